@@ -20,7 +20,8 @@ except ImportError:
     logging.warning("Could not import EDSDK bindings. Make sure the C++ bindings have been built.")
 
 # Main camera class
-from .camera import Canon
+from .camera import Canon, CameraArray
+from .aio import AsyncCanon, CommandDroppedError
 
 # Exception classes
 from .exceptions import (
@@ -58,6 +59,7 @@ from .utils import (
     
     # File operations
     create_save_directory,
+    create_file_sink,
     
     # Validation 
     is_valid_property_id
@@ -0,0 +1,184 @@
+"""
+asyncio interface for Canon EDSDK cameras.
+
+Commands are queued on the camera's processor thread and awaited; the
+processor completes each future through ``loop.call_soon_threadsafe``, so a
+single event loop can drive many cameras with no thread per camera.
+"""
+
+import asyncio
+from typing import Any, AsyncIterator, Dict, Optional
+
+try:
+    from . import edsdk_bindings
+except ImportError:
+    raise ImportError("Could not import edsdk_bindings. Make sure the C++ bindings have been built.")
+
+from .camera import Canon
+from .exceptions import CanonError
+
+
+# Keyword names accepted by AsyncCanon.set()
+PROPERTY_IDS: Dict[str, int] = {
+    "AEMode": edsdk_bindings.EdsPropertyID.AE_MODE_SELECT,
+    "Tv": edsdk_bindings.EdsPropertyID.TV,
+    "Av": edsdk_bindings.EdsPropertyID.AV,
+    "ISO": edsdk_bindings.EdsPropertyID.ISO_SPEED,
+    "MeteringMode": edsdk_bindings.EdsPropertyID.METERING_MODE,
+    "ExposureCompensation": edsdk_bindings.EdsPropertyID.EXPOSURE_COMPENSATION,
+    "ImageQuality": edsdk_bindings.EdsPropertyID.IMAGE_QUALITY,
+    "DriveMode": edsdk_bindings.EdsPropertyID.DRIVE_MODE,
+    "AFMode": edsdk_bindings.EdsPropertyID.AF_MODE,
+    "EvfMode": edsdk_bindings.EdsPropertyID.EVF_MODE,
+    "EvfOutputDevice": edsdk_bindings.EdsPropertyID.EVF_OUTPUT_DEVICE,
+    "EvfAFMode": edsdk_bindings.EdsPropertyID.EVF_AF_MODE,
+}
+
+
+class CommandDroppedError(RuntimeError):
+    """The processor discarded a command without running it, e.g. on close."""
+
+
+class AsyncCanon:
+    """Awaitable commands for one connected camera.
+
+    Example::
+
+        cam = AsyncCanon(Canon.from_session(session))
+        await cam.set(Tv=0x60, ISO=0x48)
+        await cam.take_picture()
+        async for frame in cam.live_view():
+            ...
+    """
+
+    def __init__(self, camera: Canon, loop: Optional[asyncio.AbstractEventLoop] = None):
+        """Wrap a connected camera.
+
+        Args:
+            camera: Connected Canon
+            loop: Loop the futures belong to, the running loop by default
+        """
+        camera._ensure_connected()
+        self._camera = camera
+        self._controller = camera._controller
+        self._loop = loop
+
+    @property
+    def camera(self) -> Canon:
+        """The synchronous Canon wrapped."""
+        return self._camera
+
+    def _submit(self, method, *args) -> "asyncio.Future[bool]":
+        """Queue a command and return a future completed by the processor.
+
+        The future raises CanonError if the camera rejected the command.
+        """
+        loop = self._loop or asyncio.get_running_loop()
+        future = loop.create_future()
+        handle = None
+
+        def resolve(executed: bool) -> None:
+            if future.done():
+                return
+            if not executed:
+                future.set_exception(CommandDroppedError("command was dropped before it ran"))
+            elif handle is not None and not handle.succeeded():
+                future.set_exception(CanonError.from_edsdk_error(handle.get_error()))
+            else:
+                future.set_result(True)
+
+        # Called on the processor thread
+        def completed(executed: bool) -> None:
+            loop.call_soon_threadsafe(resolve, executed)
+
+        handle = method(*args, completed)
+        return future
+
+    # --------------------------------------------------------------------------
+    # Camera operations
+    # --------------------------------------------------------------------------
+
+    async def take_picture(self) -> bool:
+        """Release the shutter; returns once the command has run."""
+        return await self._submit(self._controller.take_picture_async)
+
+    async def press_shutter_halfway(self) -> bool:
+        """Press the shutter button halfway (AF and metering)."""
+        return await self._submit(self._controller.press_shutter_button_async,
+                                  edsdk_bindings.EdsCameraCommand.SHUTTER_BUTTON_HALFWAY)
+
+    async def press_shutter_completely(self) -> bool:
+        """Press the shutter button completely."""
+        return await self._submit(self._controller.press_shutter_button_async,
+                                  edsdk_bindings.EdsCameraCommand.SHUTTER_BUTTON_COMPLETELY)
+
+    async def release_shutter(self) -> bool:
+        """Release the shutter button."""
+        return await self._submit(self._controller.press_shutter_button_async,
+                                  edsdk_bindings.EdsCameraCommand.SHUTTER_BUTTON_OFF)
+
+    async def set(self, **properties: int) -> None:
+        """Set properties by name, e.g. ``await cam.set(Tv=0x60, Av=0x30)``.
+
+        The commands are queued together and run in order.
+
+        Args:
+            properties: Values by name, see ``PROPERTY_IDS``
+        """
+        futures = []
+        for name, value in properties.items():
+            if name not in PROPERTY_IDS:
+                raise ValueError(f"Unknown property: {name}")
+            futures.append(self._submit(self._controller.set_property_async, PROPERTY_IDS[name], int(value)))
+        await asyncio.gather(*futures)
+
+    async def drive_lens(self, step: int) -> bool:
+        """Move the focus by one EdsEvfDriveLens step."""
+        return await self._submit(self._controller.drive_lens_async, step)
+
+    # --------------------------------------------------------------------------
+    # Live View (EVF)
+    # --------------------------------------------------------------------------
+
+    async def start_live_view(self) -> bool:
+        """Start live view."""
+        return await self._submit(self._controller.start_evf_async)
+
+    async def stop_live_view(self) -> bool:
+        """Stop live view."""
+        return await self._submit(self._controller.end_evf_async)
+
+    async def download_live_view_frame(self) -> Any:
+        """Download one live view frame.
+
+        Returns:
+            EvfFrame, or None if the camera had no new frame
+        """
+        model = self._camera._model
+        before = model.get_evf_frame()
+        sequence = before.sequence if before is not None else None
+        await self._submit(self._controller.download_evf_async)
+        frame = model.get_evf_frame()
+        if frame is None or frame.sequence == sequence:
+            return None
+        return frame
+
+    async def live_view(self, interval: float = 0.0) -> AsyncIterator[Any]:
+        """Stream live view frames; live view must already be started.
+
+        Args:
+            interval: Minimum seconds between downloads, 0 for as fast as
+                the camera delivers
+
+        Yields:
+            EvfFrame
+        """
+        loop = self._loop or asyncio.get_running_loop()
+        while True:
+            started = loop.time()
+            frame = await self.download_live_view_frame()
+            if frame is not None:
+                yield frame
+            remaining = interval - (loop.time() - started)
+            if remaining > 0:
+                await asyncio.sleep(remaining)
@@ -6,7 +6,7 @@ Canon camera live view (EVF).
 """
 
 import logging
-from typing import Any, Optional, Dict, List, Union, Tuple
+from typing import Any, Optional, Dict, List, Union, Tuple, Iterator
 
 try:
     from ..edsdk_bindings import *
@@ -35,6 +35,12 @@ class LiveViewManager:
         self._is_active = False
         self._zoom_level = 1
         self._zoom_position = (0, 0)  # x, y
+        self._pump = None
+        self._last_sequence = 0
+        self._decoder = None
+        self._last_index = 0
+        self._fanout = None
+        self._consumer_index = {}
         
     @property
     def is_active(self) -> bool:
@@ -68,6 +74,7 @@ class LiveViewManager:
         if not self._is_active:
             return True
             
+        self.stop_streaming()
         result = self._model.end_evf()
         if result:
             self._is_active = False
@@ -77,7 +84,8 @@ class LiveViewManager:
         """Download the current live view frame.
         
         Returns:
-            Live view image data
+            EvfFrame exposing the JPEG bytes through the buffer protocol,
+            or None if the camera has no image ready yet
             
         Raises:
             LiveViewNotActiveError: If live view is not active
@@ -87,6 +95,451 @@ class LiveViewManager:
             
         return self._model.download_evf()
         
+    @property
+    def is_streaming(self) -> bool:
+        """Get whether the live view pump is running.
+        
+        Returns:
+            True if frames are being pulled continuously, False otherwise
+        """
+        return self._pump is not None and self._pump.is_running()
+        
+    def start_streaming(self, slot_count: int = 3, target_fps: float = 0,
+                        max_in_flight: int = 1, drop_policy: str = "drop_oldest") -> bool:
+        """Start pulling frames continuously on a dedicated thread.
+        
+        Frames are kept in a ring of ``slot_count`` slots. Readers always
+        get the newest frame; frames nobody read in time are dropped.
+        
+        Args:
+            slot_count: Number of ring slots
+            target_fps: Download at most this many frames per second to
+                save USB bandwidth; 0 for as fast as the camera delivers
+            max_in_flight: Unread frames allowed before the drop policy
+                applies, at most slot_count
+            drop_policy: "drop_oldest" keeps downloading and loses the
+                oldest unread frame; "drop_newest" stops downloading until
+                a reader catches up
+            
+        Returns:
+            True if the pump is running, False otherwise
+            
+        Raises:
+            LiveViewNotActiveError: If live view is not active
+            ValueError: If drop_policy is invalid
+        """
+        if not self._is_active:
+            raise LiveViewNotActiveError("Live view is not active")
+            
+        if self.is_streaming:
+            return True
+            
+        drop_policies = {
+            "drop_oldest": EvfDropPolicy.DROP_OLDEST,
+            "drop_newest": EvfDropPolicy.DROP_NEWEST,
+        }
+        if drop_policy not in drop_policies:
+            raise ValueError(f"drop_policy must be one of {tuple(drop_policies)}")
+            
+        self._pump = EvfPump(self._model, slot_count)
+        self._pump.set_target_fps(target_fps)
+        self._pump.set_max_in_flight(max_in_flight)
+        self._pump.set_drop_policy(drop_policies[drop_policy])
+        self._last_sequence = 0
+        return self._pump.start()
+        
+    def stop_streaming(self) -> None:
+        """Stop the live view pump if it is running."""
+        self.stop_decoding()
+        self.stop_fanout()
+        if self._pump is not None:
+            self._pump.stop()
+            self._pump = None
+            
+    def latest_frame(self) -> Any:
+        """Get the newest frame pulled by the pump without waiting.
+        
+        Returns:
+            The newest EvfFrame, or None if no frame has arrived yet
+        """
+        if self._pump is None:
+            return None
+        frame = self._pump.latest()
+        if frame is not None:
+            self._last_sequence = frame.sequence
+        return frame
+        
+    def wait_for_frame(self, timeout_ms: int = 1000) -> Any:
+        """Wait for a frame newer than the last one returned.
+        
+        Args:
+            timeout_ms: Maximum time to wait in milliseconds
+            
+        Returns:
+            The newest EvfFrame, or None on timeout
+        """
+        if self._pump is None:
+            return None
+        frame = self._pump.wait_for_frame(self._last_sequence, timeout_ms)
+        if frame is not None:
+            self._last_sequence = frame.sequence
+        return frame
+        
+    def frames(self, timeout_ms: int = 1000) -> Iterator[Any]:
+        """Iterate over new frames while the pump is running.
+        
+        Stale frames are skipped, so a slow consumer gets the newest
+        frame each time instead of falling behind.
+        
+        Args:
+            timeout_ms: Maximum time to wait for each frame
+            
+        Yields:
+            EvfFrame objects
+        """
+        while self.is_streaming:
+            frame = self.wait_for_frame(timeout_ms)
+            if frame is not None:
+                yield frame
+                
+    def grab_batch(self, out: Any, n: Optional[int] = None, format: str = "rgb",
+                   timeout_ms: int = 5000, workers: int = 2) -> Tuple[Any, Any]:
+        """Fill a preallocated array with the next n streamed frames.
+        
+        Frames are decoded on worker threads as they are downloaded,
+        straight into ``out`` and resized to its size if needed, with the
+        GIL released throughout.
+        
+        Args:
+            out: uint8 array of shape (N, H, W, C), C 3 for color or 1
+                for gray; slot i gets the i-th frame
+            n: Frames to grab, at most N; None for N
+            format: "rgb" or "bgr" when C is 3
+            timeout_ms: Maximum time for the whole batch
+            workers: Number of decode threads
+            
+        Returns:
+            (timestamps, zoom): a uint64 (n, 2) array of download start and
+            end in microseconds of a steady clock, and an int32 (n, 7) array
+            of zoom, zoom rect x, y, width, height and image position x, y.
+            Fewer rows than asked for if the timeout passed first.
+            
+        Raises:
+            LiveViewNotActiveError: If the pump is not running
+            ValueError: If format or the shape of out is invalid
+        """
+        if not self.is_streaming:
+            raise LiveViewNotActiveError("Live view streaming is not running")
+            
+        pixel_formats = {
+            "rgb": JpegPixelFormat.RGB,
+            "bgr": JpegPixelFormat.BGR,
+        }
+        if format not in pixel_formats:
+            raise ValueError(f"format must be one of {tuple(pixel_formats)}")
+            
+        filled, timestamps, zoom = grab_evf_batch(self._pump, out, n or 0, pixel_formats[format],
+                                                  timeout_ms, workers)
+        return timestamps, zoom
+        
+    def start_decoding(self, worker_count: int = 2, format: str = "rgb",
+                       scale: int = 1, queue_limit: int = 4,
+                       region: Union[None, str, Tuple[int, int, int, int]] = None,
+                       statistics: bool = False) -> bool:
+        """Decode streamed frames on a pool of worker threads.
+        
+        The pump thread only downloads; decoding happens on the workers
+        and frames come out in the order they were downloaded. If the
+        workers fall behind, the oldest waiting frames are dropped.
+        
+        Args:
+            worker_count: Number of decode threads
+            format: Pixel format, one of "rgb", "bgr" or "gray"
+            scale: Denominator of the output size: 1, 2, 4 or 8
+            queue_limit: Frames allowed to wait for a worker
+            region: Decode only part of each frame: "zoom" for the frame's
+                zoom rect, or (x, y, width, height) in JPEG Large
+                coordinates; None decodes the whole frame
+            statistics: Compute histograms, means and clipping of each
+                decoded frame on the workers (``f.statistics``)
+            
+        Returns:
+            True if the decode pool is running, False otherwise
+            
+        Raises:
+            LiveViewNotActiveError: If the pump is not running
+            ValueError: If format or scale is invalid
+        """
+        if not self.is_streaming:
+            raise LiveViewNotActiveError("Live view streaming is not running")
+            
+        pixel_formats = {
+            "rgb": JpegPixelFormat.RGB,
+            "bgr": JpegPixelFormat.BGR,
+            "gray": JpegPixelFormat.GRAY,
+        }
+        if format not in pixel_formats:
+            raise ValueError(f"format must be one of {tuple(pixel_formats)}")
+        if scale not in (1, 2, 4, 8):
+            raise ValueError("scale must be 1, 2, 4 or 8")
+            
+        self.stop_decoding()
+        self._decoder = EvfDecodePool(worker_count, pixel_formats[format], scale, queue_limit)
+        placement = self._model.get_placement()
+        self._decoder.set_placement(placement.decode, placement.name)
+        self._last_index = 0
+        if region == "zoom":
+            self._decoder.follow_zoom_rect()
+        elif region is not None:
+            rect = EdsRect()
+            rect.point.x, rect.point.y, rect.size.width, rect.size.height = region
+            self._decoder.set_region(rect, EvfCoordinateSpace.JPEG_LARGE)
+        self._decoder.set_compute_statistics(statistics)
+        if not self._decoder.start():
+            self._decoder = None
+            return False
+        self._pump.add_sink(self._decoder)
+        return True
+        
+    def stop_decoding(self) -> None:
+        """Stop the decode pool if it is running."""
+        if self._decoder is not None:
+            if self._pump is not None:
+                self._pump.remove_sink(self._decoder)
+            self._decoder.stop()
+            self._decoder = None
+            
+    def wait_for_decoded(self, timeout_ms: int = 1000) -> Any:
+        """Wait for a decoded frame newer than the last one returned.
+        
+        Args:
+            timeout_ms: Maximum time to wait in milliseconds
+            
+        Returns:
+            DecodedEvfFrame (``np.asarray(f.image)`` gives the pixels,
+            ``f.timing`` the per-stage timestamps), or None on timeout
+        """
+        if self._decoder is None:
+            return None
+        decoded = self._decoder.wait_for_frame(self._last_index, timeout_ms)
+        if decoded is not None:
+            self._last_index = decoded.index
+        return decoded
+        
+    def decoded_frames(self, timeout_ms: int = 1000) -> Iterator[Any]:
+        """Iterate over decoded frames while decoding is running.
+        
+        Args:
+            timeout_ms: Maximum time to wait for each frame
+            
+        Yields:
+            DecodedEvfFrame objects, in download order
+        """
+        while self._decoder is not None and self._decoder.is_running():
+            decoded = self.wait_for_decoded(timeout_ms)
+            if decoded is not None:
+                yield decoded
+                
+    def get_decoding_statistics(self) -> Dict[str, int]:
+        """Get counters of the decode pool.
+        
+        Returns:
+            Dictionary of decode pool counters, empty if not decoding
+        """
+        if self._decoder is None:
+            return {}
+        stats = self._decoder.get_statistics()
+        return {
+            "submitted": stats.submitted,
+            "dropped": stats.dropped,
+            "decoded": stats.decoded,
+            "failed": stats.failed,
+            "delivered": stats.delivered,
+            "queue_depth": stats.queue_depth,
+            "worker_count": stats.worker_count,
+            "average_decode_micros": stats.average_decode_micros,
+            "average_latency_micros": stats.average_latency_micros,
+        }
+        
+    def add_consumer(self, width: int = 0, height: int = 0, format: str = "rgb",
+                     region: Union[None, str, Tuple[int, int, int, int]] = None,
+                     filter: str = "area", callback: Optional[Any] = None) -> int:
+        """Declare a consumer of decoded streamed frames.
+        
+        All consumers share one decode per frame: at the coarsest scale
+        that still covers the largest output, of only the regions asked
+        for. Each output is cut and resized from it; consumers asking for
+        the same output get the same image.
+        
+        Args:
+            width: Output width, 0 to keep the region's width (or the
+                aspect ratio if height is given)
+            height: Output height, likewise
+            format: Pixel format, one of "rgb", "bgr" or "gray"
+            region: "zoom" for the frame's zoom rect, or (x, y, width,
+                height) in JPEG Large coordinates; None for the whole frame
+            filter: Resize filter, one of "area", "bilinear" or "lanczos"
+            callback: Called with each EvfFanoutFrame on the fan-out
+                thread; without one use wait_for_consumer()
+            
+        Returns:
+            The consumer id
+            
+        Raises:
+            LiveViewNotActiveError: If the pump is not running
+            ValueError: If format or filter is invalid
+        """
+        if not self.is_streaming:
+            raise LiveViewNotActiveError("Live view streaming is not running")
+            
+        pixel_formats = {
+            "rgb": JpegPixelFormat.RGB,
+            "bgr": JpegPixelFormat.BGR,
+            "gray": JpegPixelFormat.GRAY,
+        }
+        filters = {
+            "area": ResizeFilter.AREA,
+            "bilinear": ResizeFilter.BILINEAR,
+            "lanczos": ResizeFilter.LANCZOS,
+        }
+        if format not in pixel_formats:
+            raise ValueError(f"format must be one of {tuple(pixel_formats)}")
+        if filter not in filters:
+            raise ValueError(f"filter must be one of {tuple(filters)}")
+            
+        spec = EvfConsumerSpec(width, height, pixel_formats[format], filters[filter])
+        if region == "zoom":
+            spec.region_mode = EvfRegionMode.ZOOM_RECT
+        elif region is not None:
+            rect = EdsRect()
+            rect.point.x, rect.point.y, rect.size.width, rect.size.height = region
+            spec.region = rect
+            spec.region_mode = EvfRegionMode.FIXED
+            spec.region_space = EvfCoordinateSpace.JPEG_LARGE
+            
+        if self._fanout is None:
+            self._fanout = EvfFanout()
+            placement = self._model.get_placement()
+            self._fanout.set_placement(placement.decode, placement.name)
+            self._fanout.start()
+            self._pump.add_sink(self._fanout)
+        consumer = self._fanout.add_consumer(spec, callback)
+        self._consumer_index[consumer] = 0
+        return consumer
+        
+    def remove_consumer(self, consumer: int) -> bool:
+        """Remove a consumer added with add_consumer()."""
+        self._consumer_index.pop(consumer, None)
+        return self._fanout is not None and self._fanout.remove_consumer(consumer)
+        
+    def wait_for_consumer(self, consumer: int, timeout_ms: int = 1000) -> Any:
+        """Wait for a consumer's output of a frame newer than the last one returned.
+        
+        Args:
+            consumer: Id from add_consumer()
+            timeout_ms: Maximum time to wait in milliseconds
+            
+        Returns:
+            EvfFanoutFrame (``np.asarray(f.image)`` gives the pixels), or
+            None on timeout
+        """
+        if self._fanout is None or consumer not in self._consumer_index:
+            return None
+        output = self._fanout.wait_for_frame(consumer, self._consumer_index[consumer], timeout_ms)
+        if output is not None:
+            self._consumer_index[consumer] = output.index
+        return output
+        
+    def stop_fanout(self) -> None:
+        """Remove all consumers and stop decoding for them."""
+        if self._fanout is not None:
+            if self._pump is not None:
+                self._pump.remove_sink(self._fanout)
+            self._fanout.stop()
+            self._fanout = None
+        self._consumer_index = {}
+        
+    def get_fanout_statistics(self) -> Dict[str, int]:
+        """Get counters of the consumer fan-out.
+        
+        Returns:
+            Dictionary of fan-out counters and the last frame's decode
+            plan, empty if there are no consumers
+        """
+        if self._fanout is None:
+            return {}
+        stats = self._fanout.get_statistics()
+        return {
+            "submitted": stats.submitted,
+            "dropped": stats.dropped,
+            "frames": stats.frames,
+            "failed": stats.failed,
+            "outputs": stats.outputs,
+            "shared_outputs": stats.shared_outputs,
+            "consumer_count": stats.consumer_count,
+            "last_scale": stats.last_scale,
+            "last_decode_width": stats.last_decode_width,
+            "last_decode_height": stats.last_decode_height,
+            "average_decode_micros": stats.average_decode_micros,
+            "average_derive_micros": stats.average_derive_micros,
+            "average_latency_micros": stats.average_latency_micros,
+        }
+        
+    def get_streaming_statistics(self) -> Dict[str, int]:
+        """Get counters of the live view pump.
+        
+        Returns:
+            Dictionary with published, dropped, not_ready, errors,
+            last_sequence, achieved_fps, in_flight, throttled, stalls and
+            stall_micros, empty if the pump was never started
+        """
+        if self._pump is None:
+            return {}
+        stats = self._pump.get_statistics()
+        return {
+            "published": stats.published,
+            "dropped": stats.dropped,
+            "not_ready": stats.not_ready,
+            "errors": stats.errors,
+            "last_sequence": stats.last_sequence,
+            "achieved_fps": stats.achieved_fps,
+            "in_flight": stats.in_flight,
+            "throttled": stats.throttled,
+            "stalls": stats.stalls,
+            "stall_micros": stats.stall_micros,
+        }
+        
+    def configure_stream_pool(self, pool_size: Optional[int] = None,
+                              buffer_size: Optional[int] = None) -> None:
+        """Configure the pool of streams reused for live view downloads.
+        
+        Args:
+            pool_size: Number of idle streams kept for reuse
+            buffer_size: Size in bytes of each stream buffer; must hold
+                the largest live view JPEG
+        """
+        pool = self._model.get_evf_stream_pool()
+        if pool_size is not None:
+            pool.set_pool_size(pool_size)
+        if buffer_size is not None:
+            pool.set_buffer_size(buffer_size)
+        pool.preallocate()
+        
+    def get_stream_pool_statistics(self) -> Dict[str, int]:
+        """Get hit/miss statistics of the live view stream pool.
+        
+        Returns:
+            Dictionary with hits, misses, pool_size, buffer_size and available
+        """
+        stats = self._model.get_evf_stream_pool().get_statistics()
+        return {
+            "hits": stats.hits,
+            "misses": stats.misses,
+            "pool_size": stats.pool_size,
+            "buffer_size": stats.buffer_size,
+            "available": stats.available,
+        }
+        
     def set_zoom_level(self, level: int) -> bool:
         """Set the live view zoom level.
         
@@ -211,6 +664,79 @@ class LiveViewManager:
         cmd = DoEvfAFCommand(self._model, point)
         return cmd.execute()
         
+    def contrast_autofocus(self, region: Union[None, str, Tuple[int, int, int, int]] = "zoom",
+                           metric: str = "tenengrad", coarse_step: int = 2,
+                           fine_step: int = 1, start_far: bool = True,
+                           max_steps: int = 40, patience: int = 2,
+                           threshold: float = 0.01, settle_frames: int = 1,
+                           scale: int = 1) -> Dict[str, Any]:
+        """Focus by maximising image contrast, independent of the camera's AF.
+        
+        The search runs natively: each lens step is followed by scoring
+        the next live view frame, without returning to Python. Frames come
+        from the streaming pump if it is running.
+        
+        Args:
+            region: Area to score: "zoom" for the zoom rect, (x, y, width,
+                height) in JPEG Large coordinates, or None for the whole frame
+            metric: "tenengrad" or "laplacian"
+            coarse_step: Lens step size of the first climb (1-3)
+            fine_step: Step size of the refining climb (1-3), 0 to skip it
+            start_far: Try the far direction first
+            max_steps: Maximum scored steps per climb
+            patience: Steps without improvement before a climb ends
+            threshold: Relative gain that counts as an improvement
+            settle_frames: Frames discarded after each step
+            scale: Decode at 1/scale of the frame size: 1, 2, 4 or 8
+            
+        Returns:
+            Dictionary with the best positions, score and the focus curve
+            
+        Raises:
+            LiveViewNotActiveError: If live view is not active
+            ValueError: If metric or scale is invalid
+        """
+        if not self._is_active:
+            raise LiveViewNotActiveError("Live view is not active")
+            
+        metrics = {
+            "tenengrad": FocusMetric.TENENGRAD,
+            "laplacian": FocusMetric.LAPLACIAN_VARIANCE,
+        }
+        if metric not in metrics:
+            raise ValueError(f"metric must be one of {tuple(metrics)}")
+        if scale not in (1, 2, 4, 8):
+            raise ValueError("scale must be 1, 2, 4 or 8")
+            
+        engine = FocusEngine(self._model, self._pump if self.is_streaming else None)
+        engine.set_metric(metrics[metric])
+        if region is None:
+            engine.clear_region()
+        elif region != "zoom":
+            rect = EdsRect()
+            rect.point.x, rect.point.y, rect.size.width, rect.size.height = region
+            engine.set_region(rect, EvfCoordinateSpace.JPEG_LARGE)
+        engine.set_scale(scale)
+        engine.set_steps(coarse_step, fine_step)
+        engine.set_start_far(start_far)
+        engine.set_max_steps(max_steps)
+        engine.set_patience(patience)
+        engine.set_threshold(threshold)
+        engine.set_settle_frames(settle_frames)
+        
+        result = engine.run()
+        return {
+            "success": result.success,
+            "error": result.error,
+            "best_position": result.best_position,
+            "best_fine_position": result.best_fine_position,
+            "best_score": result.best_score,
+            "lens_steps": result.lens_steps,
+            "frames": result.frames,
+            "elapsed_ms": result.elapsed_micros / 1000.0,
+            "curve": [(s.phase, s.position, s.score) for s in result.curve],
+        }
+        
     def get_focus_info(self) -> Dict[str, Any]:
         """Get information about the current focus state.
         
@@ -63,48 +63,11 @@ class ISOSettings:
             Human-readable ISO label (e.g., "ISO 100")
         """
         try:
-            # First try to use the EDSDK function if available
-            return Iso.get_label(iso_value)
+            # Shared with the C++ layer, see PropertyLabels.h
+            label = Iso.get_label(iso_value)
         except (NameError, AttributeError):
-            # Fallback implementation
-            if iso_value == cls.AUTO:
-                return "ISO Auto"
-                
-            # Map codes to values
-            iso_map = {
-                cls.ISO_50: "ISO 50",
-                cls.ISO_100: "ISO 100",
-                cls.ISO_125: "ISO 125",
-                cls.ISO_160: "ISO 160",
-                cls.ISO_200: "ISO 200",
-                cls.ISO_250: "ISO 250",
-                cls.ISO_320: "ISO 320",
-                cls.ISO_400: "ISO 400",
-                cls.ISO_500: "ISO 500",
-                cls.ISO_640: "ISO 640",
-                cls.ISO_800: "ISO 800",
-                cls.ISO_1000: "ISO 1000",
-                cls.ISO_1250: "ISO 1250",
-                cls.ISO_1600: "ISO 1600",
-                cls.ISO_2000: "ISO 2000",
-                cls.ISO_2500: "ISO 2500",
-                cls.ISO_3200: "ISO 3200",
-                cls.ISO_4000: "ISO 4000",
-                cls.ISO_5000: "ISO 5000",
-                cls.ISO_6400: "ISO 6400",
-                cls.ISO_8000: "ISO 8000",
-                cls.ISO_10000: "ISO 10000",
-                cls.ISO_12800: "ISO 12800",
-                cls.ISO_16000: "ISO 16000",
-                cls.ISO_20000: "ISO 20000",
-                cls.ISO_25600: "ISO 25600",
-                cls.ISO_32000: "ISO 32000",
-                cls.ISO_40000: "ISO 40000",
-                cls.ISO_51200: "ISO 51200",
-                cls.ISO_102400: "ISO 102400",
-            }
-            
-            return iso_map.get(iso_value, f"ISO {iso_value}")
+            label = None
+        return label if label is not None else f"ISO {iso_value}"
 
 
 class ApertureSettings:
@@ -153,44 +116,11 @@ class ApertureSettings:
             Human-readable aperture label (e.g., "f/2.8")
         """
         try:
-            # First try to use the EDSDK function if available
-            return Av.get_label(av_value)
+            # Shared with the C++ layer, see PropertyLabels.h
+            label = Av.get_label(av_value)
         except (NameError, AttributeError):
-            # Fallback implementation
-            av_map = {
-                cls.F1_0: "f/1.0",
-                cls.F1_2: "f/1.2",
-                cls.F1_4: "f/1.4",
-                cls.F1_6: "f/1.6",
-                cls.F1_8: "f/1.8",
-                cls.F2_0: "f/2.0",
-                cls.F2_2: "f/2.2",
-                cls.F2_5: "f/2.5",
-                cls.F2_8: "f/2.8",
-                cls.F3_2: "f/3.2",
-                cls.F3_5: "f/3.5",
-                cls.F4_0: "f/4.0",
-                cls.F4_5: "f/4.5",
-                cls.F5_0: "f/5.0",
-                cls.F5_6: "f/5.6",
-                cls.F6_3: "f/6.3",
-                cls.F7_1: "f/7.1",
-                cls.F8_0: "f/8.0",
-                cls.F9_0: "f/9.0",
-                cls.F10: "f/10",
-                cls.F11: "f/11",
-                cls.F13: "f/13",
-                cls.F14: "f/14",
-                cls.F16: "f/16",
-                cls.F18: "f/18",
-                cls.F20: "f/20",
-                cls.F22: "f/22",
-                cls.F25: "f/25",
-                cls.F29: "f/29",
-                cls.F32: "f/32",
-            }
-            
-            return av_map.get(av_value, f"f/{av_value}")
+            label = None
+        return label if label is not None else f"f/{av_value}"
 
 
 class ShutterSpeedSettings:
@@ -266,68 +196,8 @@ class ShutterSpeedSettings:
             Human-readable shutter speed label (e.g., "1/125")
         """
         try:
-            # First try to use the EDSDK function if available
-            return Tv.get_label(tv_value)
+            # Shared with the C++ layer, see PropertyLabels.h
+            label = Tv.get_label(tv_value)
         except (NameError, AttributeError):
-            # Fallback implementation
-            tv_map = {
-                cls.BULB: "Bulb",
-                cls.SEC_30: "30\"",
-                cls.SEC_25: "25\"",
-                cls.SEC_20: "20\"",
-                cls.SEC_15: "15\"",
-                cls.SEC_13: "13\"",
-                cls.SEC_10: "10\"",
-                cls.SEC_8: "8\"",
-                cls.SEC_6: "6\"",
-                cls.SEC_5: "5\"",
-                cls.SEC_4: "4\"",
-                cls.SEC_3_2: "3.2\"",
-                cls.SEC_3: "3\"",
-                cls.SEC_2_5: "2.5\"",
-                cls.SEC_2: "2\"",
-                cls.SEC_1_6: "1.6\"",
-                cls.SEC_1_3: "1.3\"",
-                cls.SEC_1: "1\"",
-                cls.SEC_0_8: "0.8\"",
-                cls.SEC_0_6: "0.6\"",
-                cls.SEC_0_5: "0.5\"",
-                cls.SEC_0_4: "0.4\"",
-                cls.SEC_0_3: "0.3\"",
-                cls.SEC_1_4: "1/4",
-                cls.SEC_1_5: "1/5",
-                cls.SEC_1_6_2: "1/6",
-                cls.SEC_1_8: "1/8",
-                cls.SEC_1_10: "1/10",
-                cls.SEC_1_13: "1/13",
-                cls.SEC_1_15: "1/15",
-                cls.SEC_1_20: "1/20",
-                cls.SEC_1_25: "1/25",
-                cls.SEC_1_30: "1/30",
-                cls.SEC_1_40: "1/40",
-                cls.SEC_1_50: "1/50",
-                cls.SEC_1_60: "1/60",
-                cls.SEC_1_80: "1/80",
-                cls.SEC_1_100: "1/100",
-                cls.SEC_1_125: "1/125",
-                cls.SEC_1_160: "1/160",
-                cls.SEC_1_200: "1/200",
-                cls.SEC_1_250: "1/250",
-                cls.SEC_1_320: "1/320",
-                cls.SEC_1_400: "1/400",
-                cls.SEC_1_500: "1/500",
-                cls.SEC_1_640: "1/640",
-                cls.SEC_1_800: "1/800",
-                cls.SEC_1_1000: "1/1000",
-                cls.SEC_1_1250: "1/1250",
-                cls.SEC_1_1600: "1/1600",
-                cls.SEC_1_2000: "1/2000",
-                cls.SEC_1_2500: "1/2500",
-                cls.SEC_1_3200: "1/3200",
-                cls.SEC_1_4000: "1/4000",
-                cls.SEC_1_5000: "1/5000",
-                cls.SEC_1_6400: "1/6400",
-                cls.SEC_1_8000: "1/8000",
-            }
-            
-            return tv_map.get(tv_value, f"TV {tv_value}") 
\ No newline at end of file
+            label = None
+        return label if label is not None else f"TV {tv_value}"
@@ -1,6 +1,11 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/functional.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
 
 // Core SDK headers
 #include "EDSDK.h"
@@ -8,13 +13,25 @@
 // Controller & Model
 #include "CameraController.h"
 #include "CameraModel.h"
+#include "PropertyStore.h"
+#include "PropertyDescCache.h"
 #include "CameraModelLegacy.h"
 #include "CameraEvent.h"
 #include "CameraEventListener.h"
+#include "CameraManager.h"
+#include "SdkContext.h"
+#include "HotPlugMonitor.h"
+#include "SessionRecovery.h"
+#include "SyncTrigger.h"
+#include "ArmedShutter.h"
+#include "CaptureSequencer.h"
+#include "EventQueue.h"
 
 // Command processing
 #include "Processor.h"
+#include "TransferProcessor.h"
 #include "Command.h"
+#include "CommandHandle.h"
 
 // Commands
 #include "TakePictureCommand.h"
@@ -23,6 +40,7 @@
 #include "SetPropertyCommand.h"
 #include "GetPropertyCommand.h"
 #include "GetPropertyDescCommand.h"
+#include "GetPropertiesCommand.h"
 #include "SetCapacityCommand.h"
 #include "SaveSettingCommand.h"
 #include "PressShutterButtonCommand.h"
@@ -30,31 +48,248 @@
 #include "CloseSessionCommand.h"
 #include "NotifyCommand.h"
 #include "DownloadEvfCommand.h"
+#include "EvfFrame.h"
+#include "EvfStreamPool.h"
+#include "EvfMetadata.h"
+#include "EvfPump.h"
+#include "JpegDecoder.h"
+#include "EvfDecodePool.h"
+#include "EvfFanout.h"
+#include "EvfBatchGrab.h"
+#include "EvfRegion.h"
+#include "EvfRecording.h"
+#include "EvfHttpServer.h"
+#include "SharedFrameRing.h"
+#include "ImageStatistics.h"
+#include "ImageKernels.h"
+#include "Sharpness.h"
+#include "FocusEngine.h"
 #include "DownloadCommand.h"
+#include "TransferProgress.h"
+#include "CapturedImage.h"
+#include "Thumbnail.h"
+#include "CardImport.h"
+#include "RawDevelopPool.h"
+#include "ShootPipeline.h"
+#include "FocusBracket.h"
+#include "ExposureBracket.h"
+#include "MotionTrigger.h"
+#include "XxHash64.h"
+#include "DownloadSink.h"
+#include "DownloadPipeline.h"
+#include "AsyncFileSink.h"
 #include "DriveLensCommand.h"
 #include "DoEvfAFCommand.h"
 
 // Utility classes
 #include "Thread.h"
+#include "ThreadPlacement.h"
 #include "Synchronized.h"
 #include "Observer.h"
 #include "ActionSource.h"
 #include "ActionListener.h"
 #include "ActionEvent.h"
+#include "Trace.h"
 
-// Property classes
-#include "Tv.h"
-#include "Av.h"
-#include "Iso.h"
-#include "MeteringMode.h"
-#include "ImageQuality.h"
-#include "ExposureComp.h"
-#include "AEMode.h"
-#include "EvfAFMode.h"
-#include "PropertyComboBox.h"
+// Property labels
+#include "PropertyLabels.h"
 
 namespace py = pybind11;
 
+// GIL policy: every call that can wait on the device, a thread or a queue
+// is bound with py::call_guard<py::gil_scoped_release>, and C++ only takes
+// the GIL back to call into Python (the trampolines below). N Python threads
+// can then drive N cameras at once, and a processor thread that notifies a
+// Python observer cannot deadlock against a Python thread waiting on it.
+
+// Runs a command on the calling thread, retrying while it reports the
+// device busy like the processor does. Call without the GIL.
+static bool executeCommand(Command &command, int attempts = 10, int retryMillis = 100)
+{
+    for (int i = 0; i < attempts; i++)
+    {
+        if (command.execute())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(retryMillis));
+    }
+    return false;
+}
+
+// Checks that a buffer holds 8-bit (h, w) gray or (h, w, 3) colour pixels
+// with packed columns, and returns its geometry.
+static void pixelLayout(const py::buffer_info &info, JpegPixelFormat format, int &width, int &height, int &stride)
+{
+    int channels = (format == kJpegPixelFormat_Gray) ? 1 : 3;
+    bool shaped = (channels == 1) ? (info.ndim == 2 || (info.ndim == 3 && info.shape[2] == 1))
+                                  : (info.ndim == 3 && info.shape[2] == 3);
+    if (info.itemsize != 1 || !shaped)
+        throw std::invalid_argument("expected uint8 pixels of shape (h, w) for gray or (h, w, 3) for colour");
+    if (info.strides[1] != channels || (info.ndim == 3 && info.strides[2] != 1))
+        throw std::invalid_argument("pixel columns must be contiguous");
+    height = (int)info.shape[0];
+    width = (int)info.shape[1];
+    stride = (int)info.strides[0];
+}
+
+// Lets Python classes act as download sinks. Calls come from the pipeline
+// thread; write() gets a read-only memoryview that is only valid during the call.
+class PyDownloadSink : public DownloadSink
+{
+public:
+    bool begin(CameraModel *model, const EdsDirectoryItemInfo &info) override
+    {
+        PYBIND11_OVERRIDE_PURE(bool, DownloadSink, begin, model, info);
+    }
+
+    bool write(const unsigned char *data, size_t length) override
+    {
+        py::gil_scoped_acquire gil;
+        py::function override = py::get_override(static_cast<const DownloadSink*>(this), "write");
+        if (!override)
+            return false;
+        py::memoryview chunk = py::memoryview::from_memory(data, (py::ssize_t)length);
+        return override(chunk).cast<bool>();
+    }
+
+    void end(bool success) override
+    {
+        PYBIND11_OVERRIDE_PURE(void, DownloadSink, end, success);
+    }
+};
+
+// Completion that calls back into Python from the processor thread. The
+// callback is only called and released with the GIL held.
+static CommandCompletion pyCompletion(py::function callback)
+{
+    std::shared_ptr<py::function> held(new py::function(std::move(callback)), [](py::function *function) {
+        py::gil_scoped_acquire gil;
+        delete function;
+    });
+    return [held](bool executed) {
+        py::gil_scoped_acquire gil;
+        try
+        {
+            (*held)(executed);
+        }
+        catch (py::error_already_set &e)
+        {
+            e.discard_as_unraisable("command completion");
+        }
+    };
+}
+
+// callback may be None when only the handle is wanted
+static CommandHandleRef enqueueAsync(CameraController &controller, Command *command, py::object callback)
+{
+    if (!callback.is_none())
+    {
+        CommandCompletion completion = pyCompletion(callback.cast<py::function>());
+        py::gil_scoped_release release;
+        return controller.enqueue(command, completion);
+    }
+    py::gil_scoped_release release;
+    return controller.enqueue(command);
+}
+
+// Queues every fetch before waiting on any, so the thumbnails cross the link
+// back to back. Called with the GIL released.
+static std::vector<ThumbnailRef> fetchThumbnails(CameraController &controller, const std::vector<EdsBaseRef> &items,
+    bool decode, EdsUInt32 maxSize, std::vector<EdsError> &outErrors)
+{
+    std::shared_ptr<std::vector<ThumbnailRef>> results = std::make_shared<std::vector<ThumbnailRef>>(items.size());
+    std::vector<CommandHandleRef> handles;
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        // The command releases its reference, the caller keeps theirs
+        EdsRetain(items[i]);
+        handles.push_back(controller.thumbnail(items[i], [results, i](EdsError, const ThumbnailRef &thumbnail) {
+            (*results)[i] = thumbnail;
+        }, decode, maxSize));
+    }
+
+    outErrors.assign(items.size(), EDS_ERR_OK);
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        handles[i]->wait(-1);
+        outErrors[i] = handles[i]->getError();
+        if (handles[i]->getStatus() == kCommandStatus_Dropped && outErrors[i] == EDS_ERR_OK)
+            outErrors[i] = EDS_ERR_OPERATION_CANCELLED;
+    }
+    return *results;
+}
+
+// None if the value has no label
+static py::object propertyLabel(const PROPERTY_LABEL_TABLE *table, EdsUInt32 value)
+{
+    const char *label = findPropertyLabel(table, value);
+    if (label == NULL)
+        return py::none();
+    return py::str(label);
+}
+
+// Value to label, in value order
+static py::dict propertyLabels(const PROPERTY_LABEL_TABLE *table)
+{
+    py::dict labels;
+    for (size_t i = 0; table != NULL && i < table->count; i++)
+        labels[py::int_(table->labels[i].value)] = py::str(table->labels[i].label);
+    return labels;
+}
+
+// EdsError, EdsCameraCommand and EdsPropertyID are typedefs of EdsUInt32,
+// which py::enum_ cannot bind; each gets a class of integer constants,
+// e.g. EdsError.DEVICE_BUSY
+template <int tag>
+struct ConstantClass {};
+
+struct CONSTANT
+{
+    const char *name;
+    EdsUInt32 value;
+};
+
+template <int tag, size_t count>
+static void bindConstantClass(py::module &m, const char *name, const CONSTANT (&constants)[count])
+{
+    py::class_<ConstantClass<tag>> constantClass(m, name);
+    for (size_t i = 0; i < count; i++)
+        constantClass.attr(constants[i].name) = py::int_(constants[i].value);
+}
+
+// Gives each label table a Python class, e.g. Tv.get_label(0x60)
+template <EdsPropertyID propertyID>
+struct PropertyLabelClass {};
+
+template <EdsPropertyID propertyID>
+static void bindPropertyLabelClass(py::module &m, const char *name)
+{
+    py::class_<PropertyLabelClass<propertyID>>(m, name)
+        .def_property_readonly_static("property_id", [](py::object) { return propertyID; })
+        .def_static("get_label", [](EdsUInt32 value) {
+            return propertyLabel(findPropertyLabelTable(propertyID), value);
+        }, py::arg("value"))
+        .def_static("get_labels", []() { return propertyLabels(findPropertyLabelTable(propertyID)); });
+}
+
+// Python observers are called from the processor and SDK threads.
+class PyObserver : public Observer
+{
+public:
+    void update(Observable *from, CameraEvent *e) override
+    {
+        PYBIND11_OVERRIDE_PURE(void, Observer, update, from, e);
+    }
+};
+
+class PyEventObserver : public EventObserver
+{
+public:
+    void onEvent(Observable *from, const CameraEvent &e) override
+    {
+        PYBIND11_OVERRIDE_PURE_NAME(void, EventObserver, "on_event", onEvent, from, &e);
+    }
+};
+
 PYBIND11_MODULE(edsdk_bindings, m) {
     m.doc() = "Python bindings for Canon EDSDK";
 
@@ -82,7 +317,9 @@ PYBIND11_MODULE(edsdk_bindings, m) {
         .def("get_evf_zoom_rect", &CameraModel::getEvfZoomRect)
         .def("get_evf_af_mode", &CameraModel::getEvfAFMode)
         .def("get_model_name", &CameraModel::getModelName)
+        .def("get_serial_number", &CameraModel::getSerialNumber)
         .def("get_focus_info", &CameraModel::getFocusInfo)
+        .def("get_startup_timing", &CameraModel::getStartupTiming)
         // Property setters
         .def("set_ae_mode", &CameraModel::setAEMode)
         .def("set_tv", &CameraModel::setTv)
@@ -103,41 +340,916 @@ PYBIND11_MODULE(edsdk_bindings, m) {
         // Property descriptions
         .def("get_property_desc", &CameraModel::getPropertyDesc)
         .def("set_property_desc", &CameraModel::setPropertyDesc)
+        .def("get_property_store", static_cast<PropertyStore &(CameraModel::*)()>(&CameraModel::getPropertyStore),
+             py::return_value_policy::reference_internal)
         // Lock control
-        .def("lock_ui", &CameraModel::lockUI)
-        .def("unlock_ui", &CameraModel::unlockUI)
+        .def("lock_ui", &CameraModel::lockUI, py::call_guard<py::gil_scoped_release>())
+        .def("unlock_ui", &CameraModel::unlockUI, py::call_guard<py::gil_scoped_release>())
+        .def("get_lock_count", &CameraModel::getLockCount)
         // Camera operations
-        .def("download_evf", &CameraModel::downloadEvf)
-        .def("end_evf", &CameraModel::endEvf)
-        .def("start_evf", &CameraModel::startEvf)
-        .def("take_picture", &CameraModel::takePicture)
-        .def("press_shutter_button", &CameraModel::pressShutterButton)
-        .def("set_capacity", &CameraModel::setCapacity)
-        .def("save_property", &CameraModel::saveProperty);
+        .def("download_evf", [](CameraModel &model) -> EvfFrameRef {
+            EvfFrameRef frame;
+            EdsError err = DownloadEvfCommand::downloadFrame(&model, frame);
+            if (err == EDS_ERR_OBJECT_NOTREADY || err == EDS_ERR_DEVICE_BUSY)
+                return EvfFrameRef();
+            if (err != EDS_ERR_OK)
+                throw std::runtime_error("EdsDownloadEvfImage failed: " + std::to_string(err));
+            model.setEvfFrame(frame);
+            return frame;
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("get_evf_frame", &CameraModel::getEvfFrame)
+        .def("get_evf_stream_pool", &CameraModel::getEvfStreamPool)
+        .def("get_evf_metadata", &CameraModel::getEvfMetadata, py::return_value_policy::reference_internal)
+        // Captured images
+        .def("set_download_target", &CameraModel::setDownloadTarget)
+        .def("get_download_target", &CameraModel::getDownloadTarget)
+        .def("get_capture_buffer_pool", &CameraModel::getCaptureBufferPool)
+        .def("wait_for_capture", [](CameraModel &model, int timeoutMs) {
+            return model.getCaptureQueue()->pop(timeoutMs);
+        }, py::arg("timeout_ms") = 0, py::call_guard<py::gil_scoped_release>())
+        .def("get_pending_captures", [](CameraModel &model) { return model.getCaptureQueue()->size(); })
+        .def("get_dropped_captures", [](CameraModel &model) { return model.getCaptureQueue()->getDropped(); })
+        .def("set_capture_queue_limit", [](CameraModel &model, EdsUInt32 limit) { model.getCaptureQueue()->setLimit(limit); })
+        .def("set_download_pipeline", &CameraModel::setDownloadPipeline)
+        .def("get_download_pipeline", &CameraModel::getDownloadPipeline)
+        .def("get_storage_index", &CameraModel::getStorageIndex)
+        .def("set_save_to", [](CameraModel &model, EdsSaveTo saveTo) { model.setSaveTo(saveTo); })
+        .def("get_save_to", [](const CameraModel &model) { return (EdsSaveTo)model.getSaveTo(); })
+        .def("set_host_capacity_path", &CameraModel::setHostCapacityPath)
+        .def("get_host_capacity_path", &CameraModel::getHostCapacityPath)
+        .def("get_transfer_rules", &CameraModel::getTransferRules)
+        .def("set_placement", &CameraModel::setPlacement)
+        .def("get_placement", &CameraModel::getPlacement)
+        // Run on the calling thread, not the processor
+        .def("end_evf", [](CameraModel &model) {
+            EndEvfCommand command(&model);
+            return executeCommand(command);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("start_evf", [](CameraModel &model) {
+            StartEvfCommand command(&model);
+            return executeCommand(command);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("take_picture", [](CameraModel &model) {
+            TakePictureCommand command(&model);
+            return executeCommand(command);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("press_shutter_button", [](CameraModel &model, EdsUInt32 status) {
+            PressShutterButtonCommand command(&model, status);
+            return executeCommand(command);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("set_capacity", [](CameraModel &model, const EdsCapacity &capacity) {
+            SetCapacityCommand command(&model, capacity);
+            return executeCommand(command);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("save_property", [](CameraModel &model, EdsUInt32 saveTo) {
+            SaveSettingCommand command(&model, (EdsSaveTo)saveTo);
+            return executeCommand(command);
+        }, py::arg("save_to") = (EdsUInt32)kEdsSaveTo_Host, py::call_guard<py::gil_scoped_release>());
     
     // --- CameraController ---
     py::class_<CameraController, ActionListener>(m, "CameraController")
         .def(py::init<>())
         .def("set_camera_model", &CameraController::setCameraModel)
         .def("run", &CameraController::run)
-        .def("action_performed", &CameraController::actionPerformed);
+        .def("action_performed", &CameraController::actionPerformed, py::call_guard<py::gil_scoped_release>())
+        // Typed commands, returning the CommandHandle
+        .def("open_session", &CameraController::openSession, py::call_guard<py::gil_scoped_release>())
+        .def("set_property", &CameraController::setProperty, py::arg("property_id"), py::arg("value"), py::call_guard<py::gil_scoped_release>())
+        .def("get_property", &CameraController::getProperty, py::call_guard<py::gil_scoped_release>())
+        .def("get_properties", &CameraController::getProperties, py::call_guard<py::gil_scoped_release>())
+        // (property_id, value) pairs; an int is set as EdsUInt32, bytes as they are
+        .def("set_properties", [](CameraController &controller, const std::vector<std::pair<EdsUInt32, py::object>> &values) {
+            PropertySettingList settings;
+            for (const auto &value : values) {
+                if (py::isinstance<py::bytes>(value.second)) {
+                    std::string data = value.second.cast<std::string>();
+                    if (data.size() > PROPERTY_VALUE_MAX)
+                        throw py::value_error("property value too large");
+                    PROPERTY_SETTING setting = makePropertySetting(value.first, (EdsUInt32)0);
+                    setting.size = (EdsUInt32)data.size();
+                    memcpy(setting.data, data.data(), data.size());
+                    settings.push_back(setting);
+                } else {
+                    settings.push_back(makePropertySetting(value.first, value.second.cast<EdsUInt32>()));
+                }
+            }
+            py::gil_scoped_release release;
+            return controller.setProperties(settings);
+        }, py::arg("values"))
+        .def("get_property_desc", &CameraController::getPropertyDesc, py::call_guard<py::gil_scoped_release>())
+        .def("press_shutter_button", &CameraController::pressShutterButton, py::call_guard<py::gil_scoped_release>())
+        .def("take_picture", &CameraController::takePicture, py::call_guard<py::gil_scoped_release>())
+        .def("set_capacity", &CameraController::setCapacity, py::call_guard<py::gil_scoped_release>())
+        .def("set_save_to", [](CameraController &controller, EdsSaveTo saveTo) { return controller.setSaveTo(saveTo); },
+             py::call_guard<py::gil_scoped_release>())
+        .def("download", [](CameraController &controller, EdsBaseRef directoryItem) {
+            // The command releases its reference, the caller keeps theirs
+            EdsRetain(directoryItem);
+            return controller.download(directoryItem);
+        }, py::call_guard<py::gil_scoped_release>())
+        // Embedded thumbnail of a file on the camera, without downloading it
+        .def("get_thumbnail", [](CameraController &controller, EdsBaseRef directoryItem, bool decode, EdsUInt32 maxSize) {
+            std::vector<EdsError> errors;
+            std::vector<ThumbnailRef> thumbnails = fetchThumbnails(controller, std::vector<EdsBaseRef>(1, directoryItem), decode, maxSize, errors);
+            if (errors[0] != EDS_ERR_OK || !thumbnails[0])
+                throw std::runtime_error("EdsDownloadThumbnail failed: " + std::to_string(errors[0]));
+            return thumbnails[0];
+        }, py::arg("directory_item"), py::arg("decode") = false, py::arg("max_size") = 0, py::call_guard<py::gil_scoped_release>())
+        // In item order, None for items without a thumbnail
+        .def("get_thumbnails", [](CameraController &controller, const std::vector<EdsBaseRef> &directoryItems, bool decode, EdsUInt32 maxSize) {
+            std::vector<EdsError> errors;
+            return fetchThumbnails(controller, directoryItems, decode, maxSize, errors);
+        }, py::arg("directory_items"), py::arg("decode") = false, py::arg("max_size") = 0, py::call_guard<py::gil_scoped_release>())
+        .def("scan_storage", &CameraController::scanStorage, py::call_guard<py::gil_scoped_release>())
+        .def("close", &CameraController::close, py::call_guard<py::gil_scoped_release>())
+        .def("start_evf", &CameraController::startEvf, py::call_guard<py::gil_scoped_release>())
+        .def("end_evf", &CameraController::endEvf, py::call_guard<py::gil_scoped_release>())
+        .def("download_evf", &CameraController::downloadEvf, py::call_guard<py::gil_scoped_release>())
+        .def("drive_lens", &CameraController::driveLens, py::call_guard<py::gil_scoped_release>())
+        .def("set_evf_zoom", &CameraController::setEvfZoom, py::call_guard<py::gil_scoped_release>())
+        .def("set_evf_zoom_position", &CameraController::setEvfZoomPosition, py::call_guard<py::gil_scoped_release>())
+        .def("move_evf_zoom_position", &CameraController::moveEvfZoomPosition, py::arg("dx"), py::arg("dy"), py::call_guard<py::gil_scoped_release>())
+        .def("do_evf_af", &CameraController::doEvfAF, py::call_guard<py::gil_scoped_release>())
+        .def("get_dispatch_latency", &CameraController::getDispatchLatency)
+        .def("get_queue_depth", &CameraController::getQueueDepth)
+        .def("get_coalesced_count", &CameraController::getCoalescedCount)
+        .def("get_retry_policies", &CameraController::getRetryPolicies, py::return_value_policy::reference_internal)
+        .def("set_transfer_processor", &CameraController::setTransferProcessor, py::keep_alive<1, 2>())
+        .def("get_transfer_processor", &CameraController::getTransferProcessor, py::return_value_policy::reference_internal)
+        .def("get_transfer_statistics", &CameraController::getTransferStatistics)
+        .def("metrics", &CameraController::getMetrics, py::call_guard<py::gil_scoped_release>())
+        // Before run()
+        .def("set_startup_mode", &CameraController::setStartupMode)
+        .def("get_startup_mode", &CameraController::getStartupMode)
+        .def("set_placement", &CameraController::setPlacement, py::call_guard<py::gil_scoped_release>())
+        .def("get_placement", &CameraController::getPlacement)
+        // Queued on the processor; the handle, and callback(executed) on the
+        // processor thread, tell when each is done
+        .def("take_picture_async", [](CameraController &controller, py::object callback) {
+            return enqueueAsync(controller, new TakePictureCommand(controller.getCameraModel()), callback);
+        }, py::arg("callback") = py::none())
+        .def("press_shutter_button_async", [](CameraController &controller, EdsUInt32 status, py::object callback) {
+            return enqueueAsync(controller, new PressShutterButtonCommand(controller.getCameraModel(), status), callback);
+        }, py::arg("status"), py::arg("callback") = py::none())
+        .def("set_property_async", [](CameraController &controller, EdsPropertyID propertyID, EdsUInt32 value, py::object callback) {
+            return enqueueAsync(controller, new SetPropertyCommand<EdsUInt32>(controller.getCameraModel(), propertyID, value), callback);
+        }, py::arg("property_id"), py::arg("value"), py::arg("callback") = py::none())
+        .def("start_evf_async", [](CameraController &controller, py::object callback) {
+            return enqueueAsync(controller, new StartEvfCommand(controller.getCameraModel()), callback);
+        }, py::arg("callback") = py::none())
+        .def("end_evf_async", [](CameraController &controller, py::object callback) {
+            return enqueueAsync(controller, new EndEvfCommand(controller.getCameraModel()), callback);
+        }, py::arg("callback") = py::none())
+        .def("download_evf_async", [](CameraController &controller, py::object callback) {
+            return enqueueAsync(controller, new DownloadEvfCommand(controller.getCameraModel()), callback);
+        }, py::arg("callback") = py::none())
+        .def("drive_lens_async", [](CameraController &controller, EdsUInt32 step, py::object callback) {
+            return enqueueAsync(controller, new DriveLensCommand(controller.getCameraModel(), step), callback);
+        }, py::arg("step"), py::arg("callback") = py::none());
+
+    // --- Thread placement ---
+    py::class_<THREAD_PLACEMENT>(m, "ThreadPlacement")
+        .def(py::init([]() { return ThreadPlacement::any(); }))
+        .def_static("any", &ThreadPlacement::any)
+        .def_static("on_cores", &ThreadPlacement::onCores, py::arg("cores"))
+        .def_static("on_node", &ThreadPlacement::onNode, py::arg("node"))
+        .def_static("parse", [](const std::string &text) {
+            std::vector<int> cores;
+            if (!ThreadPlacement::parseCoreList(text.c_str(), cores))
+                throw py::value_error("Not a core list: " + text);
+            return ThreadPlacement::onCores(cores);
+        }, py::arg("core_list"))
+        .def_readwrite("numa_node", &THREAD_PLACEMENT::numaNode)
+        .def("add_core", [](THREAD_PLACEMENT &placement, int core) { ThreadPlacement::addCore(placement, core); })
+        .def("get_cores", [](const THREAD_PLACEMENT &placement) { return ThreadPlacement::getCores(placement); })
+        .def("is_any", [](const THREAD_PLACEMENT &placement) { return ThreadPlacement::isAny(placement); });
+
+    py::class_<CAMERA_PLACEMENT>(m, "CameraPlacement")
+        .def(py::init([](EdsUInt32 slot) { return ThreadPlacement::makeCameraPlacement(slot); }), py::arg("slot") = 0)
+        .def_property("name",
+            [](const CAMERA_PLACEMENT &placement) { return std::string(placement.name); },
+            [](CAMERA_PLACEMENT &placement, const std::string &name) {
+                strncpy(placement.name, name.c_str(), sizeof(placement.name) - 1);
+                placement.name[sizeof(placement.name) - 1] = '\0';
+            })
+        .def_readwrite("io", &CAMERA_PLACEMENT::io)
+        .def_readwrite("decode", &CAMERA_PLACEMENT::decode)
+        .def_readwrite("arena_buffers", &CAMERA_PLACEMENT::arenaBuffers)
+        .def_readwrite("arena_buffer_size", &CAMERA_PLACEMENT::arenaBufferSize);
+
+    m.def("get_core_count", &ThreadPlacement::getCoreCount);
+    m.def("get_numa_node_count", &ThreadPlacement::getNodeCount);
+    m.def("get_numa_node_cores", &ThreadPlacement::getNodeCores, py::arg("node"));
+
+    // --- Multi-camera sessions ---
+    py::class_<EdsDeviceInfo>(m, "EdsDeviceInfo")
+        .def_property_readonly("port_name", [](const EdsDeviceInfo &info) { return std::string(info.szPortName); })
+        .def_property_readonly("device_description", [](const EdsDeviceInfo &info) { return std::string(info.szDeviceDescription); })
+        .def_readonly("device_sub_type", &EdsDeviceInfo::deviceSubType);
+
+    py::class_<CameraSession, CameraSessionRef>(m, "CameraSession")
+        .def("open", &CameraSession::open)
+        .def("close", &CameraSession::close, py::call_guard<py::gil_scoped_release>())
+        .def("is_open", &CameraSession::isOpen)
+        .def_property_readonly("device_info", &CameraSession::getDeviceInfo)
+        .def_property_readonly("port_name", [](const CameraSession &session) { return std::string(session.getPortName()); })
+        .def_property_readonly("description", [](const CameraSession &session) { return std::string(session.getDescription()); })
+        .def("get_camera_model", &CameraSession::getCameraModel, py::return_value_policy::reference_internal)
+        .def("get_camera_controller", &CameraSession::getCameraController, py::return_value_policy::reference_internal)
+        .def_property_readonly("slot", &CameraSession::getSlot);
+
+    py::class_<CameraManager>(m, "CameraManager")
+        .def(py::init<>())
+        .def("initialize", &CameraManager::initialize, py::call_guard<py::gil_scoped_release>())
+        .def("terminate", &CameraManager::terminate, py::call_guard<py::gil_scoped_release>())
+        .def("is_initialized", &CameraManager::isInitialized)
+        .def("set_startup_mode", &CameraManager::setStartupMode)
+        .def("get_startup_mode", &CameraManager::getStartupMode)
+        // policy(slot, device_info) -> CameraPlacement, None for names only
+        .def("set_placement_policy", [](CameraManager &manager, py::object policy) {
+            if (policy.is_none())
+            {
+                manager.setPlacementPolicy(PlacementPolicy());
+                return;
+            }
+            std::shared_ptr<py::function> held(new py::function(policy.cast<py::function>()), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            manager.setPlacementPolicy([held](EdsUInt32 slot, const EdsDeviceInfo &deviceInfo) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    return (*held)(slot, deviceInfo).cast<CAMERA_PLACEMENT>();
+                }
+                catch (py::error_already_set &e)
+                {
+                    e.discard_as_unraisable("camera placement policy");
+                }
+                catch (py::cast_error &)
+                {
+                    PyErr_WarnEx(PyExc_RuntimeWarning, "placement policy did not return a CameraPlacement", 1);
+                }
+                return ThreadPlacement::makeCameraPlacement(slot);
+            });
+        }, py::arg("policy"))
+        .def("place_across_numa_nodes", [](CameraManager &manager, EdsUInt32 arenaBuffers, EdsUInt64 arenaBufferSize) {
+            manager.setPlacementPolicy(ThreadPlacement::spreadAcrossNodes(arenaBuffers, arenaBufferSize));
+        }, py::arg("arena_buffers") = 0, py::arg("arena_buffer_size") = 0)
+        .def("place_cores_per_camera", [](CameraManager &manager, int coresPerCamera, int firstCore, EdsUInt32 arenaBuffers, EdsUInt64 arenaBufferSize) {
+            manager.setPlacementPolicy(ThreadPlacement::coresPerCamera(coresPerCamera, firstCore, arenaBuffers, arenaBufferSize));
+        }, py::arg("cores_per_camera"), py::arg("first_core") = 0, py::arg("arena_buffers") = 0, py::arg("arena_buffer_size") = 0)
+        .def("enumerate", [](CameraManager &manager) {
+            std::vector<EdsDeviceInfo> devices;
+            EdsError err = manager.enumerate(devices);
+            if (err != EDS_ERR_OK)
+                throw std::runtime_error("EdsGetCameraList failed: " + std::to_string(err));
+            return devices;
+        })
+        .def("connect_all", &CameraManager::connectAll, py::call_guard<py::gil_scoped_release>())
+        .def("disconnect_all", &CameraManager::disconnectAll, py::call_guard<py::gil_scoped_release>())
+        .def("disconnect", &CameraManager::disconnect, py::call_guard<py::gil_scoped_release>())
+        .def("get_event", &CameraManager::getEvent, py::call_guard<py::gil_scoped_release>())
+        .def("get_session_count", &CameraManager::getSessionCount)
+        .def("get_session", &CameraManager::getSession)
+        .def("get_sessions", &CameraManager::getSessions)
+        .def("find_by_port", &CameraManager::findByPort)
+        .def("find_by_model", &CameraManager::findByModel)
+        .def("__len__", &CameraManager::getSessionCount)
+        .def("__getitem__", [](CameraManager &manager, size_t index) {
+            CameraSessionRef session = manager.getSession(index);
+            if (!session)
+                throw py::index_error();
+            return session;
+        });
+
+    // --- Process-wide SDK and session pool ---
+    py::class_<SDK_CONTEXT_STATISTICS>(m, "SdkContextStatistics")
+        .def_readonly("initializations", &SDK_CONTEXT_STATISTICS::initializations)
+        .def_readonly("sessions_opened", &SDK_CONTEXT_STATISTICS::sessionsOpened)
+        .def_readonly("leases", &SDK_CONTEXT_STATISTICS::leases)
+        .def_readonly("warm_leases", &SDK_CONTEXT_STATISTICS::warmLeases)
+        .def_readonly("active_leases", &SDK_CONTEXT_STATISTICS::activeLeases)
+        .def_readonly("open_sessions", &SDK_CONTEXT_STATISTICS::openSessions)
+        .def_readonly("last_lease_micros", &SDK_CONTEXT_STATISTICS::lastLeaseMicros);
+
+    py::class_<SessionLease, SessionLeaseRef>(m, "SessionLease")
+        .def_property_readonly("session", &SessionLease::getSession)
+        .def_property_readonly("active", &SessionLease::isActive)
+        .def_property_readonly("warm", &SessionLease::isWarm)
+        .def("release", &SessionLease::release, py::call_guard<py::gil_scoped_release>())
+        .def("__enter__", [](const SessionLeaseRef &lease) { return lease; })
+        .def("__exit__", [](SessionLease &lease, py::object, py::object, py::object) {
+            py::gil_scoped_release release;
+            lease.release();
+        });
+
+    py::class_<SdkContext, SdkContextRef>(m, "SdkContext")
+        // The one context of the process, initializing the SDK if needed
+        .def_static("acquire", []() {
+            EdsError err = EDS_ERR_OK;
+            SdkContextRef context = SdkContext::acquire(&err);
+            if (!context)
+                throw std::runtime_error("EdsInitializeSDK failed: " + std::to_string(err));
+            return context;
+        }, py::call_guard<py::gil_scoped_release>())
+        .def_static("is_alive", &SdkContext::isAlive)
+        .def_property_readonly("manager", &SdkContext::getManager, py::return_value_policy::reference_internal)
+        // Empty port name: any camera, preferring one no lease holds
+        .def("lease", [](SdkContext &context, const std::string &portName) {
+            SessionLeaseRef lease;
+            EdsError err = context.lease(portName, lease);
+            if (err != EDS_ERR_OK)
+                throw std::runtime_error("EdsOpenSession failed: " + std::to_string(err));
+            return lease;
+        }, py::arg("port_name") = std::string(), py::call_guard<py::gil_scoped_release>())
+        .def("close_idle", &SdkContext::closeIdle, py::call_guard<py::gil_scoped_release>())
+        .def("get_event", [](SdkContext &context) { return context.getManager().getEvent(); }, py::call_guard<py::gil_scoped_release>())
+        .def("get_statistics", &SdkContext::getStatistics);
+
+    // --- Hot-plug ---
+    py::enum_<HotPlugEventKind>(m, "HotPlugEventKind")
+        .value("ADDED", kHotPlug_Added)
+        .value("REMOVED", kHotPlug_Removed);
+
+    py::class_<HOTPLUG_EVENT>(m, "HotPlugEvent")
+        .def_readonly("kind", &HOTPLUG_EVENT::kind)
+        .def_readonly("device_info", &HOTPLUG_EVENT::deviceInfo)
+        .def_property_readonly("port_name", [](const HOTPLUG_EVENT &e) { return std::string(e.deviceInfo.szPortName); })
+        // None unless connected; already closed once removed
+        .def_readonly("session", &HOTPLUG_EVENT::session)
+        .def_readonly("micros", &HOTPLUG_EVENT::micros);
+
+    py::class_<HOTPLUG_DEVICE>(m, "HotPlugDevice")
+        .def_readonly("device_info", &HOTPLUG_DEVICE::deviceInfo)
+        .def_property_readonly("port_name", [](const HOTPLUG_DEVICE &device) { return std::string(device.deviceInfo.szPortName); })
+        .def_readonly("connected", &HOTPLUG_DEVICE::connected)
+        .def_readonly("added_micros", &HOTPLUG_DEVICE::addedMicros);
+
+    py::class_<HOTPLUG_STATISTICS>(m, "HotPlugStatistics")
+        .def_readonly("added", &HOTPLUG_STATISTICS::added)
+        .def_readonly("removed", &HOTPLUG_STATISTICS::removed)
+        .def_readonly("camera_added_events", &HOTPLUG_STATISTICS::cameraAddedEvents)
+        .def_readonly("shutdown_events", &HOTPLUG_STATISTICS::shutdownEvents)
+        .def_readonly("rescans", &HOTPLUG_STATISTICS::rescans)
+        .def_readonly("devices", &HOTPLUG_STATISTICS::devices);
+
+    py::class_<HotPlugMonitor>(m, "HotPlugMonitor")
+        .def(py::init<CameraManager&>(), py::keep_alive<1, 2>())
+        .def("set_auto_connect", &HotPlugMonitor::setAutoConnect)
+        // callback(HotPlugEvent), on the monitor thread
+        .def("add_listener", [](HotPlugMonitor &monitor, py::function callback) {
+            std::shared_ptr<py::function> held(new py::function(callback), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            monitor.addListener([held](const HOTPLUG_EVENT &e) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    (*held)(e);
+                }
+                catch (py::error_already_set &error)
+                {
+                    error.discard_as_unraisable("hot-plug listener");
+                }
+            });
+        })
+        .def("start", &HotPlugMonitor::start, py::call_guard<py::gil_scoped_release>())
+        .def("stop", &HotPlugMonitor::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &HotPlugMonitor::isRunning)
+        .def("get_devices", &HotPlugMonitor::getDevices, py::call_guard<py::gil_scoped_release>())
+        .def("get_statistics", &HotPlugMonitor::getStatistics, py::call_guard<py::gil_scoped_release>());
+
+    // --- Session recovery ---
+    py::class_<RECOVERY_EVENT>(m, "RecoveryEvent")
+        .def_readonly("session", &RECOVERY_EVENT::session)
+        .def_property_readonly("port_name", [](const RECOVERY_EVENT &e) { return std::string(e.portName); })
+        .def_property_readonly("serial_number", [](const RECOVERY_EVENT &e) { return std::string(e.serialNumber); })
+        .def_readonly("error", &RECOVERY_EVENT::error)
+        .def_readonly("lost_micros", &RECOVERY_EVENT::lostMicros)
+        .def_readonly("found_micros", &RECOVERY_EVENT::foundMicros)
+        .def_readonly("open_micros", &RECOVERY_EVENT::openMicros)
+        .def_readonly("resumed_micros", &RECOVERY_EVENT::resumedMicros)
+        .def_readonly("downtime_micros", &RECOVERY_EVENT::downtimeMicros)
+        .def_readonly("scans", &RECOVERY_EVENT::scans)
+        .def_readonly("restored", &RECOVERY_EVENT::restored)
+        .def_readonly("restore_failed", &RECOVERY_EVENT::restoreFailed)
+        .def_readonly("evf_restored", &RECOVERY_EVENT::evfRestored)
+        .def_readonly("replayed", &RECOVERY_EVENT::replayed);
+
+    py::class_<RECOVERY_STATISTICS>(m, "RecoveryStatistics")
+        .def_readonly("lost", &RECOVERY_STATISTICS::lost)
+        .def_readonly("recovered", &RECOVERY_STATISTICS::recovered)
+        .def_readonly("failed", &RECOVERY_STATISTICS::failed)
+        .def_readonly("recovering", &RECOVERY_STATISTICS::recovering)
+        .def_readonly("downtime", &RECOVERY_STATISTICS::downtime);
+
+    py::class_<SessionRecovery>(m, "SessionRecovery")
+        .def(py::init<CameraManager&>(), py::keep_alive<1, 2>())
+        .def("set_timeout", &SessionRecovery::setTimeout)
+        .def("get_timeout", &SessionRecovery::getTimeout)
+        .def("set_poll_interval", &SessionRecovery::setPollInterval)
+        .def("get_poll_interval", &SessionRecovery::getPollInterval)
+        .def("set_restore_properties", &SessionRecovery::setRestoreProperties)
+        .def("get_restore_properties", &SessionRecovery::getRestoreProperties)
+        .def("set_restore_evf", &SessionRecovery::setRestoreEvf)
+        // callback(RecoveryEvent), on the recovery thread
+        .def("add_listener", [](SessionRecovery &recovery, py::function callback) {
+            std::shared_ptr<py::function> held(new py::function(callback), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            recovery.addListener([held](const RECOVERY_EVENT &e) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    (*held)(e);
+                }
+                catch (py::error_already_set &error)
+                {
+                    error.discard_as_unraisable("recovery listener");
+                }
+            });
+        })
+        .def("start", &SessionRecovery::start, py::call_guard<py::gil_scoped_release>())
+        .def("stop", &SessionRecovery::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &SessionRecovery::isRunning)
+        .def("get_statistics", &SessionRecovery::getStatistics, py::call_guard<py::gil_scoped_release>())
+        .def("reset_statistics", &SessionRecovery::resetStatistics);
+
+    // --- Interval / burst sequencer ---
+    py::enum_<CaptureSchedule>(m, "CaptureSchedule")
+        .value("INTERVAL", kCaptureSchedule_Interval)
+        .value("BURST", kCaptureSchedule_Burst)
+        .value("BULB_RAMP", kCaptureSchedule_BulbRamp);
+
+    py::enum_<SequenceBusyPolicy>(m, "SequenceBusyPolicy")
+        .value("SKIP", kSequenceBusy_Skip)
+        .value("DELAY", kSequenceBusy_Delay);
+
+    py::enum_<SequenceShotStatus>(m, "SequenceShotStatus")
+        .value("DONE", kSequenceShot_Done)
+        .value("LATE", kSequenceShot_Late)
+        .value("SKIPPED", kSequenceShot_Skipped)
+        .value("BUSY", kSequenceShot_Busy)
+        .value("FAILED", kSequenceShot_Failed);
+
+    py::class_<SEQUENCE_SHOT>(m, "SequenceShot")
+        .def_readonly("index", &SEQUENCE_SHOT::index)
+        .def_readonly("status", &SEQUENCE_SHOT::status)
+        .def_readonly("error", &SEQUENCE_SHOT::error)
+        .def_readonly("scheduled_micros", &SEQUENCE_SHOT::scheduledMicros)
+        .def_readonly("dispatch_micros", &SEQUENCE_SHOT::dispatchMicros)
+        .def_readonly("lateness_micros", &SEQUENCE_SHOT::latenessMicros)
+        .def_readonly("command_micros", &SEQUENCE_SHOT::commandMicros)
+        .def_readonly("exposure_micros", &SEQUENCE_SHOT::exposureMicros);
+
+    py::class_<SEQUENCE_STATISTICS>(m, "SequenceStatistics")
+        .def_readonly("planned", &SEQUENCE_STATISTICS::planned)
+        .def_readonly("completed", &SEQUENCE_STATISTICS::completed)
+        .def_readonly("fired", &SEQUENCE_STATISTICS::fired)
+        .def_readonly("late", &SEQUENCE_STATISTICS::late)
+        .def_readonly("skipped", &SEQUENCE_STATISTICS::skipped)
+        .def_readonly("busy", &SEQUENCE_STATISTICS::busy)
+        .def_readonly("failed", &SEQUENCE_STATISTICS::failed)
+        .def_readonly("average_lateness_micros", &SEQUENCE_STATISTICS::averageLatenessMicros)
+        .def_readonly("max_lateness_micros", &SEQUENCE_STATISTICS::maxLatenessMicros)
+        .def_readonly("elapsed_micros", &SEQUENCE_STATISTICS::elapsedMicros);
+
+    py::class_<CaptureSequencer>(m, "CaptureSequencer")
+        .def(py::init<CameraController*, CameraModel*>(), py::keep_alive<1, 2>(), py::keep_alive<1, 3>())
+        .def("set_interval", &CaptureSequencer::setInterval, py::arg("count"), py::arg("interval_micros"))
+        .def("set_burst", &CaptureSequencer::setBurst, py::arg("count"), py::arg("spacing_micros") = 0)
+        .def("set_bulb_ramp", &CaptureSequencer::setBulbRamp,
+             py::arg("count"), py::arg("interval_micros"), py::arg("start_exposure_micros"), py::arg("end_exposure_micros"))
+        .def("set_busy_policy", &CaptureSequencer::setBusyPolicy)
+        .def("set_start_delay", &CaptureSequencer::setStartDelay)
+        .def("get_schedule", &CaptureSequencer::getSchedule)
+        .def("start", &CaptureSequencer::start)
+        .def("stop", &CaptureSequencer::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &CaptureSequencer::isRunning)
+        .def("wait", &CaptureSequencer::wait, py::arg("timeout_ms"), py::call_guard<py::gil_scoped_release>())
+        .def("pop_shot", [](CaptureSequencer &sequencer, int timeoutMs) -> py::object {
+            SEQUENCE_SHOT shot;
+            bool found;
+            {
+                py::gil_scoped_release release;
+                found = sequencer.popShot(shot, timeoutMs);
+            }
+            if (!found)
+                return py::none();
+            return py::cast(shot);
+        }, py::arg("timeout_ms") = 0)
+        .def("get_statistics", &CaptureSequencer::getStatistics);
+
+    // --- Synchronized multi-camera trigger ---
+    py::class_<SYNC_CAMERA_TIMING>(m, "SyncCameraTiming")
+        .def_readonly("error", &SYNC_CAMERA_TIMING::error)
+        .def_readonly("armed", &SYNC_CAMERA_TIMING::armed)
+        .def_readonly("fired", &SYNC_CAMERA_TIMING::fired)
+        .def_readonly("transferred", &SYNC_CAMERA_TIMING::transferred)
+        .def_readonly("dispatch_offset_micros", &SYNC_CAMERA_TIMING::dispatchOffsetMicros)
+        .def_readonly("call_micros", &SYNC_CAMERA_TIMING::callMicros)
+        .def_readonly("transfer_offset_micros", &SYNC_CAMERA_TIMING::transferOffsetMicros);
+
+    py::class_<SYNC_TRIGGER_RESULT>(m, "SyncTriggerResult")
+        .def(py::init<>())
+        .def_readonly("success", &SYNC_TRIGGER_RESULT::success)
+        .def_readonly("cameras", &SYNC_TRIGGER_RESULT::cameras)
+        .def_readonly("armed", &SYNC_TRIGGER_RESULT::armed)
+        .def_readonly("fired", &SYNC_TRIGGER_RESULT::fired)
+        .def_readonly("transferred", &SYNC_TRIGGER_RESULT::transferred)
+        .def_readonly("arm_micros", &SYNC_TRIGGER_RESULT::armMicros)
+        .def_readonly("dispatch_skew_micros", &SYNC_TRIGGER_RESULT::dispatchSkewMicros)
+        .def_readonly("transfer_skew_micros", &SYNC_TRIGGER_RESULT::transferSkewMicros)
+        .def_readonly("timings", &SYNC_TRIGGER_RESULT::timings);
+
+    py::enum_<ArmedShutterMode>(m, "ArmedShutterMode")
+        .value("HALF_PRESS", kArmedShutter_HalfPress)
+        .value("NON_AF", kArmedShutter_NonAF);
+
+    py::enum_<ArmedShutterState>(m, "ArmedShutterState")
+        .value("IDLE", kArmedShutter_Idle)
+        .value("ARMED", kArmedShutter_Armed)
+        .value("FIRING", kArmedShutter_Firing)
+        .value("FAILED", kArmedShutter_Failed);
+
+    py::class_<ARMED_SHUTTER_SHOT>(m, "ArmedShutterShot")
+        .def_readonly("index", &ARMED_SHUTTER_SHOT::index)
+        .def_readonly("error", &ARMED_SHUTTER_SHOT::error)
+        .def_readonly("command_micros", &ARMED_SHUTTER_SHOT::commandMicros)
+        .def_readonly("call_micros", &ARMED_SHUTTER_SHOT::callMicros)
+        .def_readonly("transfer_micros", &ARMED_SHUTTER_SHOT::transferMicros)
+        .def_readonly("lag_micros", &ARMED_SHUTTER_SHOT::lagMicros);
+
+    py::class_<ARMED_SHUTTER_STATISTICS>(m, "ArmedShutterStatistics")
+        .def_readonly("state", &ARMED_SHUTTER_STATISTICS::state)
+        .def_readonly("shots", &ARMED_SHUTTER_STATISTICS::shots)
+        .def_readonly("failed", &ARMED_SHUTTER_STATISTICS::failed)
+        .def_readonly("arm_micros", &ARMED_SHUTTER_STATISTICS::armMicros)
+        .def_readonly("call", &ARMED_SHUTTER_STATISTICS::call)
+        .def_readonly("lag", &ARMED_SHUTTER_STATISTICS::lag);
+
+    py::class_<ArmedShutter>(m, "ArmedShutter")
+        .def(py::init<CameraModel*, ArmedShutterMode>(), py::arg("model"), py::arg("mode") = kArmedShutter_HalfPress,
+             py::keep_alive<1, 2>())
+        .def("set_mode", &ArmedShutter::setMode)
+        .def("get_mode", &ArmedShutter::getMode)
+        .def("set_busy_policy", &ArmedShutter::setBusyPolicy)
+        .def("set_pump_events", &ArmedShutter::setPumpEvents)
+        .def("get_state", &ArmedShutter::getState)
+        .def("is_armed", &ArmedShutter::isArmed)
+        .def("arm", &ArmedShutter::arm, py::call_guard<py::gil_scoped_release>())
+        .def("disarm", &ArmedShutter::disarm, py::call_guard<py::gil_scoped_release>())
+        .def("fire", [](ArmedShutter &shutter, bool rearm) {
+            ARMED_SHUTTER_SHOT shot;
+            {
+                py::gil_scoped_release release;
+                shutter.fire(rearm, &shot);
+            }
+            return shot;
+        }, py::arg("rearm") = true)
+        // The shot with its lag, or None on timeout
+        .def("wait_for_transfer", [](ArmedShutter &shutter, EdsUInt32 timeoutMillis) -> py::object {
+            ARMED_SHUTTER_SHOT shot;
+            bool done;
+            {
+                py::gil_scoped_release release;
+                done = shutter.waitForTransfer(shot, timeoutMillis);
+            }
+            return done ? py::cast(shot) : py::none();
+        }, py::arg("timeout_ms") = (EdsUInt32)ArmedShutter::kDefaultTransferTimeoutMillis)
+        .def("get_last_shot", &ArmedShutter::getLastShot)
+        .def("get_statistics", &ArmedShutter::getStatistics)
+        .def("reset_statistics", &ArmedShutter::resetStatistics);
+
+    py::class_<SyncTrigger>(m, "SyncTrigger")
+        .def(py::init<>())
+        .def("set_half_press", &SyncTrigger::setHalfPress)
+        .def("set_lead", &SyncTrigger::setLead)
+        .def("set_arm_timeout", &SyncTrigger::setArmTimeout)
+        .def("set_barrier_timeout", &SyncTrigger::setBarrierTimeout)
+        .def("set_transfer_timeout", &SyncTrigger::setTransferTimeout)
+        .def("set_pump_events", &SyncTrigger::setPumpEvents)
+        .def("fire", [](SyncTrigger &trigger, CameraManager &manager) {
+            SYNC_TRIGGER_RESULT result;
+            trigger.fire(manager, result);
+            return result;
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("fire", [](SyncTrigger &trigger, const std::vector<CameraSessionRef> &sessions) {
+            SYNC_TRIGGER_RESULT result;
+            trigger.fire(sessions, result);
+            return result;
+        }, py::call_guard<py::gil_scoped_release>());
 
     // --- Processor ---
+    py::enum_<CommandPriority>(m, "CommandPriority")
+        .value("REALTIME", kCommandPriority_Realtime)
+        .value("NORMAL", kCommandPriority_Normal)
+        .value("BACKGROUND", kCommandPriority_Background);
+
+    py::class_<DISPATCH_LATENCY>(m, "DispatchLatency")
+        .def(py::init<>())
+        .def_readonly("count", &DISPATCH_LATENCY::count)
+        .def_readonly("last_micros", &DISPATCH_LATENCY::lastMicros)
+        .def_readonly("average_micros", &DISPATCH_LATENCY::averageMicros)
+        .def_readonly("max_micros", &DISPATCH_LATENCY::maxMicros);
+
+    py::enum_<RetryErrorClass>(m, "RetryErrorClass")
+        .value("BUSY", kRetryError_Busy)
+        .value("NOT_READY", kRetryError_NotReady)
+        .value("OTHER", kRetryError_Other);
+
+    py::class_<RETRY_POLICY>(m, "RetryPolicy")
+        .def(py::init([](EdsUInt32 initialDelayMillis, double factor, EdsUInt32 maxDelayMillis, double jitter, EdsUInt32 maxAttempts, EdsUInt32 deadlineMillis) {
+            return RetryPolicyTable::makePolicy(initialDelayMillis, factor, maxDelayMillis, jitter, maxAttempts, deadlineMillis);
+        }), py::arg("initial_delay_ms") = 500, py::arg("factor") = 1.0, py::arg("max_delay_ms") = 500,
+            py::arg("jitter") = 0.0, py::arg("max_attempts") = 0, py::arg("deadline_ms") = 0)
+        .def_readwrite("initial_delay_ms", &RETRY_POLICY::initialDelayMillis)
+        .def_readwrite("factor", &RETRY_POLICY::factor)
+        .def_readwrite("max_delay_ms", &RETRY_POLICY::maxDelayMillis)
+        .def_readwrite("jitter", &RETRY_POLICY::jitter)
+        .def_readwrite("max_attempts", &RETRY_POLICY::maxAttempts)
+        .def_readwrite("deadline_ms", &RETRY_POLICY::deadlineMillis);
+
+    py::class_<RetryPolicyTable>(m, "RetryPolicyTable")
+        .def_static("class_of", &RetryPolicyTable::classOf)
+        .def("set_default", &RetryPolicyTable::setDefault)
+        .def("get_default", &RetryPolicyTable::getDefault)
+        .def("set_policy", &RetryPolicyTable::setPolicy)
+        .def("clear_policy", &RetryPolicyTable::clearPolicy)
+        .def("get_policy", [](const RetryPolicyTable &table, const std::string &name, RetryErrorClass errorClass) {
+            return table.getPolicy(name.c_str(), errorClass);
+        });
+
     py::class_<Processor, Thread>(m, "Processor")
         .def(py::init<>())
         .def("set_close_command", &Processor::setCloseCommand)
-        .def("enqueue", &Processor::enqueue)
+        .def("enqueue", py::overload_cast<Command*>(&Processor::enqueue))
+        .def("enqueue", py::overload_cast<Command*, CommandPriority>(&Processor::enqueue))
         .def("stop", &Processor::stop)
         .def("clear", &Processor::clear)
-        .def("run", &Processor::run);
+        .def("run", &Processor::run, py::call_guard<py::gil_scoped_release>())
+        .def("set_retry_interval", &Processor::setRetryInterval)
+        .def("get_retry_interval", &Processor::getRetryInterval)
+        .def("get_retry_policies", &Processor::getRetryPolicies, py::return_value_policy::reference_internal)
+        .def("set_starvation_limit", &Processor::setStarvationLimit)
+        .def("get_starvation_limit", &Processor::getStarvationLimit)
+        .def("get_queue_depth", &Processor::getQueueDepth)
+        .def("get_retry_depth", &Processor::getRetryDepth)
+        .def("get_coalesced_count", &Processor::getCoalescedCount)
+        .def("get_dispatch_latency", &Processor::getDispatchLatency)
+        .def("get_command_metrics", [](Processor &processor) {
+            return processor.getMetrics().getCommandMetrics();
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("purge", &Processor::purge);
+
+    py::class_<TRANSFER_STATISTICS>(m, "TransferStatistics")
+        .def_readonly("completed", &TRANSFER_STATISTICS::completed)
+        .def_readonly("failed", &TRANSFER_STATISTICS::failed)
+        .def_readonly("bytes", &TRANSFER_STATISTICS::bytes)
+        .def_readonly("busy_micros", &TRANSFER_STATISTICS::busyMicros)
+        .def_readonly("last_bytes", &TRANSFER_STATISTICS::lastBytes)
+        .def_readonly("last_micros", &TRANSFER_STATISTICS::lastMicros)
+        .def_readonly("last_bytes_per_second", &TRANSFER_STATISTICS::lastBytesPerSecond)
+        .def_readonly("average_bytes_per_second", &TRANSFER_STATISTICS::averageBytesPerSecond)
+        .def_readonly("queue_depth", &TRANSFER_STATISTICS::queueDepth)
+        .def_readonly("active", &TRANSFER_STATISTICS::active);
+
+    py::class_<TRANSFER_PROGRESS>(m, "TransferProgress")
+        .def_readonly("id", &TRANSFER_PROGRESS::id)
+        .def_readonly("camera", &TRANSFER_PROGRESS::camera)
+        .def_readonly("file_name", &TRANSFER_PROGRESS::fileName)
+        .def_readonly("total_bytes", &TRANSFER_PROGRESS::totalBytes)
+        .def_readonly("transferred_bytes", &TRANSFER_PROGRESS::transferredBytes)
+        .def_readonly("percent", &TRANSFER_PROGRESS::percent)
+        .def_readonly("bytes_per_second", &TRANSFER_PROGRESS::bytesPerSecond)
+        .def_readonly("eta_micros", &TRANSFER_PROGRESS::etaMicros)
+        .def_readonly("start_micros", &TRANSFER_PROGRESS::startMicros)
+        .def_readonly("elapsed_micros", &TRANSFER_PROGRESS::elapsedMicros)
+        .def_readonly("cancel_requested", &TRANSFER_PROGRESS::cancelRequested);
+
+    py::class_<CAMERA_TRANSFER_PROGRESS>(m, "CameraTransferProgress")
+        .def_readonly("camera", &CAMERA_TRANSFER_PROGRESS::camera)
+        .def_readonly("active_transfers", &CAMERA_TRANSFER_PROGRESS::activeTransfers)
+        .def_readonly("total_bytes", &CAMERA_TRANSFER_PROGRESS::totalBytes)
+        .def_readonly("transferred_bytes", &CAMERA_TRANSFER_PROGRESS::transferredBytes)
+        .def_readonly("bytes_per_second", &CAMERA_TRANSFER_PROGRESS::bytesPerSecond)
+        .def_readonly("eta_micros", &CAMERA_TRANSFER_PROGRESS::etaMicros)
+        .def_readonly("completed_files", &CAMERA_TRANSFER_PROGRESS::completedFiles)
+        .def_readonly("completed_bytes", &CAMERA_TRANSFER_PROGRESS::completedBytes)
+        .def_readonly("failed_files", &CAMERA_TRANSFER_PROGRESS::failedFiles)
+        .def_readonly("cancelled_files", &CAMERA_TRANSFER_PROGRESS::cancelledFiles);
+
+    py::class_<TRANSFER_PROGRESS_SNAPSHOT>(m, "TransferProgressSnapshot")
+        .def_readonly("timestamp_micros", &TRANSFER_PROGRESS_SNAPSHOT::timestampMicros)
+        .def_readonly("transfers", &TRANSFER_PROGRESS_SNAPSHOT::transfers)
+        .def_readonly("cameras", &TRANSFER_PROGRESS_SNAPSHOT::cameras)
+        .def_readonly("total_bytes", &TRANSFER_PROGRESS_SNAPSHOT::totalBytes)
+        .def_readonly("transferred_bytes", &TRANSFER_PROGRESS_SNAPSHOT::transferredBytes)
+        .def_readonly("bytes_per_second", &TRANSFER_PROGRESS_SNAPSHOT::bytesPerSecond)
+        .def_readonly("eta_micros", &TRANSFER_PROGRESS_SNAPSHOT::etaMicros);
+
+    // The downloads of every camera in the process
+    m.def("get_transfer_progress", []() { return TransferProgressTracker::instance().snapshot(); });
+    m.def("set_transfer_progress_rate", [](double perSecond) { TransferProgressTracker::instance().setMaxRate(perSecond); },
+          py::arg("per_second"));
+    m.def("get_transfer_progress_rate", []() { return TransferProgressTracker::instance().getMaxRate(); });
+    m.def("cancel_transfer", [](EdsUInt64 id) { return TransferProgressTracker::instance().cancel(id); }, py::arg("id"));
+    m.def("cancel_transfers", [](const CameraModel *model) { return TransferProgressTracker::instance().cancelAll(model); },
+          py::arg("model") = nullptr);
+    m.def("reset_transfer_progress", []() { TransferProgressTracker::instance().resetStatistics(); });
+    // callback(TransferProgressSnapshot), on a transfer thread, at most the rate a second
+    m.def("add_transfer_progress_listener", [](py::function callback) {
+        std::shared_ptr<py::function> held(new py::function(callback), [](py::function *function) {
+            py::gil_scoped_acquire gil;
+            delete function;
+        });
+        TransferProgressTracker::instance().addListener([held](const TRANSFER_PROGRESS_SNAPSHOT &snapshot) {
+            py::gil_scoped_acquire gil;
+            try
+            {
+                (*held)(snapshot);
+            }
+            catch (py::error_already_set &error)
+            {
+                error.discard_as_unraisable("transfer progress listener");
+            }
+        });
+    });
+    m.def("clear_transfer_progress_listeners", []() {
+        TransferProgressTracker::instance().clearListeners();
+    }, py::call_guard<py::gil_scoped_release>());
+
+    // --- Property desc cache ---
+    py::class_<PROPERTY_DESC_CACHE_STATISTICS>(m, "PropertyDescCacheStatistics")
+        .def_readonly("capacity", &PROPERTY_DESC_CACHE_STATISTICS::capacity)
+        .def_readonly("records", &PROPERTY_DESC_CACHE_STATISTICS::records)
+        .def_readonly("hits", &PROPERTY_DESC_CACHE_STATISTICS::hits)
+        .def_readonly("verified", &PROPERTY_DESC_CACHE_STATISTICS::verified)
+        .def_readonly("changed", &PROPERTY_DESC_CACHE_STATISTICS::changed)
+        .def_readonly("misses", &PROPERTY_DESC_CACHE_STATISTICS::misses)
+        .def_readonly("preloaded", &PROPERTY_DESC_CACHE_STATISTICS::preloaded);
+
+    // Shared by every session in the process, off until opened
+    m.def("open_property_desc_cache", [](const std::string &path, EdsUInt32 capacity) {
+        return PropertyDescCache::instance().open(path, capacity);
+    }, py::arg("path"), py::arg("capacity") = (EdsUInt32)PropertyDescCache::kDefaultCapacity);
+    m.def("close_property_desc_cache", []() { PropertyDescCache::instance().close(); });
+    m.def("clear_property_desc_cache", []() { PropertyDescCache::instance().clear(); });
+    m.def("set_property_desc_verify_interval", [](EdsUInt64 seconds) { PropertyDescCache::instance().setVerifyInterval(seconds); },
+          py::arg("seconds"));
+    m.def("get_property_desc_verify_interval", []() { return PropertyDescCache::instance().getVerifyInterval(); });
+    m.def("get_property_desc_cache_statistics", []() { return PropertyDescCache::instance().getStatistics(); });
+    m.def("reset_property_desc_cache_statistics", []() { PropertyDescCache::instance().resetStatistics(); });
+
+    // One worker can serve several cameras' controllers.
+    py::class_<TransferProcessor, Processor>(m, "TransferProcessor")
+        .def(py::init<>())
+        .def("get_statistics", &TransferProcessor::getStatistics)
+        .def("reset_statistics", &TransferProcessor::resetStatistics);
+
+    // --- Metrics ---
+    py::class_<LATENCY_SNAPSHOT>(m, "LatencySnapshot")
+        .def_readonly("count", &LATENCY_SNAPSHOT::count)
+        .def_readonly("total_micros", &LATENCY_SNAPSHOT::totalMicros)
+        .def_readonly("min_micros", &LATENCY_SNAPSHOT::minMicros)
+        .def_readonly("max_micros", &LATENCY_SNAPSHOT::maxMicros)
+        .def_property_readonly("average_micros", [](const LATENCY_SNAPSHOT &snapshot) {
+            return snapshot.count != 0 ? (double)snapshot.totalMicros / (double)snapshot.count : 0.0;
+        })
+        // Non-empty buckets as (upper_bound_micros, count)
+        .def_property_readonly("buckets", [](const LATENCY_SNAPSHOT &snapshot) {
+            py::list buckets;
+            for(size_t i = 0; i < snapshot.buckets.size(); i++)
+            {
+                if(snapshot.buckets[i] != 0)
+                {
+                    buckets.append(py::make_tuple(LatencyHistogram::bucketUpperMicros((int)i), snapshot.buckets[i]));
+                }
+            }
+            return buckets;
+        })
+        .def("percentile", [](const LATENCY_SNAPSHOT &snapshot, double fraction) {
+            return LatencyHistogram::percentile(snapshot, fraction);
+        }, py::arg("fraction"));
+
+    py::class_<COMMAND_METRICS>(m, "CommandMetrics")
+        .def_property_readonly("name", [](const COMMAND_METRICS &metrics) { return std::string(metrics.name); })
+        .def_readonly("executions", &COMMAND_METRICS::executions)
+        .def_readonly("completed", &COMMAND_METRICS::completed)
+        .def_readonly("errors", &COMMAND_METRICS::errors)
+        .def_readonly("busy_retries", &COMMAND_METRICS::busyRetries)
+        .def_readonly("not_ready_retries", &COMMAND_METRICS::notReadyRetries)
+        .def_readonly("other_retries", &COMMAND_METRICS::otherRetries)
+        .def_readonly("abandoned", &COMMAND_METRICS::abandoned)
+        .def_readonly("execute_latency", &COMMAND_METRICS::executeLatency);
+
+    py::enum_<StartupMode>(m, "StartupMode")
+        .value("EAGER", kStartupMode_Eager)
+        .value("LAZY", kStartupMode_Lazy);
+
+    // Steady clock microseconds, 0 until reached
+    py::class_<STARTUP_TIMING>(m, "StartupTiming")
+        .def_readonly("mode", &STARTUP_TIMING::mode)
+        .def_readonly("start_micros", &STARTUP_TIMING::startMicros)
+        .def_readonly("session_open_micros", &STARTUP_TIMING::sessionOpenMicros)
+        .def_readonly("first_frame_micros", &STARTUP_TIMING::firstFrameMicros)
+        .def_readonly("time_to_first_frame_micros", &STARTUP_TIMING::timeToFirstFrameMicros)
+        .def_readonly("properties_fetched", &STARTUP_TIMING::propertiesFetched);
+
+    py::class_<CONTROLLER_METRICS>(m, "ControllerMetrics")
+        .def_readonly("commands", &CONTROLLER_METRICS::commands)
+        .def_readonly("transfer_commands", &CONTROLLER_METRICS::transferCommands)
+        .def_readonly("dispatch_latency", &CONTROLLER_METRICS::dispatchLatency)
+        .def_readonly("transfer_dispatch_latency", &CONTROLLER_METRICS::transferDispatchLatency)
+        // Waiting commands per CommandPriority lane
+        .def_property_readonly("queue_depth", [](const CONTROLLER_METRICS &metrics) {
+            py::list depths;
+            for(int lane = 0; lane < kCommandPriority_Count; lane++)
+            {
+                depths.append(metrics.queueDepth[lane]);
+            }
+            return depths;
+        })
+        .def_readonly("retry_depth", &CONTROLLER_METRICS::retryDepth)
+        .def_readonly("transfer", &CONTROLLER_METRICS::transfer)
+        .def_readonly("evf_frames", &CONTROLLER_METRICS::evfFrames)
+        .def_readonly("evf_frames_per_second", &CONTROLLER_METRICS::evfFramesPerSecond)
+        .def_readonly("evf_bytes_per_second", &CONTROLLER_METRICS::evfBytesPerSecond)
+        .def_readonly("coalesced", &CONTROLLER_METRICS::coalesced)
+        .def_readonly("capture_pool", &CONTROLLER_METRICS::capturePool)
+        .def_readonly("startup", &CONTROLLER_METRICS::startup);
+
+    // --- Tracing ---
+    // Spans of commands, SDK calls, callbacks and observers, for
+    // chrome://tracing or ui.perfetto.dev
+    m.def("trace_start", [](size_t eventsPerThread) { Tracer::instance().start(eventsPerThread); },
+          py::arg("events_per_thread") = (size_t)Tracer::kDefaultEventsPerThread);
+    m.def("trace_stop", []() { Tracer::instance().stop(); });
+    m.def("trace_clear", []() { Tracer::instance().clear(); });
+    m.def("trace_enabled", &Tracer::isEnabled);
+    m.def("trace_dropped", []() { return Tracer::instance().getDropped(); });
+    m.def("trace_export", []() { return Tracer::instance().exportChromeTrace(); },
+          py::call_guard<py::gil_scoped_release>());
+    m.def("trace_write", [](const std::string &path) { return Tracer::instance().writeChromeTrace(path.c_str()); },
+          py::arg("path"), py::call_guard<py::gil_scoped_release>());
+    m.def("trace_set_thread_name", [](const std::string &name) { Tracer::instance().setThreadName(name.c_str()); },
+          py::arg("name"));
+
+    // with edsdk.TraceSpan("decode"): ... records a span on the calling thread
+    struct PythonTraceSpan
+    {
+        const char* name;
+        EdsUInt64 begin;
+        bool active;
+    };
+    py::class_<PythonTraceSpan>(m, "TraceSpan")
+        .def(py::init([](const std::string &name) {
+            PythonTraceSpan span = { Tracer::instance().intern(name), 0, false };
+            return span;
+        }), py::arg("name"))
+        .def("__enter__", [](PythonTraceSpan &span) -> PythonTraceSpan& {
+            span.active = Tracer::isEnabled();
+            span.begin = span.active ? Tracer::nowMicros() : 0;
+            return span;
+        }, py::return_value_policy::reference)
+        .def("__exit__", [](PythonTraceSpan &span, py::object, py::object, py::object) {
+            if(span.active)
+            {
+                Tracer::instance().record("Python", span.name, span.begin, Tracer::nowMicros() - span.begin);
+            }
+            return false;
+        });
 
     // ==========================================================================
     // 2. COMMAND PATTERN CLASSES
     // ==========================================================================
     
     // --- Base Command ---
+    py::enum_<CommandStatus>(m, "CommandStatus")
+        .value("PENDING", kCommandStatus_Pending)
+        .value("COMPLETED", kCommandStatus_Completed)
+        .value("DROPPED", kCommandStatus_Dropped);
+
+    py::class_<COMMAND_TIMING>(m, "CommandTiming")
+        .def_readonly("enqueue_micros", &COMMAND_TIMING::enqueueMicros)
+        .def_readonly("first_execute_micros", &COMMAND_TIMING::firstExecuteMicros)
+        .def_readonly("complete_micros", &COMMAND_TIMING::completeMicros)
+        .def_readonly("executions", &COMMAND_TIMING::executions)
+        .def_readonly("retry_micros", &COMMAND_TIMING::retryMicros);
+
+    py::class_<CommandHandle, CommandHandleRef>(m, "CommandHandle")
+        .def("get_status", &CommandHandle::getStatus)
+        .def("get_error", &CommandHandle::getError)
+        .def("is_done", &CommandHandle::isDone)
+        .def("succeeded", &CommandHandle::succeeded)
+        .def("get_timing", &CommandHandle::getTiming)
+        .def("wait", &CommandHandle::wait, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>());
+
     py::class_<Command>(m, "Command")
-        .def("execute", &Command::execute);
+        .def("execute", &Command::execute, py::call_guard<py::gil_scoped_release>());
 
     // --- Camera Operation Commands ---
     py::class_<TakePictureCommand, Command>(m, "TakePictureCommand")
@@ -153,7 +1265,7 @@ PYBIND11_MODULE(edsdk_bindings, m) {
         .def(py::init<CameraModel*>());
         
     py::class_<SaveSettingCommand, Command>(m, "SaveSettingCommand")
-        .def(py::init<CameraModel*>());
+        .def(py::init([](CameraModel *model, EdsUInt32 saveTo) { return new SaveSettingCommand(model, (EdsSaveTo)saveTo); }));
 
     // --- EVF Commands ---
     py::class_<StartEvfCommand, Command>(m, "StartEvfCommand")
@@ -164,13 +1276,731 @@ PYBIND11_MODULE(edsdk_bindings, m) {
         
     py::class_<DownloadEvfCommand, Command>(m, "DownloadEvfCommand")
         .def(py::init<CameraModel*>());
+
+    // --- Live view stream pool ---
+    py::class_<EVF_POOL_STATISTICS>(m, "EvfPoolStatistics")
+        .def_readonly("hits", &EVF_POOL_STATISTICS::hits)
+        .def_readonly("misses", &EVF_POOL_STATISTICS::misses)
+        .def_readonly("pool_size", &EVF_POOL_STATISTICS::poolSize)
+        .def_readonly("buffer_size", &EVF_POOL_STATISTICS::bufferSize)
+        .def_readonly("available", &EVF_POOL_STATISTICS::available);
+
+    py::class_<EvfStreamPool, EvfStreamPoolRef>(m, "EvfStreamPool")
+        .def("preallocate", &EvfStreamPool::preallocate)
+        .def("set_pool_size", &EvfStreamPool::setPoolSize)
+        .def("get_pool_size", &EvfStreamPool::getPoolSize)
+        .def("set_buffer_size", &EvfStreamPool::setBufferSize)
+        .def("get_buffer_size", &EvfStreamPool::getBufferSize)
+        .def("get_statistics", &EvfStreamPool::getStatistics)
+        .def("reset_statistics", &EvfStreamPool::resetStatistics)
+        .def("clear", &EvfStreamPool::clear);
+
+    // --- Live view frame ---
+    py::class_<EVF_TIMING>(m, "EvfTiming")
+        .def_readonly("download_start", &EVF_TIMING::downloadStart)
+        .def_readonly("download_end", &EVF_TIMING::downloadEnd)
+        .def_readonly("queued", &EVF_TIMING::queued)
+        .def_readonly("decode_start", &EVF_TIMING::decodeStart)
+        .def_readonly("decode_end", &EVF_TIMING::decodeEnd)
+        .def_readonly("delivered", &EVF_TIMING::delivered);
+
+    py::class_<EvfFrameSink>(m, "EvfFrameSink");
+
+    // Exposes the JPEG stream memory directly; memoryview/np.frombuffer
+    // keep the frame (and its EdsStreamRef) alive without copying.
+    py::enum_<EvfMetadataField>(m, "EvfMetadataField", py::arithmetic())
+        .value("ZOOM", kEvfMetadata_Zoom)
+        .value("IMAGE_POSITION", kEvfMetadata_ImagePosition)
+        .value("HISTOGRAM", kEvfMetadata_Histogram)
+        .value("ZOOM_RECT", kEvfMetadata_ZoomRect)
+        .value("COORDINATE_SYSTEM", kEvfMetadata_CoordinateSystem)
+        .value("ALL", kEvfMetadata_All);
+
+    py::class_<EVF_METADATA_STATISTICS>(m, "EvfMetadataStatistics")
+        .def_readonly("frames", &EVF_METADATA_STATISTICS::frames)
+        .def_readonly("reads", &EVF_METADATA_STATISTICS::reads)
+        .def_readonly("skipped", &EVF_METADATA_STATISTICS::skipped);
+
+    py::class_<EvfMetadataCache>(m, "EvfMetadataCache")
+        .def("set_fields", &EvfMetadataCache::setFields, py::arg("every_frame"), py::arg("on_change"))
+        .def("get_every_frame", &EvfMetadataCache::getEveryFrame)
+        .def("get_on_change", &EvfMetadataCache::getOnChange)
+        .def("set_refresh_frames", &EvfMetadataCache::setRefreshFrames)
+        .def("get_refresh_frames", &EvfMetadataCache::getRefreshFrames)
+        .def("request", &EvfMetadataCache::request)
+        .def("invalidate", &EvfMetadataCache::invalidate)
+        .def("get_statistics", &EvfMetadataCache::getStatistics);
+
+    py::class_<EvfFrame, EvfFrameRef>(m, "EvfFrame", py::buffer_protocol())
+        .def_buffer([](EvfFrame &frame) -> py::buffer_info {
+            return py::buffer_info(
+                const_cast<unsigned char*>(frame.getData()),
+                1, py::format_descriptor<unsigned char>::format(), 1,
+                { static_cast<py::ssize_t>(frame.getLength()) }, { 1 },
+                true);
+        })
+        .def("__len__", [](const EvfFrame &frame) { return static_cast<size_t>(frame.getLength()); })
+        .def_property_readonly("sequence", &EvfFrame::getSequence)
+        .def_property_readonly("timing", [](const EvfFrame &frame) { return frame.getDataSet().timing; })
+        .def_property_readonly("zoom", &EvfFrame::getZoom)
+        .def_property_readonly("zoom_rect", &EvfFrame::getZoomRect)
+        .def_property_readonly("image_position", &EvfFrame::getImagePosition)
+        .def_property_readonly("size_jpeg_large", &EvfFrame::getSizeJpegLarge)
+        .def_property_readonly("metadata", &EvfFrame::getMetadata)
+        // Camera histogram as a read-only (256, 4) view, columns Y, R, G, B.
+        .def_property_readonly("histogram", [](py::object self) {
+            const EvfFrame &frame = self.cast<const EvfFrame&>();
+            py::array_t<EdsUInt32> histogram({ 256, 4 }, { 4 * sizeof(EdsUInt32), sizeof(EdsUInt32) },
+                                             frame.getHistogram(), self);
+            histogram.attr("setflags")(py::arg("write") = false);
+            return histogram;
+        });
+
+    // --- JPEG decode ---
+    py::enum_<JpegPixelFormat>(m, "JpegPixelFormat")
+        .value("RGB", kJpegPixelFormat_RGB)
+        .value("BGR", kJpegPixelFormat_BGR)
+        .value("GRAY", kJpegPixelFormat_Gray);
+
+    // Gray images are 2-D (height, width), colour ones (height, width, 3).
+    py::class_<DecodedImage, DecodedImageRef>(m, "DecodedImage", py::buffer_protocol())
+        .def_buffer([](DecodedImage &image) -> py::buffer_info {
+            if (image.getChannels() == 1)
+                return py::buffer_info(image.getPixels(), 1, py::format_descriptor<unsigned char>::format(), 2,
+                    { image.getHeight(), image.getWidth() },
+                    { image.getStride(), 1 });
+            return py::buffer_info(image.getPixels(), 1, py::format_descriptor<unsigned char>::format(), 3,
+                { image.getHeight(), image.getWidth(), image.getChannels() },
+                { image.getStride(), image.getChannels(), 1 });
+        })
+        .def_property_readonly("width", &DecodedImage::getWidth)
+        .def_property_readonly("height", &DecodedImage::getHeight)
+        .def_property_readonly("channels", &DecodedImage::getChannels)
+        .def_property_readonly("origin_x", &DecodedImage::getOriginX)
+        .def_property_readonly("origin_y", &DecodedImage::getOriginY)
+        .def_property_readonly("format", &DecodedImage::getFormat);
+
+    m.def("jpeg_available", &JpegDecoder::isAvailable);
+
+    // Accepts anything exposing a byte buffer (EvfFrame, bytes, numpy).
+    m.def("decode_jpeg", [](py::buffer data, JpegPixelFormat format, int scale) -> DecodedImageRef {
+        py::buffer_info info = data.request();
+        DecodedImageRef image = std::make_shared<DecodedImage>();
+        bool decoded = false;
+        std::string error;
+        {
+            py::gil_scoped_release release;
+            static thread_local JpegDecoder decoder;
+            decoded = decoder.decode(static_cast<const unsigned char*>(info.ptr),
+                                     (size_t)(info.size * info.itemsize), *image, format, scale);
+            if (!decoded)
+                error = decoder.getLastError();
+        }
+        if (!decoded)
+            throw std::runtime_error("JPEG decode failed: " + error);
+        return image;
+    }, py::arg("data"), py::arg("format") = kJpegPixelFormat_RGB, py::arg("scale") = 1);
+
+    m.def("decode_jpeg_region", [](py::buffer data, int x, int y, int width, int height, JpegPixelFormat format, int scale) -> DecodedImageRef {
+        py::buffer_info info = data.request();
+        DecodedImageRef image = std::make_shared<DecodedImage>();
+        bool decoded = false;
+        std::string error;
+        {
+            py::gil_scoped_release release;
+            static thread_local JpegDecoder decoder;
+            decoded = decoder.decodeRegion(static_cast<const unsigned char*>(info.ptr),
+                                           (size_t)(info.size * info.itemsize), *image, x, y, width, height, format, scale);
+            if (!decoded)
+                error = decoder.getLastError();
+        }
+        if (!decoded)
+            throw std::runtime_error("JPEG decode failed: " + error);
+        return image;
+    }, py::arg("data"), py::arg("x"), py::arg("y"), py::arg("width"), py::arg("height"),
+       py::arg("format") = kJpegPixelFormat_RGB, py::arg("scale") = 1);
+
+    py::enum_<EvfCoordinateSpace>(m, "EvfCoordinateSpace")
+        .value("IMAGE", kEvfCoordinate_Image)
+        .value("JPEG_LARGE", kEvfCoordinate_JpegLarge);
+
+    // Region defaults to the frame's own zoom rect.
+    m.def("decode_evf_region", [](EvfFrameRef frame, py::object region, EvfCoordinateSpace space, JpegPixelFormat format, int scale) -> DecodedImageRef {
+        EdsRect rect = region.is_none() ? frame->getZoomRect() : region.cast<EdsRect>();
+        if (region.is_none())
+            space = kEvfCoordinate_JpegLarge;
+        DecodedImageRef image = std::make_shared<DecodedImage>();
+        bool decoded = false;
+        std::string error;
+        {
+            py::gil_scoped_release release;
+            static thread_local JpegDecoder decoder;
+            decoded = decodeEvfRegion(decoder, *frame, rect, space, *image, format, scale);
+            if (!decoded)
+                error = decoder.getLastError();
+        }
+        if (!decoded)
+            throw std::runtime_error("JPEG decode failed: " + error);
+        return image;
+    }, py::arg("frame"), py::arg("region") = py::none(), py::arg("space") = kEvfCoordinate_JpegLarge,
+       py::arg("format") = kJpegPixelFormat_RGB, py::arg("scale") = 1);
+
+    // --- Image statistics ---
+    py::enum_<ImageChannel>(m, "ImageChannel")
+        .value("RED", kImageChannel_Red)
+        .value("GREEN", kImageChannel_Green)
+        .value("BLUE", kImageChannel_Blue)
+        .value("LUMA", kImageChannel_Luma);
+
+    py::class_<IMAGE_STATISTICS>(m, "ImageStatistics")
+        .def_readonly("pixel_count", &IMAGE_STATISTICS::pixelCount)
+        // (4, 256) view, rows R, G, B, luma
+        .def_property_readonly("histogram", [](py::object self) {
+            IMAGE_STATISTICS &stats = self.cast<IMAGE_STATISTICS&>();
+            py::array_t<EdsUInt32> histogram({ (int)kImageChannel_Count, 256 }, &stats.histogram[0][0], self);
+            histogram.attr("setflags")(py::arg("write") = false);
+            return histogram;
+        })
+        .def_property_readonly("mean", [](const IMAGE_STATISTICS &stats) {
+            return std::vector<double>(stats.mean, stats.mean + kImageChannel_Count);
+        })
+        .def_property_readonly("clipped_low", [](const IMAGE_STATISTICS &stats) {
+            return std::vector<double>(stats.clippedLow, stats.clippedLow + kImageChannel_Count);
+        })
+        .def_property_readonly("clipped_high", [](const IMAGE_STATISTICS &stats) {
+            return std::vector<double>(stats.clippedHigh, stats.clippedHigh + kImageChannel_Count);
+        });
+
+    m.def("compute_image_statistics", [](py::buffer pixels, JpegPixelFormat format) {
+        py::buffer_info info = pixels.request();
+        int width = 0, height = 0, stride = 0;
+        pixelLayout(info, format, width, height, stride);
+        IMAGE_STATISTICS stats;
+        {
+            py::gil_scoped_release release;
+            computeImageStatistics(static_cast<const unsigned char*>(info.ptr), width, height, stride, format, stats);
+        }
+        return stats;
+    }, py::arg("pixels"), py::arg("format") = kJpegPixelFormat_RGB);
+
+    // In place; returns False if the image is too flat to stretch.
+    m.def("contrast_stretch", [](py::buffer pixels, JpegPixelFormat format, double lowPercent, double highPercent) {
+        py::buffer_info info = pixels.request(true);
+        int width = 0, height = 0, stride = 0;
+        pixelLayout(info, format, width, height, stride);
+        py::gil_scoped_release release;
+        IMAGE_STATISTICS stats;
+        computeImageStatistics(static_cast<const unsigned char*>(info.ptr), width, height, stride, format, stats);
+        return contrastStretch(static_cast<unsigned char*>(info.ptr), width, height, stride, format, stats, lowPercent, highPercent);
+    }, py::arg("pixels"), py::arg("format") = kJpegPixelFormat_RGB,
+       py::arg("low_percent") = 0.5, py::arg("high_percent") = 0.5);
+
+    // --- Resize and colour conversion ---
+    // Inputs are uint8 arrays with contiguous columns; results are new
+    // arrays the kernels write into directly
+    py::enum_<ResizeFilter>(m, "ResizeFilter")
+        .value("AREA", kResizeFilter_Area)
+        .value("BILINEAR", kResizeFilter_Bilinear)
+        .value("LANCZOS", kResizeFilter_Lanczos);
+
+    m.def("resize_image", [](py::buffer pixels, int width, int height, ResizeFilter filter, int threads) {
+        py::buffer_info info = pixels.request();
+        int channels = (info.ndim == 3) ? (int)info.shape[2] : 1;
+        if (info.itemsize != 1 || (info.ndim != 2 && info.ndim != 3) || channels < 1 || channels > 4)
+            throw std::invalid_argument("expected uint8 pixels of shape (h, w) or (h, w, c) with c up to 4");
+        if (info.strides[1] != channels || (info.ndim == 3 && info.strides[2] != 1))
+            throw std::invalid_argument("pixel columns must be contiguous");
+        if (width <= 0 || height <= 0)
+            throw std::invalid_argument("width and height must be positive");
+        std::vector<py::ssize_t> shape = { height, width };
+        if (info.ndim == 3)
+            shape.push_back(channels);
+        py::array_t<unsigned char> out(shape);
+        unsigned char *dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            resizeImage(static_cast<const unsigned char*>(info.ptr), (int)info.shape[1], (int)info.shape[0], (int)info.strides[0],
+                dst, width, height, width * channels, channels, filter, threads);
+        }
+        return out;
+    }, py::arg("pixels"), py::arg("width"), py::arg("height"), py::arg("filter") = kResizeFilter_Area, py::arg("threads") = 0);
+
+    // RGB <-> BGR; in place when out is pixels
+    m.def("swap_red_blue", [](py::buffer pixels, py::object out, int threads) -> py::object {
+        py::buffer_info info = pixels.request();
+        int width = 0, height = 0, stride = 0;
+        pixelLayout(info, kJpegPixelFormat_RGB, width, height, stride);
+        py::object result = out;
+        if (out.is_none())
+            result = py::array_t<unsigned char>({ height, width, 3 });
+        py::buffer_info target = result.cast<py::buffer>().request(true);
+        int targetWidth = 0, targetHeight = 0, targetStride = 0;
+        pixelLayout(target, kJpegPixelFormat_RGB, targetWidth, targetHeight, targetStride);
+        if (targetWidth != width || targetHeight != height)
+            throw std::invalid_argument("out must have the shape of pixels");
+        {
+            py::gil_scoped_release release;
+            swapRedBlue(static_cast<const unsigned char*>(info.ptr), stride, static_cast<unsigned char*>(target.ptr), targetStride, width, height, threads);
+        }
+        return result;
+    }, py::arg("pixels"), py::arg("out") = py::none(), py::arg("threads") = 0);
+
+    m.def("convert_to_gray", [](py::buffer pixels, JpegPixelFormat format, int threads) {
+        py::buffer_info info = pixels.request();
+        int width = 0, height = 0, stride = 0;
+        pixelLayout(info, kJpegPixelFormat_RGB, width, height, stride);
+        py::array_t<unsigned char> out({ height, width });
+        unsigned char *dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            convertToGray(static_cast<const unsigned char*>(info.ptr), stride, format, dst, width, width, height, threads);
+        }
+        return out;
+    }, py::arg("pixels"), py::arg("format") = kJpegPixelFormat_RGB, py::arg("threads") = 0);
+
+    // (h, w, 3) to (3, h, w)
+    m.def("split_planes", [](py::buffer pixels, int threads) {
+        py::buffer_info info = pixels.request();
+        int width = 0, height = 0, stride = 0;
+        pixelLayout(info, kJpegPixelFormat_RGB, width, height, stride);
+        py::array_t<unsigned char> out({ 3, height, width });
+        unsigned char *dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            splitPlanes(static_cast<const unsigned char*>(info.ptr), stride, dst, width, (size_t)width * height, width, height, threads);
+        }
+        return out;
+    }, py::arg("pixels"), py::arg("threads") = 0);
+
+    // (3, h, w) to (h, w, 3)
+    m.def("merge_planes", [](py::buffer planes, int threads) {
+        py::buffer_info info = planes.request();
+        if (info.itemsize != 1 || info.ndim != 3 || info.shape[0] != 3)
+            throw std::invalid_argument("expected uint8 planes of shape (3, h, w)");
+        if (info.strides[2] != 1)
+            throw std::invalid_argument("plane rows must be contiguous");
+        int height = (int)info.shape[1], width = (int)info.shape[2];
+        py::array_t<unsigned char> out({ height, width, 3 });
+        unsigned char *dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            mergePlanes(static_cast<const unsigned char*>(info.ptr), (int)info.strides[1], (size_t)info.strides[0], dst, width * 3, width, height, threads);
+        }
+        return out;
+    }, py::arg("planes"), py::arg("threads") = 0);
+
+    // --- Live view pump ---
+    py::enum_<EvfDropPolicy>(m, "EvfDropPolicy")
+        .value("DROP_OLDEST", kEvfDropPolicy_DropOldest)
+        .value("DROP_NEWEST", kEvfDropPolicy_DropNewest);
+
+    py::class_<EVF_PUMP_STATISTICS>(m, "EvfPumpStatistics")
+        .def_readonly("published", &EVF_PUMP_STATISTICS::published)
+        .def_readonly("dropped", &EVF_PUMP_STATISTICS::dropped)
+        .def_readonly("not_ready", &EVF_PUMP_STATISTICS::notReady)
+        .def_readonly("errors", &EVF_PUMP_STATISTICS::errors)
+        .def_readonly("last_sequence", &EVF_PUMP_STATISTICS::lastSequence)
+        .def_readonly("achieved_fps", &EVF_PUMP_STATISTICS::achievedFps)
+        .def_readonly("in_flight", &EVF_PUMP_STATISTICS::inFlight)
+        .def_readonly("throttled", &EVF_PUMP_STATISTICS::throttled)
+        .def_readonly("stalls", &EVF_PUMP_STATISTICS::stalls)
+        .def_readonly("stall_micros", &EVF_PUMP_STATISTICS::stallMicros);
+
+    py::class_<EvfPump>(m, "EvfPump")
+        .def(py::init<CameraModel*, EdsUInt32>(),
+             py::arg("model"), py::arg("slot_count") = (EdsUInt32)EvfPump::kDefaultSlotCount,
+             py::keep_alive<1, 2>())
+        .def("start", &EvfPump::start)
+        .def("stop", &EvfPump::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &EvfPump::isRunning)
+        .def("get_slot_count", &EvfPump::getSlotCount)
+        .def("set_not_ready_wait", &EvfPump::setNotReadyWait)
+        .def("set_busy_wait", &EvfPump::setBusyWait)
+        .def("set_idle_wait", &EvfPump::setIdleWait)
+        .def("set_target_fps", &EvfPump::setTargetFps, py::arg("fps"))
+        .def("get_target_fps", &EvfPump::getTargetFps)
+        .def("set_max_in_flight", &EvfPump::setMaxInFlight, py::arg("frames"))
+        .def("get_max_in_flight", &EvfPump::getMaxInFlight)
+        .def("set_drop_policy", &EvfPump::setDropPolicy, py::arg("policy"))
+        .def("get_drop_policy", &EvfPump::getDropPolicy)
+        .def("add_sink", &EvfPump::addSink, py::keep_alive<1, 2>())
+        .def("remove_sink", &EvfPump::removeSink)
+        .def("latest", &EvfPump::latest)
+        .def("wait_for_frame", &EvfPump::waitForFrame,
+             py::arg("after_sequence"), py::arg("timeout_ms"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_statistics", &EvfPump::getStatistics);
+
+    // Fills out, uint8 (n, h, w, c) with c 1 for gray or 3, with the next
+    // frames of pump. Returns (filled, timestamps, zoom): per frame the
+    // download start and end in microseconds, and zoom, zoom rect x, y,
+    // width, height and image position x, y.
+    m.def("grab_evf_batch", [](EvfPump &pump, py::buffer out, EdsUInt32 count, JpegPixelFormat format, int timeoutMillis, EdsUInt32 workers) {
+        py::buffer_info info = out.request(true);
+        if (info.itemsize != 1 || info.ndim != 4 || (info.shape[3] != 1 && info.shape[3] != 3))
+            throw std::invalid_argument("expected a uint8 array of shape (n, h, w, c) with c 1 or 3");
+        if (info.strides[3] != 1 || info.strides[2] != info.shape[3])
+            throw std::invalid_argument("pixel columns must be contiguous");
+        if (info.shape[3] == 1)
+            format = kJpegPixelFormat_Gray;
+        else if (format == kJpegPixelFormat_Gray)
+            throw std::invalid_argument("gray needs c == 1");
+        if (count == 0 || count > (EdsUInt32)info.shape[0])
+            count = (EdsUInt32)info.shape[0];
+
+        std::vector<EVF_BATCH_FRAME> frames(count);
+        EdsUInt32 filled = 0;
+        {
+            py::gil_scoped_release release;
+            EvfBatchGrab grab(static_cast<unsigned char*>(info.ptr), count, (int)info.shape[2], (int)info.shape[1],
+                (int)info.strides[1], (size_t)info.strides[0], format, &frames[0]);
+            grab.setWorkerCount(workers);
+            filled = grab.grab(pump, timeoutMillis);
+        }
+
+        py::array_t<EdsUInt64> timestamps({ (py::ssize_t)filled, (py::ssize_t)2 });
+        py::array_t<EdsInt32> zoom({ (py::ssize_t)filled, (py::ssize_t)7 });
+        auto t = timestamps.mutable_unchecked<2>();
+        auto z = zoom.mutable_unchecked<2>();
+        for (EdsUInt32 i = 0; i < filled; i++)
+        {
+            const EVF_BATCH_FRAME &frame = frames[i];
+            t(i, 0) = frame.downloadStart;
+            t(i, 1) = frame.downloadEnd;
+            z(i, 0) = (EdsInt32)frame.zoom;
+            z(i, 1) = frame.zoomRect.point.x;
+            z(i, 2) = frame.zoomRect.point.y;
+            z(i, 3) = frame.zoomRect.size.width;
+            z(i, 4) = frame.zoomRect.size.height;
+            z(i, 5) = frame.imagePosition.x;
+            z(i, 6) = frame.imagePosition.y;
+        }
+        return py::make_tuple(filled, timestamps, zoom);
+    }, py::arg("pump"), py::arg("out"), py::arg("count") = 0, py::arg("format") = kJpegPixelFormat_RGB,
+       py::arg("timeout_ms") = 5000, py::arg("workers") = (EdsUInt32)EvfBatchGrab::kDefaultWorkerCount);
+
+    // --- Live view decode pool ---
+    py::class_<DecodedEvfFrame, DecodedEvfFrameRef>(m, "DecodedEvfFrame")
+        .def_readonly("frame", &DecodedEvfFrame::frame)
+        .def_readonly("image", &DecodedEvfFrame::image)
+        .def_readonly("index", &DecodedEvfFrame::index)
+        .def_readonly("timing", &DecodedEvfFrame::timing)
+        .def_readonly("has_statistics", &DecodedEvfFrame::hasStatistics)
+        .def_readonly("statistics", &DecodedEvfFrame::statistics);
+
+    py::enum_<EvfRegionMode>(m, "EvfRegionMode")
+        .value("NONE", kEvfRegion_None)
+        .value("FIXED", kEvfRegion_Fixed)
+        .value("ZOOM_RECT", kEvfRegion_ZoomRect);
+
+    py::class_<EVF_DECODE_STATISTICS>(m, "EvfDecodeStatistics")
+        .def_readonly("submitted", &EVF_DECODE_STATISTICS::submitted)
+        .def_readonly("dropped", &EVF_DECODE_STATISTICS::dropped)
+        .def_readonly("decoded", &EVF_DECODE_STATISTICS::decoded)
+        .def_readonly("failed", &EVF_DECODE_STATISTICS::failed)
+        .def_readonly("delivered", &EVF_DECODE_STATISTICS::delivered)
+        .def_readonly("last_index", &EVF_DECODE_STATISTICS::lastIndex)
+        .def_readonly("queue_depth", &EVF_DECODE_STATISTICS::queueDepth)
+        .def_readonly("worker_count", &EVF_DECODE_STATISTICS::workerCount)
+        .def_readonly("average_decode_micros", &EVF_DECODE_STATISTICS::averageDecodeMicros)
+        .def_readonly("average_latency_micros", &EVF_DECODE_STATISTICS::averageLatencyMicros);
+
+    py::class_<EvfDecodePool, EvfFrameSink>(m, "EvfDecodePool")
+        .def(py::init<EdsUInt32, JpegPixelFormat, int, EdsUInt32>(),
+             py::arg("worker_count") = (EdsUInt32)EvfDecodePool::kDefaultWorkerCount,
+             py::arg("format") = kJpegPixelFormat_RGB,
+             py::arg("scale") = 1,
+             py::arg("queue_limit") = (EdsUInt32)EvfDecodePool::kDefaultQueueLimit)
+        .def("set_placement", &EvfDecodePool::setPlacement, py::arg("placement"), py::arg("name") = std::string())
+        .def("start", &EvfDecodePool::start)
+        .def("stop", &EvfDecodePool::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &EvfDecodePool::isRunning)
+        .def("get_worker_count", &EvfDecodePool::getWorkerCount)
+        .def("get_format", &EvfDecodePool::getFormat)
+        .def("get_scale", &EvfDecodePool::getScale)
+        .def("set_region", &EvfDecodePool::setRegion, py::arg("region"), py::arg("space") = kEvfCoordinate_JpegLarge)
+        .def("follow_zoom_rect", &EvfDecodePool::followZoomRect)
+        .def("set_compute_statistics", &EvfDecodePool::setComputeStatistics)
+        .def("get_compute_statistics", &EvfDecodePool::getComputeStatistics)
+        .def("clear_region", &EvfDecodePool::clearRegion)
+        .def("set_resize", &EvfDecodePool::setResize,
+             py::arg("width"), py::arg("height"), py::arg("filter") = kResizeFilter_Area)
+        .def("clear_resize", &EvfDecodePool::clearResize)
+        .def("get_region_mode", &EvfDecodePool::getRegionMode)
+        .def("latest", &EvfDecodePool::latest)
+        .def("wait_for_frame", &EvfDecodePool::waitForFrame,
+             py::arg("after_index"), py::arg("timeout_ms"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_statistics", &EvfDecodePool::getStatistics);
+
+    // --- Live view fan-out ---
+    py::class_<EVF_CONSUMER_SPEC>(m, "EvfConsumerSpec")
+        .def(py::init([](EdsInt32 width, EdsInt32 height, JpegPixelFormat format, ResizeFilter filter) {
+            return EvfFanout::makeSpec(width, height, format, filter);
+        }), py::arg("width") = 0, py::arg("height") = 0, py::arg("format") = kJpegPixelFormat_RGB,
+            py::arg("filter") = kResizeFilter_Area)
+        .def_readwrite("width", &EVF_CONSUMER_SPEC::width)
+        .def_readwrite("height", &EVF_CONSUMER_SPEC::height)
+        .def_readwrite("format", &EVF_CONSUMER_SPEC::format)
+        .def_readwrite("region_mode", &EVF_CONSUMER_SPEC::regionMode)
+        .def_readwrite("region", &EVF_CONSUMER_SPEC::region)
+        .def_readwrite("region_space", &EVF_CONSUMER_SPEC::regionSpace)
+        .def_readwrite("filter", &EVF_CONSUMER_SPEC::filter);
+
+    py::class_<EvfFanoutFrame, EvfFanoutFrameRef>(m, "EvfFanoutFrame")
+        .def_readonly("frame", &EvfFanoutFrame::frame)
+        .def_readonly("image", &EvfFanoutFrame::image)
+        .def_readonly("index", &EvfFanoutFrame::index)
+        .def_readonly("consumer", &EvfFanoutFrame::consumer)
+        .def_readonly("scale", &EvfFanoutFrame::scale)
+        .def_readonly("timing", &EvfFanoutFrame::timing);
+
+    py::class_<EVF_FANOUT_STATISTICS>(m, "EvfFanoutStatistics")
+        .def_readonly("submitted", &EVF_FANOUT_STATISTICS::submitted)
+        .def_readonly("dropped", &EVF_FANOUT_STATISTICS::dropped)
+        .def_readonly("frames", &EVF_FANOUT_STATISTICS::frames)
+        .def_readonly("failed", &EVF_FANOUT_STATISTICS::failed)
+        .def_readonly("outputs", &EVF_FANOUT_STATISTICS::outputs)
+        .def_readonly("shared_outputs", &EVF_FANOUT_STATISTICS::sharedOutputs)
+        .def_readonly("consumer_count", &EVF_FANOUT_STATISTICS::consumerCount)
+        .def_readonly("queue_depth", &EVF_FANOUT_STATISTICS::queueDepth)
+        .def_readonly("last_scale", &EVF_FANOUT_STATISTICS::lastScale)
+        .def_readonly("last_decode_width", &EVF_FANOUT_STATISTICS::lastDecodeWidth)
+        .def_readonly("last_decode_height", &EVF_FANOUT_STATISTICS::lastDecodeHeight)
+        .def_readonly("last_decode_format", &EVF_FANOUT_STATISTICS::lastDecodeFormat)
+        .def_readonly("average_decode_micros", &EVF_FANOUT_STATISTICS::averageDecodeMicros)
+        .def_readonly("average_derive_micros", &EVF_FANOUT_STATISTICS::averageDeriveMicros)
+        .def_readonly("average_latency_micros", &EVF_FANOUT_STATISTICS::averageLatencyMicros);
+
+    py::class_<EvfFanout, EvfFrameSink>(m, "EvfFanout")
+        .def(py::init<EdsUInt32>(), py::arg("queue_limit") = (EdsUInt32)EvfFanout::kDefaultQueueLimit)
+        .def("set_thread_count", &EvfFanout::setThreadCount)
+        .def("get_thread_count", &EvfFanout::getThreadCount)
+        .def("add_consumer", [](EvfFanout &fanout, const EVF_CONSUMER_SPEC &spec, py::object callback) {
+            if (callback.is_none())
+                return fanout.addConsumer(spec);
+            std::shared_ptr<py::function> held(new py::function(callback.cast<py::function>()), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            return fanout.addConsumer(spec, [held](const EvfFanoutFrameRef &frame) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    (*held)(frame);
+                }
+                catch (py::error_already_set &e)
+                {
+                    e.discard_as_unraisable("live view fan-out listener");
+                }
+            });
+        }, py::arg("spec"), py::arg("callback") = py::none())
+        .def("remove_consumer", &EvfFanout::removeConsumer)
+        .def("set_consumer_spec", &EvfFanout::setConsumerSpec)
+        .def("get_consumer_count", &EvfFanout::getConsumerCount)
+        .def("start", &EvfFanout::start)
+        .def("stop", &EvfFanout::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &EvfFanout::isRunning)
+        .def("latest", &EvfFanout::latest)
+        .def("wait_for_frame", &EvfFanout::waitForFrame,
+             py::arg("consumer"), py::arg("after_index"), py::arg("timeout_ms"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_placement", &EvfFanout::setPlacement, py::arg("placement"), py::arg("name") = std::string())
+        .def("get_statistics", &EvfFanout::getStatistics);
         
+    // --- Live view recording ---
+    py::class_<EVF_RECORDER_STATISTICS>(m, "EvfRecorderStatistics")
+        .def_readonly("frames", &EVF_RECORDER_STATISTICS::frames)
+        .def_readonly("bytes", &EVF_RECORDER_STATISTICS::bytes)
+        .def_readonly("capacity", &EVF_RECORDER_STATISTICS::capacity)
+        .def_readonly("max_frames", &EVF_RECORDER_STATISTICS::maxFrames)
+        .def_readonly("dropped", &EVF_RECORDER_STATISTICS::dropped)
+        .def_readonly("duration_micros", &EVF_RECORDER_STATISTICS::durationMicros);
+
+    // pump.add_sink(recorder) records every frame as it came from the camera
+    py::class_<EvfRecorder, EvfFrameSink>(m, "EvfRecorder")
+        .def(py::init<>())
+        .def("open", [](EvfRecorder &recorder, const std::string &path, EdsUInt64 capacity, EdsUInt64 maxFrames) {
+            return recorder.open(path.c_str(), capacity, maxFrames);
+        }, py::arg("path"), py::arg("capacity"), py::arg("max_frames") = 0)
+        .def("close", &EvfRecorder::close, py::call_guard<py::gil_scoped_release>())
+        .def("is_recording", &EvfRecorder::isRecording)
+        .def("get_statistics", &EvfRecorder::getStatistics);
+
+    py::class_<EVF_REPLAY_STATISTICS>(m, "EvfReplayStatistics")
+        .def_readonly("frame_count", &EVF_REPLAY_STATISTICS::frameCount)
+        .def_readonly("duration_micros", &EVF_REPLAY_STATISTICS::durationMicros)
+        .def_readonly("published", &EVF_REPLAY_STATISTICS::published)
+        .def_readonly("position", &EVF_REPLAY_STATISTICS::position)
+        .def_readonly("loops", &EVF_REPLAY_STATISTICS::loops);
+
+    py::class_<EvfReplay>(m, "EvfReplay")
+        .def(py::init<CameraModel*>(), py::arg("model") = nullptr, py::keep_alive<1, 2>())
+        .def("open", [](EvfReplay &replay, const std::string &path) {
+            return replay.open(path.c_str());
+        }, py::arg("path"), py::call_guard<py::gil_scoped_release>())
+        .def("is_open", &EvfReplay::isOpen)
+        .def("get_frame_count", &EvfReplay::getFrameCount)
+        .def("get_duration_micros", &EvfReplay::getDurationMicros)
+        .def("set_speed", &EvfReplay::setSpeed)
+        .def("get_speed", &EvfReplay::getSpeed)
+        .def("set_loop", &EvfReplay::setLoop)
+        .def("seek", &EvfReplay::seek)
+        .def("find_frame", &EvfReplay::findFrame, py::arg("time_micros"))
+        .def("get_frame_time", &EvfReplay::getFrameTime)
+        .def("frame", &EvfReplay::frame, py::arg("index"))
+        .def("__len__", &EvfReplay::getFrameCount)
+        .def("__getitem__", [](const EvfReplay &replay, EdsUInt64 index) {
+            EvfFrameRef frame = replay.frame(index);
+            if(!frame)
+            {
+                throw py::index_error();
+            }
+            return frame;
+        })
+        .def("add_sink", &EvfReplay::addSink, py::keep_alive<1, 2>())
+        .def("remove_sink", &EvfReplay::removeSink)
+        .def("start", &EvfReplay::start)
+        .def("stop", &EvfReplay::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &EvfReplay::isRunning)
+        .def("get_statistics", &EvfReplay::getStatistics);
+
+    // --- MJPEG over HTTP ---
+    py::class_<EVF_HTTP_CLIENT_STATISTICS>(m, "EvfHttpClientStatistics")
+        .def_readonly("address", &EVF_HTTP_CLIENT_STATISTICS::address)
+        .def_readonly("path", &EVF_HTTP_CLIENT_STATISTICS::path)
+        .def_readonly("max_fps", &EVF_HTTP_CLIENT_STATISTICS::maxFps)
+        .def_readonly("sent", &EVF_HTTP_CLIENT_STATISTICS::sent)
+        .def_readonly("dropped", &EVF_HTTP_CLIENT_STATISTICS::dropped)
+        .def_readonly("bytes", &EVF_HTTP_CLIENT_STATISTICS::bytes)
+        .def_readonly("connected_micros", &EVF_HTTP_CLIENT_STATISTICS::connectedMicros);
+
+    py::class_<EVF_HTTP_SERVER_STATISTICS>(m, "EvfHttpServerStatistics")
+        .def_readonly("clients", &EVF_HTTP_SERVER_STATISTICS::clients)
+        .def_readonly("accepted", &EVF_HTTP_SERVER_STATISTICS::accepted)
+        .def_readonly("rejected", &EVF_HTTP_SERVER_STATISTICS::rejected)
+        .def_readonly("frames", &EVF_HTTP_SERVER_STATISTICS::frames)
+        .def_readonly("sent", &EVF_HTTP_SERVER_STATISTICS::sent)
+        .def_readonly("dropped", &EVF_HTTP_SERVER_STATISTICS::dropped)
+        .def_readonly("bytes", &EVF_HTTP_SERVER_STATISTICS::bytes);
+
+    // pump.add_sink(server); viewers open http://host:port/stream
+    py::class_<EvfHttpServer, EvfFrameSink>(m, "EvfHttpServer")
+        .def(py::init<>())
+        .def("start", [](EvfHttpServer &server, EdsUInt16 port, const std::string &address) {
+            return server.start(port, address.c_str());
+        }, py::arg("port") = 8080, py::arg("address") = "127.0.0.1")
+        .def("stop", &EvfHttpServer::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &EvfHttpServer::isRunning)
+        .def("get_port", &EvfHttpServer::getPort)
+        .def("set_max_clients", &EvfHttpServer::setMaxClients)
+        .def("get_max_clients", &EvfHttpServer::getMaxClients)
+        .def("set_max_fps", &EvfHttpServer::setMaxFps)
+        .def("get_max_fps", &EvfHttpServer::getMaxFps)
+        .def("get_statistics", &EvfHttpServer::getStatistics)
+        .def("get_clients", &EvfHttpServer::getClients);
+
+    // --- Shared memory frames ---
+    py::enum_<SharedFrameKind>(m, "SharedFrameKind")
+        .value("NONE", kSharedFrameKind_None)
+        .value("EVF_JPEG", kSharedFrameKind_EvfJpeg)
+        .value("EVF_IMAGE", kSharedFrameKind_EvfImage)
+        .value("CAPTURE", kSharedFrameKind_Capture);
+
+    py::class_<SHARED_FRAME_RING_STATISTICS>(m, "SharedFrameRingStatistics")
+        .def_readonly("published", &SHARED_FRAME_RING_STATISTICS::published)
+        .def_readonly("bytes", &SHARED_FRAME_RING_STATISTICS::bytes)
+        .def_readonly("dropped", &SHARED_FRAME_RING_STATISTICS::dropped)
+        .def_readonly("aborted", &SHARED_FRAME_RING_STATISTICS::aborted);
+
+    // pump.add_sink(ring); other processes read it with core.shared_frames
+    py::class_<SharedFrameRing, EvfFrameSink>(m, "SharedFrameRing")
+        .def(py::init<>())
+        .def("create", [](SharedFrameRing &ring, const std::string &name, EdsUInt64 slotSize, EdsUInt32 slotCount) {
+            return ring.create(name.c_str(), slotSize, slotCount);
+        }, py::arg("name"), py::arg("slot_size"), py::arg("slot_count") = (EdsUInt32)SharedFrameRing::kDefaultSlotCount)
+        .def("close", &SharedFrameRing::close, py::call_guard<py::gil_scoped_release>())
+        .def("is_open", &SharedFrameRing::isOpen)
+        .def("get_name", &SharedFrameRing::getName)
+        .def("get_slot_size", &SharedFrameRing::getSlotSize)
+        .def("get_slot_count", &SharedFrameRing::getSlotCount)
+        .def("get_statistics", &SharedFrameRing::getStatistics)
+        // Decoded frames of pool are published as pixels; pool keeps the ring alive
+        .def("publish_decoded_from", [](SharedFrameRing &ring, EvfDecodePool &pool) {
+            pool.addListener([&ring](const DecodedEvfFrameRef &decoded) {
+                ring.publishDecoded(decoded);
+            });
+        }, py::arg("pool"), py::keep_alive<2, 1>());
+
     py::class_<DoEvfAFCommand, Command>(m, "DoEvfAFCommand")
         .def(py::init<CameraModel*, EdsPoint>());
         
     py::class_<DriveLensCommand, Command>(m, "DriveLensCommand")
         .def(py::init<CameraModel*, EdsUInt32>());
 
+    // --- Contrast-detect autofocus ---
+    py::enum_<FocusMetric>(m, "FocusMetric")
+        .value("TENENGRAD", kFocusMetric_Tenengrad)
+        .value("LAPLACIAN_VARIANCE", kFocusMetric_LaplacianVariance);
+
+    m.def("compute_sharpness", [](py::buffer pixels, FocusMetric metric) {
+        py::buffer_info info = pixels.request();
+        int width = 0, height = 0, stride = 0;
+        pixelLayout(info, kJpegPixelFormat_Gray, width, height, stride);
+        py::gil_scoped_release release;
+        return computeSharpness(static_cast<const unsigned char*>(info.ptr), width, height, stride, metric);
+    }, py::arg("pixels"), py::arg("metric") = kFocusMetric_Tenengrad);
+
+    py::class_<FOCUS_SAMPLE>(m, "FocusSample")
+        .def_readonly("phase", &FOCUS_SAMPLE::phase)
+        .def_readonly("position", &FOCUS_SAMPLE::position)
+        .def_readonly("score", &FOCUS_SAMPLE::score)
+        .def_readonly("captured", &FOCUS_SAMPLE::captured);
+
+    py::class_<FOCUS_RESULT>(m, "FocusResult")
+        .def_readonly("success", &FOCUS_RESULT::success)
+        .def_readonly("error", &FOCUS_RESULT::error)
+        .def_readonly("best_position", &FOCUS_RESULT::bestPosition)
+        .def_readonly("best_fine_position", &FOCUS_RESULT::bestFinePosition)
+        .def_readonly("best_score", &FOCUS_RESULT::bestScore)
+        .def_readonly("lens_steps", &FOCUS_RESULT::lensSteps)
+        .def_readonly("frames", &FOCUS_RESULT::frames)
+        .def_readonly("elapsed_micros", &FOCUS_RESULT::elapsedMicros)
+        .def_readonly("curve", &FOCUS_RESULT::curve);
+
+    py::class_<FocusEngine>(m, "FocusEngine")
+        .def(py::init<CameraModel*, EvfPump*>(), py::arg("model"), py::arg("pump") = nullptr,
+             py::keep_alive<1, 2>(), py::keep_alive<1, 3>())
+        .def("set_metric", &FocusEngine::setMetric)
+        .def("get_metric", &FocusEngine::getMetric)
+        .def("set_region", &FocusEngine::setRegion, py::arg("region"), py::arg("space") = kEvfCoordinate_JpegLarge)
+        .def("follow_zoom_rect", &FocusEngine::followZoomRect)
+        .def("clear_region", &FocusEngine::clearRegion)
+        .def("get_region_mode", &FocusEngine::getRegionMode)
+        .def("set_scale", &FocusEngine::setScale)
+        .def("get_scale", &FocusEngine::getScale)
+        .def("set_steps", &FocusEngine::setSteps, py::arg("coarse_step"), py::arg("fine_step"))
+        .def("set_start_far", &FocusEngine::setStartFar)
+        .def("set_max_steps", &FocusEngine::setMaxSteps)
+        .def("set_patience", &FocusEngine::setPatience)
+        .def("set_threshold", &FocusEngine::setThreshold)
+        .def("set_settle_frames", &FocusEngine::setSettleFrames)
+        .def("set_frame_timeout", &FocusEngine::setFrameTimeout)
+        .def("cancel", &FocusEngine::cancel)
+        .def("is_cancelled", &FocusEngine::isCancelled)
+        .def("score", [](FocusEngine &engine, EvfFrameRef frame) {
+            py::gil_scoped_release release;
+            return engine.score(*frame);
+        })
+        .def("run", [](FocusEngine &engine) {
+            FOCUS_RESULT result;
+            {
+                py::gil_scoped_release release;
+                engine.run(result);
+            }
+            return result;
+        });
+
     // --- Property Commands ---
     // Note: SetPropertyCommand is templated, would need template specializations
     // This is a simplified version for common types
@@ -179,6 +2009,21 @@ PYBIND11_MODULE(edsdk_bindings, m) {
         
     py::class_<GetPropertyDescCommand, Command>(m, "GetPropertyDescCommand") 
         .def(py::init<CameraModel*, EdsUInt32>());
+
+    py::class_<GetPropertiesCommand, Command>(m, "GetPropertiesCommand")
+        .def(py::init<CameraModel*, const PropertyIDList&>());
+
+    py::class_<PROPERTY_SETTING>(m, "PropertySetting")
+        .def_readonly("property_id", &PROPERTY_SETTING::propertyID)
+        .def_readonly("size", &PROPERTY_SETTING::size)
+        .def_readonly("error", &PROPERTY_SETTING::error)
+        .def_property_readonly("data", [](const PROPERTY_SETTING &setting) {
+            return py::bytes(reinterpret_cast<const char*>(setting.data), setting.size);
+        });
+
+    py::class_<SetPropertiesCommand, Command>(m, "SetPropertiesCommand")
+        .def(py::init<CameraModel*, const PropertySettingList&>())
+        .def("get_settings", &SetPropertiesCommand::getSettings);
         
     py::class_<SetCapacityCommand, Command>(m, "SetCapacityCommand")
         .def(py::init<CameraModel*, const EdsCapacity&>());
@@ -189,6 +2034,707 @@ PYBIND11_MODULE(edsdk_bindings, m) {
     py::class_<DownloadCommand, Command>(m, "DownloadCommand")
         .def(py::init<CameraModel*, EdsBaseRef>());
 
+    // --- Save target and transfer rules ---
+    py::enum_<EdsSaveTo>(m, "SaveTo", py::arithmetic())
+        .value("CAMERA", kEdsSaveTo_Camera)
+        .value("HOST", kEdsSaveTo_Host)
+        .value("BOTH", kEdsSaveTo_Both);
+
+    py::enum_<TransferAction>(m, "TransferAction")
+        .value("DOWNLOAD", kTransferAction_Download)
+        .value("LEAVE_ON_CARD", kTransferAction_LeaveOnCard);
+
+    py::class_<TRANSFER_RULE>(m, "TransferRule")
+        .def(py::init([](const std::string &extension, TransferAction action, EdsUInt64 minSize, EdsUInt64 maxSize) {
+            return TransferRules::makeRule(extension.c_str(), action, minSize, maxSize);
+        }), py::arg("extension") = "", py::arg("action") = kTransferAction_LeaveOnCard,
+            py::arg("min_size") = (EdsUInt64)0, py::arg("max_size") = (EdsUInt64)0)
+        .def_property_readonly("extension", [](const TRANSFER_RULE &rule) { return std::string(rule.extension); })
+        .def_readwrite("min_size", &TRANSFER_RULE::minSize)
+        .def_readwrite("max_size", &TRANSFER_RULE::maxSize)
+        .def_readwrite("action", &TRANSFER_RULE::action);
+
+    py::class_<TRANSFER_RULE_STATISTICS>(m, "TransferRuleStatistics")
+        .def_readonly("requests", &TRANSFER_RULE_STATISTICS::requests)
+        .def_readonly("downloaded", &TRANSFER_RULE_STATISTICS::downloaded)
+        .def_readonly("left_on_card", &TRANSFER_RULE_STATISTICS::leftOnCard)
+        .def_readonly("left_on_card_bytes", &TRANSFER_RULE_STATISTICS::leftOnCardBytes)
+        .def_readonly("kept", &TRANSFER_RULE_STATISTICS::kept);
+
+    py::class_<TransferRules, TransferRulesRef>(m, "TransferRules")
+        .def("add_rule", &TransferRules::addRule)
+        .def("clear", &TransferRules::clear)
+        .def("get_rules", &TransferRules::getRules)
+        .def("set_default_action", &TransferRules::setDefaultAction)
+        .def("get_default_action", &TransferRules::getDefaultAction)
+        .def("is_empty", &TransferRules::isEmpty)
+        .def("get_statistics", &TransferRules::getStatistics)
+        .def("reset_statistics", &TransferRules::resetStatistics);
+
+    m.def("get_host_capacity", &SaveSettingCommand::hostCapacity, py::arg("path") = std::string());
+
+    // --- In-memory capture download ---
+    py::enum_<DownloadTarget>(m, "DownloadTarget")
+        .value("FILE", kDownloadTarget_File)
+        .value("MEMORY", kDownloadTarget_Memory)
+        .value("PIPELINE", kDownloadTarget_Pipeline);
+
+    py::class_<CAPTURE_POOL_STATISTICS>(m, "CapturePoolStatistics")
+        .def_readonly("hits", &CAPTURE_POOL_STATISTICS::hits)
+        .def_readonly("misses", &CAPTURE_POOL_STATISTICS::misses)
+        .def_readonly("pool_size", &CAPTURE_POOL_STATISTICS::poolSize)
+        .def_readonly("available", &CAPTURE_POOL_STATISTICS::available)
+        .def_readonly("pooled_bytes", &CAPTURE_POOL_STATISTICS::pooledBytes)
+        .def_readonly("in_use", &CAPTURE_POOL_STATISTICS::inUse)
+        .def_readonly("size_classes", &CAPTURE_POOL_STATISTICS::sizeClasses)
+        .def_readonly("in_use_bytes", &CAPTURE_POOL_STATISTICS::inUseBytes)
+        .def_readonly("allocated_bytes", &CAPTURE_POOL_STATISTICS::allocatedBytes)
+        .def_readonly("allocate_micros", &CAPTURE_POOL_STATISTICS::allocateMicros)
+        .def_readonly("huge_page_buffers", &CAPTURE_POOL_STATISTICS::hugePageBuffers)
+        .def_readonly("discarded", &CAPTURE_POOL_STATISTICS::discarded);
+
+    py::class_<CaptureBufferPool, CaptureBufferPoolRef>(m, "CaptureBufferPool")
+        .def("preallocate", &CaptureBufferPool::preallocate, py::arg("count"), py::arg("buffer_size"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_huge_pages", &CaptureBufferPool::setHugePages)
+        .def("get_huge_pages", &CaptureBufferPool::getHugePages)
+        .def("set_prefault", &CaptureBufferPool::setPrefault)
+        .def("get_prefault", &CaptureBufferPool::getPrefault)
+        .def_static("size_class", &CaptureBufferPool::sizeClass, py::arg("size"))
+        .def("set_pool_size", &CaptureBufferPool::setPoolSize)
+        .def("get_pool_size", &CaptureBufferPool::getPoolSize)
+        .def("get_statistics", &CaptureBufferPool::getStatistics)
+        .def("reset_statistics", &CaptureBufferPool::resetStatistics)
+        .def("clear", &CaptureBufferPool::clear);
+
+    // Full-size file bytes without a copy; the pooled buffer is held until
+    // the last memoryview/array over it is gone.
+    py::class_<CapturedImage, CapturedImageRef>(m, "CapturedImage", py::buffer_protocol())
+        .def_buffer([](CapturedImage &image) -> py::buffer_info {
+            return py::buffer_info(
+                const_cast<unsigned char*>(image.getData()),
+                1, py::format_descriptor<unsigned char>::format(), 1,
+                { static_cast<py::ssize_t>(image.getLength()) }, { 1 },
+                true);
+        })
+        .def("__len__", [](const CapturedImage &image) { return static_cast<size_t>(image.getLength()); })
+        .def_property_readonly("sequence", &CapturedImage::getSequence)
+        .def_property_readonly("info", &CapturedImage::getInfo)
+        .def_property_readonly("file_name", [](const CapturedImage &image) { return std::string(image.getFileName()); })
+        .def_property_readonly("format", &CapturedImage::getFormat)
+        .def_property_readonly("group_id", &CapturedImage::getGroupID)
+        .def_property_readonly("date_time", &CapturedImage::getDateTime)
+        .def_property_readonly("timing", &CapturedImage::getTiming);
+
+    py::class_<CAPTURE_TIMING>(m, "CaptureTiming")
+        .def_readonly("request_micros", &CAPTURE_TIMING::requestMicros)
+        .def_readonly("download_start_micros", &CAPTURE_TIMING::downloadStartMicros)
+        .def_readonly("download_end_micros", &CAPTURE_TIMING::downloadEndMicros);
+
+    // --- Thumbnails ---
+    py::enum_<EdsImageSource>(m, "ImageSource")
+        .value("FULL_VIEW", kEdsImageSrc_FullView)
+        .value("THUMBNAIL", kEdsImageSrc_Thumbnail)
+        .value("PREVIEW", kEdsImageSrc_Preview)
+        .value("RAW_THUMBNAIL", kEdsImageSrc_RAWThumbnail)
+        .value("RAW_FULL_VIEW", kEdsImageSrc_RAWFullView);
+
+    // The buffer is the embedded JPEG as the camera sent it; pixels is an
+    // (height, width, 3) RGB array when decoded, otherwise None
+    py::class_<Thumbnail, ThumbnailRef>(m, "Thumbnail", py::buffer_protocol())
+        .def_buffer([](Thumbnail &thumbnail) -> py::buffer_info {
+            return py::buffer_info(
+                const_cast<unsigned char*>(thumbnail.getData()),
+                1, py::format_descriptor<unsigned char>::format(), 1,
+                { static_cast<py::ssize_t>(thumbnail.getLength()) }, { 1 },
+                true);
+        })
+        .def("__len__", [](const Thumbnail &thumbnail) { return static_cast<size_t>(thumbnail.getLength()); })
+        .def_property_readonly("info", &Thumbnail::getInfo)
+        .def_property_readonly("file_name", [](const Thumbnail &thumbnail) { return std::string(thumbnail.getFileName()); })
+        .def_property_readonly("source", &Thumbnail::getSource)
+        .def_property_readonly("width", &Thumbnail::getWidth)
+        .def_property_readonly("height", &Thumbnail::getHeight)
+        .def_property_readonly("pixels", [](py::object self) -> py::object {
+            const Thumbnail &thumbnail = self.cast<const Thumbnail&>();
+            if (!thumbnail.hasPixels())
+                return py::none();
+            return py::array_t<unsigned char>({ thumbnail.getPixelHeight(), thumbnail.getPixelWidth(), (EdsUInt32)3 },
+                { thumbnail.getStride(), (EdsUInt32)3, (EdsUInt32)1 }, thumbnail.getPixels(), self);
+        });
+
+    // Thumbnail or preview of a file already on the host: bytes, a
+    // CapturedImage or a path. Always decoded.
+    m.def("extract_thumbnail", [](py::buffer data, EdsImageSource source, EdsUInt32 maxSize) {
+        py::buffer_info info = data.request();
+        ThumbnailRef thumbnail;
+        EdsError err;
+        {
+            py::gil_scoped_release release;
+            err = Thumbnail::extract(info.ptr, (EdsUInt64)(info.size * info.itemsize), NULL, source, maxSize, thumbnail);
+        }
+        if (err != EDS_ERR_OK)
+            throw std::runtime_error("EdsGetImage failed: " + std::to_string(err));
+        return thumbnail;
+    }, py::arg("data"), py::arg("source") = kEdsImageSrc_Preview, py::arg("max_size") = 0);
+
+    m.def("extract_thumbnail_file", [](const std::string &path, EdsImageSource source, EdsUInt32 maxSize) {
+        ThumbnailRef thumbnail;
+        EdsError err;
+        {
+            py::gil_scoped_release release;
+            err = Thumbnail::extractFile(path.c_str(), source, maxSize, thumbnail);
+        }
+        if (err != EDS_ERR_OK)
+            throw std::runtime_error("EdsGetImage failed: " + std::to_string(err));
+        return thumbnail;
+    }, py::arg("path"), py::arg("source") = kEdsImageSrc_Preview, py::arg("max_size") = 0);
+
+    // --- RAW development ---
+    // pixels is an (height, width, 3) RGB array of uint8 or uint16, over
+    // the developed buffer
+    py::class_<DevelopedImage, DevelopedImageRef>(m, "DevelopedImage")
+        .def_property_readonly("info", &DevelopedImage::getInfo)
+        .def_property_readonly("file_name", [](const DevelopedImage &image) { return std::string(image.getFileName()); })
+        .def_property_readonly("sequence", &DevelopedImage::getSequence)
+        .def_property_readonly("source", &DevelopedImage::getSource)
+        .def_property_readonly("width", &DevelopedImage::getWidth)
+        .def_property_readonly("height", &DevelopedImage::getHeight)
+        .def_property_readonly("bits_per_channel", &DevelopedImage::getBitsPerChannel)
+        .def_property_readonly("source_width", &DevelopedImage::getSourceWidth)
+        .def_property_readonly("source_height", &DevelopedImage::getSourceHeight)
+        .def_property_readonly("develop_micros", &DevelopedImage::getDevelopMicros)
+        .def_property_readonly("pixels", [](py::object self) -> py::object {
+            const DevelopedImage &image = self.cast<const DevelopedImage&>();
+            if (image.getPixels() == NULL)
+                return py::none();
+            if (image.getBitsPerChannel() == 16)
+                return py::array_t<EdsUInt16>({ image.getHeight(), image.getWidth(), (EdsUInt32)3 },
+                    { image.getStride(), (EdsUInt32)6, (EdsUInt32)2 }, reinterpret_cast<const EdsUInt16*>(image.getPixels()), self);
+            return py::array_t<unsigned char>({ image.getHeight(), image.getWidth(), (EdsUInt32)3 },
+                { image.getStride(), (EdsUInt32)3, (EdsUInt32)1 }, image.getPixels(), self);
+        });
+
+    py::class_<RAW_DEVELOP_STATISTICS>(m, "RawDevelopStatistics")
+        .def_readonly("submitted", &RAW_DEVELOP_STATISTICS::submitted)
+        .def_readonly("developed", &RAW_DEVELOP_STATISTICS::developed)
+        .def_readonly("failed", &RAW_DEVELOP_STATISTICS::failed)
+        .def_readonly("dropped", &RAW_DEVELOP_STATISTICS::dropped)
+        .def_readonly("overwritten", &RAW_DEVELOP_STATISTICS::overwritten)
+        .def_readonly("queue_depth", &RAW_DEVELOP_STATISTICS::queueDepth)
+        .def_readonly("worker_count", &RAW_DEVELOP_STATISTICS::workerCount)
+        .def_readonly("input_bytes", &RAW_DEVELOP_STATISTICS::inputBytes)
+        .def_readonly("output_pixels", &RAW_DEVELOP_STATISTICS::outputPixels)
+        .def_readonly("average_develop_micros", &RAW_DEVELOP_STATISTICS::averageDevelopMicros)
+        .def_readonly("average_latency_micros", &RAW_DEVELOP_STATISTICS::averageLatencyMicros)
+        .def_readonly("active_micros", &RAW_DEVELOP_STATISTICS::activeMicros)
+        .def_readonly("images_per_second", &RAW_DEVELOP_STATISTICS::imagesPerSecond)
+        .def_readonly("megapixels_per_second", &RAW_DEVELOP_STATISTICS::megapixelsPerSecond);
+
+    py::class_<RawDevelopPool, RawDevelopPoolRef>(m, "RawDevelopPool")
+        .def(py::init([](EdsUInt32 workerCount, EdsUInt32 bits, EdsUInt32 maxSize) {
+                 if (bits != 8 && bits != 16)
+                     throw std::invalid_argument("bits must be 8 or 16");
+                 return std::make_shared<RawDevelopPool>(workerCount, bits == 16 ? kEdsTargetImageType_RGB16 : kEdsTargetImageType_RGB, maxSize);
+             }),
+             py::arg("worker_count") = (EdsUInt32)RawDevelopPool::kDefaultWorkerCount,
+             py::arg("bits") = (EdsUInt32)16, py::arg("max_size") = (EdsUInt32)0)
+        .def_static("is_raw_file", [](const std::string &name) { return RawDevelopPool::isRawFile(name.c_str()); })
+        .def("set_source", &RawDevelopPool::setSource)
+        .def("set_queue_limit", &RawDevelopPool::setQueueLimit)
+        .def("set_result_limit", &RawDevelopPool::setResultLimit)
+        .def("set_keep_source", &RawDevelopPool::setKeepSource)
+        .def("get_worker_count", &RawDevelopPool::getWorkerCount)
+        .def("get_max_size", &RawDevelopPool::getMaxSize)
+        .def("start", &RawDevelopPool::start)
+        .def("stop", &RawDevelopPool::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &RawDevelopPool::isRunning)
+        .def("attach", &RawDevelopPool::attach, py::arg("model"), py::arg("pass_through") = false, py::keep_alive<1, 2>())
+        .def("detach", &RawDevelopPool::detach)
+        .def("submit", &RawDevelopPool::submit)
+        .def("pop", &RawDevelopPool::pop, py::arg("timeout_ms"), py::call_guard<py::gil_scoped_release>())
+        .def("wait_idle", &RawDevelopPool::waitIdle, py::arg("timeout_ms"), py::call_guard<py::gil_scoped_release>())
+        .def("add_listener", [](RawDevelopPool &pool, py::function callback) {
+            std::shared_ptr<py::function> held(new py::function(callback), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            pool.addListener([held](const DevelopedImageRef &image) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    (*held)(image);
+                }
+                catch (py::error_already_set &e)
+                {
+                    e.discard_as_unraisable("raw develop listener");
+                }
+            });
+        })
+        .def("get_statistics", &RawDevelopPool::getStatistics)
+        // A RAW already on the host, bytes or a CapturedImage, on the calling thread
+        .def_static("develop", [](py::buffer data, EdsUInt32 bits, EdsUInt32 maxSize, EdsImageSource source) {
+            py::buffer_info info = data.request();
+            DevelopedImageRef image = std::make_shared<DevelopedImage>();
+            EdsError err;
+            {
+                py::gil_scoped_release release;
+                err = RawDevelopPool::develop(info.ptr, (EdsUInt64)(info.size * info.itemsize), source,
+                    bits == 8 ? kEdsTargetImageType_RGB : kEdsTargetImageType_RGB16, maxSize, *image);
+            }
+            if (err != EDS_ERR_OK)
+                throw std::runtime_error("EdsGetImage failed: " + std::to_string(err));
+            return image;
+        }, py::arg("data"), py::arg("bits") = (EdsUInt32)16, py::arg("max_size") = (EdsUInt32)0, py::arg("source") = kEdsImageSrc_FullView);
+
+    // --- Shoot pipeline ---
+    py::enum_<ShotFiles>(m, "ShotFiles", py::arithmetic())
+        .value("JPEG", kShotFiles_Jpeg)
+        .value("RAW", kShotFiles_Raw)
+        .value("RAW_JPEG", kShotFiles_RawJpeg);
+
+    py::class_<SHOT_TIMING>(m, "ShotTiming")
+        .def_readonly("request_micros", &SHOT_TIMING::requestMicros)
+        .def_readonly("release_micros", &SHOT_TIMING::releaseMicros)
+        .def_readonly("transfer_request_micros", &SHOT_TIMING::transferRequestMicros)
+        .def_readonly("download_start_micros", &SHOT_TIMING::downloadStartMicros)
+        .def_readonly("download_end_micros", &SHOT_TIMING::downloadEndMicros)
+        .def_readonly("decode_start_micros", &SHOT_TIMING::decodeStartMicros)
+        .def_readonly("decode_end_micros", &SHOT_TIMING::decodeEndMicros)
+        .def_readonly("complete_micros", &SHOT_TIMING::completeMicros);
+
+    py::class_<SHOOT_PIPELINE_STATISTICS>(m, "ShootPipelineStatistics")
+        .def_readonly("shots", &SHOOT_PIPELINE_STATISTICS::shots)
+        .def_readonly("completed", &SHOOT_PIPELINE_STATISTICS::completed)
+        .def_readonly("failed", &SHOOT_PIPELINE_STATISTICS::failed)
+        .def_readonly("in_flight", &SHOOT_PIPELINE_STATISTICS::inFlight)
+        .def_readonly("max_in_flight", &SHOOT_PIPELINE_STATISTICS::maxInFlight)
+        .def_readonly("shutter_lag", &SHOOT_PIPELINE_STATISTICS::shutterLag)
+        .def_readonly("transfer_wait", &SHOOT_PIPELINE_STATISTICS::transferWait)
+        .def_readonly("transfer", &SHOOT_PIPELINE_STATISTICS::transfer)
+        .def_readonly("decode", &SHOOT_PIPELINE_STATISTICS::decode)
+        .def_readonly("total", &SHOOT_PIPELINE_STATISTICS::total)
+        .def_readonly("shots_per_second", &SHOOT_PIPELINE_STATISTICS::shotsPerSecond);
+
+    py::class_<ShotFuture, ShotFutureRef>(m, "ShotFuture")
+        .def("wait", &ShotFuture::wait, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>())
+        .def("wait_released", &ShotFuture::waitReleased, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>())
+        .def("is_done", &ShotFuture::isDone)
+        .def("get_error", &ShotFuture::getError)
+        .def_property_readonly("index", &ShotFuture::getIndex)
+        .def_property_readonly("jpeg", &ShotFuture::getJpeg)
+        .def_property_readonly("raw", &ShotFuture::getRaw)
+        .def_property_readonly("decoded", &ShotFuture::getDecoded)
+        .def_property_readonly("timing", &ShotFuture::getTiming)
+        // Waits, and raises unless the shot completed
+        .def("result", [](ShotFuture &shot, int timeoutMillis) {
+            bool done;
+            {
+                py::gil_scoped_release release;
+                done = shot.wait(timeoutMillis);
+            }
+            if (!done)
+                throw py::value_error("shot not complete within the timeout");
+            EdsError err = shot.getError();
+            if (err != EDS_ERR_OK)
+                throw std::runtime_error("Shot failed: " + std::to_string(err));
+            DecodedImageRef decoded = shot.getDecoded();
+            return decoded ? py::cast(decoded) : py::cast(shot.getJpeg());
+        }, py::arg("timeout_ms") = -1);
+
+    py::class_<ShootPipeline, ShootPipelineRef>(m, "ShootPipeline")
+        .def(py::init([](CameraController *controller, ShotFiles files, EdsUInt32 workerCount) {
+                 return std::make_shared<ShootPipeline>(controller, files, workerCount);
+             }), py::arg("controller"), py::arg("files") = kShotFiles_Jpeg,
+             py::arg("worker_count") = (EdsUInt32)ShootPipeline::kDefaultWorkerCount, py::keep_alive<1, 2>())
+        .def("set_decode", &ShootPipeline::setDecode)
+        .def("set_pixel_format", &ShootPipeline::setPixelFormat)
+        .def("set_scale", &ShootPipeline::setScale)
+        .def("set_max_in_flight", &ShootPipeline::setMaxInFlight)
+        .def("set_auto_focus", &ShootPipeline::setAutoFocus)
+        .def("get_auto_focus", &ShootPipeline::getAutoFocus)
+        .def("get_files", &ShootPipeline::getFiles)
+        .def("get_decode", &ShootPipeline::getDecode)
+        .def("is_running", &ShootPipeline::isRunning)
+        .def("start", &ShootPipeline::start)
+        .def("stop", &ShootPipeline::stop, py::call_guard<py::gil_scoped_release>())
+        .def("shoot", &ShootPipeline::shoot, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>())
+        .def("get_statistics", &ShootPipeline::getStatistics);
+
+    py::class_<FOCUS_BRACKET_SLICE>(m, "FocusBracketSlice")
+        .def_readonly("index", &FOCUS_BRACKET_SLICE::index)
+        .def_readonly("position", &FOCUS_BRACKET_SLICE::position)
+        .def_readonly("drive_commands", &FOCUS_BRACKET_SLICE::driveCommands)
+        .def_readonly("busy_retries", &FOCUS_BRACKET_SLICE::busyRetries)
+        .def_readonly("error", &FOCUS_BRACKET_SLICE::error)
+        .def_readonly("drive_start_micros", &FOCUS_BRACKET_SLICE::driveStartMicros)
+        .def_readonly("drive_end_micros", &FOCUS_BRACKET_SLICE::driveEndMicros)
+        .def_readonly("settled_micros", &FOCUS_BRACKET_SLICE::settledMicros)
+        .def_readonly("timing", &FOCUS_BRACKET_SLICE::timing)
+        .def_readonly("shot", &FOCUS_BRACKET_SLICE::shot);
+
+    py::class_<FOCUS_BRACKET_RESULT>(m, "FocusBracketResult")
+        .def_readonly("success", &FOCUS_BRACKET_RESULT::success)
+        .def_readonly("error", &FOCUS_BRACKET_RESULT::error)
+        .def_readonly("released", &FOCUS_BRACKET_RESULT::released)
+        .def_readonly("completed", &FOCUS_BRACKET_RESULT::completed)
+        .def_readonly("lens_steps", &FOCUS_BRACKET_RESULT::lensSteps)
+        .def_readonly("end_position", &FOCUS_BRACKET_RESULT::endPosition)
+        .def_readonly("elapsed_micros", &FOCUS_BRACKET_RESULT::elapsedMicros)
+        .def_readonly("slices", &FOCUS_BRACKET_RESULT::slices);
+
+    py::class_<FocusBracket>(m, "FocusBracket")
+        .def(py::init<CameraController*, const ShootPipelineRef&>(), py::arg("controller"), py::arg("pipeline"),
+             py::keep_alive<1, 2>())
+        .def("set_steps", &FocusBracket::setSteps, py::arg("count"), py::arg("step_size") = 1, py::arg("steps_per_slice") = 1)
+        .def("set_toward_far", &FocusBracket::setTowardFar)
+        .def("set_settle", &FocusBracket::setSettle, py::arg("millisec"))
+        .def("set_return_to_start", &FocusBracket::setReturnToStart)
+        .def("set_shot_timeout", &FocusBracket::setShotTimeout, py::arg("millisec"))
+        .def("get_count", &FocusBracket::getCount)
+        .def("get_step_size", &FocusBracket::getStepSize)
+        .def("get_steps_per_slice", &FocusBracket::getStepsPerSlice)
+        .def("cancel", &FocusBracket::cancel)
+        .def("is_cancelled", &FocusBracket::isCancelled)
+        .def("run", [](FocusBracket &bracket) {
+            FOCUS_BRACKET_RESULT result;
+            {
+                py::gil_scoped_release release;
+                bracket.run(result);
+            }
+            return result;
+        });
+
+    py::enum_<ExposureField>(m, "ExposureField", py::arithmetic())
+        .value("TV", kExposureField_Tv)
+        .value("AV", kExposureField_Av)
+        .value("ISO", kExposureField_Iso)
+        .value("COMPENSATION", kExposureField_Compensation)
+        .value("ALL", kExposureField_All);
+
+    py::class_<EXPOSURE_SETTING>(m, "ExposureSetting")
+        .def(py::init(&ExposureBracket::makeSetting), py::arg("fields"), py::arg("tv") = 0, py::arg("av") = 0,
+             py::arg("iso") = 0, py::arg("exposure_comp") = 0)
+        .def_readwrite("fields", &EXPOSURE_SETTING::fields)
+        .def_readwrite("tv", &EXPOSURE_SETTING::tv)
+        .def_readwrite("av", &EXPOSURE_SETTING::av)
+        .def_readwrite("iso", &EXPOSURE_SETTING::iso)
+        .def_readwrite("exposure_comp", &EXPOSURE_SETTING::exposureComp);
+
+    py::class_<EXPOSURE_BRACKET_SHOT>(m, "ExposureBracketShot")
+        .def_readonly("index", &EXPOSURE_BRACKET_SHOT::index)
+        .def_readonly("setting", &EXPOSURE_BRACKET_SHOT::setting)
+        .def_readonly("property_sets", &EXPOSURE_BRACKET_SHOT::propertySets)
+        .def_readonly("busy_retries", &EXPOSURE_BRACKET_SHOT::busyRetries)
+        .def_readonly("error", &EXPOSURE_BRACKET_SHOT::error)
+        .def_readonly("set_start_micros", &EXPOSURE_BRACKET_SHOT::setStartMicros)
+        .def_readonly("set_end_micros", &EXPOSURE_BRACKET_SHOT::setEndMicros)
+        .def_readonly("timing", &EXPOSURE_BRACKET_SHOT::timing)
+        .def_readonly("shot", &EXPOSURE_BRACKET_SHOT::shot);
+
+    py::class_<EXPOSURE_BRACKET_RESULT>(m, "ExposureBracketResult")
+        .def_readonly("success", &EXPOSURE_BRACKET_RESULT::success)
+        .def_readonly("error", &EXPOSURE_BRACKET_RESULT::error)
+        .def_readonly("released", &EXPOSURE_BRACKET_RESULT::released)
+        .def_readonly("completed", &EXPOSURE_BRACKET_RESULT::completed)
+        .def_readonly("property_sets", &EXPOSURE_BRACKET_RESULT::propertySets)
+        .def_readonly("elapsed_micros", &EXPOSURE_BRACKET_RESULT::elapsedMicros)
+        .def_readonly("shots", &EXPOSURE_BRACKET_RESULT::shots);
+
+    py::class_<ExposureBracket>(m, "ExposureBracket")
+        .def(py::init<CameraController*, const ShootPipelineRef&>(), py::arg("controller"), py::arg("pipeline"),
+             py::keep_alive<1, 2>())
+        .def("add_setting", &ExposureBracket::addSetting)
+        .def("set_settings", &ExposureBracket::setSettings)
+        .def("clear_settings", &ExposureBracket::clearSettings)
+        .def("get_settings", &ExposureBracket::getSettings)
+        .def("set_busy_policy", &ExposureBracket::setBusyPolicy)
+        .def("get_busy_policy", &ExposureBracket::getBusyPolicy)
+        .def("set_restore", &ExposureBracket::setRestore)
+        .def("set_shot_timeout", &ExposureBracket::setShotTimeout, py::arg("millisec"))
+        .def("cancel", &ExposureBracket::cancel)
+        .def("is_cancelled", &ExposureBracket::isCancelled)
+        .def("run", [](ExposureBracket &bracket) {
+            EXPOSURE_BRACKET_RESULT result;
+            {
+                py::gil_scoped_release release;
+                bracket.run(result);
+            }
+            return result;
+        });
+
+    // --- Motion trigger ---
+    py::enum_<MotionModel>(m, "MotionModel")
+        .value("FRAME_DIFFERENCE", kMotionModel_FrameDifference)
+        .value("BACKGROUND", kMotionModel_Background);
+
+    py::enum_<MotionAction>(m, "MotionAction", py::arithmetic())
+        .value("NOTIFY", kMotionAction_Notify)
+        .value("CAPTURE", kMotionAction_Capture);
+
+    py::class_<MOTION_EVENT>(m, "MotionEvent")
+        .def_readonly("index", &MOTION_EVENT::index)
+        .def_readonly("frame_sequence", &MOTION_EVENT::frameSequence)
+        .def_readonly("score", &MOTION_EVENT::score)
+        .def_readonly("frame_micros", &MOTION_EVENT::frameMicros)
+        .def_readonly("detect_micros", &MOTION_EVENT::detectMicros)
+        .def_readonly("latency_micros", &MOTION_EVENT::latencyMicros)
+        .def_readonly("shot", &MOTION_EVENT::shot);
+
+    py::class_<MOTION_TRIGGER_STATISTICS>(m, "MotionTriggerStatistics")
+        .def_readonly("frames", &MOTION_TRIGGER_STATISTICS::frames)
+        .def_readonly("scored", &MOTION_TRIGGER_STATISTICS::scored)
+        .def_readonly("failed", &MOTION_TRIGGER_STATISTICS::failed)
+        .def_readonly("triggers", &MOTION_TRIGGER_STATISTICS::triggers)
+        .def_readonly("suppressed", &MOTION_TRIGGER_STATISTICS::suppressed)
+        .def_readonly("last_score", &MOTION_TRIGGER_STATISTICS::lastScore)
+        .def_readonly("peak_score", &MOTION_TRIGGER_STATISTICS::peakScore)
+        .def_readonly("detect", &MOTION_TRIGGER_STATISTICS::detect)
+        .def_readonly("release", &MOTION_TRIGGER_STATISTICS::release);
+
+    // pump.add_sink(trigger); frames are scored on the pump thread
+    py::class_<MotionTrigger, EvfFrameSink>(m, "MotionTrigger")
+        .def(py::init<CameraController*>(), py::arg("controller") = nullptr, py::keep_alive<1, 2>())
+        .def("set_pipeline", &MotionTrigger::setPipeline)
+        .def("set_model", &MotionTrigger::setModel, py::arg("model"), py::arg("background_shift") = 3)
+        .def("set_threshold", &MotionTrigger::setThreshold, py::arg("threshold"),
+             py::arg("pixel_threshold") = (int)MotionTrigger::kDefaultPixelThreshold)
+        .def("set_scale", &MotionTrigger::setScale)
+        .def("set_region", &MotionTrigger::setRegion, py::arg("region"), py::arg("space") = kEvfCoordinate_JpegLarge)
+        .def("clear_region", &MotionTrigger::clearRegion)
+        .def("set_warmup_frames", &MotionTrigger::setWarmupFrames)
+        .def("set_cooldown", &MotionTrigger::setCooldown, py::arg("millisec"))
+        .def("set_actions", &MotionTrigger::setActions)
+        .def("set_auto_focus", &MotionTrigger::setAutoFocus)
+        .def("arm", &MotionTrigger::arm, py::arg("armed") = true)
+        .def("is_armed", &MotionTrigger::isArmed)
+        .def("reset", &MotionTrigger::reset)
+        // callback(MotionEvent), on the pump thread
+        .def("add_listener", [](MotionTrigger &trigger, py::function callback) {
+            std::shared_ptr<py::function> held(new py::function(callback), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            trigger.addListener([held](const MOTION_EVENT &e) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    (*held)(e);
+                }
+                catch (py::error_already_set &error)
+                {
+                    error.discard_as_unraisable("motion listener");
+                }
+            });
+        })
+        .def("get_statistics", &MotionTrigger::getStatistics);
+
+    // --- Storage index ---
+    py::enum_<StorageChangeKind>(m, "StorageChangeKind")
+        .value("SCANNED", kStorageChange_Scanned)
+        .value("ITEM_ADDED", kStorageChange_ItemAdded)
+        .value("ITEM_REMOVED", kStorageChange_ItemRemoved)
+        .value("ITEM_CHANGED", kStorageChange_ItemChanged)
+        .value("VOLUME_CHANGED", kStorageChange_VolumeChanged);
+
+    py::class_<STORAGE_INDEX_STATISTICS>(m, "StorageIndexStatistics")
+        .def_readonly("volumes", &STORAGE_INDEX_STATISTICS::volumes)
+        .def_readonly("files", &STORAGE_INDEX_STATISTICS::files)
+        .def_readonly("folders", &STORAGE_INDEX_STATISTICS::folders)
+        .def_readonly("bytes", &STORAGE_INDEX_STATISTICS::bytes)
+        .def_readonly("scans", &STORAGE_INDEX_STATISTICS::scans)
+        .def_readonly("updates", &STORAGE_INDEX_STATISTICS::updates)
+        .def_readonly("last_scan_micros", &STORAGE_INDEX_STATISTICS::lastScanMicros)
+        .def_readonly("generation", &STORAGE_INDEX_STATISTICS::generation);
+
+    py::class_<EdsVolumeInfo>(m, "EdsVolumeInfo")
+        .def_readonly("storage_type", &EdsVolumeInfo::storageType)
+        .def_readonly("access", &EdsVolumeInfo::access)
+        .def_readonly("max_capacity", &EdsVolumeInfo::maxCapacity)
+        .def_readonly("free_space", &EdsVolumeInfo::freeSpaceInBytes)
+        .def_property_readonly("label", [](const EdsVolumeInfo &info) { return std::string(info.szVolumeLabel); });
+
+    py::class_<StorageVolume, StorageVolumeRef>(m, "StorageVolume")
+        .def_property_readonly("ref", &StorageVolume::getRef)
+        .def_property_readonly("info", &StorageVolume::getInfo)
+        .def_property_readonly("index", &StorageVolume::getIndex)
+        .def_property_readonly("name", &StorageVolume::getName);
+
+    // ref stays valid while the item is in the index, e.g. for
+    // CameraController.download() or get_thumbnail()
+    py::class_<StorageItem, StorageItemRef>(m, "StorageItem")
+        .def_property_readonly("ref", &StorageItem::getRef)
+        .def_property_readonly("info", &StorageItem::getInfo)
+        .def_property_readonly("file_name", [](const StorageItem &item) { return std::string(item.getFileName()); })
+        .def_property_readonly("size", &StorageItem::getSize)
+        .def_property_readonly("date_time", &StorageItem::getDateTime)
+        .def_property_readonly("format", &StorageItem::getFormat)
+        .def_property_readonly("group_id", &StorageItem::getGroupID)
+        .def_property_readonly("is_folder", &StorageItem::isFolder)
+        .def_property_readonly("volume", &StorageItem::getVolume)
+        .def_property_readonly("folder", &StorageItem::getFolder)
+        .def_property_readonly("path", &StorageItem::getPath);
+
+    py::class_<StorageIndex, StorageIndexRef>(m, "StorageIndex")
+        .def("is_built", &StorageIndex::isBuilt)
+        .def("is_active", &StorageIndex::isActive)
+        .def("get_statistics", &StorageIndex::getStatistics)
+        .def("get_volumes", &StorageIndex::getVolumes)
+        .def("find_path", &StorageIndex::findPath, py::arg("path"))
+        .def("find_by_name", &StorageIndex::findByName, py::arg("name"))
+        .def("find_by_date", &StorageIndex::findByDate, py::arg("first"), py::arg("last"))
+        .def("find_by_size", &StorageIndex::findBySize, py::arg("minimum"), py::arg("maximum"))
+        .def("get_files", &StorageIndex::getFiles, py::arg("folder") = std::string())
+        .def("get_folders", &StorageIndex::getFolders, py::arg("folder"))
+        .def("clear", &StorageIndex::clear);
+
+    // --- Card import ---
+    py::enum_<CardImportResult>(m, "CardImportResult")
+        .value("IMPORTED", kCardImport_Imported)
+        .value("SKIPPED", kCardImport_Skipped)
+        .value("DUPLICATE", kCardImport_Duplicate)
+        .value("FAILED", kCardImport_Failed)
+        .value("CANCELLED", kCardImport_Cancelled);
+
+    py::class_<CARD_IMPORT_STATISTICS>(m, "CardImportStatistics")
+        .def_readonly("files", &CARD_IMPORT_STATISTICS::files)
+        .def_readonly("pending", &CARD_IMPORT_STATISTICS::pending)
+        .def_readonly("imported", &CARD_IMPORT_STATISTICS::imported)
+        .def_readonly("skipped", &CARD_IMPORT_STATISTICS::skipped)
+        .def_readonly("duplicates", &CARD_IMPORT_STATISTICS::duplicates)
+        .def_readonly("failed", &CARD_IMPORT_STATISTICS::failed)
+        .def_readonly("cancelled", &CARD_IMPORT_STATISTICS::cancelled)
+        .def_readonly("bytes", &CARD_IMPORT_STATISTICS::bytes)
+        .def_readonly("skipped_bytes", &CARD_IMPORT_STATISTICS::skippedBytes)
+        .def_readonly("transfer_micros", &CARD_IMPORT_STATISTICS::transferMicros)
+        .def_readonly("elapsed_micros", &CARD_IMPORT_STATISTICS::elapsedMicros)
+        .def_readonly("bytes_per_second", &CARD_IMPORT_STATISTICS::bytesPerSecond);
+
+    py::class_<CardImport, CardImportRef>(m, "CardImport")
+        .def(py::init<CameraController*, const std::string&, const std::string&>(),
+             py::arg("controller"), py::arg("directory"), py::arg("journal_path") = std::string(), py::keep_alive<1, 2>())
+        .def_property_readonly("directory", &CardImport::getDirectory)
+        .def_property_readonly("journal_path", &CardImport::getJournalPath)
+        .def("set_keep_folders", &CardImport::setKeepFolders)
+        .def("set_verify_existing", &CardImport::setVerifyExisting)
+        .def("set_chunk_size", &CardImport::setChunkSize)
+        // callback(item, result, error, path) on the transfer thread
+        .def("set_handler", [](CardImport &import, py::object callback) {
+            if (callback.is_none())
+            {
+                import.setHandler(CardImportHandler());
+                return;
+            }
+            std::shared_ptr<py::function> held(new py::function(callback.cast<py::function>()), [](py::function *function) {
+                py::gil_scoped_acquire gil;
+                delete function;
+            });
+            import.setHandler([held](const StorageItemRef &item, CardImportResult result, EdsError err, const std::string &path) {
+                py::gil_scoped_acquire gil;
+                try
+                {
+                    (*held)(item, result, err, path);
+                }
+                catch (py::error_already_set &e)
+                {
+                    e.discard_as_unraisable("card import handler");
+                }
+            });
+        })
+        .def("start", [](CardImport &import, const StorageItemList &items) {
+            EdsError err = import.start(items);
+            if (err != EDS_ERR_OK)
+                throw std::runtime_error("Opening the import journal failed: " + std::to_string(err));
+        }, py::arg("items"), py::call_guard<py::gil_scoped_release>())
+        .def("wait", &CardImport::wait, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>())
+        .def("cancel", &CardImport::cancel)
+        .def("get_statistics", &CardImport::getStatistics)
+        .def("get_journal_size", &CardImport::getJournalSize);
+
+    // --- Chunked download pipeline ---
+    m.def("xxhash64", [](py::buffer data, EdsUInt64 seed) {
+        py::buffer_info info = data.request();
+        py::gil_scoped_release release;
+        return XxHash64::hash(info.ptr, (size_t)(info.size * info.itemsize), seed);
+    }, py::arg("data"), py::arg("seed") = 0);
+
+    py::class_<DownloadSink, PyDownloadSink, DownloadSinkRef>(m, "DownloadSink")
+        .def(py::init<>())
+        .def("begin", &DownloadSink::begin)
+        .def("end", &DownloadSink::end);
+
+    py::class_<FileDownloadSink, DownloadSink, std::shared_ptr<FileDownloadSink>>(m, "FileDownloadSink")
+        .def(py::init<const std::string&>(), py::arg("directory") = std::string())
+        .def("get_directory", &FileDownloadSink::getDirectory)
+        .def("get_path", &FileDownloadSink::getPath);
+
+    py::class_<HashDownloadSink, DownloadSink, std::shared_ptr<HashDownloadSink>>(m, "HashDownloadSink")
+        .def(py::init<EdsUInt64>(), py::arg("seed") = 0)
+        .def("get_digest", &HashDownloadSink::getDigest)
+        .def("get_length", &HashDownloadSink::getLength)
+        .def("get_file_name", &HashDownloadSink::getFileName);
+
+    py::class_<MemoryDownloadSink, DownloadSink, std::shared_ptr<MemoryDownloadSink>>(m, "MemoryDownloadSink")
+        .def(py::init<>());
+
+    // pipeline.add_sink(SharedFrameDownloadSink(ring)) shares each capture
+    py::class_<SharedFrameDownloadSink, DownloadSink, std::shared_ptr<SharedFrameDownloadSink>>(m, "SharedFrameDownloadSink")
+        .def(py::init<SharedFrameRing*>(), py::arg("ring"), py::keep_alive<1, 2>());
+
+    m.def("expand_path_template", [](const std::string &pathTemplate, CameraModel *model, const std::string &fileName, EdsUInt64 sequence) {
+        EdsDirectoryItemInfo info = {};
+        strncpy(info.szFileName, fileName.c_str(), EDS_MAX_NAME - 1);
+        return expandPathTemplate(pathTemplate, model, info, sequence);
+    }, py::arg("path_template"), py::arg("model"), py::arg("file_name"), py::arg("sequence") = 0);
+
+    py::class_<ASYNC_FILE_STATISTICS>(m, "AsyncFileStatistics")
+        .def_readonly("files", &ASYNC_FILE_STATISTICS::files)
+        .def_readonly("failed_files", &ASYNC_FILE_STATISTICS::failedFiles)
+        .def_readonly("bytes", &ASYNC_FILE_STATISTICS::bytes)
+        .def_readonly("writes", &ASYNC_FILE_STATISTICS::writes)
+        .def_readonly("wait_micros", &ASYNC_FILE_STATISTICS::waitMicros);
+
+    py::class_<AsyncFileSink, DownloadSink, std::shared_ptr<AsyncFileSink>>(m, "AsyncFileSink")
+        .def(py::init<const std::string&, EdsUInt32, EdsUInt32, bool>(),
+             py::arg("path_template"),
+             py::arg("write_size") = (EdsUInt32)AsyncFileSink::kDefaultWriteSize,
+             py::arg("buffer_count") = (EdsUInt32)AsyncFileSink::kDefaultBufferCount,
+             py::arg("unbuffered") = true)
+        .def("set_preallocate", &AsyncFileSink::setPreallocate)
+        .def("set_sequence", &AsyncFileSink::setSequence)
+        .def("get_path_template", &AsyncFileSink::getPathTemplate)
+        .def("get_path", &AsyncFileSink::getPath)
+        .def("get_statistics", &AsyncFileSink::getStatistics);
+
+    py::class_<DOWNLOAD_PIPELINE_STATISTICS>(m, "DownloadPipelineStatistics")
+        .def_readonly("files", &DOWNLOAD_PIPELINE_STATISTICS::files)
+        .def_readonly("failed_files", &DOWNLOAD_PIPELINE_STATISTICS::failedFiles)
+        .def_readonly("bytes", &DOWNLOAD_PIPELINE_STATISTICS::bytes)
+        .def_readonly("chunks", &DOWNLOAD_PIPELINE_STATISTICS::chunks)
+        .def_readonly("transfer_micros", &DOWNLOAD_PIPELINE_STATISTICS::transferMicros)
+        .def_readonly("stall_micros", &DOWNLOAD_PIPELINE_STATISTICS::stallMicros)
+        .def_readonly("sink_micros", &DOWNLOAD_PIPELINE_STATISTICS::sinkMicros)
+        .def_readonly("chunk_size", &DOWNLOAD_PIPELINE_STATISTICS::chunkSize)
+        .def_readonly("chunk_count", &DOWNLOAD_PIPELINE_STATISTICS::chunkCount);
+
+    py::class_<DownloadPipeline, DownloadPipelineRef>(m, "DownloadPipeline")
+        .def(py::init<EdsUInt32, EdsUInt32>(),
+             py::arg("chunk_size") = (EdsUInt32)DownloadPipeline::kDefaultChunkSize,
+             py::arg("chunk_count") = (EdsUInt32)DownloadPipeline::kDefaultChunkCount)
+        .def("start", &DownloadPipeline::start)
+        .def("stop", &DownloadPipeline::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &DownloadPipeline::isRunning)
+        .def("add_sink", &DownloadPipeline::addSink, py::keep_alive<1, 2>())
+        .def("remove_sink", &DownloadPipeline::removeSink)
+        .def("clear_sinks", &DownloadPipeline::clearSinks)
+        .def("get_sink_count", &DownloadPipeline::getSinkCount)
+        .def("set_chunk_size", &DownloadPipeline::setChunkSize)
+        .def("get_chunk_size", &DownloadPipeline::getChunkSize)
+        .def("set_chunk_count", &DownloadPipeline::setChunkCount)
+        .def("get_chunk_count", &DownloadPipeline::getChunkCount)
+        .def("get_statistics", &DownloadPipeline::getStatistics)
+        .def("reset_statistics", &DownloadPipeline::resetStatistics);
+
     // ==========================================================================
     // 3. UTILITY CLASSES
     // ==========================================================================
@@ -203,32 +2749,133 @@ PYBIND11_MODULE(edsdk_bindings, m) {
     py::class_<ActionListener>(m, "ActionListener")
         .def("action_performed", &ActionListener::actionPerformed);
         
+    py::enum_<CameraEventID>(m, "CameraEventID")
+        .value("CUSTOM", kCameraEvent_Custom)
+        .value("PROPERTY_CHANGED", kCameraEvent_PropertyChanged)
+        .value("PROPERTIES_CHANGED", kCameraEvent_PropertiesChanged)
+        .value("PROPERTY_DESC_CHANGED", kCameraEvent_PropertyDescChanged)
+        .value("EVF_DATA_CHANGED", kCameraEvent_EvfDataChanged)
+        .value("DOWNLOAD_START", kCameraEvent_DownloadStart)
+        .value("DOWNLOAD_COMPLETE", kCameraEvent_DownloadComplete)
+        .value("PROGRESS_REPORT", kCameraEvent_ProgressReport)
+        .value("DEVICE_BUSY", kCameraEvent_DeviceBusy)
+        .value("ERROR", kCameraEvent_Error)
+        .value("SHUT_DOWN", kCameraEvent_ShutDown)
+        .value("STORAGE_CHANGED", kCameraEvent_StorageChanged);
+
+    m.def("camera_event_mask", &cameraEventMask);
+
     py::class_<CameraEvent>(m, "CameraEvent")
         .def(py::init<const std::string&>())
         .def(py::init<const std::string&, void*>())
+        .def(py::init<CameraEventID>())
         .def("get_event", &CameraEvent::getEvent)
+        .def("get_id", &CameraEvent::getID)
         .def("get_arg", &CameraEvent::getArg);
         
-    py::class_<Observer>(m, "Observer")
+    // --- Event queue to Python ---
+    py::class_<QUEUED_EVENT>(m, "QueuedEvent")
+        .def_readonly("id", &QUEUED_EVENT::id)
+        .def_readonly("source", &QUEUED_EVENT::source)
+        .def_readonly("sequence", &QUEUED_EVENT::sequence)
+        .def_readonly("timestamp_micros", &QUEUED_EVENT::timestampMicros)
+        .def_readonly("param", &QUEUED_EVENT::param)
+        .def("__repr__", [](const QUEUED_EVENT &event) {
+            return "<QueuedEvent " + CameraEvent::nameOf(event.id) + " source=" + std::to_string(event.source) +
+                   " param=" + std::to_string(event.param) + ">";
+        });
+
+    py::class_<EVENT_QUEUE_STATISTICS>(m, "EventQueueStatistics")
+        .def_readonly("pushed", &EVENT_QUEUE_STATISTICS::pushed)
+        .def_readonly("drained", &EVENT_QUEUE_STATISTICS::drained)
+        .def_readonly("overflows", &EVENT_QUEUE_STATISTICS::overflows)
+        .def_readonly("capacity", &EVENT_QUEUE_STATISTICS::capacity)
+        .def_readonly("depth", &EVENT_QUEUE_STATISTICS::depth);
+
+    py::class_<EventQueue>(m, "EventQueue")
+        .def(py::init<EdsUInt32>(), py::arg("capacity") = (EdsUInt32)EventQueue::kDefaultCapacity)
+        .def("attach", &EventQueue::attach, py::arg("model"), py::arg("tag") = 0,
+             py::arg("mask") = kCameraEventMask_All, py::keep_alive<1, 2>())
+        .def("detach", &EventQueue::detach)
+        .def("detach_all", &EventQueue::detachAll)
+        .def("drain", [](EventQueue &queue, size_t maxEvents) {
+            std::vector<QUEUED_EVENT> events;
+            queue.drain(events, maxEvents);
+            return events;
+        }, py::arg("max_events") = 0)
+        .def("wait", &EventQueue::wait, py::arg("timeout_ms"), py::call_guard<py::gil_scoped_release>())
+        .def("empty", &EventQueue::empty)
+        .def("get_wait_fd", &EventQueue::getWaitFd)
+        .def("fileno", &EventQueue::getWaitFd)
+        .def("get_statistics", &EventQueue::getStatistics);
+
+    // Reads take no lock and never wait on the processor
+    py::class_<PROPERTY_VALUE>(m, "PropertyValue")
+        .def_readonly("data_type", &PROPERTY_VALUE::dataType)
+        .def_readonly("size", &PROPERTY_VALUE::size)
+        .def_readonly("version", &PROPERTY_VALUE::version)
+        .def_property_readonly("data", [](const PROPERTY_VALUE &value) {
+            return py::bytes(reinterpret_cast<const char *>(value.data), value.size);
+        });
+
+    py::class_<PropertyStore, std::unique_ptr<PropertyStore, py::nodelete>>(m, "PropertyStore")
+        .def("get_value", [](const PropertyStore &store, EdsUInt32 propertyID) -> py::object {
+            PROPERTY_VALUE value;
+            if (!store.getValue(propertyID, value))
+                return py::none();
+            return py::cast(value);
+        }, py::arg("property_id"))
+        .def("get_uint32", &PropertyStore::getUInt32, py::arg("property_id"), py::arg("default_value") = 0xffffffff)
+        .def("get_desc", [](const PropertyStore &store, EdsUInt32 propertyID) {
+            EdsPropertyDesc desc = store.getDesc(propertyID);
+            return std::vector<EdsInt32>(desc.propDesc, desc.propDesc + desc.numElements);
+        }, py::arg("property_id"))
+        .def("get_version", &PropertyStore::getVersion, py::arg("property_id"))
+        .def("get_desc_version", &PropertyStore::getDescVersion, py::arg("property_id"))
+        .def("get_generation", &PropertyStore::getGeneration)
+        .def("get_property_ids", &PropertyStore::getPropertyIDs);
+
+    py::class_<Observer, PyObserver>(m, "Observer")
+        .def(py::init<>())
         .def("update", &Observer::update);
+
+    py::class_<EventObserver, PyEventObserver>(m, "EventObserver")
+        .def(py::init<>())
+        .def("on_event", [](EventObserver &observer, Observable *from, const CameraEvent *e) { observer.onEvent(from, *e); });
         
+    // Adding and removing never waits for a notification in progress; the
+    // observers stay alive with the observable, so one still being called
+    // from an older list is safe.
     py::class_<Observable>(m, "Observable")
-        .def("add_observer", &Observable::addObserver)
-        .def("remove_observer", &Observable::removeObserver)
+        // Only events in mask and, of the property events, those about one
+        // of properties reach the observer; the rest never take the GIL
+        .def("add_observer", [](Observable &observable, Observer *observer, EdsUInt32 mask, const PropertyIDList &properties) {
+            observable.addObserver(observer, EventFilter(mask, properties));
+        }, py::arg("observer"), py::arg("mask") = kCameraEventMask_All, py::arg("properties") = PropertyIDList(),
+           py::keep_alive<1, 2>())
+        .def("remove_observer", &Observable::deleteObserver)
+        .def("add_event_observer", [](Observable &observable, EventObserver *observer, EdsUInt32 mask, const PropertyIDList &properties) {
+            observable.addEventObserver(observer, EventFilter(mask, properties));
+        }, py::arg("observer"), py::arg("mask") = kCameraEventMask_All, py::arg("properties") = PropertyIDList(),
+           py::keep_alive<1, 2>())
+        .def("remove_event_observer", &Observable::deleteEventObserver)
         .def("notify_observers", &Observable::notifyObservers);
 
     // --- Threading ---
     py::class_<Thread>(m, "Thread")
         .def("start", &Thread::start)
-        .def("join", &Thread::join)
-        .def("suspend", &Thread::suspend)
-        .def("resume", &Thread::resume);
+        .def("join", &Thread::join, py::call_guard<py::gil_scoped_release>())
+        .def("is_active", &Thread::isActive)
+        .def("set_name", &Thread::setName)
+        .def("get_name", &Thread::getName)
+        .def("set_placement", &Thread::setPlacement)
+        .def("get_placement", &Thread::getPlacement);
         
     py::class_<Synchronized>(m, "Synchronized")
         .def(py::init<>())
-        .def("lock", &Synchronized::lock)
+        .def("lock", &Synchronized::lock, py::call_guard<py::gil_scoped_release>())
         .def("unlock", &Synchronized::unlock)
-        .def("wait", &Synchronized::wait)
+        .def("wait", &Synchronized::wait, py::call_guard<py::gil_scoped_release>())
         .def("notify", &Synchronized::notify);
 
     // ==========================================================================
@@ -236,75 +2883,74 @@ PYBIND11_MODULE(edsdk_bindings, m) {
     // ==========================================================================
     
     // --- Camera Settings ---
-    py::class_<Tv>(m, "Tv")
-        .def_static("get_label", &Tv::getLabel);
-        
-    py::class_<Av>(m, "Av")
-        .def_static("get_label", &Av::getLabel);
-        
-    py::class_<Iso>(m, "Iso")
-        .def_static("get_label", &Iso::getLabel);
-        
-    py::class_<AEMode>(m, "AEMode")
-        .def_static("get_label", &AEMode::getLabel);
-        
-    py::class_<MeteringMode>(m, "MeteringMode")
-        .def_static("get_label", &MeteringMode::getLabel);
-        
-    py::class_<ExposureComp>(m, "ExposureComp")
-        .def_static("get_label", &ExposureComp::getLabel);
-        
-    py::class_<ImageQuality>(m, "ImageQuality")
-        .def_static("get_label", &ImageQuality::getLabel);
-        
-    py::class_<EvfAFMode>(m, "EvfAFMode")
-        .def_static("get_label", &EvfAFMode::getLabel);
+    // The same tables the GUI uses; nothing is built at import
+    m.def("get_property_label", [](EdsUInt32 propertyID, EdsUInt32 value) {
+        return propertyLabel(findPropertyLabelTable(propertyID), value);
+    }, py::arg("property_id"), py::arg("value"));
+    m.def("get_property_labels", [](EdsUInt32 propertyID) {
+        return propertyLabels(findPropertyLabelTable(propertyID));
+    }, py::arg("property_id"));
+
+    bindPropertyLabelClass<kEdsPropID_Tv>(m, "Tv");
+    bindPropertyLabelClass<kEdsPropID_Av>(m, "Av");
+    bindPropertyLabelClass<kEdsPropID_ISOSpeed>(m, "Iso");
+    bindPropertyLabelClass<kEdsPropID_AEModeSelect>(m, "AEMode");
+    bindPropertyLabelClass<kEdsPropID_MeteringMode>(m, "MeteringMode");
+    bindPropertyLabelClass<kEdsPropID_ExposureCompensation>(m, "ExposureComp");
+    bindPropertyLabelClass<kEdsPropID_ImageQuality>(m, "ImageQuality");
+    bindPropertyLabelClass<kEdsPropID_Evf_AFMode>(m, "EvfAFMode");
 
     // ==========================================================================
     // 5. EDSDK TYPES AND CONSTANTS
     // ==========================================================================
     
     // EdsError values
-    py::enum_<EdsError>(m, "EdsError")
-        .value("OK", EDS_ERR_OK)
-        .value("UNIMPLEMENTED", EDS_ERR_UNIMPLEMENTED)
-        .value("INTERNAL_ERROR", EDS_ERR_INTERNAL_ERROR)
-        .value("MEM_ALLOC_FAILED", EDS_ERR_MEM_ALLOC_FAILED)
-        .value("MEM_FREE_FAILED", EDS_ERR_MEM_FREE_FAILED)
-        .value("OPERATION_CANCELLED", EDS_ERR_OPERATION_CANCELLED)
-        .value("INCOMPATIBLE_VERSION", EDS_ERR_INCOMPATIBLE_VERSION)
-        .value("NOT_SUPPORTED", EDS_ERR_NOT_SUPPORTED)
-        .value("UNEXPECTED_EXCEPTION", EDS_ERR_UNEXPECTED_EXCEPTION)
-        .value("PROTECTION_VIOLATION", EDS_ERR_PROTECTION_VIOLATION)
-        .value("FILE_IO_ERROR", EDS_ERR_FILE_IO_ERROR)
-        .value("DEVICE_NOT_FOUND", EDS_ERR_DEVICE_NOT_FOUND)
-        .value("DEVICE_BUSY", EDS_ERR_DEVICE_BUSY)
-        .value("DEVICE_INVALID", EDS_ERR_DEVICE_INVALID)
-        .value("COMMUNICATION_ERROR", EDS_ERR_COMMUNICATION_ERROR)
-        .value("SESSION_NOT_OPEN", EDS_ERR_SESSION_NOT_OPEN);
+    static const CONSTANT edsErrors[] = {
+        { "OK", EDS_ERR_OK },
+        { "UNIMPLEMENTED", EDS_ERR_UNIMPLEMENTED },
+        { "INTERNAL_ERROR", EDS_ERR_INTERNAL_ERROR },
+        { "MEM_ALLOC_FAILED", EDS_ERR_MEM_ALLOC_FAILED },
+        { "MEM_FREE_FAILED", EDS_ERR_MEM_FREE_FAILED },
+        { "OPERATION_CANCELLED", EDS_ERR_OPERATION_CANCELLED },
+        { "INCOMPATIBLE_VERSION", EDS_ERR_INCOMPATIBLE_VERSION },
+        { "NOT_SUPPORTED", EDS_ERR_NOT_SUPPORTED },
+        { "UNEXPECTED_EXCEPTION", EDS_ERR_UNEXPECTED_EXCEPTION },
+        { "PROTECTION_VIOLATION", EDS_ERR_PROTECTION_VIOLATION },
+        { "FILE_IO_ERROR", EDS_ERR_FILE_IO_ERROR },
+        { "DEVICE_NOT_FOUND", EDS_ERR_DEVICE_NOT_FOUND },
+        { "DEVICE_BUSY", EDS_ERR_DEVICE_BUSY },
+        { "DEVICE_INVALID", EDS_ERR_DEVICE_INVALID },
+        { "COMMUNICATION_ERROR", EDS_ERR_COMM_DISCONNECTED },
+        { "SESSION_NOT_OPEN", EDS_ERR_SESSION_NOT_OPEN }
+    };
+    bindConstantClass<0>(m, "EdsError", edsErrors);
     
     // Camera commands
-    py::enum_<EdsCameraCommand>(m, "EdsCameraCommand")
-        .value("TAKE_PICTURE", kEdsCameraCommand_TakePicture)
-        .value("SHUTTER_BUTTON_HALFWAY", kEdsCameraCommand_ShutterButton_Halfway)
-        .value("SHUTTER_BUTTON_COMPLETELY", kEdsCameraCommand_ShutterButton_Completely)
-        .value("SHUTTER_BUTTON_OFF", kEdsCameraCommand_ShutterButton_OFF);
+    static const CONSTANT cameraCommands[] = {
+        { "TAKE_PICTURE", kEdsCameraCommand_TakePicture },
+        { "SHUTTER_BUTTON_HALFWAY", kEdsCameraCommand_ShutterButton_Halfway },
+        { "SHUTTER_BUTTON_COMPLETELY", kEdsCameraCommand_ShutterButton_Completely },
+        { "SHUTTER_BUTTON_OFF", kEdsCameraCommand_ShutterButton_OFF }
+    };
+    bindConstantClass<1>(m, "EdsCameraCommand", cameraCommands);
     
     // Property IDs
-    py::enum_<EdsPropertyID>(m, "EdsPropertyID")
-        .value("PRODUCT_NAME", kEdsPropID_ProductName)
-        .value("AE_MODE_SELECT", kEdsPropID_AEModeSelect)
-        .value("DRIVE_MODE", kEdsPropID_DriveMode)
-        .value("ISO_SPEED", kEdsPropID_ISOSpeed)
-        .value("METERING_MODE", kEdsPropID_MeteringMode)
-        .value("AF_MODE", kEdsPropID_AFMode)
-        .value("AV", kEdsPropID_Av)
-        .value("TV", kEdsPropID_Tv)
-        .value("EXPOSURE_COMPENSATION", kEdsPropID_ExposureCompensation)
-        .value("IMAGE_QUALITY", kEdsPropID_ImageQuality)
-        .value("EVF_MODE", kEdsPropID_Evf_Mode)
-        .value("EVF_OUTPUT_DEVICE", kEdsPropID_Evf_OutputDevice)
-        .value("EVF_AF_MODE", kEdsPropID_Evf_AFMode);
+    static const CONSTANT propertyIDs[] = {
+        { "PRODUCT_NAME", kEdsPropID_ProductName },
+        { "AE_MODE_SELECT", kEdsPropID_AEModeSelect },
+        { "DRIVE_MODE", kEdsPropID_DriveMode },
+        { "ISO_SPEED", kEdsPropID_ISOSpeed },
+        { "METERING_MODE", kEdsPropID_MeteringMode },
+        { "AF_MODE", kEdsPropID_AFMode },
+        { "AV", kEdsPropID_Av },
+        { "TV", kEdsPropID_Tv },
+        { "EXPOSURE_COMPENSATION", kEdsPropID_ExposureCompensation },
+        { "IMAGE_QUALITY", kEdsPropID_ImageQuality },
+        { "EVF_MODE", kEdsPropID_Evf_Mode },
+        { "EVF_OUTPUT_DEVICE", kEdsPropID_Evf_OutputDevice },
+        { "EVF_AF_MODE", kEdsPropID_Evf_AFMode }
+    };
+    bindConstantClass<2>(m, "EdsPropertyID", propertyIDs);
         
     // EVF Drive Lens
     py::enum_<EdsEvfDriveLens>(m, "EdsEvfDriveLens")
@@ -334,6 +2980,16 @@ PYBIND11_MODULE(edsdk_bindings, m) {
     py::class_<EdsCapacity>(m, "EdsCapacity")
         .def(py::init<>())
         .def_readwrite("number_of_free_clusters", &EdsCapacity::numberOfFreeClusters)
-        .def_readwrite("bytes_per_cluster", &EdsCapacity::bytesPerCluster)
+        .def_readwrite("bytes_per_sector", &EdsCapacity::bytesPerSector)
         .def_readwrite("reset", &EdsCapacity::reset);
+
+    py::class_<EdsDirectoryItemInfo>(m, "EdsDirectoryItemInfo")
+        .def(py::init<>())
+        .def_readonly("size", &EdsDirectoryItemInfo::size)
+        .def_readonly("is_folder", &EdsDirectoryItemInfo::isFolder)
+        .def_readonly("group_id", &EdsDirectoryItemInfo::groupID)
+        .def_readonly("option", &EdsDirectoryItemInfo::option)
+        .def_property_readonly("file_name", [](const EdsDirectoryItemInfo &info) { return std::string(info.szFileName); })
+        .def_readonly("format", &EdsDirectoryItemInfo::format)
+        .def_readonly("date_time", &EdsDirectoryItemInfo::dateTime);
 } 
\ No newline at end of file
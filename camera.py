@@ -2,6 +2,7 @@
 High-level Python wrapper for Canon EDSDK camera control.
 """
 
+import os
 import inspect
 import functools
 from typing import Dict, List, Any, Optional, Tuple, Union, Callable
@@ -12,6 +13,16 @@ except ImportError:
     raise ImportError("Could not import edsdk_bindings. Make sure the C++ bindings have been built.")
 
 
+def _event_mask(events: Optional[List[Any]]) -> int:
+    """Subscription mask for a list of CameraEventID values, None for all."""
+    if events is None:
+        return 0xFFFFFFFF
+    mask = 0
+    for event in events:
+        mask |= edsdk_bindings.camera_event_mask(event)
+    return mask
+
+
 class Canon:
     """Main Canon camera interface providing a Pythonic wrapper."""
     
@@ -20,6 +31,11 @@ class Canon:
         self._controller = edsdk_bindings.CameraController()
         self._model = None
         self._initialized = False
+        self._download_pipeline = None
+        self._download_checksum = None
+        self._raw_develop = None
+        self._shoot_pipeline = None
+        self._lease = None
 
     def initialize(self):
         """Initialize the camera connection."""
@@ -29,11 +45,13 @@ class Canon:
         self._controller.run()
         self._initialized = True
 
-    def connect_to_camera(self, camera_ref=None):
+    def connect_to_camera(self, camera_ref=None, lazy: bool = False):
         """Connect to a Canon camera.
         
         Args:
             camera_ref: Optional camera reference. If None, uses the first available camera.
+            lazy: Read properties on first access instead of as the camera
+                announces them, so live view starts sooner
         """
         # Placeholder for getting camera ref - would need to use EDSDK methods
         if camera_ref is None:
@@ -43,8 +61,70 @@ class Canon:
             
         self._model = edsdk_bindings.CameraModel(camera_ref)
         self._controller.set_camera_model(self._model)
+        if lazy:
+            self._controller.set_startup_mode(edsdk_bindings.StartupMode.LAZY)
         self.initialize()
         
+    @classmethod
+    def from_session(cls, session) -> "Canon":
+        """Wrap a running session of a ``CameraManager``.
+        
+        Args:
+            session: CameraSession, already opened by the manager
+            
+        Returns:
+            Canon driving that camera
+        """
+        camera = cls.__new__(cls)
+        camera._session = session
+        camera._controller = session.get_camera_controller()
+        camera._model = session.get_camera_model()
+        camera._initialized = True
+        camera._download_pipeline = None
+        camera._download_checksum = None
+        camera._raw_develop = None
+        camera._shoot_pipeline = None
+        camera._lease = None
+        return camera
+        
+    @classmethod
+    def attach(cls, port_name: Optional[str] = None) -> "Canon":
+        """Attach to a camera session kept open by the process-wide SDK.
+        
+        The first handle on a camera opens its session; while the SDK stays
+        initialized (see ``core.binding_helpers.initialize_sdk``) the session
+        outlives the handle, and later handles attach to it without
+        EdsOpenSession. Call ``close()`` when done.
+        
+        Args:
+            port_name: Camera to attach to, None for any, preferring one
+                no other handle uses
+            
+        Returns:
+            Canon on the leased session
+        """
+        from .core.binding_helpers import get_sdk_context
+        lease = get_sdk_context().lease(port_name or "")
+        camera = cls.from_session(lease.session)
+        camera._lease = lease
+        return camera
+        
+    def close(self) -> None:
+        """Stop this handle's shooting, RAW development and download pipeline
+        and give an attached session back to the pool, still open."""
+        self.stop_shooting()
+        self.stop_raw_development()
+        if self._download_pipeline is not None and self._model is not None:
+            self._model.set_download_pipeline(None)
+            self._model.set_download_target(edsdk_bindings.DownloadTarget.FILE)
+            self._download_pipeline = None
+            self._download_checksum = None
+        if self._lease is not None:
+            self._lease.release()
+            self._lease = None
+            self._initialized = False
+            self._model = None
+        
     # --------------------------------------------------------------------------
     # Camera operations
     # --------------------------------------------------------------------------
@@ -85,6 +165,648 @@ class Canon:
         self._ensure_connected()
         return self._model.press_shutter_button(edsdk_bindings.EdsCameraCommand.SHUTTER_BUTTON_OFF)
         
+    def arm_shutter(self, auto_focus: bool = True) -> Any:
+        """Half press the shutter and hold it for low latency releases.
+        
+        AF and metering are done once here; ``fire()`` on the returned
+        ArmedShutter then releases straight from the calling thread, past
+        the command queue, and holds the half press again for the next shot.
+        ``wait_for_transfer()`` gives each shot's lag up to the camera's
+        transfer request. Call ``disarm()`` when done.
+        
+        Args:
+            auto_focus: False holds and releases without AF
+            
+        Returns:
+            The armed ArmedShutter
+        """
+        self._ensure_connected()
+        mode = edsdk_bindings.ArmedShutterMode.HALF_PRESS if auto_focus else edsdk_bindings.ArmedShutterMode.NON_AF
+        shutter = edsdk_bindings.ArmedShutter(self._model, mode)
+        err = shutter.arm()
+        if err != 0:
+            raise RuntimeError(f"Arming the shutter failed: {err:#010x}")
+        return shutter
+        
+    def start_sequence(self, schedule: str = "interval", count: int = 1, interval: float = 1.0,
+                       bulb_start: float = 0.0, bulb_end: float = 0.0,
+                       skip_when_busy: bool = True, start_delay: float = 0.0) -> Any:
+        """Run a capture schedule natively, off the GIL.
+        
+        Slots are due against a monotonic clock from the start, so the
+        sequence does not drift; downloads overlap the next exposure.
+        
+        Args:
+            schedule: "interval", "burst" or "bulb_ramp"
+            count: Number of shots, 0 for an interval run until stopped
+            interval: Seconds between shots; for a burst 0 fires each shot
+                as soon as the last one returns
+            bulb_start: Bulb ramp, first exposure in seconds
+            bulb_end: Bulb ramp, last exposure in seconds
+            skip_when_busy: Skip a slot if the last shot is still running,
+                otherwise fire it late
+            start_delay: Seconds before the first shot
+            
+        Returns:
+            Running CaptureSequencer; ``pop_shot`` streams the per-shot timing
+        """
+        self._ensure_connected()
+        sequencer = edsdk_bindings.CaptureSequencer(self._controller, self._model)
+        interval_us = int(interval * 1e6)
+        if schedule == "interval":
+            sequencer.set_interval(count, interval_us)
+        elif schedule == "burst":
+            sequencer.set_burst(count, interval_us)
+        elif schedule == "bulb_ramp":
+            sequencer.set_bulb_ramp(count, interval_us, int(bulb_start * 1e6), int(bulb_end * 1e6))
+        else:
+            raise ValueError(f"Unknown schedule: {schedule}")
+        sequencer.set_busy_policy(edsdk_bindings.SequenceBusyPolicy.SKIP if skip_when_busy
+                                  else edsdk_bindings.SequenceBusyPolicy.DELAY)
+        sequencer.set_start_delay(int(start_delay * 1e6))
+        sequencer.start()
+        return sequencer
+        
+    def create_event_queue(self, capacity: int = 4096, events: Optional[List[Any]] = None) -> Any:
+        """Queue this camera's events for Python to drain in batches.
+        
+        The SDK and processor threads push without taking the GIL; events
+        arriving while the queue is full are counted as overflows.
+        
+        Args:
+            capacity: Queue size, rounded up to a power of two
+            events: CameraEventID values to queue, None for all
+            
+        Returns:
+            EventQueue; call ``drain()``, or ``wait(timeout_ms)`` first.
+            The queue has a ``fileno()``, so it can be registered with a
+            ``selectors`` selector; it is readable until drained.
+        """
+        self._ensure_connected()
+        queue = edsdk_bindings.EventQueue(capacity)
+        queue.attach(self._model, 0, _event_mask(events))
+        return queue
+        
+    # --------------------------------------------------------------------------
+    # Captured image transfer
+    # --------------------------------------------------------------------------
+    
+    def set_download_to_memory(self, enabled: bool = True, preallocate: int = 0,
+                               buffer_size: int = 0) -> None:
+        """Download captured images into memory instead of files.
+        
+        Images are queued on the camera and fetched with ``wait_for_capture``;
+        no bytes are written to disk.
+        
+        Args:
+            enabled: True for memory downloads, False for files in the
+                working directory
+            preallocate: Number of buffers to allocate up front
+            buffer_size: Size of each preallocated buffer in bytes, e.g.
+                the largest RAW file expected
+        """
+        self._ensure_connected()
+        target = edsdk_bindings.DownloadTarget.MEMORY if enabled else edsdk_bindings.DownloadTarget.FILE
+        self._model.set_download_target(target)
+        if enabled and preallocate > 0 and buffer_size > 0:
+            self._model.get_capture_buffer_pool().preallocate(preallocate, buffer_size)
+            
+    def wait_for_capture(self, timeout_ms: int = 5000) -> Any:
+        """Wait for the next image downloaded into memory.
+        
+        The result exposes the file bytes through the buffer protocol
+        (``memoryview(image)``, ``np.frombuffer(image, np.uint8)``) without
+        a copy, and ``image.info`` holds the directory item info.
+        
+        Args:
+            timeout_ms: Maximum wait in milliseconds
+            
+        Returns:
+            CapturedImage, or None on timeout
+        """
+        self._ensure_connected()
+        return self._model.wait_for_capture(timeout_ms)
+
+    def set_save_target(self, target: str = "host", capacity_path: Optional[str] = None) -> None:
+        """Choose where the camera saves shots.
+        
+        With "host" or "both" the camera is told the free space of the
+        download folder, so its shots-left count is real. The choice is
+        kept for sessions reopened later, e.g. after a USB reset.
+        
+        Args:
+            target: "camera", "host" or "both"
+            capacity_path: Folder whose free space is reported; None for
+                the working directory, where downloads are written
+                
+        Raises:
+            ValueError: If target is invalid
+            RuntimeError: If the camera refused the setting
+        """
+        self._ensure_connected()
+        targets = {
+            "camera": edsdk_bindings.SaveTo.CAMERA,
+            "host": edsdk_bindings.SaveTo.HOST,
+            "both": edsdk_bindings.SaveTo.BOTH,
+        }
+        if target not in targets:
+            raise ValueError(f"target must be one of {tuple(targets)}")
+        if capacity_path is not None:
+            self._model.set_host_capacity_path(capacity_path)
+        handle = self._controller.set_save_to(targets[target])
+        if handle.wait(-1) and not handle.succeeded():
+            raise RuntimeError(f"Setting the save target failed: {handle.get_error()}")
+            
+    def set_transfer_rules(self, rules: List[Dict[str, Any]], default: str = "download") -> None:
+        """Choose which shots are downloaded as they are taken.
+        
+        The first rule matching a file decides; the rest use default.
+        Files left on the card never cross the link and can be imported
+        later with ``import_files``. That needs the "both" save target;
+        saving to the host only, every file is downloaded regardless.
+        
+        Args:
+            rules: Dicts with "extension" (e.g. "CR3", "" for any),
+                "action" ("download" or "card"), and optional "min_size"
+                and "max_size" in bytes
+            default: Action for files no rule matches
+            
+        Example:
+            camera.set_save_target("both")
+            camera.set_transfer_rules([{"extension": "CR3", "action": "card"}])
+        """
+        self._ensure_connected()
+        actions = {
+            "download": edsdk_bindings.TransferAction.DOWNLOAD,
+            "card": edsdk_bindings.TransferAction.LEAVE_ON_CARD,
+        }
+        if default not in actions or any(rule.get("action", "card") not in actions for rule in rules):
+            raise ValueError(f"action must be one of {tuple(actions)}")
+        transfer_rules = self._model.get_transfer_rules()
+        transfer_rules.clear()
+        for rule in rules:
+            transfer_rules.add_rule(edsdk_bindings.TransferRule(
+                rule.get("extension", ""), actions[rule.get("action", "card")],
+                rule.get("min_size", 0), rule.get("max_size", 0)))
+        transfer_rules.set_default_action(actions[default])
+        
+    def get_transfer_rule_statistics(self) -> Dict[str, int]:
+        """Requested transfers downloaded and left on the card so far."""
+        self._ensure_connected()
+        stats = self._model.get_transfer_rules().get_statistics()
+        return {
+            "requests": stats.requests,
+            "downloaded": stats.downloaded,
+            "left_on_card": stats.left_on_card,
+            "left_on_card_bytes": stats.left_on_card_bytes,
+            "kept": stats.kept,
+        }
+
+    def start_raw_development(self, worker_count: int = 2, bits: int = 16, max_size: int = 0,
+                              pass_through: bool = False, on_image: Optional[Callable] = None) -> Any:
+        """Develop captured RAWs to NumPy arrays as they are downloaded.
+
+        RAWs are taken from the memory download and developed on a pool of
+        workers, one image each, without going through a file. JPEGs and
+        other files still go to ``wait_for_capture``.
+
+        Args:
+            worker_count: Images developed at once
+            bits: 8 for uint8, 16 for uint16 pixels
+            max_size: Fit the long side to this, 0 for full size
+            pass_through: Also queue the RAW bytes for ``wait_for_capture``
+            on_image: ``on_image(developed)`` for each image, on a worker
+
+        Returns:
+            The RawDevelopPool; ``pop(timeout_ms)`` gives the next
+            DevelopedImage, ``.pixels`` its (height, width, 3) RGB array
+        """
+        self._ensure_connected()
+        self.stop_raw_development()
+        if self._model.get_download_target() == edsdk_bindings.DownloadTarget.FILE:
+            self._model.set_download_target(edsdk_bindings.DownloadTarget.MEMORY)
+        pool = edsdk_bindings.RawDevelopPool(worker_count, bits, max_size)
+        if on_image is not None:
+            pool.add_listener(on_image)
+        pool.start()
+        pool.attach(self._model, pass_through)
+        self._raw_develop = pool
+        return pool
+
+    def stop_raw_development(self) -> None:
+        """Detach the RAW development pool and wait for its workers."""
+        if self._raw_develop is not None:
+            self._raw_develop.detach()
+            self._raw_develop.stop()
+            self._raw_develop = None
+
+    def start_shooting(self, raw: bool = False, jpeg: bool = True, max_in_flight: int = 4,
+                       decode: bool = True, format: str = "rgb", scale: int = 1,
+                       worker_count: int = 2) -> Any:
+        """Capture straight to decoded images in memory.
+        
+        After this, ``shoot()`` releases the shutter and returns a ShotFuture
+        at once. The files are downloaded to memory, matched to their shot
+        and the JPEG decoded on a worker, with several shots in flight so
+        that the camera's buffer sets the pace. Replaces RAW development
+        while it runs.
+        
+        Args:
+            raw: Each shot waits for a RAW file as well
+            jpeg: Each shot waits for a JPEG, decoded unless decode is False
+            max_in_flight: shoot() blocks while this many shots are unfinished
+            decode: Decode the JPEG; without libjpeg shots keep the bytes only
+            format: "rgb", "bgr" or "gray"
+            scale: Decode at 1/1, 1/2, 1/4 or 1/8 size
+            worker_count: JPEGs decoded at once
+            
+        Returns:
+            The ShootPipeline; ``get_statistics()`` breaks the latency down
+            into shutter lag, transfer wait, transfer and decode
+        """
+        self._ensure_connected()
+        self.stop_shooting()
+        self.stop_raw_development()
+        formats = {
+            "rgb": edsdk_bindings.JpegPixelFormat.RGB,
+            "bgr": edsdk_bindings.JpegPixelFormat.BGR,
+            "gray": edsdk_bindings.JpegPixelFormat.GRAY,
+        }
+        if format not in formats:
+            raise ValueError(f"format must be one of {sorted(formats)}")
+        if not raw and not jpeg:
+            raise ValueError("a shot needs a RAW or a JPEG")
+        files = 0
+        if jpeg:
+            files |= int(edsdk_bindings.ShotFiles.JPEG)
+        if raw:
+            files |= int(edsdk_bindings.ShotFiles.RAW)
+        pipeline = edsdk_bindings.ShootPipeline(self._controller, edsdk_bindings.ShotFiles(files), worker_count)
+        pipeline.set_decode(decode)
+        pipeline.set_pixel_format(formats[format])
+        pipeline.set_scale(scale)
+        pipeline.set_max_in_flight(max_in_flight)
+        if not pipeline.start():
+            raise RuntimeError("Failed to start the shoot pipeline")
+        self._shoot_pipeline = pipeline
+        return pipeline
+        
+    def shoot(self, timeout_ms: int = -1) -> Any:
+        """Release the shutter through the pipeline of ``start_shooting()``.
+        
+        Args:
+            timeout_ms: Longest wait for a shot in flight to finish when
+                max_in_flight are, -1 for no limit
+            
+        Returns:
+            ShotFuture; ``result()`` waits and gives the decoded image as a
+            buffer (``numpy.asarray(...)`` is (height, width, 3)), or the
+            JPEG bytes when not decoded, and ``timing`` has each stage
+        """
+        if self._shoot_pipeline is None:
+            self.start_shooting()
+        shot = self._shoot_pipeline.shoot(timeout_ms)
+        if shot is None:
+            raise TimeoutError("No shot slot became free in time")
+        return shot
+        
+    def stop_shooting(self) -> None:
+        """Stop the shoot pipeline; shots still in flight fail as cancelled."""
+        if self._shoot_pipeline is not None:
+            self._shoot_pipeline.stop()
+            self._shoot_pipeline = None
+        
+    def get_thumbnails(self, items: List[Any], decode: bool = False, max_size: int = 0) -> List[Any]:
+        """Fetch the embedded thumbnails of files on the camera.
+        
+        Only the thumbnail of each file crosses the link, a few KB each,
+        and the requests are queued back to back on the transfer worker.
+        
+        Args:
+            items: Directory item references
+            decode: Also decode each to RGB pixels (``thumbnail.pixels``)
+            max_size: Longest side of the decoded pixels, 0 for full size
+            
+        Returns:
+            Thumbnail objects in item order, None for items without one;
+            ``bytes(thumbnail)`` is the embedded JPEG
+        """
+        self._ensure_connected()
+        return self._controller.get_thumbnails(list(items), decode, max_size)
+
+    def scan_storage(self, timeout_ms: int = -1) -> Any:
+        """Index the files on the camera's cards.
+
+        Every card is walked at once. Afterwards captures, deletes and card
+        changes update the index from camera events, without a rescan.
+
+        Args:
+            timeout_ms: How long to wait for the scan, -1 for as long as it takes
+
+        Returns:
+            The StorageIndex; queries on it never reach the camera
+        """
+        self._ensure_connected()
+        handle = self._controller.scan_storage()
+        if handle.wait(timeout_ms) and not handle.succeeded():
+            raise RuntimeError(f"Storage scan failed: {handle.get_error()}")
+        return self._model.get_storage_index()
+
+    def find_files(self, name: Optional[str] = None, first: Optional[int] = None,
+                   last: Optional[int] = None, min_size: int = 0,
+                   max_size: Optional[int] = None, folder: str = "") -> List[Any]:
+        """Files in the storage index matching every given condition.
+
+        Args:
+            name: File name, ignoring case; ``"IMG_12*"`` matches a prefix
+            first: Earliest date_time, as in EdsDirectoryItemInfo
+            last: Latest date_time
+            min_size: Smallest size in bytes
+            max_size: Largest size in bytes
+            folder: Only below this path, e.g. ``"CF/DCIM/100CANON"``
+
+        Returns:
+            StorageItem objects; ``item.ref`` can be passed to download()
+        """
+        index = self._model.get_storage_index()
+        if not index.is_built():
+            index = self.scan_storage()
+        if name is not None:
+            items = index.find_by_name(name)
+        elif first is not None or last is not None:
+            items = index.find_by_date(first or 0, 0xFFFFFFFF if last is None else last)
+        else:
+            items = index.get_files(folder)
+        prefix = folder + "/" if folder else ""
+        return [item for item in items
+                if item.path.startswith(prefix)
+                and (first is None or item.date_time >= first)
+                and (last is None or item.date_time <= last)
+                and item.size >= min_size
+                and (max_size is None or item.size <= max_size)]
+
+    def import_files(self, directory: str, items: Optional[List[Any]] = None,
+                     journal_path: Optional[str] = None, keep_folders: bool = True,
+                     verify_existing: bool = False, on_file: Optional[Callable] = None,
+                     wait: bool = True) -> Any:
+        """Copy files off the cards, resuming an earlier import.
+
+        Files are transferred back to back on the transfer worker. Each
+        one is journaled once it is complete on disk, so running this again
+        after an interruption only fetches what is missing. Files already in
+        the directory at the same size are skipped. A shot that was already
+        imported from the other card is not transferred again.
+
+        Args:
+            directory: Where the files go, below ``CF/DCIM/...`` with keep_folders
+            items: StorageItem objects, by default every file in the storage index
+            journal_path: Journal file, by default ``import.journal`` in directory
+            keep_folders: Keep the card's folder structure below directory
+            verify_existing: Rehash journaled files instead of trusting their size
+            on_file: ``on_file(item, result, error, path)`` for each file, on
+                the transfer thread
+            wait: Return once every file is settled
+
+        Returns:
+            The CardImport; ``get_statistics()`` has the counts and throughput
+        """
+        self._ensure_connected()
+        if items is None:
+            index = self._model.get_storage_index()
+            if not index.is_built():
+                index = self.scan_storage()
+            items = index.get_files()
+        job = edsdk_bindings.CardImport(self._controller, directory, journal_path or "")
+        job.set_keep_folders(keep_folders)
+        job.set_verify_existing(verify_existing)
+        if on_file is not None:
+            job.set_handler(on_file)
+        job.start(list(items))
+        if wait:
+            job.wait()
+        return job
+
+    def set_download_pipeline(self, directory: Optional[str] = None,
+                              path_template: str = "{name}", checksum: bool = False,
+                              memory: bool = False, sinks: Optional[List[Any]] = None,
+                              chunk_size: int = 4 * 1024 * 1024, chunk_count: int = 3) -> Any:
+        """Download captured images in chunks through a pipeline of sinks.
+        
+        Each chunk is handed to the sinks on a separate thread while the
+        next one is transferred, so writing, hashing and any upload overlap
+        with the transfer itself.
+        
+        Args:
+            directory: Write files into this directory, None to skip
+            path_template: File path below ``directory``, see
+                ``utils.create_file_sink`` for the tokens
+            checksum: Add an XXH64 checksum sink
+            memory: Queue the files in memory for ``wait_for_capture``
+            sinks: Additional ``DownloadSink`` objects, e.g. Python subclasses
+                implementing ``begin(model, info)``, ``write(chunk)`` and
+                ``end(success)``; ``chunk`` is a memoryview valid only
+                during the call
+            chunk_size: Bytes per EdsDownload call, rounded up to 512
+            chunk_count: Chunk buffers in flight between transfer and sinks
+            
+        Returns:
+            The DownloadPipeline, e.g. for ``get_statistics()``
+        """
+        self._ensure_connected()
+        pipeline = edsdk_bindings.DownloadPipeline(chunk_size, chunk_count)
+        if directory is not None:
+            pipeline.add_sink(edsdk_bindings.AsyncFileSink(os.path.join(directory, path_template)))
+        hasher = None
+        if checksum:
+            hasher = edsdk_bindings.HashDownloadSink()
+            pipeline.add_sink(hasher)
+        if memory:
+            pipeline.add_sink(edsdk_bindings.MemoryDownloadSink())
+        for sink in sinks or []:
+            pipeline.add_sink(sink)
+        self._model.set_download_pipeline(pipeline)
+        self._model.set_download_target(edsdk_bindings.DownloadTarget.PIPELINE)
+        self._download_pipeline = pipeline
+        self._download_checksum = hasher
+        return pipeline
+        
+    def get_last_checksum(self) -> Optional[int]:
+        """Get the XXH64 of the last file downloaded through the pipeline.
+        
+        Returns:
+            The checksum, or None if no checksum sink is configured
+        """
+        if self._download_checksum is None:
+            return None
+        return self._download_checksum.get_digest()
+        
+    def get_transfer_statistics(self) -> Dict[str, Any]:
+        """Get the state of the image transfer worker.
+        
+        Downloads run on their own worker, so camera control continues
+        while files are transferred.
+        
+        Returns:
+            Dictionary with queue depth, counts and throughput in bytes/s
+        """
+        stats = self._controller.get_transfer_statistics()
+        return {
+            "queue_depth": stats.queue_depth,
+            "active": stats.active,
+            "completed": stats.completed,
+            "failed": stats.failed,
+            "bytes": stats.bytes,
+            "last_bytes_per_second": stats.last_bytes_per_second,
+            "average_bytes_per_second": stats.average_bytes_per_second,
+        }
+        
+    def cancel_transfers(self) -> int:
+        """Cancel this camera's downloads in progress.
+        
+        Each transfer stops at its next progress tick and is reported with
+        EDS_ERR_OPERATION_CANCELLED; the file stays on the card.
+        
+        Returns:
+            Number of transfers asked to stop
+        """
+        self._ensure_connected()
+        return edsdk_bindings.cancel_transfers(self._model)
+        
+    def get_metrics(self) -> Dict[str, Any]:
+        """Get command, queue and live view metrics for scraping.
+        
+        Reading them takes no lock on the command or live view paths.
+        
+        Returns:
+            Dictionary with per command counters and p50/p99 latencies in
+            microseconds, queue depths per lane, live view frames/s and the
+            RAW download buffer pool
+        """
+        self._ensure_connected()
+        metrics = self._controller.metrics()
+        pool = metrics.capture_pool
+        startup = metrics.startup
+        
+        def commands(entries):
+            return {
+                entry.name: {
+                    "executions": entry.executions,
+                    "completed": entry.completed,
+                    "errors": entry.errors,
+                    "busy_retries": entry.busy_retries,
+                    "not_ready_retries": entry.not_ready_retries,
+                    "other_retries": entry.other_retries,
+                    "abandoned": entry.abandoned,
+                    "p50_micros": entry.execute_latency.percentile(0.5),
+                    "p99_micros": entry.execute_latency.percentile(0.99),
+                    "max_micros": entry.execute_latency.max_micros,
+                }
+                for entry in entries
+            }
+        
+        return {
+            "commands": commands(metrics.commands),
+            "transfer_commands": commands(metrics.transfer_commands),
+            "dispatch_p50_micros": metrics.dispatch_latency.percentile(0.5),
+            "dispatch_p99_micros": metrics.dispatch_latency.percentile(0.99),
+            "queue_depth": metrics.queue_depth,
+            "retry_depth": metrics.retry_depth,
+            "coalesced": metrics.coalesced,
+            "evf_frames": metrics.evf_frames,
+            "evf_frames_per_second": metrics.evf_frames_per_second,
+            "evf_bytes_per_second": metrics.evf_bytes_per_second,
+            "capture_pool": {
+                "hits": pool.hits,
+                "misses": pool.misses,
+                "available": pool.available,
+                "pooled_bytes": pool.pooled_bytes,
+                "in_use": pool.in_use,
+                "in_use_bytes": pool.in_use_bytes,
+                "allocated_bytes": pool.allocated_bytes,
+                "allocate_micros": pool.allocate_micros,
+                "huge_page_buffers": pool.huge_page_buffers,
+                "discarded": pool.discarded,
+            },
+            "startup": {
+                "lazy": startup.mode == edsdk_bindings.StartupMode.LAZY,
+                "session_open_micros": (startup.session_open_micros - startup.start_micros
+                                        if startup.session_open_micros else 0),
+                "time_to_first_frame_micros": startup.time_to_first_frame_micros,
+                "properties_fetched": startup.properties_fetched,
+            },
+        }
+        
+    def set_retry_policy(self, error: str, command: Optional[str] = None,
+                         initial_delay_ms: int = 500, factor: float = 1.0,
+                         max_delay_ms: Optional[int] = None, jitter: float = 0.0,
+                         max_attempts: int = 0, deadline_ms: int = 0) -> None:
+        """Set how commands the camera could not take yet are reissued.
+        
+        The n-th retry waits ``initial_delay_ms * factor ** (n - 1)``, at most
+        ``max_delay_ms``, give or take ``jitter`` of it. A command that has
+        run ``max_attempts`` times, or would be retried past ``deadline_ms``
+        after its first run, completes with its last error instead.
+        
+        Args:
+            error: "busy", "not_ready" or "other"
+            command: Command name as in get_metrics(), e.g. "DownloadEvf";
+                None sets the default for every command
+            max_delay_ms: By default initial_delay_ms
+        """
+        self._ensure_connected()
+        classes = {
+            "busy": edsdk_bindings.RetryErrorClass.BUSY,
+            "not_ready": edsdk_bindings.RetryErrorClass.NOT_READY,
+            "other": edsdk_bindings.RetryErrorClass.OTHER,
+        }
+        if error not in classes:
+            raise ValueError(f"error must be one of {sorted(classes)}")
+        if max_delay_ms is None:
+            max_delay_ms = initial_delay_ms
+        policy = edsdk_bindings.RetryPolicy(initial_delay_ms, factor, max_delay_ms,
+                                            jitter, max_attempts, deadline_ms)
+        policies = self._controller.get_retry_policies()
+        if command is None:
+            policies.set_default(classes[error], policy)
+        else:
+            policies.set_policy(command, classes[error], policy)
+        
+    @staticmethod
+    def start_trace(events_per_thread: Optional[int] = None):
+        """Start recording spans of commands, SDK calls, SDK callbacks and
+        observer dispatch on every thread.
+        
+        Wrap Python stages in ``TraceSpan("name")`` to see
+        them on the same timeline.
+        
+        Args:
+            events_per_thread: Ring size of each thread's buffer; the oldest
+                events are dropped once it is full
+        """
+        edsdk_bindings.trace_clear()
+        if events_per_thread is None:
+            edsdk_bindings.trace_start()
+        else:
+            edsdk_bindings.trace_start(events_per_thread)
+        
+    @staticmethod
+    def stop_trace(path: Optional[str] = None) -> str:
+        """Stop recording and return the trace as Chrome trace JSON.
+        
+        Args:
+            path: Also write it to this file, for chrome://tracing or
+                ui.perfetto.dev
+        
+        Returns:
+            The trace JSON
+        """
+        edsdk_bindings.trace_stop()
+        trace = edsdk_bindings.trace_export()
+        if path is not None:
+            with open(path, "w") as f:
+                f.write(trace)
+        return trace
+        
     # --------------------------------------------------------------------------
     # Live View (EVF) methods
     # --------------------------------------------------------------------------
@@ -116,6 +838,50 @@ class Canon:
         self._ensure_connected()
         return self._model.download_evf()
         
+    def set_live_view_metadata(self, every_frame: Optional[List[str]] = None,
+                               on_change: Optional[List[str]] = None,
+                               refresh_frames: Optional[int] = None) -> None:
+        """Choose which properties are read with each live view frame.
+        
+        Each field is one more SDK call per frame. Fields read on change are
+        read again only after the camera reports a zoom, zoom position or
+        live view mode change, or every refresh_frames frames, and frames in
+        between carry the last value. Fields in neither list are not read;
+        ``frame.metadata`` tells which ones a frame holds.
+        
+        Args:
+            every_frame: Names out of "zoom", "image_position", "histogram",
+                "zoom_rect" and "coordinate_system"; none by default
+            on_change: Same names; by default all but "histogram"
+            refresh_frames: Frames between reads of the on change fields,
+                0 for events only
+        """
+        self._ensure_connected()
+        fields = {
+            "zoom": edsdk_bindings.EvfMetadataField.ZOOM,
+            "image_position": edsdk_bindings.EvfMetadataField.IMAGE_POSITION,
+            "histogram": edsdk_bindings.EvfMetadataField.HISTOGRAM,
+            "zoom_rect": edsdk_bindings.EvfMetadataField.ZOOM_RECT,
+            "coordinate_system": edsdk_bindings.EvfMetadataField.COORDINATE_SYSTEM,
+        }
+        
+        def mask(names):
+            value = 0
+            for name in names:
+                if name not in fields:
+                    raise ValueError(f"unknown live view field {name!r}, expected one of {sorted(fields)}")
+                value |= int(fields[name])
+            return value
+        
+        metadata = self._model.get_evf_metadata()
+        if every_frame is None:
+            every_frame = []
+        if on_change is None:
+            on_change = [name for name in fields if name != "histogram"]
+        metadata.set_fields(mask(every_frame), mask(on_change))
+        if refresh_frames is not None:
+            metadata.set_refresh_frames(refresh_frames)
+        
     def set_evf_zoom(self, zoom: int) -> None:
         """Set the live view zoom level.
         
@@ -187,6 +953,77 @@ class Canon:
         cmd = edsdk_bindings.DriveLensCommand(self._model, drive_lens)
         return cmd.execute()
         
+    def focus_bracket(self, count: int, step_size: int = 1, steps_per_slice: int = 1,
+                      toward_far: bool = True, settle_ms: int = 100,
+                      return_to_start: bool = False) -> Any:
+        """Shoot a focus stack: count slices, the lens driven between them.
+        
+        Runs in C++ on the pipeline of ``start_shooting()`` (started with
+        defaults if it is not running), so each slice is transferring while
+        the lens moves on to the next. Releases are made without AF and live
+        view must be on.
+        
+        Args:
+            count: Number of slices
+            step_size: Lens drive size, 1 to 3 as for focus_near/focus_far
+            steps_per_slice: Drive commands between two slices
+            toward_far: Drive direction
+            settle_ms: Wait after driving, before each release
+            return_to_start: Drive the lens back once the last slice is shot
+            
+        Returns:
+            FocusBracketResult; ``slices`` holds each slice's lens position,
+            drive and settle times and its ShotFuture
+        """
+        self._ensure_connected()
+        if self._shoot_pipeline is None:
+            self.start_shooting()
+        bracket = edsdk_bindings.FocusBracket(self._controller, self._shoot_pipeline)
+        bracket.set_steps(count, step_size, steps_per_slice)
+        bracket.set_toward_far(toward_far)
+        bracket.set_settle(settle_ms)
+        bracket.set_return_to_start(return_to_start)
+        return bracket.run()
+        
+    def exposure_bracket(self, settings: List[Dict[str, int]], restore: bool = True) -> Any:
+        """Shoot one frame per exposure setting, for HDR.
+        
+        Runs in C++ on the pipeline of ``start_shooting()`` (started with
+        defaults if it is not running). Each next setting is applied as soon
+        as the previous release returns, only the properties that change,
+        and frames are released without waiting for their downloads.
+        
+        Args:
+            settings: One dict per frame with any of "tv", "av", "iso" and
+                "exposure_comp", as EDSDK property codes; others stay as
+                they are
+            restore: Set the properties back once the last frame is released
+            
+        Returns:
+            ExposureBracketResult; ``shots`` pairs each frame's setting with
+            its ShotFuture
+        """
+        self._ensure_connected()
+        if self._shoot_pipeline is None:
+            self.start_shooting()
+        fields = {
+            "tv": edsdk_bindings.ExposureField.TV,
+            "av": edsdk_bindings.ExposureField.AV,
+            "iso": edsdk_bindings.ExposureField.ISO,
+            "exposure_comp": edsdk_bindings.ExposureField.COMPENSATION,
+        }
+        bracket = edsdk_bindings.ExposureBracket(self._controller, self._shoot_pipeline)
+        for setting in settings:
+            unknown = set(setting) - set(fields)
+            if unknown:
+                raise ValueError(f"unknown exposure settings {sorted(unknown)}")
+            mask = 0
+            for name in setting:
+                mask |= int(fields[name])
+            bracket.add_setting(edsdk_bindings.ExposureSetting(mask, **setting))
+        bracket.set_restore(restore)
+        return bracket.run()
+        
     # --------------------------------------------------------------------------
     # Camera settings methods
     # --------------------------------------------------------------------------
@@ -392,6 +1229,29 @@ class Canon:
         self._ensure_connected()
         self._model.set_image_quality(image_quality)
         
+    def apply_settings(self, settings: Dict[Any, Union[int, bytes]], timeout_ms: int = -1) -> Any:
+        """Set several properties as one transaction.
+        
+        The camera's UI is locked once for all of them and only the ones
+        the camera answers busy are retried, so reconfiguring between
+        scenes takes one round trip per property instead of a busy cycle
+        for each.
+        
+        Args:
+            settings: Property ID (EdsPropertyID or int) to value, applied
+                in order; ints are set as EdsUInt32, bytes as they are
+            timeout_ms: How long to wait, -1 for as long as it takes
+            
+        Returns:
+            The CommandHandle; raises if any property was refused
+        """
+        self._ensure_connected()
+        values = [(int(property_id), value) for property_id, value in settings.items()]
+        handle = self._controller.set_properties(values)
+        if handle.wait(timeout_ms) and not handle.succeeded():
+            raise RuntimeError(f"Setting properties failed: {handle.get_error()}")
+        return handle
+        
     def get_image_quality_label(self, image_quality: int) -> str:
         """Get the human-readable label for an image quality value.
         
@@ -422,5 +1282,261 @@ class Canon:
         Ensures the session is closed properly.
         """
         if self._initialized:
-            # Gracefully close the session
-            pass 
\ No newline at end of file
+            self.close()
+
+
+class CameraArray:
+    """Every attached camera, each with its own controller and processor.
+    
+    Commands to different cameras run in parallel on their own threads.
+    Without a message loop, call ``pump_events`` regularly from the thread
+    that created the array so downloads and property changes are delivered.
+    """
+    
+    def __init__(self, lazy: bool = False, placement: Any = None,
+                 cores_per_camera: int = 2, arena_buffers: int = 0,
+                 arena_buffer_mb: int = 64):
+        """Initialize the SDK; no camera is connected yet.
+        
+        Args:
+            lazy: Open sessions that read properties on first access, see
+                ``Canon.connect_to_camera``
+            placement: Where each camera's threads run. None leaves them to
+                the scheduler, only named (``cam0-cmd``, ``cam0-xfer``,
+                ``cam0-evf``, ``cam0-dec0``...). ``"numa"`` deals cameras
+                round the NUMA nodes, ``"cores"`` gives each
+                ``cores_per_camera`` cores of its own. A list gives the core
+                list of each camera by slot (e.g. ``["0-3", "4-7"]``), and a
+                callable ``placement(slot, device_info)`` returns a
+                ``CameraPlacement``.
+            cores_per_camera: Cores per camera with ``"cores"``
+            arena_buffers: Capture buffers to fault in per camera on its
+                own cores when it connects, so downloads land in local memory
+            arena_buffer_mb: Size of each of those buffers
+        """
+        self._manager = edsdk_bindings.CameraManager()
+        if lazy:
+            self._manager.set_startup_mode(edsdk_bindings.StartupMode.LAZY)
+        self._set_placement(placement, cores_per_camera, arena_buffers, arena_buffer_mb << 20)
+        err = self._manager.initialize()
+        if err != 0:
+            raise RuntimeError(f"EdsInitializeSDK failed: 0x{err:08X}")
+        self._cameras: List[Canon] = []
+        self._monitor = None
+        self._recovery = None
+            
+    def _set_placement(self, placement: Any, cores_per_camera: int,
+                       arena_buffers: int, arena_buffer_size: int) -> None:
+        if placement is None and arena_buffers == 0:
+            return
+        if placement == "numa":
+            self._manager.place_across_numa_nodes(arena_buffers, arena_buffer_size)
+        elif placement == "cores":
+            self._manager.place_cores_per_camera(cores_per_camera, 0, arena_buffers, arena_buffer_size)
+        elif isinstance(placement, (list, tuple)):
+            core_lists = [edsdk_bindings.ThreadPlacement.parse(cores) if isinstance(cores, str)
+                          else edsdk_bindings.ThreadPlacement.on_cores(list(cores))
+                          for cores in placement]
+            
+            def by_slot(slot, device_info):
+                result = edsdk_bindings.CameraPlacement(slot)
+                if slot < len(core_lists):
+                    result.io = core_lists[slot]
+                    result.decode = core_lists[slot]
+                result.arena_buffers = arena_buffers
+                result.arena_buffer_size = arena_buffer_size
+                return result
+            self._manager.set_placement_policy(by_slot)
+        elif placement is None or callable(placement):
+            def by_callable(slot, device_info):
+                result = placement(slot, device_info) if placement is not None else None
+                if result is None:
+                    result = edsdk_bindings.CameraPlacement(slot)
+                    result.arena_buffers = arena_buffers
+                    result.arena_buffer_size = arena_buffer_size
+                return result
+            self._manager.set_placement_policy(by_callable)
+        else:
+            raise ValueError("placement must be None, 'numa', 'cores', a list of core lists or a callable")
+            
+    def connect_all(self) -> List[Canon]:
+        """Open a session on every attached camera.
+        
+        Cameras already connected are kept. A camera that fails to open
+        is skipped.
+        
+        Returns:
+            One Canon per connected camera
+        """
+        self._manager.connect_all()
+        known = {camera._session.port_name: camera for camera in self._cameras}
+        self._cameras = [known.get(session.port_name) or Canon.from_session(session)
+                         for session in self._manager.get_sessions()]
+        return list(self._cameras)
+        
+    def watch(self, on_added: Optional[Callable[[Any, Optional[Canon]], None]] = None,
+              on_removed: Optional[Callable[[Any, Optional[Canon]], None]] = None,
+              auto_connect: bool = True) -> Any:
+        """Follow bodies being plugged in and unplugged, instead of polling.
+        
+        The SDK's camera-added and shutdown events keep a device registry
+        current; with ``auto_connect`` a session is opened on each body as
+        it arrives and closed as it goes, and the array follows. Bodies
+        attached now are reported as added first. Callbacks run on the
+        monitor thread.
+        
+        Args:
+            on_added: ``on_added(event, camera)``, camera None without a session
+            on_removed: ``on_removed(event, camera)``, camera the Canon that
+                drove the body, if any
+            auto_connect: Open sessions on bodies as they are added
+            
+        Returns:
+            The HotPlugMonitor, e.g. for ``get_devices()``
+        """
+        if self._monitor is not None:
+            return self._monitor
+        
+        def changed(event):
+            known = next((camera for camera in self._cameras
+                          if camera._session.port_name == event.port_name), None)
+            if event.kind == edsdk_bindings.HotPlugEventKind.ADDED:
+                camera = known
+                if camera is None and event.session is not None:
+                    camera = Canon.from_session(event.session)
+                    self._cameras = self._cameras + [camera]
+                if on_added is not None:
+                    on_added(event, camera)
+            else:
+                self._cameras = [camera for camera in self._cameras if camera is not known]
+                if on_removed is not None:
+                    on_removed(event, known)
+        
+        monitor = edsdk_bindings.HotPlugMonitor(self._manager)
+        monitor.set_auto_connect(auto_connect)
+        monitor.add_listener(changed)
+        if not monitor.start():
+            raise RuntimeError("EdsSetCameraAddedHandler failed")
+        self._monitor = monitor
+        return monitor
+        
+    def recover(self, on_recovered: Optional[Callable[[Any, Optional[Canon]], None]] = None,
+                timeout_ms: int = 10000, poll_ms: int = 20) -> Any:
+        """Bring cameras back after a shutdown event, e.g. a USB reset.
+        
+        A lost camera's commands are held until the same body is back in
+        the camera list; its session is then opened again, its settings
+        and live view are set back and the held commands run. The Canon
+        stays valid throughout. A body not back within ``timeout_ms`` is
+        closed and dropped from the array. Use instead of ``watch``.
+        
+        Args:
+            on_recovered: ``on_recovered(event, camera)`` on the recovery
+                thread; ``event.error`` is 0 and ``event.downtime_micros``
+                the time it was down once it is back
+            timeout_ms: How long a body may be gone
+            poll_ms: Camera list reads while waiting for it
+            
+        Returns:
+            The SessionRecovery, e.g. for ``get_statistics()``
+        """
+        if self._recovery is not None:
+            return self._recovery
+        
+        def recovered(event):
+            known = next((camera for camera in self._cameras
+                          if camera._session.port_name == event.port_name), None)
+            if event.error != 0:
+                self._cameras = [camera for camera in self._cameras if camera is not known]
+            if on_recovered is not None:
+                on_recovered(event, known)
+        
+        recovery = edsdk_bindings.SessionRecovery(self._manager)
+        recovery.set_timeout(timeout_ms)
+        recovery.set_poll_interval(poll_ms)
+        recovery.add_listener(recovered)
+        if not recovery.start():
+            raise RuntimeError("Could not start session recovery")
+        self._recovery = recovery
+        return recovery
+        
+    def list_devices(self) -> List[Any]:
+        """Device info of every attached camera, connected or not."""
+        return self._manager.enumerate()
+        
+    def sync_capture(self, half_press: bool = True, lead_us: int = 2000,
+                     transfer_timeout_ms: int = 5000) -> Any:
+        """Release the shutter of every camera at the same instant.
+        
+        Each body is half-pressed first, then all processor threads meet on
+        a barrier and press the shutter fully together. Call from the thread
+        that created the array; SDK events are pumped while waiting.
+        
+        Args:
+            half_press: Half-press (AF and metering) before the release
+            lead_us: Time between the last camera being ready and the release
+            transfer_timeout_ms: How long to wait for every camera to
+                announce its image, 0 to skip
+            
+        Returns:
+            SyncTriggerResult with the dispatch and transfer skew, and per
+            camera offsets in ``timings`` (same order as the cameras)
+        """
+        trigger = edsdk_bindings.SyncTrigger()
+        trigger.set_half_press(half_press)
+        trigger.set_lead(lead_us)
+        trigger.set_transfer_timeout(transfer_timeout_ms)
+        return trigger.fire([camera._session for camera in self._cameras])
+        
+    def create_event_queue(self, capacity: int = 4096, events: Optional[List[Any]] = None) -> Any:
+        """Queue the events of every connected camera into one EventQueue.
+        
+        Each event's ``source`` is the index of its camera in this array.
+        
+        Args:
+            capacity: Queue size, rounded up to a power of two
+            events: CameraEventID values to queue, None for all
+            
+        Returns:
+            EventQueue
+        """
+        queue = edsdk_bindings.EventQueue(capacity)
+        mask = _event_mask(events)
+        for index, camera in enumerate(self._cameras):
+            queue.attach(camera._model, index, mask)
+        return queue
+        
+    def pump_events(self) -> None:
+        """Deliver pending SDK events to the cameras."""
+        self._manager.get_event()
+        
+    def close(self) -> None:
+        """Close every session at once and unload the SDK."""
+        if self._monitor is not None:
+            self._monitor.stop()
+            self._monitor = None
+        if self._recovery is not None:
+            self._recovery.stop()
+            self._recovery = None
+        self._cameras = []
+        self._manager.terminate()
+        
+    @property
+    def manager(self) -> Any:
+        """The native CameraManager."""
+        return self._manager
+        
+    def __len__(self) -> int:
+        return len(self._cameras)
+        
+    def __getitem__(self, index: int) -> Canon:
+        return self._cameras[index]
+        
+    def __iter__(self):
+        return iter(self._cameras)
+        
+    def __enter__(self):
+        return self
+        
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.close() 
\ No newline at end of file
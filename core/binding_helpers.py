@@ -21,20 +21,56 @@ except ImportError:
 logger = logging.getLogger(__name__)
 
 
+_sdk_context = None
+_sdk_refs = 0
+_manager_context = None
+
+
+def get_sdk_context() -> Any:
+    """Get the process-wide SdkContext, initializing the SDK if needed.
+    
+    The SDK stays loaded, and its sessions open, while any context or
+    session lease is held; ``initialize_sdk`` holds one until
+    ``terminate_sdk``.
+    
+    Returns:
+        SdkContext
+    
+    Raises:
+        CanonError: If EdsInitializeSDK fails
+    """
+    if _sdk_context is not None:
+        return _sdk_context
+    try:
+        return SdkContext.acquire()
+    except RuntimeError as e:
+        raise CanonError(str(e)) from e
+
+
+def get_camera_manager() -> Any:
+    """Get the CameraManager of the process-wide SDK context.
+    
+    Returns:
+        CameraManager
+    """
+    global _manager_context
+    if _manager_context is None:
+        # Kept for the life of the process
+        _manager_context = get_sdk_context()
+    return _manager_context.manager
+
+
 def find_cameras() -> List[Any]:
     """Find available Canon cameras.
     
     Returns:
-        List of camera references that can be used with Canon.connect_to_camera()
+        Device info (port name, description) of every attached camera
     
     Raises:
-        DeviceNotFoundError: If no cameras are found
+        DeviceNotFoundError: If the camera list can not be read
     """
     try:
-        # Placeholder function - in a real implementation, 
-        # this would use the EDSDK to list available cameras
-        cameras = []
-        return cameras
+        return get_camera_manager().enumerate()
     except Exception as e:
         logger.error(f"Error finding cameras: {e}")
         raise DeviceNotFoundError("No Canon cameras found. Check connections.") from e
@@ -68,19 +104,28 @@ def setup_memory_callbacks() -> None:
 def initialize_sdk() -> None:
     """Initialize the EDSDK library.
     
-    This should be called once at the start of the program.
+    Calls nest: each must be matched by ``terminate_sdk``. While the SDK
+    is initialized, sessions opened by ``Canon.attach`` stay open after
+    their handles are closed, so the next handle starts warm.
     
     Raises:
         CanonError: If initialization fails
     """
-    # This would be implemented to initialize the EDSDK
-    pass
+    global _sdk_context, _sdk_refs
+    if _sdk_context is None:
+        _sdk_context = get_sdk_context()
+    _sdk_refs += 1
 
 
 def terminate_sdk() -> None:
     """Terminate the EDSDK library.
     
-    This should be called once at the end of the program.
+    Releases one ``initialize_sdk``. The SDK is unloaded, and its sessions
+    closed, once no call is outstanding and no handle holds a session.
     """
-    # This would be implemented to terminate the EDSDK
-    pass 
\ No newline at end of file
+    global _sdk_context, _sdk_refs
+    if _sdk_refs == 0:
+        return
+    _sdk_refs -= 1
+    if _sdk_refs == 0:
+        _sdk_context = None 
\ No newline at end of file
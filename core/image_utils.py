@@ -6,6 +6,7 @@ from Canon cameras.
 """
 
 import logging
+import os
 from typing import Any, Optional, Dict, List, Union, Tuple
 
 try:
@@ -21,19 +22,135 @@ logger = logging.getLogger(__name__)
 def edsdkimage_to_numpy(image_data: Any) -> Optional[np.ndarray]:
     """Convert EDSDK image data to a NumPy array.
     
+    Objects exposing the buffer protocol (such as ``EvfFrame``) are wrapped
+    without copying; the array keeps the frame alive.
+    
     Args:
         image_data: Image data from EDSDK
         
     Returns:
-        NumPy array containing the image data, or None if conversion failed
+        Read-only uint8 NumPy array over the encoded bytes, or None if
+        conversion failed
     """
     if not HAVE_NUMPY:
         logger.warning("NumPy not available. Cannot convert image.")
         return None
         
-    # This would be implemented to convert EDSDK image data to NumPy array
-    # For now, return a placeholder
-    return None
+    if image_data is None:
+        return None
+        
+    try:
+        return np.frombuffer(image_data, dtype=np.uint8)
+    except (TypeError, ValueError) as e:
+        logger.error(f"Error converting image: {e}")
+        return None
+
+
+_PIXEL_FORMATS = ("rgb", "bgr", "gray")
+
+
+def decode_jpeg(image_data: Any, format: str = "rgb", scale: int = 1) -> Optional[np.ndarray]:
+    """Decode JPEG data (e.g. a live view ``EvfFrame``) to a NumPy array.
+    
+    Decoding runs natively with the GIL released. ``scale`` shrinks the
+    image during decoding, which is much cheaper than decoding at full
+    size and resizing afterwards.
+    
+    Args:
+        image_data: Object exposing the JPEG bytes through the buffer protocol
+        format: Pixel format, one of "rgb", "bgr" or "gray"
+        scale: Denominator of the output size: 1, 2, 4 or 8
+        
+    Returns:
+        uint8 array of shape (height, width, 3), or (height, width) for
+        gray, or None if decoding failed
+    """
+    if not HAVE_NUMPY:
+        logger.warning("NumPy not available. Cannot decode image.")
+        return None
+        
+    if format not in _PIXEL_FORMATS:
+        raise ValueError(f"format must be one of {_PIXEL_FORMATS}")
+        
+    if scale not in (1, 2, 4, 8):
+        raise ValueError("scale must be 1, 2, 4 or 8")
+        
+    try:
+        from ..edsdk_bindings import decode_jpeg as _decode_jpeg, JpegPixelFormat, jpeg_available
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot decode image.")
+        return None
+        
+    if not jpeg_available():
+        logger.warning("EDSDK bindings were built without libjpeg. Cannot decode image.")
+        return None
+        
+    pixel_format = {
+        "rgb": JpegPixelFormat.RGB,
+        "bgr": JpegPixelFormat.BGR,
+        "gray": JpegPixelFormat.GRAY,
+    }[format]
+    
+    try:
+        return np.asarray(_decode_jpeg(image_data, pixel_format, scale))
+    except (RuntimeError, TypeError) as e:
+        logger.error(f"Error decoding image: {e}")
+        return None
+
+
+def decode_evf_region(frame: Any, region: Optional[Tuple[int, int, int, int]] = None,
+                      space: str = "large", format: str = "rgb",
+                      scale: int = 1) -> Optional[np.ndarray]:
+    """Decode only part of a live view frame.
+    
+    Only the JPEG blocks covering the region are decoded, which is much
+    cheaper than decoding the whole frame and cropping.
+    
+    Args:
+        frame: EvfFrame from live view
+        region: (x, y, width, height), or None for the frame's zoom rect
+        space: "large" if region is in JPEG Large coordinates (like the
+            zoom rect and focus points), "image" for live view pixels
+        format: Pixel format, one of "rgb", "bgr" or "gray"
+        scale: Denominator of the output size: 1, 2, 4 or 8
+        
+    Returns:
+        uint8 array of the region, or None if decoding failed
+    """
+    if not HAVE_NUMPY:
+        logger.warning("NumPy not available. Cannot decode image.")
+        return None
+        
+    if format not in _PIXEL_FORMATS:
+        raise ValueError(f"format must be one of {_PIXEL_FORMATS}")
+        
+    if space not in ("large", "image"):
+        raise ValueError("space must be 'large' or 'image'")
+        
+    try:
+        from ..edsdk_bindings import (decode_evf_region as _decode_evf_region,
+                                      EdsRect, EvfCoordinateSpace, JpegPixelFormat)
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot decode image.")
+        return None
+        
+    rect = None
+    if region is not None:
+        rect = EdsRect()
+        rect.point.x, rect.point.y, rect.size.width, rect.size.height = region
+        
+    pixel_format = {
+        "rgb": JpegPixelFormat.RGB,
+        "bgr": JpegPixelFormat.BGR,
+        "gray": JpegPixelFormat.GRAY,
+    }[format]
+    coordinate_space = EvfCoordinateSpace.JPEG_LARGE if space == "large" else EvfCoordinateSpace.IMAGE
+    
+    try:
+        return np.asarray(_decode_evf_region(frame, rect, coordinate_space, pixel_format, scale))
+    except (RuntimeError, TypeError) as e:
+        logger.error(f"Error decoding image region: {e}")
+        return None
 
 
 def save_image(image_data: Any, file_path: str, format: str = "jpeg") -> bool:
@@ -55,43 +172,211 @@ def save_image(image_data: Any, file_path: str, format: str = "jpeg") -> bool:
         return False
 
 
-def get_thumbnail(image_data: Any) -> Optional[Any]:
-    """Extract thumbnail from image data.
+def get_thumbnail(image_data: Any, source: str = "preview", max_size: int = 0) -> Optional[Any]:
+    """Extract the thumbnail or preview embedded in an image file.
+    
+    Only the small image inside the file is decoded, never the full-size
+    one, so this is fast enough for contact sheets. For a file still on the
+    camera use ``CameraController.get_thumbnail(item)`` instead: it fetches
+    just the embedded JPEG without downloading the file.
     
     Args:
-        image_data: Image data from EDSDK
+        image_data: A file path, the file's bytes, a ``CapturedImage``, or a
+            ``Thumbnail`` fetched from the camera
+        source: "thumbnail" (about 160 pixels wide) or "preview" (larger,
+            about 1620 pixels wide on current bodies)
+        max_size: Longest side of the result, 0 for the size in the file
         
     Returns:
-        Thumbnail data, or None if extraction failed
+        uint8 RGB array of shape (height, width, 3), or None if extraction
+        failed
     """
-    # This would be implemented to extract thumbnail from EDSDK image data
-    return None
+    if not HAVE_NUMPY:
+        logger.warning("NumPy not available. Cannot extract thumbnail.")
+        return None
+        
+    if image_data is None:
+        return None
+        
+    try:
+        from ..edsdk_bindings import extract_thumbnail, extract_thumbnail_file, ImageSource, Thumbnail
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot extract thumbnail.")
+        return None
+        
+    sources = {"thumbnail": ImageSource.THUMBNAIL, "preview": ImageSource.PREVIEW}
+    if source not in sources:
+        raise ValueError(f"source must be one of {tuple(sources)}")
+        
+    try:
+        if isinstance(image_data, Thumbnail):
+            if image_data.pixels is not None and max_size == 0:
+                return image_data.pixels
+            # The camera's thumbnail is a file in its own right
+            thumbnail = extract_thumbnail(image_data, ImageSource.THUMBNAIL, max_size)
+        elif isinstance(image_data, (str, os.PathLike)):
+            thumbnail = extract_thumbnail_file(os.fspath(image_data), sources[source], max_size)
+        else:
+            thumbnail = extract_thumbnail(image_data, sources[source], max_size)
+        return thumbnail.pixels
+    except (RuntimeError, TypeError) as e:
+        logger.error(f"Error extracting thumbnail: {e}")
+        return None
+
 
+_RESIZE_FILTERS = ("area", "bilinear", "lanczos")
 
-def resize_image(image_data: Any, width: int, height: int) -> Optional[Any]:
-    """Resize image data.
+
+def resize_image(image_data: Any, width: int, height: int, filter: str = "area",
+                 threads: int = 0) -> Optional[Any]:
+    """Resize decoded pixels.
+    
+    Runs natively with the GIL released, split across threads by rows.
+    "area" averages the covered pixels and suits live view downscaling;
+    "lanczos" is sharper and slower, for stills.
     
     Args:
-        image_data: Image data from EDSDK
+        image_data: uint8 array of shape (h, w) or (h, w, c), c up to 4
         width: Target width
         height: Target height
+        filter: One of "area", "bilinear" or "lanczos"
+        threads: Threads to use, 0 to pick by image size
         
     Returns:
-        Resized image data, or None if resizing failed
+        New uint8 array of shape (height, width[, c]), or None if resizing failed
     """
     if not HAVE_NUMPY:
         logger.warning("NumPy not available. Cannot resize image.")
         return None
         
-    # This would be implemented to resize EDSDK image data
-    return None
+    if filter not in _RESIZE_FILTERS:
+        raise ValueError(f"filter must be one of {_RESIZE_FILTERS}")
+        
+    try:
+        from ..edsdk_bindings import resize_image as _resize_image, ResizeFilter
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot resize image.")
+        return None
+        
+    resize_filter = {
+        "area": ResizeFilter.AREA,
+        "bilinear": ResizeFilter.BILINEAR,
+        "lanczos": ResizeFilter.LANCZOS,
+    }[filter]
+    
+    try:
+        return _resize_image(np.ascontiguousarray(image_data, dtype=np.uint8), width, height, resize_filter, threads)
+    except (ValueError, TypeError) as e:
+        logger.error(f"Error resizing image: {e}")
+        return None
+
+
+_CONVERSIONS = ("rgb2bgr", "bgr2rgb", "rgb2gray", "bgr2gray", "to_planar", "to_interleaved")
+
+
+def convert_color(image_data: Any, conversion: str, threads: int = 0) -> Optional[Any]:
+    """Convert decoded pixels natively, with the GIL released.
+    
+    Args:
+        image_data: uint8 array of shape (h, w, 3), or (3, h, w) for
+            "to_interleaved"
+        conversion: One of "rgb2bgr", "bgr2rgb", "rgb2gray", "bgr2gray",
+            "to_planar" ((h, w, 3) to (3, h, w)) or "to_interleaved"
+        threads: Threads to use, 0 to pick by image size
+        
+    Returns:
+        New uint8 array, or None if the conversion failed
+    """
+    if not HAVE_NUMPY:
+        logger.warning("NumPy not available. Cannot convert image.")
+        return None
+        
+    if conversion not in _CONVERSIONS:
+        raise ValueError(f"conversion must be one of {_CONVERSIONS}")
+        
+    try:
+        from .. import edsdk_bindings
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot convert image.")
+        return None
+        
+    pixels = np.ascontiguousarray(image_data, dtype=np.uint8)
+    try:
+        if conversion in ("rgb2bgr", "bgr2rgb"):
+            return edsdk_bindings.swap_red_blue(pixels, None, threads)
+        if conversion in ("rgb2gray", "bgr2gray"):
+            pixel_format = _native_pixel_format(conversion[:3])
+            return edsdk_bindings.convert_to_gray(pixels, pixel_format, threads)
+        if conversion == "to_planar":
+            return edsdk_bindings.split_planes(pixels, threads)
+        return edsdk_bindings.merge_planes(pixels, threads)
+    except (ValueError, TypeError) as e:
+        logger.error(f"Error converting image: {e}")
+        return None
 
 
-def apply_histogram_stretching(image_data: Any) -> Optional[Any]:
+def _native_pixel_format(format: str) -> Any:
+    if format not in _PIXEL_FORMATS:
+        raise ValueError(f"format must be one of {_PIXEL_FORMATS}")
+    from ..edsdk_bindings import JpegPixelFormat
+    return {
+        "rgb": JpegPixelFormat.RGB,
+        "bgr": JpegPixelFormat.BGR,
+        "gray": JpegPixelFormat.GRAY,
+    }[format]
+
+
+def get_image_statistics(image_data: Any, format: str = "rgb") -> Optional[Dict[str, Any]]:
+    """Compute histograms and exposure statistics of decoded pixels.
+    
+    Runs natively with the GIL released.
+    
+    Args:
+        image_data: uint8 array of shape (h, w, 3), or (h, w) for gray
+        format: Pixel format, one of "rgb", "bgr" or "gray"
+        
+    Returns:
+        Dictionary with "histogram" (4 x 256 array, rows R, G, B, luma),
+        "mean", "clipped_low" and "clipped_high" (percent of pixels at 0
+        and 255, per channel), or None if the statistics failed
+    """
+    if not HAVE_NUMPY:
+        logger.warning("NumPy not available. Cannot process image.")
+        return None
+        
+    try:
+        from ..edsdk_bindings import compute_image_statistics
+        stats = compute_image_statistics(image_data, _native_pixel_format(format))
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot process image.")
+        return None
+    except (TypeError, ValueError) as e:
+        logger.error(f"Error computing image statistics: {e}")
+        return None
+        
+    return {
+        "histogram": stats.histogram,
+        "mean": stats.mean,
+        "clipped_low": stats.clipped_low,
+        "clipped_high": stats.clipped_high,
+    }
+
+
+def apply_histogram_stretching(image_data: Any, format: str = "rgb",
+                               low_percent: float = 0.5, high_percent: float = 0.5,
+                               in_place: bool = False) -> Optional[Any]:
     """Apply histogram stretching to improve image contrast.
     
+    The darkest ``low_percent`` and brightest ``high_percent`` of the
+    pixels (by luma) are mapped to black and white. All channels share one
+    table, so hues are kept.
+    
     Args:
-        image_data: Image data from EDSDK
+        image_data: uint8 array of shape (h, w, 3), or (h, w) for gray
+        format: Pixel format, one of "rgb", "bgr" or "gray"
+        low_percent: Percent of pixels clipped to black
+        high_percent: Percent of pixels clipped to white
+        in_place: Modify image_data instead of a copy
         
     Returns:
         Processed image data, or None if processing failed
@@ -100,5 +385,16 @@ def apply_histogram_stretching(image_data: Any) -> Optional[Any]:
         logger.warning("NumPy not available. Cannot process image.")
         return None
         
-    # This would be implemented to apply histogram stretching
-    return None 
\ No newline at end of file
+    image = image_data if in_place else np.array(image_data, dtype=np.uint8, copy=True)
+    
+    try:
+        from ..edsdk_bindings import contrast_stretch
+        contrast_stretch(image, _native_pixel_format(format), low_percent, high_percent)
+    except ImportError:
+        logger.warning("EDSDK bindings not available. Cannot process image.")
+        return None
+    except (TypeError, ValueError) as e:
+        logger.error(f"Error stretching image: {e}")
+        return None
+        
+    return image 
\ No newline at end of file
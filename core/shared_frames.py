@@ -0,0 +1,236 @@
+"""
+Reader for frames published through a shared memory ring.
+
+A process running the camera publishes live view frames or captures with
+``SharedFrameRing`` (see ``edsdk/include/SharedFrameRing.h``); any number of
+other processes on the machine map the same segment with this module and see
+each frame as a NumPy array over the shared memory, without a copy. Only the
+standard library and NumPy are needed here, not the EDSDK bindings.
+
+Example:
+    with SharedFrameReader("canon_evf") as reader:
+        for frame in reader.frames(timeout=5.0):
+            image = frame.data          # points into the ring
+            process(image)
+            if not frame.is_valid():
+                continue                # overwritten while we used it
+
+The writer overwrites the oldest slot once the ring wraps, so an array is only
+trustworthy while ``is_valid()`` holds; call ``copy()`` to keep a frame.
+"""
+
+import logging
+import struct
+import sys
+import time
+from multiprocessing import shared_memory
+from typing import Iterator, Optional, Tuple
+
+try:
+    import numpy as np
+    HAVE_NUMPY = True
+except ImportError:
+    HAVE_NUMPY = False
+
+logger = logging.getLogger(__name__)
+
+
+# Layout of SHARED_FRAME_RING_HEADER and SHARED_FRAME_SLOT, native byte order
+RING_MAGIC = b"EDSRING\0"
+RING_VERSION = 1
+_HEADER = struct.Struct("=8sIIIIQQQQQ")
+_PUBLISHED_OFFSET = 40
+_LOCK = struct.Struct("=Q")
+_INFO = struct.Struct("=QQQQIIiiiiI4i2iI64s")
+_INFO_OFFSET = 8
+
+KIND_NONE = 0
+KIND_EVF_JPEG = 1
+KIND_EVF_IMAGE = 2
+KIND_CAPTURE = 3
+
+_KIND_NAMES = {
+    KIND_NONE: "none",
+    KIND_EVF_JPEG: "evf_jpeg",
+    KIND_EVF_IMAGE: "evf_image",
+    KIND_CAPTURE: "capture",
+}
+
+_PIXEL_FORMATS = ("rgb", "bgr", "gray")
+
+
+class SharedFrame:
+    """One frame in the ring, its payload left in shared memory.
+
+    Attributes:
+        sequence: Position in the ring's stream, counting from 1
+        source_sequence: Live view frame sequence or decode index
+        timestamp: Seconds since the epoch when it was published
+        kind: "evf_jpeg", "evf_image" or "capture"
+        width, height, stride, channels: Geometry of a decoded image
+        format: "rgb", "bgr" or "gray" for a decoded image
+        zoom, zoom_rect, image_position: Live view metadata
+        name: Camera file name of a capture
+        data: Read-only uint8 array over the payload, shaped
+            (height, width, channels) for decoded images
+    """
+
+    def __init__(self, reader: "SharedFrameReader", lock: int, offset: int, info: Tuple):
+        (self.sequence, self.source_sequence, time_micros, length, kind, pixel_format,
+         self.width, self.height, self.stride, self.channels, self.zoom,
+         zx, zy, zw, zh, px, py, _, name) = info
+        self._reader = reader
+        self._lock = lock
+        self._offset = offset
+        self.timestamp = time_micros / 1e6
+        self.length = length
+        self.kind = _KIND_NAMES.get(kind, "none")
+        self.format = _PIXEL_FORMATS[pixel_format] if kind == KIND_EVF_IMAGE and pixel_format < len(_PIXEL_FORMATS) else None
+        self.zoom_rect = (zx, zy, zw, zh)
+        self.image_position = (px, py)
+        self.name = name.split(b"\0", 1)[0].decode("utf-8", "replace")
+        self.data = self._view(reader._buffer, offset + reader._slot_header_size)
+
+    def _view(self, buffer, payload: int):
+        if not HAVE_NUMPY:
+            return buffer[payload:payload + self.length].toreadonly()
+        if self.kind == "evf_image" and self.width > 0 and self.height > 0:
+            array = np.ndarray((self.height, self.width, self.channels), dtype=np.uint8, buffer=buffer,
+                               offset=payload, strides=(self.stride, self.channels, 1))
+        else:
+            array = np.frombuffer(buffer, dtype=np.uint8, count=self.length, offset=payload)
+        array.flags.writeable = False
+        return array
+
+    def is_valid(self) -> bool:
+        """True while the writer has not touched this frame's slot since it was read."""
+        return self._reader._lock_at(self._offset) == self._lock
+
+    def copy(self):
+        """The payload copied out of the ring, or None if it changed while copying."""
+        data = self.data.copy() if HAVE_NUMPY else bytes(self.data)
+        return data if self.is_valid() else None
+
+    def __repr__(self) -> str:
+        return f"<SharedFrame {self.kind} #{self.sequence} length={self.length}>"
+
+
+class SharedFrameReader:
+    """Maps a ring published by another process and reads frames from it.
+
+    Reading never blocks the writer. Arrays handed out keep the mapping
+    alive, so drop them before calling close().
+    """
+
+    def __init__(self, name: str):
+        """Open the ring published under name.
+
+        Raises:
+            FileNotFoundError: No ring of that name exists
+            ValueError: The segment is not a ring of a known version
+        """
+        self._memory = _open_shared_memory(name)
+        self._buffer = self._memory.buf
+        try:
+            (magic, version, header_size, self.slot_count, self._slot_header_size,
+             self.slot_size, self._slot_stride, _, self.producer_id, _) = _HEADER.unpack_from(self._buffer, 0)
+            if magic != RING_MAGIC or version != RING_VERSION:
+                raise ValueError(f"{name} is not a shared frame ring")
+        except Exception:
+            self.close()
+            raise
+        self.name = name
+        self._header_size = header_size
+
+    def __enter__(self) -> "SharedFrameReader":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def close(self) -> None:
+        """Unmap the ring; the writer and other readers are unaffected."""
+        memory, self._memory = getattr(self, "_memory", None), None
+        self._buffer = None
+        if memory is not None:
+            try:
+                memory.close()
+            except BufferError:
+                logger.debug("Shared frames still referenced, unmapping when they are released")
+
+    def _lock_at(self, offset: int) -> int:
+        return _LOCK.unpack_from(self._buffer, offset)[0]
+
+    @property
+    def published(self) -> int:
+        """Sequence of the newest complete frame, 0 before the first."""
+        return _LOCK.unpack_from(self._buffer, _PUBLISHED_OFFSET)[0]
+
+    def read(self, sequence: int) -> Optional[SharedFrame]:
+        """The frame with this sequence, or None if it is gone or not written yet."""
+        if self._buffer is None or sequence <= 0 or sequence > self.published:
+            return None
+        offset = self._header_size + ((sequence - 1) % self.slot_count) * self._slot_stride
+        lock = self._lock_at(offset)
+        if lock & 1:
+            return None
+        info = _INFO.unpack_from(self._buffer, offset + _INFO_OFFSET)
+        if self._lock_at(offset) != lock or info[0] != sequence or info[3] > self.slot_size:
+            return None
+        return SharedFrame(self, lock, offset, info)
+
+    def latest(self) -> Optional[SharedFrame]:
+        """The newest frame, or None if there is none yet."""
+        for _ in range(2):
+            frame = self.read(self.published)
+            if frame is not None:
+                return frame
+        return None
+
+    def wait(self, after: int = 0, timeout: Optional[float] = None) -> Optional[SharedFrame]:
+        """Wait for a frame newer than sequence ``after`` and return the newest.
+
+        Args:
+            after: Sequence already seen
+            timeout: Seconds to wait, None for ever
+
+        Returns:
+            The frame, or None on timeout
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while self._buffer is not None:
+            if self.published > after:
+                frame = self.latest()
+                if frame is not None:
+                    return frame
+            if deadline is not None and time.monotonic() >= deadline:
+                return None
+            time.sleep(0.001)
+        return None
+
+    def frames(self, timeout: Optional[float] = None) -> Iterator[SharedFrame]:
+        """Yield each new frame as it is published, skipping any the reader fell behind on.
+
+        Stops when no frame arrives within timeout seconds.
+        """
+        last = 0
+        while True:
+            frame = self.wait(last, timeout)
+            if frame is None:
+                return
+            last = frame.sequence
+            yield frame
+
+
+def _open_shared_memory(name: str) -> shared_memory.SharedMemory:
+    # The writer owns the segment; stop Python unlinking it when we exit
+    if sys.version_info >= (3, 13):
+        return shared_memory.SharedMemory(name=name, create=False, track=False)
+    memory = shared_memory.SharedMemory(name=name, create=False)
+    if sys.platform != "win32":
+        try:
+            from multiprocessing import resource_tracker
+            resource_tracker.unregister(memory._name, "shared_memory")
+        except Exception:
+            pass
+    return memory
@@ -0,0 +1,454 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : PipelineBenchmark.cpp                                           *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+// Times the command, live view and capture paths against the mock EDSDK:
+//
+//   edsdk_benchmark [--cameras=N] [--commands=N] [--evf-seconds=S] [--shots=N]
+//                   [--busy=PERMILLE] [--raw=BYTES] [--zero-latency] [--json]
+//                   [--min-command-rate=N] [--min-evf-fps=N] [--max-capture-ms=N]
+//                   [--lazy] [--trace=PATH]
+//
+// The --min/--max options make it exit with 1 when a result is worse, so a
+// scripted run catches regressions. --trace writes a Chrome trace of the
+// whole run, for chrome://tracing or ui.perfetto.dev. --lazy opens the
+// sessions with kStartupMode_Lazy, for the time to the first frame.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MockEDSDK.h"
+#include "CameraManager.h"
+#include "EvfPump.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+
+typedef struct _BENCHMARK_OPTIONS
+{
+	EdsUInt32	cameras;
+	EdsUInt32	commands;
+	double		evfSeconds;
+	EdsUInt32	shots;
+	EdsUInt32	busyPermille;
+	EdsUInt32	rawSize;
+	bool		zeroLatency;
+	bool		lazy;
+	bool		json;
+	double		minCommandRate;
+	double		minEvfFps;
+	double		maxCaptureMillis;
+	std::string	tracePath;
+}BENCHMARK_OPTIONS;
+
+typedef struct _BENCHMARK_RESULTS
+{
+	STARTUP_TIMING		startup;			// first camera, live view started as the session opens
+	double				commandRate;		// set property commands per second, all cameras
+	LATENCY_SNAPSHOT	commandLatency;		// enqueue to completion
+	EdsUInt64			commandErrors;
+	double				evfFps;
+	EdsUInt64			evfFrames;
+	EdsUInt64			evfNotReady;
+	LATENCY_SNAPSHOT	captureLatency;		// takePicture to the image in memory
+	EdsUInt32			captured;
+	EdsUInt64			busyInjected;
+	EdsUInt64			leakedObjects;
+}BENCHMARK_RESULTS;
+
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool parseOption(const char* arg, const char* name, std::string& value)
+{
+	size_t length = strlen(name);
+	if(strncmp(arg, name, length) != 0)
+	{
+		return false;
+	}
+	if(arg[length] == '=')
+	{
+		value = arg + length + 1;
+		return true;
+	}
+	if(arg[length] == '\0')
+	{
+		value = "1";
+		return true;
+	}
+	return false;
+}
+
+static bool parseOptions(int argc, char** argv, BENCHMARK_OPTIONS& options)
+{
+	options.cameras = 1;
+	options.commands = 200;
+	options.evfSeconds = 2.0;
+	options.shots = 10;
+	options.busyPermille = 0;
+	options.rawSize = 0;
+	options.zeroLatency = false;
+	options.lazy = false;
+	options.json = false;
+	options.minCommandRate = 0.0;
+	options.minEvfFps = 0.0;
+	options.maxCaptureMillis = 0.0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string value;
+		if(parseOption(argv[i], "--cameras", value))					options.cameras = (EdsUInt32)atoi(value.c_str());
+		else if(parseOption(argv[i], "--commands", value))				options.commands = (EdsUInt32)atoi(value.c_str());
+		else if(parseOption(argv[i], "--evf-seconds", value))			options.evfSeconds = atof(value.c_str());
+		else if(parseOption(argv[i], "--shots", value))					options.shots = (EdsUInt32)atoi(value.c_str());
+		else if(parseOption(argv[i], "--busy", value))					options.busyPermille = (EdsUInt32)atoi(value.c_str());
+		else if(parseOption(argv[i], "--raw", value))					options.rawSize = (EdsUInt32)atoi(value.c_str());
+		else if(parseOption(argv[i], "--zero-latency", value))			options.zeroLatency = true;
+		else if(parseOption(argv[i], "--lazy", value))					options.lazy = true;
+		else if(parseOption(argv[i], "--json", value))					options.json = true;
+		else if(parseOption(argv[i], "--min-command-rate", value))		options.minCommandRate = atof(value.c_str());
+		else if(parseOption(argv[i], "--min-evf-fps", value))			options.minEvfFps = atof(value.c_str());
+		else if(parseOption(argv[i], "--max-capture-ms", value))		options.maxCaptureMillis = atof(value.c_str());
+		else if(parseOption(argv[i], "--trace", value))					options.tracePath = value;
+		else
+		{
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return false;
+		}
+	}
+	if(options.cameras == 0)
+	{
+		options.cameras = 1;
+	}
+	return true;
+}
+
+
+// Property sets on every camera at once; each set is acknowledged by the
+// body and refreshed through a PropertyChanged event, as on hardware.
+static void benchmarkCommands(CameraManager& manager, const BENCHMARK_OPTIONS& options, BENCHMARK_RESULTS& results)
+{
+	LatencyHistogram latency;
+	std::atomic<EdsUInt64> errors(0);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for(size_t n = 0; n < manager.getSessionCount(); n++)
+	{
+		CameraSessionRef session = manager.getSession(n);
+		workers.push_back(std::thread([session, &options, &latency, &errors]()
+		{
+			CameraController* controller = session->getCameraController();
+			CameraModel* model = session->getCameraModel();
+
+			controller->getPropertyDesc(kEdsPropID_Tv)->wait(-1);
+			EdsPropertyDesc desc = model->getTvDesc();
+			if(desc.numElements == 0)
+			{
+				errors += options.commands;
+				return;
+			}
+
+			std::vector<CommandHandleRef> handles;
+			for(EdsUInt32 i = 0; i < options.commands; i++)
+			{
+				handles.push_back(controller->setProperty(kEdsPropID_Tv, (EdsUInt32)desc.propDesc[i % desc.numElements]));
+			}
+			for(size_t i = 0; i < handles.size(); i++)
+			{
+				handles[i]->wait(-1);
+				if(!handles[i]->succeeded())
+				{
+					errors++;
+				}
+				COMMAND_TIMING timing = handles[i]->getTiming();
+				latency.record(timing.completeMicros - timing.enqueueMicros);
+			}
+		}));
+	}
+	for(size_t n = 0; n < workers.size(); n++)
+	{
+		workers[n].join();
+	}
+
+	double elapsed = secondsSince(start);
+	results.commandRate = (elapsed > 0.0) ? (double)options.commands * workers.size() / elapsed : 0.0;
+	results.commandLatency = latency.snapshot();
+	results.commandErrors = errors;
+}
+
+// Live view asked for right after connecting, to the first frame
+static void benchmarkStartup(CameraManager& manager, BENCHMARK_RESULTS& results)
+{
+	CameraSessionRef session = manager.getSession(0);
+	CameraController* controller = session->getCameraController();
+	CameraModel* model = session->getCameraModel();
+
+	controller->startEvf();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while(model->getStartupTiming().firstFrameMicros == 0 && secondsSince(start) < 5.0)
+	{
+		if(model->getEvfOutputDevice() & kEdsEvfOutputDevice_PC)
+		{
+			controller->downloadEvf()->wait(-1);
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	results.startup = model->getStartupTiming();
+
+	controller->endEvf()->wait(-1);
+}
+
+// An EvfPump on the first camera for evfSeconds
+static void benchmarkEvf(CameraManager& manager, const BENCHMARK_OPTIONS& options, BENCHMARK_RESULTS& results)
+{
+	CameraSessionRef session = manager.getSession(0);
+	CameraController* controller = session->getCameraController();
+	CameraModel* model = session->getCameraModel();
+
+	results.evfFps = 0.0;
+	results.evfFrames = 0;
+	results.evfNotReady = 0;
+	if(options.evfSeconds <= 0.0)
+	{
+		return;
+	}
+
+	controller->startEvf()->wait(-1);
+
+	// The model hears of the PC output device through a PropertyChanged event
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while((model->getEvfOutputDevice() & kEdsEvfOutputDevice_PC) == 0 && secondsSince(start) < 5.0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	EvfPump pump(model);
+	pump.setNotReadyWait(1);
+	pump.start();
+
+	start = std::chrono::steady_clock::now();
+	std::this_thread::sleep_for(std::chrono::microseconds((EdsUInt64)(options.evfSeconds * 1000000.0)));
+	EVF_PUMP_STATISTICS stats = pump.getStatistics();
+	double elapsed = secondsSince(start);
+	pump.stop();
+
+	controller->endEvf()->wait(-1);
+
+	results.evfFrames = stats.published;
+	results.evfNotReady = stats.notReady;
+	results.evfFps = (elapsed > 0.0) ? (double)stats.published / elapsed : 0.0;
+}
+
+// takePicture to the last file of the shot in the capture queue
+static void benchmarkCapture(CameraManager& manager, const BENCHMARK_OPTIONS& options, BENCHMARK_RESULTS& results)
+{
+	CameraSessionRef session = manager.getSession(0);
+	CameraController* controller = session->getCameraController();
+	CameraModel* model = session->getCameraModel();
+	LatencyHistogram latency;
+
+	model->setDownloadTarget(kDownloadTarget_Memory);
+	int filesPerShot = (options.rawSize > 0) ? 2 : 1;
+
+	results.captured = 0;
+	for(EdsUInt32 shot = 0; shot < options.shots; shot++)
+	{
+		EdsUInt64 started = evfClockMicros();
+		controller->takePicture();
+
+		int received = 0;
+		while(received < filesPerShot)
+		{
+			CapturedImageRef image = model->getCaptureQueue()->pop(10000);
+			if(!image)
+			{
+				break;
+			}
+			received++;
+		}
+		if(received == filesPerShot)
+		{
+			latency.record(evfClockMicros() - started);
+			results.captured++;
+		}
+	}
+
+	model->setDownloadTarget(kDownloadTarget_File);
+	results.captureLatency = latency.snapshot();
+}
+
+
+static void printLatency(const char* name, const LATENCY_SNAPSHOT& snapshot)
+{
+	printf("  %-22s p50 %8.2f ms  p99 %8.2f ms  max %8.2f ms  (n=%llu)\n", name,
+		LatencyHistogram::percentile(snapshot, 0.5) / 1000.0,
+		LatencyHistogram::percentile(snapshot, 0.99) / 1000.0,
+		snapshot.maxMicros / 1000.0,
+		(unsigned long long)snapshot.count);
+}
+
+static void printResults(const BENCHMARK_OPTIONS& options, const BENCHMARK_RESULTS& results)
+{
+	if(options.json)
+	{
+		printf("{\"cameras\": %u, \"command_rate\": %.1f, \"command_p50_ms\": %.3f, \"command_p99_ms\": %.3f, \"command_errors\": %llu, "
+			"\"startup_lazy\": %s, \"first_frame_ms\": %.3f, \"startup_properties\": %llu, "
+			"\"evf_fps\": %.2f, \"evf_frames\": %llu, \"evf_not_ready\": %llu, "
+			"\"captured\": %u, \"capture_p50_ms\": %.3f, \"capture_p99_ms\": %.3f, "
+			"\"busy_injected\": %llu, \"leaked_objects\": %llu}\n",
+			(unsigned)options.cameras, results.commandRate,
+			LatencyHistogram::percentile(results.commandLatency, 0.5) / 1000.0,
+			LatencyHistogram::percentile(results.commandLatency, 0.99) / 1000.0,
+			(unsigned long long)results.commandErrors,
+			options.lazy ? "true" : "false", results.startup.timeToFirstFrameMicros / 1000.0,
+			(unsigned long long)results.startup.propertiesFetched,
+			results.evfFps, (unsigned long long)results.evfFrames, (unsigned long long)results.evfNotReady,
+			(unsigned)results.captured,
+			LatencyHistogram::percentile(results.captureLatency, 0.5) / 1000.0,
+			LatencyHistogram::percentile(results.captureLatency, 0.99) / 1000.0,
+			(unsigned long long)results.busyInjected, (unsigned long long)results.leakedObjects);
+		return;
+	}
+
+	printf("cameras %u%s, busy %u permille\n", (unsigned)options.cameras, options.zeroLatency ? ", zero latency" : "", (unsigned)options.busyPermille);
+	printf("startup   %10.2f ms to the first frame, %s (%llu properties read first)\n",
+		results.startup.timeToFirstFrameMicros / 1000.0, options.lazy ? "lazy" : "eager",
+		(unsigned long long)results.startup.propertiesFetched);
+	printf("commands  %10.1f /s  (%llu errors)\n", results.commandRate, (unsigned long long)results.commandErrors);
+	printLatency("set property", results.commandLatency);
+	printf("live view %10.2f fps (%llu frames, %llu not ready)\n", results.evfFps,
+		(unsigned long long)results.evfFrames, (unsigned long long)results.evfNotReady);
+	printf("capture   %10u of %u shots\n", (unsigned)results.captured, (unsigned)options.shots);
+	printLatency("shot to memory", results.captureLatency);
+	printf("busy injected %llu, objects leaked %llu\n", (unsigned long long)results.busyInjected, (unsigned long long)results.leakedObjects);
+}
+
+static int checkThresholds(const BENCHMARK_OPTIONS& options, const BENCHMARK_RESULTS& results)
+{
+	int failed = 0;
+	if(options.minCommandRate > 0.0 && results.commandRate < options.minCommandRate)
+	{
+		fprintf(stderr, "command rate %.1f/s below %.1f/s\n", results.commandRate, options.minCommandRate);
+		failed = 1;
+	}
+	if(options.minEvfFps > 0.0 && results.evfFps < options.minEvfFps)
+	{
+		fprintf(stderr, "live view %.2f fps below %.2f fps\n", results.evfFps, options.minEvfFps);
+		failed = 1;
+	}
+	double captureMillis = LatencyHistogram::percentile(results.captureLatency, 0.99) / 1000.0;
+	if(options.maxCaptureMillis > 0.0 && (results.captured < options.shots || captureMillis > options.maxCaptureMillis))
+	{
+		fprintf(stderr, "capture p99 %.2f ms over %.2f ms, or shots lost\n", captureMillis, options.maxCaptureMillis);
+		failed = 1;
+	}
+	if(results.leakedObjects != 0)
+	{
+		fprintf(stderr, "%llu SDK objects not released\n", (unsigned long long)results.leakedObjects);
+		failed = 1;
+	}
+	return failed;
+}
+
+
+int main(int argc, char** argv)
+{
+	BENCHMARK_OPTIONS options;
+	if(!parseOptions(argc, argv, options))
+	{
+		return 2;
+	}
+
+	MOCK_EDSDK_CONFIG config;
+	MockEdsGetDefaultConfig(&config);
+	config.cameraCount = options.cameras;
+	config.busyPermille = options.busyPermille;
+	config.rawSize = options.rawSize;
+	// Nothing here runs a message loop
+	config.eventThread = true;
+	config.sessionEvents = true;
+	if(options.zeroLatency)
+	{
+		config.sessionLatencyMicros = 0;
+		config.propertyLatencyMicros = 0;
+		config.setPropertyLatencyMicros = 0;
+		config.commandLatencyMicros = 0;
+		config.evfLatencyMicros = 0;
+		config.evfPropertyLatencyMicros = 0;
+		config.evfFrameIntervalMicros = 1;
+		config.evfWarmupMicros = 0;
+		config.captureLatencyMicros = 0;
+		config.transferBytesPerSecond = 0;
+	}
+	MockEdsSetConfig(&config);
+
+	if(!options.tracePath.empty())
+	{
+		Tracer::instance().start();
+		Tracer::instance().setThreadName("Benchmark");
+	}
+
+	BENCHMARK_RESULTS results = BENCHMARK_RESULTS();
+	{
+		CameraManager manager;
+		EdsError err = manager.initialize();
+		manager.setStartupMode(options.lazy ? kStartupMode_Lazy : kStartupMode_Eager);
+		if(err == EDS_ERR_OK)
+		{
+			err = manager.connectAll();
+		}
+		if(err != EDS_ERR_OK)
+		{
+			fprintf(stderr, "connect failed: 0x%08x\n", (unsigned)err);
+			return 2;
+		}
+
+		benchmarkStartup(manager, results);
+		benchmarkCommands(manager, options, results);
+		benchmarkEvf(manager, options, results);
+		benchmarkCapture(manager, options, results);
+
+		MOCK_EDSDK_STATISTICS stats;
+		MockEdsGetStatistics(&stats);
+		results.busyInjected = stats.busyInjected;
+
+		manager.terminate();
+	}
+
+	MOCK_EDSDK_STATISTICS stats;
+	MockEdsGetStatistics(&stats);
+	results.leakedObjects = stats.liveObjects;
+
+	if(!options.tracePath.empty())
+	{
+		Tracer::instance().stop();
+		if(!Tracer::instance().writeChromeTrace(options.tracePath.c_str()))
+		{
+			fprintf(stderr, "cannot write %s\n", options.tracePath.c_str());
+		}
+	}
+
+	printResults(options, results);
+	return checkThresholds(options, results);
+}
@@ -36,7 +36,7 @@ public:
 		}
 	}
 	
-	void fireEvent(LPCTSTR command, void* arg = 0)
+	void fireEvent(const char* command, void* arg = 0)
 	{
 		std::vector<ActionListener*>::iterator i = _listeners.begin();
 		
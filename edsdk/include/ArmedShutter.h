@@ -0,0 +1,304 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ArmedShutter.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "EDSDK.h"
+#include "CameraEvent.h"
+#include "CameraModel.h"
+#include "Metrics.h"
+#include "RetryPolicy.h"
+#include "Trace.h"
+
+
+enum ArmedShutterMode
+{
+	// Held half pressed, so AF and metering are done and locked before the release
+	kArmedShutter_HalfPress = 0,
+	// Held half pressed without AF; the release does not focus either
+	kArmedShutter_NonAF,
+};
+
+enum ArmedShutterState
+{
+	kArmedShutter_Idle = 0,
+	kArmedShutter_Armed,
+	kArmedShutter_Firing,
+	kArmedShutter_Failed,		// arming failed, or the body dropped the half press
+};
+
+// One release. Times are evfClockMicros().
+typedef struct _ARMED_SHUTTER_SHOT
+{
+	EdsUInt64	index;				// from 1
+	EdsError	error;
+	EdsUInt64	commandMicros;		// fire() called
+	EdsUInt64	callMicros;			// inside EdsSendCommand for the release
+	EdsUInt64	transferMicros;		// DirItemRequestTransfer, 0 until it came
+	EdsUInt64	lagMicros;			// fire() to DirItemRequestTransfer
+}ARMED_SHUTTER_SHOT;
+
+typedef struct _ARMED_SHUTTER_STATISTICS
+{
+	ArmedShutterState	state;
+	EdsUInt64			shots;
+	EdsUInt64			failed;
+	EdsUInt64			armMicros;		// last arm(), including busy retries
+	LATENCY_SNAPSHOT	call;			// EdsSendCommand of the release
+	LATENCY_SNAPSHOT	lag;			// fire() to DirItemRequestTransfer
+}ARMED_SHUTTER_STATISTICS;
+
+
+// Low latency release. arm() half presses the body and keeps it there, so
+// AF and metering are out of the way; fire() then sends the full press
+// straight from the calling thread, past the command queue and whatever is
+// waiting in it, and goes back to the half press for the next shot. Each
+// shot's lag is the time from fire() to the camera's DirItemRequestTransfer.
+// The calls go to the SDK on the caller's thread while the processor may
+// be using it too, as FocusEngine does with the lens.
+class ArmedShutter
+{
+public:
+	enum { kDefaultTransferTimeoutMillis = 5000 };
+
+private:
+	CameraModel*			_model;
+	ArmedShutterMode		_mode;
+	RETRY_POLICY			_busyPolicy;
+	RetryPolicyTable		_delays;
+	bool					_pumpEvents;
+
+	std::mutex				_mutex;			// one arm or fire at a time
+	std::atomic<int>		_state;
+	std::atomic<EdsUInt64>	_shots;
+	std::atomic<EdsUInt64>	_failed;
+	std::atomic<EdsUInt64>	_armMicros;
+	ARMED_SHUTTER_SHOT		_last;			// guarded by _mutex
+	bool					_lagPending;	// _last waits for its transfer request
+	LatencyHistogram		_callLatency;
+	LatencyHistogram		_lagLatency;
+
+	ArmedShutter(const ArmedShutter&);
+	ArmedShutter& operator=(const ArmedShutter&);
+
+	EdsUInt32 halfPress() const		{ return (_mode == kArmedShutter_NonAF) ? kEdsCameraCommand_ShutterButton_Halfway_NonAF : kEdsCameraCommand_ShutterButton_Halfway; }
+	EdsUInt32 fullPress() const		{ return (_mode == kArmedShutter_NonAF) ? kEdsCameraCommand_ShutterButton_Completely_NonAF : kEdsCameraCommand_ShutterButton_Completely; }
+
+	EdsError press(EdsUInt32 status)
+	{
+		TraceScope trace("EDSDK", "EdsSendCommand");
+		EdsError err = EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton, status);
+		trace.setArg("error", err);
+		return err;
+	}
+
+	// Busy is retried within milliseconds, not with the processor's 500 ms
+	EdsError pressRetrying(EdsUInt32 status)
+	{
+		EdsUInt64 first = evfClockMicros();
+		for(EdsUInt32 attempt = 1; ; attempt++)
+		{
+			EdsError err = press(status);
+			if((err & EDS_ERRORID_MASK) != EDS_ERR_DEVICE_BUSY)
+			{
+				return err;
+			}
+
+			EdsUInt64 elapsedMillis = (evfClockMicros() - first) / 1000;
+			if((_busyPolicy.maxAttempts != 0 && attempt >= _busyPolicy.maxAttempts) ||
+			   (_busyPolicy.deadlineMillis != 0 && elapsedMillis >= _busyPolicy.deadlineMillis))
+			{
+				return err;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(_delays.delayMillis(_busyPolicy, attempt)));
+		}
+	}
+
+	// Lock held. Takes the transfer request of the last shot if it came.
+	bool resolveLag()
+	{
+		if(!_lagPending)
+		{
+			return true;
+		}
+		EdsUInt64 transfer = _model->getFirstTransferRequestMicros();
+		if(transfer == 0)
+		{
+			return false;
+		}
+		_last.transferMicros = transfer;
+		_last.lagMicros = (transfer > _last.commandMicros) ? transfer - _last.commandMicros : 0;
+		_lagLatency.record(_last.lagMicros);
+		_lagPending = false;
+		return true;
+	}
+
+public:
+	ArmedShutter(CameraModel* model, ArmedShutterMode mode = kArmedShutter_HalfPress)
+		: _model(model), _mode(mode), _busyPolicy(RetryPolicyTable::makePolicy(5, 1.5, 50, 0.2, 0, 3000)),
+		  _pumpEvents(false), _state(kArmedShutter_Idle), _shots(0), _failed(0), _armMicros(0), _lagPending(false)
+	{
+		memset(&_last, 0, sizeof(_last));
+	}
+
+	~ArmedShutter()
+	{
+		disarm();
+	}
+
+	// Taken by the next arm()
+	void setMode(ArmedShutterMode mode)					{ std::lock_guard<std::mutex> lock(_mutex); _mode = mode; }
+	ArmedShutterMode getMode()							{ std::lock_guard<std::mutex> lock(_mutex); return _mode; }
+	// How a press the camera answers busy is retried, while arming only
+	void setBusyPolicy(const RETRY_POLICY& policy)		{ std::lock_guard<std::mutex> lock(_mutex); _busyPolicy = policy; }
+	// Call EdsGetEvent in waitForTransfer(), for callers with no message
+	// loop. Must then run on the thread that initialized the SDK.
+	void setPumpEvents(bool pumpEvents)					{ std::lock_guard<std::mutex> lock(_mutex); _pumpEvents = pumpEvents; }
+
+	ArmedShutterState getState() const					{ return (ArmedShutterState)_state.load(); }
+	bool isArmed() const								{ return getState() == kArmedShutter_Armed; }
+
+	// Half presses the body and holds it. Returns once AF and metering are done.
+	EdsError arm()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		EdsUInt64 start = evfClockMicros();
+		EdsError err = pressRetrying(halfPress());
+		_armMicros = evfClockMicros() - start;
+		_state = (err == EDS_ERR_OK) ? kArmedShutter_Armed : kArmedShutter_Failed;
+		return err;
+	}
+
+	// Lets go of the button
+	EdsError disarm()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(getState() == kArmedShutter_Idle)
+		{
+			return EDS_ERR_OK;
+		}
+		EdsError err = press(kEdsCameraCommand_ShutterButton_OFF);
+		_state = kArmedShutter_Idle;
+		return err;
+	}
+
+	// Releases the shutter now, from this thread; never retried, a late
+	// release is no use. With rearm the button goes back to half pressed,
+	// else it is let go. Disarmed, the release pays for AF and metering.
+	EdsError fire(bool rearm = true, ARMED_SHUTTER_SHOT* shot = NULL)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		resolveLag();
+
+		int previous = _state.exchange(kArmedShutter_Firing);
+
+		_model->expectTransferRequest();
+		EdsUInt64 start = evfClockMicros();
+		EdsError err = press(fullPress());
+		EdsUInt64 end = evfClockMicros();
+
+		// Back to half pressed holds the focus; OFF ends the shot
+		EdsError after = press((rearm && err == EDS_ERR_OK) ? halfPress() : (EdsUInt32)kEdsCameraCommand_ShutterButton_OFF);
+
+		memset(&_last, 0, sizeof(_last));
+		_last.index = ++_shots;
+		_last.error = err;
+		_last.commandMicros = start;
+		_last.callMicros = end - start;
+		_callLatency.record(_last.callMicros);
+
+		if(err == EDS_ERR_OK)
+		{
+			_lagPending = true;
+			_state = !rearm ? kArmedShutter_Idle : (after == EDS_ERR_OK ? kArmedShutter_Armed : kArmedShutter_Failed);
+		}
+		else
+		{
+			_failed++;
+			_lagPending = false;
+			_state = (previous == kArmedShutter_Armed && rearm) ? kArmedShutter_Armed : kArmedShutter_Idle;
+			CameraEvent e(kCameraEvent_Error, &err);
+			_model->notifyObservers(&e);
+		}
+
+		if(shot != NULL)
+		{
+			*shot = _last;
+		}
+		return err;
+	}
+
+	// Waits for the last shot's DirItemRequestTransfer. False on timeout.
+	bool waitForTransfer(ARMED_SHUTTER_SHOT& shot, EdsUInt32 timeoutMillis = kDefaultTransferTimeoutMillis)
+	{
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+		for(;;)
+		{
+			bool pumpEvents;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				bool resolved = resolveLag();
+				shot = _last;
+				if(resolved || _last.error != EDS_ERR_OK)
+				{
+					return _last.index != 0 && _last.error == EDS_ERR_OK;
+				}
+				pumpEvents = _pumpEvents;
+			}
+
+			if(std::chrono::steady_clock::now() > deadline)
+			{
+				return false;
+			}
+			if(pumpEvents)
+			{
+				EdsGetEvent();
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	ARMED_SHUTTER_SHOT getLastShot()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		resolveLag();
+		return _last;
+	}
+
+	ARMED_SHUTTER_STATISTICS getStatistics()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			resolveLag();
+		}
+		ARMED_SHUTTER_STATISTICS stats;
+		stats.state = getState();
+		stats.shots = _shots;
+		stats.failed = _failed;
+		stats.armMicros = _armMicros;
+		stats.call = _callLatency.snapshot();
+		stats.lag = _lagLatency.snapshot();
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_shots = 0;
+		_failed = 0;
+		_callLatency.reset();
+		_lagLatency.reset();
+	}
+};
@@ -0,0 +1,635 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : AsyncFileSink.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+#include "CameraModel.h"
+#include "DownloadSink.h"
+#include "EvfFrame.h"
+#include "EDSDK.h"
+
+
+// Expands a path template for one downloaded file. Tokens:
+//   {name} camera file name       {stem} name without extension   {ext} extension
+//   {seq} sequence number, {seq:N} zero padded to N digits
+//   {model} product name          {serial} body serial number
+//   {date} YYYYMMDD  {time} HHMMSS  of the download, local time
+// Unknown tokens are kept as written. A template ending in a separator
+// gets {name} appended.
+inline std::string expandPathTemplate(const std::string& pathTemplate, CameraModel* model, const EdsDirectoryItemInfo& info, EdsUInt64 sequence)
+{
+	std::string name = info.szFileName;
+	std::string::size_type dot = name.rfind('.');
+	std::string stem = (dot == std::string::npos) ? name : name.substr(0, dot);
+	std::string ext = (dot == std::string::npos) ? std::string() : name.substr(dot + 1);
+
+	time_t now = time(NULL);
+	struct tm local;
+#ifdef _WIN32
+	localtime_s(&local, &now);
+#else
+	localtime_r(&now, &local);
+#endif
+
+	// Camera strings end up in paths; keep them to safe characters.
+	struct Clean
+	{
+		static std::string apply(const char* text)
+		{
+			std::string result;
+			for(; text != NULL && *text != '\0'; text++)
+			{
+				char c = *text;
+				bool safe = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '-' || c == '_';
+				result += safe ? c : (c == ' ' ? '_' : '-');
+			}
+			return result;
+		}
+	};
+
+	std::string result;
+	std::string::size_type i = 0;
+	while(i < pathTemplate.size())
+	{
+		std::string::size_type close = pathTemplate.find('}', i);
+		if(pathTemplate[i] != '{' || close == std::string::npos)
+		{
+			result += pathTemplate[i++];
+			continue;
+		}
+
+		std::string token = pathTemplate.substr(i + 1, close - i - 1);
+		char text[64];
+
+		if(token == "name")			result += name;
+		else if(token == "stem")	result += stem;
+		else if(token == "ext")		result += ext;
+		else if(token == "model")	result += Clean::apply(model != NULL ? model->getModelName() : NULL);
+		else if(token == "serial")	result += Clean::apply(model != NULL ? model->getSerialNumber() : NULL);
+		else if(token == "date")	{ strftime(text, sizeof(text), "%Y%m%d", &local); result += text; }
+		else if(token == "time")	{ strftime(text, sizeof(text), "%H%M%S", &local); result += text; }
+		else if(token == "seq" || token.compare(0, 4, "seq:") == 0)
+		{
+			int width = (token.size() > 4) ? atoi(token.c_str() + 4) : 0;
+			snprintf(text, sizeof(text), "%0*llu", (width > 0 && width < 20) ? width : 1, (unsigned long long)sequence);
+			result += text;
+		}
+		else
+		{
+			result += pathTemplate.substr(i, close - i + 1);
+		}
+		i = close + 1;
+	}
+
+	if(result.empty() || result[result.size() - 1] == '\\' || result[result.size() - 1] == '/')
+	{
+		result += name;
+	}
+	return result;
+}
+
+
+typedef struct _ASYNC_FILE_STATISTICS
+{
+	EdsUInt64	files;
+	EdsUInt64	failedFiles;
+	EdsUInt64	bytes;
+	EdsUInt64	writes;			// buffers handed to the disk
+	EdsUInt64	waitMicros;		// time write() waited for the disk
+}ASYNC_FILE_STATISTICS;
+
+
+// File sink that keeps the download thread off the disk: chunks are copied
+// into a few large page-aligned buffers that are written while the next
+// ones fill, unbuffered by default so big sequential writes go straight to
+// the device. Windows uses overlapped WriteFile with FILE_FLAG_NO_BUFFERING;
+// elsewhere a writer thread calls pwrite, with O_DIRECT (F_NOCACHE on
+// macOS) where the file system takes it. The file is preallocated to
+// the item size up front and trimmed to the exact length at the end.
+// Paths come from a template, see expandPathTemplate(); missing directories
+// are created.
+class AsyncFileSink : public DownloadSink
+{
+public:
+	enum { kDefaultWriteSize = 8 * 1024 * 1024, kDefaultBufferCount = 4, kSectorSize = 4096 };
+
+private:
+	typedef struct _WRITE_BUFFER
+	{
+		unsigned char*	data;
+		size_t			used;
+#ifdef _WIN32
+		OVERLAPPED		overlapped;
+#else
+		EdsUInt64		offset;		// of the write the writer thread is given
+		size_t			length;
+#endif
+		bool			pending;
+	}WRITE_BUFFER;
+
+#ifdef _WIN32
+	typedef HANDLE FileHandle;
+	static FileHandle invalidFile()		{ return INVALID_HANDLE_VALUE; }
+#else
+	typedef int FileHandle;
+	static FileHandle invalidFile()		{ return -1; }
+
+	class Worker : public Thread
+	{
+	private:
+		AsyncFileSink*	_sink;
+	public:
+		Worker(AsyncFileSink* sink) : _sink(sink) {}
+		virtual void run() { _sink->writeBehind(); }
+	};
+#endif
+
+	std::string					_pathTemplate;
+	size_t						_writeSize;
+	bool						_unbuffered;
+	bool						_preallocate;
+
+	std::vector<WRITE_BUFFER>	_buffers;
+	size_t						_current;
+	FileHandle					_file;
+	EdsUInt64					_offset;
+	EdsUInt64					_length;
+	std::atomic<bool>			_failed;
+	EdsUInt64					_sequence;
+	std::string					_path;
+
+	ASYNC_FILE_STATISTICS		_stats;
+	// Guards the statistics and last path for readers on other threads
+	std::mutex					_mutex;
+
+#ifndef _WIN32
+	// Buffers waiting for the writer thread, and their pending flags
+	Worker						_worker;
+	std::deque<size_t>			_writes;
+	bool						_stopping;
+	std::mutex					_writeMutex;
+	std::condition_variable		_writeCondition;
+#endif
+
+	AsyncFileSink(const AsyncFileSink&);
+	AsyncFileSink& operator=(const AsyncFileSink&);
+
+public:
+	AsyncFileSink(const std::string& pathTemplate, EdsUInt32 writeSize = kDefaultWriteSize, EdsUInt32 bufferCount = kDefaultBufferCount, bool unbuffered = true)
+		: _pathTemplate(pathTemplate), _writeSize(alignUp(writeSize > 0 ? writeSize : (EdsUInt32)kDefaultWriteSize)), _unbuffered(unbuffered), _preallocate(true),
+		  _current(0), _file(invalidFile()), _offset(0), _length(0), _failed(false), _sequence(0)
+#ifndef _WIN32
+		  , _worker(this), _stopping(false)
+#endif
+	{
+		memset(&_stats, 0, sizeof(_stats));
+
+		_buffers.resize(bufferCount > 0 ? bufferCount : 1);
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+			WRITE_BUFFER& buffer = _buffers[i];
+			memset(&buffer, 0, sizeof(buffer));
+			// Page aligned, as unbuffered I/O needs.
+#ifdef _WIN32
+			buffer.data = (unsigned char*)VirtualAlloc(NULL, _writeSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+			buffer.overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+#else
+			void* data = mmap(NULL, _writeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			buffer.data = (data != MAP_FAILED) ? (unsigned char*)data : NULL;
+#endif
+		}
+
+#ifndef _WIN32
+		_worker.start();
+#endif
+	}
+
+	virtual ~AsyncFileSink()
+	{
+		closeFile(false);
+
+#ifndef _WIN32
+		{
+			std::lock_guard<std::mutex> lock(_writeMutex);
+			_stopping = true;
+		}
+		_writeCondition.notify_all();
+		_worker.join();
+#endif
+
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+#ifdef _WIN32
+			if(_buffers[i].data != NULL)
+			{
+				VirtualFree(_buffers[i].data, 0, MEM_RELEASE);
+			}
+			CloseHandle(_buffers[i].overlapped.hEvent);
+#else
+			if(_buffers[i].data != NULL)
+			{
+				munmap(_buffers[i].data, _writeSize);
+			}
+#endif
+		}
+	}
+
+	// Preallocation reserves the whole file before the first write, which
+	// keeps it contiguous on disk.
+	void setPreallocate(bool preallocate)		{ _preallocate = preallocate; }
+	// Sequence used for the next file's {seq}
+	void setSequence(EdsUInt64 sequence)		{ _sequence = sequence; }
+	const std::string& getPathTemplate() const	{ return _pathTemplate; }
+
+	std::string getPath()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _path;
+	}
+
+	ASYNC_FILE_STATISTICS getStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _stats;
+	}
+
+	virtual bool begin(CameraModel* model, const EdsDirectoryItemInfo& info)
+	{
+		closeFile(false);
+
+		std::string path = expandPathTemplate(_pathTemplate, model, info, _sequence++);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_path = path;
+		}
+
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+			if(_buffers[i].data == NULL)
+			{
+				return false;
+			}
+		}
+
+		createDirectories(path);
+
+		_file = openFile(path);
+		if(_file == invalidFile())
+		{
+			return false;
+		}
+
+		_current = 0;
+		_offset = 0;
+		_length = 0;
+		_failed = false;
+
+		if(_preallocate && info.size > 0)
+		{
+			setFileSize(alignUp(info.size));
+		}
+		return true;
+	}
+
+	virtual bool write(const unsigned char* data, size_t length)
+	{
+		while(length > 0 && !_failed)
+		{
+			WRITE_BUFFER& buffer = _buffers[_current];
+			size_t count = _writeSize - buffer.used;
+			if(count > length)
+			{
+				count = length;
+			}
+
+			memcpy(buffer.data + buffer.used, data, count);
+			buffer.used += count;
+			_length += count;
+			data += count;
+			length -= count;
+
+			if(buffer.used == _writeSize)
+			{
+				submit(buffer, _writeSize);
+				_current = (_current + 1) % _buffers.size();
+				wait(_buffers[_current]);
+			}
+		}
+		return !_failed;
+	}
+
+	virtual void end(bool success)
+	{
+		if(_file == invalidFile())
+		{
+			return;
+		}
+
+		// The tail goes out padded to a whole sector and is cut off below.
+		WRITE_BUFFER& buffer = _buffers[_current];
+		if(buffer.used > 0 && success && !_failed)
+		{
+			size_t padded = _unbuffered ? (size_t)alignUp(buffer.used) : buffer.used;
+			memset(buffer.data + buffer.used, 0, padded - buffer.used);
+			submit(buffer, padded);
+		}
+
+		closeFile(success);
+	}
+
+protected:
+	static EdsUInt64 alignUp(EdsUInt64 size)
+	{
+		return (size + kSectorSize - 1) / kSectorSize * kSectorSize;
+	}
+
+	FileHandle openFile(const std::string& path)
+	{
+#ifdef _WIN32
+		DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN;
+		if(_unbuffered)
+		{
+			flags |= FILE_FLAG_NO_BUFFERING;
+		}
+		return CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, flags, NULL);
+#else
+		int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_CLOEXEC
+		flags |= O_CLOEXEC;
+#endif
+		int file = -1;
+#ifdef O_DIRECT
+		if(_unbuffered)
+		{
+			file = ::open(path.c_str(), flags | O_DIRECT, 0666);
+		}
+		// tmpfs and some network file systems refuse O_DIRECT
+		if(file < 0)
+#endif
+		{
+			file = ::open(path.c_str(), flags, 0666);
+#ifdef F_NOCACHE
+			if(file >= 0 && _unbuffered)
+			{
+				fcntl(file, F_NOCACHE, 1);
+			}
+#endif
+		}
+		return file;
+#endif
+	}
+
+#ifdef _WIN32
+	void submit(WRITE_BUFFER& buffer, size_t length)
+	{
+		buffer.overlapped.Offset = (DWORD)(_offset & 0xffffffff);
+		buffer.overlapped.OffsetHigh = (DWORD)(_offset >> 32);
+		ResetEvent(buffer.overlapped.hEvent);
+
+		if(!WriteFile(_file, buffer.data, (DWORD)length, NULL, &buffer.overlapped) && GetLastError() != ERROR_IO_PENDING)
+		{
+			_failed = true;
+		}
+		else
+		{
+			buffer.pending = true;
+		}
+
+		_offset += length;
+		buffer.used = 0;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stats.writes++;
+	}
+
+	void wait(WRITE_BUFFER& buffer)
+	{
+		if(!buffer.pending)
+		{
+			return;
+		}
+
+		EdsUInt64 started = evfClockMicros();
+		DWORD written = 0;
+		if(!GetOverlappedResult(_file, &buffer.overlapped, &written, TRUE))
+		{
+			_failed = true;
+		}
+		buffer.pending = false;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stats.waitMicros += evfClockMicros() - started;
+	}
+
+	void setFileSize(EdsUInt64 size)
+	{
+		FILE_END_OF_FILE_INFO endOfFile;
+		endOfFile.EndOfFile.QuadPart = (LONGLONG)size;
+		SetFileInformationByHandle(_file, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile));
+	}
+
+	void closeHandle()
+	{
+		CloseHandle(_file);
+	}
+
+	static void removeFile(const std::string& path)
+	{
+		DeleteFileA(path.c_str());
+	}
+
+	static void makeDirectory(const std::string& path)
+	{
+		CreateDirectoryA(path.c_str(), NULL);
+	}
+#else
+	void submit(WRITE_BUFFER& buffer, size_t length)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_writeMutex);
+			buffer.offset = _offset;
+			buffer.length = length;
+			buffer.pending = true;
+			_writes.push_back((size_t)(&buffer - &_buffers[0]));
+		}
+		_writeCondition.notify_all();
+
+		_offset += length;
+		buffer.used = 0;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stats.writes++;
+	}
+
+	void wait(WRITE_BUFFER& buffer)
+	{
+		EdsUInt64 started = evfClockMicros();
+		{
+			std::unique_lock<std::mutex> lock(_writeMutex);
+			if(!buffer.pending)
+			{
+				return;
+			}
+			_writeCondition.wait(lock, [&buffer]() { return !buffer.pending; });
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stats.waitMicros += evfClockMicros() - started;
+	}
+
+	// Writer thread: the buffers in the order they were submitted
+	void writeBehind()
+	{
+		for(;;)
+		{
+			WRITE_BUFFER* buffer = NULL;
+			{
+				std::unique_lock<std::mutex> lock(_writeMutex);
+				_writeCondition.wait(lock, [this]() { return _stopping || !_writes.empty(); });
+				if(_writes.empty())
+				{
+					return;
+				}
+				buffer = &_buffers[_writes.front()];
+				_writes.pop_front();
+			}
+
+			const unsigned char* data = buffer->data;
+			size_t remaining = buffer->length;
+			off_t offset = (off_t)buffer->offset;
+			while(remaining > 0)
+			{
+				ssize_t written = ::pwrite(_file, data, remaining, offset);
+				if(written < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				if(written <= 0)
+				{
+					_failed = true;
+					break;
+				}
+				data += written;
+				remaining -= (size_t)written;
+				offset += written;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_writeMutex);
+				buffer->pending = false;
+			}
+			_writeCondition.notify_all();
+		}
+	}
+
+	void setFileSize(EdsUInt64 size)
+	{
+		if(size > _length)
+		{
+#if defined(__linux__)
+			// Reserves the blocks, unlike a sparse ftruncate
+			if(posix_fallocate(_file, 0, (off_t)size) == 0)
+			{
+				return;
+			}
+#endif
+		}
+		if(ftruncate(_file, (off_t)size) != 0 && size <= _length)
+		{
+			_failed = true;
+		}
+	}
+
+	void closeHandle()
+	{
+		::close(_file);
+	}
+
+	static void removeFile(const std::string& path)
+	{
+		::unlink(path.c_str());
+	}
+
+	static void makeDirectory(const std::string& path)
+	{
+		::mkdir(path.c_str(), 0777);
+	}
+#endif
+
+	void closeFile(bool success)
+	{
+		if(_file == invalidFile())
+		{
+			return;
+		}
+
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+			wait(_buffers[i]);
+			_buffers[i].used = 0;
+		}
+
+		bool ok = success && !_failed;
+		if(ok)
+		{
+			setFileSize(_length);
+			ok = !_failed;
+		}
+
+		closeHandle();
+		_file = invalidFile();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(ok)
+		{
+			_stats.files++;
+			_stats.bytes += _length;
+		}
+		else
+		{
+			_stats.failedFiles++;
+			removeFile(_path);
+		}
+	}
+
+	static void createDirectories(const std::string& path)
+	{
+		for(std::string::size_type i = 1; i < path.size(); i++)
+		{
+			if((path[i] == '\\' || path[i] == '/') && path[i - 1] != ':')
+			{
+				makeDirectory(path.substr(0, i));
+			}
+		}
+	}
+};
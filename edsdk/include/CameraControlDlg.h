@@ -34,7 +34,7 @@
 #include "EvfZoomButton.h"
 
 // CCameraControlDlg Dialog
-class CCameraControlDlg : public CDialog, public ActionSource, public Observer
+class CCameraControlDlg : public CDialog, public ActionSource, public EventObserver
 {
 	
 // Construction
@@ -50,7 +50,7 @@ public:
 
 public:
 	// Observer 
-	virtual void update(Observable* from, CameraEvent *e);
+	virtual void onEvent(Observable* from, const CameraEvent& e);
 
 	//Dialog data
 	enum { IDD = IDD_CAMERACONTROL_DIALOG };
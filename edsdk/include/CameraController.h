@@ -15,9 +15,13 @@
 
 #pragma once
 
+#include <string>
+#include <unordered_map>
+
 #include "EDSDK.h"
 #include "CameraModel.h"
 #include "Processor.h"
+#include "TransferProcessor.h"
 
 #include "ActionListener.h"
 #include "ActionEvent.h"
@@ -27,8 +31,12 @@
 #include "SaveSettingCommand.h"
 #include "TakePictureCommand.h"
 #include "DownloadCommand.h"
+#include "ThumbnailCommand.h"
+#include "ScanStorageCommand.h"
 #include "GetPropertyCommand.h"
 #include "GetPropertyDescCommand.h"
+#include "GetPropertiesCommand.h"
+#include "SetPropertiesCommand.h"
 #include "SetPropertyCommand.h"
 #include "SetCapacityCommand.h"
 #include "NotifyCommand.h"
@@ -41,6 +49,25 @@
 #include "GetPropertyCommand.h"
 #include "DoEvfAFCommand.h"
 
+// Everything a scraper needs in one call, without locks on the hot paths
+typedef struct _CONTROLLER_METRICS
+{
+	std::vector<COMMAND_METRICS>	commands;
+	std::vector<COMMAND_METRICS>	transferCommands;
+	LATENCY_SNAPSHOT				dispatchLatency;
+	LATENCY_SNAPSHOT				transferDispatchLatency;
+	EdsUInt32						queueDepth[kCommandPriority_Count];
+	EdsUInt32						retryDepth;
+	TRANSFER_STATISTICS				transfer;
+	EdsUInt64						evfFrames;
+	double							evfFramesPerSecond;
+	double							evfBytesPerSecond;
+	EdsUInt64						coalesced;
+	CAPTURE_POOL_STATISTICS			capturePool;
+	STARTUP_TIMING					startup;
+}CONTROLLER_METRICS;
+
+
 class CameraController : public ActionListener
 {
 
@@ -51,220 +78,507 @@ protected:
 	// Command processing
 	Processor _processor;
 
+	// Image downloads, unless a worker shared with other cameras is set
+	TransferProcessor _ownTransferProcessor;
+	TransferProcessor* _transferProcessor;
+
+	// Runs on the SDK thread as the body shuts down or goes away
+	std::shared_ptr<std::function<void()> > _shutdownHandler;
+
 public:
 	// Constructor
-	CameraController(): _model(){}
+	CameraController(): _model(), _transferProcessor(&_ownTransferProcessor){}
 
 	// Destoracta
 	virtual ~CameraController(){}
 
 	void setCameraModel(CameraModel* model) {_model = model;}
 
-	//Execution beginning
-	void run()
-	{
-		_processor.start();
+	// Share one transfer worker between cameras. Call before run();
+	// the caller starts and stops a shared worker.
+	void setTransferProcessor(TransferProcessor* processor) {_transferProcessor = (processor != NULL) ? processor : &_ownTransferProcessor;}
+	TransferProcessor* getTransferProcessor() {return _transferProcessor;}
 
-		//The communication with the camera begins
-		StoreAsync(new OpenSessionCommand(_model));
+	// Depth and throughput of the transfer worker
+	TRANSFER_STATISTICS getTransferStatistics() {return _transferProcessor->getStatistics();}
 
-		//It is necessary to acquire the property information that cannot acquire in sending OpenSessionCommand automatically by manual operation.
-		StoreAsync(new GetPropertyCommand(_model, kEdsPropID_ProductName));
-	}
+	// Enqueue-to-execute latency of the command processor
+	DISPATCH_LATENCY getDispatchLatency() {return _processor.getDispatchLatency();}
 
-public:
-	
-	void actionPerformed(const ActionEvent& event)
-	{
-		std::string command = event.getActionCommand();
+	// Number of commands waiting in a lane of the command processor
+	int getQueueDepth(CommandPriority priority) {return _processor.getQueueDepth(priority);}
 
+	// Number of property refreshes merged into one already pending
+	EdsUInt64 getCoalescedCount() {return _processor.getCoalescedCount();}
 
-		if ( command == "opensession" )
-		{
-			StoreAsync(new OpenSessionCommand(_model));
-		}
+	// How commands the camera could not take yet are reissued
+	RetryPolicyTable& getRetryPolicies() {return _processor.getRetryPolicies();}
 
-		if ( command == "set_AEMode" )
+	// Snapshot of the command and transfer processors and live view. The
+	// counters are read without locks; only the queue depths take one.
+	CONTROLLER_METRICS getMetrics()
+	{
+		CONTROLLER_METRICS metrics;
+		metrics.commands = _processor.getMetrics().getCommandMetrics();
+		metrics.transferCommands = _transferProcessor->getMetrics().getCommandMetrics();
+		metrics.dispatchLatency = _processor.getMetrics().getDispatchLatency();
+		metrics.transferDispatchLatency = _transferProcessor->getMetrics().getDispatchLatency();
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
 		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_AEModeSelect, *static_cast<EdsUInt32*>(event.getArg())));			
+			metrics.queueDepth[lane] = (EdsUInt32)_processor.getQueueDepth((CommandPriority)lane);
 		}
-
-		if ( command == "set_Av" )
+		metrics.retryDepth = (EdsUInt32)_processor.getRetryDepth();
+		metrics.transfer = _transferProcessor->getStatistics();
+		metrics.coalesced = _processor.getCoalescedCount();
+
+		metrics.evfFrames = 0;
+		metrics.evfFramesPerSecond = 0.0;
+		metrics.evfBytesPerSecond = 0.0;
+		memset(&metrics.capturePool, 0, sizeof(metrics.capturePool));
+		memset(&metrics.startup, 0, sizeof(metrics.startup));
+		if(_model != NULL)
 		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_Av, *static_cast<EdsUInt32*>(event.getArg())));			
+			metrics.startup = _model->getStartupTiming();
+			metrics.evfFrames = _model->getEvfRate().getTotal();
+			metrics.evfFramesPerSecond = _model->getEvfRate().getRate();
+			metrics.evfBytesPerSecond = _model->getEvfRate().getByteRate();
+			metrics.capturePool = _model->getCaptureBufferPool()->getStatistics();
 		}
+		return metrics;
+	}
 
-		if ( command == "set_Tv" )
-		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_Tv, *static_cast<EdsUInt32*>(event.getArg())));			
-		}
+	CameraModel* getCameraModel() {return _model;}
+
+	// Queue a command for this camera; transfers go to the transfer worker
+	CommandHandleRef enqueue(Command* command) {return StoreAsync(command);}
+
+	// Run on the processor once due, which stays free until then
+	CommandHandleRef enqueueAt(Command* command, std::chrono::steady_clock::time_point due)
+	{
+		return command->isTransfer() ? _transferProcessor->enqueueAt(command, due) : _processor.enqueueAt(command, due);
+	}
 
-		if ( command == "set_ISOSpeed" )
+	// Queue a command and be told on the processor thread when it is done
+	CommandHandleRef enqueue(Command* command, const CommandCompletion& completion)
+	{
+		command->setCompletion(completion);
+		return StoreAsync(command);
+	}
+
+	//Execution beginning
+	void run()
+	{
+		_processor.start();
+		if(_transferProcessor == &_ownTransferProcessor)
 		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_ISOSpeed, *static_cast<EdsUInt32*>(event.getArg())));			
+			_transferProcessor->start();
 		}
 
-		if ( command == "set_MeteringMode" )
+		//The communication with the camera begins
+		_model->noteStartup();
+		StoreAsync(new OpenSessionCommand(_model));
+
+		//It is necessary to acquire the property information that cannot acquire in sending OpenSessionCommand automatically by manual operation.
+		// Lazily, they are read when first asked for.
+		if(_model->getStartupMode() == kStartupMode_Eager)
 		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_MeteringMode, *static_cast<EdsUInt32*>(event.getArg())));			
+			StoreAsync(new GetPropertyCommand(_model, kEdsPropID_ProductName));
+			StoreAsync(new GetPropertyCommand(_model, kEdsPropID_BodyIDEx));
 		}
+	}
 
-		if ( command == "set_ExposureCompensation" )
+	// Call before run(). See StartupMode.
+	void setStartupMode(StartupMode mode)
+	{
+		PropertyDemandHandler demand;
+		if(mode == kStartupMode_Lazy)
 		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_ExposureCompensation, *static_cast<EdsUInt32*>(event.getArg())));			
+			demand = [this](EdsPropertyID propertyID, bool desc) {
+				if(desc) getPropertyDesc(propertyID);
+				else getProperty(propertyID);
+			};
 		}
-		
-		if ( command == "set_ImageQuality" )
+		_model->setStartupMode(mode, demand);
+	}
+	StartupMode getStartupMode() const {return _model->getStartupMode();}
+
+	// Names and pins the processor and transfer threads, and faults the
+	// pooled capture buffers in from the io cores so they sit on that node.
+	// Call before run(); a shared transfer processor keeps its own.
+	void setPlacement(const CAMERA_PLACEMENT& placement)
+	{
+		_model->setPlacement(placement);
+
+		std::string prefix(placement.name);
+		if(!prefix.empty())
 		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_ImageQuality, *static_cast<EdsUInt32*>(event.getArg())));			
+			_processor.setName(prefix + "-cmd");
+			_ownTransferProcessor.setName(prefix + "-xfer");
 		}
+		_processor.setPlacement(placement.io);
+		_ownTransferProcessor.setPlacement(placement.io);
 
-		if ( command == "pressingHalfway" )
+		if(placement.arenaBuffers > 0 && placement.arenaBufferSize > 0)
 		{
-			StoreAsync(new PressShutterButtonCommand(_model, kEdsCameraCommand_ShutterButton_Halfway));			
+			CaptureBufferPoolRef pool = _model->getCaptureBufferPool();
+			if(pool->getPoolSize() < placement.arenaBuffers)
+			{
+				pool->setPoolSize(placement.arenaBuffers);
+			}
+			ThreadPlacement::runOn(placement.io, [&pool, &placement]()
+			{
+				pool->preallocate(placement.arenaBuffers, placement.arenaBufferSize);
+			});
 		}
-		if ( command == "pressingCompletely" )
+	}
+	CAMERA_PLACEMENT getPlacement() {return _model->getPlacement();}
+
+	// The camera reported a change. Lazily, only what the model already
+	// holds is read now; the rest is read on its next access.
+	void propertyChanged(EdsPropertyID propertyID)
+	{
+		_model->getEvfMetadata().propertyChanged(propertyID);
+
+		if(_model->getStartupMode() == kStartupMode_Eager || propertyID == kEdsPropID_Unknown ||
+		   _model->getPropertyStore().getVersion(propertyID) != 0)
 		{
-			StoreAsync(new PressShutterButtonCommand(_model, kEdsCameraCommand_ShutterButton_Completely));			
+			getProperty(propertyID);
 		}
-		if ( command == "pressingOff" )
+		else
 		{
-			StoreAsync(new PressShutterButtonCommand(_model, kEdsCameraCommand_ShutterButton_OFF));			
+			_model->getPropertyStore().markStale(propertyID, false);
 		}
+	}
 
-		if ( command == "TakePicture" )
+	void propertyDescChanged(EdsPropertyID propertyID)
+	{
+		if(_model->getStartupMode() == kStartupMode_Eager || propertyID == kEdsPropID_Unknown ||
+		   _model->getPropertyStore().getDescVersion(propertyID) != 0)
 		{
-			StoreAsync(new TakePictureCommand(_model));
+			getPropertyDesc(propertyID);
 		}
-
-		if ( command == "set_Capacity" )
+		else
 		{
-			//EdsCapacity capacity = {0x7FFFFFFF, 0x1000, 1};
-			StoreAsync(new SetCapacityCommand(_model, *static_cast<EdsCapacity*>(event.getArg())));
+			_model->getPropertyStore().markStale(propertyID, true);
 		}
+	}
 
-		if ( command == "get_Property" )
-		{ 
-			StoreAsync(new GetPropertyCommand(_model, *static_cast<EdsUInt32*>(event.getArg())));
-		}
+public:
 
-		if( command == "get_PropertyDesc" ) 
+	// Typed commands: each queues its command and returns its handle, with
+	// no string compare on the way
+	CommandHandleRef openSession()								{return StoreAsync(new OpenSessionCommand(_model));}
+	CommandHandleRef setProperty(EdsPropertyID propertyID, EdsUInt32 value)	{return StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, propertyID, value));}
+	CommandHandleRef getProperty(EdsPropertyID propertyID)			{return StoreAsync(new GetPropertyCommand(_model, propertyID));}
+
+	// setTypedProperty<kEdsPropID_Tv>(0x60) does not compile with a value of the wrong type
+	template<EdsPropertyID propertyID>
+	CommandHandleRef setTypedProperty(const typename PropertyTraits<propertyID>::type& value)	{return StoreAsync(newSetPropertyCommand<propertyID>(_model, value));}
+	CommandHandleRef getProperties(const PropertyIDList& propertyIDs)	{return StoreAsync(new GetPropertiesCommand(_model, propertyIDs));}
+	// All of them under one UI lock; only the busy ones are retried
+	CommandHandleRef setProperties(const PropertySettingList& settings)	{return StoreAsync(new SetPropertiesCommand(_model, settings));}
+	CommandHandleRef getPropertyDesc(EdsPropertyID propertyID)		{return StoreAsync(new GetPropertyDescCommand(_model, propertyID));}
+	CommandHandleRef pressShutterButton(EdsUInt32 status)			{return StoreAsync(new PressShutterButtonCommand(_model, status));}
+	CommandHandleRef takePicture()								{return StoreAsync(new TakePictureCommand(_model));}
+	CommandHandleRef setCapacity(const EdsCapacity& capacity)		{return StoreAsync(new SetCapacityCommand(_model, capacity));}
+	// kEdsSaveTo_Camera, _Host or _Both, with the host's capacity when it is included
+	CommandHandleRef setSaveTo(EdsUInt32 saveTo)					{return StoreAsync(new SaveSettingCommand(_model, (EdsSaveTo)saveTo));}
+	CommandHandleRef notifyShutDown()							{return StoreAsync(new NotifyCommand(_model, "shutDown"));}
+
+	// kEdsStateEvent_Shutdown: observers hear of it from the processor,
+	// the shutdown handler at once
+	void handleShutDown()
+	{
+		notifyShutDown();
+		std::shared_ptr<std::function<void()> > handler = std::atomic_load(&_shutdownHandler);
+		if(handler)
 		{
-			StoreAsync(new GetPropertyDescCommand(_model, *static_cast<EdsUInt32*>(event.getArg())));
+			(*handler)();
 		}
+	}
 
-		if ( command == "download" )
-		{
-			StoreAsync(new DownloadCommand(_model, static_cast<EdsBaseRef>(event.getArg())));
-		}
+	// Hold this camera's commands in the queue, and those queued meanwhile,
+	// e.g. while the body is reconnected; resume() runs them in order
+	void suspend()										{_processor.pause();}
+	void resume()										{_processor.resume();}
+	bool isSuspended()									{return _processor.isPaused();}
 
-		if( command == "shutDown")
+	// Commands waiting in every lane, with those parked for retry
+	int getPendingCount()
+	{
+		int pending = _processor.getRetryDepth();
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
 		{
-			StoreAsync(new NotifyCommand(_model, "shutDown"));
+			pending += _processor.getQueueDepth((CommandPriority)lane);
 		}
+		return pending;
+	}
 
-		if( command == "closing")
+	// An empty handler removes it
+	void setShutdownHandler(const std::function<void()>& handler)
+	{
+		std::shared_ptr<std::function<void()> > next;
+		if(handler)
 		{
-			_processor.setCloseCommand(new CloseSessionCommand(_model));
-			_processor.stop();
-			_processor.join();		
+			next = std::make_shared<std::function<void()> >(handler);
 		}
+		std::atomic_store(&_shutdownHandler, next);
+	}
 
-/////////////////////////////
-//		EVF Control
-/////////////////////////////
+	// Takes over the reference to the directory item
+	CommandHandleRef download(EdsBaseRef directoryItem)
+	{
+		_model->noteTransferRequest();
+		return StoreAsync(new DownloadCommand(_model, directoryItem));
+	}
 
-		if ( command == "startEVF" )
+	// Declines a requested transfer at once, also taking over the reference.
+	// With kEdsSaveTo_Both the file stays on the card.
+	void leaveOnCard(EdsBaseRef directoryItem)
+	{
+		_model->noteTransferRequest();
 		{
-			StoreAsync(new StartEvfCommand(_model));
+			TraceScope trace("EDSDK", "EdsDownloadCancel");
+			EdsError err = EdsDownloadCancel(directoryItem);
+			trace.setArg("error", err);
 		}
+		EdsRelease(directoryItem);
+	}
 
-		if ( command == "endEVF" )
-		{
-			StoreAsync(new EndEvfCommand(_model));
-		}	
-		
-		if ( command == "downloadEVF" )
-		{
-			StoreAsync(new DownloadEvfCommand(_model));
-		}
+	// The embedded thumbnail only, also taking over the reference; handler
+	// runs on the transfer thread. Pixels are decoded with decode, fitted
+	// to maxSize on the long side unless it is 0.
+	CommandHandleRef thumbnail(EdsBaseRef directoryItem, const ThumbnailHandler& handler, bool decode = false, EdsUInt32 maxSize = 0)
+	{
+		return StoreAsync(new ThumbnailCommand(_model, directoryItem, decode, maxSize, handler));
+	}
+
+	// (Re)builds the model's storage index; object events keep it current after
+	CommandHandleRef scanStorage()
+	{
+		_model->getStorageIndex()->setActive(true);
+		return StoreAsync(new ScanStorageCommand(_model));
+	}
+
+	// Takes over the reference from the object event
+	CommandHandleRef updateStorage(EdsUInt32 event, EdsBaseRef ref)	{return StoreAsync(new UpdateStorageCommand(_model, event, ref));}
 
-		if ( command == "focus_Near3" || command == "focus_Near2" || command == "focus_Near1" ||
-			 command == "focus_Far3"  || command == "focus_Far2"  || command == "focus_Far1")
+	// Ends the transfers, then the session, and stops the processor;
+	// blocks until they are done
+	void close()
+	{
+		// No more reads on access once the processor stops
+		_model->setStartupMode(_model->getStartupMode(), PropertyDemandHandler());
+
+		// Transfers end before the session does
+		if(_transferProcessor == &_ownTransferProcessor)
 		{
-			EdsUInt32 driveLens; 
-			if ( command == "focus_Near3") driveLens = kEdsEvfDriveLens_Near3;
-			if ( command == "focus_Near2") driveLens = kEdsEvfDriveLens_Near2;
-			if ( command == "focus_Near1") driveLens = kEdsEvfDriveLens_Near1;
-			if ( command == "focus_Far3") driveLens = kEdsEvfDriveLens_Far3;
-			if ( command == "focus_Far2") driveLens = kEdsEvfDriveLens_Far2;
-			if ( command == "focus_Far1") driveLens = kEdsEvfDriveLens_Far1;
-			StoreAsync(new DriveLensCommand(_model, driveLens));			
+			_transferProcessor->stop();
+			_transferProcessor->join();
 		}
-	
-		if ( command == "focus_Up" || command == "focus_Down")
+		else
 		{
-			const int stepY = 128;
-
-			EdsPoint point = _model->getEvfZoomPosition();
-			if ( command == "focus_Up")
-			{
-				point.y -= stepY;
-				if(point.y < 0) point.y = 0;
-			}
-			if ( command == "focus_Down") point.y += stepY;
-			StoreAsync(new SetPropertyCommand<EdsPoint>(_model, kEdsPropID_Evf_ZoomPosition, point));			
+			_transferProcessor->purge(_model);
 		}
-		
+		_processor.setCloseCommand(new CloseSessionCommand(_model));
+		_processor.stop();
+		_processor.join();		
+	}
 
-		if ( command == "focus_Left" || command == "focus_Right")
-		{
-			const int stepX = 128;
+	// EVF control
+	CommandHandleRef startEvf()									{return StoreAsync(new StartEvfCommand(_model));}
+	CommandHandleRef endEvf()									{return StoreAsync(new EndEvfCommand(_model));}
+	CommandHandleRef downloadEvf()								{return StoreAsync(new DownloadEvfCommand(_model));}
+	CommandHandleRef driveLens(EdsUInt32 driveLens)				{return StoreAsync(new DriveLensCommand(_model, driveLens));}
+	CommandHandleRef setEvfZoom(EdsUInt32 zoom)					{return setTypedProperty<kEdsPropID_Evf_Zoom>(zoom);}
+	CommandHandleRef setEvfZoomPosition(const EdsPoint& point)	{return setTypedProperty<kEdsPropID_Evf_ZoomPosition>(point);}
+	CommandHandleRef doEvfAF(EdsUInt32 status)					{return StoreAsync(new DoEvfAFCommand(_model, status));}
+
+	// Move the zoom area from where it is now, clamped at the top left
+	CommandHandleRef moveEvfZoomPosition(EdsInt32 dx, EdsInt32 dy)
+	{
+		EdsPoint point = _model->getEvfZoomPosition();
+		point.x += dx;
+		point.y += dy;
+		if(point.x < 0) point.x = 0;
+		if(point.y < 0) point.y = 0;
+		return setEvfZoomPosition(point);
+	}
 
-			EdsPoint point = _model->getEvfZoomPosition();
-			if(command == "focus_Left")
-			{
-				point.x -= stepX;
-				if(point.x < 0) point.x = 0;
-			}
-			if(command == "focus_Right")point.x += stepX;
-			StoreAsync(new SetPropertyCommand<EdsPoint>(_model, kEdsPropID_Evf_ZoomPosition, point));			
-		}
+private:
+	enum Action
+	{
+		kAction_Unknown = 0,
+		kAction_OpenSession,
+		kAction_SetAEMode,
+		kAction_SetAv,
+		kAction_SetTv,
+		kAction_SetISOSpeed,
+		kAction_SetMeteringMode,
+		kAction_SetExposureCompensation,
+		kAction_SetImageQuality,
+		kAction_SetEvfAFMode,
+		kAction_PressingHalfway,
+		kAction_PressingCompletely,
+		kAction_PressingOff,
+		kAction_TakePicture,
+		kAction_SetCapacity,
+		kAction_GetProperty,
+		kAction_GetProperties,
+		kAction_GetPropertyDesc,
+		kAction_Download,
+		kAction_ShutDown,
+		kAction_Closing,
+		kAction_StartEvf,
+		kAction_EndEvf,
+		kAction_DownloadEvf,
+		kAction_FocusNear3,
+		kAction_FocusNear2,
+		kAction_FocusNear1,
+		kAction_FocusFar3,
+		kAction_FocusFar2,
+		kAction_FocusFar1,
+		kAction_FocusUp,
+		kAction_FocusDown,
+		kAction_FocusLeft,
+		kAction_FocusRight,
+		kAction_ZoomFit,
+		kAction_ZoomZoom,
+		kAction_EvfAFOn,
+		kAction_EvfAFOff
+	};
+
+	static Action actionOf(const std::string& command)
+	{
+		static const std::unordered_map<std::string, Action> actions = {
+			{ "opensession",				kAction_OpenSession },
+			{ "set_AEMode",					kAction_SetAEMode },
+			{ "set_Av",						kAction_SetAv },
+			{ "set_Tv",						kAction_SetTv },
+			{ "set_ISOSpeed",				kAction_SetISOSpeed },
+			{ "set_MeteringMode",			kAction_SetMeteringMode },
+			{ "set_ExposureCompensation",	kAction_SetExposureCompensation },
+			{ "set_ImageQuality",			kAction_SetImageQuality },
+			{ "set_EvfAFMode",				kAction_SetEvfAFMode },
+			{ "pressingHalfway",			kAction_PressingHalfway },
+			{ "pressingCompletely",			kAction_PressingCompletely },
+			{ "pressingOff",				kAction_PressingOff },
+			{ "TakePicture",				kAction_TakePicture },
+			{ "set_Capacity",				kAction_SetCapacity },
+			{ "get_Property",				kAction_GetProperty },
+			{ "get_Properties",				kAction_GetProperties },
+			{ "get_PropertyDesc",			kAction_GetPropertyDesc },
+			{ "download",					kAction_Download },
+			{ "shutDown",					kAction_ShutDown },
+			{ "closing",					kAction_Closing },
+			{ "startEVF",					kAction_StartEvf },
+			{ "endEVF",						kAction_EndEvf },
+			{ "downloadEVF",				kAction_DownloadEvf },
+			{ "focus_Near3",				kAction_FocusNear3 },
+			{ "focus_Near2",				kAction_FocusNear2 },
+			{ "focus_Near1",				kAction_FocusNear1 },
+			{ "focus_Far3",					kAction_FocusFar3 },
+			{ "focus_Far2",					kAction_FocusFar2 },
+			{ "focus_Far1",					kAction_FocusFar1 },
+			{ "focus_Up",					kAction_FocusUp },
+			{ "focus_Down",					kAction_FocusDown },
+			{ "focus_Left",					kAction_FocusLeft },
+			{ "focus_Right",				kAction_FocusRight },
+			{ "zoom_Fit",					kAction_ZoomFit },
+			{ "zoom_Zoom",					kAction_ZoomZoom },
+			{ "evfAFOn",					kAction_EvfAFOn },
+			{ "evfAFOff",					kAction_EvfAFOff },
+		};
+
+		std::unordered_map<std::string, Action>::const_iterator it = actions.find(command);
+		return (it != actions.end()) ? it->second : kAction_Unknown;
+	}
 
-		if ( command == "zoom_Fit")
-		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_Evf_Zoom, kEdsEvfZoom_Fit));		
-		}
+	static EdsUInt32 argOf(const ActionEvent& event)
+	{
+		return *static_cast<EdsUInt32*>(event.getArg());
+	}
 
-		if( command == "zoom_Zoom")
-		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_Evf_Zoom, kEdsEvfZoom_x5));		
-		}
+public:
 
-		if (command == "set_EvfAFMode")
-		{
-			StoreAsync(new SetPropertyCommand<EdsUInt32>(_model, kEdsPropID_Evf_AFMode, *static_cast<EdsUInt32*>(event.getArg())));			
-		}
-		if (command == "evfAFOn")
-		{
-			StoreAsync(new DoEvfAFCommand(_model, kEdsCameraCommand_EvfAf_ON));
-		}
-		if (command == "evfAFOff")
+	// Legacy adapter for the string commands of the dialog's controls.
+	// One hash lookup, then the same typed call as above.
+	void actionPerformed(const ActionEvent& event)
+	{
+		const int stepX = 128;
+		const int stepY = 128;
+
+		switch(actionOf(event.getActionCommand()))
 		{
-			StoreAsync(new DoEvfAFCommand(_model, kEdsCameraCommand_EvfAf_OFF));			
+		case kAction_OpenSession:				openSession(); break;
+		case kAction_SetAEMode:					setProperty(kEdsPropID_AEModeSelect, argOf(event)); break;
+		case kAction_SetAv:						setProperty(kEdsPropID_Av, argOf(event)); break;
+		case kAction_SetTv:						setProperty(kEdsPropID_Tv, argOf(event)); break;
+		case kAction_SetISOSpeed:				setProperty(kEdsPropID_ISOSpeed, argOf(event)); break;
+		case kAction_SetMeteringMode:			setProperty(kEdsPropID_MeteringMode, argOf(event)); break;
+		case kAction_SetExposureCompensation:	setProperty(kEdsPropID_ExposureCompensation, argOf(event)); break;
+		case kAction_SetImageQuality:			setProperty(kEdsPropID_ImageQuality, argOf(event)); break;
+		case kAction_SetEvfAFMode:				setProperty(kEdsPropID_Evf_AFMode, argOf(event)); break;
+
+		case kAction_PressingHalfway:			pressShutterButton(kEdsCameraCommand_ShutterButton_Halfway); break;
+		case kAction_PressingCompletely:		pressShutterButton(kEdsCameraCommand_ShutterButton_Completely); break;
+		case kAction_PressingOff:				pressShutterButton(kEdsCameraCommand_ShutterButton_OFF); break;
+		case kAction_TakePicture:				takePicture(); break;
+
+		//EdsCapacity capacity = {0x7FFFFFFF, 0x1000, 1};
+		case kAction_SetCapacity:				setCapacity(*static_cast<EdsCapacity*>(event.getArg())); break;
+
+		case kAction_GetProperty:				getProperty(argOf(event)); break;
+		case kAction_GetProperties:				getProperties(*static_cast<PropertyIDList*>(event.getArg())); break;
+		case kAction_GetPropertyDesc:			getPropertyDesc(argOf(event)); break;
+		case kAction_Download:					download(static_cast<EdsBaseRef>(event.getArg())); break;
+		case kAction_ShutDown:					notifyShutDown(); break;
+		case kAction_Closing:					close(); break;
+
+		case kAction_StartEvf:					startEvf(); break;
+		case kAction_EndEvf:					endEvf(); break;
+		case kAction_DownloadEvf:				downloadEvf(); break;
+
+		case kAction_FocusNear3:				driveLens(kEdsEvfDriveLens_Near3); break;
+		case kAction_FocusNear2:				driveLens(kEdsEvfDriveLens_Near2); break;
+		case kAction_FocusNear1:				driveLens(kEdsEvfDriveLens_Near1); break;
+		case kAction_FocusFar3:					driveLens(kEdsEvfDriveLens_Far3); break;
+		case kAction_FocusFar2:					driveLens(kEdsEvfDriveLens_Far2); break;
+		case kAction_FocusFar1:					driveLens(kEdsEvfDriveLens_Far1); break;
+
+		case kAction_FocusUp:					moveEvfZoomPosition(0, -stepY); break;
+		case kAction_FocusDown:					moveEvfZoomPosition(0, stepY); break;
+		case kAction_FocusLeft:					moveEvfZoomPosition(-stepX, 0); break;
+		case kAction_FocusRight:				moveEvfZoomPosition(stepX, 0); break;
+
+		case kAction_ZoomFit:					setEvfZoom(kEdsEvfZoom_Fit); break;
+		case kAction_ZoomZoom:					setEvfZoom(kEdsEvfZoom_x5); break;
+
+		case kAction_EvfAFOn:					doEvfAF(kEdsCameraCommand_EvfAf_ON); break;
+		case kAction_EvfAFOff:					doEvfAF(kEdsCameraCommand_EvfAf_OFF); break;
+
+		default:
+			break;
 		}
-
 	}
 
 
 protected:
 	//The command is received
-	void StoreAsync( Command *command )
+	CommandHandleRef StoreAsync( Command *command )
 	{
 		if ( command != NULL )
 		{
-			_processor.enqueue( command );
+			if ( command->isTransfer() )
+			{
+				return _transferProcessor->enqueue( command );
+			}
+			else
+			{
+				return _processor.enqueue( command );
+			}
 		}
+		return CommandHandleRef();
 	}
 
 
@@ -16,19 +16,118 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
 #include "EDSDK.h"
 
+// Argument of the "PropertiesChanged" event
+typedef std::vector<EdsPropertyID> PropertyIDList;
+
+struct _EVF_DATASET;
+struct _STORAGE_CHANGE;
+
+
+// Typed event identifiers. Each has the name string observers compare
+// against, so both kinds of observer see the same events.
+enum CameraEventID
+{
+	// Named only by its string, e.g. from NotifyCommand
+	kCameraEvent_Custom = 0,
+	kCameraEvent_PropertyChanged,
+	kCameraEvent_PropertiesChanged,
+	kCameraEvent_PropertyDescChanged,
+	kCameraEvent_EvfDataChanged,
+	kCameraEvent_DownloadStart,
+	kCameraEvent_DownloadComplete,
+	kCameraEvent_ProgressReport,
+	kCameraEvent_DeviceBusy,
+	kCameraEvent_Error,
+	kCameraEvent_ShutDown,
+	// The storage index was scanned or updated from an object event
+	kCameraEvent_StorageChanged,
+
+	kCameraEvent_Count
+};
+
+// Subscription mask bits for Observable::addEventObserver
+inline EdsUInt32 cameraEventMask(CameraEventID id) { return 1u << id; }
+const EdsUInt32 kCameraEventMask_All = 0xffffffff;
+
+
+// Type getArg() points to for each event
+template<CameraEventID ID> struct CameraEventPayload	{ typedef void Type; };
+template<> struct CameraEventPayload<kCameraEvent_PropertyChanged>		{ typedef EdsUInt32 Type; };
+template<> struct CameraEventPayload<kCameraEvent_PropertiesChanged>	{ typedef PropertyIDList Type; };
+template<> struct CameraEventPayload<kCameraEvent_PropertyDescChanged>	{ typedef EdsUInt32 Type; };
+template<> struct CameraEventPayload<kCameraEvent_EvfDataChanged>		{ typedef _EVF_DATASET Type; };
+template<> struct CameraEventPayload<kCameraEvent_DownloadComplete>		{ typedef EdsError Type; };
+template<> struct CameraEventPayload<kCameraEvent_ProgressReport>		{ typedef EdsUInt32 Type; };
+template<> struct CameraEventPayload<kCameraEvent_Error>				{ typedef EdsError Type; };
+template<> struct CameraEventPayload<kCameraEvent_StorageChanged>		{ typedef _STORAGE_CHANGE Type; };
+
 
 class CameraEvent
 {
-	std::string _event;	
+	CameraEventID _id;
 	void* _arg;
+	// Only set for kCameraEvent_Custom
+	std::string _name;
+
 public:
-	const std::string getEvent() const{ return _event; }
-	void* getArg() const{ return _arg; }
+	// Built without allocating. getEvent() gives the matching name.
+	CameraEvent(CameraEventID id, void* arg=0) :
+	 _id(id), _arg(arg) {}
 
+	// String form, mapped to the typed id when the name is known.
 	CameraEvent(std::string event,void* arg=0) : 
-	 _event(event), _arg(arg) {}
+	 _id(idOf(event)), _arg(arg)
+	{
+		if(_id == kCameraEvent_Custom)
+		{
+			_name = event;
+		}
+	}
 
-};
+	const std::string& getEvent() const{ return (_id == kCameraEvent_Custom) ? _name : nameOf(_id); }
+	CameraEventID getID() const{ return _id; }
+	void* getArg() const{ return _arg; }
+
+	// Typed argument, NULL if this is a different event.
+	template<CameraEventID ID>
+	typename CameraEventPayload<ID>::Type* getPayload() const
+	{
+		return (_id == ID) ? static_cast<typename CameraEventPayload<ID>::Type*>(_arg) : NULL;
+	}
 
+	static const std::string& nameOf(CameraEventID id)
+	{
+		static const std::string names[kCameraEvent_Count] =
+		{
+			"",
+			"PropertyChanged",
+			"PropertiesChanged",
+			"PropertyDescChanged",
+			"EvfDataChanged",
+			"DownloadStart",
+			"DownloadComplete",
+			"ProgressReport",
+			"DeviceBusy",
+			"error",
+			"shutDown",
+			"StorageChanged",
+		};
+		return names[(id < kCameraEvent_Count) ? id : kCameraEvent_Custom];
+	}
+
+	static CameraEventID idOf(const std::string& event)
+	{
+		for(int id = kCameraEvent_Custom + 1; id < kCameraEvent_Count; id++)
+		{
+			if(event == nameOf((CameraEventID)id))
+			{
+				return (CameraEventID)id;
+			}
+		}
+		return kCameraEvent_Custom;
+	}
+};
@@ -18,6 +18,7 @@
 
 #include "EDSDK.h"
 #include "CameraController.h"
+#include "Trace.h"
 
 
 class CameraEventListener
@@ -31,11 +32,41 @@ public:
 	{
 
 		CameraController*	controller = (CameraController *)inContext;
+		TraceScope trace("Callback", "ObjectEvent");
+		trace.setArg("event", inEvent);
 
 		switch(inEvent)
 		{
 		case kEdsObjectEvent_DirItemRequestTransfer:
-				fireEvent(controller, "download", inRef);
+				// Files the rules leave on the card never cross the link
+				if(controller->getCameraModel()->getTransferRules()->decide(inRef, controller->getCameraModel()->getSaveTo()) == kTransferAction_LeaveOnCard)
+				{
+					controller->leaveOnCard(inRef);
+				}
+				else
+				{
+					controller->download(inRef);
+				}
+				break;
+
+		case kEdsObjectEvent_DirItemCreated:
+		case kEdsObjectEvent_DirItemRemoved:
+		case kEdsObjectEvent_DirItemInfoChanged:
+		case kEdsObjectEvent_DirItemContentChanged:
+		case kEdsObjectEvent_FolderUpdateItems:
+		case kEdsObjectEvent_VolumeInfoChanged:
+		case kEdsObjectEvent_VolumeUpdateItems:
+		case kEdsObjectEvent_VolumeAdded:
+		case kEdsObjectEvent_VolumeRemoved:
+				// Only worth the SDK calls once the cards have been indexed
+				if(controller->getCameraModel()->getStorageIndex()->isActive())
+				{
+					controller->updateStorage(inEvent, inRef);
+				}
+				else if(inRef != NULL)
+				{
+					EdsRelease(inRef);
+				}
 				break;
 		
 		default:
@@ -53,21 +84,23 @@ public:
 	static EdsError EDSCALLBACK  handlePropertyEvent (
 						EdsUInt32			inEvent,
 						EdsUInt32			inPropertyID,
-						EdsUInt32			inParam, 
+						EdsUInt32			/*inParam*/, 
 						EdsVoid *			inContext				
 						)
 	{
 
 		CameraController*	controller = (CameraController *)inContext;
+		TraceScope trace("Callback", "PropertyEvent");
+		trace.setArg("event", inEvent);
 
 		switch(inEvent)
 		{
 		case kEdsPropertyEvent_PropertyChanged:
-				fireEvent(controller, "get_Property", &inPropertyID);
+				controller->propertyChanged(inPropertyID);
 				break;
 
 		case kEdsPropertyEvent_PropertyDescChanged:
-				fireEvent(controller, "get_PropertyDesc", &inPropertyID);
+				controller->propertyDescChanged(inPropertyID);
 				break;
 		}
 
@@ -76,28 +109,23 @@ public:
 
 	static EdsError EDSCALLBACK  handleStateEvent (
 						EdsUInt32			inEvent,
-						EdsUInt32			inParam, 
+						EdsUInt32			/*inParam*/, 
 						EdsVoid *			inContext				
 						)
 	{
 
 		CameraController*	controller = (CameraController *)inContext;
+		TraceScope trace("Callback", "StateEvent");
+		trace.setArg("event", inEvent);
 
 		switch(inEvent)
 		{
 		case kEdsStateEvent_Shutdown:
-				fireEvent(controller, "shutDown");
+				controller->handleShutDown();
 				break;
 		}
 
 		return EDS_ERR_OK;		
 	}	
 
-private:
-	static void fireEvent(ActionListener *listener, std::string command, void* arg = 0)
-	{
-		ActionEvent event(command, arg);
-		listener->actionPerformed(event);
-	}
-
 };
@@ -0,0 +1,541 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : CameraManager.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraModel.h"
+#include "CameraModelLegacy.h"
+#include "CameraController.h"
+#include "CameraEventListener.h"
+#include "Synchronized.h"
+
+
+class CameraSession;
+typedef std::shared_ptr<CameraSession> CameraSessionRef;
+
+// A session's body shut down or was unplugged; runs on the SDK thread
+typedef std::function<void(const CameraSessionRef&)> SessionShutdownHandler;
+
+
+// One attached body: its model, controller and command processor. SDK
+// callbacks carry the controller as context, so each camera's events go
+// straight to its own processor.
+class CameraSession
+{
+private:
+	EdsCameraRef		_camera;
+	EdsDeviceInfo		_deviceInfo;
+	CameraModel*		_model;
+	CameraController*	_controller;
+	bool				_open;
+	EdsUInt32			_slot;
+	// References replaced by reattach()
+	std::vector<EdsCameraRef>	_retired;
+
+	CameraSession(const CameraSession&);
+	CameraSession& operator=(const CameraSession&);
+
+public:
+	// Takes over a reference to camera.
+	CameraSession(EdsCameraRef camera, const EdsDeviceInfo& deviceInfo)
+		: _camera(camera), _deviceInfo(deviceInfo), _open(false), _slot(0)
+	{
+		// Legacy protocol when there is no PTP sub type
+		if(deviceInfo.deviceSubType == 0)
+		{
+			_model = new CameraModelLegacy(camera);
+		}
+		else
+		{
+			_model = new CameraModel(camera);
+		}
+
+		_controller = new CameraController();
+		_controller->setCameraModel(_model);
+	}
+
+	virtual ~CameraSession()
+	{
+		close();
+
+		delete _controller;
+		delete _model;
+
+		if(_camera != NULL)
+		{
+			EdsRelease(_camera);
+			_camera = NULL;
+		}
+		for(size_t i = 0; i < _retired.size(); i++)
+		{
+			EdsRelease(_retired[i]);
+		}
+	}
+
+	// Install the event handlers and start the processor. The session itself
+	// is opened by the processor thread, so this does not block.
+	EdsError open()
+	{
+		if(_open)
+		{
+			return EDS_ERR_OK;
+		}
+
+		EdsError err = EdsSetPropertyEventHandler(_camera, kEdsPropertyEvent_All, CameraEventListener::handlePropertyEvent, (EdsVoid *)_controller);
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsSetObjectEventHandler(_camera, kEdsObjectEvent_All, CameraEventListener::handleObjectEvent, (EdsVoid *)_controller);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsSetCameraStateEventHandler(_camera, kEdsStateEvent_All, CameraEventListener::handleStateEvent, (EdsVoid *)_controller);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			_controller->run();
+			_open = true;
+		}
+		return err;
+	}
+
+	// Close the session and stop the processor; blocks until both are done.
+	void close()
+	{
+		if(!_open)
+		{
+			return;
+		}
+		_open = false;
+
+		_controller->close();
+
+		EdsSetPropertyEventHandler(_camera, kEdsPropertyEvent_All, NULL, NULL);
+		EdsSetObjectEventHandler(_camera, kEdsObjectEvent_All, NULL, NULL);
+		EdsSetCameraStateEventHandler(_camera, kEdsStateEvent_All, NULL, NULL);
+	}
+
+	bool isOpen() const								{ return _open; }
+
+	// The same body came back under a new reference, e.g. after a USB
+	// reset: the handlers move over. The old reference is released with the
+	// session, as live view or a lens drive may still be in a call on it.
+	// The controller and model stay, with their queue and cached state;
+	// the caller opens the SDK session again. Takes over a reference to camera.
+	EdsError reattach(EdsCameraRef camera, const EdsDeviceInfo& deviceInfo)
+	{
+		EdsCameraRef previous = _camera;
+		if(previous != NULL)
+		{
+			EdsSetPropertyEventHandler(previous, kEdsPropertyEvent_All, NULL, NULL);
+			EdsSetObjectEventHandler(previous, kEdsObjectEvent_All, NULL, NULL);
+			EdsSetCameraStateEventHandler(previous, kEdsStateEvent_All, NULL, NULL);
+		}
+
+		_camera = camera;
+		_deviceInfo = deviceInfo;
+		_model->setCameraObject(camera);
+		if(previous != NULL)
+		{
+			_retired.push_back(previous);
+		}
+
+		if(!_open)
+		{
+			return EDS_ERR_OK;
+		}
+
+		EdsError err = EdsSetPropertyEventHandler(_camera, kEdsPropertyEvent_All, CameraEventListener::handlePropertyEvent, (EdsVoid *)_controller);
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsSetObjectEventHandler(_camera, kEdsObjectEvent_All, CameraEventListener::handleObjectEvent, (EdsVoid *)_controller);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsSetCameraStateEventHandler(_camera, kEdsStateEvent_All, CameraEventListener::handleStateEvent, (EdsVoid *)_controller);
+		}
+		return err;
+	}
+
+	EdsCameraRef getCameraObject() const			{ return _camera; }
+	const EdsDeviceInfo& getDeviceInfo() const		{ return _deviceInfo; }
+	const EdsChar* getPortName() const				{ return _deviceInfo.szPortName; }
+	const EdsChar* getDescription() const			{ return _deviceInfo.szDeviceDescription; }
+
+	CameraModel* getCameraModel()					{ return _model; }
+	CameraController* getCameraController()			{ return _controller; }
+
+	// Given by the manager, see PlacementPolicy
+	void setSlot(EdsUInt32 slot)					{ _slot = slot; }
+	EdsUInt32 getSlot() const						{ return _slot; }
+};
+
+
+
+// Enumerates every attached camera and runs a CameraSession for each.
+// Sessions share nothing but the SDK: each has its own processor and
+// transfer worker, so 8-24 bodies run on as many cores as they need.
+//
+// Without a message loop (e.g. from Python), SDK events are only delivered
+// while getEvent() is called on the thread that called initialize().
+class CameraManager
+{
+private:
+	std::vector<CameraSessionRef>	_sessions;
+	bool							_sdkLoaded;
+	StartupMode						_startupMode;
+	SessionShutdownHandler			_shutdownHandler;
+	PlacementPolicy					_placementPolicy;
+	Synchronized					_syncObject;
+
+	// Called with _syncObject held. Lowest slot no session holds; a
+	// session still opening is not in _sessions, so connectAll() takes
+	// them one after the other.
+	EdsUInt32 freeSlot() const
+	{
+		for(EdsUInt32 slot = 0; ; slot++)
+		{
+			bool taken = false;
+			for(size_t i = 0; i < _sessions.size() && !taken; i++)
+			{
+				taken = (_sessions[i]->getSlot() == slot);
+			}
+			if(!taken)
+			{
+				return slot;
+			}
+		}
+	}
+
+	// Called with _syncObject held
+	void installShutdownHandler(const CameraSessionRef& session)
+	{
+		std::function<void()> shutdown;
+		if(_shutdownHandler)
+		{
+			SessionShutdownHandler handler = _shutdownHandler;
+			std::weak_ptr<CameraSession> weak = session;
+			shutdown = [handler, weak]() {
+				CameraSessionRef session = weak.lock();
+				if(session)
+				{
+					handler(session);
+				}
+			};
+		}
+		session->getCameraController()->setShutdownHandler(shutdown);
+	}
+
+public:
+	CameraManager() : _sdkLoaded(false), _startupMode(kStartupMode_Eager) {}
+
+	virtual ~CameraManager()
+	{
+		terminate();
+	}
+
+	EdsError initialize()
+	{
+		if(_sdkLoaded)
+		{
+			return EDS_ERR_OK;
+		}
+
+		EdsError err = EdsInitializeSDK();
+		_sdkLoaded = (err == EDS_ERR_OK);
+		return err;
+	}
+
+	// Close every session, then unload the SDK.
+	void terminate()
+	{
+		disconnectAll();
+
+		if(_sdkLoaded)
+		{
+			EdsTerminateSDK();
+			_sdkLoaded = false;
+		}
+	}
+
+	bool isInitialized() const { return _sdkLoaded; }
+
+	// How sessions opened from now on read the properties, see StartupMode
+	void setStartupMode(StartupMode mode) { _startupMode = mode; }
+	StartupMode getStartupMode() const { return _startupMode; }
+
+	// Cores and names of the threads of sessions opened from now on, by
+	// slot; see ThreadPlacement for stock policies. Without one, threads
+	// are only named, "cam<slot>-cmd" and so on.
+	void setPlacementPolicy(const PlacementPolicy& policy)
+	{
+		_syncObject.lock();
+		_placementPolicy = policy;
+		_syncObject.unlock();
+	}
+
+	// For every session, open or opened later. The session stays in the
+	// manager until disconnected.
+	void setShutdownHandler(const SessionShutdownHandler& handler)
+	{
+		_syncObject.lock();
+		_shutdownHandler = handler;
+		for(size_t i = 0; i < _sessions.size(); i++)
+		{
+			installShutdownHandler(_sessions[i]);
+		}
+		_syncObject.unlock();
+	}
+
+	// Device info of every camera attached right now.
+	EdsError enumerate(std::vector<EdsDeviceInfo>& devices)
+	{
+		devices.clear();
+
+		EdsCameraListRef cameraList = NULL;
+		EdsUInt32 count = 0;
+
+		EdsError err = EdsGetCameraList(&cameraList);
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsGetChildCount(cameraList, &count);
+		}
+
+		for(EdsUInt32 i = 0; err == EDS_ERR_OK && i < count; i++)
+		{
+			EdsCameraRef camera = NULL;
+			EdsDeviceInfo deviceInfo;
+
+			err = EdsGetChildAtIndex(cameraList, i, &camera);
+			if(err == EDS_ERR_OK)
+			{
+				err = EdsGetDeviceInfo(camera, &deviceInfo);
+			}
+			if(err == EDS_ERR_OK)
+			{
+				devices.push_back(deviceInfo);
+			}
+
+			if(camera != NULL)
+			{
+				EdsRelease(camera);
+			}
+		}
+
+		if(cameraList != NULL)
+		{
+			EdsRelease(cameraList);
+		}
+		return err;
+	}
+
+	// Open a session on every attached camera that does not have one yet.
+	// Sessions open in parallel on their own processor threads; a camera
+	// that fails does not stop the others, its error is returned.
+	EdsError connectAll()
+	{
+		EdsCameraListRef cameraList = NULL;
+		EdsUInt32 count = 0;
+
+		EdsError err = EdsGetCameraList(&cameraList);
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsGetChildCount(cameraList, &count);
+			if(err == EDS_ERR_OK && count == 0)
+			{
+				err = EDS_ERR_DEVICE_NOT_FOUND;
+			}
+		}
+
+		EdsError result = err;
+		for(EdsUInt32 i = 0; err == EDS_ERR_OK && i < count; i++)
+		{
+			EdsCameraRef camera = NULL;
+			EdsDeviceInfo deviceInfo;
+
+			EdsError cameraErr = EdsGetChildAtIndex(cameraList, i, &camera);
+			if(cameraErr == EDS_ERR_OK)
+			{
+				cameraErr = EdsGetDeviceInfo(camera, &deviceInfo);
+			}
+
+			if(cameraErr == EDS_ERR_OK && !findByPort(deviceInfo.szPortName))
+			{
+				CameraSessionRef session = std::make_shared<CameraSession>(camera, deviceInfo);
+				camera = NULL;
+
+				session->getCameraController()->setStartupMode(_startupMode);
+				_syncObject.lock();
+				PlacementPolicy policy = _placementPolicy;
+				EdsUInt32 slot = freeSlot();
+				session->setSlot(slot);
+				_syncObject.unlock();
+				session->getCameraController()->setPlacement(policy ? policy(slot, deviceInfo) : ThreadPlacement::makeCameraPlacement(slot));
+				_syncObject.lock();
+				installShutdownHandler(session);
+				_syncObject.unlock();
+				cameraErr = session->open();
+				if(cameraErr == EDS_ERR_OK)
+				{
+					_syncObject.lock();
+					// Again, in case the handler changed meanwhile
+					installShutdownHandler(session);
+					_sessions.push_back(session);
+					_syncObject.unlock();
+				}
+			}
+
+			if(camera != NULL)
+			{
+				EdsRelease(camera);
+			}
+
+			if(result == EDS_ERR_OK)
+			{
+				result = cameraErr;
+			}
+		}
+
+		if(cameraList != NULL)
+		{
+			EdsRelease(cameraList);
+		}
+		return result;
+	}
+
+	// Close every session at once; each blocks on its own camera.
+	void disconnectAll()
+	{
+		std::vector<CameraSessionRef> sessions;
+
+		_syncObject.lock();
+		sessions.swap(_sessions);
+		_syncObject.unlock();
+
+		std::vector<std::thread> closers;
+		for(size_t i = 0; i < sessions.size(); i++)
+		{
+			CameraSessionRef session = sessions[i];
+			closers.push_back(std::thread([session]()
+			{
+				// The SDK needs COM on each thread that calls it in Windows
+#ifdef _WIN32
+				CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+				session->close();
+#ifdef _WIN32
+				CoUninitialize();
+#endif
+			}));
+		}
+		for(size_t i = 0; i < closers.size(); i++)
+		{
+			closers[i].join();
+		}
+	}
+
+	// Close and drop one session.
+	void disconnect(const CameraSessionRef& session)
+	{
+		_syncObject.lock();
+		for(std::vector<CameraSessionRef>::iterator it = _sessions.begin(); it != _sessions.end(); ++it)
+		{
+			if(*it == session)
+			{
+				_sessions.erase(it);
+				break;
+			}
+		}
+		_syncObject.unlock();
+
+		session->close();
+	}
+
+	// Deliver pending SDK events to the sessions' controllers.
+	EdsError getEvent()
+	{
+		return EdsGetEvent();
+	}
+
+	size_t getSessionCount()
+	{
+		_syncObject.lock();
+		size_t count = _sessions.size();
+		_syncObject.unlock();
+		return count;
+	}
+
+	CameraSessionRef getSession(size_t index)
+	{
+		CameraSessionRef session;
+		_syncObject.lock();
+		if(index < _sessions.size())
+		{
+			session = _sessions[index];
+		}
+		_syncObject.unlock();
+		return session;
+	}
+
+	std::vector<CameraSessionRef> getSessions()
+	{
+		_syncObject.lock();
+		std::vector<CameraSessionRef> sessions = _sessions;
+		_syncObject.unlock();
+		return sessions;
+	}
+
+	// The port name stays the same for as long as a body is attached.
+	CameraSessionRef findByPort(const std::string& portName)
+	{
+		CameraSessionRef session;
+		_syncObject.lock();
+		for(size_t i = 0; i < _sessions.size(); i++)
+		{
+			if(portName == _sessions[i]->getPortName())
+			{
+				session = _sessions[i];
+				break;
+			}
+		}
+		_syncObject.unlock();
+		return session;
+	}
+
+	CameraSessionRef findByModel(CameraModel* model)
+	{
+		CameraSessionRef session;
+		_syncObject.lock();
+		for(size_t i = 0; i < _sessions.size(); i++)
+		{
+			if(_sessions[i]->getCameraModel() == model)
+			{
+				session = _sessions[i];
+				break;
+			}
+		}
+		_syncObject.unlock();
+		return session;
+	}
+};
@@ -15,143 +15,438 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+
 #include "EDSDK.h"
 
 #include "Observer.h"
+#include "EvfFrame.h"
+#include "EvfStreamPool.h"
+#include "EvfMetadata.h"
+#include "CapturedImage.h"
+#include "PropertyStore.h"
+#include "PropertyTraits.h"
+#include "Metrics.h"
+#include "StorageIndex.h"
+#include "TransferRules.h"
+#include "ThreadPlacement.h"
+#include "Trace.h"
+
+class DownloadPipeline;
+
+// How a session fills the model once it is open
+enum StartupMode
+{
+	// Every property the camera announces is read as it is announced
+	kStartupMode_Eager = 0,
+	// Only announced properties already held are read; the rest, and
+	// descs, are read on their first access. Live view starts ahead of
+	// the metadata.
+	kStartupMode_Lazy,
+};
+
+// From CameraController::run(), steady clock microseconds; 0 until reached
+typedef struct _STARTUP_TIMING
+{
+	StartupMode		mode;
+	EdsUInt64		startMicros;
+	EdsUInt64		sessionOpenMicros;
+	EdsUInt64		firstFrameMicros;		// first live view frame in the model
+	EdsUInt64		timeToFirstFrameMicros;
+	EdsUInt64		propertiesFetched;		// values and descs read before that frame
+}STARTUP_TIMING;
+
+// Queues the read of a value, or with desc its desc
+typedef std::function<void(EdsPropertyID, bool)> PropertyDemandHandler;
 
 class CameraModel : public Observable
 {
 protected:
-	EdsCameraRef _camera;
+	// Replaced when the body comes back after a USB reset
+	std::atomic<EdsCameraRef> _camera;
 
 	//Count of UIlock
 	int		_lockCount;
+	std::mutex	_lockMutex;
 
 	// Model name
 	EdsChar  _modelName[EDS_MAX_NAME];
 
-	// Taking a picture parameter
-	EdsUInt32 _AEMode;
-	EdsUInt32 _Av;
-	EdsUInt32 _Tv;
-	EdsUInt32 _Iso;
-	EdsUInt32 _MeteringMode;
-	EdsUInt32 _ExposureCompensation;
-	EdsUInt32 _ImageQuality;
-	EdsUInt32 _AvailableShot;
-	EdsUInt32 _evfMode;
-	EdsUInt32 _evfOutputDevice;
-	EdsUInt32 _evfDepthOfFieldPreview;
-	EdsUInt32 _evfZoom;
-	EdsPoint  _evfZoomPosition;
-	EdsRect	  _evfZoomRect;
-	EdsUInt32 _evfAFMode;
+	// Body serial number
+	EdsChar  _serialNumber[EDS_MAX_NAME];
+
+	// Values and descs of every property, read without locks
+	PropertyStore _properties;
+	// Types and sizes, so a read needs no size query
+	PropertyInfoCache _propertyInfo;
 
 	EdsFocusInfo _focusInfo;
 
-	// List of value in which taking a picture parameter can be set
-	EdsPropertyDesc _AEModeDesc;
-	EdsPropertyDesc _AvDesc;
-	EdsPropertyDesc _TvDesc;
-	EdsPropertyDesc _IsoDesc;
-	EdsPropertyDesc _MeteringModeDesc;
-	EdsPropertyDesc _ExposureCompensationDesc;
-	EdsPropertyDesc _ImageQualityDesc;
-	EdsPropertyDesc _evfAFModeDesc;
+	// Last downloaded live view image
+	EvfFrameRef _evfFrame;
+	RateMeter _evfRate;
+
+	// Streams reused across live view downloads
+	EvfStreamPoolRef _evfStreamPool;
+
+	// Which properties are read with each live view image
+	EvfMetadataCache _evfMetadata;
+
+	// Where DownloadCommand puts captured images
+	DownloadTarget _downloadTarget;
+	CaptureBufferPoolRef _captureBufferPool;
+	std::shared_ptr<CaptureQueue> _captureQueue;
+	std::shared_ptr<DownloadPipeline> _downloadPipeline;
+
+	// Files on the cards, kept current from object events once scanned
+	StorageIndexRef _storageIndex;
+
+	// kEdsPropID_SaveTo the session opens with, and the folder whose free
+	// space the camera is told when saving to the host
+	std::atomic<EdsUInt32> _saveTo;
+	std::string _hostCapacityPath;
+	std::mutex _hostCapacityMutex;
+	// Which requested transfers are downloaded
+	TransferRulesRef _transferRules;
+
+	// Cores of this camera's threads, see CameraController::setPlacement()
+	CAMERA_PLACEMENT _placement;
+	std::mutex _placementMutex;
+
+	// DirItemRequestTransfer arrivals, steady clock microseconds
+	std::atomic<EdsUInt64> _transferRequestCount;
+	std::atomic<EdsUInt64> _lastTransferRequestMicros;
+	std::atomic<EdsUInt64> _firstTransferRequestMicros;
+	std::atomic<bool> _transferRequestExpected;
+
+	// Reads on first access, with kStartupMode_Lazy
+	std::atomic<bool> _lazyProperties;
+	std::shared_ptr<PropertyDemandHandler> _demandHandler;
+
+	std::atomic<int> _startupMode;
+	std::atomic<EdsUInt64> _startMicros;
+	std::atomic<EdsUInt64> _sessionOpenMicros;
+	std::atomic<EdsUInt64> _firstFrameMicros;
+	std::atomic<EdsUInt64> _startupFetches;
+
+	// Queue the read of a property the model does not hold current
+	void demand(EdsPropertyID propertyID, bool desc) const
+	{
+		if(_lazyProperties.load(std::memory_order_acquire) &&
+		   const_cast<PropertyStore&>(_properties).claimFetch(propertyID, desc))
+		{
+			std::shared_ptr<PropertyDemandHandler> handler = std::atomic_load(&_demandHandler);
+			if(handler)
+			{
+				(*handler)(propertyID, desc);
+			}
+		}
+	}
+
+	EdsUInt32 demandUInt32(EdsPropertyID propertyID, EdsUInt32 defaultValue) const
+	{
+		demand(propertyID, false);
+		return _properties.getUInt32(propertyID, defaultValue);
+	}
 
 public:
 	// Constructor
-	CameraModel(EdsCameraRef camera):_lockCount(0),_camera(camera){memset(&_focusInfo, 0, sizeof(_focusInfo));} 
+	CameraModel(EdsCameraRef camera):_camera(camera),_lockCount(0)
+	{
+		memset(_modelName, 0, sizeof(_modelName));
+		memset(_serialNumber, 0, sizeof(_serialNumber));
+		memset(&_focusInfo, 0, sizeof(_focusInfo));
+
+
+		_evfStreamPool = std::make_shared<EvfStreamPool>();
+
+		_downloadTarget = kDownloadTarget_File;
+		_captureBufferPool = std::make_shared<CaptureBufferPool>();
+		_captureQueue = std::make_shared<CaptureQueue>();
+		_storageIndex = std::make_shared<StorageIndex>();
+		_saveTo = kEdsSaveTo_Host;
+		_transferRules = std::make_shared<TransferRules>();
+		_placement = ThreadPlacement::makeCameraPlacement(0);
+		_placement.name[0] = '\0';
+
+		_transferRequestCount = 0;
+		_lastTransferRequestMicros = 0;
+		_firstTransferRequestMicros = 0;
+		_transferRequestExpected = false;
+
+		_lazyProperties = false;
+		_startupMode = kStartupMode_Eager;
+		_startMicros = 0;
+		_sessionOpenMicros = 0;
+		_firstFrameMicros = 0;
+		_startupFetches = 0;
+	} 
 
 	//Acquisition of Camera Object
 	EdsCameraRef getCameraObject() const {return _camera;}
+	// The same body under a new reference; the session keeps the old one's release
+	void setCameraObject(EdsCameraRef camera) {_camera = camera;}
 
 
 //Property
 public:
 	// Taking a picture parameter
-	void setAEMode(EdsUInt32 value )				{ _AEMode = value;}
-	void setTv( EdsUInt32 value )					{ _Tv = value;}
-	void setAv( EdsUInt32 value )					{ _Av = value;}
-	void setIso( EdsUInt32 value )					{ _Iso = value; }
-	void setMeteringMode( EdsUInt32 value )			{ _MeteringMode = value; }
-	void setExposureCompensation( EdsUInt32 value)	{ _ExposureCompensation = value; }
-	void setImageQuality( EdsUInt32 value)			{ _ImageQuality = value; }
-	void setEvfMode( EdsUInt32 value)				{ _evfMode = value; }
-	void setEvfOutputDevice( EdsUInt32 value)		{ _evfOutputDevice = value; }
-	void setEvfDepthOfFieldPreview( EdsUInt32 value){ _evfDepthOfFieldPreview = value; }
-	void setEvfZoom( EdsUInt32 value)				{ _evfZoom = value; }
-	void setEvfZoomPosition( EdsPoint value)		{ _evfZoomPosition = value; }
-	void setEvfZoomRect( EdsRect value)				{ _evfZoomRect = value; }
+	void setAEMode(EdsUInt32 value )				{ setPropertyUInt32(kEdsPropID_AEModeSelect, value); }
+	void setTv( EdsUInt32 value )					{ setPropertyUInt32(kEdsPropID_Tv, value); }
+	void setAv( EdsUInt32 value )					{ setPropertyUInt32(kEdsPropID_Av, value); }
+	void setIso( EdsUInt32 value )					{ setPropertyUInt32(kEdsPropID_ISOSpeed, value); }
+	void setMeteringMode( EdsUInt32 value )			{ setPropertyUInt32(kEdsPropID_MeteringMode, value); }
+	void setExposureCompensation( EdsUInt32 value)	{ setPropertyUInt32(kEdsPropID_ExposureCompensation, value); }
+	void setImageQuality( EdsUInt32 value)			{ setPropertyUInt32(kEdsPropID_ImageQuality, value); }
+	void setEvfMode( EdsUInt32 value)				{ setPropertyUInt32(kEdsPropID_Evf_Mode, value); }
+	void setEvfOutputDevice( EdsUInt32 value)		{ setPropertyUInt32(kEdsPropID_Evf_OutputDevice, value); }
+	void setEvfDepthOfFieldPreview( EdsUInt32 value){ setPropertyUInt32(kEdsPropID_Evf_DepthOfFieldPreview, value); }
+	void setEvfZoom( EdsUInt32 value)				{ setPropertyUInt32(kEdsPropID_Evf_Zoom, value); }
+	void setEvfZoomPosition( EdsPoint value)		{ _properties.set(kEdsPropID_Evf_ZoomPosition, kEdsDataType_Point, value); }
+	void setEvfZoomRect( EdsRect value)				{ _properties.set(kEdsPropID_Evf_ZoomRect, kEdsDataType_Rect, value); }
 	void setModelName(EdsChar *modelName)			{ strcpy(_modelName, modelName); }
-	void setEvfAFMode( EdsUInt32 value)				{ _evfAFMode = value; }
+	void setSerialNumber(EdsChar *serialNumber)		{ strncpy(_serialNumber, serialNumber, EDS_MAX_NAME - 1); }
+	void setEvfAFMode( EdsUInt32 value)				{ setPropertyUInt32(kEdsPropID_Evf_AFMode, value); }
 	void setFocusInfo( EdsFocusInfo value)				{ _focusInfo = value; }
 
-	// Taking a picture parameter
-	EdsUInt32 getAEMode() const					{ return _AEMode; }
-	EdsUInt32 getTv() const						{ return _Tv; }
-	EdsUInt32 getAv() const						{ return _Av; }
-	EdsUInt32 getIso() const					{ return _Iso; }
-	EdsUInt32 getMeteringMode() const			{ return _MeteringMode; }
-	EdsUInt32 getExposureCompensation() const	{ return _ExposureCompensation; }
-	EdsUInt32 getImageQuality() const			{ return _ImageQuality; }
-	EdsUInt32 getEvfMode() const				{ return _evfMode; }
-	EdsUInt32 getEvfOutputDevice() const		{ return _evfOutputDevice; }
-	EdsUInt32 getEvfDepthOfFieldPreview() const	{ return _evfDepthOfFieldPreview; }
-	EdsUInt32 getEvfZoom() const				{ return _evfZoom; }	
-	EdsPoint  getEvfZoomPosition() const		{ return _evfZoomPosition; }	
-	EdsRect	  getEvfZoomRect() const			{ return _evfZoomRect; }	
-	EdsUInt32 getEvfAFMode() const				{ return _evfAFMode; }
-	EdsChar *getModelName()						{ return _modelName; }
+	// Taking a picture parameter, 0xffffffff until acquired from the camera
+	EdsUInt32 getAEMode() const					{ return demandUInt32(kEdsPropID_AEModeSelect, 0xffffffff); }
+	EdsUInt32 getTv() const						{ return demandUInt32(kEdsPropID_Tv, 0xffffffff); }
+	EdsUInt32 getAv() const						{ return demandUInt32(kEdsPropID_Av, 0xffffffff); }
+	EdsUInt32 getIso() const					{ return demandUInt32(kEdsPropID_ISOSpeed, 0xffffffff); }
+	EdsUInt32 getMeteringMode() const			{ return demandUInt32(kEdsPropID_MeteringMode, 0xffffffff); }
+	EdsUInt32 getExposureCompensation() const	{ return demandUInt32(kEdsPropID_ExposureCompensation, 0xffffffff); }
+	EdsUInt32 getImageQuality() const			{ return demandUInt32(kEdsPropID_ImageQuality, 0xffffffff); }
+	EdsUInt32 getEvfMode() const				{ return demandUInt32(kEdsPropID_Evf_Mode, 0); }
+	EdsUInt32 getEvfOutputDevice() const		{ return demandUInt32(kEdsPropID_Evf_OutputDevice, 0); }
+	EdsUInt32 getEvfDepthOfFieldPreview() const	{ return demandUInt32(kEdsPropID_Evf_DepthOfFieldPreview, 0); }
+	EdsUInt32 getEvfZoom() const				{ return demandUInt32(kEdsPropID_Evf_Zoom, 0); }	
+	EdsPoint  getEvfZoomPosition() const		{ EdsPoint point = {}; demand(kEdsPropID_Evf_ZoomPosition, false); _properties.get(kEdsPropID_Evf_ZoomPosition, point); return point; }	
+	EdsRect	  getEvfZoomRect() const			{ EdsRect rect = {}; demand(kEdsPropID_Evf_ZoomRect, false); _properties.get(kEdsPropID_Evf_ZoomRect, rect); return rect; }	
+	EdsUInt32 getEvfAFMode() const				{ return demandUInt32(kEdsPropID_Evf_AFMode, 0); }
+	EdsChar *getModelName()						{ demand(kEdsPropID_ProductName, false); return _modelName; }
+	EdsChar *getSerialNumber()					{ demand(kEdsPropID_BodyIDEx, false); return _serialNumber; }
 	EdsFocusInfo getFocusInfo()const			{ return _focusInfo; }
 
+	// Every property value and desc seen, with a version per property
+	PropertyStore& getPropertyStore()			{ return _properties; }
+	const PropertyStore& getPropertyStore() const	{ return _properties; }
+	PropertyInfoCache& getPropertyInfoCache()	{ return _propertyInfo; }
+
+	// Type-checked read of the model's copy. False until it has been read.
+	template<EdsPropertyID propertyID>
+	bool getProperty(typename PropertyTraits<propertyID>::type& value) const
+	{
+		demand(propertyID, false);
+		return _properties.get(propertyID, value);
+	}
+
+	// Last downloaded live view image
+	void setEvfFrame(const EvfFrameRef& frame)
+	{
+		if(frame)
+		{
+			_evfRate.record(frame->getLength());
+			if(_firstFrameMicros.load(std::memory_order_relaxed) == 0 && _startMicros.load(std::memory_order_relaxed) != 0)
+			{
+				EdsUInt64 none = 0;
+				_firstFrameMicros.compare_exchange_strong(none, evfClockMicros());
+			}
+		}
+		std::atomic_store(&_evfFrame, frame);
+	}
+	EvfFrameRef getEvfFrame() const				{ return std::atomic_load(&_evfFrame); }
+	EvfStreamPoolRef getEvfStreamPool() const	{ return _evfStreamPool; }
+	EvfMetadataCache& getEvfMetadata()			{ return _evfMetadata; }
+	// Live view frames per second and bytes per second, however they are downloaded
+	const RateMeter& getEvfRate() const			{ return _evfRate; }
+
+	// Captured images
+	void setDownloadTarget(DownloadTarget target)	{ _downloadTarget = target; }
+	DownloadTarget getDownloadTarget() const		{ return _downloadTarget; }
+	CaptureBufferPoolRef getCaptureBufferPool() const	{ return _captureBufferPool; }
+	CaptureQueue* getCaptureQueue() const			{ return _captureQueue.get(); }
+	void setDownloadPipeline(const std::shared_ptr<DownloadPipeline>& pipeline)	{ std::atomic_store(&_downloadPipeline, pipeline); }
+	std::shared_ptr<DownloadPipeline> getDownloadPipeline() const				{ return std::atomic_load(&_downloadPipeline); }
+
+	// Card contents; empty until CameraController::scanStorage()
+	StorageIndexRef getStorageIndex() const			{ return _storageIndex; }
+
+	// Where the camera saves shots, kEdsSaveTo_Host unless set; taken by
+	// OpenSessionCommand and by SaveSettingCommand during a session
+	void setSaveTo(EdsUInt32 saveTo)				{ _saveTo = saveTo; }
+	EdsUInt32 getSaveTo() const						{ return _saveTo; }
+	// Empty for the working directory, where DownloadCommand writes files
+	void setHostCapacityPath(const std::string& path)	{ std::lock_guard<std::mutex> lock(_hostCapacityMutex); _hostCapacityPath = path; }
+	std::string getHostCapacityPath()				{ std::lock_guard<std::mutex> lock(_hostCapacityMutex); return _hostCapacityPath; }
+	TransferRulesRef getTransferRules() const		{ return _transferRules; }
+
+	// Read by the live view pump when it starts, and by the decode pools
+	// the caller sets up for this camera
+	void setPlacement(const CAMERA_PLACEMENT& placement)	{ std::lock_guard<std::mutex> lock(_placementMutex); _placement = placement; }
+	CAMERA_PLACEMENT getPlacement()					{ std::lock_guard<std::mutex> lock(_placementMutex); return _placement; }
+
+	// Startup, see StartupMode. With kStartupMode_Lazy the getters call
+	// handler for what the model does not hold; an empty one stops that.
+	void setStartupMode(StartupMode mode, const PropertyDemandHandler& handler)
+	{
+		_startupMode = mode;
+		std::shared_ptr<PropertyDemandHandler> next;
+		if(handler)
+		{
+			next = std::make_shared<PropertyDemandHandler>(handler);
+		}
+		std::atomic_store(&_demandHandler, next);
+		_lazyProperties.store(mode == kStartupMode_Lazy && next, std::memory_order_release);
+	}
+	StartupMode getStartupMode() const				{ return (StartupMode)_startupMode.load(); }
+
+	void noteStartup()
+	{
+		_sessionOpenMicros = 0;
+		_firstFrameMicros = 0;
+		_startupFetches = 0;
+		_startMicros = evfClockMicros();
+	}
+	void noteSessionOpened()
+	{
+		_sessionOpenMicros = evfClockMicros();
+		// A new session starts unlocked
+		std::lock_guard<std::mutex> lock(_lockMutex);
+		_lockCount = 0;
+	}
+
+	// UI lock for nested users: only the first lockUI() and the last
+	// unlockUI() reach the camera
+	EdsError lockUI()
+	{
+		std::lock_guard<std::mutex> lock(_lockMutex);
+		if(_lockCount == 0)
+		{
+			TraceScope trace("EDSDK", "EdsSendStatusCommand");
+			EdsError err = EdsSendStatusCommand(_camera, kEdsCameraStatusCommand_UILock, 0);
+			trace.setArg("error", err);
+			if(err != EDS_ERR_OK)
+			{
+				return err;
+			}
+		}
+		_lockCount++;
+		return EDS_ERR_OK;
+	}
+
+	EdsError unlockUI()
+	{
+		std::lock_guard<std::mutex> lock(_lockMutex);
+		if(_lockCount == 0 || --_lockCount > 0)
+		{
+			return EDS_ERR_OK;
+		}
+		TraceScope trace("EDSDK", "EdsSendStatusCommand");
+		EdsError err = EdsSendStatusCommand(_camera, kEdsCameraStatusCommand_UIUnLock, 0);
+		trace.setArg("error", err);
+		return err;
+	}
+
+	int getLockCount()
+	{
+		std::lock_guard<std::mutex> lock(_lockMutex);
+		return _lockCount;
+	}
+
+	// A property command finished; those before the first frame are counted
+	void notePropertyFetched(EdsPropertyID propertyID, bool desc, EdsError err)
+	{
+		_properties.fetchDone(propertyID, desc, err != EDS_ERR_OK);
+		if(_firstFrameMicros.load(std::memory_order_relaxed) == 0)
+		{
+			_startupFetches++;
+		}
+	}
+
+	STARTUP_TIMING getStartupTiming() const
+	{
+		STARTUP_TIMING timing;
+		timing.mode = getStartupMode();
+		timing.startMicros = _startMicros;
+		timing.sessionOpenMicros = _sessionOpenMicros;
+		timing.firstFrameMicros = _firstFrameMicros;
+		timing.timeToFirstFrameMicros = (timing.firstFrameMicros != 0) ? timing.firstFrameMicros - timing.startMicros : 0;
+		timing.propertiesFetched = _startupFetches;
+		return timing;
+	}
+
+	// Called on the SDK event thread as a capture is announced.
+	void noteTransferRequest()
+	{
+		EdsUInt64 now = evfClockMicros();
+		_lastTransferRequestMicros = now;
+		if(_transferRequestExpected.exchange(false))
+		{
+			_firstTransferRequestMicros = now;
+		}
+		_transferRequestCount++;
+	}
+	// Record the time of the next arrival only, e.g. the RAW of a RAW+JPEG pair.
+	void expectTransferRequest()					{ _firstTransferRequestMicros = 0; _transferRequestExpected = true; }
+	EdsUInt64 getFirstTransferRequestMicros() const	{ return _firstTransferRequestMicros; }
+	EdsUInt64 getLastTransferRequestMicros() const	{ return _lastTransferRequestMicros; }
+	EdsUInt64 getTransferRequestCount() const		{ return _transferRequestCount; }
+
 	//List of value in which taking a picture parameter can be set
-	EdsPropertyDesc getAEModeDesc() const					{ return _AEModeDesc;}
-	EdsPropertyDesc getAvDesc() const						{ return _AvDesc;}
-	EdsPropertyDesc getTvDesc()	const						{ return _TvDesc;}
-	EdsPropertyDesc getIsoDesc()	const					{ return _IsoDesc;}
-	EdsPropertyDesc getMeteringModeDesc()	const			{ return _MeteringModeDesc;}
-	EdsPropertyDesc getExposureCompensationDesc()	const	{ return _ExposureCompensationDesc;}
-	EdsPropertyDesc getImageQualityDesc()	const			{ return _ImageQualityDesc;}
-	EdsPropertyDesc getEvfAFModeDesc()	const				{ return _evfAFModeDesc;}
+	EdsPropertyDesc getAEModeDesc() const					{ return getPropertyDesc(kEdsPropID_AEModeSelect); }
+	EdsPropertyDesc getAvDesc() const						{ return getPropertyDesc(kEdsPropID_Av); }
+	EdsPropertyDesc getTvDesc()	const						{ return getPropertyDesc(kEdsPropID_Tv); }
+	EdsPropertyDesc getIsoDesc()	const					{ return getPropertyDesc(kEdsPropID_ISOSpeed); }
+	EdsPropertyDesc getMeteringModeDesc()	const			{ return getPropertyDesc(kEdsPropID_MeteringMode); }
+	EdsPropertyDesc getExposureCompensationDesc()	const	{ return getPropertyDesc(kEdsPropID_ExposureCompensation); }
+	EdsPropertyDesc getImageQualityDesc()	const			{ return getPropertyDesc(kEdsPropID_ImageQuality); }
+	EdsPropertyDesc getEvfAFModeDesc()	const				{ return getPropertyDesc(kEdsPropID_Evf_AFMode); }
 
 	//List of value in which taking a picture parameter can be set
-	void setAEModeDesc(const EdsPropertyDesc* desc)					{_AEModeDesc = *desc;}
-	void setAvDesc(const EdsPropertyDesc* desc)						{_AvDesc = *desc;}
-	void setTvDesc(const EdsPropertyDesc* desc)						{_TvDesc = *desc;}
-	void setIsoDesc(const EdsPropertyDesc* desc)					{_IsoDesc = *desc;}
-	void setMeteringModeDesc(const EdsPropertyDesc* desc)			{_MeteringModeDesc = *desc;}
-	void setExposureCompensationDesc(const EdsPropertyDesc* desc)	{_ExposureCompensationDesc = *desc;}
-	void setImageQualityDesc(const EdsPropertyDesc* desc)			{_ImageQualityDesc = *desc;}
-	void setEvfAFModeDesc(const EdsPropertyDesc* desc)			{_evfAFModeDesc = *desc;}
+	void setAEModeDesc(const EdsPropertyDesc* desc)					{ setPropertyDesc(kEdsPropID_AEModeSelect, desc); }
+	void setAvDesc(const EdsPropertyDesc* desc)						{ setPropertyDesc(kEdsPropID_Av, desc); }
+	void setTvDesc(const EdsPropertyDesc* desc)						{ setPropertyDesc(kEdsPropID_Tv, desc); }
+	void setIsoDesc(const EdsPropertyDesc* desc)					{ setPropertyDesc(kEdsPropID_ISOSpeed, desc); }
+	void setMeteringModeDesc(const EdsPropertyDesc* desc)			{ setPropertyDesc(kEdsPropID_MeteringMode, desc); }
+	void setExposureCompensationDesc(const EdsPropertyDesc* desc)	{ setPropertyDesc(kEdsPropID_ExposureCompensation, desc); }
+	void setImageQualityDesc(const EdsPropertyDesc* desc)			{ setPropertyDesc(kEdsPropID_ImageQuality, desc); }
+	void setEvfAFModeDesc(const EdsPropertyDesc* desc)			{ setPropertyDesc(kEdsPropID_Evf_AFMode, desc); }
 
 public:
+	// Any property as read from the camera. True if the value changed.
+	bool setPropertyData(EdsUInt32 propertyID, EdsDataType dataType, const void* data, EdsUInt32 size)
+	{
+		return _properties.setValue(propertyID, dataType, data, size);
+	}
+
 	//Setting of taking a picture parameter(UInt32)
-	void setPropertyUInt32(EdsUInt32 propertyID, EdsUInt32 value)	
+	// True if the value changed
+	bool setPropertyUInt32(EdsUInt32 propertyID, EdsUInt32 value)	
 	{
-		switch(propertyID) 
-		{
-			case kEdsPropID_AEModeSelect:			setAEMode(value);					break;
-			case kEdsPropID_Tv:						setTv(value);						break;		               
-			case kEdsPropID_Av:						setAv(value);						break;           	  
-			case kEdsPropID_ISOSpeed:				setIso(value);						break;       
-			case kEdsPropID_MeteringMode:			setMeteringMode(value);				break;       
-			case kEdsPropID_ExposureCompensation:	setExposureCompensation(value);		break;
-			case kEdsPropID_ImageQuality:			setImageQuality(value);				break;
-			case kEdsPropID_Evf_Mode:				setEvfMode(value);					break;
-			case kEdsPropID_Evf_OutputDevice:		setEvfOutputDevice(value);			break;
-			case kEdsPropID_Evf_DepthOfFieldPreview:setEvfDepthOfFieldPreview(value);	break;	
-			case kEdsPropID_Evf_AFMode:				setEvfAFMode(value);				break;
-		}
+		return _properties.set(propertyID, kEdsDataType_UInt32, value);
+	}
+
+	//Acquisition of taking a picture parameter(UInt32)
+	// Returns false when the model does not hold the property
+	bool getPropertyUInt32(EdsUInt32 propertyID, EdsUInt32* value) const
+	{
+		demand(propertyID, false);
+		return _properties.get(propertyID, *value);
 	}
 
 	//Setting of taking a picture parameter(String)
-	void setPropertyString(EdsUInt32 propertyID, EdsChar *str)	
+	bool setPropertyString(EdsUInt32 propertyID, EdsChar *str)	
 	{	
 		switch(propertyID) 
 		{
 			case kEdsPropID_ProductName:			setModelName(str);					break;
+			case kEdsPropID_BodyIDEx:				setSerialNumber(str);				break;
 		}
+		return _properties.setString(propertyID, str);
 	}
 
 	void setProeprtyFocusInfo(EdsUInt32 propertyID, EdsFocusInfo info)
@@ -165,35 +460,14 @@ public:
 	//Setting of value list that can set taking a picture parameter
 	void setPropertyDesc(EdsUInt32 propertyID, const EdsPropertyDesc* desc)
 	{
-		switch(propertyID) 
-		{
-			case kEdsPropID_AEModeSelect:			setAEModeDesc(desc);				break;
-			case kEdsPropID_Tv:						setTvDesc(desc);					break;		               
-			case kEdsPropID_Av:						setAvDesc(desc);					break;           	  
-			case kEdsPropID_ISOSpeed:				setIsoDesc(desc);					break;       
-			case kEdsPropID_MeteringMode:			setMeteringModeDesc(desc);			break;       
-			case kEdsPropID_ExposureCompensation:	setExposureCompensationDesc(desc);	break;       
-			case kEdsPropID_ImageQuality:			setImageQualityDesc(desc);			break;   
-			case kEdsPropID_Evf_AFMode:				setEvfAFModeDesc(desc);				break;
-		}	
+		_properties.setDesc(propertyID, *desc);
 	}
 
 	//Acquisition of value list that can set taking a picture parameter
-	EdsPropertyDesc getPropertyDesc(EdsUInt32 propertyID)	
+	EdsPropertyDesc getPropertyDesc(EdsUInt32 propertyID) const
 	{
-		EdsPropertyDesc desc = {0};
-		switch(propertyID) 
-		{
-			case kEdsPropID_AEModeSelect:			desc = getAEModeDesc();					break;
-			case kEdsPropID_Tv:						desc = getTvDesc();						break;		               
-			case kEdsPropID_Av:						desc = getAvDesc();						break;           	  
-			case kEdsPropID_ISOSpeed:				desc = getIsoDesc();					break;       
-			case kEdsPropID_MeteringMode:			desc = getMeteringModeDesc();			break;       
-			case kEdsPropID_ExposureCompensation:	desc = getExposureCompensationDesc();	break;       
-			case kEdsPropID_ImageQuality:			desc = getImageQualityDesc();			break;    
-			case kEdsPropID_Evf_AFMode:				desc = getEvfAFModeDesc();				break;    
-		}
-		return desc;
+		demand(propertyID, true);
+		return _properties.getDesc(propertyID);
 	}
 
 //Access to camera
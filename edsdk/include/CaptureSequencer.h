@@ -0,0 +1,529 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : CaptureSequencer.h                                              *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "EDSDK.h"
+#include "Thread.h"
+#include "Command.h"
+#include "CameraEvent.h"
+#include "CameraController.h"
+#include "EvfFrame.h"
+
+
+enum CaptureSchedule
+{
+	// One shot every interval
+	kCaptureSchedule_Interval = 0,
+	// Shots back to back, or spaced by the interval
+	kCaptureSchedule_Burst,
+	// Bulb exposures every interval, the length ramped from first to last
+	kCaptureSchedule_BulbRamp,
+};
+
+// What to do with a slot whose time comes while the last shot is running
+enum SequenceBusyPolicy
+{
+	kSequenceBusy_Skip = 0,
+	kSequenceBusy_Delay,
+};
+
+enum SequenceShotStatus
+{
+	kSequenceShot_Done = 0,
+	// Fired after waiting for the previous shot
+	kSequenceShot_Late,
+	// Not fired, the previous shot was still running
+	kSequenceShot_Skipped,
+	// The camera answered busy
+	kSequenceShot_Busy,
+	kSequenceShot_Failed,
+};
+
+
+// Times are microseconds from the start of the sequence.
+typedef struct _SEQUENCE_SHOT
+{
+	EdsUInt32			index;
+	SequenceShotStatus	status;
+	EdsError			error;
+	EdsUInt64			scheduledMicros;
+	EdsUInt64			dispatchMicros;
+	// dispatch - scheduled, including the wait on the processor
+	EdsUInt64			latenessMicros;
+	// Time inside EdsSendCommand for the release
+	EdsUInt64			commandMicros;
+	// Bulb: time the shutter was held
+	EdsUInt64			exposureMicros;
+}SEQUENCE_SHOT;
+
+
+typedef struct _SEQUENCE_STATISTICS
+{
+	EdsUInt32	planned;
+	EdsUInt32	completed;
+	EdsUInt32	fired;
+	EdsUInt32	late;
+	EdsUInt32	skipped;
+	EdsUInt32	busy;
+	EdsUInt32	failed;
+	EdsUInt64	averageLatenessMicros;
+	EdsUInt64	maxLatenessMicros;
+	EdsUInt64	elapsedMicros;
+}SEQUENCE_STATISTICS;
+
+
+// Shared by the sequencer and the shot commands still on the processor.
+class SequenceState
+{
+public:
+	enum { kShotLimit = 1024 };
+
+	std::mutex					mutex;
+	std::condition_variable		condition;
+	std::deque<SEQUENCE_SHOT>	shots;
+	bool						inFlight;
+	EdsUInt64					startMicros;
+	EdsUInt64					latenessTotal;
+	SEQUENCE_STATISTICS			stats;
+
+	SequenceState() : inFlight(false), startMicros(0), latenessTotal(0)
+	{
+		memset(&stats, 0, sizeof(stats));
+	}
+
+	void record(const SEQUENCE_SHOT& shot)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			switch(shot.status)
+			{
+			case kSequenceShot_Done:	stats.fired++; break;
+			case kSequenceShot_Late:	stats.fired++; stats.late++; break;
+			case kSequenceShot_Skipped:	stats.skipped++; break;
+			case kSequenceShot_Busy:	stats.busy++; break;
+			default:					stats.failed++; break;
+			}
+			if(shot.status == kSequenceShot_Done || shot.status == kSequenceShot_Late)
+			{
+				latenessTotal += shot.latenessMicros;
+				stats.averageLatenessMicros = latenessTotal / stats.fired;
+				if(shot.latenessMicros > stats.maxLatenessMicros)
+				{
+					stats.maxLatenessMicros = shot.latenessMicros;
+				}
+			}
+			stats.completed++;
+
+			shots.push_back(shot);
+			while(shots.size() > kShotLimit)
+			{
+				shots.pop_front();
+			}
+			if(shot.status != kSequenceShot_Skipped)
+			{
+				inFlight = false;
+			}
+		}
+		condition.notify_all();
+	}
+};
+
+typedef std::shared_ptr<SequenceState> SequenceStateRef;
+
+
+// Ends a bulb exposure. Parked on the processor until the shutter is due
+// to close, so other commands run during the exposure.
+class BulbReleaseCommand : public Command
+{
+private:
+	SequenceStateRef	_state;
+	SEQUENCE_SHOT		_shot;
+	EdsUInt64			_pressMicros;
+	EdsUInt64			_releaseMicros;
+	bool				_released;
+
+	void release()
+	{
+		EdsError err = EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_OFF);
+		_shot.exposureMicros = evfClockMicros() - _pressMicros;
+		if(err != EDS_ERR_OK && _shot.error == EDS_ERR_OK)
+		{
+			_shot.status = kSequenceShot_Failed;
+			_shot.error = err;
+		}
+		_released = true;
+		_state->record(_shot);
+	}
+
+public:
+	BulbReleaseCommand(CameraModel* model, const SequenceStateRef& state, const SEQUENCE_SHOT& shot, EdsUInt64 pressMicros, EdsUInt64 releaseMicros)
+		: Command(model), _state(state), _shot(shot), _pressMicros(pressMicros), _releaseMicros(releaseMicros), _released(false) {}
+
+	// Dropped from the processor, e.g. when the session closes: the shutter
+	// is not left open.
+	virtual ~BulbReleaseCommand()
+	{
+		if(!_released)
+		{
+			_shot.status = kSequenceShot_Failed;
+			_shot.error = EDS_ERR_OPERATION_CANCELLED;
+			release();
+		}
+	}
+
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+	virtual const char* getName() const {return "BulbRelease";}
+
+	virtual bool execute()
+	{
+		// The processor parks to the millisecond; the rest is slept here
+		if(evfClockMicros() < _releaseMicros)
+		{
+			std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(_releaseMicros)));
+		}
+		release();
+		return true;
+	}
+};
+
+
+// One slot of a sequence, run on the camera's processor. A bulb shot only
+// opens the shutter here; a BulbReleaseCommand closes it when due.
+class SequenceShotCommand : public Command
+{
+private:
+	CameraController*	_controller;
+	SequenceStateRef	_state;
+	SEQUENCE_SHOT		_shot;
+	EdsUInt64			_deadline;
+	EdsUInt64			_bulbMicros;
+	bool				_executed;
+
+public:
+	SequenceShotCommand(CameraController* controller, CameraModel* model, const SequenceStateRef& state, const SEQUENCE_SHOT& shot, EdsUInt64 deadline, EdsUInt64 bulbMicros)
+		: Command(model), _controller(controller), _state(state), _shot(shot), _deadline(deadline), _bulbMicros(bulbMicros), _executed(false) {}
+
+	// Dropped from the processor before it ran: the slot is recorded so the
+	// sequencer does not wait on it.
+	virtual ~SequenceShotCommand()
+	{
+		if(!_executed)
+		{
+			_shot.status = kSequenceShot_Failed;
+			_shot.error = EDS_ERR_OPERATION_CANCELLED;
+			_state->record(_shot);
+		}
+	}
+
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+	virtual const char* getName() const {return "SequenceShot";}
+
+	// Never retried, the slot would be late.
+	virtual bool execute()
+	{
+		_executed = true;
+		EdsCameraRef camera = _model->getCameraObject();
+
+		EdsUInt64 start = evfClockMicros();
+		EdsError err = EdsSendCommand(camera, kEdsCameraCommand_PressShutterButton,
+			(_bulbMicros > 0) ? kEdsCameraCommand_ShutterButton_Completely_NonAF : kEdsCameraCommand_ShutterButton_Completely);
+		EdsUInt64 end = evfClockMicros();
+
+		_shot.dispatchMicros = start - _state->startMicros;
+		_shot.latenessMicros = (start > _deadline) ? start - _deadline : 0;
+		_shot.commandMicros = end - start;
+		_shot.error = err;
+
+		if(err == EDS_ERR_OK && _bulbMicros > 0)
+		{
+			// Recorded once the shutter has closed
+			EdsUInt64 release = start + _bulbMicros;
+			_controller->enqueueAt(new BulbReleaseCommand(_model, _state, _shot, start, release),
+				std::chrono::steady_clock::time_point(std::chrono::microseconds(release)));
+			return true;
+		}
+
+		EdsSendCommand(camera, kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_OFF);
+		if(_bulbMicros > 0)
+		{
+			_shot.exposureMicros = evfClockMicros() - start;
+		}
+
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			_shot.status = kSequenceShot_Busy;
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+		}
+		else if(err != EDS_ERR_OK)
+		{
+			_shot.status = kSequenceShot_Failed;
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
+			_model->notifyObservers(&e);
+		}
+
+		_state->record(_shot);
+		return true;
+	}
+};
+
+
+// Runs a capture schedule for one camera against monotonic deadlines:
+// slot k is due at start + k * interval however late earlier slots were,
+// so the sequence does not drift. Shots are queued on the camera's
+// processor; downloads go to its transfer worker and overlap the next
+// exposure.
+class CaptureSequencer : public Thread
+{
+public:
+	enum { kSpinMicros = 2000 };
+
+private:
+	CameraController*	_controller;
+	CameraModel*		_model;
+
+	CaptureSchedule		_schedule;
+	SequenceBusyPolicy	_busyPolicy;
+	EdsUInt32			_count;
+	EdsUInt64			_intervalMicros;
+	EdsUInt64			_startDelayMicros;
+	EdsUInt64			_bulbStartMicros;
+	EdsUInt64			_bulbEndMicros;
+
+	SequenceStateRef	_state;
+	bool				_running;
+	bool				_finished;
+
+public:
+	CaptureSequencer(CameraController* controller, CameraModel* model)
+		: _controller(controller), _model(model), _schedule(kCaptureSchedule_Interval), _busyPolicy(kSequenceBusy_Skip),
+		  _count(1), _intervalMicros(1000000), _startDelayMicros(0), _bulbStartMicros(0), _bulbEndMicros(0),
+		  _state(std::make_shared<SequenceState>()), _running(false), _finished(true) {}
+
+	virtual ~CaptureSequencer()
+	{
+		stop();
+	}
+
+	// count 0 runs until stop().
+	void setInterval(EdsUInt32 count, EdsUInt64 intervalMicros)
+	{
+		_schedule = kCaptureSchedule_Interval;
+		_count = count;
+		_intervalMicros = intervalMicros;
+	}
+
+	// spacingMicros 0 fires each shot as soon as the last one returns.
+	void setBurst(EdsUInt32 count, EdsUInt64 spacingMicros = 0)
+	{
+		_schedule = kCaptureSchedule_Burst;
+		_count = count;
+		_intervalMicros = spacingMicros;
+	}
+
+	// Needs the camera in bulb mode. Exposure goes linearly from the first
+	// to the last length over count shots.
+	void setBulbRamp(EdsUInt32 count, EdsUInt64 intervalMicros, EdsUInt64 startExposureMicros, EdsUInt64 endExposureMicros)
+	{
+		_schedule = kCaptureSchedule_BulbRamp;
+		_count = count;
+		_intervalMicros = intervalMicros;
+		_bulbStartMicros = startExposureMicros;
+		_bulbEndMicros = endExposureMicros;
+	}
+
+	void setBusyPolicy(SequenceBusyPolicy policy)	{ _busyPolicy = policy; }
+	void setStartDelay(EdsUInt64 micros)			{ _startDelayMicros = micros; }
+	CaptureSchedule getSchedule() const				{ return _schedule; }
+
+	bool start()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			if(_running)
+			{
+				return true;
+			}
+		}
+		join();
+
+		_state = std::make_shared<SequenceState>();
+		_state->stats.planned = _count;
+		_running = true;
+		_finished = false;
+		if(!Thread::start())
+		{
+			_running = false;
+			_finished = true;
+		}
+		return _running;
+	}
+
+	// Stops scheduling; a shot already on the processor still completes.
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			_running = false;
+		}
+		_state->condition.notify_all();
+		join();
+	}
+
+	bool isRunning()
+	{
+		std::lock_guard<std::mutex> lock(_state->mutex);
+		return _running;
+	}
+
+	// Wait until every slot has been fired or skipped and the last shot
+	// has returned. False on timeout.
+	bool wait(int millisec)
+	{
+		SequenceStateRef state = _state;
+		std::unique_lock<std::mutex> lock(state->mutex);
+		return state->condition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec),
+			[this, &state]() { return _finished && !state->inFlight; });
+	}
+
+	// Next per-shot record, false on timeout.
+	bool popShot(SEQUENCE_SHOT& shot, int millisec)
+	{
+		SequenceStateRef state = _state;
+		std::unique_lock<std::mutex> lock(state->mutex);
+		if(!state->condition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [&state]() { return !state->shots.empty(); }))
+		{
+			return false;
+		}
+		shot = state->shots.front();
+		state->shots.pop_front();
+		return true;
+	}
+
+	SEQUENCE_STATISTICS getStatistics()
+	{
+		SequenceStateRef state = _state;
+		std::lock_guard<std::mutex> lock(state->mutex);
+		SEQUENCE_STATISTICS stats = state->stats;
+		if(state->startMicros != 0)
+		{
+			stats.elapsedMicros = evfClockMicros() - state->startMicros;
+		}
+		return stats;
+	}
+
+	virtual void run()
+	{
+		SequenceStateRef state = _state;
+		state->startMicros = evfClockMicros() + _startDelayMicros;
+
+		for(EdsUInt32 index = 0; _count == 0 || index < _count; index++)
+		{
+			EdsUInt64 offset = (EdsUInt64)index * _intervalMicros;
+			EdsUInt64 deadline = state->startMicros + offset;
+
+			if(!waitUntil(state, deadline))
+			{
+				break;
+			}
+
+			SEQUENCE_SHOT shot;
+			memset(&shot, 0, sizeof(shot));
+			shot.index = index;
+			shot.scheduledMicros = offset;
+			shot.status = kSequenceShot_Done;
+
+			{
+				std::unique_lock<std::mutex> lock(state->mutex);
+				if(state->inFlight)
+				{
+					// Back-to-back bursts wait for the camera by design
+					if(_busyPolicy == kSequenceBusy_Skip && !(_schedule == kCaptureSchedule_Burst && _intervalMicros == 0))
+					{
+						lock.unlock();
+						shot.status = kSequenceShot_Skipped;
+						state->record(shot);
+						continue;
+					}
+
+					state->condition.wait(lock, [this, &state]() { return !state->inFlight || !_running; });
+					if(!_running)
+					{
+						break;
+					}
+					if(_intervalMicros > 0)
+					{
+						shot.status = kSequenceShot_Late;
+					}
+				}
+				state->inFlight = true;
+			}
+
+			_controller->enqueue(new SequenceShotCommand(_controller, _model, state, shot, deadline, bulbExposure(index)));
+		}
+
+		std::lock_guard<std::mutex> lock(state->mutex);
+		_running = false;
+		_finished = true;
+		state->condition.notify_all();
+	}
+
+protected:
+	EdsUInt64 bulbExposure(EdsUInt32 index) const
+	{
+		if(_schedule != kCaptureSchedule_BulbRamp)
+		{
+			return 0;
+		}
+		if(_count <= 1)
+		{
+			return _bulbStartMicros;
+		}
+
+		double t = (double)index / (double)(_count - 1);
+		return (EdsUInt64)((double)_bulbStartMicros + ((double)_bulbEndMicros - (double)_bulbStartMicros) * t);
+	}
+
+	// Sleep to just before the deadline, then spin the rest, which a
+	// sleep alone overshoots by the timer resolution. False if stopped.
+	bool waitUntil(const SequenceStateRef& state, EdsUInt64 deadline)
+	{
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			if(deadline > evfClockMicros() + kSpinMicros)
+			{
+				std::chrono::steady_clock::time_point wake(std::chrono::microseconds(deadline - kSpinMicros));
+				state->condition.wait_until(lock, wake, [this]() { return !_running; });
+			}
+			if(!_running)
+			{
+				return false;
+			}
+		}
+
+		while(evfClockMicros() < deadline)
+		{
+			std::this_thread::yield();
+		}
+		return true;
+	}
+};
@@ -0,0 +1,627 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : CapturedImage.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "EDSDK.h"
+#include "Synchronized.h"
+
+
+enum DownloadTarget
+{
+	// File named after the item, in the working directory
+	kDownloadTarget_File = 0,
+	// Pooled memory buffer, queued on the model as a CapturedImage
+	kDownloadTarget_Memory,
+	// In chunks through the sinks of the model's DownloadPipeline
+	kDownloadTarget_Pipeline,
+};
+
+
+// Page-aligned memory a full-size file is downloaded into. Mapped straight
+// from the OS rather than the heap, so 40 MB buffers never fragment it, and
+// optionally faulted in up front and backed by huge pages.
+class CaptureBuffer
+{
+public:
+	enum { kHugePageBytes = 2 * 1024 * 1024 };
+
+private:
+	unsigned char*	_data;
+	size_t			_size;
+	bool			_hugePages;
+
+	CaptureBuffer(const CaptureBuffer&);
+	CaptureBuffer& operator=(const CaptureBuffer&);
+
+	static size_t pageSize()
+	{
+#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (size_t)info.dwPageSize;
+#else
+		return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+public:
+	// Zero filled. hugePages is a hint; without the privilege (Windows) or
+	// reserved pages (Linux) the buffer falls back to normal pages.
+	CaptureBuffer(size_t size, bool hugePages = false, bool prefault = false)
+		: _data(NULL), _size(size), _hugePages(false)
+	{
+		if(size == 0)
+		{
+			return;
+		}
+
+#ifdef _WIN32
+		if(hugePages && size >= kHugePageBytes)
+		{
+			SIZE_T large = GetLargePageMinimum();
+			if(large != 0)
+			{
+				_data = (unsigned char*)VirtualAlloc(NULL, (size + large - 1) / large * large,
+					MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				_hugePages = (_data != NULL);
+			}
+		}
+		if(_data == NULL)
+		{
+			_data = (unsigned char*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		}
+#else
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+		if(prefault)
+		{
+			flags |= MAP_POPULATE;
+		}
+#endif
+		void* data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+		if(hugePages && size >= kHugePageBytes)
+		{
+			data = mmap(NULL, (size + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes,
+				PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+			_hugePages = (data != MAP_FAILED);
+		}
+#endif
+		if(data == MAP_FAILED)
+		{
+			data = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+#ifdef MADV_HUGEPAGE
+			// Transparent huge pages, where the kernel has them enabled
+			if(data != MAP_FAILED && hugePages && size >= kHugePageBytes)
+			{
+				madvise(data, size, MADV_HUGEPAGE);
+			}
+#endif
+		}
+		_data = (data != MAP_FAILED) ? (unsigned char*)data : NULL;
+#endif
+		if(_data == NULL)
+		{
+			throw std::bad_alloc();
+		}
+
+		// One write per page, where the mapping did not already populate it
+#if defined(_WIN32) || !defined(MAP_POPULATE)
+		if(prefault)
+		{
+			size_t page = pageSize();
+			for(size_t offset = 0; offset < size; offset += page)
+			{
+				((volatile unsigned char*)_data)[offset] = 0;
+			}
+		}
+#endif
+	}
+
+	~CaptureBuffer()
+	{
+		if(_data == NULL)
+		{
+			return;
+		}
+#ifdef _WIN32
+		VirtualFree(_data, 0, MEM_RELEASE);
+#else
+		size_t mapped = _hugePages ? (_size + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes : _size;
+		munmap(_data, mapped);
+#endif
+	}
+
+	size_t size() const							{ return _size; }
+	bool empty() const							{ return _size == 0; }
+	unsigned char* data()						{ return _data; }
+	const unsigned char* data() const			{ return _data; }
+	unsigned char& operator[](size_t i)			{ return _data[i]; }
+	const unsigned char& operator[](size_t i) const	{ return _data[i]; }
+	bool isHugePages() const					{ return _hugePages; }
+};
+
+typedef std::shared_ptr<CaptureBuffer>		CaptureBufferRef;
+
+
+typedef struct _CAPTURE_POOL_STATISTICS
+{
+	EdsUInt64	hits;				// acquire() served from the pool
+	EdsUInt64	misses;				// acquire() had to allocate
+	EdsUInt32	poolSize;
+	EdsUInt32	available;			// buffers currently idle in the pool
+	EdsUInt64	pooledBytes;
+	EdsUInt32	inUse;				// acquired and not released yet
+	EdsUInt32	sizeClasses;		// distinct sizes idle in the pool
+	EdsUInt64	inUseBytes;
+	EdsUInt64	allocatedBytes;		// by misses and preallocate()
+	EdsUInt64	allocateMicros;		// spent mapping and faulting them in
+	EdsUInt64	hugePageBuffers;	// allocations that got huge pages
+	EdsUInt64	discarded;			// released buffers the pool had no room for
+}CAPTURE_POOL_STATISTICS;
+
+
+// Reuses the large buffers full-size images are downloaded into, so a burst
+// of 40 MB RAW files does not allocate and fault in fresh memory per shot.
+// Sizes are rounded up to classes, four per doubling above 1 MB, so files
+// of similar size share buffers; acquire() takes the smallest idle class
+// that fits, but not one more than twice the size asked for.
+// Owned through a shared_ptr; images keep a weak_ptr like EvfStreamPool.
+class CaptureBufferPool
+{
+public:
+	enum { kDefaultPoolSize = 4, kMinClassBytes = 1024 * 1024 };
+
+private:
+	typedef std::map<EdsUInt64, std::vector<CaptureBufferRef> >	FreeLists;
+
+	FreeLists						_free;
+	EdsUInt32						_available;
+	EdsUInt32						_poolSize;
+	bool							_hugePages;
+	bool							_prefault;
+	EdsUInt64						_hits;
+	EdsUInt64						_misses;
+	EdsUInt32						_inUse;
+	EdsUInt64						_inUseBytes;
+	EdsUInt64						_allocatedBytes;
+	EdsUInt64						_allocateMicros;
+	EdsUInt64						_hugePageBuffers;
+	EdsUInt64						_discarded;
+	Synchronized					_syncObject;
+
+	CaptureBufferRef allocate(EdsUInt64 size)
+	{
+		_syncObject.lock();
+		bool hugePages = _hugePages;
+		bool prefault = _prefault;
+		_syncObject.unlock();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		CaptureBufferRef buffer = std::make_shared<CaptureBuffer>((size_t)size, hugePages, prefault);
+		EdsUInt64 micros = (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+		_syncObject.lock();
+		_allocatedBytes += size;
+		_allocateMicros += micros;
+		if(buffer->isHugePages())
+		{
+			_hugePageBuffers++;
+		}
+		_syncObject.unlock();
+		return buffer;
+	}
+
+	// Idle buffer to give up for one of size, the smallest class first
+	bool evictFor(EdsUInt64 size)
+	{
+		FreeLists::iterator smallest = _free.begin();
+		if(smallest == _free.end() || smallest->first >= size)
+		{
+			return false;
+		}
+		smallest->second.pop_back();
+		if(smallest->second.empty())
+		{
+			_free.erase(smallest);
+		}
+		_available--;
+		_discarded++;
+		return true;
+	}
+
+public:
+	CaptureBufferPool(EdsUInt32 poolSize = kDefaultPoolSize)
+		: _available(0), _poolSize(poolSize), _hugePages(true), _prefault(true), _hits(0), _misses(0),
+		  _inUse(0), _inUseBytes(0), _allocatedBytes(0), _allocateMicros(0), _hugePageBuffers(0), _discarded(0) {}
+
+	static EdsUInt64 sizeClass(EdsUInt64 size)
+	{
+		if(size <= kMinClassBytes)
+		{
+			return kMinClassBytes;
+		}
+		EdsUInt64 power = kMinClassBytes;
+		while(power * 2 < size)
+		{
+			power *= 2;
+		}
+		EdsUInt64 step = power / 4;
+		return (size + step - 1) / step * step;
+	}
+
+	// Huge pages cut TLB misses when a RAW is written and read back; a hint
+	// only, see CaptureBuffer
+	void setHugePages(bool hugePages)
+	{
+		_syncObject.lock();
+		_hugePages = hugePages;
+		_syncObject.unlock();
+	}
+
+	bool getHugePages()
+	{
+		_syncObject.lock();
+		bool hugePages = _hugePages;
+		_syncObject.unlock();
+		return hugePages;
+	}
+
+	// Faults new buffers in when they are allocated instead of page by page
+	// while the SDK writes into them
+	void setPrefault(bool prefault)
+	{
+		_syncObject.lock();
+		_prefault = prefault;
+		_syncObject.unlock();
+	}
+
+	bool getPrefault()
+	{
+		_syncObject.lock();
+		bool prefault = _prefault;
+		_syncObject.unlock();
+		return prefault;
+	}
+
+	// Allocate buffers up front, e.g. count RAW-sized buffers before a burst.
+	void preallocate(EdsUInt32 count, EdsUInt64 bufferSize)
+	{
+		EdsUInt64 size = sizeClass(bufferSize);
+		for(EdsUInt32 i = 0; i < count; i++)
+		{
+			_syncObject.lock();
+			bool full = (_available >= _poolSize);
+			_syncObject.unlock();
+			if(full)
+			{
+				break;
+			}
+
+			CaptureBufferRef buffer = allocate(size);
+			_syncObject.lock();
+			_free[size].push_back(buffer);
+			_available++;
+			_syncObject.unlock();
+		}
+	}
+
+	CaptureBufferRef acquire(EdsUInt64 size)
+	{
+		EdsUInt64 wanted = sizeClass(size);
+		CaptureBufferRef buffer;
+
+		_syncObject.lock();
+		FreeLists::iterator best = _free.lower_bound(wanted);
+		if(best != _free.end() && best->first <= wanted * 2)
+		{
+			buffer = best->second.back();
+			best->second.pop_back();
+			if(best->second.empty())
+			{
+				_free.erase(best);
+			}
+			_available--;
+			_hits++;
+		}
+		else
+		{
+			_misses++;
+		}
+		_syncObject.unlock();
+
+		if(!buffer)
+		{
+			buffer = allocate(wanted);
+		}
+
+		_syncObject.lock();
+		_inUse++;
+		_inUseBytes += buffer->size();
+		_syncObject.unlock();
+		return buffer;
+	}
+
+	// When full, the smallest buffer is the one dropped.
+	void release(const CaptureBufferRef& buffer)
+	{
+		if(!buffer)
+		{
+			return;
+		}
+
+		_syncObject.lock();
+		if(_inUse > 0)
+		{
+			_inUse--;
+			_inUseBytes -= std::min<EdsUInt64>(_inUseBytes, buffer->size());
+		}
+		if(_poolSize > 0 && (_available < _poolSize || evictFor(buffer->size())))
+		{
+			_free[buffer->size()].push_back(buffer);
+			_available++;
+		}
+		else
+		{
+			_discarded++;
+		}
+		_syncObject.unlock();
+	}
+
+	void setPoolSize(EdsUInt32 poolSize)
+	{
+		_syncObject.lock();
+		_poolSize = poolSize;
+		while(_available > _poolSize && evictFor((EdsUInt64)-1))
+		{
+		}
+		_syncObject.unlock();
+	}
+
+	EdsUInt32 getPoolSize()
+	{
+		_syncObject.lock();
+		EdsUInt32 poolSize = _poolSize;
+		_syncObject.unlock();
+		return poolSize;
+	}
+
+	CAPTURE_POOL_STATISTICS getStatistics()
+	{
+		CAPTURE_POOL_STATISTICS stats = {};
+
+		_syncObject.lock();
+		stats.hits = _hits;
+		stats.misses = _misses;
+		stats.poolSize = _poolSize;
+		stats.available = _available;
+		for(FreeLists::iterator it = _free.begin(); it != _free.end(); ++it)
+		{
+			stats.pooledBytes += it->first * it->second.size();
+		}
+		stats.sizeClasses = (EdsUInt32)_free.size();
+		stats.inUse = _inUse;
+		stats.inUseBytes = _inUseBytes;
+		stats.allocatedBytes = _allocatedBytes;
+		stats.allocateMicros = _allocateMicros;
+		stats.hugePageBuffers = _hugePageBuffers;
+		stats.discarded = _discarded;
+		_syncObject.unlock();
+
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		_syncObject.lock();
+		_hits = _misses = 0;
+		_allocatedBytes = _allocateMicros = _hugePageBuffers = _discarded = 0;
+		_syncObject.unlock();
+	}
+
+	void clear()
+	{
+		_syncObject.lock();
+		_free.clear();
+		_available = 0;
+		_syncObject.unlock();
+	}
+};
+
+typedef std::shared_ptr<CaptureBufferPool> CaptureBufferPoolRef;
+
+
+// Called with the buffer when the last holder of an image goes away.
+typedef std::function<void(const CaptureBufferRef&)> CaptureBufferRecycler;
+
+
+// evfClockMicros() times of a download to memory
+typedef struct _CAPTURE_TIMING
+{
+	EdsUInt64	requestMicros;			// DirItemRequestTransfer handled
+	EdsUInt64	downloadStartMicros;	// EdsDownload called
+	EdsUInt64	downloadEndMicros;		// EdsDownloadComplete returned
+}CAPTURE_TIMING;
+
+
+// A full-size file downloaded into memory, with its directory item info.
+// The bytes can be handed out without copying for the image's lifetime.
+class CapturedImage
+{
+private:
+	EdsDirectoryItemInfo	_info;
+	CaptureBufferRef		_buffer;
+	EdsUInt64				_length;
+	CaptureBufferRecycler	_recycler;
+	// Order of downloads on the model, from 1
+	EdsUInt64				_sequence;
+	CAPTURE_TIMING			_timing;
+
+	CapturedImage(const CapturedImage&);
+	CapturedImage& operator=(const CapturedImage&);
+
+public:
+	CapturedImage(const EdsDirectoryItemInfo& info, const CaptureBufferRef& buffer, EdsUInt64 length, const CaptureBufferRecycler& recycler)
+		: _info(info), _buffer(buffer), _length(length), _recycler(recycler), _sequence(0)
+	{
+		memset(&_timing, 0, sizeof(_timing));
+	}
+
+	~CapturedImage()
+	{
+		if(_recycler)
+		{
+			_recycler(_buffer);
+		}
+	}
+
+	const EdsDirectoryItemInfo& getInfo() const	{ return _info; }
+	const EdsChar* getFileName() const			{ return _info.szFileName; }
+	EdsUInt32 getFormat() const					{ return _info.format; }
+	EdsUInt32 getGroupID() const				{ return _info.groupID; }
+	EdsUInt32 getDateTime() const				{ return _info.dateTime; }
+
+	const unsigned char* getData() const		{ return (_buffer && !_buffer->empty()) ? &(*_buffer)[0] : NULL; }
+	EdsUInt64 getLength() const					{ return _length; }
+
+	void setSequence(EdsUInt64 sequence)		{ _sequence = sequence; }
+	EdsUInt64 getSequence() const				{ return _sequence; }
+
+	void setTiming(const CAPTURE_TIMING& timing)	{ _timing = timing; }
+	const CAPTURE_TIMING& getTiming() const		{ return _timing; }
+};
+
+typedef std::shared_ptr<CapturedImage> CapturedImageRef;
+
+// Sees each image before it is queued, on the downloading thread. True
+// when it took the image and it should not be queued.
+typedef std::function<bool(const CapturedImageRef&)> CaptureTap;
+
+
+// Memory downloads waiting to be picked up. When full, the oldest image is
+// dropped so a reader that stopped polling can not hold every shot.
+class CaptureQueue
+{
+public:
+	enum { kDefaultLimit = 16 };
+
+private:
+	std::deque<CapturedImageRef>	_images;
+	EdsUInt32						_limit;
+	EdsUInt64						_sequence;
+	EdsUInt64						_dropped;
+	std::shared_ptr<CaptureTap>		_tap;
+	std::mutex						_mutex;
+	std::condition_variable			_condition;
+
+public:
+	CaptureQueue(EdsUInt32 limit = kDefaultLimit) : _limit(limit > 0 ? limit : 1), _sequence(0), _dropped(0) {}
+
+	void push(const CapturedImageRef& image)
+	{
+		std::shared_ptr<CaptureTap> tap;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			image->setSequence(++_sequence);
+			tap = _tap;
+		}
+		// Outside the lock, the tap may take its time
+		if(tap && (*tap)(image))
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_images.push_back(image);
+			while(_images.size() > _limit)
+			{
+				_images.pop_front();
+				_dropped++;
+			}
+		}
+		_condition.notify_all();
+	}
+
+	// Oldest waiting image, or empty on timeout.
+	CapturedImageRef pop(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if(!_condition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [this]() { return !_images.empty(); }))
+		{
+			return CapturedImageRef();
+		}
+
+		CapturedImageRef image = _images.front();
+		_images.pop_front();
+		return image;
+	}
+
+	void setLimit(EdsUInt32 limit)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_limit = (limit > 0) ? limit : 1;
+		while(_images.size() > _limit)
+		{
+			_images.pop_front();
+			_dropped++;
+		}
+	}
+
+	// An empty tap removes it
+	void setTap(const CaptureTap& tap)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_tap = tap ? std::make_shared<CaptureTap>(tap) : std::shared_ptr<CaptureTap>();
+	}
+
+	EdsUInt32 getLimit()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _limit;
+	}
+
+	EdsUInt32 size()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return (EdsUInt32)_images.size();
+	}
+
+	EdsUInt64 getDropped()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _dropped;
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_images.clear();
+	}
+};
@@ -0,0 +1,707 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : CardImport.h                                                    *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "CameraController.h"
+#include "DownloadPipeline.h"
+#include "DownloadSink.h"
+#include "StorageIndex.h"
+#include "XxHash64.h"
+#include "EDSDK.h"
+
+
+// One imported file, a line of the journal
+typedef struct _IMPORT_JOURNAL_ENTRY
+{
+	std::string		source;		// storage path, "CF/DCIM/100CANON/IMG_0001.JPG"
+	EdsUInt32		dateTime;
+	EdsUInt64		size;
+	EdsUInt64		hash;		// XXH64 of the contents
+	std::string		localPath;	// relative to the import directory
+}IMPORT_JOURNAL_ENTRY;
+
+
+// Append-only record of the files an import has finished. Each entry is
+// flushed as the file lands, so after a crash the journal lists exactly the
+// files that are complete on disk; a line cut short is ignored. Later lines
+// for the same source replace earlier ones. Not thread-safe.
+class ImportJournal
+{
+private:
+	FILE*									_file;
+	std::string								_path;
+	std::map<std::string, IMPORT_JOURNAL_ENTRY>	_bySource;
+	// "name|size|dateTime" to sources
+	std::map<std::string, std::string>		_byShot;
+
+	ImportJournal(const ImportJournal&);
+	ImportJournal& operator=(const ImportJournal&);
+
+	static std::string fileName(const std::string& path)
+	{
+		std::string::size_type slash = path.find_last_of("/\\");
+		return (slash == std::string::npos) ? path : path.substr(slash + 1);
+	}
+
+	void add(const IMPORT_JOURNAL_ENTRY& entry)
+	{
+		_bySource[entry.source] = entry;
+		_byShot[shotKey(fileName(entry.source), entry.size, entry.dateTime)] = entry.source;
+	}
+
+public:
+	ImportJournal() : _file(NULL) {}
+
+	~ImportJournal()
+	{
+		close();
+	}
+
+	static std::string shotKey(const std::string& name, EdsUInt64 size, EdsUInt32 dateTime)
+	{
+		return name + "|" + std::to_string(size) + "|" + std::to_string(dateTime);
+	}
+
+	bool isOpen() const					{ return _file != NULL; }
+	const std::string& getPath() const	{ return _path; }
+	size_t size() const					{ return _bySource.size(); }
+
+	// Reads what is there and opens it for appending; creates it if missing
+	bool open(const std::string& path)
+	{
+		close();
+		_path = path;
+		_bySource.clear();
+		_byShot.clear();
+
+		bool terminated = true;
+		FILE* existing = fopen(path.c_str(), "rb");
+		if(existing != NULL)
+		{
+			char line[4096];
+			while(fgets(line, sizeof(line), existing) != NULL)
+			{
+				size_t length = strlen(line);
+				terminated = (length > 0 && line[length - 1] == '\n');
+				if(!terminated)
+				{
+					continue;
+				}
+				line[--length] = '\0';
+
+				// source, dateTime, size, hash, localPath
+				char* fields[5];
+				int count = 0;
+				char* field = line;
+				for(; count < 5 && field != NULL; count++)
+				{
+					fields[count] = field;
+					field = strchr(field, '\t');
+					if(field != NULL)
+					{
+						*field++ = '\0';
+					}
+				}
+				if(count == 5 && field == NULL && fields[0][0] != '\0')
+				{
+					IMPORT_JOURNAL_ENTRY entry;
+					entry.source = fields[0];
+					entry.dateTime = (EdsUInt32)strtoul(fields[1], NULL, 10);
+					entry.size = strtoull(fields[2], NULL, 10);
+					entry.hash = strtoull(fields[3], NULL, 16);
+					entry.localPath = fields[4];
+					add(entry);
+				}
+			}
+			fclose(existing);
+		}
+
+		_file = fopen(path.c_str(), "ab");
+		if(_file != NULL && !terminated)
+		{
+			// Keep the next entry off the end of a line cut short
+			fputc('\n', _file);
+		}
+		return _file != NULL;
+	}
+
+	void close()
+	{
+		if(_file != NULL)
+		{
+			fclose(_file);
+			_file = NULL;
+		}
+	}
+
+	const IMPORT_JOURNAL_ENTRY* find(const std::string& source) const
+	{
+		std::map<std::string, IMPORT_JOURNAL_ENTRY>::const_iterator it = _bySource.find(source);
+		return (it != _bySource.end()) ? &it->second : NULL;
+	}
+
+	// The same shot imported from another card or folder
+	const IMPORT_JOURNAL_ENTRY* findShot(const std::string& name, EdsUInt64 size, EdsUInt32 dateTime) const
+	{
+		std::map<std::string, std::string>::const_iterator it = _byShot.find(shotKey(name, size, dateTime));
+		return (it != _byShot.end()) ? find(it->second) : NULL;
+	}
+
+	bool record(const IMPORT_JOURNAL_ENTRY& entry)
+	{
+		if(_file == NULL)
+		{
+			return false;
+		}
+		bool written = fprintf(_file, "%s\t%u\t%llu\t%016llx\t%s\n", entry.source.c_str(), (unsigned)entry.dateTime,
+			(unsigned long long)entry.size, (unsigned long long)entry.hash, entry.localPath.c_str()) > 0;
+		written = (fflush(_file) == 0) && written;
+		if(written)
+		{
+			add(entry);
+		}
+		return written;
+	}
+};
+
+
+typedef struct _CARD_IMPORT_STATISTICS
+{
+	EdsUInt64	files;				// given to start()
+	EdsUInt64	pending;			// queued, not yet finished
+	EdsUInt64	imported;
+	EdsUInt64	skipped;			// already in the directory
+	EdsUInt64	duplicates;			// the same shot from another card or folder
+	EdsUInt64	failed;
+	EdsUInt64	cancelled;
+	EdsUInt64	bytes;				// transferred from the camera
+	EdsUInt64	skippedBytes;		// not transferred, skipped or duplicate
+	EdsUInt64	transferMicros;		// downloading, on the transfer thread
+	EdsUInt64	elapsedMicros;		// since the first start(), to the last file
+	EdsUInt64	bytesPerSecond;		// bytes over elapsedMicros
+}CARD_IMPORT_STATISTICS;
+
+enum CardImportResult
+{
+	kCardImport_Imported = 0,
+	kCardImport_Skipped,
+	kCardImport_Duplicate,
+	kCardImport_Failed,
+	kCardImport_Cancelled,
+};
+
+// Told for every file once it is settled, with where it is on disk. Runs
+// on the transfer thread, or in start() for files that need no transfer.
+typedef std::function<void(const StorageItemRef& item, CardImportResult result, EdsError err, const std::string& path)> CardImportHandler;
+
+
+// Copies files off the cards into a directory, resuming where an earlier
+// import stopped. A file is skipped when the journal or the directory
+// already has it at the same size, and a shot already imported from the
+// other card (the same name, size and time) is not transferred twice.
+//
+// The queued files run back to back on the transfer worker, each pulled in
+// chunks through a DownloadPipeline that writes and hashes one chunk while
+// the next is transferred. A file is written as "name.part" and renamed
+// only once complete, then journaled with its hash; so an interrupted
+// import loses at most the file in flight.
+class CardImport : public std::enable_shared_from_this<CardImport>
+{
+private:
+	// Writes the file being imported and hashes it on the way
+	class ImportSink : public DownloadSink
+	{
+	private:
+		std::string		_path;
+		FILE*			_file;
+		XxHash64		_hasher;
+		EdsUInt64		_digest;
+
+	public:
+		ImportSink() : _file(NULL), _digest(0) {}
+
+		virtual ~ImportSink()
+		{
+			end(false);
+		}
+
+		// Before each download, on the transfer thread
+		void setPath(const std::string& path)	{ _path = path; }
+		EdsUInt64 getDigest() const				{ return _digest; }
+
+		virtual bool begin(CameraModel*, const EdsDirectoryItemInfo&)
+		{
+			_hasher.reset();
+			_digest = 0;
+			_file = fopen(_path.c_str(), "wb");
+			return _file != NULL;
+		}
+
+		virtual bool write(const unsigned char* data, size_t length)
+		{
+			_hasher.update(data, length);
+			return _file != NULL && fwrite(data, 1, length, _file) == length;
+		}
+
+		virtual void end(bool success)
+		{
+			if(_file != NULL)
+			{
+				success = (fclose(_file) == 0) && success;
+				_file = NULL;
+				_digest = success ? _hasher.digest() : 0;
+			}
+		}
+	};
+
+	// One file on the transfer worker
+	class FileCommand : public Command
+	{
+	private:
+		std::shared_ptr<CardImport>	_import;
+		StorageItemRef				_item;
+		EdsUInt64					_transferredBytes;
+
+	public:
+		FileCommand(const std::shared_ptr<CardImport>& import, const StorageItemRef& item)
+			: Command(import->_model), _import(import), _item(item), _transferredBytes(0) {}
+
+		virtual bool isTransfer() const {return true;}
+
+		virtual EdsUInt64 getTransferredBytes() const {return _transferredBytes;}
+
+		virtual const char* getName() const {return "ImportFile";}
+
+		virtual bool execute()
+		{
+			EdsError err = _import->importFile(_item, _transferredBytes);
+
+			// It retries it at device busy
+			if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+			{
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
+				_model->notifyObservers(&e);
+				return false;
+			}
+
+			_error = err;
+			return true;
+		}
+	};
+
+	typedef struct _SETTLED
+	{
+		StorageItemRef		item;
+		CardImportResult	result;
+		EdsError			error;
+		std::string			path;
+	}SETTLED;
+
+	CameraController*			_controller;
+	CameraModel*				_model;
+	std::string					_directory;
+	std::string					_journalPath;
+	bool						_keepFolders;
+	bool						_verifyExisting;
+	CardImportHandler			_handler;
+
+	ImportJournal				_journal;
+	DownloadPipelineRef			_pipeline;
+	std::shared_ptr<ImportSink>	_sink;
+	// Shots queued in this import, for the duplicates waiting on them
+	std::map<std::string, std::vector<StorageItemRef> >	_waiting;
+
+	CARD_IMPORT_STATISTICS		_stats;
+	EdsUInt64					_startMicros;
+	EdsUInt64					_lastMicros;
+	bool						_cancelled;
+	std::mutex					_mutex;
+	std::condition_variable		_settledCondition;
+
+	CardImport(const CardImport&);
+	CardImport& operator=(const CardImport&);
+
+	static std::string join(const std::string& directory, const std::string& path)
+	{
+		if(directory.empty())
+		{
+			return path;
+		}
+		char last = directory[directory.size() - 1];
+		return (last == '/' || last == '\\') ? directory + path : directory + "/" + path;
+	}
+
+	static bool fileSize(const std::string& path, EdsUInt64& outSize)
+	{
+#ifdef _WIN32
+		struct _stat64 info;
+		if(_stat64(path.c_str(), &info) != 0)
+#else
+		struct stat info;
+		if(stat(path.c_str(), &info) != 0)
+#endif
+		{
+			return false;
+		}
+		outSize = (EdsUInt64)info.st_size;
+		return true;
+	}
+
+	static bool hashFile(const std::string& path, EdsUInt64& outHash)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if(file == NULL)
+		{
+			return false;
+		}
+		XxHash64 hasher;
+		std::vector<unsigned char> buffer(1024 * 1024);
+		size_t length = 0;
+		while((length = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+		{
+			hasher.update(&buffer[0], length);
+		}
+		bool ok = (ferror(file) == 0);
+		fclose(file);
+		outHash = hasher.digest();
+		return ok;
+	}
+
+	static void createDirectories(const std::string& path)
+	{
+		for(std::string::size_type i = 1; i < path.size(); i++)
+		{
+			if((path[i] == '\\' || path[i] == '/') && path[i - 1] != ':')
+			{
+#ifdef _WIN32
+				_mkdir(path.substr(0, i).c_str());
+#else
+				mkdir(path.substr(0, i).c_str(), 0777);
+#endif
+			}
+		}
+	}
+
+	static bool replaceFile(const std::string& from, const std::string& to)
+	{
+		// rename() will not overwrite on Windows
+		remove(to.c_str());
+		return rename(from.c_str(), to.c_str()) == 0;
+	}
+
+	std::string localPathOf(const StorageItemRef& item) const
+	{
+		return _keepFolders ? item->getPath() : std::string(item->getFileName());
+	}
+
+	// Mutex held. Whether an earlier import's file is still there intact.
+	bool present(const IMPORT_JOURNAL_ENTRY& entry) const
+	{
+		EdsUInt64 size = 0;
+		EdsUInt64 hash = 0;
+		std::string path = join(_directory, entry.localPath);
+		if(!fileSize(path, size) || size != entry.size)
+		{
+			return false;
+		}
+		return !_verifyExisting || (hashFile(path, hash) && hash == entry.hash);
+	}
+
+	// Mutex held
+	IMPORT_JOURNAL_ENTRY entryFor(const StorageItemRef& item, EdsUInt64 hash, const std::string& localPath) const
+	{
+		IMPORT_JOURNAL_ENTRY entry;
+		entry.source = item->getPath();
+		entry.dateTime = item->getDateTime();
+		entry.size = item->getSize();
+		entry.hash = hash;
+		entry.localPath = localPath;
+		return entry;
+	}
+
+	// Mutex held
+	void settle(const StorageItemRef& item, CardImportResult result, EdsError err, const std::string& localPath, std::vector<SETTLED>& out)
+	{
+		switch(result)
+		{
+			case kCardImport_Imported:	_stats.imported++; break;
+			case kCardImport_Skipped:	_stats.skipped++; _stats.skippedBytes += item->getSize(); break;
+			case kCardImport_Duplicate:	_stats.duplicates++; _stats.skippedBytes += item->getSize(); break;
+			case kCardImport_Failed:	_stats.failed++; break;
+			case kCardImport_Cancelled:	_stats.cancelled++; break;
+		}
+		_lastMicros = evfClockMicros();
+
+		SETTLED settled;
+		settled.item = item;
+		settled.result = result;
+		settled.error = err;
+		settled.path = localPath.empty() ? localPath : join(_directory, localPath);
+		out.push_back(settled);
+	}
+
+	void tell(const std::vector<SETTLED>& settled)
+	{
+		CardImportHandler handler;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			handler = _handler;
+		}
+		for(size_t i = 0; handler && i < settled.size(); i++)
+		{
+			handler(settled[i].item, settled[i].result, settled[i].error, settled[i].path);
+		}
+	}
+
+	// On the transfer thread
+	EdsError importFile(const StorageItemRef& item, EdsUInt64& outTransferred)
+	{
+		EdsError err = EDS_ERR_OK;
+		std::string localPath = localPathOf(item);
+		std::string path = join(_directory, localPath);
+		std::string partial = path + ".part";
+		std::vector<SETTLED> settled;
+		bool cancelled = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			cancelled = _cancelled;
+		}
+
+		EdsUInt64 started = evfClockMicros();
+		if(!cancelled)
+		{
+			createDirectories(path);
+			_sink->setPath(partial);
+			err = _pipeline->download(_model, item->getRef(), item->getInfo());
+		}
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			remove(partial.c_str());
+			return err;
+		}
+
+		std::string shot = ImportJournal::shotKey(item->getFileName(), item->getSize(), item->getDateTime());
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::vector<StorageItemRef> waiting;
+			waiting.swap(_waiting[shot]);
+			_waiting.erase(shot);
+
+			if(cancelled)
+			{
+				err = EDS_ERR_OPERATION_CANCELLED;
+				settle(item, kCardImport_Cancelled, err, std::string(), settled);
+			}
+			else
+			{
+				_stats.transferMicros += evfClockMicros() - started;
+				EdsUInt64 hash = _sink->getDigest();
+
+				if(err == EDS_ERR_OK && !replaceFile(partial, path))
+				{
+					err = EDS_ERR_FILE_WRITE_ERROR;
+				}
+
+				if(err == EDS_ERR_OK && !_journal.record(entryFor(item, hash, localPath)))
+				{
+					err = EDS_ERR_FILE_WRITE_ERROR;
+				}
+
+				if(err == EDS_ERR_OK)
+				{
+					outTransferred = item->getSize();
+					_stats.bytes += item->getSize();
+					settle(item, kCardImport_Imported, err, localPath, settled);
+				}
+				else
+				{
+					remove(partial.c_str());
+					settle(item, kCardImport_Failed, err, std::string(), settled);
+				}
+			}
+
+			// The copies on the other card share the outcome
+			for(size_t i = 0; i < waiting.size(); i++)
+			{
+				if(err == EDS_ERR_OK && _journal.record(entryFor(waiting[i], _sink->getDigest(), localPath)))
+				{
+					settle(waiting[i], kCardImport_Duplicate, err, localPath, settled);
+				}
+				else
+				{
+					settle(waiting[i], cancelled ? kCardImport_Cancelled : kCardImport_Failed, err, std::string(), settled);
+				}
+			}
+			_stats.pending -= std::min<EdsUInt64>(_stats.pending, 1 + waiting.size());
+		}
+
+		tell(settled);
+		_settledCondition.notify_all();
+		return err;
+	}
+
+public:
+	// Into directory, journaled in journalPath, by default "import.journal" there
+	CardImport(CameraController* controller, const std::string& directory, const std::string& journalPath = std::string())
+		: _controller(controller), _model(controller->getCameraModel()), _directory(directory),
+		  _journalPath(journalPath.empty() ? join(directory, "import.journal") : journalPath),
+		  _keepFolders(true), _verifyExisting(false), _startMicros(0), _lastMicros(0), _cancelled(false)
+	{
+		memset(&_stats, 0, sizeof(_stats));
+		_pipeline = std::make_shared<DownloadPipeline>();
+		_sink = std::make_shared<ImportSink>();
+		_pipeline->addSink(_sink);
+	}
+
+	virtual ~CardImport()
+	{
+		_pipeline->stop();
+	}
+
+	const std::string& getDirectory() const		{ return _directory; }
+	const std::string& getJournalPath() const	{ return _journalPath; }
+
+	// Files go to "CF/DCIM/100CANON/IMG_0001.JPG" below the directory, or
+	// straight into it without the folders
+	void setKeepFolders(bool keepFolders)		{ std::lock_guard<std::mutex> lock(_mutex); _keepFolders = keepFolders; }
+	// Rehash files the journal lists before skipping them, not just the size
+	void setVerifyExisting(bool verify)			{ std::lock_guard<std::mutex> lock(_mutex); _verifyExisting = verify; }
+	void setHandler(const CardImportHandler& handler)	{ std::lock_guard<std::mutex> lock(_mutex); _handler = handler; }
+	// Chunk size of the downloads; see DownloadPipeline
+	void setChunkSize(EdsUInt32 chunkSize)		{ _pipeline->setChunkSize(chunkSize); }
+
+	// Settles what is already imported and queues the rest. Can be called
+	// again with more items while files are still in flight.
+	EdsError start(const StorageItemList& items)
+	{
+		std::vector<SETTLED> settled;
+		std::vector<StorageItemRef> queue;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			createDirectories(_journalPath);
+			if(!_journal.isOpen() && !_journal.open(_journalPath))
+			{
+				return EDS_ERR_FILE_OPEN_ERROR;
+			}
+			if(_startMicros == 0)
+			{
+				_startMicros = evfClockMicros();
+			}
+			_cancelled = false;
+
+			for(size_t i = 0; i < items.size(); i++)
+			{
+				const StorageItemRef& item = items[i];
+				if(!item || item->isFolder())
+				{
+					continue;
+				}
+				_stats.files++;
+
+				std::string localPath = localPathOf(item);
+				std::string shot = ImportJournal::shotKey(item->getFileName(), item->getSize(), item->getDateTime());
+				const IMPORT_JOURNAL_ENTRY* entry = _journal.find(item->getPath());
+				const IMPORT_JOURNAL_ENTRY* copy = _journal.findShot(item->getFileName(), item->getSize(), item->getDateTime());
+				EdsUInt64 size = 0;
+				EdsUInt64 hash = 0;
+
+				if(entry != NULL && entry->size == item->getSize() && entry->dateTime == item->getDateTime() && present(*entry))
+				{
+					settle(item, kCardImport_Skipped, EDS_ERR_OK, entry->localPath, settled);
+				}
+				else if(copy != NULL && present(*copy) && _journal.record(entryFor(item, copy->hash, copy->localPath)))
+				{
+					settle(item, kCardImport_Duplicate, EDS_ERR_OK, copy->localPath, settled);
+				}
+				// Copied in some other way: adopted into the journal
+				else if(entry == NULL && fileSize(join(_directory, localPath), size) && size == item->getSize()
+					&& hashFile(join(_directory, localPath), hash) && _journal.record(entryFor(item, hash, localPath)))
+				{
+					settle(item, kCardImport_Skipped, EDS_ERR_OK, localPath, settled);
+				}
+				else if(_waiting.count(shot) != 0)
+				{
+					_waiting[shot].push_back(item);
+					_stats.pending++;
+				}
+				else
+				{
+					_waiting[shot];
+					queue.push_back(item);
+					_stats.pending++;
+				}
+			}
+		}
+
+		tell(settled);
+		std::shared_ptr<CardImport> self = shared_from_this();
+		for(size_t i = 0; i < queue.size(); i++)
+		{
+			_controller->enqueue(new FileCommand(self, queue[i]));
+		}
+		_settledCondition.notify_all();
+		return EDS_ERR_OK;
+	}
+
+	// True once every queued file is settled; timeoutMs < 0 waits for good
+	bool wait(int timeoutMs = -1)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if(timeoutMs < 0)
+		{
+			_settledCondition.wait(lock, [this]() { return _stats.pending == 0; });
+			return true;
+		}
+		return _settledCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return _stats.pending == 0; });
+	}
+
+	// Files not yet started finish as cancelled without a transfer
+	void cancel()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_cancelled = true;
+	}
+
+	CARD_IMPORT_STATISTICS getStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		CARD_IMPORT_STATISTICS stats = _stats;
+		EdsUInt64 end = (_stats.pending > 0) ? evfClockMicros() : _lastMicros;
+		stats.elapsedMicros = (_startMicros != 0 && end > _startMicros) ? end - _startMicros : 0;
+		stats.bytesPerSecond = (stats.elapsedMicros > 0) ? (EdsUInt64)((double)stats.bytes * 1000000.0 / stats.elapsedMicros) : 0;
+		return stats;
+	}
+
+	size_t getJournalSize()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _journal.size();
+	}
+};
+
+typedef std::shared_ptr<CardImport> CardImportRef;
@@ -27,19 +27,29 @@ public:
 	CloseSessionCommand(CameraModel *model) : Command(model){}
 
 
+	virtual const char* getName() const {return "CloseSession";}
+
 	//Execute command	
 	virtual bool execute()
 	{
 		EdsError err = EDS_ERR_OK;
+
+		// Item references are only good within the session
+		_model->getStorageIndex()->clear();
 	
 		//The communication with the camera is ended
-		err = EdsCloseSession(_model->getCameraObject());
+		{
+			TraceScope trace("EDSDK", "EdsCloseSession");
+			err = EdsCloseSession(_model->getCameraObject());
+			trace.setArg("error", err);
+		}
 
 
 		//Notification of error
 		if(err != EDS_ERR_OK)
 		{
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
@@ -16,7 +16,32 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include  "CameraModel.h"
+#include "CommandHandle.h"
+#include "Trace.h"
+
+// Lanes of the command processor, highest priority first
+enum CommandPriority
+{
+	kCommandPriority_Realtime = 0,		// Shutter and live view
+	kCommandPriority_Normal,			// Settings and session control
+	kCommandPriority_Background,		// Property and desc refresh
+	kCommandPriority_Count
+};
+
+// Kinds of command that can be merged while one is already pending
+enum CommandCoalesceKind
+{
+	kCommandCoalesce_None = 0,
+	kCommandCoalesce_Property,
+	kCommandCoalesce_PropertyDesc
+};
+
+// Told once when the processor is done with a command: true when it ran to
+// completion, false when it was dropped without (queue cleared or purged)
+typedef std::function<void(bool executed)> CommandCompletion;
 
 class Command {
 
@@ -24,11 +49,107 @@ protected:
 	// Camera Model
 	CameraModel* _model;
 
+	// Time the command was put into the queue
+	std::chrono::steady_clock::time_point _enqueueTime;
+
+	CommandCompletion _completion;
+
+	// Error of the current execute(), for the handle
+	EdsError _error;
+
+	CommandHandleRef _handle;
+
+	// execute() calls so far, and when the first one started
+	EdsUInt32 _executions;
+	std::chrono::steady_clock::time_point _firstExecuteTime;
+
 public:
-	Command(CameraModel *model) : _model(model) {}
+	Command(CameraModel *model) : _model(model), _error(EDS_ERR_OK), _executions(0) {}
+
+	virtual ~Command() {complete(false);}
 
 	CameraModel* getCameraModel(){return _model;}
 
+	// Kind of command in metrics and traces, a string literal
+	virtual const char* getName() const {return "Command";}
+
+	// Lane the command is queued in when no priority is given to enqueue()
+	virtual CommandPriority getPriority() const {return kCommandPriority_Normal;}
+
+	// Commands with the same non-zero key are merged while one of them is pending
+	virtual EdsUInt64 getCoalesceKey() const {return 0;}
+
+	static EdsUInt64 makeCoalesceKey(CommandCoalesceKind kind, EdsUInt32 id)
+	{
+		return ((EdsUInt64)kind << 32) | id;
+	}
+
+	// Image transfers run on the transfer processor, apart from camera control
+	virtual bool isTransfer() const {return false;}
+
+	// Bytes moved by the last execute()
+	virtual EdsUInt64 getTransferredBytes() const {return 0;}
+
+	void setEnqueueTime(std::chrono::steady_clock::time_point time){_enqueueTime = time;}
+	std::chrono::steady_clock::time_point getEnqueueTime() const {return _enqueueTime;}
+
+	// Called on the processor thread. A command with a completion is never
+	// merged into a pending one, so every waiter is told about its own run.
+	void setCompletion(const CommandCompletion& completion){_completion = completion;}
+	bool hasCompletion() const {return (bool)_completion;}
+
+	// Created when first asked for, normally by enqueue()
+	CommandHandleRef getHandle()
+	{
+		if(!_handle)
+		{
+			_handle = std::make_shared<CommandHandle>();
+		}
+		return _handle;
+	}
+
+	EdsError getError() const {return _error;}
+
+	EdsUInt32 getExecutions() const {return _executions;}
+	std::chrono::steady_clock::time_point getFirstExecuteTime() const {return _firstExecuteTime;}
+
+	// Processor side, around each execute()
+	void beginExecute()
+	{
+		if(_executions++ == 0)
+		{
+			_firstExecuteTime = std::chrono::steady_clock::now();
+		}
+		_error = EDS_ERR_OK;
+		if(_handle)
+		{
+			_handle->executing();
+		}
+	}
+
+	void retrying()
+	{
+		if(_handle)
+		{
+			_handle->retrying(_error);
+		}
+	}
+
+	void complete(bool executed)
+	{
+		if(_handle)
+		{
+			_handle->finish(executed ? kCommandStatus_Completed : kCommandStatus_Dropped, _error);
+		}
+
+		if(_completion)
+		{
+			CommandCompletion completion;
+			completion.swap(_completion);
+			completion(executed);
+		}
+	}
+
 	// Execute command	
 	virtual bool execute() = 0;
 };
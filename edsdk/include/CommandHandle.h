@@ -0,0 +1,144 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : CommandHandle.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EDSDK.h"
+#include "EvfFrame.h"
+
+
+enum CommandStatus
+{
+	kCommandStatus_Pending = 0,		// Queued or parked for retry
+	kCommandStatus_Completed,		// Ran; see the error for the outcome
+	kCommandStatus_Dropped			// Discarded without completing
+};
+
+
+// Monotonic timestamps of one command, evfClockMicros() clock
+typedef struct _COMMAND_TIMING
+{
+	EdsUInt64				enqueueMicros;
+	EdsUInt64				firstExecuteMicros;
+	EdsUInt64				completeMicros;
+	EdsUInt32				executions;
+	// Start of each execute() after the first
+	std::vector<EdsUInt64>	retryMicros;
+}COMMAND_TIMING;
+
+
+// Outcome of an enqueued command, shared between the processor and anyone
+// waiting on it. Commands merged into a pending one share its handle.
+class CommandHandle
+{
+private:
+	std::mutex				_mutex;
+	std::condition_variable	_done;
+	CommandStatus			_status;
+	EdsError				_error;
+	COMMAND_TIMING			_timing;
+
+public:
+	CommandHandle() : _status(kCommandStatus_Pending), _error(EDS_ERR_OK)
+	{
+		_timing.enqueueMicros = evfClockMicros();
+		_timing.firstExecuteMicros = 0;
+		_timing.completeMicros = 0;
+		_timing.executions = 0;
+	}
+
+	CommandStatus getStatus()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _status;
+	}
+
+	// Error of the last execute(), EDS_ERR_OK while pending
+	EdsError getError()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _error;
+	}
+
+	bool isDone()
+	{
+		return getStatus() != kCommandStatus_Pending;
+	}
+
+	// Success means it ran and the camera accepted it
+	bool succeeded()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _status == kCommandStatus_Completed && _error == EDS_ERR_OK;
+	}
+
+	COMMAND_TIMING getTiming()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _timing;
+	}
+
+	// Block until it completes or is dropped; negative waits forever.
+	// False on timeout.
+	bool wait(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if(millisec < 0)
+		{
+			_done.wait(lock, [this]() { return _status != kCommandStatus_Pending; });
+			return true;
+		}
+		return _done.wait_for(lock, std::chrono::milliseconds(millisec), [this]() { return _status != kCommandStatus_Pending; });
+	}
+
+	// Processor side
+	void executing()
+	{
+		EdsUInt64 now = evfClockMicros();
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_timing.executions++ == 0)
+		{
+			_timing.firstExecuteMicros = now;
+		}
+		else
+		{
+			_timing.retryMicros.push_back(now);
+		}
+	}
+
+	void retrying(EdsError error)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_error = error;
+	}
+
+	void finish(CommandStatus status, EdsError error)
+	{
+		EdsUInt64 now = evfClockMicros();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_status != kCommandStatus_Pending)
+			{
+				return;
+			}
+			_status = status;
+			_error = error;
+			_timing.completeMicros = now;
+		}
+		_done.notify_all();
+	}
+};
+
+typedef std::shared_ptr<CommandHandle> CommandHandleRef;
@@ -25,19 +25,24 @@ private:
 	EdsUInt32 _status;
 
 public:
-	DoEvfAFCommand(CameraModel *model, EdsUInt32 status) : _status(status), Command(model){}
+	DoEvfAFCommand(CameraModel *model, EdsUInt32 status) : Command(model), _status(status){}
 
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+
+	virtual const char* getName() const {return "DoEvfAF";}
 
 	// Execute command	
 	virtual bool execute()
 	{
 		EdsError err = EDS_ERR_OK;
-		bool	 locked = false;
 		
 		//EvfAFON
 		if(err == EDS_ERR_OK)
 		{
+			TraceScope trace("EDSDK", "EdsSendCommand");
 			err = EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_DoEvfAf, _status);
+			trace.setArg("error", err);
 		}
 
 		//Notification of error
@@ -46,12 +51,14 @@ public:
 			// It retries it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return true;
 			}
 			
-			CameraEvent e("error", &err); 
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err); 
 			_model->notifyObservers(&e);
 		}
 
@@ -17,16 +17,27 @@
 
 #include "Command.h"
 #include "CameraEvent.h"
+#include "CapturedImage.h"
+#include "DownloadPipeline.h"
+#include "TransferProgress.h"
 #include "EDSDK.h"
 
 class DownloadCommand : public Command
 {
 private:
 	EdsDirectoryItemRef _directoryItem;
+	EdsUInt64 _transferredBytes;
+	CAPTURE_TIMING _timing;
+	// In TransferProgressTracker, 0 before the transfer starts
+	EdsUInt64 _progressID;
 
 public:
 	DownloadCommand(CameraModel *model, EdsDirectoryItemRef dirItem) 
-			: _directoryItem(dirItem), Command(model){}
+			: Command(model), _directoryItem(dirItem), _transferredBytes(0), _progressID(0)
+	{
+		memset(&_timing, 0, sizeof(_timing));
+		_timing.requestMicros = evfClockMicros();
+	}
 
 
 	virtual ~DownloadCommand()
@@ -40,46 +51,105 @@ public:
 	}
 
 
+	virtual bool isTransfer() const {return true;}
+
+	virtual EdsUInt64 getTransferredBytes() const {return _transferredBytes;}
+
+	virtual const char* getName() const {return "Download";}
+
 	// Execute command 	
 	virtual bool execute()
 	{
 		EdsError				err = EDS_ERR_OK;
 		EdsStreamRef			stream = NULL;
+		CaptureBufferRef		buffer;
+		bool					toMemory = (_model->getDownloadTarget() == kDownloadTarget_Memory);
+		DownloadPipelineRef		pipeline = (_model->getDownloadTarget() == kDownloadTarget_Pipeline) ? _model->getDownloadPipeline() : DownloadPipelineRef();
+		bool					downloaded = false;
 
 		//Acquisition of the downloaded image information
 		EdsDirectoryItemInfo	dirItemInfo;
-		err = EdsGetDirectoryItemInfo( _directoryItem, &dirItemInfo);
+		{
+			TraceScope trace("EDSDK", "EdsGetDirectoryItemInfo");
+			err = EdsGetDirectoryItemInfo( _directoryItem, &dirItemInfo);
+			trace.setArg("error", err);
+		}
 	
 		// Forwarding beginning notification	
 		if(err == EDS_ERR_OK)
 		{
-			CameraEvent e("DownloadStart");
+			const char* camera = _model->getSerialNumber();
+			_progressID = TransferProgressTracker::instance().begin(_model, (camera[0] != '\0') ? camera : _model->getModelName(), dirItemInfo);
+
+			CameraEvent e(kCameraEvent_DownloadStart);
 			_model->notifyObservers(&e);
 		}
 
+		//Download in chunks through the pipeline's sinks
+		if(err == EDS_ERR_OK && pipeline)
+		{
+			err = pipeline->download(_model, _directoryItem, dirItemInfo, [this](EdsUInt32 percent)
+			{
+				EdsBool cancel = false;
+				ProgressFunc(percent, this, &cancel);
+				return !cancel;
+			});
+			downloaded = (err == EDS_ERR_OK);
+			_transferredBytes = downloaded ? dirItemInfo.size : 0;
+		}
+
 		//Make the file stream at the forwarding destination
-		if(err == EDS_ERR_OK)
+		if(err == EDS_ERR_OK && !toMemory && !pipeline)
 		{	
 			err = EdsCreateFileStream(dirItemInfo.szFileName, kEdsFileCreateDisposition_CreateAlways, kEdsAccess_ReadWrite, &stream);
 		}	
 
+		//Or a memory stream over a pooled buffer
+		if(err == EDS_ERR_OK && toMemory)
+		{
+			buffer = _model->getCaptureBufferPool()->acquire(dirItemInfo.size > 0 ? dirItemInfo.size : 1);
+			err = EdsCreateMemoryStreamFromPointer(&(*buffer)[0], buffer->size(), &stream);
+		}
+
 		//Set Progress
-		if(err == EDS_ERR_OK)
+		if(err == EDS_ERR_OK && stream != NULL)
 		{
 			err = EdsSetProgressCallback(stream, ProgressFunc, kEdsProgressOption_Periodically, this);
 		}
 
 
 		//Download image
-		if(err == EDS_ERR_OK)
+		if(err == EDS_ERR_OK && stream != NULL)
 		{
+			_timing.downloadStartMicros = evfClockMicros();
+			TraceScope trace("EDSDK", "EdsDownload");
 			err = EdsDownload( _directoryItem, dirItemInfo.size, stream);
+			trace.setArg("error", err);
+		}
+
+		//Cancelled from the progress callback
+		if(err == EDS_ERR_OPERATION_CANCELLED && stream != NULL)
+		{
+			EdsDownloadCancel( _directoryItem);
 		}
 
 		//Forwarding completion
-		if(err == EDS_ERR_OK)
+		if(err == EDS_ERR_OK && stream != NULL)
 		{
-			err = EdsDownloadComplete( _directoryItem);
+			{
+				TraceScope trace("EDSDK", "EdsDownloadComplete");
+				err = EdsDownloadComplete( _directoryItem);
+				trace.setArg("error", err);
+			}
+			downloaded = (err == EDS_ERR_OK);
+			_transferredBytes = downloaded ? dirItemInfo.size : 0;
+			_timing.downloadEndMicros = evfClockMicros();
+		}
+
+		if(_progressID != 0)
+		{
+			TransferProgressTracker::instance().end(_progressID, err);
+			_progressID = 0;
 		}
 
 		//Release Item
@@ -96,17 +166,39 @@ public:
 			stream = NULL;
 		}		
 		
+		//Hand the bytes over; the buffer goes back to the pool with the last reference
+		if(downloaded && toMemory)
+		{
+			std::weak_ptr<CaptureBufferPool> pool(_model->getCaptureBufferPool());
+			CapturedImageRef image = std::make_shared<CapturedImage>(dirItemInfo, buffer, dirItemInfo.size,
+				[pool](const CaptureBufferRef& released)
+				{
+					CaptureBufferPoolRef owner = pool.lock();
+					if(owner)
+					{
+						owner->release(released);
+					}
+				});
+			image->setTiming(_timing);
+			_model->getCaptureQueue()->push(image);
+		}
+		else if(buffer)
+		{
+			_model->getCaptureBufferPool()->release(buffer);
+		}
+
 		// Forwarding completion notification
 		if( err == EDS_ERR_OK)
 		{
-			CameraEvent e("DownloadComplete", &err);
+			CameraEvent e(kCameraEvent_DownloadComplete, &err);
 			_model->notifyObservers(&e);
 		}
 
 		//Notification of error
 		if( err != EDS_ERR_OK)
 		{
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
@@ -120,9 +212,20 @@ private:
 						EdsBool	*	outCancel
 						)
 	{
-		Command *command = (Command *)inContext;
-		CameraEvent e("ProgressReport", &inPercent);
-		command->getCameraModel()->notifyObservers(&e);
+		DownloadCommand *command = (DownloadCommand *)inContext;
+		TransferProgressTracker& tracker = TransferProgressTracker::instance();
+
+		// Only the ticks the tracker's rate allows, and always the last one
+		if(tracker.update(command->_progressID, inPercent))
+		{
+			CameraEvent e(kCameraEvent_ProgressReport, &inPercent);
+			command->getCameraModel()->notifyObservers(&e);
+		}
+
+		if(outCancel != NULL && tracker.isCancelled(command->_progressID))
+		{
+			*outCancel = true;
+		}
 		return EDS_ERR_OK;
 	}
 
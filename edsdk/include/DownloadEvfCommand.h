@@ -17,109 +17,150 @@
 
 #include "Command.h"
 #include "CameraEvent.h"
+#include "EvfFrame.h"
 #include "EDSDK.h"
 
 
-typedef struct _EVF_DATASET 
-{
-	EdsStreamRef	stream; // JPEG stream.
-	EdsUInt32		zoom;
-	EdsRect			zoomRect;
-	EdsPoint		imagePosition;
-	EdsUInt32		histogram[256 * 4]; //(YRGB) YRGBYRGBYRGBYRGB....
-	EdsSize			sizeJpegLarge;
-}EVF_DATASET;
-
-
 class DownloadEvfCommand : public Command
 {
 
 public:
 	DownloadEvfCommand(CameraModel *model) : Command(model){}
 
-    // Execute command	
-	virtual bool execute()
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+	// Download one live view image into a stream taken from the model's pool.
+	// outFrame is left empty unless EDS_ERR_OK is returned; the stream goes
+	// back to the pool when the last holder of the frame lets go.
+	static EdsError downloadFrame(CameraModel *model, EvfFrameRef& outFrame)
 	{
-	
 		EdsError err = EDS_ERR_OK;
+		EdsUInt64 downloadStart = evfClockMicros();
 
-		EdsEvfImageRef evfImage = NULL;
-		EdsStreamRef stream = NULL;
-		EdsUInt32 bufferSize = 2 * 1024 * 1024;
-
-		// Exit unless during live view.
-		if ((_model->getEvfOutputDevice() & kEdsEvfOutputDevice_PC) == 0)
-		{
-			return true;
-		}
-
-		// Create memory stream.
-		err = EdsCreateMemoryStream(bufferSize, &stream);
-
-		// When creating to a file.
-		// err = EdsCreateFileStream("C:\\test.jpg", kEdsFileCreateDisposition_CreateAlways, kEdsAccess_ReadWrite, &stream);
+		EvfStreamPoolRef pool = model->getEvfStreamPool();
+		EvfStreamSlotRef slot;
 
-
-		// Create EvfImageRef.
-		if (err == EDS_ERR_OK)
-		{
-			err = EdsCreateEvfImageRef(stream, &evfImage);
-		}
+		// Take a preallocated stream and EvfImageRef.
+		err = pool->acquire(slot);
 
 		// Download live view image data.
 		if (err == EDS_ERR_OK)
 		{
-			err = EdsDownloadEvfImage(_model->getCameraObject(), evfImage);
+			TraceScope trace("EDSDK", "EdsDownloadEvfImage");
+			err = EdsDownloadEvfImage(model->getCameraObject(), slot->getEvfImage());
+			trace.setArg("error", err);
 		}
 
 		// Get meta data for live view image data.
 		if (err == EDS_ERR_OK)
 		{
-			EVF_DATASET dataSet = {0};
+			EdsEvfImageRef evfImage = slot->getEvfImage();
+			EVF_DATASET dataSet = {};
+			EdsUInt64 length = 0;
 
-			dataSet.stream = stream;
+			dataSet.stream = slot->getStream();
+			dataSet.timing.downloadStart = downloadStart;
 
-			// Get magnification ratio (x1, x5, or x10).
-			EdsGetPropertyData(evfImage, kEdsPropID_Evf_Zoom, 0, sizeof(dataSet.zoom),  &dataSet.zoom);
+			// The stream wraps a fixed buffer, so the write position is the JPEG size.
+			EdsGetPosition(dataSet.stream, &length);
 
+			// Only the fields the model's metadata cache asks for are read;
+			// the others carry their last value or stay 0.
+			EvfMetadataCache& metadata = model->getEvfMetadata();
+			EdsUInt32 wanted = metadata.beginFrame();
+			EdsUInt32 read = 0;
+
+			// Get magnification ratio (x1, x5, or x10).
+			if((wanted & kEvfMetadata_Zoom) &&
+			   EdsGetPropertyData(evfImage, kEdsPropID_Evf_Zoom, 0, sizeof(dataSet.zoom),  &dataSet.zoom) == EDS_ERR_OK)
+			{
+				read |= kEvfMetadata_Zoom;
+			}
 
 			// Get position of image data. (when enlarging)
 			// Upper left coordinate using JPEG Large size as a reference.
-			EdsGetPropertyData(evfImage, kEdsPropID_Evf_ImagePosition, 0, sizeof(dataSet.imagePosition), &dataSet.imagePosition);
+			if((wanted & kEvfMetadata_ImagePosition) &&
+			   EdsGetPropertyData(evfImage, kEdsPropID_Evf_ImagePosition, 0, sizeof(dataSet.imagePosition), &dataSet.imagePosition) == EDS_ERR_OK)
+			{
+				read |= kEvfMetadata_ImagePosition;
+			}
 
 			// Get histogram (RGBY).
-			EdsGetPropertyData(evfImage, kEdsPropID_Evf_Histogram, 0, sizeof(dataSet.histogram), dataSet.histogram);
+			if((wanted & kEvfMetadata_Histogram) &&
+			   EdsGetPropertyData(evfImage, kEdsPropID_Evf_Histogram, 0, sizeof(dataSet.histogram), dataSet.histogram) == EDS_ERR_OK)
+			{
+				read |= kEvfMetadata_Histogram;
+			}
 
 			// Get rectangle of the focus border.
-			EdsGetPropertyData(evfImage, kEdsPropID_Evf_ZoomRect, 0, sizeof(dataSet.zoomRect), &dataSet.zoomRect);
+			if((wanted & kEvfMetadata_ZoomRect) &&
+			   EdsGetPropertyData(evfImage, kEdsPropID_Evf_ZoomRect, 0, sizeof(dataSet.zoomRect), &dataSet.zoomRect) == EDS_ERR_OK)
+			{
+				read |= kEvfMetadata_ZoomRect;
+			}
 
 			// Get the size as a reference of the coordinates of rectangle of the focus border.
-			EdsGetPropertyData(evfImage, kEdsPropID_Evf_CoordinateSystem, 0, sizeof(dataSet.sizeJpegLarge), &dataSet.sizeJpegLarge);
+			if((wanted & kEvfMetadata_CoordinateSystem) &&
+			   EdsGetPropertyData(evfImage, kEdsPropID_Evf_CoordinateSystem, 0, sizeof(dataSet.sizeJpegLarge), &dataSet.sizeJpegLarge) == EDS_ERR_OK)
+			{
+				read |= kEvfMetadata_CoordinateSystem;
+			}
 
-			// Set to model.
-			_model->setEvfZoom(dataSet.zoom);
-			_model->setEvfZoomPosition(dataSet.zoomRect.point);
-			_model->setEvfZoomRect(dataSet.zoomRect);
+			metadata.endFrame(dataSet, wanted, read);
 
-			// Live view image transfer complete notification.
-			if (err == EDS_ERR_OK)
+			// Set to model.
+			if(read & kEvfMetadata_Zoom)
+			{
+				model->setEvfZoom(dataSet.zoom);
+			}
+			if(read & kEvfMetadata_ZoomRect)
 			{
-				CameraEvent e("EvfDataChanged", &dataSet);
-				_model->notifyObservers(&e);		
+				model->setEvfZoomPosition(dataSet.zoomRect.point);
+				model->setEvfZoomRect(dataSet.zoomRect);
 			}
+
+			dataSet.timing.downloadEnd = evfClockMicros();
+
+			// The frame hands the slot back to the pool when released.
+			std::weak_ptr<EvfStreamPool> weakPool(pool);
+			outFrame = std::make_shared<EvfFrame>(dataSet, length, [weakPool, slot]()
+			{
+				EvfStreamPoolRef owner = weakPool.lock();
+				if(owner)
+				{
+					owner->release(slot);
+				}
+			});
+		}
+		else
+		{
+			pool->release(slot);
 		}
 
+		return err;
+	}
 
-		if(stream != NULL)
+	virtual const char* getName() const {return "DownloadEvf";}
+
+    // Execute command	
+	virtual bool execute()
+	{
+		// Exit unless during live view.
+		if ((_model->getEvfOutputDevice() & kEdsEvfOutputDevice_PC) == 0)
 		{
-			EdsRelease(stream);
-			stream = NULL;
+			return true;
 		}
-		
-		if(evfImage != NULL)
+
+		EvfFrameRef frame;
+		EdsError err = downloadFrame(_model, frame);
+
+		// Live view image transfer complete notification.
+		if (err == EDS_ERR_OK)
 		{
-			EdsRelease(evfImage);
-			evfImage = NULL;
+			_model->setEvfFrame(frame);
+
+			CameraEvent e(kCameraEvent_EvfDataChanged, const_cast<EVF_DATASET*>(&frame->getDataSet()));
+			_model->notifyObservers(&e);
 		}
          
 		//Notification of error
@@ -130,18 +171,21 @@ public:
 			// when the image data is not ready yet.
 			if(err == EDS_ERR_OBJECT_NOTREADY)
 			{
+				_error = err;
 				return false;
 			}
 
 			// It retries it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
@@ -0,0 +1,531 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : DownloadPipeline.h                                              *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Thread.h"
+#include "CameraModel.h"
+#include "DownloadSink.h"
+#include "EvfFrame.h"
+#include "Trace.h"
+#include "EDSDK.h"
+
+
+typedef struct _DOWNLOAD_PIPELINE_STATISTICS
+{
+	EdsUInt64	files;			// downloads that reached every sink
+	EdsUInt64	failedFiles;	// downloads the SDK or a sink failed
+	EdsUInt64	bytes;
+	EdsUInt64	chunks;
+	EdsUInt64	transferMicros;	// time inside EdsDownload
+	EdsUInt64	stallMicros;	// transfer waiting for the sinks to free a chunk
+	EdsUInt64	sinkMicros;		// time the sinks spent on chunks
+	EdsUInt32	chunkSize;
+	EdsUInt32	chunkCount;
+}DOWNLOAD_PIPELINE_STATISTICS;
+
+
+// Called with the percentage transferred after each chunk; false cancels
+// the transfer.
+typedef std::function<bool(EdsUInt32)> DownloadProgress;
+
+
+// Pulls a file from the camera in chunks with repeated EdsDownload calls
+// and pushes each chunk through the sinks on a thread of its own, so
+// transfer, hashing and writing overlap instead of running one after the other.
+// A fixed number of chunk buffers is cycled; when the sinks fall behind the
+// transfer waits for one to come back.
+class DownloadPipeline : public Thread
+{
+public:
+	// EdsDownload needs every block but the last to be a multiple of 512 bytes.
+	enum { kBlockAlignment = 512, kDefaultChunkSize = 4 * 1024 * 1024, kDefaultChunkCount = 3 };
+
+private:
+	class Chunk
+	{
+	public:
+		std::vector<unsigned char>	buffer;
+		EdsStreamRef				stream;
+		size_t						length;
+
+		Chunk() : stream(NULL), length(0) {}
+
+		~Chunk()
+		{
+			if(stream != NULL)
+			{
+				EdsRelease(stream);
+				stream = NULL;
+			}
+		}
+
+		EdsError create(EdsUInt32 size)
+		{
+			buffer.resize(size);
+			return EdsCreateMemoryStreamFromPointer(&buffer[0], buffer.size(), &stream);
+		}
+
+	private:
+		Chunk(const Chunk&);
+		Chunk& operator=(const Chunk&);
+	};
+
+	typedef std::shared_ptr<Chunk> ChunkRef;
+
+	// One file on its way through the sinks
+	typedef struct _FILE_CONTEXT
+	{
+		CameraModel*					model;
+		EdsDirectoryItemInfo			info;
+		std::vector<DownloadSinkRef>	sinks;
+		std::vector<bool>				active;
+		bool							sinkFailed;
+		bool							done;
+	}FILE_CONTEXT;
+
+	typedef std::shared_ptr<FILE_CONTEXT> FileContextRef;
+
+	enum JobKind { kJob_Begin, kJob_Data, kJob_End };
+
+	typedef struct _JOB
+	{
+		JobKind			kind;
+		FileContextRef	file;
+		ChunkRef		chunk;
+		bool			success;
+	}JOB;
+
+	std::vector<DownloadSinkRef>	_sinks;
+	EdsUInt32						_chunkSize;
+	EdsUInt32						_chunkCount;
+
+	std::vector<ChunkRef>			_free;
+	EdsUInt32						_allocated;
+	std::deque<JOB>					_jobs;
+	bool							_running;
+
+	EdsUInt64						_files;
+	EdsUInt64						_failedFiles;
+	EdsUInt64						_bytes;
+	EdsUInt64						_chunks;
+	EdsUInt64						_transferMicros;
+	EdsUInt64						_stallMicros;
+	EdsUInt64						_sinkMicros;
+
+	std::mutex						_mutex;
+	std::condition_variable			_jobCondition;
+	// Chunk returned or file finished
+	std::condition_variable			_doneCondition;
+
+public:
+	DownloadPipeline(EdsUInt32 chunkSize = kDefaultChunkSize, EdsUInt32 chunkCount = kDefaultChunkCount)
+		: _chunkSize(alignChunkSize(chunkSize)), _chunkCount(chunkCount > 0 ? chunkCount : 1), _allocated(0), _running(false),
+		  _files(0), _failedFiles(0), _bytes(0), _chunks(0), _transferMicros(0), _stallMicros(0), _sinkMicros(0) {}
+
+	virtual ~DownloadPipeline()
+	{
+		stop();
+	}
+
+	bool start()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_running)
+		{
+			return true;
+		}
+
+		_running = true;
+		if(!Thread::start())
+		{
+			_running = false;
+		}
+		return _running;
+	}
+
+	// Waits for queued chunks to reach the sinks.
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(!_running)
+			{
+				return;
+			}
+			_running = false;
+		}
+		_jobCondition.notify_all();
+		join();
+	}
+
+	bool isRunning()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _running;
+	}
+
+	// Sinks are taken when a file starts; changes apply to the next file.
+	void addSink(const DownloadSinkRef& sink)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(std::find(_sinks.begin(), _sinks.end(), sink) == _sinks.end())
+		{
+			_sinks.push_back(sink);
+		}
+	}
+
+	void removeSink(const DownloadSinkRef& sink)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_sinks.erase(std::remove(_sinks.begin(), _sinks.end(), sink), _sinks.end());
+	}
+
+	void clearSinks()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_sinks.clear();
+	}
+
+	EdsUInt32 getSinkCount()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return (EdsUInt32)_sinks.size();
+	}
+
+	// Rounded up to a multiple of kBlockAlignment. Buffers of the old size
+	// are dropped as they come back.
+	void setChunkSize(EdsUInt32 chunkSize)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_chunkSize = alignChunkSize(chunkSize);
+		_allocated -= (EdsUInt32)_free.size();
+		_free.clear();
+	}
+
+	EdsUInt32 getChunkSize()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _chunkSize;
+	}
+
+	void setChunkCount(EdsUInt32 chunkCount)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_chunkCount = (chunkCount > 0) ? chunkCount : 1;
+	}
+
+	EdsUInt32 getChunkCount()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _chunkCount;
+	}
+
+	DOWNLOAD_PIPELINE_STATISTICS getStatistics()
+	{
+		DOWNLOAD_PIPELINE_STATISTICS stats = {};
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		stats.files = _files;
+		stats.failedFiles = _failedFiles;
+		stats.bytes = _bytes;
+		stats.chunks = _chunks;
+		stats.transferMicros = _transferMicros;
+		stats.stallMicros = _stallMicros;
+		stats.sinkMicros = _sinkMicros;
+		stats.chunkSize = _chunkSize;
+		stats.chunkCount = _chunkCount;
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_files = _failedFiles = _bytes = _chunks = 0;
+		_transferMicros = _stallMicros = _sinkMicros = 0;
+	}
+
+	// Transfers one directory item through the sinks and returns once every
+	// sink has seen the end of it. Calls EdsDownloadComplete, or
+	// EdsDownloadCancel on failure. Runs on the caller's (transfer) thread.
+	EdsError download(CameraModel* model, EdsDirectoryItemRef item, const EdsDirectoryItemInfo& info, const DownloadProgress& progress = DownloadProgress())
+	{
+		EdsError err = EDS_ERR_OK;
+
+		if(!start())
+		{
+			return EDS_ERR_INTERNAL_ERROR;
+		}
+
+		FileContextRef file = std::make_shared<FILE_CONTEXT>();
+		file->model = model;
+		file->info = info;
+		file->sinkFailed = false;
+		file->done = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			file->sinks = _sinks;
+		}
+		file->active.assign(file->sinks.size(), false);
+
+		post(kJob_Begin, file, ChunkRef(), true);
+
+		EdsUInt64 remaining = info.size;
+		while(err == EDS_ERR_OK && remaining > 0)
+		{
+			ChunkRef chunk;
+			err = acquire(chunk);
+
+			if(err == EDS_ERR_OK)
+			{
+				chunk->length = (size_t)std::min<EdsUInt64>(remaining, chunk->buffer.size());
+				err = EdsSeek(chunk->stream, 0, kEdsSeek_Begin);
+			}
+
+			if(err == EDS_ERR_OK)
+			{
+				EdsUInt64 started = evfClockMicros();
+				{
+					TraceScope trace("EDSDK", "EdsDownload");
+					err = EdsDownload(item, chunk->length, chunk->stream);
+					trace.setArg("bytes", chunk->length);
+				}
+
+				std::lock_guard<std::mutex> lock(_mutex);
+				_transferMicros += evfClockMicros() - started;
+			}
+
+			if(err == EDS_ERR_OK)
+			{
+				remaining -= chunk->length;
+				post(kJob_Data, file, chunk, true);
+
+				if(progress && !progress((EdsUInt32)((info.size - remaining) * 100 / info.size)))
+				{
+					err = EDS_ERR_OPERATION_CANCELLED;
+				}
+			}
+			else if(chunk)
+			{
+				recycle(chunk);
+			}
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			TraceScope trace("EDSDK", "EdsDownloadComplete");
+			err = EdsDownloadComplete(item);
+			trace.setArg("error", err);
+		}
+		else
+		{
+			EdsDownloadCancel(item);
+		}
+
+		post(kJob_End, file, ChunkRef(), err == EDS_ERR_OK);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_doneCondition.wait(lock, [file]() { return file->done; });
+
+		if(err == EDS_ERR_OK && file->sinkFailed)
+		{
+			err = EDS_ERR_STREAM_WRITE_ERROR;
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			_files++;
+			_bytes += info.size;
+		}
+		else
+		{
+			_failedFiles++;
+		}
+		return err;
+	}
+
+public:
+	virtual void run()
+	{
+		//When using the SDK from another thread in Windows,
+		// you must initialize the COM library by calling CoInitialize
+#ifdef _WIN32
+		CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+		Tracer::instance().setThreadName("DownloadPipeline");
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		for(;;)
+		{
+			_jobCondition.wait(lock, [this]() { return !_jobs.empty() || !_running; });
+			if(_jobs.empty())
+			{
+				break;
+			}
+
+			JOB job = _jobs.front();
+			_jobs.pop_front();
+
+			lock.unlock();
+			EdsUInt64 started = evfClockMicros();
+			{
+				TraceScope trace("Sink", jobName(job.kind));
+				process(job);
+			}
+			EdsUInt64 elapsed = evfClockMicros() - started;
+			lock.lock();
+
+			_sinkMicros += elapsed;
+			if(job.chunk)
+			{
+				_chunks++;
+				returnChunk(job.chunk);
+			}
+			if(job.kind == kJob_End)
+			{
+				job.file->done = true;
+			}
+			_doneCondition.notify_all();
+		}
+		lock.unlock();
+
+#ifdef _WIN32
+		CoUninitialize();
+#endif
+	}
+
+protected:
+	static const char* jobName(JobKind kind)
+	{
+		switch(kind)
+		{
+			case kJob_Begin:	return "SinkBegin";
+			case kJob_Data:		return "SinkWrite";
+			default:			return "SinkEnd";
+		}
+	}
+
+	static EdsUInt32 alignChunkSize(EdsUInt32 chunkSize)
+	{
+		EdsUInt32 blocks = (chunkSize + kBlockAlignment - 1) / kBlockAlignment;
+		return (blocks > 0 ? blocks : 1) * kBlockAlignment;
+	}
+
+	// Sinks run without the lock.
+	void process(const JOB& job)
+	{
+		FILE_CONTEXT& file = *job.file;
+
+		for(size_t i = 0; i < file.sinks.size(); i++)
+		{
+			switch(job.kind)
+			{
+				case kJob_Begin:
+					file.active[i] = file.sinks[i]->begin(file.model, file.info);
+					file.sinkFailed = file.sinkFailed || !file.active[i];
+					break;
+
+				case kJob_Data:
+					if(file.active[i] && !file.sinks[i]->write(&job.chunk->buffer[0], job.chunk->length))
+					{
+						file.active[i] = false;
+						file.sinkFailed = true;
+					}
+					break;
+
+				case kJob_End:
+					file.sinks[i]->end(job.success && file.active[i]);
+					break;
+			}
+		}
+	}
+
+	void post(JobKind kind, const FileContextRef& file, const ChunkRef& chunk, bool success)
+	{
+		JOB job;
+		job.kind = kind;
+		job.file = file;
+		job.chunk = chunk;
+		job.success = success;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_jobs.push_back(job);
+		}
+		_jobCondition.notify_all();
+	}
+
+	// A free chunk, a new one while under the count, or wait for the sinks.
+	EdsError acquire(ChunkRef& chunk)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if(_free.empty() && _allocated >= _chunkCount)
+		{
+			EdsUInt64 started = evfClockMicros();
+			_doneCondition.wait(lock, [this]() { return !_free.empty() || _allocated < _chunkCount; });
+			_stallMicros += evfClockMicros() - started;
+		}
+
+		if(!_free.empty())
+		{
+			chunk = _free.back();
+			_free.pop_back();
+			return EDS_ERR_OK;
+		}
+
+		_allocated++;
+		EdsUInt32 chunkSize = _chunkSize;
+		lock.unlock();
+
+		chunk = std::make_shared<Chunk>();
+		EdsError err = chunk->create(chunkSize);
+		if(err != EDS_ERR_OK)
+		{
+			chunk.reset();
+			lock.lock();
+			_allocated--;
+		}
+		return err;
+	}
+
+	void recycle(const ChunkRef& chunk)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			returnChunk(chunk);
+		}
+		_doneCondition.notify_all();
+	}
+
+	// Called with the lock held
+	void returnChunk(const ChunkRef& chunk)
+	{
+		if(chunk->buffer.size() == _chunkSize && _allocated <= _chunkCount)
+		{
+			_free.push_back(chunk);
+		}
+		else
+		{
+			_allocated--;
+		}
+	}
+};
+
+typedef std::shared_ptr<DownloadPipeline> DownloadPipelineRef;
@@ -0,0 +1,201 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : DownloadSink.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "CameraModel.h"
+#include "CapturedImage.h"
+#include "XxHash64.h"
+#include "EDSDK.h"
+
+
+// One stage a chunked download is pushed through. For every file a sink
+// gets begin(), then write() for each chunk in order, then end(). All three
+// run on the pipeline thread while the next chunk is being transferred.
+// Returning false from begin() or write() stops that sink for the file.
+class DownloadSink
+{
+public:
+	virtual ~DownloadSink() {}
+
+	virtual bool begin(CameraModel* model, const EdsDirectoryItemInfo& info) = 0;
+	virtual bool write(const unsigned char* data, size_t length) = 0;
+	// success is false if the transfer or this sink failed part way.
+	virtual void end(bool success) = 0;
+};
+
+typedef std::shared_ptr<DownloadSink> DownloadSinkRef;
+
+
+// Writes each file into a directory under its camera file name.
+class FileDownloadSink : public DownloadSink
+{
+private:
+	std::string		_directory;
+	std::string		_path;
+	FILE*			_file;
+
+public:
+	FileDownloadSink(const std::string& directory = std::string()) : _directory(directory), _file(NULL) {}
+
+	virtual ~FileDownloadSink()
+	{
+		close();
+	}
+
+	const std::string& getDirectory() const		{ return _directory; }
+	// Path of the file being or last written
+	const std::string& getPath() const			{ return _path; }
+
+	virtual bool begin(CameraModel*, const EdsDirectoryItemInfo& info)
+	{
+		close();
+		_path = _directory;
+		if(!_path.empty() && _path[_path.size() - 1] != '\\' && _path[_path.size() - 1] != '/')
+		{
+			_path += '\\';
+		}
+		_path += info.szFileName;
+
+		_file = fopen(_path.c_str(), "wb");
+		return _file != NULL;
+	}
+
+	virtual bool write(const unsigned char* data, size_t length)
+	{
+		return _file != NULL && fwrite(data, 1, length, _file) == length;
+	}
+
+	virtual void end(bool success)
+	{
+		close();
+		if(!success)
+		{
+			remove(_path.c_str());
+		}
+	}
+
+protected:
+	void close()
+	{
+		if(_file != NULL)
+		{
+			fclose(_file);
+			_file = NULL;
+		}
+	}
+};
+
+
+// Checksums each file as it streams past.
+class HashDownloadSink : public DownloadSink
+{
+private:
+	XxHash64		_hasher;
+	EdsUInt64		_seed;
+	EdsUInt64		_digest;
+	EdsUInt64		_length;
+	std::string		_fileName;
+
+public:
+	HashDownloadSink(EdsUInt64 seed = 0) : _seed(seed), _digest(0), _length(0) {}
+
+	// XXH64 of the last complete file, 0 if it failed
+	EdsUInt64 getDigest() const					{ return _digest; }
+	EdsUInt64 getLength() const					{ return _length; }
+	const std::string& getFileName() const		{ return _fileName; }
+
+	virtual bool begin(CameraModel*, const EdsDirectoryItemInfo& info)
+	{
+		_hasher.reset(_seed);
+		_digest = 0;
+		_length = 0;
+		_fileName = info.szFileName;
+		return true;
+	}
+
+	virtual bool write(const unsigned char* data, size_t length)
+	{
+		_hasher.update(data, length);
+		_length += length;
+		return true;
+	}
+
+	virtual void end(bool success)
+	{
+		_digest = success ? _hasher.digest() : 0;
+	}
+};
+
+
+// Collects each file into a pooled buffer and queues it on the model as a
+// CapturedImage, like the kDownloadTarget_Memory download does.
+class MemoryDownloadSink : public DownloadSink
+{
+private:
+	CameraModel*			_model;
+	EdsDirectoryItemInfo	_info;
+	CaptureBufferRef		_buffer;
+	EdsUInt64				_length;
+
+public:
+	MemoryDownloadSink() : _model(NULL), _length(0)
+	{
+		memset(&_info, 0, sizeof(_info));
+	}
+
+	virtual bool begin(CameraModel* model, const EdsDirectoryItemInfo& info)
+	{
+		_model = model;
+		_info = info;
+		_length = 0;
+		_buffer = model->getCaptureBufferPool()->acquire(info.size > 0 ? info.size : 1);
+		return true;
+	}
+
+	virtual bool write(const unsigned char* data, size_t length)
+	{
+		if(_length + length > _buffer->size())
+		{
+			return false;
+		}
+		memcpy(&(*_buffer)[(size_t)_length], data, length);
+		_length += length;
+		return true;
+	}
+
+	virtual void end(bool success)
+	{
+		CaptureBufferPoolRef owner = _model->getCaptureBufferPool();
+		if(!success)
+		{
+			owner->release(_buffer);
+			_buffer.reset();
+			return;
+		}
+
+		std::weak_ptr<CaptureBufferPool> pool(owner);
+		CapturedImageRef image = std::make_shared<CapturedImage>(_info, _buffer, _length,
+			[pool](const CaptureBufferRef& released)
+			{
+				CaptureBufferPoolRef owner = pool.lock();
+				if(owner)
+				{
+					owner->release(released);
+				}
+			});
+		_buffer.reset();
+		_model->getCaptureQueue()->push(image);
+	}
+};
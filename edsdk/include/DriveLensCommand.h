@@ -27,8 +27,21 @@ private:
 
 public:
 	DriveLensCommand(CameraModel *model, EdsUInt32 parameter)
-		:_parameter(parameter), Command(model){}
+		:Command(model), _parameter(parameter){}
 
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+
+	// Drive lens by one step without going through the command queue
+	static EdsError drive(CameraModel *model, EdsUInt32 parameter)
+	{
+		TraceScope trace("EDSDK", "EdsSendCommand");
+		return EdsSendCommand(model->getCameraObject(),
+							  kEdsCameraCommand_DriveLensEvf,
+							  parameter);
+	}
+
+	virtual const char* getName() const {return "DriveLens";}
 
 	// Execute command	
 	virtual bool execute()
@@ -38,9 +51,7 @@ public:
 		// Drive lens
 		if(err == EDS_ERR_OK)
 		{		
-			err = EdsSendCommand(_model->getCameraObject(),
-								 kEdsCameraCommand_DriveLensEvf,
-								 _parameter);
+			err = drive(_model, _parameter);
 		}
 
 		//Notification of error
@@ -49,12 +60,14 @@ public:
 			// It doesn't retry it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return true;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
@@ -15,12 +15,24 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "Observer.h"
 #include "ActionSource.h"
+#include "EvfFrame.h"
+#include "JpegDecoder.h"
 
 // CEVFPictureBox
+// Frames are handed from the processor thread to a render thread, which
+// decodes the newest one into the back buffer and swaps it to the front.
+// The UI thread only composes the front buffer and blits it, so neither
+// camera I/O nor the decoder waits for painting; frames the UI has not
+// caught up with are dropped.
 
-class CEVFPictureBox : public CStatic, public ActionSource , public Observer
+class CEVFPictureBox : public CStatic, public ActionSource , public EventObserver
 {
 	DECLARE_DYNAMIC(CEVFPictureBox)
 	
@@ -29,17 +41,54 @@ private:
 	EdsFocusInfo	m_focusInfo;
 	EdsBool			m_bDrawZoomFrame;
 
-	void OnDrawImage(CDC *pDC, unsigned char* pbyteImage, int size);
+	// A frame ready to draw
+	struct RenderedFrame
+	{
+		EVF_DATASET		data;		// zoom and coordinates only, the stream may be gone
+		EvfFrameRef		frame;		// the JPEG, when it is decoded on the UI thread
+#ifdef HAVE_LIBJPEG
+		DecodedImage	image;
+#endif
+	};
+
+	std::thread				m_renderThread;
+	std::mutex				m_renderMutex;		// the hand-over from the processor thread
+	std::condition_variable	m_renderCondition;
+	bool					m_renderStop;
+	EvfFrameRef				m_pendingFrame;		// newest frame not decoded yet
+
+	std::mutex				m_bufferMutex;		// held to swap, and to draw the front buffer
+	RenderedFrame			m_buffers[2];
+	int						m_front;
+	bool					m_frontReady;
+	std::atomic<bool>		m_posted;			// a WM_USER_EVF_DATA_CHANGED is queued
+
+	// UI thread only; the frame and the focus border are composed here, then blitted
+	CBitmap					m_surface;
+	CSize					m_surfaceSize;
+
+#ifdef HAVE_LIBJPEG
+	// Render thread only
+	JpegDecoder		m_decoder;
+#endif
+
+	void startRenderer();
+	void stopRenderer();
+	void renderProc();
+	void submitFrame(const EvfFrameRef& frame);
+
+	void OnDrawImage(CDC *pDC, const RenderedFrame& rendered, const CRect& rect);
 	void OnDrawFocusRect(CDC *pDC, CRect zoomRect, CSize sizeJpegLarge);
 public:
 	CEVFPictureBox();
 	virtual ~CEVFPictureBox();
 
 	//observer
-	virtual void update(Observable* from, CameraEvent *e);
+	virtual void onEvent(Observable* from, const CameraEvent& e);
 
 protected:
 	afx_msg LRESULT OnEvfDataChanged(WPARAM wParam, LPARAM lParam);
+	afx_msg void OnDestroy();
 	DECLARE_MESSAGE_MAP()
 };
 
@@ -15,6 +15,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <thread>
+
 #include "Command.h"
 #include "CameraEvent.h"
 #include "EDSDK.h"
@@ -28,6 +31,8 @@ public:
 	EndEvfCommand(CameraModel *model) : Command(model){}
 
 
+	virtual const char* getName() const {return "EndEvf";}
+
     // Execute command	
 	virtual bool execute()
 	{
@@ -51,12 +56,16 @@ public:
 		if (depthOfFieldPreview != 0)
 		{
 			depthOfFieldPreview = 0;
-			err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_Evf_DepthOfFieldPreview, 0, sizeof(depthOfFieldPreview), &depthOfFieldPreview);
+			{
+				TraceScope trace("EDSDK", "EdsSetPropertyData");
+				err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_Evf_DepthOfFieldPreview, 0, sizeof(depthOfFieldPreview), &depthOfFieldPreview);
+				trace.setArg("error", err);
+			}
 
 			// Standby because commands are not accepted for awhile when the depth of field has been released.
 			if (err == EDS_ERR_OK)
 			{
-				Sleep(500);
+				std::this_thread::sleep_for(std::chrono::milliseconds(500));
 			}
 		}
 
@@ -65,7 +74,9 @@ public:
 		if (err == EDS_ERR_OK)
 		{
 			device &= ~kEdsEvfOutputDevice_PC;
+			TraceScope trace("EDSDK", "EdsSetPropertyData");
 			err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_Evf_OutputDevice, 0, sizeof(device), &device);
+			trace.setArg("error", err);
 		}
 
 		//Notification of error
@@ -74,12 +85,14 @@ public:
 			// It retries it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 
 			// Retry until successful.
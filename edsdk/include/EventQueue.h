@@ -0,0 +1,505 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EventQueue.h                                                    *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraEvent.h"
+#include "Observer.h"
+#include "Synchronized.h"
+#include "EvfFrame.h"
+#include "StorageIndex.h"
+
+
+// A camera event flattened to plain data, so it can be queued without
+// holding on to the SDK's argument.
+typedef struct _QUEUED_EVENT
+{
+	CameraEventID	id;
+	// Tag given to attach(), to tell the cameras apart
+	EdsUInt32		source;
+	EdsUInt64		sequence;
+	EdsUInt64		timestampMicros;
+	// Property id, progress percent or error code, by event
+	EdsUInt32		param;
+}QUEUED_EVENT;
+
+
+typedef struct _EVENT_QUEUE_STATISTICS
+{
+	EdsUInt64	pushed;
+	EdsUInt64	drained;
+	// Events dropped because the queue was full
+	EdsUInt64	overflows;
+	EdsUInt32	capacity;
+	EdsUInt32	depth;
+}EVENT_QUEUE_STATISTICS;
+
+
+// Bounded lock-free queue from the SDK and processor threads to one
+// consumer, usually Python. Producers never block and never take the GIL:
+// a push is a CAS on the tail and a store into a preallocated cell (after
+// Vyukov's bounded queue). When full, the new event is dropped and counted.
+//
+// The consumer drains in batches, after wait() or once the wait socket
+// is readable. Both are signalled only when the queue goes from empty to
+// non-empty; the socket is a selector-friendly file descriptor (a socket
+// on Windows, as selectors take nothing else there).
+class EventQueue
+{
+public:
+	enum { kDefaultCapacity = 4096 };
+
+private:
+	struct Cell
+	{
+		std::atomic<EdsUInt64>	sequence;
+		QUEUED_EVENT			event;
+	};
+
+#ifdef _WIN32
+	typedef SOCKET WaitSocket;
+	static WaitSocket invalidSocket()	{ return INVALID_SOCKET; }
+	static void closeSocket(WaitSocket socket)	{ closesocket(socket); }
+#else
+	typedef int WaitSocket;
+	static WaitSocket invalidSocket()	{ return -1; }
+	static void closeSocket(WaitSocket socket)	{ ::close(socket); }
+#endif
+
+	// A connected pair, both ends non-blocking. Windows has no
+	// socketpair(), so it is made over loopback.
+	static bool makeSocketPair(WaitSocket sockets[2])
+	{
+#ifdef _WIN32
+		WSADATA data;
+		if(WSAStartup(MAKEWORD(2, 2), &data) != 0)
+		{
+			return false;
+		}
+		SOCKET listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		sockets[0] = sockets[1] = INVALID_SOCKET;
+		bool ok = (listener != INVALID_SOCKET);
+
+		struct sockaddr_in address;
+		int length = sizeof(address);
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = 0;
+		ok = ok && bind(listener, (struct sockaddr*)&address, sizeof(address)) == 0
+			&& getsockname(listener, (struct sockaddr*)&address, &length) == 0
+			&& listen(listener, 1) == 0;
+		if(ok)
+		{
+			sockets[1] = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+			ok = sockets[1] != INVALID_SOCKET && connect(sockets[1], (struct sockaddr*)&address, sizeof(address)) == 0;
+		}
+		if(ok)
+		{
+			sockets[0] = accept(listener, NULL, NULL);
+			ok = sockets[0] != INVALID_SOCKET;
+		}
+		if(listener != INVALID_SOCKET)
+		{
+			closesocket(listener);
+		}
+		u_long nonBlocking = 1;
+		for(int i = 0; ok && i < 2; i++)
+		{
+			ok = ioctlsocket(sockets[i], FIONBIO, &nonBlocking) == 0;
+		}
+		if(!ok)
+		{
+			for(int i = 0; i < 2; i++)
+			{
+				if(sockets[i] != INVALID_SOCKET)
+				{
+					closesocket(sockets[i]);
+				}
+				sockets[i] = INVALID_SOCKET;
+			}
+			WSACleanup();
+		}
+		return ok;
+#else
+		if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+		{
+			sockets[0] = sockets[1] = -1;
+			return false;
+		}
+		for(int i = 0; i < 2; i++)
+		{
+			fcntl(sockets[i], F_SETFL, fcntl(sockets[i], F_GETFL) | O_NONBLOCK);
+#ifdef F_SETFD
+			fcntl(sockets[i], F_SETFD, FD_CLOEXEC);
+#endif
+		}
+		return true;
+#endif
+	}
+
+	// With the queue just gone non-empty
+	void signal()
+	{
+		{
+			// Taken so a waiter between its check and its wait is not missed
+			std::lock_guard<std::mutex> lock(_waitMutex);
+		}
+		_waitCondition.notify_all();
+
+		if(_hasWaitSocket.load(std::memory_order_acquire))
+		{
+			char byte = 1;
+#if defined(_WIN32)
+			::send(_waitSockets[1], &byte, 1, 0);
+#elif defined(MSG_NOSIGNAL)
+			::send(_waitSockets[1], &byte, 1, MSG_NOSIGNAL);
+#else
+			::send(_waitSockets[1], &byte, 1, 0);
+#endif
+		}
+	}
+
+	// Empties the wait socket
+	void unsignal()
+	{
+		if(_hasWaitSocket.load(std::memory_order_acquire))
+		{
+			char buffer[64];
+			while(::recv(_waitSockets[0], buffer, sizeof(buffer), 0) > 0)
+			{
+			}
+		}
+	}
+
+	// Subscribes the queue to one model under a tag.
+	class Tap : public EventObserver
+	{
+	public:
+		EventQueue*		queue;
+		Observable*		source;
+		EdsUInt32		tag;
+
+		Tap(EventQueue* queue, Observable* source, EdsUInt32 tag) : queue(queue), source(source), tag(tag) {}
+
+		virtual void onEvent(Observable*, const CameraEvent& e)
+		{
+			queue->push(e, tag);
+		}
+	};
+
+	std::vector<Cell>		_cells;
+	EdsUInt64				_mask;
+
+	// Producers and consumer each on their own cache line
+	char					_pad0[64];
+	std::atomic<EdsUInt64>	_tail;
+	char					_pad1[64];
+	EdsUInt64				_head;
+	char					_pad2[64];
+
+	std::atomic<EdsUInt64>	_pushed;
+	std::atomic<EdsUInt64>	_overflows;
+	std::atomic<EdsUInt64>	_sequence;
+	std::atomic<EdsUInt64>	_drained;
+
+	std::atomic<bool>		_signalled;
+	std::mutex				_waitMutex;
+	std::condition_variable	_waitCondition;
+
+	// Read and write ends of the wait socket, made on first use
+	WaitSocket				_waitSockets[2];
+	std::atomic<bool>		_hasWaitSocket;
+	std::mutex				_waitSocketMutex;
+
+	std::vector<Tap*>		_taps;
+	Synchronized			_syncObject;
+
+	EventQueue(const EventQueue&);
+	EventQueue& operator=(const EventQueue&);
+
+public:
+	// capacity is rounded up to a power of two.
+	EventQueue(EdsUInt32 capacity = kDefaultCapacity)
+		: _tail(0), _head(0), _pushed(0), _overflows(0), _sequence(0), _drained(0), _signalled(false), _hasWaitSocket(false)
+	{
+		_waitSockets[0] = _waitSockets[1] = invalidSocket();
+
+		EdsUInt64 size = 2;
+		while(size < capacity)
+		{
+			size <<= 1;
+		}
+
+		_cells = std::vector<Cell>((size_t)size);
+		for(EdsUInt64 i = 0; i < size; i++)
+		{
+			_cells[(size_t)i].sequence.store(i, std::memory_order_relaxed);
+		}
+		_mask = size - 1;
+	}
+
+	virtual ~EventQueue()
+	{
+		detachAll();
+		if(_hasWaitSocket)
+		{
+			closeSocket(_waitSockets[0]);
+			closeSocket(_waitSockets[1]);
+#ifdef _WIN32
+			WSACleanup();
+#endif
+		}
+	}
+
+	// Queue the events of a model whose bits are set in mask. Attach and
+	// detach while no events are being sent, e.g. before the session opens.
+	void attach(Observable* model, EdsUInt32 tag = 0, EdsUInt32 mask = kCameraEventMask_All)
+	{
+		_syncObject.lock();
+		Tap* tap = NULL;
+		for(size_t i = 0; i < _taps.size(); i++)
+		{
+			if(_taps[i]->source == model)
+			{
+				tap = _taps[i];
+				tap->tag = tag;
+			}
+		}
+		if(tap == NULL)
+		{
+			tap = new Tap(this, model, tag);
+			_taps.push_back(tap);
+		}
+		model->addEventObserver(tap, mask);
+		_syncObject.unlock();
+	}
+
+	void detach(Observable* model)
+	{
+		_syncObject.lock();
+		for(std::vector<Tap*>::iterator it = _taps.begin(); it != _taps.end(); ++it)
+		{
+			if((*it)->source == model)
+			{
+				model->deleteEventObserver(*it);
+				delete *it;
+				_taps.erase(it);
+				break;
+			}
+		}
+		_syncObject.unlock();
+	}
+
+	void detachAll()
+	{
+		_syncObject.lock();
+		for(size_t i = 0; i < _taps.size(); i++)
+		{
+			_taps[i]->source->deleteEventObserver(_taps[i]);
+			delete _taps[i];
+		}
+		_taps.clear();
+		_syncObject.unlock();
+	}
+
+	// Any thread. False if the queue was full and the event was dropped.
+	bool push(const CameraEvent& e, EdsUInt32 source)
+	{
+		QUEUED_EVENT event;
+		event.id = e.getID();
+		event.source = source;
+		event.timestampMicros = evfClockMicros();
+		event.param = 0;
+
+		switch(event.id)
+		{
+		case kCameraEvent_PropertyChanged:
+		case kCameraEvent_PropertyDescChanged:
+		case kCameraEvent_ProgressReport:
+			event.param = (e.getArg() != NULL) ? *static_cast<EdsUInt32*>(e.getArg()) : 0;
+			break;
+
+		case kCameraEvent_Error:
+		case kCameraEvent_DownloadComplete:
+			event.param = (e.getArg() != NULL) ? *static_cast<EdsError*>(e.getArg()) : 0;
+			break;
+
+		case kCameraEvent_StorageChanged:
+			{
+				const STORAGE_CHANGE* change = e.getPayload<kCameraEvent_StorageChanged>();
+				event.param = (change != NULL) ? (EdsUInt32)change->kind : 0;
+			}
+			break;
+
+		case kCameraEvent_PropertiesChanged:
+			{
+				// One entry per property, like separate PropertyChanged events
+				const PropertyIDList* list = e.getPayload<kCameraEvent_PropertiesChanged>();
+				if(list != NULL)
+				{
+					bool queued = true;
+					event.id = kCameraEvent_PropertyChanged;
+					for(size_t i = 0; i < list->size(); i++)
+					{
+						event.param = (*list)[i];
+						queued = push(event) && queued;
+					}
+					return queued;
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		return push(event);
+	}
+
+	bool push(QUEUED_EVENT event)
+	{
+		EdsUInt64 tail = _tail.load(std::memory_order_relaxed);
+		Cell* cell;
+		for(;;)
+		{
+			cell = &_cells[(size_t)(tail & _mask)];
+			EdsUInt64 sequence = cell->sequence.load(std::memory_order_acquire);
+			EdsInt64 diff = (EdsInt64)(sequence - tail);
+			if(diff == 0)
+			{
+				if(_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if(diff < 0)
+			{
+				_overflows.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+			{
+				tail = _tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		event.sequence = _sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+		cell->event = event;
+		cell->sequence.store(tail + 1, std::memory_order_release);
+		_pushed.fetch_add(1, std::memory_order_relaxed);
+
+		if(!_signalled.exchange(true))
+		{
+			signal();
+		}
+		return true;
+	}
+
+	// Consumer only. Appends up to maxEvents (0 for all) to events and
+	// returns how many were taken.
+	size_t drain(std::vector<QUEUED_EVENT>& events, size_t maxEvents = 0)
+	{
+		// Reset first: a push from here on signals again
+		unsignal();
+		_signalled.store(false);
+
+		size_t count = 0;
+		while(maxEvents == 0 || count < maxEvents)
+		{
+			Cell* cell = &_cells[(size_t)(_head & _mask)];
+			EdsUInt64 sequence = cell->sequence.load(std::memory_order_acquire);
+			if((EdsInt64)(sequence - (_head + 1)) < 0)
+			{
+				break;
+			}
+
+			events.push_back(cell->event);
+			cell->sequence.store(_head + _mask + 1, std::memory_order_release);
+			_head++;
+			count++;
+		}
+		_drained += count;
+
+		// Stopped at maxEvents with more waiting
+		if(count > 0 && !empty() && !_signalled.exchange(true))
+		{
+			signal();
+		}
+		return count;
+	}
+
+	// Block until an event is queued, millisec < 0 for no limit. False on timeout.
+	bool wait(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_waitMutex);
+		if(millisec < 0)
+		{
+			_waitCondition.wait(lock, [this]() { return !empty(); });
+			return true;
+		}
+		return _waitCondition.wait_for(lock, std::chrono::milliseconds(millisec), [this]() { return !empty(); });
+	}
+
+	bool empty()
+	{
+		Cell* cell = &_cells[(size_t)(_head & _mask)];
+		return (EdsInt64)(cell->sequence.load(std::memory_order_acquire) - (_head + 1)) < 0;
+	}
+
+	// Readable while events are waiting, for select() or a selectors
+	// selector; drain() clears it. -1 if no socket could be made.
+	EdsInt64 getWaitFd()
+	{
+		std::lock_guard<std::mutex> lock(_waitSocketMutex);
+		if(!_hasWaitSocket)
+		{
+			if(!makeSocketPair(_waitSockets))
+			{
+				return -1;
+			}
+			_hasWaitSocket.store(true, std::memory_order_release);
+			// Events queued before there was a socket
+			if(!empty())
+			{
+				signal();
+			}
+		}
+		return (EdsInt64)_waitSockets[0];
+	}
+
+	EVENT_QUEUE_STATISTICS getStatistics()
+	{
+		EVENT_QUEUE_STATISTICS stats;
+		stats.pushed = _pushed.load();
+		stats.drained = _drained.load();
+		stats.overflows = _overflows.load();
+		stats.capacity = (EdsUInt32)(_mask + 1);
+		stats.depth = (EdsUInt32)(stats.pushed - stats.drained);
+		return stats;
+	}
+};
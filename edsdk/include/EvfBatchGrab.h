@@ -0,0 +1,246 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfBatchGrab.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "EvfFrame.h"
+#include "EvfPump.h"
+#include "JpegDecoder.h"
+#include "ImageKernels.h"
+#include "EDSDK.h"
+
+
+// Where one frame of a batch came from.
+typedef struct _EVF_BATCH_FRAME
+{
+	EdsUInt64	sequence;			// in the pump's stream
+	EdsUInt64	downloadStart;		// evfClockMicros()
+	EdsUInt64	downloadEnd;
+	EdsUInt32	zoom;
+	EdsRect		zoomRect;
+	EdsPoint	imagePosition;
+	EdsSize		sizeJpegLarge;
+	EdsInt32	sourceWidth;		// of the JPEG, before any resize
+	EdsInt32	sourceHeight;
+	bool		decoded;			// false leaves the slot zeroed
+}EVF_BATCH_FRAME;
+
+
+// Fills count consecutive slots of a caller's buffer with the next frames
+// a pump publishes, decoded (and resized when the JPEG is another size) on
+// a few threads as the frames come in. Slot i holds the i-th frame after
+// grab() was called; each slot needs frameStride bytes of rows stride
+// bytes apart and nothing is allocated per frame.
+class EvfBatchGrab : public EvfFrameSink
+{
+public:
+	enum { kDefaultWorkerCount = 2 };
+
+private:
+	typedef struct _JOB
+	{
+		EdsUInt32		slot;
+		EvfFrameRef		frame;
+	}JOB;
+
+	unsigned char*			_out;
+	EdsUInt32				_count;
+	int						_width;
+	int						_height;
+	int						_stride;
+	size_t					_frameStride;
+	JpegPixelFormat			_format;
+	EVF_BATCH_FRAME*		_frames;
+	EdsUInt32				_workerCount;
+
+	std::deque<JOB>			_jobs;
+	EdsUInt32				_taken;			// slots handed to the queue
+	EdsUInt32				_finished;
+	EdsUInt32				_failed;
+	bool					_closed;
+	std::mutex				_mutex;
+	std::condition_variable	_jobCondition;
+	std::condition_variable	_finishedCondition;
+
+	EvfBatchGrab(const EvfBatchGrab&);
+	EvfBatchGrab& operator=(const EvfBatchGrab&);
+
+public:
+	EvfBatchGrab(unsigned char* out, EdsUInt32 count, int width, int height, int stride, size_t frameStride,
+		JpegPixelFormat format, EVF_BATCH_FRAME* frames)
+		: _out(out), _count(count), _width(width), _height(height), _stride(stride), _frameStride(frameStride),
+		  _format(format), _frames(frames), _workerCount(kDefaultWorkerCount), _taken(0), _finished(0), _failed(0), _closed(false)
+	{
+	}
+
+	void setWorkerCount(EdsUInt32 workerCount)		{ _workerCount = workerCount > 0 ? workerCount : 1; }
+
+	// Blocks until every slot is decoded or timeoutMillis passed; frames
+	// already received by then are still decoded. Returns the slots filled.
+	EdsUInt32 grab(EvfPump& pump, int timeoutMillis)
+	{
+		std::vector<std::thread> workers;
+		for(EdsUInt32 i = 0; i < _workerCount && i < _count; i++)
+		{
+			workers.push_back(std::thread(&EvfBatchGrab::work, this));
+		}
+
+		pump.addSink(this);
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_finishedCondition.wait_for(lock, std::chrono::milliseconds(timeoutMillis < 0 ? 0 : timeoutMillis), [this]()
+			{
+				return _finished >= _count;
+			});
+		}
+		// No call is in progress once removeSink() returns
+		pump.removeSink(this);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_closed = true;
+		}
+		_jobCondition.notify_all();
+		for(size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+		return _taken;
+	}
+
+	EdsUInt32 getFailed()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _failed;
+	}
+
+	// EvfFrameSink: only queues; decoding is on the workers.
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_closed || _taken >= _count)
+			{
+				return;
+			}
+			JOB job;
+			job.slot = _taken++;
+			job.frame = frame;
+			_jobs.push_back(job);
+		}
+		_jobCondition.notify_one();
+	}
+
+protected:
+	void work()
+	{
+		JpegDecoder decoder;
+		DecodedImage image;		// reused, so its pixels are allocated once
+
+		for(;;)
+		{
+			JOB job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_jobCondition.wait(lock, [this]() { return _closed || !_jobs.empty(); });
+				if(_jobs.empty())
+				{
+					return;
+				}
+				job = _jobs.front();
+				_jobs.pop_front();
+			}
+
+			bool ok = decode(decoder, image, job);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_finished++;
+				if(!ok)
+				{
+					_failed++;
+				}
+			}
+			_finishedCondition.notify_all();
+		}
+	}
+
+	bool decode(JpegDecoder& decoder, DecodedImage& image, const JOB& job)
+	{
+		const EvfFrame& frame = *job.frame;
+		unsigned char* slot = _out + _frameStride * job.slot;
+		int channels = (_format == kJpegPixelFormat_Gray) ? 1 : 3;
+
+		EVF_BATCH_FRAME info;
+		memset(&info, 0, sizeof(info));
+		info.sequence = frame.getSequence();
+		info.downloadStart = frame.getDataSet().timing.downloadStart;
+		info.downloadEnd = frame.getDataSet().timing.downloadEnd;
+		info.zoom = frame.getZoom();
+		info.zoomRect = frame.getZoomRect();
+		info.imagePosition = frame.getImagePosition();
+		info.sizeJpegLarge = frame.getSizeJpegLarge();
+
+		int width = 0;
+		int height = 0;
+		bool ok = decoder.readHeader(frame.getData(), (size_t)frame.getLength(), width, height);
+		if(ok)
+		{
+			info.sourceWidth = width;
+			info.sourceHeight = height;
+
+			// Let the IDCT do as much of a downscale as it can
+			int scale = 1;
+			for(int s = 8; s > 1; s /= 2)
+			{
+				if(width / s >= _width && height / s >= _height)
+				{
+					scale = s;
+					break;
+				}
+			}
+			ok = decoder.decode(frame.getData(), (size_t)frame.getLength(), image, _format, scale);
+		}
+
+		if(ok && image.getWidth() == _width && image.getHeight() == _height)
+		{
+			for(int y = 0; y < _height; y++)
+			{
+				memcpy(slot + (size_t)_stride * y, image.getRow(y), (size_t)_width * channels);
+			}
+		}
+		else if(ok)
+		{
+			// The workers already run frames side by side
+			ok = resizeImage(image.getPixels(), image.getWidth(), image.getHeight(), image.getStride(),
+				slot, _width, _height, _stride, channels, kResizeFilter_Area, 1);
+		}
+
+		if(!ok)
+		{
+			for(int y = 0; y < _height; y++)
+			{
+				memset(slot + (size_t)_stride * y, 0, (size_t)_width * channels);
+			}
+		}
+		info.decoded = ok;
+		if(_frames != NULL)
+		{
+			_frames[job.slot] = info;
+		}
+		return ok;
+	}
+};
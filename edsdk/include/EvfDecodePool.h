@@ -0,0 +1,485 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfDecodePool.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+#include "EvfFrame.h"
+#include "JpegDecoder.h"
+#include "EvfRegion.h"
+#include "ImageStatistics.h"
+#include "ImageKernels.h"
+#include "EDSDK.h"
+
+
+// A live view frame after the decode stage.
+class DecodedEvfFrame
+{
+public:
+	EvfFrameRef			frame;		// source JPEG and metadata
+	DecodedImageRef		image;
+	EdsUInt64			index;		// delivery order, consecutive from 1
+	EVF_TIMING			timing;		// download stages copied from the frame
+	bool				hasStatistics;
+	IMAGE_STATISTICS	statistics;	// of the decoded pixels, if enabled
+
+	DecodedEvfFrame() : index(0), hasStatistics(false)
+	{
+		memset(&timing, 0, sizeof(timing));
+		memset(&statistics, 0, sizeof(statistics));
+	}
+};
+
+typedef std::shared_ptr<DecodedEvfFrame> DecodedEvfFrameRef;
+
+// Runs on the worker right after decoding, e.g. for statistics.
+typedef std::function<void(DecodedEvfFrame&)> EvfPostProcess;
+// Called in delivery order, one frame at a time.
+typedef std::function<void(const DecodedEvfFrameRef&)> EvfDecodedListener;
+
+
+typedef struct _EVF_DECODE_STATISTICS
+{
+	EdsUInt64	submitted;
+	EdsUInt64	dropped;			// replaced in the queue before a worker took them
+	EdsUInt64	decoded;
+	EdsUInt64	failed;
+	EdsUInt64	delivered;
+	EdsUInt64	lastIndex;
+	EdsUInt32	queueDepth;
+	EdsUInt32	workerCount;
+	EdsUInt64	averageDecodeMicros;
+	EdsUInt64	averageLatencyMicros;	// download start to delivery
+}EVF_DECODE_STATISTICS;
+
+
+// Decodes live view frames on a pool of worker threads so that the thread
+// talking to the camera only downloads.
+// Frames are numbered when a worker takes them and handed on strictly in
+// that order, whichever worker finishes first. If the workers fall behind,
+// the oldest waiting frame is dropped before it is numbered.
+class EvfDecodePool : public EvfFrameSink
+{
+public:
+	enum { kDefaultWorkerCount = 2, kDefaultQueueLimit = 4 };
+
+private:
+	class Worker : public Thread
+	{
+	private:
+		EvfDecodePool*	_pool;
+	public:
+		Worker(EvfDecodePool* pool) : _pool(pool) {}
+		virtual void run() { _pool->work(); }
+	};
+
+	typedef struct _JOB
+	{
+		EvfFrameRef			frame;
+		EdsUInt64			queued;
+		EvfRegionMode		regionMode;
+		EdsRect				region;
+		EvfCoordinateSpace	regionSpace;
+		int					resizeWidth;
+		int					resizeHeight;
+		ResizeFilter		resizeFilter;
+	}JOB;
+
+	EdsUInt32							_workerCount;
+	JpegPixelFormat						_format;
+	int									_scale;
+	EdsUInt32							_queueLimit;
+	EvfPostProcess						_postProcess;
+	std::atomic<bool>					_computeStatistics;
+
+	// Region of interest, guarded by _jobMutex and copied into each job
+	EvfRegionMode						_regionMode;
+	EdsRect								_region;
+	EvfCoordinateSpace					_regionSpace;
+
+	// Output size, 0 to keep the decoded size; also under _jobMutex
+	int									_resizeWidth;
+	int									_resizeHeight;
+	ResizeFilter						_resizeFilter;
+
+	std::vector<std::unique_ptr<Worker> >	_workers;
+	std::atomic<bool>					_running;
+	THREAD_PLACEMENT					_placement;
+	std::string							_name;
+
+	// Input queue
+	std::deque<JOB>						_jobs;
+	EdsUInt64							_nextIndex;
+	std::mutex							_jobMutex;
+	std::condition_variable				_jobCondition;
+
+	// Reorder buffer; frames wait here until all earlier ones are out.
+	// A NULL entry marks a frame that failed to decode.
+	std::map<EdsUInt64, DecodedEvfFrameRef>	_completed;
+	EdsUInt64							_nextDelivery;
+	std::vector<EvfDecodedListener>		_listeners;
+	DecodedEvfFrameRef					_latest;
+	std::mutex							_deliveryMutex;
+	std::condition_variable				_deliveryCondition;
+
+	EdsUInt64							_submitted;
+	EdsUInt64							_dropped;
+	std::atomic<EdsUInt64>				_decoded;
+	std::atomic<EdsUInt64>				_failed;
+	EdsUInt64							_delivered;
+	EdsUInt64							_decodeMicrosTotal;
+	EdsUInt64							_latencyMicrosTotal;
+
+public:
+	EvfDecodePool(EdsUInt32 workerCount = kDefaultWorkerCount, JpegPixelFormat format = kJpegPixelFormat_RGB, int scale = 1, EdsUInt32 queueLimit = kDefaultQueueLimit)
+		: _workerCount(workerCount > 0 ? workerCount : 1), _format(format), _scale(JpegDecoder::isValidScale(scale) ? scale : 1),
+		  _queueLimit(queueLimit > 0 ? queueLimit : 1),
+		  _computeStatistics(false), _regionMode(kEvfRegion_None), _regionSpace(kEvfCoordinate_Image),
+		  _resizeWidth(0), _resizeHeight(0), _resizeFilter(kResizeFilter_Area), _running(false), _placement(ThreadPlacement::any()), _nextIndex(1), _nextDelivery(1),
+		  _submitted(0), _dropped(0), _decoded(0), _failed(0), _delivered(0), _decodeMicrosTotal(0), _latencyMicrosTotal(0)
+	{
+		memset(&_region, 0, sizeof(_region));
+	}
+
+	virtual ~EvfDecodePool()
+	{
+		stop();
+	}
+
+	// Set before start().
+	void setPostProcess(const EvfPostProcess& postProcess)	{ _postProcess = postProcess; }
+
+	// Histogram, means and clipping of every decoded frame.
+	void setComputeStatistics(bool compute)		{ _computeStatistics = compute; }
+	bool getComputeStatistics() const			{ return _computeStatistics; }
+
+	void addListener(const EvfDecodedListener& listener)
+	{
+		std::lock_guard<std::mutex> lock(_deliveryMutex);
+		_listeners.push_back(listener);
+	}
+
+	// Decode only region of each following frame.
+	void setRegion(const EdsRect& region, EvfCoordinateSpace space)
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_region = region;
+		_regionSpace = space;
+		_regionMode = kEvfRegion_Fixed;
+	}
+
+	// Decode only the zoom rect that came with each frame.
+	void followZoomRect()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_regionMode = kEvfRegion_ZoomRect;
+	}
+
+	void clearRegion()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_regionMode = kEvfRegion_None;
+	}
+
+	EvfRegionMode getRegionMode()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		return _regionMode;
+	}
+
+	// Resize each following frame after decoding, before statistics and
+	// the post process. Cheapest combined with a decode scale that gets
+	// close to the size first.
+	void setResize(int width, int height, ResizeFilter filter = kResizeFilter_Area)
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_resizeWidth = (width > 0 && height > 0) ? width : 0;
+		_resizeHeight = (width > 0 && height > 0) ? height : 0;
+		_resizeFilter = filter;
+	}
+
+	void clearResize()
+	{
+		setResize(0, 0);
+	}
+
+	// Cores of the workers, e.g. the camera's CAMERA_PLACEMENT::decode, and
+	// their name prefix: the workers are "<name>-dec0" and on. Set before start().
+	void setPlacement(const THREAD_PLACEMENT& placement, const std::string& name = std::string())
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_placement = placement;
+		_name = name;
+	}
+
+	bool start()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		if(_running)
+		{
+			return true;
+		}
+
+		_running = true;
+		for(EdsUInt32 i = 0; i < _workerCount; i++)
+		{
+			std::unique_ptr<Worker> worker(new Worker(this));
+			if(!_name.empty())
+			{
+				worker->setName(_name + "-dec" + std::to_string(i));
+			}
+			worker->setPlacement(_placement);
+			if(worker->start())
+			{
+				_workers.push_back(std::move(worker));
+			}
+		}
+
+		_running = !_workers.empty();
+		return _running;
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			if(!_running)
+			{
+				return;
+			}
+			_running = false;
+			_jobs.clear();
+		}
+		_jobCondition.notify_all();
+
+		for(size_t i = 0; i < _workers.size(); i++)
+		{
+			_workers[i]->join();
+		}
+		_workers.clear();
+
+		_deliveryCondition.notify_all();
+	}
+
+	bool isRunning() const					{ return _running; }
+	EdsUInt32 getWorkerCount() const		{ return _workerCount; }
+	JpegPixelFormat getFormat() const		{ return _format; }
+	int getScale() const					{ return _scale; }
+
+	// EvfFrameSink: called on the producer thread, never blocks on decoding.
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			if(!_running)
+			{
+				return;
+			}
+
+			if(_jobs.size() >= _queueLimit)
+			{
+				_jobs.pop_front();
+				_dropped++;
+			}
+
+			JOB job;
+			job.frame = frame;
+			job.queued = evfClockMicros();
+			job.regionMode = _regionMode;
+			job.region = _region;
+			job.regionSpace = _regionSpace;
+			job.resizeWidth = _resizeWidth;
+			job.resizeHeight = _resizeHeight;
+			job.resizeFilter = _resizeFilter;
+			_jobs.push_back(job);
+			_submitted++;
+		}
+		_jobCondition.notify_one();
+	}
+
+	// Newest delivered frame, or empty if none yet.
+	DecodedEvfFrameRef latest()
+	{
+		std::lock_guard<std::mutex> lock(_deliveryMutex);
+		return _latest;
+	}
+
+	// Waits for a frame delivered after afterIndex; returns empty on timeout or stop.
+	DecodedEvfFrameRef waitForFrame(EdsUInt64 afterIndex, int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_deliveryMutex);
+		_deliveryCondition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [this, afterIndex]()
+		{
+			return !_running || (_latest && _latest->index > afterIndex);
+		});
+
+		if(_latest && _latest->index > afterIndex)
+		{
+			return _latest;
+		}
+		return DecodedEvfFrameRef();
+	}
+
+	EVF_DECODE_STATISTICS getStatistics()
+	{
+		EVF_DECODE_STATISTICS stats = {};
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			stats.submitted = _submitted;
+			stats.dropped = _dropped;
+			stats.queueDepth = (EdsUInt32)_jobs.size();
+		}
+		stats.decoded = _decoded;
+		stats.failed = _failed;
+		stats.workerCount = _workerCount;
+		{
+			std::lock_guard<std::mutex> lock(_deliveryMutex);
+			stats.delivered = _delivered;
+			stats.lastIndex = _nextDelivery - 1;
+			if(_delivered > 0)
+			{
+				stats.averageDecodeMicros = _decodeMicrosTotal / _delivered;
+				stats.averageLatencyMicros = _latencyMicrosTotal / _delivered;
+			}
+		}
+		return stats;
+	}
+
+protected:
+	void work()
+	{
+		JpegDecoder decoder;
+
+		for(;;)
+		{
+			JOB job;
+			EdsUInt64 index = 0;
+			{
+				std::unique_lock<std::mutex> lock(_jobMutex);
+				_jobCondition.wait(lock, [this]() { return !_running || !_jobs.empty(); });
+				if(!_running)
+				{
+					return;
+				}
+
+				job = _jobs.front();
+				_jobs.pop_front();
+				index = _nextIndex++;
+			}
+
+			DecodedEvfFrameRef decoded = decode(decoder, job, index);
+			deliver(index, decoded);
+		}
+	}
+
+	DecodedEvfFrameRef decode(JpegDecoder& decoder, const JOB& job, EdsUInt64 index)
+	{
+		DecodedEvfFrameRef decoded = std::make_shared<DecodedEvfFrame>();
+		decoded->frame = job.frame;
+		decoded->index = index;
+		decoded->timing = job.frame->getDataSet().timing;
+		decoded->timing.queued = job.queued;
+		decoded->timing.decodeStart = evfClockMicros();
+
+		decoded->image = std::make_shared<DecodedImage>();
+		bool ok = false;
+		switch(job.regionMode)
+		{
+			case kEvfRegion_Fixed:
+				ok = decodeEvfRegion(decoder, *job.frame, job.region, job.regionSpace, *decoded->image, _format, _scale);
+				break;
+			case kEvfRegion_ZoomRect:
+				ok = decodeEvfRegion(decoder, *job.frame, job.frame->getZoomRect(), kEvfCoordinate_JpegLarge, *decoded->image, _format, _scale);
+				break;
+			default:
+				ok = decoder.decode(job.frame->getData(), (size_t)job.frame->getLength(), *decoded->image, _format, _scale);
+				break;
+		}
+
+		if(ok && job.resizeWidth > 0)
+		{
+			// One thread per frame; the workers already run frames side by side
+			DecodedImageRef resized = std::make_shared<DecodedImage>();
+			const DecodedImage& image = *decoded->image;
+			ok = resizeImage(image, *resized, job.resizeWidth, job.resizeHeight, job.resizeFilter, 1);
+			resized->setOrigin(image.getOriginX() * job.resizeWidth / image.getWidth(), image.getOriginY() * job.resizeHeight / image.getHeight());
+			decoded->image = resized;
+		}
+
+		if(ok && _computeStatistics)
+		{
+			computeImageStatistics(*decoded->image, decoded->statistics);
+			decoded->hasStatistics = true;
+		}
+
+		if(ok && _postProcess)
+		{
+			_postProcess(*decoded);
+		}
+		decoded->timing.decodeEnd = evfClockMicros();
+
+		if(!ok)
+		{
+			_failed++;
+			return DecodedEvfFrameRef();
+		}
+
+		_decoded++;
+		return decoded;
+	}
+
+	void deliver(EdsUInt64 index, const DecodedEvfFrameRef& decoded)
+	{
+		std::lock_guard<std::mutex> lock(_deliveryMutex);
+
+		_completed[index] = decoded;
+
+		// Hand on every frame whose predecessors are all out.
+		std::map<EdsUInt64, DecodedEvfFrameRef>::iterator it = _completed.begin();
+		while(it != _completed.end() && it->first == _nextDelivery)
+		{
+			DecodedEvfFrameRef ready = it->second;
+			_completed.erase(it);
+			_nextDelivery++;
+
+			if(ready)
+			{
+				ready->timing.delivered = evfClockMicros();
+				_delivered++;
+				_decodeMicrosTotal += ready->timing.decodeEnd - ready->timing.decodeStart;
+				if(ready->timing.downloadStart != 0)
+				{
+					_latencyMicrosTotal += ready->timing.delivered - ready->timing.downloadStart;
+				}
+
+				_latest = ready;
+				for(size_t i = 0; i < _listeners.size(); i++)
+				{
+					_listeners[i](ready);
+				}
+			}
+
+			it = _completed.begin();
+		}
+
+		_deliveryCondition.notify_all();
+	}
+};
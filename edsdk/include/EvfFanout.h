@@ -0,0 +1,725 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfFanout.h                                                     *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+#include "EvfFrame.h"
+#include "JpegDecoder.h"
+#include "EvfRegion.h"
+#include "ImageKernels.h"
+#include "EDSDK.h"
+
+
+// What one consumer wants out of each live view frame.
+typedef struct _EVF_CONSUMER_SPEC
+{
+	EdsInt32			width;			// 0 for both keeps the region's full size;
+	EdsInt32			height;			// one of them 0 keeps the aspect ratio
+	JpegPixelFormat		format;
+	EvfRegionMode		regionMode;		// kEvfRegion_None for the whole frame
+	EdsRect				region;			// with kEvfRegion_Fixed
+	EvfCoordinateSpace	regionSpace;
+	ResizeFilter		filter;
+}EVF_CONSUMER_SPEC;
+
+// One consumer's image of a frame. Consumers asking for the same output
+// share one image; treat it as read only.
+class EvfFanoutFrame
+{
+public:
+	EvfFrameRef			frame;		// source JPEG and metadata
+	DecodedImageRef		image;
+	EdsUInt64			index;		// frames fanned out, from 1
+	EdsUInt32			consumer;
+	int					scale;		// the frame was decoded at 1/scale
+	EVF_TIMING			timing;
+
+	EvfFanoutFrame() : index(0), consumer(0), scale(1)
+	{
+		memset(&timing, 0, sizeof(timing));
+	}
+};
+
+typedef std::shared_ptr<EvfFanoutFrame> EvfFanoutFrameRef;
+
+// Called on the fan-out thread, consumer by consumer in the order they were added.
+typedef std::function<void(const EvfFanoutFrameRef&)> EvfFanoutListener;
+
+
+typedef struct _EVF_FANOUT_STATISTICS
+{
+	EdsUInt64	submitted;
+	EdsUInt64	dropped;				// replaced in the queue before they were decoded
+	EdsUInt64	frames;					// decoded once and fanned out
+	EdsUInt64	failed;
+	EdsUInt64	outputs;				// images handed to consumers
+	EdsUInt64	sharedOutputs;			// of those, the decoded image itself or another consumer's
+	EdsUInt32	consumerCount;
+	EdsUInt32	queueDepth;
+	EdsInt32	lastScale;				// plan of the last frame
+	EdsInt32	lastDecodeWidth;
+	EdsInt32	lastDecodeHeight;
+	JpegPixelFormat	lastDecodeFormat;
+	EdsUInt64	averageDecodeMicros;
+	EdsUInt64	averageDeriveMicros;	// all outputs of a frame
+	EdsUInt64	averageLatencyMicros;	// download start to the last consumer
+}EVF_FANOUT_STATISTICS;
+
+
+// Decodes each live view frame once for any number of consumers that want
+// it at different sizes, pixel formats and regions. Per frame the plan is
+// one decode at the smallest DCT scale that still covers the largest
+// output, of only the union of the regions asked for and in a colour
+// format one of the consumers wants. Each output is then cut from that
+// image in place and resized, with colour conversion done on the smaller
+// side of the resize. Frames are fanned out on one thread, in order; if
+// it falls behind the oldest waiting frame is dropped.
+class EvfFanout : public EvfFrameSink
+{
+public:
+	enum { kDefaultQueueLimit = 2 };
+
+private:
+	class Worker : public Thread
+	{
+	private:
+		EvfFanout*	_fanout;
+	public:
+		Worker(EvfFanout* fanout) : _fanout(fanout) {}
+		virtual void run() { _fanout->work(); }
+	};
+
+	typedef struct _CONSUMER
+	{
+		EdsUInt32			id;
+		EVF_CONSUMER_SPEC	spec;
+		EvfFanoutListener	listener;
+	}CONSUMER;
+
+	// A consumer's output for one frame
+	typedef struct _TARGET
+	{
+		size_t				consumer;	// into the frame's copy of _consumers
+		EdsRect				source;		// full size image pixels, clipped
+		int					width;
+		int					height;
+		JpegPixelFormat		format;
+		ResizeFilter		filter;
+		int					scale;		// coarsest decode that still covers it
+	}TARGET;
+
+	typedef struct _JOB
+	{
+		EvfFrameRef			frame;
+		EdsUInt64			queued;
+	}JOB;
+
+	EdsUInt32							_queueLimit;
+	int									_threadCount;
+	std::unique_ptr<Worker>				_worker;
+	std::atomic<bool>					_running;
+	THREAD_PLACEMENT					_placement;
+	std::string							_name;
+
+	std::vector<CONSUMER>				_consumers;		// under _jobMutex
+	EdsUInt32							_nextConsumer;
+	std::deque<JOB>						_jobs;
+	std::mutex							_jobMutex;
+	std::condition_variable				_jobCondition;
+
+	std::map<EdsUInt32, EvfFanoutFrameRef>	_latest;	// by consumer
+	std::mutex							_deliveryMutex;
+	std::condition_variable				_deliveryCondition;
+
+	EdsUInt64							_submitted;
+	EdsUInt64							_dropped;
+	EdsUInt64							_frames;
+	EdsUInt64							_failed;
+	EdsUInt64							_outputs;
+	EdsUInt64							_sharedOutputs;
+	EdsInt32							_lastScale;
+	EdsInt32							_lastDecodeWidth;
+	EdsInt32							_lastDecodeHeight;
+	JpegPixelFormat						_lastDecodeFormat;
+	EdsUInt64							_decodeMicrosTotal;
+	EdsUInt64							_deriveMicrosTotal;
+	EdsUInt64							_latencyMicrosTotal;
+	EdsUInt64							_latencyFrames;
+
+	EvfFanout(const EvfFanout&);
+	EvfFanout& operator=(const EvfFanout&);
+
+public:
+	EvfFanout(EdsUInt32 queueLimit = kDefaultQueueLimit)
+		: _queueLimit(queueLimit > 0 ? queueLimit : 1), _threadCount(0), _running(false), _placement(ThreadPlacement::any()), _nextConsumer(1),
+		  _submitted(0), _dropped(0), _frames(0), _failed(0), _outputs(0), _sharedOutputs(0),
+		  _lastScale(0), _lastDecodeWidth(0), _lastDecodeHeight(0), _lastDecodeFormat(kJpegPixelFormat_RGB),
+		  _decodeMicrosTotal(0), _deriveMicrosTotal(0), _latencyMicrosTotal(0), _latencyFrames(0)
+	{
+	}
+
+	virtual ~EvfFanout()
+	{
+		stop();
+	}
+
+	static EVF_CONSUMER_SPEC makeSpec(EdsInt32 width = 0, EdsInt32 height = 0, JpegPixelFormat format = kJpegPixelFormat_RGB, ResizeFilter filter = kResizeFilter_Area)
+	{
+		EVF_CONSUMER_SPEC spec;
+		memset(&spec, 0, sizeof(spec));
+		spec.width = width > 0 ? width : 0;
+		spec.height = height > 0 ? height : 0;
+		spec.format = format;
+		spec.regionMode = kEvfRegion_None;
+		spec.regionSpace = kEvfCoordinate_JpegLarge;
+		spec.filter = filter;
+		return spec;
+	}
+
+	// Threads for each resize and colour conversion, 0 to size them by the work.
+	void setThreadCount(int threadCount)		{ _threadCount = threadCount; }
+
+	// Cores of the worker, e.g. the camera's CAMERA_PLACEMENT::decode; the
+	// row threads it starts inherit them on Linux. The worker is named
+	// "<name>-fan". Set before start().
+	void setPlacement(const THREAD_PLACEMENT& placement, const std::string& name = std::string())
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_placement = placement;
+		_name = name;
+	}
+	int getThreadCount() const					{ return _threadCount; }
+
+	// Taken from the next frame on; returns the consumer's id.
+	EdsUInt32 addConsumer(const EVF_CONSUMER_SPEC& spec, const EvfFanoutListener& listener = EvfFanoutListener())
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		CONSUMER consumer;
+		consumer.id = _nextConsumer++;
+		consumer.spec = spec;
+		consumer.listener = listener;
+		_consumers.push_back(consumer);
+		return consumer.id;
+	}
+
+	bool removeConsumer(EdsUInt32 id)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			std::vector<CONSUMER>::iterator it = _consumers.begin();
+			while(it != _consumers.end() && it->id != id)
+			{
+				++it;
+			}
+			if(it == _consumers.end())
+			{
+				return false;
+			}
+			_consumers.erase(it);
+		}
+		std::lock_guard<std::mutex> lock(_deliveryMutex);
+		_latest.erase(id);
+		return true;
+	}
+
+	bool setConsumerSpec(EdsUInt32 id, const EVF_CONSUMER_SPEC& spec)
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		for(size_t i = 0; i < _consumers.size(); i++)
+		{
+			if(_consumers[i].id == id)
+			{
+				_consumers[i].spec = spec;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	EdsUInt32 getConsumerCount()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		return (EdsUInt32)_consumers.size();
+	}
+
+	bool start()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		if(_running)
+		{
+			return true;
+		}
+
+		_running = true;
+		_worker.reset(new Worker(this));
+		if(!_name.empty())
+		{
+			_worker->setName(_name + "-fan");
+		}
+		_worker->setPlacement(_placement);
+		if(!_worker->start())
+		{
+			_worker.reset();
+			_running = false;
+		}
+		return _running;
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			if(!_running)
+			{
+				return;
+			}
+			_running = false;
+			_jobs.clear();
+		}
+		_jobCondition.notify_all();
+
+		_worker->join();
+		_worker.reset();
+
+		_deliveryCondition.notify_all();
+	}
+
+	bool isRunning() const		{ return _running; }
+
+	// EvfFrameSink: called on the producer thread, never blocks on decoding.
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			if(!_running || _consumers.empty())
+			{
+				return;
+			}
+
+			if(_jobs.size() >= _queueLimit)
+			{
+				_jobs.pop_front();
+				_dropped++;
+			}
+
+			JOB job;
+			job.frame = frame;
+			job.queued = evfClockMicros();
+			_jobs.push_back(job);
+			_submitted++;
+		}
+		_jobCondition.notify_one();
+	}
+
+	// Newest output for a consumer, or empty if none yet.
+	EvfFanoutFrameRef latest(EdsUInt32 consumer)
+	{
+		std::lock_guard<std::mutex> lock(_deliveryMutex);
+		std::map<EdsUInt32, EvfFanoutFrameRef>::iterator it = _latest.find(consumer);
+		return (it != _latest.end()) ? it->second : EvfFanoutFrameRef();
+	}
+
+	// Waits for a consumer's output of a frame after afterIndex; empty on timeout or stop.
+	EvfFanoutFrameRef waitForFrame(EdsUInt32 consumer, EdsUInt64 afterIndex, int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_deliveryMutex);
+		EvfFanoutFrameRef found;
+		_deliveryCondition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [this, consumer, afterIndex, &found]()
+		{
+			std::map<EdsUInt32, EvfFanoutFrameRef>::iterator it = _latest.find(consumer);
+			if(it != _latest.end() && it->second->index > afterIndex)
+			{
+				found = it->second;
+				return true;
+			}
+			return !_running;
+		});
+		return found;
+	}
+
+	EVF_FANOUT_STATISTICS getStatistics()
+	{
+		EVF_FANOUT_STATISTICS stats;
+		memset(&stats, 0, sizeof(stats));
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			stats.submitted = _submitted;
+			stats.dropped = _dropped;
+			stats.queueDepth = (EdsUInt32)_jobs.size();
+			stats.consumerCount = (EdsUInt32)_consumers.size();
+		}
+		std::lock_guard<std::mutex> lock(_deliveryMutex);
+		stats.frames = _frames;
+		stats.failed = _failed;
+		stats.outputs = _outputs;
+		stats.sharedOutputs = _sharedOutputs;
+		stats.lastScale = _lastScale;
+		stats.lastDecodeWidth = _lastDecodeWidth;
+		stats.lastDecodeHeight = _lastDecodeHeight;
+		stats.lastDecodeFormat = _lastDecodeFormat;
+		if(_frames > 0)
+		{
+			stats.averageDecodeMicros = _decodeMicrosTotal / _frames;
+			stats.averageDeriveMicros = _deriveMicrosTotal / _frames;
+		}
+		if(_latencyFrames > 0)
+		{
+			stats.averageLatencyMicros = _latencyMicrosTotal / _latencyFrames;
+		}
+		return stats;
+	}
+
+protected:
+	void work()
+	{
+		JpegDecoder decoder;
+		EdsUInt64 index = 0;
+
+		for(;;)
+		{
+			JOB job;
+			std::vector<CONSUMER> consumers;
+			{
+				std::unique_lock<std::mutex> lock(_jobMutex);
+				_jobCondition.wait(lock, [this]() { return !_running || !_jobs.empty(); });
+				if(!_running)
+				{
+					return;
+				}
+
+				job = _jobs.front();
+				_jobs.pop_front();
+				consumers = _consumers;
+			}
+
+			fanOut(decoder, job, consumers, ++index);
+		}
+	}
+
+	static EdsRect clipRect(const EdsRect& rect, int width, int height)
+	{
+		int left = std::max(0, std::min((int)rect.point.x, width));
+		int top = std::max(0, std::min((int)rect.point.y, height));
+		int right = std::max(left, std::min((int)(rect.point.x + rect.size.width), width));
+		int bottom = std::max(top, std::min((int)(rect.point.y + rect.size.height), height));
+
+		EdsRect clipped;
+		clipped.point.x = left;
+		clipped.point.y = top;
+		clipped.size.width = right - left;
+		clipped.size.height = bottom - top;
+		return clipped;
+	}
+
+	// False if the consumer's region misses this frame.
+	static bool planTarget(const EVF_CONSUMER_SPEC& spec, const EvfFrame& frame, int fullWidth, int fullHeight, TARGET& target)
+	{
+		EdsRect rect;
+		rect.point.x = rect.point.y = 0;
+		rect.size.width = fullWidth;
+		rect.size.height = fullHeight;
+
+		if(spec.regionMode == kEvfRegion_Fixed)
+		{
+			rect = (spec.regionSpace == kEvfCoordinate_JpegLarge) ? evfLargeToImageRect(frame.getDataSet(), fullWidth, fullHeight, spec.region) : spec.region;
+		}
+		else if(spec.regionMode == kEvfRegion_ZoomRect)
+		{
+			rect = evfLargeToImageRect(frame.getDataSet(), fullWidth, fullHeight, frame.getZoomRect());
+		}
+
+		target.source = clipRect(rect, fullWidth, fullHeight);
+		int sourceWidth = target.source.size.width;
+		int sourceHeight = target.source.size.height;
+		if(sourceWidth <= 0 || sourceHeight <= 0)
+		{
+			return false;
+		}
+
+		target.width = spec.width;
+		target.height = spec.height;
+		if(target.width <= 0 && target.height <= 0)
+		{
+			target.width = sourceWidth;
+			target.height = sourceHeight;
+		}
+		else if(target.width <= 0)
+		{
+			target.width = std::max(1, sourceWidth * target.height / sourceHeight);
+		}
+		else if(target.height <= 0)
+		{
+			target.height = std::max(1, sourceHeight * target.width / sourceWidth);
+		}
+
+		// The IDCT scales down for free; never below what the output needs.
+		target.scale = 1;
+		for(int scale = 8; scale > 1; scale /= 2)
+		{
+			if(sourceWidth / scale >= target.width && sourceHeight / scale >= target.height)
+			{
+				target.scale = scale;
+				break;
+			}
+		}
+
+		target.format = spec.format;
+		target.filter = spec.filter;
+		return true;
+	}
+
+	static bool sameOutput(const TARGET& a, const TARGET& b)
+	{
+		return a.width == b.width && a.height == b.height && a.format == b.format && a.filter == b.filter &&
+			a.source.point.x == b.source.point.x && a.source.point.y == b.source.point.y &&
+			a.source.size.width == b.source.size.width && a.source.size.height == b.source.size.height;
+	}
+
+	// Cuts target out of decoded, which starts at the decoded image's origin
+	// at 1/scale. Returns decoded itself when it is already the output.
+	DecodedImageRef derive(const DecodedImageRef& decoded, const TARGET& target, int scale)
+	{
+		const DecodedImage& image = *decoded;
+		int left = std::max(0, std::min((int)target.source.point.x / scale - image.getOriginX(), image.getWidth()));
+		int top = std::max(0, std::min((int)target.source.point.y / scale - image.getOriginY(), image.getHeight()));
+		int right = std::max(left, std::min((int)(target.source.point.x + target.source.size.width + scale - 1) / scale - image.getOriginX(), image.getWidth()));
+		int bottom = std::max(top, std::min((int)(target.source.point.y + target.source.size.height + scale - 1) / scale - image.getOriginY(), image.getHeight()));
+		int cropWidth = right - left;
+		int cropHeight = bottom - top;
+		if(cropWidth <= 0 || cropHeight <= 0)
+		{
+			return DecodedImageRef();
+		}
+
+		bool resize = (cropWidth != target.width || cropHeight != target.height);
+		bool convert = (target.format != image.getFormat());
+		if(!resize && !convert && cropWidth == image.getWidth() && cropHeight == image.getHeight())
+		{
+			return decoded;
+		}
+
+		// The crop is read in place, never copied on its own
+		const unsigned char* crop = image.getPixels() + (size_t)image.getStride() * top + (size_t)left * image.getChannels();
+		int cropStride = image.getStride();
+
+		DecodedImageRef out = std::make_shared<DecodedImage>();
+		out->allocate(target.width, target.height, target.format, 1);
+		out->setOrigin((left + image.getOriginX()) * target.width / cropWidth, (top + image.getOriginY()) * target.height / cropHeight);
+
+		if(resize)
+		{
+			// Resize first so the colour conversion runs on the output size;
+			// gray from colour needs a colour image of that size in between.
+			std::vector<unsigned char> scratch;
+			unsigned char* resized = out->getPixels();
+			int resizedStride = out->getStride();
+			if(convert && target.format == kJpegPixelFormat_Gray)
+			{
+				resizedStride = target.width * image.getChannels();
+				scratch.resize((size_t)resizedStride * target.height);
+				resized = &scratch[0];
+			}
+
+			if(!resizeImage(crop, cropWidth, cropHeight, cropStride, resized, target.width, target.height, resizedStride,
+				image.getChannels(), target.filter, _threadCount))
+			{
+				return DecodedImageRef();
+			}
+
+			if(convert && target.format == kJpegPixelFormat_Gray)
+			{
+				convertToGray(resized, resizedStride, image.getFormat(), out->getPixels(), out->getStride(), target.width, target.height, _threadCount);
+			}
+			else if(convert)
+			{
+				swapRedBlue(out->getPixels(), out->getStride(), out->getPixels(), out->getStride(), target.width, target.height, _threadCount);
+			}
+		}
+		else if(convert && target.format == kJpegPixelFormat_Gray)
+		{
+			convertToGray(crop, cropStride, image.getFormat(), out->getPixels(), out->getStride(), target.width, target.height, _threadCount);
+		}
+		else if(convert)
+		{
+			swapRedBlue(crop, cropStride, out->getPixels(), out->getStride(), target.width, target.height, _threadCount);
+		}
+		else
+		{
+			for(int y = 0; y < target.height; y++)
+			{
+				memcpy(out->getRow(y), crop + (size_t)cropStride * y, (size_t)target.width * image.getChannels());
+			}
+		}
+		return out;
+	}
+
+	void fanOut(JpegDecoder& decoder, const JOB& job, const std::vector<CONSUMER>& consumers, EdsUInt64 index)
+	{
+		const EvfFrame& frame = *job.frame;
+		EVF_TIMING timing = frame.getDataSet().timing;
+		timing.queued = job.queued;
+		timing.decodeStart = evfClockMicros();
+
+		int fullWidth = 0;
+		int fullHeight = 0;
+		if(!decoder.readHeader(frame.getData(), (size_t)frame.getLength(), fullWidth, fullHeight))
+		{
+			std::lock_guard<std::mutex> lock(_deliveryMutex);
+			_failed++;
+			return;
+		}
+
+		// The plan: finest scale, union of the regions, a format someone wants.
+		std::vector<TARGET> targets;
+		int scale = 8;
+		JpegPixelFormat format = kJpegPixelFormat_Gray;
+		int left = fullWidth, top = fullHeight, right = 0, bottom = 0;
+		for(size_t i = 0; i < consumers.size(); i++)
+		{
+			TARGET target;
+			if(!planTarget(consumers[i].spec, frame, fullWidth, fullHeight, target))
+			{
+				continue;
+			}
+			target.consumer = i;
+			targets.push_back(target);
+
+			scale = std::min(scale, target.scale);
+			if(format == kJpegPixelFormat_Gray && target.format != kJpegPixelFormat_Gray)
+			{
+				format = target.format;
+			}
+			left = std::min(left, (int)target.source.point.x);
+			top = std::min(top, (int)target.source.point.y);
+			right = std::max(right, (int)(target.source.point.x + target.source.size.width));
+			bottom = std::max(bottom, (int)(target.source.point.y + target.source.size.height));
+		}
+		if(targets.empty())
+		{
+			return;
+		}
+
+		DecodedImageRef decoded = std::make_shared<DecodedImage>();
+		bool ok;
+		if(left == 0 && top == 0 && right == fullWidth && bottom == fullHeight)
+		{
+			ok = decoder.decode(frame.getData(), (size_t)frame.getLength(), *decoded, format, scale);
+		}
+		else
+		{
+			ok = decoder.decodeRegion(frame.getData(), (size_t)frame.getLength(), *decoded, left, top, right - left, bottom - top, format, scale);
+		}
+		timing.decodeEnd = evfClockMicros();
+
+		if(!ok)
+		{
+			std::lock_guard<std::mutex> lock(_deliveryMutex);
+			_failed++;
+			return;
+		}
+
+		std::vector<EvfFanoutFrameRef> outputs;
+		EdsUInt64 shared = 0;
+		for(size_t i = 0; i < targets.size(); i++)
+		{
+			// Same output as an earlier consumer, or the decode as it is
+			DecodedImageRef image;
+			for(size_t j = 0; j < i && !image; j++)
+			{
+				if(outputs[j] && sameOutput(targets[i], targets[j]))
+				{
+					image = outputs[j]->image;
+				}
+			}
+			if(!image)
+			{
+				image = derive(decoded, targets[i], scale);
+			}
+			bool reused = (image && image == decoded);
+			for(size_t j = 0; j < i && image && !reused; j++)
+			{
+				reused = (outputs[j] && outputs[j]->image == image);
+			}
+			if(reused)
+			{
+				shared++;
+			}
+
+			EvfFanoutFrameRef output;
+			if(image)
+			{
+				output = std::make_shared<EvfFanoutFrame>();
+				output->frame = job.frame;
+				output->image = image;
+				output->index = index;
+				output->consumer = consumers[targets[i].consumer].id;
+				output->scale = scale;
+				output->timing = timing;
+			}
+			outputs.push_back(output);
+		}
+		EdsUInt64 derived = evfClockMicros();
+
+		EdsUInt64 delivered = 0;
+		for(size_t i = 0; i < outputs.size(); i++)
+		{
+			if(!outputs[i])
+			{
+				continue;
+			}
+			outputs[i]->timing.delivered = evfClockMicros();
+			const EvfFanoutListener& listener = consumers[targets[i].consumer].listener;
+			if(listener)
+			{
+				listener(outputs[i]);
+			}
+			delivered++;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_deliveryMutex);
+			for(size_t i = 0; i < outputs.size(); i++)
+			{
+				if(outputs[i])
+				{
+					_latest[outputs[i]->consumer] = outputs[i];
+				}
+			}
+			_frames++;
+			_outputs += delivered;
+			_sharedOutputs += shared;
+			_lastScale = scale;
+			_lastDecodeWidth = decoded->getWidth();
+			_lastDecodeHeight = decoded->getHeight();
+			_lastDecodeFormat = decoded->getFormat();
+			_decodeMicrosTotal += timing.decodeEnd - timing.decodeStart;
+			_deriveMicrosTotal += derived - timing.decodeEnd;
+			if(timing.downloadStart != 0)
+			{
+				_latencyMicrosTotal += evfClockMicros() - timing.downloadStart;
+				_latencyFrames++;
+			}
+		}
+		_deliveryCondition.notify_all();
+	}
+};
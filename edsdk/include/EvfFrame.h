@@ -0,0 +1,144 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfFrame.h                                                      *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "EDSDK.h"
+
+
+// Per-stage timestamps of a live view frame in microseconds of a steady clock.
+// Stages a frame never went through stay 0.
+typedef struct _EVF_TIMING
+{
+	EdsUInt64		downloadStart;
+	EdsUInt64		downloadEnd;
+	EdsUInt64		queued;		// handed to the decode pool
+	EdsUInt64		decodeStart;
+	EdsUInt64		decodeEnd;
+	EdsUInt64		delivered;	// passed on in order to consumers
+}EVF_TIMING;
+
+inline EdsUInt64 evfClockMicros()
+{
+	return (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+typedef struct _EVF_DATASET
+{
+	EdsStreamRef	stream; // JPEG stream.
+	EdsUInt32		zoom;
+	EdsRect			zoomRect;
+	EdsPoint		imagePosition;
+	EdsUInt32		histogram[256 * 4]; //(YRGB) YRGBYRGBYRGBYRGB....
+	EdsSize			sizeJpegLarge;
+	EdsUInt32		metadata;	// kEvfMetadata_ fields that hold a value, the rest are 0
+	EVF_TIMING		timing;
+}EVF_DATASET;
+
+
+// Called instead of EdsRelease when the stream belongs to a pool.
+typedef std::function<void()> EvfFrameRecycler;
+
+
+// One downloaded live view image.
+// Owns the reference to the JPEG stream and releases (or recycles) it when
+// the last holder goes away, so the bytes can be handed out without copying.
+class EvfFrame
+{
+private:
+	EVF_DATASET			_dataSet;
+	EdsVoid*			_data;
+	EdsUInt64			_length;
+	EvfFrameRecycler	_recycler;
+	// Position in the live view stream, 0 if never published.
+	EdsUInt64			_sequence;
+
+	EvfFrame(const EvfFrame&);
+	EvfFrame& operator=(const EvfFrame&);
+
+public:
+	// Takes over the stream reference held by dataSet.
+	EvfFrame(const EVF_DATASET& dataSet) : _dataSet(dataSet), _data(NULL), _length(0), _sequence(0)
+	{
+		if(_dataSet.stream != NULL)
+		{
+			EdsGetPointer(_dataSet.stream, &_data);
+			EdsGetLength(_dataSet.stream, &_length);
+		}
+	}
+
+	// The stream stays owned by whoever supplied recycler; length is the
+	// number of bytes written, since a stream over a fixed buffer always
+	// reports the whole buffer.
+	EvfFrame(const EVF_DATASET& dataSet, EdsUInt64 length, const EvfFrameRecycler& recycler)
+		: _dataSet(dataSet), _data(NULL), _length(length), _recycler(recycler), _sequence(0)
+	{
+		if(_dataSet.stream != NULL)
+		{
+			EdsGetPointer(_dataSet.stream, &_data);
+		}
+	}
+
+	// Bytes that live outside any SDK stream, e.g. a recording; recycler is
+	// told when the frame no longer needs them.
+	EvfFrame(const EVF_DATASET& dataSet, const void* data, EdsUInt64 length, const EvfFrameRecycler& recycler)
+		: _dataSet(dataSet), _data(const_cast<void*>(data)), _length(length), _recycler(recycler), _sequence(0)
+	{
+		_dataSet.stream = NULL;
+	}
+
+	~EvfFrame()
+	{
+		if(_recycler)
+		{
+			_recycler();
+		}
+		else if(_dataSet.stream != NULL)
+		{
+			EdsRelease(_dataSet.stream);
+			_dataSet.stream = NULL;
+		}
+	}
+
+	const EVF_DATASET& getDataSet() const		{ return _dataSet; }
+	EdsStreamRef getStream() const				{ return _dataSet.stream; }
+
+	// JPEG bytes, valid for the lifetime of the frame.
+	const unsigned char* getData() const		{ return static_cast<const unsigned char*>(_data); }
+	EdsUInt64 getLength() const					{ return _length; }
+
+	EdsUInt32 getZoom() const					{ return _dataSet.zoom; }
+	EdsRect getZoomRect() const					{ return _dataSet.zoomRect; }
+	EdsPoint getImagePosition() const			{ return _dataSet.imagePosition; }
+	EdsSize getSizeJpegLarge() const			{ return _dataSet.sizeJpegLarge; }
+	const EdsUInt32* getHistogram() const		{ return _dataSet.histogram; }
+	EdsUInt32 getMetadata() const				{ return _dataSet.metadata; }
+
+	void setSequence(EdsUInt64 sequence)		{ _sequence = sequence; }
+	EdsUInt64 getSequence() const				{ return _sequence; }
+};
+
+typedef std::shared_ptr<EvfFrame> EvfFrameRef;
+
+
+// Receives every frame a live view producer publishes. Called on the
+// producer's thread, so implementations must hand off quickly.
+class EvfFrameSink
+{
+public:
+	virtual ~EvfFrameSink() {}
+	virtual void onEvfFrame(const EvfFrameRef& frame) = 0;
+};
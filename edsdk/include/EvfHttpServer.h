@@ -0,0 +1,749 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfHttpServer.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+#include "EvfFrame.h"
+#include "Trace.h"
+#include "EDSDK.h"
+
+
+#ifdef _WIN32
+typedef SOCKET EvfSocket;
+#define EVF_INVALID_SOCKET INVALID_SOCKET
+#else
+typedef int EvfSocket;
+#define EVF_INVALID_SOCKET (-1)
+#endif
+
+
+typedef struct _EVF_HTTP_CLIENT_STATISTICS
+{
+	std::string	address;			// "host:port" of the peer
+	std::string	path;				// of the request
+	double		maxFps;				// cap of this client, 0 for none
+	EdsUInt64	sent;				// frames written to the socket
+	EdsUInt64	dropped;			// frames replaced before the client took them
+	EdsUInt64	bytes;
+	EdsUInt64	connectedMicros;	// evfClockMicros() at accept
+}EVF_HTTP_CLIENT_STATISTICS;
+
+typedef struct _EVF_HTTP_SERVER_STATISTICS
+{
+	EdsUInt32	clients;			// connected now
+	EdsUInt64	accepted;
+	EdsUInt64	rejected;			// over the client limit
+	EdsUInt64	frames;				// frames offered by the producer
+	EdsUInt64	sent;				// frames written, all clients
+	EdsUInt64	dropped;
+	EdsUInt64	bytes;
+}EVF_HTTP_SERVER_STATISTICS;
+
+
+class EvfHttpServer;
+
+// One connection, served on its own thread. The producer only ever swaps
+// the newest frame into _pending, so a client that cannot keep up skips
+// frames instead of holding up the camera or the other clients.
+class EvfHttpClient : public Thread
+{
+	friend class EvfHttpServer;
+
+private:
+	EvfHttpServer*			_server;
+	EvfSocket				_socket;
+	std::string				_address;
+	std::string				_path;
+
+	std::mutex				_mutex;
+	std::condition_variable	_condition;
+	EvfFrameRef				_pending;
+	bool					_closing;
+	std::atomic<bool>		_finished;
+
+	std::atomic<EdsUInt32>	_maxFpsMillis;		// fps * 1000
+	std::atomic<EdsUInt64>	_sent;
+	std::atomic<EdsUInt64>	_dropped;
+	std::atomic<EdsUInt64>	_bytes;
+	EdsUInt64				_connectedMicros;
+
+	EvfHttpClient(const EvfHttpClient&);
+	EvfHttpClient& operator=(const EvfHttpClient&);
+
+public:
+	EvfHttpClient(EvfHttpServer* server, EvfSocket socket, const std::string& address, double maxFps)
+		: _server(server), _socket(socket), _address(address), _closing(false), _finished(false),
+		  _maxFpsMillis((EdsUInt32)(maxFps * 1000.0 + 0.5)), _sent(0), _dropped(0), _bytes(0),
+		  _connectedMicros(evfClockMicros()) {}
+
+	virtual ~EvfHttpClient()
+	{
+		close();
+		join();
+	}
+
+	// Producer side: newest frame wins
+	void offer(const EvfFrameRef& frame)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_pending)
+			{
+				_dropped++;
+			}
+			_pending = frame;
+		}
+		_condition.notify_one();
+	}
+
+	// Unblocks the sender and ends the connection
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_closing)
+			{
+				return;
+			}
+			_closing = true;
+			if(_socket != EVF_INVALID_SOCKET)
+			{
+#ifdef _WIN32
+				shutdown(_socket, SD_BOTH);
+#else
+				shutdown(_socket, SHUT_RDWR);
+#endif
+			}
+		}
+		_condition.notify_all();
+	}
+
+	bool isFinished() const					{ return _finished; }
+
+	EVF_HTTP_CLIENT_STATISTICS getStatistics() const
+	{
+		EVF_HTTP_CLIENT_STATISTICS stats;
+		stats.address = _address;
+		stats.path = _path;
+		stats.maxFps = _maxFpsMillis.load() / 1000.0;
+		stats.sent = _sent.load();
+		stats.dropped = _dropped.load();
+		stats.bytes = _bytes.load();
+		stats.connectedMicros = _connectedMicros;
+		return stats;
+	}
+
+	virtual void run();
+
+	static void closeSocket(EvfSocket socket)
+	{
+#ifdef _WIN32
+		closesocket(socket);
+#else
+		::close(socket);
+#endif
+	}
+
+	static bool sendAll(EvfSocket socket, const void* data, size_t length)
+	{
+		const char* bytes = (const char*)data;
+		while(length > 0)
+		{
+#ifdef _WIN32
+			int sent = ::send(socket, bytes, (int)std::min<size_t>(length, 1 << 30), 0);
+#elif defined(MSG_NOSIGNAL)
+			ssize_t sent = ::send(socket, bytes, length, MSG_NOSIGNAL);
+#else
+			ssize_t sent = ::send(socket, bytes, length, 0);
+#endif
+			if(sent <= 0)
+			{
+				return false;
+			}
+			bytes += sent;
+			length -= (size_t)sent;
+		}
+		return true;
+	}
+
+private:
+	// Request line and headers, up to the blank line
+	bool readRequest(std::string& method, std::string& target)
+	{
+		std::string request;
+		char buffer[1024];
+		while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+		{
+			int received = (int)::recv(_socket, buffer, sizeof(buffer), 0);
+			if(received <= 0)
+			{
+				return false;
+			}
+			request.append(buffer, (size_t)received);
+		}
+
+		size_t methodEnd = request.find(' ');
+		size_t targetEnd = (methodEnd != std::string::npos) ? request.find(' ', methodEnd + 1) : std::string::npos;
+		if(targetEnd == std::string::npos)
+		{
+			return false;
+		}
+		method = request.substr(0, methodEnd);
+		target = request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+		return true;
+	}
+
+	static bool queryValue(const std::string& query, const char* name, std::string& value)
+	{
+		size_t length = strlen(name);
+		size_t start = 0;
+		while(start < query.size())
+		{
+			size_t end = query.find('&', start);
+			if(end == std::string::npos)
+			{
+				end = query.size();
+			}
+			if(query.compare(start, length, name) == 0 && start + length < end && query[start + length] == '=')
+			{
+				value = query.substr(start + length + 1, end - start - length - 1);
+				return true;
+			}
+			start = end + 1;
+		}
+		return false;
+	}
+
+	bool sendResponse(const char* status, const char* contentType, const char* body)
+	{
+		char header[256];
+		int length = snprintf(header, sizeof(header),
+			"HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n",
+			status, contentType, (unsigned)strlen(body));
+		return sendAll(_socket, header, (size_t)length) && sendAll(_socket, body, strlen(body));
+	}
+
+	// Waits for a frame newer than the last one sent, and for the fps cap
+	EvfFrameRef nextFrame(EdsUInt64 lastSentMicros)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		EdsUInt32 fpsMillis = _maxFpsMillis;
+		if(fpsMillis != 0 && lastSentMicros != 0)
+		{
+			EdsUInt64 due = lastSentMicros + 1000000000ull / fpsMillis;
+			EdsUInt64 now = evfClockMicros();
+			if(due > now)
+			{
+				_condition.wait_for(lock, std::chrono::microseconds(due - now), [this]() { return _closing; });
+			}
+		}
+		_condition.wait(lock, [this]() { return _closing || (bool)_pending; });
+
+		EvfFrameRef frame;
+		if(!_closing)
+		{
+			frame.swap(_pending);
+		}
+		return frame;
+	}
+
+	void serveStream()
+	{
+		static const char kHeader[] =
+			"HTTP/1.0 200 OK\r\n"
+			"Content-Type: multipart/x-mixed-replace; boundary=evfframe\r\n"
+			"Cache-Control: no-cache, no-store\r\n"
+			"Pragma: no-cache\r\n"
+			"Connection: close\r\n\r\n";
+		if(!sendAll(_socket, kHeader, sizeof(kHeader) - 1))
+		{
+			return;
+		}
+
+		EdsUInt64 lastSentMicros = 0;
+		for(;;)
+		{
+			EvfFrameRef frame = nextFrame(lastSentMicros);
+			if(!frame)
+			{
+				return;
+			}
+
+			TraceScope trace("Http", "SendFrame");
+			char part[160];
+			int length = snprintf(part, sizeof(part),
+				"--evfframe\r\nContent-Type: image/jpeg\r\nContent-Length: %llu\r\nX-Sequence: %llu\r\n\r\n",
+				(unsigned long long)frame->getLength(), (unsigned long long)frame->getSequence());
+
+			// The JPEG goes out of the frame's own buffer, shared by every client
+			if(!sendAll(_socket, part, (size_t)length)
+				|| !sendAll(_socket, frame->getData(), (size_t)frame->getLength())
+				|| !sendAll(_socket, "\r\n", 2))
+			{
+				return;
+			}
+
+			lastSentMicros = evfClockMicros();
+			_sent++;
+			_bytes += frame->getLength();
+		}
+	}
+
+	void serveSnapshot(const EvfFrameRef& latest)
+	{
+		EvfFrameRef frame = latest;
+		if(!frame)
+		{
+			frame = nextFrame(0);
+		}
+		if(!frame)
+		{
+			return;
+		}
+
+		char header[192];
+		int length = snprintf(header, sizeof(header),
+			"HTTP/1.0 200 OK\r\nContent-Type: image/jpeg\r\nContent-Length: %llu\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n",
+			(unsigned long long)frame->getLength());
+		if(sendAll(_socket, header, (size_t)length) && sendAll(_socket, frame->getData(), (size_t)frame->getLength()))
+		{
+			_sent++;
+			_bytes += frame->getLength();
+		}
+	}
+};
+
+
+// Serves the live view as MJPEG over HTTP to any number of viewers. Add it
+// as a sink of an EvfPump (or EvfReplay): each frame is downloaded once and
+// the same buffer is written to every client's socket.
+//
+//   GET /stream[?fps=N]   multipart/x-mixed-replace MJPEG, optionally capped
+//   GET /snapshot         the newest frame as one JPEG
+//
+// Every client has its own sender thread and a one frame mailbox, so a slow
+// client drops frames rather than delaying the camera or anyone else.
+class EvfHttpServer : public EvfFrameSink, public Thread
+{
+public:
+	enum { kDefaultMaxClients = 16 };
+
+private:
+	EvfSocket									_listenSocket;
+	EdsUInt16									_port;
+	std::atomic<bool>							_running;
+	std::atomic<EdsUInt32>						_maxClients;
+	std::atomic<EdsUInt32>						_maxFpsMillis;
+
+	std::mutex									_clientMutex;
+	std::vector<std::shared_ptr<EvfHttpClient> >	_clients;
+	EvfFrameRef									_latest;
+
+	std::atomic<EdsUInt64>						_accepted;
+	std::atomic<EdsUInt64>						_rejected;
+	std::atomic<EdsUInt64>						_frames;
+	// Of clients already gone
+	EdsUInt64									_closedSent;
+	EdsUInt64									_closedDropped;
+	EdsUInt64									_closedBytes;
+
+	EvfHttpServer(const EvfHttpServer&);
+	EvfHttpServer& operator=(const EvfHttpServer&);
+
+public:
+	EvfHttpServer()
+		: _listenSocket(EVF_INVALID_SOCKET), _port(0), _running(false), _maxClients(kDefaultMaxClients), _maxFpsMillis(0),
+		  _accepted(0), _rejected(0), _frames(0), _closedSent(0), _closedDropped(0), _closedBytes(0) {}
+
+	virtual ~EvfHttpServer()
+	{
+		stop();
+	}
+
+	// Port 0 picks a free one, see getPort(). Binds to loopback unless an
+	// address such as "0.0.0.0" is given.
+	EdsError start(EdsUInt16 port = 8080, const char* address = "127.0.0.1")
+	{
+		if(_running)
+		{
+			return EDS_ERR_OK;
+		}
+
+#ifdef _WIN32
+		WSADATA data;
+		if(WSAStartup(MAKEWORD(2, 2), &data) != 0)
+		{
+			return EDS_ERR_INTERNAL_ERROR;
+		}
+#endif
+
+		struct sockaddr_in bindAddress;
+		memset(&bindAddress, 0, sizeof(bindAddress));
+		bindAddress.sin_family = AF_INET;
+		bindAddress.sin_port = htons(port);
+		if(inet_pton(AF_INET, address, &bindAddress.sin_addr) != 1)
+		{
+			cleanup();
+			return EDS_ERR_INVALID_PARAMETER;
+		}
+
+		_listenSocket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if(_listenSocket == EVF_INVALID_SOCKET)
+		{
+			cleanup();
+			return EDS_ERR_INTERNAL_ERROR;
+		}
+
+		int reuse = 1;
+		setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+		if(::bind(_listenSocket, (struct sockaddr*)&bindAddress, sizeof(bindAddress)) != 0
+			|| ::listen(_listenSocket, 16) != 0)
+		{
+			cleanup();
+			return EDS_ERR_COMM_PORT_IS_IN_USE;
+		}
+
+		struct sockaddr_in bound;
+		socklen_t boundLength = sizeof(bound);
+		getsockname(_listenSocket, (struct sockaddr*)&bound, &boundLength);
+		_port = ntohs(bound.sin_port);
+
+		_running = true;
+		if(!Thread::start())
+		{
+			_running = false;
+			cleanup();
+			return EDS_ERR_INTERNAL_ERROR;
+		}
+		return EDS_ERR_OK;
+	}
+
+	void stop()
+	{
+		if(!_running)
+		{
+			return;
+		}
+		_running = false;
+		join();
+
+		std::vector<std::shared_ptr<EvfHttpClient> > clients;
+		{
+			std::lock_guard<std::mutex> lock(_clientMutex);
+			clients.swap(_clients);
+			_latest.reset();
+		}
+		for(size_t i = 0; i < clients.size(); i++)
+		{
+			clients[i]->close();
+		}
+		for(size_t i = 0; i < clients.size(); i++)
+		{
+			clients[i]->join();
+			retire(*clients[i]);
+		}
+		cleanup();
+	}
+
+	bool isRunning() const						{ return _running; }
+	EdsUInt16 getPort() const					{ return _port; }
+
+	// Connections past the limit get 503
+	void setMaxClients(EdsUInt32 maxClients)	{ _maxClients = maxClients; }
+	EdsUInt32 getMaxClients() const				{ return _maxClients; }
+
+	// Cap for every client, 0 for none; ?fps= can only lower it
+	void setMaxFps(double fps)					{ _maxFpsMillis = (EdsUInt32)(fps > 0.0 ? fps * 1000.0 + 0.5 : 0); }
+	double getMaxFps() const					{ return _maxFpsMillis.load() / 1000.0; }
+
+	EVF_HTTP_SERVER_STATISTICS getStatistics()
+	{
+		EVF_HTTP_SERVER_STATISTICS stats = {};
+		std::lock_guard<std::mutex> lock(_clientMutex);
+		stats.clients = (EdsUInt32)_clients.size();
+		stats.accepted = _accepted;
+		stats.rejected = _rejected;
+		stats.frames = _frames;
+		stats.sent = _closedSent;
+		stats.dropped = _closedDropped;
+		stats.bytes = _closedBytes;
+		for(size_t i = 0; i < _clients.size(); i++)
+		{
+			stats.sent += _clients[i]->_sent;
+			stats.dropped += _clients[i]->_dropped;
+			stats.bytes += _clients[i]->_bytes;
+		}
+		return stats;
+	}
+
+	std::vector<EVF_HTTP_CLIENT_STATISTICS> getClients()
+	{
+		std::vector<EVF_HTTP_CLIENT_STATISTICS> clients;
+		std::lock_guard<std::mutex> lock(_clientMutex);
+		for(size_t i = 0; i < _clients.size(); i++)
+		{
+			if(!_clients[i]->isFinished())
+			{
+				clients.push_back(_clients[i]->getStatistics());
+			}
+		}
+		return clients;
+	}
+
+	// EvfFrameSink: a pointer swap per client, on the producer's thread
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		_frames++;
+		std::lock_guard<std::mutex> lock(_clientMutex);
+		_latest = frame;
+		for(size_t i = 0; i < _clients.size(); i++)
+		{
+			if(!_clients[i]->_path.empty())
+			{
+				_clients[i]->offer(frame);
+			}
+		}
+	}
+
+	EvfFrameRef getLatest()
+	{
+		std::lock_guard<std::mutex> lock(_clientMutex);
+		return _latest;
+	}
+
+	// Client side: the effective cap for a requested fps
+	double clampFps(double requested) const
+	{
+		double cap = getMaxFps();
+		if(requested <= 0.0)
+		{
+			return cap;
+		}
+		return (cap > 0.0 && cap < requested) ? cap : requested;
+	}
+
+	// Client side: the request was read, frames can be offered now
+	void routed(EvfHttpClient* client, const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(_clientMutex);
+		client->_path = path;
+	}
+
+public:
+	virtual void run()
+	{
+		Tracer::instance().setThreadName("EvfHttpServer");
+
+		while(_running)
+		{
+			fd_set readable;
+			FD_ZERO(&readable);
+			FD_SET(_listenSocket, &readable);
+			struct timeval timeout = { 0, 100000 };
+			int ready = select((int)_listenSocket + 1, &readable, NULL, NULL, &timeout);
+
+			reap();
+
+			if(ready <= 0)
+			{
+				continue;
+			}
+
+			struct sockaddr_in peer;
+			socklen_t peerLength = sizeof(peer);
+			EvfSocket socket = ::accept(_listenSocket, (struct sockaddr*)&peer, &peerLength);
+			if(socket == EVF_INVALID_SOCKET)
+			{
+				continue;
+			}
+
+			char host[INET_ADDRSTRLEN] = "";
+			inet_ntop(AF_INET, &peer.sin_addr, host, sizeof(host));
+			char address[INET_ADDRSTRLEN + 8];
+			snprintf(address, sizeof(address), "%s:%u", host, (unsigned)ntohs(peer.sin_port));
+
+			configureSocket(socket);
+
+			std::shared_ptr<EvfHttpClient> client = std::make_shared<EvfHttpClient>(this, socket, std::string(address), getMaxFps());
+			{
+				std::lock_guard<std::mutex> lock(_clientMutex);
+				if(_clients.size() >= _maxClients)
+				{
+					_rejected++;
+					static const char kBusy[] = "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+					EvfHttpClient::sendAll(socket, kBusy, sizeof(kBusy) - 1);
+					client.reset();
+				}
+				else
+				{
+					_accepted++;
+					_clients.push_back(client);
+				}
+			}
+
+			if(!client)
+			{
+				EvfHttpClient::closeSocket(socket);
+			}
+			else if(!client->start())
+			{
+				// No thread to serve it, so it would never be reaped
+				{
+					std::lock_guard<std::mutex> lock(_clientMutex);
+					_clients.erase(std::find(_clients.begin(), _clients.end(), client));
+					_accepted--;
+					_rejected++;
+				}
+				client->close();
+				EvfHttpClient::closeSocket(socket);
+			}
+		}
+	}
+
+private:
+	static void configureSocket(EvfSocket socket)
+	{
+		int noDelay = 1;
+		setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+		// A viewer that stops reading is let go after a while
+#ifdef _WIN32
+		DWORD timeout = 5000;
+#else
+		struct timeval timeout = { 5, 0 };
+#endif
+		setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+		setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+		int noSigPipe = 1;
+		setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+	}
+
+	void retire(const EvfHttpClient& client)
+	{
+		_closedSent += client._sent;
+		_closedDropped += client._dropped;
+		_closedBytes += client._bytes;
+	}
+
+	// Joins the threads of clients that hung up
+	void reap()
+	{
+		std::vector<std::shared_ptr<EvfHttpClient> > finished;
+		{
+			std::lock_guard<std::mutex> lock(_clientMutex);
+			for(size_t i = 0; i < _clients.size(); )
+			{
+				if(_clients[i]->isFinished())
+				{
+					retire(*_clients[i]);
+					finished.push_back(_clients[i]);
+					_clients.erase(_clients.begin() + i);
+				}
+				else
+				{
+					i++;
+				}
+			}
+		}
+		for(size_t i = 0; i < finished.size(); i++)
+		{
+			finished[i]->join();
+		}
+	}
+
+	void cleanup()
+	{
+		if(_listenSocket != EVF_INVALID_SOCKET)
+		{
+			EvfHttpClient::closeSocket(_listenSocket);
+			_listenSocket = EVF_INVALID_SOCKET;
+		}
+#ifdef _WIN32
+		WSACleanup();
+#endif
+	}
+};
+
+
+inline void EvfHttpClient::run()
+{
+	Tracer::instance().setThreadName("EvfHttpClient");
+
+	std::string method, target;
+	if(readRequest(method, target))
+	{
+		size_t queryStart = target.find('?');
+		std::string path = target.substr(0, queryStart);
+		std::string query = (queryStart != std::string::npos) ? target.substr(queryStart + 1) : std::string();
+
+		std::string fps;
+		double requested = queryValue(query, "fps", fps) ? atof(fps.c_str()) : 0.0;
+		double maxFps = _server->clampFps(requested);
+		_maxFpsMillis = (EdsUInt32)(maxFps > 0.0 ? maxFps * 1000.0 + 0.5 : 0);
+
+		if(method != "GET")
+		{
+			sendResponse("405 Method Not Allowed", "text/plain", "GET only\n");
+		}
+		else if(path == "/" || path == "/stream")
+		{
+			_server->routed(this, path);
+			serveStream();
+		}
+		else if(path == "/snapshot")
+		{
+			_server->routed(this, path);
+			serveSnapshot(_server->getLatest());
+		}
+		else
+		{
+			sendResponse("404 Not Found", "text/plain", "Try /stream or /snapshot\n");
+		}
+	}
+
+	EvfSocket socket;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		socket = _socket;
+		_socket = EVF_INVALID_SOCKET;
+		_pending.reset();
+	}
+	closeSocket(socket);
+	_finished = true;
+}
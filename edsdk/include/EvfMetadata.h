@@ -0,0 +1,208 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfMetadata.h                                                   *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <string.h>
+
+#include "EDSDK.h"
+#include "EvfFrame.h"
+
+
+// Properties of a live view image, each one EdsGetPropertyData call
+enum EvfMetadataField
+{
+	kEvfMetadata_Zoom				= 0x01,
+	kEvfMetadata_ImagePosition		= 0x02,
+	kEvfMetadata_Histogram			= 0x04,
+	kEvfMetadata_ZoomRect			= 0x08,
+	kEvfMetadata_CoordinateSystem	= 0x10,
+	kEvfMetadata_All				= 0x1f,
+	kEvfMetadata_Count				= 5
+};
+
+typedef struct _EVF_METADATA_STATISTICS
+{
+	EdsUInt64	frames;
+	EdsUInt64	reads;			// EdsGetPropertyData calls on live view images
+	EdsUInt64	skipped;		// calls saved against reading every field of every frame
+}EVF_METADATA_STATISTICS;
+
+
+// Which properties are read with each live view image of a camera.
+//
+// Fields read on every frame are always current. Fields read on change are
+// read with the first frame, again after the camera reports a property they
+// follow (Evf_Zoom, Evf_ZoomPosition, ...) and every refreshFrames frames in
+// case an event was missed; frames in between carry the last value. Other
+// fields are only read with the frame after request().
+class EvfMetadataCache
+{
+private:
+	mutable std::mutex			_mutex;
+	EdsUInt32					_everyFrame;
+	EdsUInt32					_onChange;
+	EdsUInt32					_stale;
+	EdsUInt32					_requested;
+	EdsUInt32					_refreshFrames;
+	EdsUInt32					_sinceRefresh;
+
+	// Last value read of each field in _held
+	EVF_DATASET					_last;
+	EdsUInt32					_held;
+	EVF_METADATA_STATISTICS		_stats;
+
+	EvfMetadataCache(const EvfMetadataCache&);
+	EvfMetadataCache& operator=(const EvfMetadataCache&);
+
+	static EdsUInt32 countOf(EdsUInt32 fields)
+	{
+		EdsUInt32 count = 0;
+		for(; fields != 0; fields &= fields - 1)
+		{
+			count++;
+		}
+		return count;
+	}
+
+	static void copyFields(EVF_DATASET& to, const EVF_DATASET& from, EdsUInt32 fields)
+	{
+		if(fields & kEvfMetadata_Zoom)to.zoom = from.zoom;
+		if(fields & kEvfMetadata_ImagePosition)to.imagePosition = from.imagePosition;
+		if(fields & kEvfMetadata_Histogram)memcpy(to.histogram, from.histogram, sizeof(to.histogram));
+		if(fields & kEvfMetadata_ZoomRect)to.zoomRect = from.zoomRect;
+		if(fields & kEvfMetadata_CoordinateSystem)to.sizeJpegLarge = from.sizeJpegLarge;
+	}
+
+public:
+	// The histogram is left out by default, nothing in the pipeline reads it
+	EvfMetadataCache()
+		: _everyFrame(0), _onChange(kEvfMetadata_All & ~kEvfMetadata_Histogram), _stale(kEvfMetadata_All),
+		  _requested(0), _refreshFrames(30), _sinceRefresh(0), _held(0)
+	{
+		memset(&_last, 0, sizeof(_last));
+		memset(&_stats, 0, sizeof(_stats));
+	}
+
+	// A field in both is read on every frame
+	void setFields(EdsUInt32 everyFrame, EdsUInt32 onChange)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_everyFrame = everyFrame & kEvfMetadata_All;
+		_onChange = onChange & kEvfMetadata_All & ~_everyFrame;
+		_stale = kEvfMetadata_All;
+	}
+
+	EdsUInt32 getEveryFrame() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _everyFrame;
+	}
+
+	EdsUInt32 getOnChange() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _onChange;
+	}
+
+	// On change fields are read again at least this often; 0 only on events
+	void setRefreshFrames(EdsUInt32 frames)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_refreshFrames = frames;
+	}
+
+	EdsUInt32 getRefreshFrames() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _refreshFrames;
+	}
+
+	// Read fields with the next frame, whatever their mode
+	void request(EdsUInt32 fields)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_requested |= fields & kEvfMetadata_All;
+	}
+
+	// On change fields among these are read with the next frame
+	void invalidate(EdsUInt32 fields)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stale |= fields;
+	}
+
+	// A property the camera reported as changed
+	void propertyChanged(EdsPropertyID propertyID)
+	{
+		switch(propertyID)
+		{
+		case kEdsPropID_Evf_Zoom:
+			invalidate(kEvfMetadata_Zoom | kEvfMetadata_ImagePosition | kEvfMetadata_ZoomRect | kEvfMetadata_CoordinateSystem);
+			break;
+		case kEdsPropID_Evf_ZoomPosition:
+			invalidate(kEvfMetadata_ImagePosition | kEvfMetadata_ZoomRect);
+			break;
+		case kEdsPropID_Evf_AFMode:
+			invalidate(kEvfMetadata_ZoomRect);
+			break;
+		case kEdsPropID_Evf_Mode:
+		case kEdsPropID_Evf_OutputDevice:
+		case kEdsPropID_Unknown:
+			invalidate(kEvfMetadata_All);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Fields to read with the frame about to be downloaded
+	EdsUInt32 beginFrame()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_refreshFrames != 0 && ++_sinceRefresh >= _refreshFrames)
+		{
+			_stale |= _onChange;
+			_sinceRefresh = 0;
+		}
+
+		EdsUInt32 fields = _everyFrame | _requested | (_onChange & _stale);
+		_stale &= ~fields;
+		_requested = 0;
+		return fields;
+	}
+
+	// After the download: wanted is what beginFrame() returned, read what
+	// was read without error. Carries the last value of the on change
+	// fields not read and sets dataSet.metadata.
+	void endFrame(EVF_DATASET& dataSet, EdsUInt32 wanted, EdsUInt32 read)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stale |= wanted & ~read;
+
+		copyFields(_last, dataSet, read);
+		_held |= read;
+
+		EdsUInt32 carried = _held & _onChange & ~read;
+		copyFields(dataSet, _last, carried);
+		dataSet.metadata = read | carried;
+
+		_stats.frames++;
+		_stats.reads += countOf(wanted);
+		_stats.skipped += kEvfMetadata_Count - countOf(wanted);
+	}
+
+	EVF_METADATA_STATISTICS getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _stats;
+	}
+};
@@ -0,0 +1,477 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfPump.h                                                       *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+#include "CameraModel.h"
+#include "DownloadEvfCommand.h"
+#include "EvfFrame.h"
+#include "EDSDK.h"
+
+
+// What the pump does once maxInFlight frames are waiting unread
+enum EvfDropPolicy
+{
+	kEvfDropPolicy_DropOldest = 0,	// keep downloading; the oldest unread frame is lost
+	kEvfDropPolicy_DropNewest,		// stop downloading until a reader catches up
+};
+
+
+typedef struct _EVF_PUMP_STATISTICS
+{
+	EdsUInt64	published;		// frames written to the ring
+	EdsUInt64	dropped;		// frames replaced before anyone read them
+	EdsUInt64	notReady;		// downloads answered with EDS_ERR_OBJECT_NOTREADY
+	EdsUInt64	errors;			// other download failures
+	EdsUInt64	lastSequence;	// sequence of the newest frame
+	double		achievedFps;	// recent publish rate, 0 when stalled
+	EdsUInt64	inFlight;		// published frames no reader has taken yet
+	EdsUInt64	throttled;		// downloads delayed to hold the target fps
+	EdsUInt64	stalls;			// times downloading stopped for slow readers
+	EdsUInt64	stallMicros;	// time spent stopped
+}EVF_PUMP_STATISTICS;
+
+
+// Pulls live view frames on its own thread as fast as the camera delivers
+// them, instead of one "downloadEVF" command per frame through the shared
+// command queue.
+// Frames go into a ring of N slots; readers always get the newest complete
+// frame and older ones are simply overwritten.
+// A target fps spaces downloads out to save USB bandwidth. A frame counts as
+// in flight from being published until a reader takes it or a sink has seen
+// it; the drop policy decides what happens once maxInFlight are waiting.
+class EvfPump : public Thread
+{
+public:
+	enum { kDefaultSlotCount = 3, kDefaultMaxInFlight = 1, kRateWindowMicros = 500000 };
+
+private:
+	CameraModel*				_model;
+
+	// Ring of the last frames; slot = sequence % size.
+	std::vector<EvfFrameRef>	_ring;
+	// Sequence of the newest published frame, 0 while empty.
+	std::atomic<EdsUInt64>		_sequence;
+	// Highest sequence handed to a reader.
+	std::atomic<EdsUInt64>		_readSequence;
+
+	std::atomic<bool>			_running;
+
+	// Back-off while the camera has no new image or is busy
+	int							_notReadyWaitMillis;
+	int							_busyWaitMillis;
+	int							_idleWaitMillis;
+
+	// Pacing; an interval of 0 downloads as fast as the camera allows
+	std::atomic<EdsUInt64>		_frameIntervalMicros;
+	std::atomic<EdsUInt32>		_maxInFlight;
+	std::atomic<int>			_dropPolicy;
+	EdsUInt64					_nextDueMicros;
+
+	std::atomic<EdsUInt64>		_dropped;
+	std::atomic<EdsUInt64>		_notReady;
+	std::atomic<EdsUInt64>		_errors;
+	std::atomic<EdsUInt64>		_throttled;
+	std::atomic<EdsUInt64>		_stalls;
+	std::atomic<EdsUInt64>		_stallMicros;
+	// Publish rate over the last completed window, in millihertz
+	EdsUInt64					_windowStartMicros;
+	EdsUInt64					_windowFrames;
+	std::atomic<EdsUInt64>		_achievedMilliFps;
+	std::atomic<EdsUInt64>		_lastPublishMicros;
+
+	// Only used to sleep the pump and wake readers; the ring itself is not locked.
+	std::mutex					_waitMutex;
+	std::condition_variable		_frameCondition;
+	std::condition_variable		_stopCondition;
+
+	// Downstream stages fed from the pump thread
+	std::vector<EvfFrameSink*>	_sinks;
+	std::mutex					_sinkMutex;
+
+public:
+	EvfPump(CameraModel *model, EdsUInt32 slotCount = kDefaultSlotCount)
+		: _model(model), _ring(slotCount > 0 ? slotCount : 1), _sequence(0), _readSequence(0), _running(false),
+		  _notReadyWaitMillis(5), _busyWaitMillis(50), _idleWaitMillis(100),
+		  _frameIntervalMicros(0), _maxInFlight(kDefaultMaxInFlight), _dropPolicy(kEvfDropPolicy_DropOldest), _nextDueMicros(0),
+		  _dropped(0), _notReady(0), _errors(0), _throttled(0), _stalls(0), _stallMicros(0),
+		  _windowStartMicros(0), _windowFrames(0), _achievedMilliFps(0), _lastPublishMicros(0) {}
+
+	virtual ~EvfPump()
+	{
+		stop();
+	}
+
+	bool start()
+	{
+		if(_running)
+		{
+			return true;
+		}
+
+		// The camera's I/O placement, unless the caller gave one
+		CAMERA_PLACEMENT placement = _model->getPlacement();
+		if(getName().empty() && placement.name[0] != '\0')
+		{
+			setName(std::string(placement.name) + "-evf");
+		}
+		if(ThreadPlacement::isAny(getPlacement()))
+		{
+			setPlacement(placement.io);
+		}
+
+		_running = true;
+		if(!Thread::start())
+		{
+			_running = false;
+		}
+		return _running;
+	}
+
+	void stop()
+	{
+		if(!_running)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_waitMutex);
+			_running = false;
+		}
+		_stopCondition.notify_all();
+		_frameCondition.notify_all();
+		join();
+	}
+
+	bool isRunning() const						{ return _running; }
+	EdsUInt32 getSlotCount() const				{ return (EdsUInt32)_ring.size(); }
+
+	void setNotReadyWait(int millisec)			{ _notReadyWaitMillis = millisec; }
+	void setBusyWait(int millisec)				{ _busyWaitMillis = millisec; }
+	void setIdleWait(int millisec)				{ _idleWaitMillis = millisec; }
+
+	// fps 0 downloads as fast as the camera delivers
+	void setTargetFps(double fps)
+	{
+		_frameIntervalMicros = fps > 0 ? (EdsUInt64)(1000000.0 / fps) : 0;
+	}
+
+	double getTargetFps() const
+	{
+		EdsUInt64 interval = _frameIntervalMicros.load();
+		return interval > 0 ? 1000000.0 / interval : 0;
+	}
+
+	// Clamped to the slot count, since more unread frames than slots
+	// cannot be kept
+	void setMaxInFlight(EdsUInt32 frames)
+	{
+		_maxInFlight = std::max<EdsUInt32>(1, std::min<EdsUInt32>(frames, getSlotCount()));
+		wakePump();
+	}
+
+	EdsUInt32 getMaxInFlight() const			{ return _maxInFlight; }
+
+	void setDropPolicy(EvfDropPolicy policy)
+	{
+		_dropPolicy = policy;
+		wakePump();
+	}
+
+	EvfDropPolicy getDropPolicy() const			{ return (EvfDropPolicy)_dropPolicy.load(); }
+
+	// Sinks get every published frame on the pump thread.
+	// Remove a sink before destroying it.
+	void addSink(EvfFrameSink* sink)
+	{
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		if(std::find(_sinks.begin(), _sinks.end(), sink) == _sinks.end())
+		{
+			_sinks.push_back(sink);
+		}
+	}
+
+	void removeSink(EvfFrameSink* sink)
+	{
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		_sinks.erase(std::remove(_sinks.begin(), _sinks.end(), sink), _sinks.end());
+	}
+
+	// Newest complete frame, or empty if none arrived yet.
+	EvfFrameRef latest()
+	{
+		for(;;)
+		{
+			EdsUInt64 sequence = _sequence.load(std::memory_order_acquire);
+			if(sequence == 0)
+			{
+				return EvfFrameRef();
+			}
+
+			EvfFrameRef frame = std::atomic_load(&_ring[sequence % _ring.size()]);
+
+			// The slot may have been reused since we read the sequence; try again.
+			if(frame && frame->getSequence() == sequence)
+			{
+				markRead(sequence);
+				return frame;
+			}
+		}
+	}
+
+	// Waits for a frame newer than afterSequence; returns empty on timeout or stop.
+	EvfFrameRef waitForFrame(EdsUInt64 afterSequence, int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_waitMutex);
+		bool arrived = _frameCondition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [this, afterSequence]()
+		{
+			return !_running || _sequence.load(std::memory_order_acquire) > afterSequence;
+		});
+		lock.unlock();
+
+		if(!arrived || _sequence.load(std::memory_order_acquire) <= afterSequence)
+		{
+			return EvfFrameRef();
+		}
+		return latest();
+	}
+
+	EVF_PUMP_STATISTICS getStatistics() const
+	{
+		EVF_PUMP_STATISTICS stats = {};
+		stats.lastSequence = _sequence.load();
+		stats.published = stats.lastSequence;
+		stats.dropped = _dropped.load();
+		stats.notReady = _notReady.load();
+		stats.errors = _errors.load();
+		stats.inFlight = std::min<EdsUInt64>(stats.lastSequence - std::min(stats.lastSequence, _readSequence.load()), _ring.size());
+		stats.throttled = _throttled.load();
+		stats.stalls = _stalls.load();
+		stats.stallMicros = _stallMicros.load();
+
+		// Stale once no frame came for a few windows
+		if(evfClockMicros() - _lastPublishMicros.load() < kRateWindowMicros * 4)
+		{
+			stats.achievedFps = _achievedMilliFps.load() / 1000.0;
+		}
+		return stats;
+	}
+
+public:
+	virtual void run()
+	{
+		//When using the SDK from another thread in Windows,
+		// you must initialize the COM library by calling CoInitialize
+#ifdef _WIN32
+		CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+		std::string name = getName();
+		Tracer::instance().setThreadName(name.empty() ? "EvfPump" : Tracer::instance().intern(name));
+
+		while(_running)
+		{
+			// Wait until PC live view is on.
+			if((_model->getEvfOutputDevice() & kEdsEvfOutputDevice_PC) == 0)
+			{
+				pause(_idleWaitMillis);
+				continue;
+			}
+
+			if(!waitForReaders() || !waitForSchedule())
+			{
+				continue;
+			}
+
+			EdsUInt64 downloadStart = evfClockMicros();
+			EvfFrameRef frame;
+			EdsError err = DownloadEvfCommand::downloadFrame(_model, frame);
+
+			if(err == EDS_ERR_OK)
+			{
+				advanceSchedule(downloadStart);
+				publish(frame);
+			}
+			else if(err == EDS_ERR_OBJECT_NOTREADY)
+			{
+				_notReady++;
+				pause(_notReadyWaitMillis);
+			}
+			else if(err == EDS_ERR_DEVICE_BUSY)
+			{
+				pause(_busyWaitMillis);
+			}
+			else
+			{
+				_errors++;
+				pause(_busyWaitMillis);
+			}
+		}
+
+#ifdef _WIN32
+		CoUninitialize();
+#endif
+	}
+
+protected:
+	void publish(const EvfFrameRef& frame)
+	{
+		EdsUInt64 sequence = _sequence.load(std::memory_order_relaxed) + 1;
+
+		// More frames are waiting than readers may fall behind by.
+		if(sequence > _maxInFlight.load(std::memory_order_relaxed)
+			&& _readSequence.load(std::memory_order_relaxed) < sequence - _maxInFlight.load(std::memory_order_relaxed))
+		{
+			_dropped++;
+		}
+
+		EdsUInt64 now = evfClockMicros();
+		_lastPublishMicros = now;
+		if(_windowStartMicros == 0 || now - _windowStartMicros > kRateWindowMicros * 4)
+		{
+			// First frame, or after a long gap: start counting from here
+			_windowStartMicros = now;
+			_windowFrames = 0;
+		}
+		else
+		{
+			_windowFrames++;
+			if(now - _windowStartMicros >= kRateWindowMicros)
+			{
+				_achievedMilliFps = _windowFrames * 1000000000 / (now - _windowStartMicros);
+				_windowStartMicros = now;
+				_windowFrames = 0;
+			}
+		}
+
+		frame->setSequence(sequence);
+		std::atomic_store(&_ring[sequence % _ring.size()], frame);
+		_sequence.store(sequence, std::memory_order_release);
+
+		_model->setEvfFrame(frame);
+
+		{
+			std::lock_guard<std::mutex> lock(_waitMutex);
+		}
+		_frameCondition.notify_all();
+
+		// Held while calling out so removeSink() does not return mid-call.
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		for(std::vector<EvfFrameSink*>::iterator it = _sinks.begin(); it != _sinks.end(); ++it)
+		{
+			(*it)->onEvfFrame(frame);
+		}
+
+		// A sink saw the frame, so it was not dropped.
+		if(!_sinks.empty())
+		{
+			markRead(sequence);
+		}
+	}
+
+	void markRead(EdsUInt64 sequence)
+	{
+		EdsUInt64 current = _readSequence.load(std::memory_order_relaxed);
+		while(current < sequence && !_readSequence.compare_exchange_weak(current, sequence))
+		{
+		}
+
+		// A pump held back by this reader can go on.
+		if(_dropPolicy.load(std::memory_order_relaxed) == kEvfDropPolicy_DropNewest)
+		{
+			wakePump();
+		}
+	}
+
+	void wakePump()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_waitMutex);
+		}
+		_stopCondition.notify_all();
+	}
+
+	EdsUInt64 inFlight() const
+	{
+		return _sequence.load(std::memory_order_acquire) - _readSequence.load(std::memory_order_acquire);
+	}
+
+	bool readersBehind() const
+	{
+		return _dropPolicy == kEvfDropPolicy_DropNewest && inFlight() >= _maxInFlight;
+	}
+
+	// Under kEvfDropPolicy_DropNewest, holds off downloading while readers
+	// are maxInFlight frames behind. False if the pump is stopping.
+	bool waitForReaders()
+	{
+		if(!readersBehind())
+		{
+			return true;
+		}
+
+		TraceScope trace("Evf", "Backpressure");
+		_stalls++;
+		EdsUInt64 start = evfClockMicros();
+		{
+			std::unique_lock<std::mutex> lock(_waitMutex);
+			_stopCondition.wait(lock, [this]() { return !_running || !readersBehind(); });
+		}
+		_stallMicros += evfClockMicros() - start;
+
+		// Nothing was downloaded meanwhile, so the schedule starts afresh.
+		_nextDueMicros = 0;
+		return _running;
+	}
+
+	// Waits for the next download slot of the target fps
+	bool waitForSchedule()
+	{
+		EdsUInt64 now = evfClockMicros();
+		if(_frameIntervalMicros == 0 || _nextDueMicros <= now)
+		{
+			return _running;
+		}
+
+		TraceScope trace("Evf", "Pace");
+		_throttled++;
+		std::unique_lock<std::mutex> lock(_waitMutex);
+		_stopCondition.wait_for(lock, std::chrono::microseconds(_nextDueMicros - now), [this]()
+		{
+			return !_running || evfClockMicros() >= _nextDueMicros;
+		});
+		return _running;
+	}
+
+	// Fixed rate from the last due time; after falling a whole interval
+	// behind it restarts from now instead of bursting to catch up
+	void advanceSchedule(EdsUInt64 downloadStart)
+	{
+		EdsUInt64 interval = _frameIntervalMicros;
+		EdsUInt64 next = _nextDueMicros + interval;
+		_nextDueMicros = (interval == 0 || next > downloadStart) ? next : downloadStart + interval;
+	}
+
+	void pause(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_waitMutex);
+		_stopCondition.wait_for(lock, std::chrono::milliseconds(millisec), [this]() { return !_running; });
+	}
+};
@@ -0,0 +1,537 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfRecording.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Thread.h"
+#include "CameraModel.h"
+#include "EvfFrame.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include "EDSDK.h"
+
+
+// Live view recording: the camera's own JPEGs with their EVF_DATASET
+// metadata, stored as they came with no decode or re-encode.
+//
+//   header | index[maxFrames] | frame record, JPEG | frame record, JPEG | ...
+//
+// The index is preallocated after the header, so frame n is found without
+// scanning and a time is found by binary search. Records start on 8 byte
+// boundaries. Fields are in the byte order of the recording machine.
+#define EVF_RECORDING_MAGIC			"EVFREC1"
+#define EVF_RECORDING_VERSION		1
+#define EVF_RECORDING_FRAME_MAGIC	0x46465645	// "EVFF"
+
+typedef struct _EVF_RECORDING_HEADER
+{
+	char		magic[8];
+	EdsUInt32	version;
+	EdsUInt32	headerSize;
+	EdsUInt64	maxFrames;			// entries in the index
+	EdsUInt64	frameCount;			// complete frames, written after each frame
+	EdsUInt64	dataOffset;			// first frame record
+	EdsUInt64	dataEnd;			// end of the last complete frame
+	EdsUInt64	durationMicros;		// time of the last frame
+	EdsUInt64	reserved[8];
+}EVF_RECORDING_HEADER;
+
+typedef struct _EVF_RECORDING_INDEX
+{
+	EdsUInt64	offset;				// of the frame record
+	EdsUInt64	timeMicros;			// since the first frame
+}EVF_RECORDING_INDEX;
+
+typedef struct _EVF_RECORDING_FRAME
+{
+	EdsUInt32	magic;
+	EdsUInt32	reserved;
+	EdsUInt64	length;				// JPEG bytes after the record
+	EdsUInt64	sequence;			// in the live view stream it was recorded from
+	EdsUInt64	timeMicros;
+	EdsUInt32	zoom;
+	EdsRect		zoomRect;
+	EdsPoint	imagePosition;
+	EdsSize		sizeJpegLarge;
+	EdsUInt32	histogram[256 * 4];
+}EVF_RECORDING_FRAME;
+
+
+typedef struct _EVF_RECORDER_STATISTICS
+{
+	EdsUInt64	frames;				// recorded
+	EdsUInt64	bytes;				// of the file in use
+	EdsUInt64	capacity;			// bytes reserved
+	EdsUInt64	maxFrames;
+	EdsUInt64	dropped;			// frames that did not fit
+	EdsUInt64	durationMicros;
+}EVF_RECORDER_STATISTICS;
+
+
+// Appends every frame it is given into a preallocated memory-mapped file.
+// A frame costs one copy into the mapping on the producer's thread; when the
+// reserved space or the index is full further frames are counted as dropped.
+class EvfRecorder : public EvfFrameSink
+{
+public:
+	enum { kAverageFrameBytes = 64 * 1024 };
+
+private:
+	MappedFile				_file;
+	EVF_RECORDING_HEADER*	_header;
+	EVF_RECORDING_INDEX*	_index;
+	EdsUInt64				_firstMicros;
+	std::atomic<EdsUInt64>	_dropped;
+	mutable std::mutex		_mutex;
+
+	EvfRecorder(const EvfRecorder&);
+	EvfRecorder& operator=(const EvfRecorder&);
+
+	static EdsUInt64 align(EdsUInt64 offset)
+	{
+		return (offset + 7) & ~(EdsUInt64)7;
+	}
+
+public:
+	EvfRecorder() : _header(NULL), _index(NULL), _firstMicros(0), _dropped(0) {}
+
+	virtual ~EvfRecorder()
+	{
+		close();
+	}
+
+	// Reserves capacity bytes at path. maxFrames 0 sizes the index for
+	// frames of kAverageFrameBytes.
+	EdsError open(const char* path, EdsUInt64 capacity, EdsUInt64 maxFrames = 0)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		closeLocked();
+
+		if(maxFrames == 0)
+		{
+			maxFrames = capacity / kAverageFrameBytes + 1;
+		}
+		EdsUInt64 dataOffset = align(sizeof(EVF_RECORDING_HEADER) + maxFrames * sizeof(EVF_RECORDING_INDEX));
+		if(capacity <= dataOffset + sizeof(EVF_RECORDING_FRAME))
+		{
+			return EDS_ERR_INVALID_PARAMETER;
+		}
+
+		EdsError err = _file.create(path, capacity);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		_header = (EVF_RECORDING_HEADER*)_file.getData();
+		_index = (EVF_RECORDING_INDEX*)(_file.getData() + sizeof(EVF_RECORDING_HEADER));
+		memcpy(_header->magic, EVF_RECORDING_MAGIC, sizeof(_header->magic));
+		_header->version = EVF_RECORDING_VERSION;
+		_header->headerSize = sizeof(EVF_RECORDING_HEADER);
+		_header->maxFrames = maxFrames;
+		_header->frameCount = 0;
+		_header->dataOffset = dataOffset;
+		_header->dataEnd = dataOffset;
+		_header->durationMicros = 0;
+		_firstMicros = 0;
+		_dropped = 0;
+		return EDS_ERR_OK;
+	}
+
+	// Cuts the file down to what was recorded
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		closeLocked();
+	}
+
+	bool isRecording() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _header != NULL;
+	}
+
+	EVF_RECORDER_STATISTICS getStatistics() const
+	{
+		EVF_RECORDER_STATISTICS stats = {};
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_header != NULL)
+		{
+			stats.frames = _header->frameCount;
+			stats.bytes = _header->dataEnd;
+			stats.capacity = _file.getSize();
+			stats.maxFrames = _header->maxFrames;
+			stats.durationMicros = _header->durationMicros;
+		}
+		stats.dropped = _dropped.load();
+		return stats;
+	}
+
+	// EvfFrameSink
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		TraceScope trace("Evf", "Record");
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_header == NULL || !frame)
+		{
+			return;
+		}
+
+		EdsUInt64 offset = _header->dataEnd;
+		EdsUInt64 end = offset + sizeof(EVF_RECORDING_FRAME) + frame->getLength();
+		if(_header->frameCount >= _header->maxFrames || end > _file.getSize())
+		{
+			_dropped++;
+			return;
+		}
+
+		const EVF_DATASET& dataSet = frame->getDataSet();
+		EdsUInt64 stamp = (dataSet.timing.downloadStart != 0) ? dataSet.timing.downloadStart : evfClockMicros();
+		if(_header->frameCount == 0)
+		{
+			_firstMicros = stamp;
+		}
+		EdsUInt64 time = (stamp > _firstMicros) ? stamp - _firstMicros : 0;
+
+		EVF_RECORDING_FRAME* record = (EVF_RECORDING_FRAME*)(_file.getData() + offset);
+		record->magic = EVF_RECORDING_FRAME_MAGIC;
+		record->reserved = 0;
+		record->length = frame->getLength();
+		record->sequence = frame->getSequence();
+		record->timeMicros = time;
+		record->zoom = dataSet.zoom;
+		record->zoomRect = dataSet.zoomRect;
+		record->imagePosition = dataSet.imagePosition;
+		record->sizeJpegLarge = dataSet.sizeJpegLarge;
+		memcpy(record->histogram, dataSet.histogram, sizeof(record->histogram));
+		memcpy(record + 1, frame->getData(), (size_t)frame->getLength());
+
+		EVF_RECORDING_INDEX& entry = _index[_header->frameCount];
+		entry.offset = offset;
+		entry.timeMicros = time;
+
+		// A reader of the live file sees the frame only once it is complete
+		std::atomic_thread_fence(std::memory_order_release);
+		_header->dataEnd = align(end);
+		_header->durationMicros = time;
+		_header->frameCount++;
+	}
+
+private:
+	void closeLocked()
+	{
+		if(_header != NULL)
+		{
+			EdsUInt64 used = _header->dataEnd;
+			_header = NULL;
+			_index = NULL;
+			_file.close(used);
+		}
+	}
+};
+
+
+typedef struct _EVF_REPLAY_STATISTICS
+{
+	EdsUInt64	frameCount;			// in the recording
+	EdsUInt64	durationMicros;
+	EdsUInt64	published;			// frames handed to sinks since start()
+	EdsUInt64	position;			// next frame to publish
+	EdsUInt64	loops;
+}EVF_REPLAY_STATISTICS;
+
+
+// Plays a recording back into EvfFrameSinks on its own thread, at the
+// recorded pace scaled by the speed or as fast as the sinks take them, so a
+// decode or analysis pipeline can be benchmarked offline. Frames point into
+// the mapping and keep it alive; nothing is copied.
+class EvfReplay : public Thread
+{
+private:
+	std::shared_ptr<MappedFile>	_file;
+	const EVF_RECORDING_HEADER*	_header;
+	const EVF_RECORDING_INDEX*	_index;
+	EdsUInt64					_frameCount;
+	CameraModel*				_model;
+
+	std::atomic<bool>			_running;
+	std::atomic<EdsUInt64>		_position;
+	std::atomic<EdsUInt64>		_published;
+	std::atomic<EdsUInt64>		_loops;
+	std::atomic<bool>			_loop;
+	// Stored as speed * 1000; 0 for no pacing
+	std::atomic<EdsUInt32>		_speedMillis;
+
+	std::mutex					_waitMutex;
+	std::condition_variable		_stopCondition;
+
+	std::vector<EvfFrameSink*>	_sinks;
+	std::mutex					_sinkMutex;
+
+	EvfReplay(const EvfReplay&);
+	EvfReplay& operator=(const EvfReplay&);
+
+public:
+	// Frames are also set as the model's latest live view frame when a
+	// model is given
+	EvfReplay(CameraModel* model = NULL)
+		: _header(NULL), _index(NULL), _frameCount(0), _model(model), _running(false),
+		  _position(0), _published(0), _loops(0), _loop(false), _speedMillis(1000) {}
+
+	virtual ~EvfReplay()
+	{
+		stop();
+	}
+
+	EdsError open(const char* path)
+	{
+		stop();
+
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+		EdsError err = file->open(path);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		const EVF_RECORDING_HEADER* header = (const EVF_RECORDING_HEADER*)file->getData();
+		if(file->getSize() < sizeof(EVF_RECORDING_HEADER)
+			|| memcmp(header->magic, EVF_RECORDING_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != EVF_RECORDING_VERSION)
+		{
+			return EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+		}
+		if(header->frameCount > header->maxFrames
+			|| header->dataEnd > file->getSize()
+			|| sizeof(EVF_RECORDING_HEADER) + header->maxFrames * sizeof(EVF_RECORDING_INDEX) > header->dataOffset)
+		{
+			return EDS_ERR_FILE_DATA_CORRUPT;
+		}
+
+		_file = file;
+		_header = header;
+		_index = (const EVF_RECORDING_INDEX*)(file->getData() + sizeof(EVF_RECORDING_HEADER));
+		_frameCount = header->frameCount;
+		_position = 0;
+		return EDS_ERR_OK;
+	}
+
+	bool isOpen() const							{ return _header != NULL; }
+	EdsUInt64 getFrameCount() const				{ return _frameCount; }
+	EdsUInt64 getDurationMicros() const			{ return (_frameCount != 0) ? _index[_frameCount - 1].timeMicros : 0; }
+
+	// 1 plays at the recorded pace, 2 twice as fast, 0 without pauses
+	void setSpeed(double speed)					{ _speedMillis = (EdsUInt32)(speed > 0.0 ? speed * 1000.0 + 0.5 : 0); }
+	double getSpeed() const						{ return _speedMillis.load() / 1000.0; }
+	void setLoop(bool loop)						{ _loop = loop; }
+
+	// Next frame start() or the running replay publishes
+	void seek(EdsUInt64 index)					{ _position = std::min(index, _frameCount); }
+
+	// Index of the last frame at or before timeMicros
+	EdsUInt64 findFrame(EdsUInt64 timeMicros) const
+	{
+		if(_frameCount == 0)
+		{
+			return 0;
+		}
+		const EVF_RECORDING_INDEX* end = _index + _frameCount;
+		const EVF_RECORDING_INDEX* found = std::upper_bound(_index, end, timeMicros,
+			[](EdsUInt64 time, const EVF_RECORDING_INDEX& entry) { return time < entry.timeMicros; });
+		return (found == _index) ? 0 : (EdsUInt64)(found - _index - 1);
+	}
+
+	EdsUInt64 getFrameTime(EdsUInt64 index) const
+	{
+		return (index < _frameCount) ? _index[index].timeMicros : 0;
+	}
+
+	// Frame index of the recording, empty past the end or if it is damaged.
+	// Its download timestamps are set to now.
+	EvfFrameRef frame(EdsUInt64 index) const
+	{
+		if(index >= _frameCount)
+		{
+			return EvfFrameRef();
+		}
+
+		EdsUInt64 offset = _index[index].offset;
+		if(offset < _header->dataOffset || offset + sizeof(EVF_RECORDING_FRAME) > _header->dataEnd)
+		{
+			return EvfFrameRef();
+		}
+		const EVF_RECORDING_FRAME* record = (const EVF_RECORDING_FRAME*)(_file->getData() + offset);
+		if(record->magic != EVF_RECORDING_FRAME_MAGIC || offset + sizeof(EVF_RECORDING_FRAME) + record->length > _header->dataEnd)
+		{
+			return EvfFrameRef();
+		}
+
+		EVF_DATASET dataSet;
+		memset(&dataSet, 0, sizeof(dataSet));
+		dataSet.zoom = record->zoom;
+		dataSet.zoomRect = record->zoomRect;
+		dataSet.imagePosition = record->imagePosition;
+		dataSet.sizeJpegLarge = record->sizeJpegLarge;
+		memcpy(dataSet.histogram, record->histogram, sizeof(dataSet.histogram));
+		dataSet.metadata = kEvfMetadata_All;
+		dataSet.timing.downloadStart = evfClockMicros();
+		dataSet.timing.downloadEnd = dataSet.timing.downloadStart;
+
+		std::shared_ptr<MappedFile> file = _file;
+		EvfFrameRef frame = std::make_shared<EvfFrame>(dataSet, record + 1, record->length, [file]() {});
+		frame->setSequence(index + 1);
+		return frame;
+	}
+
+	void addSink(EvfFrameSink* sink)
+	{
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		if(std::find(_sinks.begin(), _sinks.end(), sink) == _sinks.end())
+		{
+			_sinks.push_back(sink);
+		}
+	}
+
+	void removeSink(EvfFrameSink* sink)
+	{
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		_sinks.erase(std::remove(_sinks.begin(), _sinks.end(), sink), _sinks.end());
+	}
+
+	bool start()
+	{
+		if(_running || _header == NULL)
+		{
+			return _running;
+		}
+
+		_published = 0;
+		_loops = 0;
+		_running = true;
+		if(!Thread::start())
+		{
+			_running = false;
+		}
+		return _running;
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_waitMutex);
+			_running = false;
+		}
+		_stopCondition.notify_all();
+		join();
+	}
+
+	// False once the last frame was published without looping
+	bool isRunning() const						{ return _running; }
+
+	EVF_REPLAY_STATISTICS getStatistics() const
+	{
+		EVF_REPLAY_STATISTICS stats = {};
+		stats.frameCount = _frameCount;
+		stats.durationMicros = getDurationMicros();
+		stats.published = _published.load();
+		stats.position = _position.load();
+		stats.loops = _loops.load();
+		return stats;
+	}
+
+public:
+	virtual void run()
+	{
+		Tracer::instance().setThreadName("EvfReplay");
+
+		// Replay time 0 is mapped to wall clock start, and moved on a
+		// seek, a loop or a change of speed
+		EdsUInt64 start = evfClockMicros();
+		EdsUInt64 startTime = getFrameTime(_position);
+		EdsUInt32 speed = _speedMillis;
+		EdsUInt64 expected = _position;
+
+		while(_running)
+		{
+			EdsUInt64 position = _position;
+			if(position >= _frameCount)
+			{
+				if(!_loop || _frameCount == 0)
+				{
+					break;
+				}
+				_loops++;
+				_position = 0;
+				position = 0;
+			}
+
+			if(position != expected || speed != _speedMillis.load())
+			{
+				speed = _speedMillis;
+				start = evfClockMicros();
+				startTime = getFrameTime(position);
+			}
+
+			if(speed != 0)
+			{
+				EdsUInt64 due = start + (getFrameTime(position) - startTime) * 1000 / speed;
+				EdsUInt64 now = evfClockMicros();
+				if(due > now)
+				{
+					std::unique_lock<std::mutex> lock(_waitMutex);
+					_stopCondition.wait_for(lock, std::chrono::microseconds(due - now), [this]() { return !_running; });
+					if(!_running)
+					{
+						break;
+					}
+				}
+			}
+
+			EvfFrameRef next = frame(position);
+			if(next)
+			{
+				publish(next);
+			}
+
+			// Unless seek() moved it meanwhile
+			EdsUInt64 current = position;
+			_position.compare_exchange_strong(current, position + 1);
+			expected = position + 1;
+		}
+
+		_running = false;
+	}
+
+protected:
+	void publish(const EvfFrameRef& frame)
+	{
+		_published++;
+
+		if(_model != NULL)
+		{
+			_model->setEvfFrame(frame);
+		}
+
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		for(std::vector<EvfFrameSink*>::iterator it = _sinks.begin(); it != _sinks.end(); ++it)
+		{
+			(*it)->onEvfFrame(frame);
+		}
+	}
+};
@@ -0,0 +1,80 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfRegion.h                                                     *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include "EvfFrame.h"
+#include "JpegDecoder.h"
+#include "EDSDK.h"
+
+
+enum EvfCoordinateSpace
+{
+	// Pixels of the live view image itself
+	kEvfCoordinate_Image = 0,
+	// JPEG Large coordinates, as used by the zoom rect and focus points
+	kEvfCoordinate_JpegLarge,
+};
+
+
+enum EvfRegionMode
+{
+	kEvfRegion_None = 0,	// whole frame
+	kEvfRegion_Fixed,		// rectangle set with setRegion()
+	kEvfRegion_ZoomRect,	// each frame's own zoom rect
+};
+
+
+// Maps a rectangle in JPEG Large coordinates to pixels of a live view image
+// of imageWidth x imageHeight. When zoomed, the image shows the area starting
+// at imagePosition, 1/zoom of the JPEG Large size.
+inline EdsRect evfLargeToImageRect(const EVF_DATASET& dataSet, int imageWidth, int imageHeight, const EdsRect& rect)
+{
+	EdsRect result = rect;
+
+	if(dataSet.sizeJpegLarge.width == 0 || dataSet.sizeJpegLarge.height == 0)
+	{
+		return result;
+	}
+
+	EdsInt64 zoom = (dataSet.zoom > 1) ? dataSet.zoom : 1;
+	EdsInt64 largeWidth = dataSet.sizeJpegLarge.width;
+	EdsInt64 largeHeight = dataSet.sizeJpegLarge.height;
+	EdsInt64 originX = (zoom > 1) ? dataSet.imagePosition.x : 0;
+	EdsInt64 originY = (zoom > 1) ? dataSet.imagePosition.y : 0;
+
+	result.point.x = (EdsInt32)((rect.point.x - originX) * imageWidth * zoom / largeWidth);
+	result.point.y = (EdsInt32)((rect.point.y - originY) * imageHeight * zoom / largeHeight);
+	result.size.width = (EdsInt32)(rect.size.width * imageWidth * zoom / largeWidth);
+	result.size.height = (EdsInt32)(rect.size.height * imageHeight * zoom / largeHeight);
+	return result;
+}
+
+
+// Decodes the part of a live view frame covered by region.
+inline bool decodeEvfRegion(JpegDecoder& decoder, const EvfFrame& frame, const EdsRect& region, EvfCoordinateSpace space,
+	DecodedImage& out, JpegPixelFormat format = kJpegPixelFormat_RGB, int scaleDenom = 1)
+{
+	EdsRect rect = region;
+
+	if(space == kEvfCoordinate_JpegLarge)
+	{
+		int width = 0;
+		int height = 0;
+		if(!decoder.readHeader(frame.getData(), (size_t)frame.getLength(), width, height))
+		{
+			return false;
+		}
+		rect = evfLargeToImageRect(frame.getDataSet(), width, height, region);
+	}
+
+	return decoder.decodeRegion(frame.getData(), (size_t)frame.getLength(), out,
+		rect.point.x, rect.point.y, rect.size.width, rect.size.height, format, scaleDenom);
+}
@@ -0,0 +1,240 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : EvfStreamPool.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "EDSDK.h"
+#include "Synchronized.h"
+
+
+typedef struct _EVF_POOL_STATISTICS
+{
+	EdsUInt64	hits;		// acquire() served from the pool
+	EdsUInt64	misses;		// acquire() had to create a new slot
+	EdsUInt32	poolSize;
+	EdsUInt32	bufferSize;
+	EdsUInt32	available;	// slots currently idle in the pool
+}EVF_POOL_STATISTICS;
+
+
+// A preallocated buffer wrapped by a memory stream and an EVF image ref.
+class EvfStreamSlot
+{
+private:
+	std::vector<unsigned char>	_buffer;
+	EdsStreamRef				_stream;
+	EdsEvfImageRef				_evfImage;
+
+	EvfStreamSlot(const EvfStreamSlot&);
+	EvfStreamSlot& operator=(const EvfStreamSlot&);
+
+public:
+	EvfStreamSlot() : _stream(NULL), _evfImage(NULL) {}
+
+	~EvfStreamSlot()
+	{
+		if(_evfImage != NULL)
+		{
+			EdsRelease(_evfImage);
+			_evfImage = NULL;
+		}
+
+		if(_stream != NULL)
+		{
+			EdsRelease(_stream);
+			_stream = NULL;
+		}
+	}
+
+	EdsError create(EdsUInt32 bufferSize)
+	{
+		EdsError err = EDS_ERR_OK;
+
+		_buffer.resize(bufferSize);
+
+		// The SDK writes straight into our buffer.
+		err = EdsCreateMemoryStreamFromPointer(&_buffer[0], _buffer.size(), &_stream);
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsCreateEvfImageRef(_stream, &_evfImage);
+		}
+
+		return err;
+	}
+
+	// Rewind so the next download overwrites the previous image.
+	EdsError rewind()
+	{
+		return EdsSeek(_stream, 0, kEdsSeek_Begin);
+	}
+
+	EdsStreamRef getStream() const			{ return _stream; }
+	EdsEvfImageRef getEvfImage() const		{ return _evfImage; }
+	EdsUInt32 getBufferSize() const			{ return (EdsUInt32)_buffer.size(); }
+};
+
+typedef std::shared_ptr<EvfStreamSlot> EvfStreamSlotRef;
+
+
+// Recycles EVF streams across frames instead of creating a 2 MB memory
+// stream and an EVF image ref for every download.
+// Owned through a shared_ptr; frames keep a weak_ptr so a slot still in
+// use is simply freed if the pool is gone by the time it comes back.
+class EvfStreamPool
+{
+public:
+	enum { kDefaultPoolSize = 3, kDefaultBufferSize = 2 * 1024 * 1024 };
+
+private:
+	std::vector<EvfStreamSlotRef>	_free;
+	EdsUInt32						_poolSize;
+	EdsUInt32						_bufferSize;
+	EdsUInt64						_hits;
+	EdsUInt64						_misses;
+	Synchronized					_syncObject;
+
+public:
+	EvfStreamPool(EdsUInt32 poolSize = kDefaultPoolSize, EdsUInt32 bufferSize = kDefaultBufferSize)
+		: _poolSize(poolSize), _bufferSize(bufferSize), _hits(0), _misses(0) {}
+
+	// Create slots up front so the first frames do not pay for it.
+	EdsError preallocate()
+	{
+		EdsError err = EDS_ERR_OK;
+
+		_syncObject.lock();
+		while(err == EDS_ERR_OK && _free.size() < _poolSize)
+		{
+			EvfStreamSlotRef slot = std::make_shared<EvfStreamSlot>();
+			err = slot->create(_bufferSize);
+			if(err == EDS_ERR_OK)
+			{
+				_free.push_back(slot);
+			}
+		}
+		_syncObject.unlock();
+
+		return err;
+	}
+
+	EdsError acquire(EvfStreamSlotRef& outSlot)
+	{
+		EdsError err = EDS_ERR_OK;
+		EdsUInt32 bufferSize = 0;
+
+		_syncObject.lock();
+		if(!_free.empty())
+		{
+			outSlot = _free.back();
+			_free.pop_back();
+			_hits++;
+		}
+		else
+		{
+			_misses++;
+		}
+		bufferSize = _bufferSize;
+		_syncObject.unlock();
+
+		if(outSlot)
+		{
+			err = outSlot->rewind();
+		}
+		else
+		{
+			outSlot = std::make_shared<EvfStreamSlot>();
+			err = outSlot->create(bufferSize);
+		}
+
+		if(err != EDS_ERR_OK)
+		{
+			outSlot.reset();
+		}
+
+		return err;
+	}
+
+	// Slots beyond the pool size or of a stale buffer size are dropped.
+	void release(const EvfStreamSlotRef& slot)
+	{
+		if(!slot)
+		{
+			return;
+		}
+
+		_syncObject.lock();
+		if(_free.size() < _poolSize && slot->getBufferSize() == _bufferSize)
+		{
+			_free.push_back(slot);
+		}
+		_syncObject.unlock();
+	}
+
+	void setPoolSize(EdsUInt32 poolSize)
+	{
+		_syncObject.lock();
+		_poolSize = poolSize;
+		if(_free.size() > _poolSize)
+		{
+			_free.resize(_poolSize);
+		}
+		_syncObject.unlock();
+	}
+
+	void setBufferSize(EdsUInt32 bufferSize)
+	{
+		_syncObject.lock();
+		if(bufferSize != _bufferSize)
+		{
+			_bufferSize = bufferSize;
+			_free.clear();
+		}
+		_syncObject.unlock();
+	}
+
+	EdsUInt32 getPoolSize() const		{ return _poolSize; }
+	EdsUInt32 getBufferSize() const		{ return _bufferSize; }
+
+	EVF_POOL_STATISTICS getStatistics()
+	{
+		EVF_POOL_STATISTICS stats = {};
+
+		_syncObject.lock();
+		stats.hits = _hits;
+		stats.misses = _misses;
+		stats.poolSize = _poolSize;
+		stats.bufferSize = _bufferSize;
+		stats.available = (EdsUInt32)_free.size();
+		_syncObject.unlock();
+
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		_syncObject.lock();
+		_hits = 0;
+		_misses = 0;
+		_syncObject.unlock();
+	}
+
+	void clear()
+	{
+		_syncObject.lock();
+		_free.clear();
+		_syncObject.unlock();
+	}
+};
+
+typedef std::shared_ptr<EvfStreamPool> EvfStreamPoolRef;
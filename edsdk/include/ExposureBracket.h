@@ -0,0 +1,373 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ExposureBracket.h                                               *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraController.h"
+#include "RetryPolicy.h"
+#include "ShootPipeline.h"
+#include "Trace.h"
+
+
+// Properties an exposure setting changes
+enum ExposureField
+{
+	kExposureField_Tv				= 0x01,
+	kExposureField_Av				= 0x02,
+	kExposureField_Iso				= 0x04,
+	kExposureField_Compensation		= 0x08,
+	kExposureField_All				= 0x0f
+};
+
+// Values are the EDSDK property codes (kEdsPropID_Tv, ...); fields not
+// set are left as the camera has them.
+typedef struct _EXPOSURE_SETTING
+{
+	EdsUInt32	fields;
+	EdsUInt32	tv;
+	EdsUInt32	av;
+	EdsUInt32	iso;
+	EdsUInt32	exposureComp;
+}EXPOSURE_SETTING;
+
+// One frame of an exposure bracket. Times are evfClockMicros().
+typedef struct _EXPOSURE_BRACKET_SHOT
+{
+	EdsUInt32			index;			// from 0
+	EXPOSURE_SETTING	setting;		// what the frame was shot with
+	EdsUInt32			propertySets;	// properties that had to change
+	EdsUInt32			busyRetries;
+	EdsError			error;
+	EdsUInt64			setStartMicros;
+	EdsUInt64			setEndMicros;
+	SHOT_TIMING			timing;			// of the shot, once its files are in
+	ShotFutureRef		shot;
+}EXPOSURE_BRACKET_SHOT;
+
+typedef struct _EXPOSURE_BRACKET_RESULT
+{
+	bool								success;
+	EdsError							error;
+	EdsUInt32							released;
+	EdsUInt32							completed;
+	EdsUInt32							propertySets;	// including the restore
+	EdsUInt64							elapsedMicros;	// run() to the last file
+	std::vector<EXPOSURE_BRACKET_SHOT>	shots;
+}EXPOSURE_BRACKET_RESULT;
+
+
+// Exposure bracketing, for HDR: one frame per setting. The next setting is
+// applied as soon as the previous release has returned, only the
+// properties that change, and a busy camera is asked again after a few
+// milliseconds rather than the processor's half second. Frames are
+// released without waiting for downloads; the ShootPipeline ties each
+// frame's files to its setting and its max in flight paces the run.
+// run() blocks; cancel() may be called from any thread.
+class ExposureBracket
+{
+public:
+	enum { kDefaultShotTimeoutMillis = 30000 };
+
+private:
+	CameraController*				_controller;
+	CameraModel*					_model;
+	ShootPipelineRef				_pipeline;
+
+	std::vector<EXPOSURE_SETTING>	_settings;
+	RETRY_POLICY					_busyPolicy;
+	RetryPolicyTable				_delays;
+	bool							_restore;
+	int								_shotTimeoutMillis;
+
+	std::atomic<bool>				_cancelled;
+
+	// Values the camera has, as far as this bracket knows
+	EXPOSURE_SETTING				_current;
+
+public:
+	// The pipeline must be started; its files and decoding apply to every frame
+	ExposureBracket(CameraController* controller, const ShootPipelineRef& pipeline)
+		: _controller(controller), _model(controller->getCameraModel()), _pipeline(pipeline),
+		  _busyPolicy(RetryPolicyTable::makePolicy(5, 1.5, 50, 0.2, 0, 5000)),
+		  _restore(true), _shotTimeoutMillis(kDefaultShotTimeoutMillis), _cancelled(false)
+	{
+		memset(&_current, 0, sizeof(_current));
+	}
+
+	static EXPOSURE_SETTING makeSetting(EdsUInt32 fields, EdsUInt32 tv, EdsUInt32 av, EdsUInt32 iso, EdsUInt32 exposureComp)
+	{
+		EXPOSURE_SETTING setting;
+		setting.fields = fields & kExposureField_All;
+		setting.tv = tv;
+		setting.av = av;
+		setting.iso = iso;
+		setting.exposureComp = exposureComp;
+		return setting;
+	}
+
+	void addSetting(const EXPOSURE_SETTING& setting)			{ _settings.push_back(setting); }
+	void setSettings(const std::vector<EXPOSURE_SETTING>& settings)	{ _settings = settings; }
+	void clearSettings()										{ _settings.clear(); }
+	const std::vector<EXPOSURE_SETTING>& getSettings() const	{ return _settings; }
+
+	// How a property set the camera answers busy is retried
+	void setBusyPolicy(const RETRY_POLICY& policy)				{ _busyPolicy = policy; }
+	RETRY_POLICY getBusyPolicy() const							{ return _busyPolicy; }
+	// Set the properties back to what they were once the last frame is released
+	void setRestore(bool restore)								{ _restore = restore; }
+	void setShotTimeout(int millisec)							{ _shotTimeoutMillis = millisec; }
+
+	void cancel()												{ _cancelled = true; }
+	bool isCancelled() const									{ return _cancelled; }
+
+	bool run(EXPOSURE_BRACKET_RESULT& result)
+	{
+		result.success = false;
+		result.error = EDS_ERR_OK;
+		result.released = 0;
+		result.completed = 0;
+		result.propertySets = 0;
+		result.elapsedMicros = 0;
+		result.shots.clear();
+		result.shots.reserve(_settings.size());
+
+		_cancelled = false;
+		EdsUInt64 started = evfClockMicros();
+
+		if(!_pipeline || !_pipeline->isRunning() || _settings.empty())
+		{
+			result.error = _settings.empty() ? EDS_ERR_INVALID_PARAMETER : EDS_ERR_OBJECT_NOTREADY;
+			return false;
+		}
+
+		// Only what the bracket will touch is read, and restored
+		EdsUInt32 touched = 0;
+		for(size_t i = 0; i < _settings.size(); i++)
+		{
+			touched |= _settings[i].fields;
+		}
+		_current = makeSetting(touched,
+			(touched & kExposureField_Tv) ? _model->getTv() : 0,
+			(touched & kExposureField_Av) ? _model->getAv() : 0,
+			(touched & kExposureField_Iso) ? _model->getIso() : 0,
+			(touched & kExposureField_Compensation) ? _model->getExposureCompensation() : 0);
+		for(EdsUInt32 field = kExposureField_Tv; field <= kExposureField_Compensation; field <<= 1)
+		{
+			if(valueOf(_current, field) == 0xffffffff)
+			{
+				_current.fields &= ~field;
+			}
+		}
+		EXPOSURE_SETTING original = _current;
+
+		ShotFutureRef previous;
+		for(size_t index = 0; index < _settings.size() && !_cancelled; index++)
+		{
+			EXPOSURE_BRACKET_SHOT shot;
+			memset(&shot.timing, 0, sizeof(shot.timing));
+			shot.index = (EdsUInt32)index;
+			shot.setting = _settings[index];
+			shot.propertySets = 0;
+			shot.busyRetries = 0;
+			shot.error = EDS_ERR_OK;
+
+			// Settings must not change under the previous exposure
+			if(previous && !released(previous, result))
+			{
+				break;
+			}
+
+			shot.setStartMicros = evfClockMicros();
+			EdsError err = apply(shot.setting, shot.propertySets, shot.busyRetries);
+			shot.setEndMicros = evfClockMicros();
+			result.propertySets += shot.propertySets;
+			if(err != EDS_ERR_OK || _cancelled)
+			{
+				shot.error = (err != EDS_ERR_OK) ? err : EDS_ERR_OPERATION_CANCELLED;
+				result.error = shot.error;
+				result.shots.push_back(shot);
+				break;
+			}
+
+			// Blocks while the pipeline has max in flight
+			shot.shot = _pipeline->shoot(_shotTimeoutMillis);
+			if(!shot.shot)
+			{
+				shot.error = _pipeline->isRunning() ? EDS_ERR_DEVICE_BUSY : EDS_ERR_OPERATION_CANCELLED;
+				result.error = shot.error;
+				result.shots.push_back(shot);
+				break;
+			}
+			result.released++;
+			previous = shot.shot;
+			result.shots.push_back(shot);
+		}
+
+		if(previous)
+		{
+			released(previous, result);
+		}
+
+		// Runs while the last frames are still downloading
+		if(_restore)
+		{
+			EdsUInt32 sets = 0, retries = 0;
+			EdsError err = apply(original, sets, retries);
+			result.propertySets += sets;
+			if(result.error == EDS_ERR_OK)
+			{
+				result.error = err;
+			}
+		}
+
+		for(size_t i = 0; i < result.shots.size(); i++)
+		{
+			EXPOSURE_BRACKET_SHOT& shot = result.shots[i];
+			if(!shot.shot)
+			{
+				continue;
+			}
+			shot.error = shot.shot->wait(_shotTimeoutMillis) ? shot.shot->getError() : EDS_ERR_WAIT_TIMEOUT_ERROR;
+			shot.timing = shot.shot->getTiming();
+
+			if(shot.error == EDS_ERR_OK)
+			{
+				result.completed++;
+			}
+			else if(result.error == EDS_ERR_OK)
+			{
+				result.error = shot.error;
+			}
+		}
+
+		result.elapsedMicros = evfClockMicros() - started;
+		if(result.error == EDS_ERR_OK && _cancelled)
+		{
+			result.error = EDS_ERR_OPERATION_CANCELLED;
+		}
+		result.success = (result.error == EDS_ERR_OK && result.completed == _settings.size());
+		return result.success;
+	}
+
+protected:
+	bool released(const ShotFutureRef& shot, EXPOSURE_BRACKET_RESULT& result)
+	{
+		if(!shot->waitReleased(_shotTimeoutMillis))
+		{
+			result.error = EDS_ERR_WAIT_TIMEOUT_ERROR;
+			return false;
+		}
+		if(shot->isDone() && shot->getError() != EDS_ERR_OK)
+		{
+			result.error = shot->getError();
+			return false;
+		}
+		return true;
+	}
+
+	// ISO and Av first: with the camera in an auto mode they move Tv
+	EdsError apply(const EXPOSURE_SETTING& setting, EdsUInt32& sets, EdsUInt32& retries)
+	{
+		static const EdsUInt32 order[] = { kExposureField_Iso, kExposureField_Av, kExposureField_Tv, kExposureField_Compensation };
+
+		for(size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+		{
+			EdsUInt32 field = order[i];
+			if(!(setting.fields & field))
+			{
+				continue;
+			}
+
+			EdsUInt32 value = valueOf(setting, field);
+			if((_current.fields & field) && valueOf(_current, field) == value)
+			{
+				continue;
+			}
+
+			EdsError err = setProperty(propertyOf(field), value, retries);
+			if(err != EDS_ERR_OK)
+			{
+				// Unknown now, set again next time
+				_current.fields &= ~field;
+				return err;
+			}
+			setValue(_current, field, value);
+			_current.fields |= field;
+			sets++;
+		}
+		return EDS_ERR_OK;
+	}
+
+	EdsError setProperty(EdsPropertyID propertyID, EdsUInt32 value, EdsUInt32& retries)
+	{
+		EdsUInt64 first = evfClockMicros();
+		for(EdsUInt32 attempt = 1; ; attempt++)
+		{
+			EdsError err;
+			{
+				TraceScope trace("EDSDK", "EdsSetPropertyData");
+				err = EdsSetPropertyData(_model->getCameraObject(), propertyID, 0, sizeof(value), &value);
+				trace.setArg("error", err);
+			}
+			if((err & EDS_ERRORID_MASK) != EDS_ERR_DEVICE_BUSY || _cancelled)
+			{
+				return err;
+			}
+
+			retries++;
+			EdsUInt64 elapsedMillis = (evfClockMicros() - first) / 1000;
+			if((_busyPolicy.maxAttempts != 0 && attempt >= _busyPolicy.maxAttempts) ||
+			   (_busyPolicy.deadlineMillis != 0 && elapsedMillis >= _busyPolicy.deadlineMillis))
+			{
+				return err;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(_delays.delayMillis(_busyPolicy, attempt)));
+		}
+	}
+
+	static EdsPropertyID propertyOf(EdsUInt32 field)
+	{
+		switch(field)
+		{
+		case kExposureField_Tv:		return kEdsPropID_Tv;
+		case kExposureField_Av:		return kEdsPropID_Av;
+		case kExposureField_Iso:	return kEdsPropID_ISOSpeed;
+		default:					return kEdsPropID_ExposureCompensation;
+		}
+	}
+
+	static EdsUInt32 valueOf(const EXPOSURE_SETTING& setting, EdsUInt32 field)
+	{
+		switch(field)
+		{
+		case kExposureField_Tv:		return setting.tv;
+		case kExposureField_Av:		return setting.av;
+		case kExposureField_Iso:	return setting.iso;
+		default:					return setting.exposureComp;
+		}
+	}
+
+	static void setValue(EXPOSURE_SETTING& setting, EdsUInt32 field, EdsUInt32 value)
+	{
+		switch(field)
+		{
+		case kExposureField_Tv:		setting.tv = value; break;
+		case kExposureField_Av:		setting.av = value; break;
+		case kExposureField_Iso:	setting.iso = value; break;
+		default:					setting.exposureComp = value; break;
+		}
+	}
+};
@@ -0,0 +1,326 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : FocusBracket.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraController.h"
+#include "DriveLensCommand.h"
+#include "RetryPolicy.h"
+#include "ShootPipeline.h"
+#include "Trace.h"
+
+
+// One slice of a focus bracket. Times are evfClockMicros().
+typedef struct _FOCUS_BRACKET_SLICE
+{
+	EdsUInt32		index;			// from 0
+	EdsInt32		position;		// lens steps from the start, positive toward far
+	EdsUInt32		driveCommands;	// sent before this slice's release
+	EdsUInt32		busyRetries;	// drive commands the camera answered busy
+	EdsError		error;
+	EdsUInt64		driveStartMicros;
+	EdsUInt64		driveEndMicros;
+	EdsUInt64		settledMicros;
+	SHOT_TIMING		timing;			// of the shot, once its files are in
+	ShotFutureRef	shot;
+}FOCUS_BRACKET_SLICE;
+
+
+typedef struct _FOCUS_BRACKET_RESULT
+{
+	bool							success;
+	EdsError						error;
+	EdsUInt32						released;		// slices shot
+	EdsUInt32						completed;		// slices with all their files
+	EdsUInt32						lensSteps;		// drive commands, including the return
+	EdsInt32						endPosition;	// where the lens was left
+	EdsUInt64						elapsedMicros;	// run() to the last file
+	std::vector<FOCUS_BRACKET_SLICE>	slices;
+}FOCUS_BRACKET_RESULT;
+
+
+// Focus bracketing for stacking: count slices, the lens driven
+// stepsPerSlice steps of stepSize (kEdsEvfDriveLens_Near/Far1..3) between
+// them. Each slice is driven, left to settle and released without AF as
+// soon as the previous release has returned; its files are downloaded and
+// decoded by the ShootPipeline while the lens moves on, so the transfers
+// overlap the next slices and the pipeline's max in flight paces the run.
+// Needs live view on; the lens is best left in MF.
+// run() blocks; cancel() may be called from any thread.
+class FocusBracket
+{
+public:
+	enum { kDefaultSettleMillis = 100, kDefaultShotTimeoutMillis = 30000 };
+
+private:
+	CameraController*	_controller;
+	CameraModel*		_model;
+	ShootPipelineRef	_pipeline;
+
+	int					_stepSize;
+	EdsUInt32			_stepsPerSlice;
+	EdsUInt32			_count;
+	bool				_towardFar;
+	EdsUInt32			_settleMillis;
+	bool				_returnToStart;
+	int					_shotTimeoutMillis;
+
+	std::atomic<bool>	_cancelled;
+	EdsInt32			_position;
+
+public:
+	// The pipeline must be started; its files and decoding apply to every slice
+	FocusBracket(CameraController* controller, const ShootPipelineRef& pipeline)
+		: _controller(controller), _model(controller->getCameraModel()), _pipeline(pipeline),
+		  _stepSize(1), _stepsPerSlice(1), _count(10), _towardFar(true), _settleMillis(kDefaultSettleMillis),
+		  _returnToStart(false), _shotTimeoutMillis(kDefaultShotTimeoutMillis), _cancelled(false), _position(0) {}
+
+	// stepSize 1 to 3 is the Near1/Far1 to Near3/Far3 drive
+	void setSteps(EdsUInt32 count, int stepSize, EdsUInt32 stepsPerSlice)
+	{
+		_count = (count > 0) ? count : 1;
+		_stepSize = (stepSize < 1) ? 1 : (stepSize > 3 ? 3 : stepSize);
+		_stepsPerSlice = (stepsPerSlice > 0) ? stepsPerSlice : 1;
+	}
+
+	void setTowardFar(bool far)						{ _towardFar = far; }
+	// Wait after the last drive of a slice before its release
+	void setSettle(EdsUInt32 millisec)				{ _settleMillis = millisec; }
+	// Drive back to the first slice once the last one is released
+	void setReturnToStart(bool back)				{ _returnToStart = back; }
+	void setShotTimeout(int millisec)				{ _shotTimeoutMillis = millisec; }
+
+	EdsUInt32 getCount() const						{ return _count; }
+	int getStepSize() const							{ return _stepSize; }
+	EdsUInt32 getStepsPerSlice() const				{ return _stepsPerSlice; }
+
+	void cancel()									{ _cancelled = true; }
+	bool isCancelled() const						{ return _cancelled; }
+
+	bool run(FOCUS_BRACKET_RESULT& result)
+	{
+		result.success = false;
+		result.error = EDS_ERR_OK;
+		result.released = 0;
+		result.completed = 0;
+		result.lensSteps = 0;
+		result.endPosition = 0;
+		result.elapsedMicros = 0;
+		result.slices.clear();
+		result.slices.reserve(_count);
+
+		_cancelled = false;
+		_position = 0;
+		EdsUInt64 started = evfClockMicros();
+
+		if(!_pipeline || !_pipeline->isRunning())
+		{
+			result.error = EDS_ERR_OBJECT_NOTREADY;
+			return false;
+		}
+
+		// DriveLensEvf works with live view only
+		if(_model->getEvfOutputDevice() == 0)
+		{
+			result.error = EDS_ERR_INVALID_PARAMETER;
+			return false;
+		}
+
+		bool autoFocus = _pipeline->getAutoFocus();
+		_pipeline->setAutoFocus(false);
+
+		ShotFutureRef previous;
+		for(EdsUInt32 index = 0; index < _count && !_cancelled && result.error == EDS_ERR_OK; index++)
+		{
+			FOCUS_BRACKET_SLICE slice;
+			memset(&slice.timing, 0, sizeof(slice.timing));
+			slice.index = index;
+			slice.driveCommands = 0;
+			slice.busyRetries = 0;
+			slice.error = EDS_ERR_OK;
+
+			// The lens must not move during the previous exposure
+			if(previous && !released(previous, result))
+			{
+				break;
+			}
+
+			slice.driveStartMicros = evfClockMicros();
+			if(index > 0)
+			{
+				int direction = _towardFar ? 1 : -1;
+				if(!drive(direction, _stepsPerSlice, slice, result))
+				{
+					slice.error = result.error;
+					result.slices.push_back(slice);
+					break;
+				}
+			}
+			slice.driveEndMicros = evfClockMicros();
+
+			if(index > 0 && _settleMillis > 0)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(_settleMillis));
+			}
+			slice.settledMicros = evfClockMicros();
+			slice.position = _position;
+
+			if(_cancelled)
+			{
+				break;
+			}
+
+			// Blocks while the pipeline has max in flight
+			slice.shot = _pipeline->shoot(_shotTimeoutMillis);
+			if(!slice.shot)
+			{
+				slice.error = _pipeline->isRunning() ? EDS_ERR_DEVICE_BUSY : EDS_ERR_OPERATION_CANCELLED;
+				result.error = slice.error;
+				result.slices.push_back(slice);
+				break;
+			}
+			result.released++;
+			previous = slice.shot;
+			result.slices.push_back(slice);
+		}
+
+		if(previous)
+		{
+			released(previous, result);
+		}
+
+		if(_returnToStart && _position != 0)
+		{
+			// Runs while the last slices are still downloading
+			FOCUS_BRACKET_SLICE back;
+			back.driveCommands = 0;
+			back.busyRetries = 0;
+			EdsError err = result.error;
+			result.error = EDS_ERR_OK;
+			drive(_position > 0 ? -1 : 1, (EdsUInt32)(_position > 0 ? _position : -_position), back, result);
+			if(err != EDS_ERR_OK)
+			{
+				result.error = err;
+			}
+		}
+		result.endPosition = _position;
+
+		for(size_t i = 0; i < result.slices.size(); i++)
+		{
+			FOCUS_BRACKET_SLICE& slice = result.slices[i];
+			if(!slice.shot)
+			{
+				continue;
+			}
+			if(!slice.shot->wait(_shotTimeoutMillis))
+			{
+				slice.error = EDS_ERR_WAIT_TIMEOUT_ERROR;
+			}
+			else
+			{
+				slice.error = slice.shot->getError();
+			}
+			slice.timing = slice.shot->getTiming();
+
+			if(slice.error == EDS_ERR_OK)
+			{
+				result.completed++;
+			}
+			else if(result.error == EDS_ERR_OK)
+			{
+				result.error = slice.error;
+			}
+		}
+
+		_pipeline->setAutoFocus(autoFocus);
+
+		result.elapsedMicros = evfClockMicros() - started;
+		if(result.error == EDS_ERR_OK && _cancelled)
+		{
+			result.error = EDS_ERR_OPERATION_CANCELLED;
+		}
+		result.success = (result.error == EDS_ERR_OK && result.completed == _count);
+		return result.success;
+	}
+
+protected:
+	bool released(const ShotFutureRef& shot, FOCUS_BRACKET_RESULT& result)
+	{
+		if(!shot->waitReleased(_shotTimeoutMillis))
+		{
+			result.error = EDS_ERR_WAIT_TIMEOUT_ERROR;
+			return false;
+		}
+		if(shot->isDone() && shot->getError() != EDS_ERR_OK)
+		{
+			result.error = shot->getError();
+			return false;
+		}
+		return true;
+	}
+
+	// Busy answers, which come while the camera writes a frame, are retried
+	// with the processor's busy policy for DriveLens.
+	bool drive(int direction, EdsUInt32 count, FOCUS_BRACKET_SLICE& slice, FOCUS_BRACKET_RESULT& result)
+	{
+		EdsUInt32 parameter = (direction > 0)
+			? (_stepSize == 1 ? kEdsEvfDriveLens_Far1 : (_stepSize == 2 ? kEdsEvfDriveLens_Far2 : kEdsEvfDriveLens_Far3))
+			: (_stepSize == 1 ? kEdsEvfDriveLens_Near1 : (_stepSize == 2 ? kEdsEvfDriveLens_Near2 : kEdsEvfDriveLens_Near3));
+
+		RetryPolicyTable& policies = _controller->getRetryPolicies();
+		RETRY_POLICY policy = policies.getPolicy("DriveLens", kRetryError_Busy);
+
+		for(EdsUInt32 i = 0; i < count; i++)
+		{
+			EdsUInt64 first = evfClockMicros();
+			EdsUInt32 attempts = 0;
+			EdsError err = EDS_ERR_OK;
+			for(;;)
+			{
+				if(_cancelled)
+				{
+					return true;
+				}
+
+				err = DriveLensCommand::drive(_model, parameter);
+				attempts++;
+				if((err & EDS_ERRORID_MASK) != EDS_ERR_DEVICE_BUSY)
+				{
+					break;
+				}
+
+				slice.busyRetries++;
+				EdsUInt64 elapsedMillis = (evfClockMicros() - first) / 1000;
+				if((policy.maxAttempts != 0 && attempts >= policy.maxAttempts) ||
+				   (policy.deadlineMillis != 0 && elapsedMillis >= policy.deadlineMillis))
+				{
+					break;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(policies.delayMillis(policy, attempts)));
+			}
+
+			if(err != EDS_ERR_OK)
+			{
+				result.error = err;
+				return false;
+			}
+			_position += direction;
+			slice.driveCommands++;
+			result.lensSteps++;
+		}
+		return true;
+	}
+};
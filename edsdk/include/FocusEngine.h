@@ -0,0 +1,374 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : FocusEngine.h                                                   *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "CameraModel.h"
+#include "DownloadEvfCommand.h"
+#include "DriveLensCommand.h"
+#include "EvfFrame.h"
+#include "EvfPump.h"
+#include "EvfRegion.h"
+#include "JpegDecoder.h"
+#include "Sharpness.h"
+#include "EDSDK.h"
+
+
+typedef struct _FOCUS_SAMPLE
+{
+	EdsInt32	phase;		// 0 coarse, 1 fine
+	EdsInt32	position;	// lens steps of the phase from where it started
+	double		score;
+	EdsUInt64	captured;	// evfClockMicros() at download start of the scored frame
+}FOCUS_SAMPLE;
+
+
+typedef struct _FOCUS_RESULT
+{
+	bool						success;
+	EdsError					error;
+	// Peak of the coarse phase, in coarse steps from the start position
+	EdsInt32					bestPosition;
+	// Peak of the fine phase, in fine steps from the coarse peak
+	EdsInt32					bestFinePosition;
+	double						bestScore;
+	EdsUInt32					lensSteps;	// drive commands sent, including the return to the peak
+	EdsUInt32					frames;		// frames scored
+	EdsUInt64					elapsedMicros;
+	std::vector<FOCUS_SAMPLE>	curve;		// every sample in the order taken
+}FOCUS_RESULT;
+
+
+// Contrast-detect autofocus: steps the lens with kEdsCameraCommand_DriveLensEvf
+// and scores the region of interest of the next live view frame after each
+// step, climbing until the score has fallen for a few steps in a row. The
+// lens is then driven back to the peak, optionally followed by the same
+// climb with a finer step.
+// Lens steps are relative and not calibrated, so positions are counted in
+// steps of the phase's own size.
+// Frames come from an EvfPump if one is given, otherwise they are downloaded
+// on the calling thread. run() blocks; cancel() may be called from any thread.
+class FocusEngine
+{
+public:
+	enum { kDefaultMaxSteps = 40, kDefaultPatience = 2 };
+
+private:
+	CameraModel*		_model;
+	EvfPump*			_pump;
+	JpegDecoder			_decoder;
+	DecodedImage		_image;
+
+	FocusMetric			_metric;
+	EvfRegionMode		_regionMode;
+	EdsRect				_region;
+	EvfCoordinateSpace	_regionSpace;
+	int					_scale;
+
+	// kEdsEvfDriveLens_Far1..3 sizes; 0 skips the fine phase
+	int					_coarseStep;
+	int					_fineStep;
+	bool				_startFar;
+	int					_maxSteps;
+	int					_patience;
+	// Relative gain a score needs to count as better
+	double				_threshold;
+	// Frames thrown away after each step while the lens settles
+	int					_settleFrames;
+	int					_frameTimeoutMillis;
+
+	std::atomic<bool>	_cancelled;
+	EdsUInt64			_lastSequence;
+
+public:
+	FocusEngine(CameraModel *model, EvfPump *pump = NULL)
+		: _model(model), _pump(pump), _metric(kFocusMetric_Tenengrad), _regionMode(kEvfRegion_ZoomRect),
+		  _regionSpace(kEvfCoordinate_JpegLarge), _scale(1), _coarseStep(2), _fineStep(1), _startFar(true),
+		  _maxSteps(kDefaultMaxSteps), _patience(kDefaultPatience), _threshold(0.01), _settleFrames(1),
+		  _frameTimeoutMillis(2000), _cancelled(false), _lastSequence(0)
+	{
+		memset(&_region, 0, sizeof(_region));
+	}
+
+	void setMetric(FocusMetric metric)				{ _metric = metric; }
+	FocusMetric getMetric() const					{ return _metric; }
+
+	void setRegion(const EdsRect& region, EvfCoordinateSpace space)
+	{
+		_region = region;
+		_regionSpace = space;
+		_regionMode = kEvfRegion_Fixed;
+	}
+
+	// Score the zoom rect of each frame; this is the default.
+	void followZoomRect()							{ _regionMode = kEvfRegion_ZoomRect; }
+	void clearRegion()								{ _regionMode = kEvfRegion_None; }
+	EvfRegionMode getRegionMode() const				{ return _regionMode; }
+
+	void setScale(int scaleDenom)					{ _scale = JpegDecoder::isValidScale(scaleDenom) ? scaleDenom : 1; }
+	int getScale() const							{ return _scale; }
+
+	void setSteps(int coarseStep, int fineStep)
+	{
+		_coarseStep = (coarseStep < 1) ? 1 : (coarseStep > 3 ? 3 : coarseStep);
+		_fineStep = (fineStep < 0) ? 0 : (fineStep > 3 ? 3 : fineStep);
+	}
+
+	void setStartFar(bool far)						{ _startFar = far; }
+	void setMaxSteps(int steps)						{ _maxSteps = (steps > 0) ? steps : 1; }
+	void setPatience(int steps)						{ _patience = (steps > 0) ? steps : 1; }
+	void setThreshold(double threshold)				{ _threshold = (threshold > 0.0) ? threshold : 0.0; }
+	void setSettleFrames(int frames)				{ _settleFrames = (frames > 0) ? frames : 0; }
+	void setFrameTimeout(int millisec)				{ _frameTimeoutMillis = millisec; }
+
+	void cancel()									{ _cancelled = true; }
+	bool isCancelled() const						{ return _cancelled; }
+
+	// Sharpness of one frame's region of interest; negative if it can not be decoded.
+	double score(const EvfFrame& frame)
+	{
+		bool decoded = false;
+		switch(_regionMode)
+		{
+			case kEvfRegion_Fixed:
+				decoded = decodeEvfRegion(_decoder, frame, _region, _regionSpace, _image, kJpegPixelFormat_Gray, _scale);
+				break;
+			case kEvfRegion_ZoomRect:
+				decoded = decodeEvfRegion(_decoder, frame, frame.getZoomRect(), kEvfCoordinate_JpegLarge, _image, kJpegPixelFormat_Gray, _scale);
+				break;
+			default:
+				decoded = _decoder.decode(frame.getData(), (size_t)frame.getLength(), _image, kJpegPixelFormat_Gray, _scale);
+				break;
+		}
+		return decoded ? computeSharpness(_image, _metric) : -1.0;
+	}
+
+	bool run(FOCUS_RESULT& result)
+	{
+		result.success = false;
+		result.error = EDS_ERR_OK;
+		result.bestPosition = 0;
+		result.bestFinePosition = 0;
+		result.bestScore = 0.0;
+		result.lensSteps = 0;
+		result.frames = 0;
+		result.curve.clear();
+
+		_cancelled = false;
+		_lastSequence = 0;
+		EdsUInt64 started = evfClockMicros();
+
+		if(!JpegDecoder::isAvailable())
+		{
+			result.error = EDS_ERR_NOT_SUPPORTED;
+			return false;
+		}
+
+		if((_model->getEvfOutputDevice() & kEdsEvfOutputDevice_PC) == 0)
+		{
+			result.error = EDS_ERR_INVALID_PARAMETER;
+			return false;
+		}
+
+		double startScore = 0.0;
+		bool ok = measure(0, 0, 0, startScore, result);
+
+		if(ok)
+		{
+			ok = climb(0, _coarseStep, startScore, result.bestPosition, result.bestScore, result);
+		}
+
+		if(ok && _fineStep > 0 && !_cancelled)
+		{
+			ok = climb(1, _fineStep, result.bestScore, result.bestFinePosition, result.bestScore, result);
+		}
+
+		result.elapsedMicros = evfClockMicros() - started;
+		result.success = ok && !_cancelled;
+		if(ok && _cancelled)
+		{
+			result.error = EDS_ERR_OPERATION_CANCELLED;
+		}
+		return result.success;
+	}
+
+protected:
+	// One hill climb from the current position, which scored startScore. If
+	// the first direction never improves the climb restarts the other way.
+	// Leaves the lens at the best position found.
+	bool climb(EdsInt32 phase, int step, double startScore, EdsInt32& bestPosition, double& bestScore, FOCUS_RESULT& result)
+	{
+		int direction = _startFar ? 1 : -1;
+		bool reversed = false;
+		EdsInt32 position = 0;
+		int falling = 0;
+
+		bestPosition = 0;
+		bestScore = startScore;
+
+		for(int taken = 0; taken < _maxSteps && !_cancelled; taken++)
+		{
+			if(!drive(step, direction, 1, result))
+			{
+				return false;
+			}
+			position += direction;
+
+			double sample = 0.0;
+			if(!measure(phase, position, evfClockMicros(), sample, result))
+			{
+				return false;
+			}
+
+			if(sample > bestScore * (1.0 + _threshold))
+			{
+				bestScore = sample;
+				bestPosition = position;
+				falling = 0;
+				continue;
+			}
+
+			if(++falling < _patience)
+			{
+				continue;
+			}
+
+			// Nothing better this way; go back past the start without scoring.
+			if(!reversed && bestPosition == 0)
+			{
+				reversed = true;
+				falling = 0;
+				if(!drive(step, -direction, position > 0 ? position : -position, result))
+				{
+					return false;
+				}
+				position = 0;
+				direction = -direction;
+				continue;
+			}
+			break;
+		}
+
+		int back = bestPosition - position;
+		return drive(step, back > 0 ? 1 : -1, back > 0 ? back : -back, result);
+	}
+
+	bool drive(int step, int direction, int count, FOCUS_RESULT& result)
+	{
+		EdsUInt32 parameter = (direction > 0)
+			? (step == 1 ? kEdsEvfDriveLens_Far1 : (step == 2 ? kEdsEvfDriveLens_Far2 : kEdsEvfDriveLens_Far3))
+			: (step == 1 ? kEdsEvfDriveLens_Near1 : (step == 2 ? kEdsEvfDriveLens_Near2 : kEdsEvfDriveLens_Near3));
+
+		for(int i = 0; i < count; i++)
+		{
+			EdsError err = EDS_ERR_DEVICE_BUSY;
+			for(int attempt = 0; attempt < 20 && err == EDS_ERR_DEVICE_BUSY; attempt++)
+			{
+				err = DriveLensCommand::drive(_model, parameter);
+				if(err == EDS_ERR_DEVICE_BUSY)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				}
+			}
+
+			if(err != EDS_ERR_OK)
+			{
+				result.error = err;
+				return false;
+			}
+			result.lensSteps++;
+		}
+		return true;
+	}
+
+	// Scores the first frame captured after notBefore, past the settle frames.
+	bool measure(EdsInt32 phase, EdsInt32 position, EdsUInt64 notBefore, double& sample, FOCUS_RESULT& result)
+	{
+		int skip = (notBefore > 0) ? _settleFrames : 0;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_frameTimeoutMillis);
+
+		for(;;)
+		{
+			if(_cancelled)
+			{
+				return true;
+			}
+
+			if(std::chrono::steady_clock::now() > deadline)
+			{
+				result.error = EDS_ERR_OBJECT_NOTREADY;
+				return false;
+			}
+
+			EvfFrameRef frame;
+			if(!nextFrame(frame, result))
+			{
+				return false;
+			}
+
+			if(!frame || frame->getDataSet().timing.downloadStart < notBefore)
+			{
+				continue;
+			}
+
+			if(skip > 0)
+			{
+				skip--;
+				continue;
+			}
+
+			sample = score(*frame);
+			if(sample < 0.0)
+			{
+				continue;
+			}
+
+			FOCUS_SAMPLE entry = { phase, position, sample, frame->getDataSet().timing.downloadStart };
+			result.curve.push_back(entry);
+			result.frames++;
+			return true;
+		}
+	}
+
+	// Empty frame means try again.
+	bool nextFrame(EvfFrameRef& frame, FOCUS_RESULT& result)
+	{
+		if(_pump != NULL)
+		{
+			frame = _pump->waitForFrame(_lastSequence, 50);
+			if(frame)
+			{
+				_lastSequence = frame->getSequence();
+			}
+			return true;
+		}
+
+		EdsError err = DownloadEvfCommand::downloadFrame(_model, frame);
+		if(err == EDS_ERR_OBJECT_NOTREADY || err == EDS_ERR_DEVICE_BUSY)
+		{
+			frame.reset();
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			return true;
+		}
+
+		if(err != EDS_ERR_OK)
+		{
+			result.error = err;
+			return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,69 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : GetPropertiesCommand.h                                          *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+
+#pragma once
+
+#include "Command.h"
+#include "CameraEvent.h"
+#include "GetPropertyCommand.h"
+#include "EDSDK.h"
+
+// Reads a set of properties in one pass and sends a single
+// "PropertiesChanged" notification with the IDs whose value changed.
+class GetPropertiesCommand : public Command
+{
+private:
+	PropertyIDList _propertyIDs;
+
+
+public:
+	GetPropertiesCommand(CameraModel *model, const PropertyIDList& propertyIDs)
+		:Command(model), _propertyIDs(propertyIDs){}
+
+	virtual CommandPriority getPriority() const {return kCommandPriority_Background;}
+
+
+	virtual const char* getName() const {return "GetProperties";}
+
+	// Execute command  	
+	virtual bool execute()
+	{
+		EdsError err = EDS_ERR_OK;
+		PropertyIDList changed;
+
+		//Get property values
+		err = GetPropertyCommand::readProperties(_model, _propertyIDs, changed);
+
+		// It retries it at device busy
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY )
+		{
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+			return false;
+		}
+
+		//Update notification
+		CameraEvent e(kCameraEvent_PropertiesChanged, &changed);
+		_model->notifyObservers(&e);
+
+		//Notification of error
+		if(err != EDS_ERR_OK)
+		{
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
+			_model->notifyObservers(&e);
+		}
+
+		return true;	
+	}
+
+};
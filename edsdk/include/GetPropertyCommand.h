@@ -28,8 +28,14 @@ private:
 
 public:
 	GetPropertyCommand(CameraModel *model, EdsPropertyID propertyID)
-		:_propertyID(propertyID), Command(model){}
+		:Command(model), _propertyID(propertyID){}
 
+	virtual CommandPriority getPriority() const {return kCommandPriority_Background;}
+
+	virtual EdsUInt64 getCoalesceKey() const {return makeCoalesceKey(kCommandCoalesce_Property, _propertyID);}
+
+
+	virtual const char* getName() const {return "GetProperty";}
 
 	// Execute command  	
 	virtual bool execute()
@@ -48,111 +54,224 @@ public:
 			// It retries it at device busy
 			if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY )
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
+		_model->notePropertyFetched(_propertyID, false, err);
 		return true;	
 	
 	}
 
-private:
-	EdsError getProperty(EdsPropertyID propertyID)
+public:
+	// Reads a property into the model without notifying observers.
+	// outChanged is set when the value differs from the one the model held.
+	static EdsError readProperty(CameraModel* model, EdsPropertyID propertyID, bool* outChanged = NULL)
 	{
 		EdsError err = EDS_ERR_OK;
 		EdsDataType	dataType = kEdsDataType_Unknown;
 		EdsUInt32   dataSize = 0;
+		bool		changed = true;
 
-		if(propertyID == kEdsPropID_Unknown)
+		//Acquisition of the property size, once per session for fixed-size types
+		PROPERTY_INFO info;
+		bool cached = model->getPropertyInfoCache().find(propertyID, info);
+		if(cached)
 		{
-			//If unknown is returned for the property ID , the required property must be retrieved again
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_AEModeSelect);
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_Tv);
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_Av);
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_ISOSpeed);
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_MeteringMode);
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_ExposureCompensation);
-			if(err == EDS_ERR_OK) err = getProperty(kEdsPropID_ImageQuality);
-			
-			return err;
+			dataType = info.dataType;
+			dataSize = info.size;
 		}
-	
-		//Acquisition of the property size
-		if(err == EDS_ERR_OK)
+		else
 		{
-			err = EdsGetPropertySize( _model->getCameraObject(),
-									  propertyID,
-									  0,
-									  &dataType,
-									  &dataSize );
+			{
+				TraceScope trace("EDSDK", "EdsGetPropertySize");
+				err = EdsGetPropertySize( model->getCameraObject(),
+										  propertyID,
+										  0,
+										  &dataType,
+										  &dataSize );
+				trace.setArg("error", err);
+			}
+
+			if(err == EDS_ERR_OK)
+			{
+				model->getPropertyInfoCache().add(propertyID, dataType, dataSize);
+			}
 		}
 
 		if(err == EDS_ERR_OK)
 		{
-			
-			if(dataType == kEdsDataType_UInt32)
+			if(dataSize <= PROPERTY_VALUE_MAX)
 			{
-				EdsUInt32 data;
+				unsigned char data[PROPERTY_VALUE_MAX] = {0};
 
 				//Acquisition of the property
-				err = EdsGetPropertyData( _model->getCameraObject(),
-										propertyID,
-										0,
-										dataSize,
-										&data );
-
-				//Acquired property value is set
-				if(err == EDS_ERR_OK)
 				{
-					_model->setPropertyUInt32(propertyID, data);
+					TraceScope trace("EDSDK", "EdsGetPropertyData");
+					err = EdsGetPropertyData( model->getCameraObject(),
+											propertyID,
+											0,
+											dataSize,
+											data );
+					trace.setArg("error", err);
 				}
-			}
-			
-			if(dataType == kEdsDataType_String)
-			{
-				
-				EdsChar str[EDS_MAX_NAME];
-				//Acquisition of the property
-				err = EdsGetPropertyData( _model->getCameraObject(),
-										propertyID,
-										0,
-										dataSize,
-										str );
 
 				//Acquired property value is set
 				if(err == EDS_ERR_OK)
 				{
-					_model->setPropertyString(propertyID, str);
-				}			
+					if(dataType == kEdsDataType_String)
+					{
+						data[PROPERTY_VALUE_MAX - 1] = 0;
+						changed = model->setPropertyString(propertyID, (EdsChar*)data);
+					}
+					else
+					{
+						changed = model->setPropertyData(propertyID, dataType, data, dataSize);
+					}
+				}
 			}
-			if(dataType == kEdsDataType_FocusInfo)
+			else if(dataType == kEdsDataType_FocusInfo)
 			{
 				EdsFocusInfo focusInfo;
 				//Acquisition of the property
-				err = EdsGetPropertyData( _model->getCameraObject(),
-										propertyID,
-										0,
-										dataSize,
-										&focusInfo );
+				{
+					TraceScope trace("EDSDK", "EdsGetPropertyData");
+					err = EdsGetPropertyData( model->getCameraObject(),
+											propertyID,
+											0,
+											dataSize,
+											&focusInfo );
+					trace.setArg("error", err);
+				}
 
 				//Acquired property value is set
 				if(err == EDS_ERR_OK)
 				{
-					_model->setFocusInfo(focusInfo);
+					model->setFocusInfo(focusInfo);
 				}		
 			}
 		}
 
+		// A stale entry: ask for the size again
+		if(cached && (err == EDS_ERR_INVALID_LENGTH || err == EDS_ERR_PROPERTIES_MISMATCH))
+		{
+			model->getPropertyInfoCache().remove(propertyID);
+			return readProperty(model, propertyID, outChanged);
+		}
+
+		if(outChanged != NULL)
+		{
+			*outChanged = changed;
+		}
+
+		return err;
+	}
+
+	// Type-checked read straight into value: one round trip, as the size
+	// is known at compile time. The store's copy is updated too, for
+	// values small enough to be kept there.
+	template<EdsPropertyID propertyID>
+	static EdsError readProperty(CameraModel* model, typename PropertyTraits<propertyID>::type& value, bool* outChanged = NULL)
+	{
+		TraceScope trace("EDSDK", "EdsGetPropertyData");
+		EdsError err = EdsGetPropertyData( model->getCameraObject(),
+										  propertyID,
+										  0,
+										  sizeof(value),
+										  &value );
+		trace.setArg("error", err);
+
+		if(err == EDS_ERR_OK)
+		{
+			bool changed = model->setPropertyData(propertyID, PropertyTraits<propertyID>::dataType, &value, sizeof(value));
+			if(outChanged != NULL)
+			{
+				*outChanged = changed;
+			}
+		}
+		return err;
+	}
+
+	// Reads a set of properties in one pass.
+	// The IDs whose value changed are appended to outChanged.
+	// Stops at device busy, other errors are skipped and the first one is returned.
+	static EdsError readProperties(CameraModel* model, const PropertyIDList& propertyIDs, PropertyIDList& outChanged)
+	{
+		EdsError firstError = EDS_ERR_OK;
+
+		PropertyIDList::const_iterator it = propertyIDs.begin();
+		while (it != propertyIDs.end())
+		{
+			bool changed = false;
+			EdsError err = readProperty(model, *it, &changed);
+
+			if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+			{
+				return err;
+			}
+
+			if(err == EDS_ERR_OK)
+			{
+				if(changed)outChanged.push_back(*it);
+			}
+			else if(firstError == EDS_ERR_OK)
+			{
+				firstError = err;
+			}
+			++it;
+		}
+
+		return firstError;
+	}
+
+	// Properties that must be retrieved again when unknown is returned for the property ID
+	static PropertyIDList getShootingPropertyIDs()
+	{
+		PropertyIDList propertyIDs;
+		propertyIDs.push_back(kEdsPropID_AEModeSelect);
+		propertyIDs.push_back(kEdsPropID_Tv);
+		propertyIDs.push_back(kEdsPropID_Av);
+		propertyIDs.push_back(kEdsPropID_ISOSpeed);
+		propertyIDs.push_back(kEdsPropID_MeteringMode);
+		propertyIDs.push_back(kEdsPropID_ExposureCompensation);
+		propertyIDs.push_back(kEdsPropID_ImageQuality);
+		return propertyIDs;
+	}
+
+private:
+	EdsError getProperty(EdsPropertyID propertyID)
+	{
+		EdsError err = EDS_ERR_OK;
+
+		if(propertyID == kEdsPropID_Unknown)
+		{
+			//If unknown is returned for the property ID , the required property must be retrieved again
+			// They are read in one pass and reported with a single notification.
+			PropertyIDList changed;
+			err = readProperties(_model, getShootingPropertyIDs(), changed);
+
+			if((err & EDS_ERRORID_MASK) != EDS_ERR_DEVICE_BUSY)
+			{
+				CameraEvent e(kCameraEvent_PropertiesChanged, &changed);
+				_model->notifyObservers(&e);
+			}
+			
+			return err;
+		}
+	
+		err = readProperty(_model, propertyID);
 
 		//Update notification
 		if(err == EDS_ERR_OK)
 		{
-			CameraEvent e("PropertyChanged", &propertyID);
+			CameraEvent e(kCameraEvent_PropertyChanged, &propertyID);
 			_model->notifyObservers(&e);
 		}
 
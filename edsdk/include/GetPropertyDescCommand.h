@@ -19,6 +19,7 @@
 #include "Command.h"
 #include "CameraEvent.h"
 #include "EDSDK.h"
+#include "PropertyDescCache.h"
 
 class GetPropertyDescCommand : public Command
 {
@@ -28,8 +29,14 @@ private:
 
 public:
 	GetPropertyDescCommand(CameraModel *model, EdsPropertyID propertyID)
-		:_propertyID(propertyID), Command(model){}
+		:Command(model), _propertyID(propertyID){}
 
+	virtual CommandPriority getPriority() const {return kCommandPriority_Background;}
+
+	virtual EdsUInt64 getCoalesceKey() const {return makeCoalesceKey(kCommandCoalesce_PropertyDesc, _propertyID);}
+
+
+	virtual const char* getName() const {return "GetPropertyDesc";}
 
 	// Execute command	
 	virtual bool execute()
@@ -46,6 +53,7 @@ public:
 		//It releases it when locked
 		if(locked)
 		{
+			TraceScope trace("EDSDK", "EdsSendStatusCommand");
 			EdsSendStatusCommand(_model->getCameraObject(), kEdsCameraStatusCommand_UIUnLock, 0);
 		}
 
@@ -56,15 +64,18 @@ public:
 			// It retries it at device busy
 			if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
+		_model->notePropertyFetched(_propertyID, true, err);
 		return true;
 
 	}	
@@ -73,7 +84,7 @@ private:
 	EdsError getPropertyDesc(EdsPropertyID propertyID)
 	{
 		EdsError  err = EDS_ERR_OK;
-		EdsPropertyDesc	 propertyDesc = {0};
+		EdsPropertyDesc	 propertyDesc = {};
 		
 		if(propertyID == kEdsPropID_Unknown)
 		{
@@ -89,24 +100,44 @@ private:
 			return err;
 		}		
 	
+		// A desc read back recently is taken from the cache, without the camera
+		PropertyDescCache& cache = PropertyDescCache::instance();
+		PROPERTY_DESC_KEY key;
+		bool cacheable = cache.isOpen() && PropertyDescCache::makeKey(_model, key);
+		bool fresh = false;
+		if(cacheable && cache.lookup(key, propertyID, propertyDesc, fresh) && fresh)
+		{
+			cache.noteHit();
+			_model->setPropertyDesc(propertyID , &propertyDesc);
+			CameraEvent e(kCameraEvent_PropertyDescChanged, &propertyID);
+			_model->notifyObservers(&e);
+			return EDS_ERR_OK;
+		}
+
 		//Acquisition of value list that can be set
 		if(err == EDS_ERR_OK)
 		{
+			TraceScope trace("EDSDK", "EdsGetPropertyDesc");
 			err = EdsGetPropertyDesc( _model->getCameraObject(),
 									propertyID,
 									&propertyDesc);
+			trace.setArg("error", err);
 		}
 
 		//The value list that can be the acquired setting it is set		
 		if(err == EDS_ERR_OK)
 		{
 			_model->setPropertyDesc(propertyID , &propertyDesc);
+			if(cacheable)
+			{
+				cache.store(key, propertyID, propertyDesc);
+			}
 		}
 
 		//Update notification
 		if(err == EDS_ERR_OK)
 		{
-			CameraEvent e("PropertyDescChanged", &propertyID);
+			CameraEvent e(kCameraEvent_PropertyDescChanged, &propertyID);
 			_model->notifyObservers(&e);
 		}
 
@@ -0,0 +1,385 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : HotPlugMonitor.h                                                *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraManager.h"
+#include "EvfFrame.h"
+#include "Thread.h"
+#include "Trace.h"
+
+
+enum HotPlugEventKind
+{
+	kHotPlug_Added = 0,
+	kHotPlug_Removed,
+};
+
+typedef struct _HOTPLUG_EVENT
+{
+	HotPlugEventKind	kind;
+	EdsDeviceInfo		deviceInfo;
+	// Open with autoConnect when added; closed already when removed
+	CameraSessionRef	session;
+	EdsUInt64			micros;
+}HOTPLUG_EVENT;
+
+typedef std::function<void(const HOTPLUG_EVENT&)> HotPlugListener;
+
+// A body in the registry
+typedef struct _HOTPLUG_DEVICE
+{
+	EdsDeviceInfo		deviceInfo;
+	bool				connected;		// has a session in the manager
+	EdsUInt64			addedMicros;
+}HOTPLUG_DEVICE;
+
+typedef struct _HOTPLUG_STATISTICS
+{
+	EdsUInt64	added;
+	EdsUInt64	removed;
+	EdsUInt64	cameraAddedEvents;	// from EdsSetCameraAddedHandler
+	EdsUInt64	shutdownEvents;		// kEdsStateEvent_Shutdown of a session
+	EdsUInt64	rescans;			// camera list reads
+	EdsUInt32	devices;
+}HOTPLUG_STATISTICS;
+
+
+// Keeps a registry of the attached bodies current from SDK events rather
+// than by polling the camera list.
+//
+// A CameraAdded callback makes the monitor read the camera list once and
+// diff it against the registry; kEdsStateEvent_Shutdown from a session
+// removes its body at once. With autoConnect the manager opens a session
+// on each body as it is added and closes it as it goes. Listeners run on
+// the monitor thread, never on the SDK's.
+//
+// Without a message loop, the SDK only calls back from EdsGetEvent().
+class HotPlugMonitor : public Thread
+{
+private:
+	// What the SDK callbacks hand over; outlives the handlers that hold it
+	struct Inbox
+	{
+		std::mutex						mutex;
+		std::condition_variable			wake;
+		bool							stopping;
+		bool							rescan;
+		std::vector<CameraSessionRef>	shutdowns;
+		EdsUInt64						cameraAddedEvents;
+		EdsUInt64						shutdownEvents;
+
+		Inbox() : stopping(false), rescan(false), cameraAddedEvents(0), shutdownEvents(0) {}
+	};
+
+	CameraManager&					_manager;
+	std::shared_ptr<Inbox>			_inbox;
+	bool							_autoConnect;
+	bool							_running;
+
+	std::mutex						_registryMutex;
+	std::map<std::string, HOTPLUG_DEVICE>	_devices;
+	EdsUInt64						_added;
+	EdsUInt64						_removed;
+	EdsUInt64						_rescans;
+
+	std::mutex						_listenerMutex;
+	std::vector<HotPlugListener>	_listeners;
+
+	HotPlugMonitor(const HotPlugMonitor&);
+	HotPlugMonitor& operator=(const HotPlugMonitor&);
+
+	static EdsError EDSCALLBACK handleCameraAdded(EdsVoid* inContext)
+	{
+		TraceScope trace("Callback", "CameraAdded");
+		Inbox* inbox = (Inbox*)inContext;
+		std::lock_guard<std::mutex> lock(inbox->mutex);
+		inbox->rescan = true;
+		inbox->cameraAddedEvents++;
+		inbox->wake.notify_all();
+		return EDS_ERR_OK;
+	}
+
+	void notify(HotPlugEventKind kind, const EdsDeviceInfo& deviceInfo, const CameraSessionRef& session)
+	{
+		HOTPLUG_EVENT e;
+		e.kind = kind;
+		e.deviceInfo = deviceInfo;
+		e.session = session;
+		e.micros = evfClockMicros();
+
+		// Called outside the lock, so a listener may add another
+		std::vector<HotPlugListener> listeners;
+		{
+			std::lock_guard<std::mutex> lock(_listenerMutex);
+			listeners = _listeners;
+		}
+		for(size_t i = 0; i < listeners.size(); i++)
+		{
+			listeners[i](e);
+		}
+	}
+
+	void remove(const std::string& portName, const EdsDeviceInfo& deviceInfo, const CameraSessionRef& session)
+	{
+		bool known = false;
+		{
+			std::lock_guard<std::mutex> lock(_registryMutex);
+			known = (_devices.erase(portName) != 0);
+			if(known)
+			{
+				_removed++;
+			}
+		}
+		if(session)
+		{
+			_manager.disconnect(session);
+		}
+		if(known)
+		{
+			notify(kHotPlug_Removed, deviceInfo, session);
+		}
+	}
+
+	// Diff the camera list against the registry
+	void rescan()
+	{
+		std::vector<EdsDeviceInfo> attached;
+		EdsError err = _manager.enumerate(attached);
+		{
+			std::lock_guard<std::mutex> lock(_registryMutex);
+			_rescans++;
+		}
+		if(err != EDS_ERR_OK)
+		{
+			return;
+		}
+
+		std::map<std::string, EdsDeviceInfo> current;
+		for(size_t i = 0; i < attached.size(); i++)
+		{
+			current[attached[i].szPortName] = attached[i];
+		}
+
+		// Gone without a shutdown event
+		std::vector<HOTPLUG_DEVICE> gone;
+		std::vector<EdsDeviceInfo> added;
+		{
+			std::lock_guard<std::mutex> lock(_registryMutex);
+			for(std::map<std::string, HOTPLUG_DEVICE>::iterator it = _devices.begin(); it != _devices.end(); ++it)
+			{
+				if(current.find(it->first) == current.end())
+				{
+					gone.push_back(it->second);
+				}
+			}
+			for(std::map<std::string, EdsDeviceInfo>::iterator it = current.begin(); it != current.end(); ++it)
+			{
+				if(_devices.find(it->first) == _devices.end())
+				{
+					added.push_back(it->second);
+				}
+			}
+		}
+
+		for(size_t i = 0; i < gone.size(); i++)
+		{
+			std::string portName = gone[i].deviceInfo.szPortName;
+			remove(portName, gone[i].deviceInfo, _manager.findByPort(portName));
+		}
+
+		if(!added.empty() && _autoConnect)
+		{
+			_manager.connectAll();
+		}
+
+		for(size_t i = 0; i < added.size(); i++)
+		{
+			std::string portName = added[i].szPortName;
+			CameraSessionRef session = _manager.findByPort(portName);
+
+			HOTPLUG_DEVICE device;
+			device.deviceInfo = added[i];
+			device.connected = (bool)session;
+			device.addedMicros = evfClockMicros();
+			{
+				std::lock_guard<std::mutex> lock(_registryMutex);
+				_devices[portName] = device;
+				_added++;
+			}
+			notify(kHotPlug_Added, added[i], session);
+		}
+	}
+
+public:
+	HotPlugMonitor(CameraManager& manager)
+		: _manager(manager), _inbox(std::make_shared<Inbox>()), _autoConnect(true), _running(false),
+		  _added(0), _removed(0), _rescans(0) {}
+
+	virtual ~HotPlugMonitor()
+	{
+		stop();
+	}
+
+	// Open a session on each body as it is added. Default on; set before start().
+	void setAutoConnect(bool autoConnect)		{ _autoConnect = autoConnect; }
+
+	void addListener(const HotPlugListener& listener)
+	{
+		std::lock_guard<std::mutex> lock(_listenerMutex);
+		_listeners.push_back(listener);
+	}
+
+	// Installs the handlers and reports the bodies attached now as added
+	bool start()
+	{
+		if(_running)
+		{
+			return true;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_inbox->mutex);
+			_inbox->stopping = false;
+			_inbox->rescan = true;
+		}
+
+		std::shared_ptr<Inbox> inbox = _inbox;
+		_manager.setShutdownHandler([inbox](const CameraSessionRef& session) {
+			std::lock_guard<std::mutex> lock(inbox->mutex);
+			if(!inbox->stopping)
+			{
+				inbox->shutdowns.push_back(session);
+				inbox->shutdownEvents++;
+				inbox->wake.notify_all();
+			}
+		});
+
+		EdsError err;
+		{
+			TraceScope trace("EDSDK", "EdsSetCameraAddedHandler");
+			err = EdsSetCameraAddedHandler(handleCameraAdded, (EdsVoid*)_inbox.get());
+			trace.setArg("error", err);
+		}
+		if(err != EDS_ERR_OK || !Thread::start())
+		{
+			EdsSetCameraAddedHandler(NULL, NULL);
+			_manager.setShutdownHandler(SessionShutdownHandler());
+			return false;
+		}
+		_running = true;
+		return true;
+	}
+
+	// Sessions opened meanwhile stay open
+	void stop()
+	{
+		if(!_running)
+		{
+			return;
+		}
+		_running = false;
+
+		EdsSetCameraAddedHandler(NULL, NULL);
+		_manager.setShutdownHandler(SessionShutdownHandler());
+		{
+			std::lock_guard<std::mutex> lock(_inbox->mutex);
+			_inbox->stopping = true;
+			_inbox->shutdowns.clear();
+			_inbox->wake.notify_all();
+		}
+		join();
+	}
+
+	bool isRunning() const						{ return _running; }
+
+	std::vector<HOTPLUG_DEVICE> getDevices()
+	{
+		std::vector<HOTPLUG_DEVICE> devices;
+		std::lock_guard<std::mutex> lock(_registryMutex);
+		for(std::map<std::string, HOTPLUG_DEVICE>::iterator it = _devices.begin(); it != _devices.end(); ++it)
+		{
+			HOTPLUG_DEVICE device = it->second;
+			device.connected = (bool)_manager.findByPort(it->first);
+			devices.push_back(device);
+		}
+		return devices;
+	}
+
+	HOTPLUG_STATISTICS getStatistics()
+	{
+		HOTPLUG_STATISTICS stats;
+		{
+			std::lock_guard<std::mutex> lock(_registryMutex);
+			stats.added = _added;
+			stats.removed = _removed;
+			stats.rescans = _rescans;
+			stats.devices = (EdsUInt32)_devices.size();
+		}
+		{
+			std::lock_guard<std::mutex> lock(_inbox->mutex);
+			stats.cameraAddedEvents = _inbox->cameraAddedEvents;
+			stats.shutdownEvents = _inbox->shutdownEvents;
+		}
+		return stats;
+	}
+
+	virtual void run()
+	{
+		//When using the SDK from another thread in Windows,
+		// you must initialize the COM library by calling CoInitialize
+#ifdef _WIN32
+		CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+		Tracer::instance().setThreadName("HotPlug");
+
+		for(;;)
+		{
+			bool doRescan = false;
+			std::vector<CameraSessionRef> shutdowns;
+			{
+				std::unique_lock<std::mutex> lock(_inbox->mutex);
+				while(!_inbox->stopping && !_inbox->rescan && _inbox->shutdowns.empty())
+				{
+					_inbox->wake.wait(lock);
+				}
+				if(_inbox->stopping)
+				{
+					break;
+				}
+				doRescan = _inbox->rescan;
+				_inbox->rescan = false;
+				shutdowns.swap(_inbox->shutdowns);
+			}
+
+			for(size_t i = 0; i < shutdowns.size(); i++)
+			{
+				remove(shutdowns[i]->getPortName(), shutdowns[i]->getDeviceInfo(), shutdowns[i]);
+			}
+			if(doRescan)
+			{
+				rescan();
+			}
+		}
+
+#ifdef _WIN32
+		CoUninitialize();
+#endif
+	}
+};
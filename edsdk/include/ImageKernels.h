@@ -0,0 +1,704 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ImageKernels.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define EDSDK_KERNELS_NEON 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define EDSDK_KERNELS_SSE2 1
+#endif
+// MSVC defines __AVX2__ but never __SSSE3__
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define EDSDK_KERNELS_SSSE3 1
+#endif
+
+#include "JpegDecoder.h"
+#include "EDSDK.h"
+
+
+// Resize and colour conversion of 8-bit interleaved pixels.
+// The x86 paths are picked at compile time: SSE2 always on x86-64, SSSE3
+// and AVX2 when the build enables them (EDSDK_ENABLE_AVX2). NEON on ARM.
+
+enum ResizeFilter
+{
+	kResizeFilter_Area = 0,		// average of the covered pixels; bilinear when enlarging
+	kResizeFilter_Bilinear,
+	kResizeFilter_Lanczos,		// 3 lobes, for stills
+};
+
+
+// Splits rows into bands run on their own threads; the last band runs on
+// the caller. threadCount 0 picks one thread per kMinWorkPerThread units of
+// work, up to the core count.
+class ImageRows
+{
+public:
+	enum { kMinWorkPerThread = 256 * 1024, kMaxThreads = 8 };
+
+	static int threadsFor(int rows, EdsUInt64 work, int threadCount)
+	{
+		if(threadCount <= 0)
+		{
+			int cores = (int)std::thread::hardware_concurrency();
+			threadCount = (int)std::min<EdsUInt64>(work / kMinWorkPerThread + 1, (EdsUInt64)std::max(cores, 1));
+			threadCount = std::min(threadCount, (int)kMaxThreads);
+		}
+		return std::max(1, std::min(threadCount, rows));
+	}
+
+	static void run(int rows, EdsUInt64 work, int threadCount, const std::function<void(int, int)>& body)
+	{
+		int threads = threadsFor(rows, work, threadCount);
+		if(threads <= 1)
+		{
+			body(0, rows);
+			return;
+		}
+
+		std::vector<std::thread> bands;
+		for(int i = 0; i < threads - 1; i++)
+		{
+			bands.push_back(std::thread(body, rows * i / threads, rows * (i + 1) / threads));
+		}
+		body(rows * (threads - 1) / threads, rows);
+		for(size_t i = 0; i < bands.size(); i++)
+		{
+			bands[i].join();
+		}
+	}
+};
+
+
+// Per output pixel of one axis: the first source pixel and a fixed number
+// of weights in 14-bit fixed point summing to exactly 1 << kBits.
+class ResizeCoefficients
+{
+public:
+	enum { kBits = 14, kLanczosLobes = 3 };
+
+	int						taps;
+	std::vector<int>		first;
+	std::vector<EdsInt16>	weights;
+
+	ResizeCoefficients() : taps(0) {}
+
+	void compute(int srcSize, int dstSize, ResizeFilter filter)
+	{
+		double scale = (double)srcSize / dstSize;
+		if(filter == kResizeFilter_Area && scale <= 1.0)
+		{
+			filter = kResizeFilter_Bilinear;
+		}
+		double filterScale = std::max(scale, 1.0);
+		double support = (filter == kResizeFilter_Lanczos) ? kLanczosLobes * filterScale : filterScale;
+
+		std::vector<int> lows(dstSize);
+		std::vector<std::vector<double> > spans(dstSize);
+		taps = 0;
+		for(int i = 0; i < dstSize; i++)
+		{
+			std::vector<double>& span = spans[i];
+			int low, high;
+			if(filter == kResizeFilter_Area)
+			{
+				double start = i * scale, end = start + scale;
+				low = (int)start;
+				high = std::min((int)std::ceil(end), srcSize);
+				for(int j = low; j < high; j++)
+				{
+					span.push_back(std::min(end, j + 1.0) - std::max(start, (double)j));
+				}
+			}
+			else
+			{
+				double center = (i + 0.5) * scale;
+				low = std::max((int)(center - support + 0.5), 0);
+				high = std::min((int)(center + support + 0.5), srcSize);
+				for(int j = low; j < high; j++)
+				{
+					double x = (j - center + 0.5) / filterScale;
+					span.push_back((filter == kResizeFilter_Lanczos) ? lanczos(x) : std::max(0.0, 1.0 - std::fabs(x)));
+				}
+			}
+			lows[i] = low;
+			taps = std::max(taps, (int)span.size());
+		}
+		taps = std::max(1, std::min(taps, srcSize));
+
+		first.assign(dstSize, 0);
+		weights.assign((size_t)dstSize * taps, 0);
+		for(int i = 0; i < dstSize; i++)
+		{
+			const std::vector<double>& span = spans[i];
+			double sum = 0.0;
+			for(size_t k = 0; k < span.size(); k++)
+			{
+				sum += span[k];
+			}
+
+			// The window is shifted to stay inside the source
+			int start = std::min(lows[i], srcSize - taps);
+			first[i] = start;
+			EdsInt16* w = &weights[(size_t)i * taps];
+			int total = 0, largest = 0;
+			for(size_t k = 0; k < span.size(); k++)
+			{
+				int slot = lows[i] + (int)k - start;
+				int q = (sum != 0.0) ? (int)std::floor(span[k] / sum * (1 << kBits) + 0.5) : 0;
+				w[slot] = (EdsInt16)q;
+				total += q;
+				if(q > w[largest])
+				{
+					largest = slot;
+				}
+			}
+			w[largest] = (EdsInt16)(w[largest] + (1 << kBits) - total);
+		}
+	}
+
+	static double lanczos(double x)
+	{
+		if(x == 0.0)
+		{
+			return 1.0;
+		}
+		if(x <= -kLanczosLobes || x >= kLanczosLobes)
+		{
+			return 0.0;
+		}
+		double px = 3.14159265358979323846 * x;
+		return kLanczosLobes * std::sin(px) * std::sin(px / kLanczosLobes) / (px * px);
+	}
+};
+
+
+inline unsigned char clampPixel(int value)
+{
+	return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// One output row of the vertical pass: weighted sum of taps source rows
+// over length bytes.
+inline void resizeVertical(const unsigned char* const* rows, const EdsInt16* weights, int taps, unsigned char* out, int length)
+{
+	const int kBits = ResizeCoefficients::kBits;
+	int x = 0;
+
+#if defined(__AVX2__)
+	for(; x + 16 <= length; x += 16)
+	{
+		__m256i acc0 = _mm256_set1_epi32(1 << (kBits - 1));
+		__m256i acc1 = acc0;
+		for(int k = 0; k < taps; k += 2)
+		{
+			// Two taps at a time: interleaved rows times (w0, w1) pairs
+			bool pair = (k + 1 < taps);
+			__m256i w = _mm256_set1_epi32((EdsUInt16)weights[k] | ((EdsUInt32)(EdsUInt16)(pair ? weights[k + 1] : 0) << 16));
+			__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k] + x)));
+			__m256i b = pair ? _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k + 1] + x))) : _mm256_setzero_si256();
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+		}
+		// Lane-wise packing puts the 16 pixels back in order in qwords 0 and 2
+		__m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(acc0, kBits), _mm256_srai_epi32(acc1, kBits));
+		packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), 0xD8);
+		_mm_storeu_si128((__m128i*)(out + x), _mm256_castsi256_si128(packed));
+	}
+#endif
+#if defined(EDSDK_KERNELS_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for(; x + 8 <= length; x += 8)
+	{
+		__m128i acc0 = _mm_set1_epi32(1 << (kBits - 1));
+		__m128i acc1 = acc0;
+		for(int k = 0; k < taps; k += 2)
+		{
+			bool pair = (k + 1 < taps);
+			__m128i w = _mm_set1_epi32((EdsUInt16)weights[k] | ((EdsUInt32)(EdsUInt16)(pair ? weights[k + 1] : 0) << 16));
+			__m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(rows[k] + x)), zero);
+			__m128i b = pair ? _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(rows[k + 1] + x)), zero) : zero;
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+		}
+		__m128i packed = _mm_packs_epi32(_mm_srai_epi32(acc0, kBits), _mm_srai_epi32(acc1, kBits));
+		_mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(packed, packed));
+	}
+#elif defined(EDSDK_KERNELS_NEON)
+	for(; x + 8 <= length; x += 8)
+	{
+		int32x4_t acc0 = vdupq_n_s32(1 << (kBits - 1));
+		int32x4_t acc1 = acc0;
+		for(int k = 0; k < taps; k++)
+		{
+			int16x8_t a = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[k] + x)));
+			acc0 = vmlal_n_s16(acc0, vget_low_s16(a), weights[k]);
+			acc1 = vmlal_n_s16(acc1, vget_high_s16(a), weights[k]);
+		}
+		// Saturating narrows clamp to 0-255
+		uint16x8_t packed = vcombine_u16(vqshrun_n_s32(acc0, kBits), vqshrun_n_s32(acc1, kBits));
+		vst1_u8(out + x, vqmovn_u16(packed));
+	}
+#endif
+
+	for(; x < length; x++)
+	{
+		int acc = 1 << (kBits - 1);
+		for(int k = 0; k < taps; k++)
+		{
+			acc += weights[k] * rows[k][x];
+		}
+		out[x] = clampPixel(acc >> kBits);
+	}
+}
+
+// One output row of the horizontal pass, channels interleaved
+template<int CHANNELS>
+inline void resizeHorizontal(const unsigned char* in, const ResizeCoefficients& coefficients, int width, unsigned char* out)
+{
+	const int kBits = ResizeCoefficients::kBits;
+	const int taps = coefficients.taps;
+	for(int x = 0; x < width; x++, out += CHANNELS)
+	{
+		const unsigned char* p = in + (size_t)coefficients.first[x] * CHANNELS;
+		const EdsInt16* w = &coefficients.weights[(size_t)x * taps];
+		int acc[CHANNELS];
+		for(int c = 0; c < CHANNELS; c++)
+		{
+			acc[c] = 1 << (kBits - 1);
+		}
+		for(int k = 0; k < taps; k++, p += CHANNELS)
+		{
+			for(int c = 0; c < CHANNELS; c++)
+			{
+				acc[c] += w[k] * p[c];
+			}
+		}
+		for(int c = 0; c < CHANNELS; c++)
+		{
+			out[c] = clampPixel(acc[c] >> kBits);
+		}
+	}
+}
+
+inline void resizeHorizontal(const unsigned char* in, const ResizeCoefficients& coefficients, int width, int channels, unsigned char* out)
+{
+	switch(channels)
+	{
+		case 1:	resizeHorizontal<1>(in, coefficients, width, out); break;
+		case 2:	resizeHorizontal<2>(in, coefficients, width, out); break;
+		case 3:	resizeHorizontal<3>(in, coefficients, width, out); break;
+		default: resizeHorizontal<4>(in, coefficients, width, out); break;
+	}
+}
+
+// Resizes 1 to 4 interleaved 8-bit channels. Rows are filtered vertically
+// first, at the source width, then horizontally; each band of output rows
+// uses one row of scratch. False on bad sizes.
+inline bool resizeImage(const unsigned char* src, int width, int height, int stride,
+	unsigned char* dst, int dstWidth, int dstHeight, int dstStride, int channels, ResizeFilter filter, int threadCount = 0)
+{
+	if(src == NULL || dst == NULL || width <= 0 || height <= 0 || dstWidth <= 0 || dstHeight <= 0 || channels < 1 || channels > 4)
+	{
+		return false;
+	}
+
+	ResizeCoefficients horizontal, vertical;
+	bool resizeX = (dstWidth != width);
+	bool resizeY = (dstHeight != height);
+	if(resizeX)
+	{
+		horizontal.compute(width, dstWidth, filter);
+	}
+	if(resizeY)
+	{
+		vertical.compute(height, dstHeight, filter);
+	}
+
+	EdsUInt64 work = (EdsUInt64)dstHeight * ((resizeY ? (EdsUInt64)width * vertical.taps : 0) + (resizeX ? (EdsUInt64)dstWidth * horizontal.taps : dstWidth)) * channels;
+	ImageRows::run(dstHeight, work, threadCount, [&](int begin, int end)
+	{
+		std::vector<unsigned char> scratch(resizeY && resizeX ? (size_t)width * channels : 0);
+		std::vector<const unsigned char*> rows(resizeY ? vertical.taps : 0);
+		for(int y = begin; y < end; y++)
+		{
+			unsigned char* out = dst + (size_t)dstStride * y;
+			const unsigned char* row = src + (size_t)stride * y;
+			if(resizeY)
+			{
+				for(int k = 0; k < vertical.taps; k++)
+				{
+					rows[k] = src + (size_t)stride * (vertical.first[y] + k);
+				}
+				unsigned char* filtered = resizeX ? &scratch[0] : out;
+				resizeVertical(&rows[0], &vertical.weights[(size_t)y * vertical.taps], vertical.taps, filtered, width * channels);
+				row = filtered;
+			}
+
+			if(resizeX)
+			{
+				resizeHorizontal(row, horizontal, dstWidth, channels, out);
+			}
+			else if(!resizeY)
+			{
+				memcpy(out, row, (size_t)width * channels);
+			}
+		}
+	});
+	return true;
+}
+
+inline bool resizeImage(const DecodedImage& src, DecodedImage& dst, int dstWidth, int dstHeight, ResizeFilter filter, int threadCount = 0, int rowAlignment = 1)
+{
+	if(dstWidth <= 0 || dstHeight <= 0)
+	{
+		return false;
+	}
+	dst.allocate(dstWidth, dstHeight, src.getFormat(), rowAlignment);
+	return resizeImage(src.getPixels(), src.getWidth(), src.getHeight(), src.getStride(),
+		dst.getPixels(), dstWidth, dstHeight, dst.getStride(), src.getChannels(), filter, threadCount);
+}
+
+
+#if defined(EDSDK_KERNELS_SSSE3)
+// pshufb masks moving 16 pixels of 3 interleaved channels between three
+// registers and three planes
+class ChannelShuffle
+{
+public:
+	// split[plane][register]
+	unsigned char	split[3][3][16];
+	// merge[register][plane]
+	unsigned char	merge[3][3][16];
+	// swap[output register][input register], red and blue exchanged
+	unsigned char	swap[3][3][16];
+
+	static const ChannelShuffle& instance()
+	{
+		static const ChannelShuffle shuffle;
+		return shuffle;
+	}
+
+private:
+	ChannelShuffle()
+	{
+		memset(split, 0x80, sizeof(split));
+		memset(merge, 0x80, sizeof(merge));
+		memset(swap, 0x80, sizeof(swap));
+		for(int i = 0; i < 48; i++)
+		{
+			int plane = i % 3, pixel = i / 3;
+			split[plane][i / 16][pixel] = (unsigned char)(i % 16);
+			merge[i / 16][plane][i % 16] = (unsigned char)pixel;
+			int from = pixel * 3 + 2 - plane;
+			swap[i / 16][from / 16][i % 16] = (unsigned char)(from % 16);
+		}
+	}
+};
+
+inline void splitChannels(const unsigned char* in, __m128i planes[3])
+{
+	const ChannelShuffle& shuffle = ChannelShuffle::instance();
+	__m128i regs[3];
+	for(int r = 0; r < 3; r++)
+	{
+		regs[r] = _mm_loadu_si128((const __m128i*)(in + 16 * r));
+	}
+	for(int c = 0; c < 3; c++)
+	{
+		planes[c] = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(regs[0], _mm_loadu_si128((const __m128i*)shuffle.split[c][0])),
+			_mm_shuffle_epi8(regs[1], _mm_loadu_si128((const __m128i*)shuffle.split[c][1]))),
+			_mm_shuffle_epi8(regs[2], _mm_loadu_si128((const __m128i*)shuffle.split[c][2])));
+	}
+}
+
+inline void mergeChannels(const __m128i planes[3], unsigned char* out)
+{
+	const ChannelShuffle& shuffle = ChannelShuffle::instance();
+	for(int r = 0; r < 3; r++)
+	{
+		__m128i reg = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(planes[0], _mm_loadu_si128((const __m128i*)shuffle.merge[r][0])),
+			_mm_shuffle_epi8(planes[1], _mm_loadu_si128((const __m128i*)shuffle.merge[r][1]))),
+			_mm_shuffle_epi8(planes[2], _mm_loadu_si128((const __m128i*)shuffle.merge[r][2])));
+		_mm_storeu_si128((__m128i*)(out + 16 * r), reg);
+	}
+}
+#endif
+
+// RGB to BGR and back. src may be dst.
+inline void swapRedBlue(const unsigned char* src, int srcStride, unsigned char* dst, int dstStride, int width, int height, int threadCount = 0)
+{
+	ImageRows::run(height, (EdsUInt64)width * height, threadCount, [=](int begin, int end)
+	{
+		for(int y = begin; y < end; y++)
+		{
+			const unsigned char* in = src + (size_t)srcStride * y;
+			unsigned char* out = dst + (size_t)dstStride * y;
+			int x = 0;
+#if defined(EDSDK_KERNELS_SSSE3)
+			// 16 pixels, three registers, all loaded before any store
+			const ChannelShuffle& shuffle = ChannelShuffle::instance();
+			for(; x + 16 <= width; x += 16)
+			{
+				__m128i regs[3], swapped[3];
+				for(int r = 0; r < 3; r++)
+				{
+					regs[r] = _mm_loadu_si128((const __m128i*)(in + x * 3 + 16 * r));
+				}
+				for(int r = 0; r < 3; r++)
+				{
+					swapped[r] = _mm_or_si128(_mm_or_si128(
+						_mm_shuffle_epi8(regs[0], _mm_loadu_si128((const __m128i*)shuffle.swap[r][0])),
+						_mm_shuffle_epi8(regs[1], _mm_loadu_si128((const __m128i*)shuffle.swap[r][1]))),
+						_mm_shuffle_epi8(regs[2], _mm_loadu_si128((const __m128i*)shuffle.swap[r][2])));
+				}
+				for(int r = 0; r < 3; r++)
+				{
+					_mm_storeu_si128((__m128i*)(out + x * 3 + 16 * r), swapped[r]);
+				}
+			}
+#elif defined(EDSDK_KERNELS_NEON)
+			for(; x + 16 <= width; x += 16)
+			{
+				uint8x16x3_t p = vld3q_u8(in + x * 3);
+				uint8x16_t red = p.val[0];
+				p.val[0] = p.val[2];
+				p.val[2] = red;
+				vst3q_u8(out + x * 3, p);
+			}
+#endif
+			for(; x < width; x++)
+			{
+				unsigned char red = in[x * 3];
+				out[x * 3 + 1] = in[x * 3 + 1];
+				out[x * 3] = in[x * 3 + 2];
+				out[x * 3 + 2] = red;
+			}
+		}
+	});
+}
+
+// Rec.601 luma in 8-bit fixed point, the same as computeImageStatistics
+inline void convertToGray(const unsigned char* src, int srcStride, JpegPixelFormat format, unsigned char* dst, int dstStride, int width, int height, int threadCount = 0)
+{
+	int red = (format == kJpegPixelFormat_BGR) ? 2 : 0;
+	int blue = 2 - red;
+	ImageRows::run(height, (EdsUInt64)width * height, threadCount, [=](int begin, int end)
+	{
+		for(int y = begin; y < end; y++)
+		{
+			const unsigned char* in = src + (size_t)srcStride * y;
+			unsigned char* out = dst + (size_t)dstStride * y;
+			int x = 0;
+#if defined(EDSDK_KERNELS_SSSE3)
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i kr = _mm_set1_epi16(77), kg = _mm_set1_epi16(150), kb = _mm_set1_epi16(29), round = _mm_set1_epi16(128);
+			for(; x + 16 <= width; x += 16)
+			{
+				__m128i planes[3];
+				splitChannels(in + x * 3, planes);
+				__m128i luma[2];
+				for(int half = 0; half < 2; half++)
+				{
+					__m128i r = half ? _mm_unpackhi_epi8(planes[red], zero) : _mm_unpacklo_epi8(planes[red], zero);
+					__m128i g = half ? _mm_unpackhi_epi8(planes[1], zero) : _mm_unpacklo_epi8(planes[1], zero);
+					__m128i b = half ? _mm_unpackhi_epi8(planes[blue], zero) : _mm_unpacklo_epi8(planes[blue], zero);
+					// At most 255 * 256 + 128, unsigned 16 bits
+					__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, kr), _mm_mullo_epi16(g, kg)), _mm_add_epi16(_mm_mullo_epi16(b, kb), round));
+					luma[half] = _mm_srli_epi16(sum, 8);
+				}
+				_mm_storeu_si128((__m128i*)(out + x), _mm_packus_epi16(luma[0], luma[1]));
+			}
+#elif defined(EDSDK_KERNELS_NEON)
+			for(; x + 16 <= width; x += 16)
+			{
+				uint8x16x3_t p = vld3q_u8(in + x * 3);
+				uint16x8_t lo = vmull_u8(vget_low_u8(p.val[red]), vdup_n_u8(77));
+				uint16x8_t hi = vmull_u8(vget_high_u8(p.val[red]), vdup_n_u8(77));
+				lo = vmlal_u8(lo, vget_low_u8(p.val[1]), vdup_n_u8(150));
+				hi = vmlal_u8(hi, vget_high_u8(p.val[1]), vdup_n_u8(150));
+				lo = vmlal_u8(lo, vget_low_u8(p.val[blue]), vdup_n_u8(29));
+				hi = vmlal_u8(hi, vget_high_u8(p.val[blue]), vdup_n_u8(29));
+				vst1q_u8(out + x, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+			}
+#endif
+			for(; x < width; x++)
+			{
+				const unsigned char* p = in + x * 3;
+				out[x] = (unsigned char)((77 * p[red] + 150 * p[1] + 29 * p[blue] + 128) >> 8);
+			}
+		}
+	});
+}
+
+// (h, w, 3) interleaved to three planes planeStride bytes apart, rows
+// dstStride apart in each
+inline void splitPlanes(const unsigned char* src, int srcStride, unsigned char* dst, int dstStride, size_t planeStride, int width, int height, int threadCount = 0)
+{
+	ImageRows::run(height, (EdsUInt64)width * height, threadCount, [=](int begin, int end)
+	{
+		for(int y = begin; y < end; y++)
+		{
+			const unsigned char* in = src + (size_t)srcStride * y;
+			unsigned char* out[3];
+			for(int c = 0; c < 3; c++)
+			{
+				out[c] = dst + planeStride * c + (size_t)dstStride * y;
+			}
+			int x = 0;
+#if defined(EDSDK_KERNELS_SSSE3)
+			for(; x + 16 <= width; x += 16)
+			{
+				__m128i planes[3];
+				splitChannels(in + x * 3, planes);
+				for(int c = 0; c < 3; c++)
+				{
+					_mm_storeu_si128((__m128i*)(out[c] + x), planes[c]);
+				}
+			}
+#elif defined(EDSDK_KERNELS_NEON)
+			for(; x + 16 <= width; x += 16)
+			{
+				uint8x16x3_t p = vld3q_u8(in + x * 3);
+				for(int c = 0; c < 3; c++)
+				{
+					vst1q_u8(out[c] + x, p.val[c]);
+				}
+			}
+#endif
+			for(; x < width; x++)
+			{
+				for(int c = 0; c < 3; c++)
+				{
+					out[c][x] = in[x * 3 + c];
+				}
+			}
+		}
+	});
+}
+
+// Three planes back to (h, w, 3) interleaved
+inline void mergePlanes(const unsigned char* src, int srcStride, size_t planeStride, unsigned char* dst, int dstStride, int width, int height, int threadCount = 0)
+{
+	ImageRows::run(height, (EdsUInt64)width * height, threadCount, [=](int begin, int end)
+	{
+		for(int y = begin; y < end; y++)
+		{
+			const unsigned char* in[3];
+			for(int c = 0; c < 3; c++)
+			{
+				in[c] = src + planeStride * c + (size_t)srcStride * y;
+			}
+			unsigned char* out = dst + (size_t)dstStride * y;
+			int x = 0;
+#if defined(EDSDK_KERNELS_SSSE3)
+			for(; x + 16 <= width; x += 16)
+			{
+				__m128i planes[3];
+				for(int c = 0; c < 3; c++)
+				{
+					planes[c] = _mm_loadu_si128((const __m128i*)(in[c] + x));
+				}
+				mergeChannels(planes, out + x * 3);
+			}
+#elif defined(EDSDK_KERNELS_NEON)
+			for(; x + 16 <= width; x += 16)
+			{
+				uint8x16x3_t p;
+				for(int c = 0; c < 3; c++)
+				{
+					p.val[c] = vld1q_u8(in[c] + x);
+				}
+				vst3q_u8(out + x * 3, p);
+			}
+#endif
+			for(; x < width; x++)
+			{
+				for(int c = 0; c < 3; c++)
+				{
+					out[x * 3 + c] = in[c][x];
+				}
+			}
+		}
+	});
+}
+
+// Pixels of two gray planes that differ by more than threshold
+inline EdsUInt64 countChangedPixels(const unsigned char* a, int aStride, const unsigned char* b, int bStride, int width, int height, int threshold)
+{
+	unsigned char limit = (unsigned char)(threshold < 0 ? 0 : (threshold > 255 ? 255 : threshold));
+	EdsUInt64 count = 0;
+	for(int y = 0; y < height; y++)
+	{
+		const unsigned char* p = a + (size_t)aStride * y;
+		const unsigned char* q = b + (size_t)bStride * y;
+		int x = 0;
+#if defined(EDSDK_KERNELS_SSE2)
+		const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1), bound = _mm_set1_epi8((char)limit);
+		while(x + 16 <= width)
+		{
+			// Byte counters, summed before they can wrap
+			__m128i counts = zero;
+			for(int block = 0; block < 255 && x + 16 <= width; block++, x += 16)
+			{
+				__m128i u = _mm_loadu_si128((const __m128i*)(p + x));
+				__m128i v = _mm_loadu_si128((const __m128i*)(q + x));
+				__m128i diff = _mm_or_si128(_mm_subs_epu8(u, v), _mm_subs_epu8(v, u));
+				__m128i same = _mm_cmpeq_epi8(_mm_subs_epu8(diff, bound), zero);
+				counts = _mm_add_epi8(counts, _mm_andnot_si128(same, one));
+			}
+			__m128i sums = _mm_sad_epu8(counts, zero);
+			count += (EdsUInt64)_mm_cvtsi128_si32(sums) + (EdsUInt64)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+		}
+#elif defined(EDSDK_KERNELS_NEON)
+		const uint8x16_t bound = vdupq_n_u8(limit);
+		while(x + 16 <= width)
+		{
+			uint8x16_t counts = vdupq_n_u8(0);
+			for(int block = 0; block < 255 && x + 16 <= width; block++, x += 16)
+			{
+				uint8x16_t diff = vabdq_u8(vld1q_u8(p + x), vld1q_u8(q + x));
+				// 0xff is -1
+				counts = vsubq_u8(counts, vcgtq_u8(diff, bound));
+			}
+			uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(counts)));
+			count += vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1);
+		}
+#endif
+		for(; x < width; x++)
+		{
+			int diff = (int)p[x] - (int)q[x];
+			if(diff > limit || -diff > limit)
+			{
+				count++;
+			}
+		}
+	}
+	return count;
+}
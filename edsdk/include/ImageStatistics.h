@@ -0,0 +1,182 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ImageStatistics.h                                               *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstring>
+
+#include "JpegDecoder.h"
+#include "EDSDK.h"
+
+
+enum ImageChannel
+{
+	kImageChannel_Red = 0,
+	kImageChannel_Green,
+	kImageChannel_Blue,
+	kImageChannel_Luma,
+	kImageChannel_Count,
+};
+
+
+typedef struct _IMAGE_STATISTICS
+{
+	EdsUInt32	histogram[kImageChannel_Count][256];
+	EdsUInt64	pixelCount;
+	double		mean[kImageChannel_Count];			// 0-255
+	double		clippedLow[kImageChannel_Count];	// percent of pixels at 0
+	double		clippedHigh[kImageChannel_Count];	// percent of pixels at 255
+}IMAGE_STATISTICS;
+
+
+// Histogram and exposure statistics of 8-bit RGB, BGR or gray pixels.
+// Luma is Rec.601 in 8-bit fixed point; for gray images every channel is
+// the gray value.
+// Counting is done in four interleaved banks so consecutive pixels of the
+// same value do not stall on the same counter.
+inline void computeImageStatistics(const unsigned char* pixels, int width, int height, int stride, JpegPixelFormat format, IMAGE_STATISTICS& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+	if(pixels == NULL || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	EdsUInt32 banks[4][kImageChannel_Count][256];
+	memset(banks, 0, sizeof(banks));
+
+	int red = (format == kJpegPixelFormat_BGR) ? 2 : 0;
+	int blue = (format == kJpegPixelFormat_BGR) ? 0 : 2;
+
+	for(int y = 0; y < height; y++)
+	{
+		const unsigned char* p = pixels + (size_t)stride * y;
+
+		if(format == kJpegPixelFormat_Gray)
+		{
+			int x = 0;
+			for(; x + 4 <= width; x += 4)
+			{
+				banks[0][kImageChannel_Luma][p[x]]++;
+				banks[1][kImageChannel_Luma][p[x + 1]]++;
+				banks[2][kImageChannel_Luma][p[x + 2]]++;
+				banks[3][kImageChannel_Luma][p[x + 3]]++;
+			}
+			for(; x < width; x++)
+			{
+				banks[0][kImageChannel_Luma][p[x]]++;
+			}
+			continue;
+		}
+
+		for(int x = 0; x < width; x++, p += 3)
+		{
+			EdsUInt32 (&bank)[kImageChannel_Count][256] = banks[x & 3];
+			unsigned int r = p[red];
+			unsigned int g = p[1];
+			unsigned int b = p[blue];
+			bank[kImageChannel_Red][r]++;
+			bank[kImageChannel_Green][g]++;
+			bank[kImageChannel_Blue][b]++;
+			bank[kImageChannel_Luma][(77 * r + 150 * g + 29 * b + 128) >> 8]++;
+		}
+	}
+
+	for(int c = 0; c < kImageChannel_Count; c++)
+	{
+		for(int v = 0; v < 256; v++)
+		{
+			stats.histogram[c][v] = banks[0][c][v] + banks[1][c][v] + banks[2][c][v] + banks[3][c][v];
+		}
+	}
+
+	if(format == kJpegPixelFormat_Gray)
+	{
+		for(int c = kImageChannel_Red; c < kImageChannel_Luma; c++)
+		{
+			memcpy(stats.histogram[c], stats.histogram[kImageChannel_Luma], sizeof(stats.histogram[c]));
+		}
+	}
+
+	stats.pixelCount = (EdsUInt64)width * height;
+	for(int c = 0; c < kImageChannel_Count; c++)
+	{
+		EdsUInt64 sum = 0;
+		for(int v = 0; v < 256; v++)
+		{
+			sum += (EdsUInt64)stats.histogram[c][v] * v;
+		}
+		stats.mean[c] = (double)sum / stats.pixelCount;
+		stats.clippedLow[c] = 100.0 * stats.histogram[c][0] / stats.pixelCount;
+		stats.clippedHigh[c] = 100.0 * stats.histogram[c][255] / stats.pixelCount;
+	}
+}
+
+inline void computeImageStatistics(const DecodedImage& image, IMAGE_STATISTICS& stats)
+{
+	computeImageStatistics(image.getPixels(), image.getWidth(), image.getHeight(), image.getStride(), image.getFormat(), stats);
+}
+
+
+// Level at or below which percent of the pixels of a histogram fall.
+inline int histogramPercentile(const EdsUInt32 histogram[256], EdsUInt64 pixelCount, double percent)
+{
+	EdsUInt64 target = (EdsUInt64)(pixelCount * percent / 100.0);
+	EdsUInt64 count = 0;
+	for(int v = 0; v < 256; v++)
+	{
+		count += histogram[v];
+		if(count > target)
+		{
+			return v;
+		}
+	}
+	return 255;
+}
+
+
+// Stretches levels in place so that lowPercent of the pixels become black
+// and highPercent white, based on the luma histogram. All channels use the
+// same table so hues are kept. Returns false if the image is flat.
+inline bool contrastStretch(unsigned char* pixels, int width, int height, int stride, JpegPixelFormat format,
+	const IMAGE_STATISTICS& stats, double lowPercent = 0.5, double highPercent = 0.5)
+{
+	int low = histogramPercentile(stats.histogram[kImageChannel_Luma], stats.pixelCount, lowPercent);
+	int high = histogramPercentile(stats.histogram[kImageChannel_Luma], stats.pixelCount, 100.0 - highPercent);
+	if(pixels == NULL || high <= low)
+	{
+		return false;
+	}
+
+	unsigned char table[256];
+	for(int v = 0; v < 256; v++)
+	{
+		int level = (v - low) * 255 / (high - low);
+		table[v] = (unsigned char)(level < 0 ? 0 : (level > 255 ? 255 : level));
+	}
+
+	int rowBytes = width * ((format == kJpegPixelFormat_Gray) ? 1 : 3);
+	for(int y = 0; y < height; y++)
+	{
+		unsigned char* p = pixels + (size_t)stride * y;
+		for(int i = 0; i < rowBytes; i++)
+		{
+			p[i] = table[p[i]];
+		}
+	}
+	return true;
+}
+
+inline bool contrastStretch(DecodedImage& image, double lowPercent = 0.5, double highPercent = 0.5)
+{
+	IMAGE_STATISTICS stats;
+	computeImageStatistics(image, stats);
+	return contrastStretch(image.getPixels(), image.getWidth(), image.getHeight(), image.getStride(), image.getFormat(), stats, lowPercent, highPercent);
+}
@@ -0,0 +1,398 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : JpegDecoder.h                                                   *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <csetjmp>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_LIBJPEG
+#include <jpeglib.h>
+#endif
+
+
+enum JpegPixelFormat
+{
+	kJpegPixelFormat_RGB = 0,
+	kJpegPixelFormat_BGR,
+	kJpegPixelFormat_Gray,
+};
+
+
+// Decoded pixels, rows top to bottom, stride bytes apart.
+class DecodedImage
+{
+private:
+	std::vector<unsigned char>	_pixels;
+	int							_width;
+	int							_height;
+	int							_channels;
+	int							_stride;
+	JpegPixelFormat				_format;
+	// Top-left of a region decode, in pixels of the (scaled) output
+	int							_originX;
+	int							_originY;
+
+public:
+	DecodedImage() : _width(0), _height(0), _channels(0), _stride(0), _format(kJpegPixelFormat_RGB), _originX(0), _originY(0) {}
+
+	// Keeps the existing allocation when the size does not change.
+	void allocate(int width, int height, JpegPixelFormat format, int rowAlignment)
+	{
+		_width = width;
+		_height = height;
+		_format = format;
+		_channels = (format == kJpegPixelFormat_Gray) ? 1 : 3;
+
+		int align = (rowAlignment > 0) ? rowAlignment : 1;
+		_stride = ((width * _channels + align - 1) / align) * align;
+		_pixels.resize((size_t)_stride * height);
+		_originX = _originY = 0;
+	}
+
+	void setOrigin(int x, int y)				{ _originX = x; _originY = y; }
+	int getOriginX() const						{ return _originX; }
+	int getOriginY() const						{ return _originY; }
+
+	unsigned char* getRow(int y)				{ return &_pixels[(size_t)_stride * y]; }
+	const unsigned char* getPixels() const		{ return _pixels.empty() ? NULL : &_pixels[0]; }
+	unsigned char* getPixels()					{ return _pixels.empty() ? NULL : &_pixels[0]; }
+	int getWidth() const						{ return _width; }
+	int getHeight() const						{ return _height; }
+	int getChannels() const						{ return _channels; }
+	int getStride() const						{ return _stride; }
+	JpegPixelFormat getFormat() const			{ return _format; }
+	size_t getSize() const						{ return _pixels.size(); }
+};
+
+typedef std::shared_ptr<DecodedImage> DecodedImageRef;
+
+
+// JPEG to raw pixels using libjpeg(-turbo).
+// scaleDenom 1, 2, 4 or 8 decodes at that fraction of the full size in the
+// DCT domain, so a 1/4 decode costs far less than a full decode plus resize.
+// One decoder per thread; the libjpeg state is reused between calls.
+class JpegDecoder
+{
+private:
+	int				_rowAlignment;
+	std::string		_lastError;
+	// Scanline scratch for region decodes
+	std::vector<unsigned char>	_row;
+
+#ifdef HAVE_LIBJPEG
+	typedef struct _ERROR_MANAGER
+	{
+		struct jpeg_error_mgr	pub;
+		jmp_buf					jump;
+		char					message[JMSG_LENGTH_MAX];
+	}ERROR_MANAGER;
+
+	struct jpeg_decompress_struct	_cinfo;
+	ERROR_MANAGER					_error;
+
+	static void errorExit(j_common_ptr cinfo)
+	{
+		ERROR_MANAGER* error = (ERROR_MANAGER*)cinfo->err;
+		(*cinfo->err->format_message)(cinfo, error->message);
+		longjmp(error->jump, 1);
+	}
+
+	// Corrupt-data warnings are common on live view frames; ignore them.
+	static void outputMessage(j_common_ptr) {}
+#endif
+
+	JpegDecoder(const JpegDecoder&);
+	JpegDecoder& operator=(const JpegDecoder&);
+
+public:
+	JpegDecoder() : _rowAlignment(1)
+	{
+#ifdef HAVE_LIBJPEG
+		_cinfo.err = jpeg_std_error(&_error.pub);
+		_error.pub.error_exit = errorExit;
+		_error.pub.output_message = outputMessage;
+		_error.message[0] = '\0';
+		jpeg_create_decompress(&_cinfo);
+#endif
+	}
+
+	~JpegDecoder()
+	{
+#ifdef HAVE_LIBJPEG
+		jpeg_destroy_decompress(&_cinfo);
+#endif
+	}
+
+	static bool isAvailable()
+	{
+#ifdef HAVE_LIBJPEG
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static bool isValidScale(int scaleDenom)
+	{
+		return scaleDenom == 1 || scaleDenom == 2 || scaleDenom == 4 || scaleDenom == 8;
+	}
+
+	// Row alignment of decoded images, e.g. 4 for DIBs.
+	void setRowAlignment(int alignment)		{ _rowAlignment = alignment; }
+	int getRowAlignment() const				{ return _rowAlignment; }
+
+	const std::string& getLastError() const	{ return _lastError; }
+
+	// Size of the full image without decoding it.
+	bool readHeader(const unsigned char* data, size_t length, int& width, int& height)
+	{
+#ifdef HAVE_LIBJPEG
+		if(!begin(data, length))
+		{
+			return false;
+		}
+
+		if(setjmp(_error.jump))
+		{
+			return fail();
+		}
+
+		jpeg_read_header(&_cinfo, TRUE);
+		width = (int)_cinfo.image_width;
+		height = (int)_cinfo.image_height;
+		jpeg_abort_decompress(&_cinfo);
+		return true;
+#else
+		return unavailable();
+#endif
+	}
+
+	bool decode(const unsigned char* data, size_t length, DecodedImage& out, JpegPixelFormat format = kJpegPixelFormat_RGB, int scaleDenom = 1)
+	{
+#ifdef HAVE_LIBJPEG
+		if(!isValidScale(scaleDenom))
+		{
+			_lastError = "scale must be 1, 2, 4 or 8";
+			return false;
+		}
+
+		if(!begin(data, length))
+		{
+			return false;
+		}
+
+		if(setjmp(_error.jump))
+		{
+			return fail();
+		}
+
+		jpeg_read_header(&_cinfo, TRUE);
+		setup(format, scaleDenom);
+		jpeg_start_decompress(&_cinfo);
+
+		out.allocate((int)_cinfo.output_width, (int)_cinfo.output_height, format, _rowAlignment);
+
+		while(_cinfo.output_scanline < _cinfo.output_height)
+		{
+			JSAMPROW row = out.getRow((int)_cinfo.output_scanline);
+			jpeg_read_scanlines(&_cinfo, &row, 1);
+		}
+
+		jpeg_finish_decompress(&_cinfo);
+
+#ifndef JCS_EXTENSIONS
+		if(format == kJpegPixelFormat_BGR)
+		{
+			swapRedBlue(out);
+		}
+#endif
+		return true;
+#else
+		return unavailable();
+#endif
+	}
+
+	// Decode only the rectangle x, y, width, height given in full-size image
+	// pixels. With jpeg_crop_scanline (libjpeg-turbo 1.5+) only the MCU columns
+	// covering it are decoded and the rows above are skipped; the rows below
+	// are never touched. out gets the region at 1/scaleDenom, and its origin
+	// in scaled output pixels.
+	bool decodeRegion(const unsigned char* data, size_t length, DecodedImage& out, int x, int y, int width, int height,
+		JpegPixelFormat format = kJpegPixelFormat_RGB, int scaleDenom = 1)
+	{
+#ifdef HAVE_LIBJPEG
+		if(!isValidScale(scaleDenom))
+		{
+			_lastError = "scale must be 1, 2, 4 or 8";
+			return false;
+		}
+
+		if(width <= 0 || height <= 0)
+		{
+			_lastError = "empty region";
+			return false;
+		}
+
+		if(!begin(data, length))
+		{
+			return false;
+		}
+
+		if(setjmp(_error.jump))
+		{
+			return fail();
+		}
+
+		jpeg_read_header(&_cinfo, TRUE);
+		setup(format, scaleDenom);
+		jpeg_start_decompress(&_cinfo);
+
+		// Region in output pixels, clipped to the image.
+		int left = clamp(x / scaleDenom, 0, (int)_cinfo.output_width);
+		int top = clamp(y / scaleDenom, 0, (int)_cinfo.output_height);
+		int right = clamp((x + width + scaleDenom - 1) / scaleDenom, 0, (int)_cinfo.output_width);
+		int bottom = clamp((y + height + scaleDenom - 1) / scaleDenom, 0, (int)_cinfo.output_height);
+
+		if(right <= left || bottom <= top)
+		{
+			jpeg_abort_decompress(&_cinfo);
+			_lastError = "region outside the image";
+			return false;
+		}
+
+		int channels = _cinfo.output_components;
+		int skipColumns = left;
+		JDIMENSION firstRow = (JDIMENSION)top;
+
+#ifdef HAVE_JPEG_CROP_SCANLINE
+		// Widened to the iMCU boundary on the left.
+		JDIMENSION cropX = (JDIMENSION)left;
+		JDIMENSION cropWidth = (JDIMENSION)(right - left);
+		jpeg_crop_scanline(&_cinfo, &cropX, &cropWidth);
+		skipColumns = left - (int)cropX;
+
+		if(firstRow > 0)
+		{
+			jpeg_skip_scanlines(&_cinfo, firstRow);
+		}
+#endif
+
+		_row.resize((size_t)_cinfo.output_width * channels);
+
+		out.allocate(right - left, bottom - top, format, _rowAlignment);
+		out.setOrigin(left, top);
+
+		while(_cinfo.output_scanline < (JDIMENSION)bottom)
+		{
+			JSAMPROW row = &_row[0];
+			JDIMENSION line = _cinfo.output_scanline;
+			jpeg_read_scanlines(&_cinfo, &row, 1);
+
+			if(line >= firstRow)
+			{
+				memcpy(out.getRow((int)(line - firstRow)), &_row[(size_t)skipColumns * channels], (size_t)(right - left) * channels);
+			}
+		}
+
+		// Nothing below the region is needed.
+		jpeg_abort_decompress(&_cinfo);
+
+#ifndef JCS_EXTENSIONS
+		if(format == kJpegPixelFormat_BGR)
+		{
+			swapRedBlue(out);
+		}
+#endif
+		return true;
+#else
+		return unavailable();
+#endif
+	}
+
+protected:
+	static int clamp(int value, int low, int high)
+	{
+		return value < low ? low : (value > high ? high : value);
+	}
+
+#ifdef HAVE_LIBJPEG
+	void setup(JpegPixelFormat format, int scaleDenom)
+	{
+		_cinfo.out_color_space = colorSpace(format);
+		_cinfo.scale_num = 1;
+		_cinfo.scale_denom = scaleDenom;
+		_cinfo.dct_method = JDCT_ISLOW;
+		if(scaleDenom > 1)
+		{
+			// Preview quality: skip fancy upsampling when shrinking anyway.
+			_cinfo.do_fancy_upsampling = FALSE;
+			_cinfo.dct_method = JDCT_IFAST;
+		}
+	}
+
+	bool begin(const unsigned char* data, size_t length)
+	{
+		if(data == NULL || length == 0)
+		{
+			_lastError = "empty JPEG data";
+			return false;
+		}
+
+		_lastError.clear();
+		jpeg_mem_src(&_cinfo, const_cast<unsigned char*>(data), (unsigned long)length);
+		return true;
+	}
+
+	bool fail()
+	{
+		_lastError = _error.message;
+		jpeg_abort_decompress(&_cinfo);
+		return false;
+	}
+
+	static J_COLOR_SPACE colorSpace(JpegPixelFormat format)
+	{
+		switch(format)
+		{
+			case kJpegPixelFormat_Gray:	return JCS_GRAYSCALE;
+#ifdef JCS_EXTENSIONS
+			case kJpegPixelFormat_BGR:	return JCS_EXT_BGR;
+#endif
+			default:					return JCS_RGB;
+		}
+	}
+
+	static void swapRedBlue(DecodedImage& image)
+	{
+		for(int y = 0; y < image.getHeight(); y++)
+		{
+			unsigned char* p = image.getRow(y);
+			for(int x = 0; x < image.getWidth(); x++, p += 3)
+			{
+				unsigned char r = p[0];
+				p[0] = p[2];
+				p[2] = r;
+			}
+		}
+	}
+#else
+	bool unavailable()
+	{
+		_lastError = "built without libjpeg";
+		return false;
+	}
+#endif
+};
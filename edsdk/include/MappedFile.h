@@ -0,0 +1,339 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : MappedFile.h                                                    *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+
+#include "EDSDK.h"
+
+
+// A whole file mapped into memory, created at a fixed size or opened as it
+// is. A named shared memory segment is mapped the same way.
+class MappedFile
+{
+private:
+	unsigned char*	_data;
+	EdsUInt64		_size;
+	bool			_writable;
+	// Segment removed again at close, by the process that created it
+	std::string		_sharedName;
+#ifdef _WIN32
+	HANDLE			_file;
+	HANDLE			_mapping;
+#else
+	int				_file;
+#endif
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	EdsError map(EdsUInt64 size, bool writable)
+	{
+#ifdef _WIN32
+		if(_mapping == NULL)
+		{
+			_mapping = CreateFileMappingA(_file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+				(DWORD)(size >> 32), (DWORD)(size & 0xFFFFFFFF), NULL);
+		}
+		if(_mapping == NULL)
+		{
+			return EDS_ERR_MEM_ALLOC_FAILED;
+		}
+		_data = (unsigned char*)MapViewOfFile(_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, (SIZE_T)size);
+#else
+		void* data = mmap(NULL, (size_t)size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, _file, 0);
+		_data = (data != MAP_FAILED) ? (unsigned char*)data : NULL;
+#endif
+		if(_data == NULL)
+		{
+			return EDS_ERR_MEM_ALLOC_FAILED;
+		}
+		_size = size;
+		_writable = writable;
+		return EDS_ERR_OK;
+	}
+
+public:
+#ifdef _WIN32
+	MappedFile() : _data(NULL), _size(0), _writable(false), _file(INVALID_HANDLE_VALUE), _mapping(NULL) {}
+#else
+	MappedFile() : _data(NULL), _size(0), _writable(false), _file(-1) {}
+#endif
+
+	~MappedFile()
+	{
+		close();
+	}
+
+	// Replaces any file at path with size bytes of zeros, mapped for writing.
+	// The space is reserved up front so writing never grows the file.
+	EdsError create(const char* path, EdsUInt64 size)
+	{
+		close();
+		if(size == 0)
+		{
+			return EDS_ERR_INVALID_PARAMETER;
+		}
+
+#ifdef _WIN32
+		_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(_file == INVALID_HANDLE_VALUE)
+		{
+			return EDS_ERR_FILE_OPEN_ERROR;
+		}
+		LARGE_INTEGER end;
+		end.QuadPart = (LONGLONG)size;
+		if(!SetFilePointerEx(_file, end, NULL, FILE_BEGIN) || !SetEndOfFile(_file))
+		{
+			close();
+			return EDS_ERR_FILE_DISK_FULL_ERROR;
+		}
+#else
+		_file = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if(_file < 0)
+		{
+			return EDS_ERR_FILE_OPEN_ERROR;
+		}
+		if(ftruncate(_file, (off_t)size) != 0)
+		{
+			close();
+			return EDS_ERR_FILE_DISK_FULL_ERROR;
+		}
+#endif
+
+		EdsError err = map(size, true);
+		if(err != EDS_ERR_OK)
+		{
+			close();
+		}
+		return err;
+	}
+
+	EdsError open(const char* path, bool writable = false)
+	{
+		close();
+
+		EdsUInt64 size = 0;
+#ifdef _WIN32
+		_file = CreateFileA(path, writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(_file == INVALID_HANDLE_VALUE)
+		{
+			return EDS_ERR_FILE_NOT_FOUND;
+		}
+		LARGE_INTEGER length;
+		if(GetFileSizeEx(_file, &length))
+		{
+			size = (EdsUInt64)length.QuadPart;
+		}
+#else
+		_file = ::open(path, writable ? O_RDWR : O_RDONLY);
+		if(_file < 0)
+		{
+			return EDS_ERR_FILE_NOT_FOUND;
+		}
+		struct stat info;
+		if(fstat(_file, &info) == 0)
+		{
+			size = (EdsUInt64)info.st_size;
+		}
+#endif
+		if(size == 0)
+		{
+			close();
+			return EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+		}
+
+		EdsError err = map(size, writable);
+		if(err != EDS_ERR_OK)
+		{
+			close();
+		}
+		return err;
+	}
+
+	// A segment other processes can open by name. One left behind by a
+	// process that crashed is replaced.
+	EdsError createShared(const char* name, EdsUInt64 size)
+	{
+		close();
+		if(size == 0)
+		{
+			return EDS_ERR_INVALID_PARAMETER;
+		}
+
+#ifdef _WIN32
+		_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+			(DWORD)(size >> 32), (DWORD)(size & 0xFFFFFFFF), name);
+		if(_mapping == NULL)
+		{
+			return EDS_ERR_MEM_ALLOC_FAILED;
+		}
+		if(GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			close();
+			return EDS_ERR_FILE_ALREADY_EXISTS;
+		}
+#else
+		std::string path = std::string("/") + name;
+		shm_unlink(path.c_str());
+		_file = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if(_file < 0)
+		{
+			return EDS_ERR_FILE_OPEN_ERROR;
+		}
+		_sharedName = path;
+		if(ftruncate(_file, (off_t)size) != 0)
+		{
+			close();
+			return EDS_ERR_MEM_ALLOC_FAILED;
+		}
+#endif
+
+		EdsError err = map(size, true);
+		if(err != EDS_ERR_OK)
+		{
+			close();
+		}
+		return err;
+	}
+
+	EdsError openShared(const char* name, bool writable = false)
+	{
+		close();
+
+		EdsUInt64 size = 0;
+#ifdef _WIN32
+		_mapping = OpenFileMappingA(writable ? FILE_MAP_WRITE : FILE_MAP_READ, FALSE, name);
+		if(_mapping == NULL)
+		{
+			return EDS_ERR_FILE_NOT_FOUND;
+		}
+		void* view = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+		MEMORY_BASIC_INFORMATION info;
+		if(view != NULL && VirtualQuery(view, &info, sizeof(info)) != 0)
+		{
+			size = (EdsUInt64)info.RegionSize;
+		}
+		if(view != NULL)
+		{
+			UnmapViewOfFile(view);
+		}
+#else
+		std::string path = std::string("/") + name;
+		_file = shm_open(path.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+		if(_file < 0)
+		{
+			return EDS_ERR_FILE_NOT_FOUND;
+		}
+		struct stat info;
+		if(fstat(_file, &info) == 0)
+		{
+			size = (EdsUInt64)info.st_size;
+		}
+#endif
+		if(size == 0)
+		{
+			close();
+			return EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+		}
+
+		EdsError err = map(size, writable);
+		if(err != EDS_ERR_OK)
+		{
+			close();
+		}
+		return err;
+	}
+
+	// Writes dirty pages back to the file; the OS does so anyway at close
+	bool flush()
+	{
+		if(_data == NULL || !_writable)
+		{
+			return false;
+		}
+#ifdef _WIN32
+		return FlushViewOfFile(_data, 0) && FlushFileBuffers(_file);
+#else
+		return msync(_data, (size_t)_size, MS_SYNC) == 0;
+#endif
+	}
+
+	// Unmaps, then cuts a file opened for writing down to truncateTo bytes
+	// when that is non-zero
+	void close(EdsUInt64 truncateTo = 0)
+	{
+#ifdef _WIN32
+		if(_data != NULL)
+		{
+			UnmapViewOfFile(_data);
+		}
+		if(_mapping != NULL)
+		{
+			CloseHandle(_mapping);
+			_mapping = NULL;
+		}
+		if(_file != INVALID_HANDLE_VALUE)
+		{
+			if(_writable && truncateTo != 0 && truncateTo < _size)
+			{
+				LARGE_INTEGER end;
+				end.QuadPart = (LONGLONG)truncateTo;
+				if(SetFilePointerEx(_file, end, NULL, FILE_BEGIN))
+				{
+					SetEndOfFile(_file);
+				}
+			}
+			CloseHandle(_file);
+			_file = INVALID_HANDLE_VALUE;
+		}
+#else
+		if(_data != NULL)
+		{
+			munmap(_data, (size_t)_size);
+		}
+		if(_file >= 0)
+		{
+			if(_writable && truncateTo != 0 && truncateTo < _size)
+			{
+				if(ftruncate(_file, (off_t)truncateTo) != 0)
+				{
+					// The file keeps its reserved size; readers go by the header
+				}
+			}
+			::close(_file);
+			_file = -1;
+		}
+		if(!_sharedName.empty())
+		{
+			shm_unlink(_sharedName.c_str());
+		}
+#endif
+		_sharedName.clear();
+		_data = NULL;
+		_size = 0;
+		_writable = false;
+	}
+
+	bool isOpen() const					{ return _data != NULL; }
+	unsigned char* getData() const		{ return _data; }
+	EdsUInt64 getSize() const			{ return _size; }
+};
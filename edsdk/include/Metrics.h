@@ -0,0 +1,413 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : Metrics.h                                                       *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "EDSDK.h"
+#include "EvfFrame.h"
+
+
+// Counts of a LatencyHistogram. buckets[i] counts values in
+// [LatencyHistogram::bucketLowerMicros(i), LatencyHistogram::bucketUpperMicros(i)).
+typedef struct _LATENCY_SNAPSHOT
+{
+	EdsUInt64				count;
+	EdsUInt64				totalMicros;
+	EdsUInt64				minMicros;
+	EdsUInt64				maxMicros;
+	std::vector<EdsUInt64>	buckets;
+}LATENCY_SNAPSHOT;
+
+
+// Log-linear histogram of microseconds, after HdrHistogram: 8 sub-buckets
+// per power of two, so any value is placed within 12.5%. Recording is a
+// few relaxed atomic adds and needs no lock; values past about 19 hours
+// land in the last bucket.
+class LatencyHistogram
+{
+public:
+	enum
+	{
+		kSubBucketBits = 3,
+		kSubBuckets = 1 << kSubBucketBits,
+		kMaxBits = 36,
+		kBucketCount = kSubBuckets + (kMaxBits - kSubBucketBits) * kSubBuckets
+	};
+
+private:
+	std::atomic<EdsUInt64>	_buckets[kBucketCount];
+	std::atomic<EdsUInt64>	_count;
+	std::atomic<EdsUInt64>	_total;
+	std::atomic<EdsUInt64>	_min;
+	std::atomic<EdsUInt64>	_max;
+
+	LatencyHistogram(const LatencyHistogram&);
+	LatencyHistogram& operator=(const LatencyHistogram&);
+
+	static int highestBit(EdsUInt64 value)
+	{
+		int bit = 0;
+		while(value >>= 1)
+		{
+			bit++;
+		}
+		return bit;
+	}
+
+public:
+	LatencyHistogram()
+	{
+		reset();
+	}
+
+	static int bucketOf(EdsUInt64 micros)
+	{
+		if(micros < kSubBuckets)
+		{
+			return (int)micros;
+		}
+		int bit = highestBit(micros);
+		if(bit >= kMaxBits)
+		{
+			return kBucketCount - 1;
+		}
+		return (bit - kSubBucketBits + 1) * kSubBuckets + (int)((micros >> (bit - kSubBucketBits)) & (kSubBuckets - 1));
+	}
+
+	static EdsUInt64 bucketLowerMicros(int bucket)
+	{
+		if(bucket < kSubBuckets)
+		{
+			return (EdsUInt64)bucket;
+		}
+		int shift = bucket / kSubBuckets - 1;
+		return (EdsUInt64)(kSubBuckets + bucket % kSubBuckets) << shift;
+	}
+
+	static EdsUInt64 bucketUpperMicros(int bucket)
+	{
+		if(bucket < kSubBuckets)
+		{
+			return (EdsUInt64)bucket + 1;
+		}
+		int shift = bucket / kSubBuckets - 1;
+		return bucketLowerMicros(bucket) + ((EdsUInt64)1 << shift);
+	}
+
+	void record(EdsUInt64 micros)
+	{
+		_buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+		_count.fetch_add(1, std::memory_order_relaxed);
+		_total.fetch_add(micros, std::memory_order_relaxed);
+
+		EdsUInt64 min = _min.load(std::memory_order_relaxed);
+		while(micros < min && !_min.compare_exchange_weak(min, micros, std::memory_order_relaxed)) {}
+		EdsUInt64 max = _max.load(std::memory_order_relaxed);
+		while(micros > max && !_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {}
+	}
+
+	void reset()
+	{
+		for(int i = 0; i < kBucketCount; i++)
+		{
+			_buckets[i].store(0, std::memory_order_relaxed);
+		}
+		_count.store(0, std::memory_order_relaxed);
+		_total.store(0, std::memory_order_relaxed);
+		_min.store((EdsUInt64)-1, std::memory_order_relaxed);
+		_max.store(0, std::memory_order_relaxed);
+	}
+
+	// Not atomic as a whole: a value recorded meanwhile may be in some
+	// fields and not others
+	LATENCY_SNAPSHOT snapshot() const
+	{
+		LATENCY_SNAPSHOT snapshot;
+		snapshot.count = _count.load(std::memory_order_relaxed);
+		snapshot.totalMicros = _total.load(std::memory_order_relaxed);
+		snapshot.minMicros = (snapshot.count != 0) ? _min.load(std::memory_order_relaxed) : 0;
+		snapshot.maxMicros = _max.load(std::memory_order_relaxed);
+		snapshot.buckets.resize(kBucketCount);
+		for(int i = 0; i < kBucketCount; i++)
+		{
+			snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+		}
+		return snapshot;
+	}
+
+	// Upper bound of the bucket holding the given fraction of values, 0-1
+	static EdsUInt64 percentile(const LATENCY_SNAPSHOT& snapshot, double fraction)
+	{
+		EdsUInt64 total = 0;
+		for(size_t i = 0; i < snapshot.buckets.size(); i++)
+		{
+			total += snapshot.buckets[i];
+		}
+		if(total == 0)
+		{
+			return 0;
+		}
+
+		EdsUInt64 rank = (EdsUInt64)(fraction * (double)total + 0.5);
+		if(rank < 1) rank = 1;
+		if(rank > total) rank = total;
+
+		EdsUInt64 seen = 0;
+		for(size_t i = 0; i < snapshot.buckets.size(); i++)
+		{
+			seen += snapshot.buckets[i];
+			if(seen >= rank)
+			{
+				EdsUInt64 upper = bucketUpperMicros((int)i);
+				return (upper > snapshot.maxMicros && snapshot.maxMicros != 0) ? snapshot.maxMicros : upper;
+			}
+		}
+		return snapshot.maxMicros;
+	}
+};
+
+
+// Events per second over a sliding one second window, plus a total. Meant
+// for one writer; readers on any thread.
+class RateMeter
+{
+private:
+	enum { kWindowMicros = 1000000 };
+
+	std::atomic<EdsUInt64>	_total;
+	std::atomic<EdsUInt64>	_byteTotal;
+	std::atomic<EdsUInt64>	_windowStart;
+	std::atomic<EdsUInt64>	_windowCount;
+	std::atomic<EdsUInt64>	_windowBytes;
+	std::atomic<EdsUInt64>	_lastMicros;
+	// Rates of the last full window, as raw double bits
+	std::atomic<EdsUInt64>	_rate;
+	std::atomic<EdsUInt64>	_byteRate;
+
+	static EdsUInt64 toBits(double value)		{ EdsUInt64 bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+	static double fromBits(EdsUInt64 bits)		{ double value; memcpy(&value, &bits, sizeof(value)); return value; }
+
+public:
+	RateMeter() : _total(0), _byteTotal(0), _windowStart(0), _windowCount(0), _windowBytes(0), _lastMicros(0), _rate(toBits(0.0)), _byteRate(toBits(0.0)) {}
+
+	void record(EdsUInt64 bytes = 0)
+	{
+		EdsUInt64 now = evfClockMicros();
+		EdsUInt64 start = _windowStart.load(std::memory_order_relaxed);
+		if(start == 0)
+		{
+			_windowStart.store(now, std::memory_order_relaxed);
+			start = now;
+		}
+		else if(now - start >= kWindowMicros)
+		{
+			double seconds = (double)(now - start) / 1000000.0;
+			_rate.store(toBits((double)_windowCount.load(std::memory_order_relaxed) / seconds), std::memory_order_relaxed);
+			_byteRate.store(toBits((double)_windowBytes.load(std::memory_order_relaxed) / seconds), std::memory_order_relaxed);
+			_windowCount.store(0, std::memory_order_relaxed);
+			_windowBytes.store(0, std::memory_order_relaxed);
+			_windowStart.store(now, std::memory_order_relaxed);
+		}
+
+		_windowCount.fetch_add(1, std::memory_order_relaxed);
+		_windowBytes.fetch_add(bytes, std::memory_order_relaxed);
+		_total.fetch_add(1, std::memory_order_relaxed);
+		_byteTotal.fetch_add(bytes, std::memory_order_relaxed);
+		_lastMicros.store(now, std::memory_order_relaxed);
+	}
+
+	EdsUInt64 getTotal() const		{ return _total.load(std::memory_order_relaxed); }
+	EdsUInt64 getByteTotal() const	{ return _byteTotal.load(std::memory_order_relaxed); }
+
+	// 0 once nothing has been recorded for a full window
+	double getRate() const
+	{
+		EdsUInt64 last = _lastMicros.load(std::memory_order_relaxed);
+		if(last == 0 || evfClockMicros() - last > 2 * kWindowMicros)
+		{
+			return 0.0;
+		}
+		return fromBits(_rate.load(std::memory_order_relaxed));
+	}
+
+	double getByteRate() const
+	{
+		EdsUInt64 last = _lastMicros.load(std::memory_order_relaxed);
+		if(last == 0 || evfClockMicros() - last > 2 * kWindowMicros)
+		{
+			return 0.0;
+		}
+		return fromBits(_byteRate.load(std::memory_order_relaxed));
+	}
+};
+
+
+// Counters of one kind of command on one processor
+typedef struct _COMMAND_METRICS
+{
+	const char*			name;
+	EdsUInt64			executions;			// execute() calls, retries included
+	EdsUInt64			completed;			// runs that did not ask for a retry
+	EdsUInt64			errors;				// completed runs with an error
+	EdsUInt64			busyRetries;		// retries after EDS_ERR_DEVICE_BUSY
+	EdsUInt64			notReadyRetries;	// retries after EDS_ERR_OBJECT_NOTREADY
+	EdsUInt64			otherRetries;
+	EdsUInt64			abandoned;			// given up on by the retry policy
+	LATENCY_SNAPSHOT	executeLatency;		// time inside execute()
+}COMMAND_METRICS;
+
+
+// Per command type counters of a processor. Written by the processor
+// thread only, read from any thread without a lock.
+class CommandMetrics
+{
+public:
+	enum { kMaxCommandTypes = 32 };
+
+private:
+	struct Entry
+	{
+		std::atomic<const char*>	name;
+		std::atomic<EdsUInt64>		executions;
+		std::atomic<EdsUInt64>		completed;
+		std::atomic<EdsUInt64>		errors;
+		std::atomic<EdsUInt64>		busyRetries;
+		std::atomic<EdsUInt64>		notReadyRetries;
+		std::atomic<EdsUInt64>		otherRetries;
+		std::atomic<EdsUInt64>		abandoned;
+		LatencyHistogram			latency;
+	};
+
+	Entry					_entries[kMaxCommandTypes];
+	std::atomic<int>		_used;
+	LatencyHistogram		_dispatchLatency;
+
+	CommandMetrics(const CommandMetrics&);
+	CommandMetrics& operator=(const CommandMetrics&);
+
+	// Names are usually the same literal, compare the text only on a miss
+	Entry* entryOf(const char* name)
+	{
+		int used = _used.load(std::memory_order_acquire);
+		for(int i = 0; i < used; i++)
+		{
+			if(_entries[i].name.load(std::memory_order_relaxed) == name)
+			{
+				return &_entries[i];
+			}
+		}
+		for(int i = 0; i < used; i++)
+		{
+			if(strcmp(_entries[i].name.load(std::memory_order_relaxed), name) == 0)
+			{
+				return &_entries[i];
+			}
+		}
+		if(used == kMaxCommandTypes)
+		{
+			// The last entry takes whatever does not fit
+			return &_entries[kMaxCommandTypes - 1];
+		}
+
+		Entry* entry = &_entries[used];
+		entry->name.store(name, std::memory_order_relaxed);
+		_used.store(used + 1, std::memory_order_release);
+		return entry;
+	}
+
+public:
+	CommandMetrics() : _used(0)
+	{
+		for(int i = 0; i < kMaxCommandTypes; i++)
+		{
+			Entry& entry = _entries[i];
+			entry.name.store(NULL, std::memory_order_relaxed);
+			entry.executions.store(0, std::memory_order_relaxed);
+			entry.completed.store(0, std::memory_order_relaxed);
+			entry.errors.store(0, std::memory_order_relaxed);
+			entry.busyRetries.store(0, std::memory_order_relaxed);
+			entry.notReadyRetries.store(0, std::memory_order_relaxed);
+			entry.otherRetries.store(0, std::memory_order_relaxed);
+			entry.abandoned.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	// Processor thread, after each execute()
+	void recordExecution(const char* name, bool complete, EdsError error, EdsUInt64 micros)
+	{
+		Entry* entry = entryOf(name);
+		entry->executions.fetch_add(1, std::memory_order_relaxed);
+		entry->latency.record(micros);
+
+		if(complete)
+		{
+			entry->completed.fetch_add(1, std::memory_order_relaxed);
+			if(error != EDS_ERR_OK)
+			{
+				entry->errors.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		else if((error & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			entry->busyRetries.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if(error == EDS_ERR_OBJECT_NOTREADY)
+		{
+			entry->notReadyRetries.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			entry->otherRetries.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Processor thread, when a retry is not scheduled after all
+	void recordAbandoned(const char* name)
+	{
+		entryOf(name)->abandoned.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Time from enqueue, or from the retry time, to dispatch
+	void recordDispatch(EdsUInt64 micros)
+	{
+		_dispatchLatency.record(micros);
+	}
+
+	std::vector<COMMAND_METRICS> getCommandMetrics() const
+	{
+		std::vector<COMMAND_METRICS> metrics;
+		int used = _used.load(std::memory_order_acquire);
+		for(int i = 0; i < used; i++)
+		{
+			const Entry& entry = _entries[i];
+			COMMAND_METRICS command;
+			command.name = entry.name.load(std::memory_order_relaxed);
+			command.executions = entry.executions.load(std::memory_order_relaxed);
+			command.completed = entry.completed.load(std::memory_order_relaxed);
+			command.errors = entry.errors.load(std::memory_order_relaxed);
+			command.busyRetries = entry.busyRetries.load(std::memory_order_relaxed);
+			command.notReadyRetries = entry.notReadyRetries.load(std::memory_order_relaxed);
+			command.otherRetries = entry.otherRetries.load(std::memory_order_relaxed);
+			command.abandoned = entry.abandoned.load(std::memory_order_relaxed);
+			command.executeLatency = entry.latency.snapshot();
+			metrics.push_back(command);
+		}
+		return metrics;
+	}
+
+	LATENCY_SNAPSHOT getDispatchLatency() const
+	{
+		return _dispatchLatency.snapshot();
+	}
+};
@@ -0,0 +1,380 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : MotionTrigger.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraController.h"
+#include "EvfFrame.h"
+#include "EvfRegion.h"
+#include "ImageKernels.h"
+#include "JpegDecoder.h"
+#include "Metrics.h"
+#include "ShootPipeline.h"
+#include "TakePictureCommand.h"
+
+
+// What each frame is compared with
+enum MotionModel
+{
+	// The frame before
+	kMotionModel_FrameDifference = 0,
+	// A running average of the frames, which slow changes blend into
+	kMotionModel_Background,
+};
+
+enum MotionAction
+{
+	kMotionAction_Notify = 0x01,	// listeners
+	kMotionAction_Capture = 0x02,	// release the shutter
+};
+
+// Times are evfClockMicros().
+typedef struct _MOTION_EVENT
+{
+	EdsUInt64		index;				// triggers so far, from 1
+	EdsUInt64		frameSequence;
+	double			score;				// fraction of the region that changed
+	EdsUInt64		frameMicros;		// download start of the frame
+	EdsUInt64		detectMicros;
+	EdsUInt64		latencyMicros;		// frame to detection
+	ShotFutureRef	shot;				// with a pipeline and the capture action
+}MOTION_EVENT;
+
+typedef std::function<void(const MOTION_EVENT&)> MotionListener;
+
+typedef struct _MOTION_TRIGGER_STATISTICS
+{
+	EdsUInt64			frames;
+	EdsUInt64			scored;			// past the warm-up and decoded
+	EdsUInt64			failed;			// could not be decoded
+	EdsUInt64			triggers;
+	EdsUInt64			suppressed;		// over the threshold in the cooldown
+	double				lastScore;
+	double				peakScore;
+	LATENCY_SNAPSHOT	detect;			// frame download start to detection
+	LATENCY_SNAPSHOT	release;		// detection to the release returning
+}MOTION_TRIGGER_STATISTICS;
+
+
+// Live view as a trigger. Each frame is decoded as a downscaled luma plane,
+// optionally of a region only, and compared pixel by pixel with the frame
+// before or a background model. When the fraction of pixels that changed
+// by more than the pixel threshold crosses the threshold, the trigger fires
+// on the pump thread: it releases the shutter, through a ShootPipeline if
+// one is set, and calls the listeners. A cooldown keeps one event from
+// firing again and again.
+// Add to an EvfPump with addSink(); remove it before destroying it.
+class MotionTrigger : public EvfFrameSink
+{
+public:
+	enum { kDefaultScale = 8, kDefaultPixelThreshold = 24, kDefaultWarmupFrames = 3, kDefaultCooldownMillis = 1000 };
+
+private:
+	CameraController*				_controller;
+	ShootPipelineRef				_pipeline;
+
+	std::mutex						_mutex;
+	bool							_armed;
+	MotionModel						_model;
+	int								_backgroundShift;	// the background learns 1/2^shift of each frame
+	double							_threshold;
+	int								_pixelThreshold;
+	int								_scale;
+	EvfRegionMode					_regionMode;
+	EdsRect							_region;
+	EvfCoordinateSpace				_regionSpace;
+	EdsUInt32						_warmupFrames;
+	EdsUInt32						_cooldownMillis;
+	EdsUInt32						_actions;
+	bool							_autoFocus;
+	bool							_reset;
+	std::vector<MotionListener>		_listeners;
+	MOTION_TRIGGER_STATISTICS		_stats;
+	LatencyHistogram				_detectLatency;
+	std::shared_ptr<LatencyHistogram>	_releaseLatency;
+
+	// Pump thread only
+	JpegDecoder						_decoder;
+	DecodedImage					_image;
+	std::vector<unsigned char>		_reference;
+	std::vector<EdsUInt16>			_background;		// 8.8 fixed point
+	int								_width;
+	int								_height;
+	EdsUInt32						_learned;
+	EdsUInt64						_lastTriggerMicros;
+
+	MotionTrigger(const MotionTrigger&);
+	MotionTrigger& operator=(const MotionTrigger&);
+
+	// Takes the frame as the reference, or blends it into the background
+	void learn(const unsigned char* pixels, int stride, MotionModel model, int shift)
+	{
+		for(int y = 0; y < _height; y++)
+		{
+			const unsigned char* in = pixels + (size_t)stride * y;
+			unsigned char* reference = &_reference[(size_t)_width * y];
+			if(model == kMotionModel_FrameDifference || _learned == 0)
+			{
+				memcpy(reference, in, _width);
+				if(model == kMotionModel_Background)
+				{
+					EdsUInt16* background = &_background[(size_t)_width * y];
+					for(int x = 0; x < _width; x++)
+					{
+						background[x] = (EdsUInt16)(in[x] << 8);
+					}
+				}
+				continue;
+			}
+
+			EdsUInt16* background = &_background[(size_t)_width * y];
+			for(int x = 0; x < _width; x++)
+			{
+				int value = background[x];
+				value += (((int)in[x] << 8) - value) >> shift;
+				background[x] = (EdsUInt16)value;
+				reference[x] = (unsigned char)((value + 128) >> 8);
+			}
+		}
+		_learned++;
+	}
+
+public:
+	// Without a controller the trigger only notifies
+	MotionTrigger(CameraController* controller = NULL)
+		: _controller(controller), _armed(true), _model(kMotionModel_FrameDifference), _backgroundShift(3),
+		  _threshold(0.02), _pixelThreshold(kDefaultPixelThreshold), _scale(kDefaultScale), _regionMode(kEvfRegion_None),
+		  _regionSpace(kEvfCoordinate_JpegLarge), _warmupFrames(kDefaultWarmupFrames), _cooldownMillis(kDefaultCooldownMillis),
+		  _actions(kMotionAction_Notify | (controller != NULL ? kMotionAction_Capture : 0)), _autoFocus(false), _reset(true),
+		  _stats(), _releaseLatency(std::make_shared<LatencyHistogram>()),
+		  _width(0), _height(0), _learned(0), _lastTriggerMicros(0)
+	{
+		memset(&_region, 0, sizeof(_region));
+	}
+
+	// Shots go through the pipeline, so their files come back as futures
+	void setPipeline(const ShootPipelineRef& pipeline)	{ std::lock_guard<std::mutex> lock(_mutex); _pipeline = pipeline; }
+
+	// shift 1 to 7: how fast the background follows, 1/2^shift per frame
+	void setModel(MotionModel model, int backgroundShift = 3)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_model = model;
+		_backgroundShift = (backgroundShift < 1) ? 1 : (backgroundShift > 7 ? 7 : backgroundShift);
+		_reset = true;
+	}
+
+	// Fraction of the region, 0 to 1, and the luma change a pixel needs to count
+	void setThreshold(double threshold, int pixelThreshold = kDefaultPixelThreshold)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_threshold = threshold;
+		_pixelThreshold = pixelThreshold;
+	}
+
+	// 1, 2, 4 or 8; the frame is decoded at that fraction of its size
+	void setScale(int scaleDenom)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_scale = JpegDecoder::isValidScale(scaleDenom) ? scaleDenom : kDefaultScale;
+		_reset = true;
+	}
+
+	void setRegion(const EdsRect& region, EvfCoordinateSpace space)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_region = region;
+		_regionSpace = space;
+		_regionMode = kEvfRegion_Fixed;
+		_reset = true;
+	}
+
+	void clearRegion()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_regionMode = kEvfRegion_None;
+		_reset = true;
+	}
+
+	// Frames learned after a reset before any is scored
+	void setWarmupFrames(EdsUInt32 frames)			{ std::lock_guard<std::mutex> lock(_mutex); _warmupFrames = frames; }
+	void setCooldown(EdsUInt32 millisec)			{ std::lock_guard<std::mutex> lock(_mutex); _cooldownMillis = millisec; }
+	void setActions(EdsUInt32 actions)				{ std::lock_guard<std::mutex> lock(_mutex); _actions = actions; }
+	// Off releases without AF, which is faster
+	void setAutoFocus(bool autoFocus)				{ std::lock_guard<std::mutex> lock(_mutex); _autoFocus = autoFocus; }
+
+	// A disarmed trigger keeps learning but does not fire
+	void arm(bool armed)							{ std::lock_guard<std::mutex> lock(_mutex); _armed = armed; }
+	bool isArmed()									{ std::lock_guard<std::mutex> lock(_mutex); return _armed; }
+
+	// Learn the scene again, e.g. after the camera moved
+	void reset()									{ std::lock_guard<std::mutex> lock(_mutex); _reset = true; }
+
+	// Called on the pump thread
+	void addListener(const MotionListener& listener)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_listeners.push_back(listener);
+	}
+
+	MOTION_TRIGGER_STATISTICS getStatistics()
+	{
+		MOTION_TRIGGER_STATISTICS stats;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			stats = _stats;
+		}
+		stats.detect = _detectLatency.snapshot();
+		stats.release = _releaseLatency->snapshot();
+		return stats;
+	}
+
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		if(!frame)
+		{
+			return;
+		}
+
+		MotionModel model;
+		int shift, pixelThreshold, scale;
+		double threshold;
+		EvfRegionMode regionMode;
+		EdsRect region;
+		EvfCoordinateSpace regionSpace;
+		EdsUInt32 warmupFrames;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stats.frames++;
+			if(_reset)
+			{
+				_learned = 0;
+				_reset = false;
+			}
+			model = _model;
+			shift = _backgroundShift;
+			threshold = _threshold;
+			pixelThreshold = _pixelThreshold;
+			scale = _scale;
+			regionMode = _regionMode;
+			region = _region;
+			regionSpace = _regionSpace;
+			warmupFrames = _warmupFrames;
+		}
+
+		bool decoded = (regionMode == kEvfRegion_Fixed)
+			? decodeEvfRegion(_decoder, *frame, region, regionSpace, _image, kJpegPixelFormat_Gray, scale)
+			: _decoder.decode(frame->getData(), (size_t)frame->getLength(), _image, kJpegPixelFormat_Gray, scale);
+		if(!decoded || _image.getWidth() == 0 || _image.getHeight() == 0)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stats.failed++;
+			return;
+		}
+
+		if(_image.getWidth() != _width || _image.getHeight() != _height)
+		{
+			_width = _image.getWidth();
+			_height = _image.getHeight();
+			_reference.assign((size_t)_width * _height, 0);
+			_background.assign((size_t)_width * _height, 0);
+			_learned = 0;
+		}
+
+		// Compared with the reference as it was, then learned
+		double score = -1.0;
+		if(_learned >= (warmupFrames > 0 ? warmupFrames : 1))
+		{
+			EdsUInt64 changed = countChangedPixels(_image.getPixels(), _image.getStride(), &_reference[0], _width,
+				_width, _height, pixelThreshold);
+			score = (double)changed / ((double)_width * _height);
+		}
+		learn(_image.getPixels(), _image.getStride(), model, shift);
+
+		if(score < 0.0)
+		{
+			return;
+		}
+
+		EdsUInt64 now = evfClockMicros();
+		EdsUInt64 frameMicros = frame->getDataSet().timing.downloadStart;
+
+		MOTION_EVENT e;
+		std::vector<MotionListener> listeners;
+		EdsUInt32 actions = 0;
+		bool autoFocus = false;
+		ShootPipelineRef pipeline;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stats.scored++;
+			_stats.lastScore = score;
+			if(score > _stats.peakScore)
+			{
+				_stats.peakScore = score;
+			}
+
+			if(!_armed || score < threshold)
+			{
+				return;
+			}
+			if(_lastTriggerMicros != 0 && now - _lastTriggerMicros < (EdsUInt64)_cooldownMillis * 1000)
+			{
+				_stats.suppressed++;
+				return;
+			}
+
+			_lastTriggerMicros = now;
+			_stats.triggers++;
+			e.index = _stats.triggers;
+			e.frameSequence = frame->getSequence();
+			e.score = score;
+			e.frameMicros = frameMicros;
+			e.detectMicros = now;
+			e.latencyMicros = (frameMicros != 0 && now > frameMicros) ? now - frameMicros : 0;
+			listeners = _listeners;
+			actions = _actions;
+			autoFocus = _autoFocus;
+			pipeline = _pipeline;
+		}
+		_detectLatency.record(e.latencyMicros);
+
+		if((actions & kMotionAction_Capture) && pipeline && pipeline->isRunning())
+		{
+			// Does not wait for a slot, a late shot is no use
+			e.shot = pipeline->shoot(0);
+		}
+		else if((actions & kMotionAction_Capture) && _controller != NULL)
+		{
+			std::shared_ptr<LatencyHistogram> releaseLatency = _releaseLatency;
+			EdsUInt64 detected = e.detectMicros;
+			_controller->enqueue(new TakePictureCommand(_controller->getCameraModel(), autoFocus), [releaseLatency, detected](bool executed)
+			{
+				if(executed)
+				{
+					releaseLatency->record(evfClockMicros() - detected);
+				}
+			});
+		}
+
+		if(actions & kMotionAction_Notify)
+		{
+			for(size_t i = 0; i < listeners.size(); i++)
+			{
+				listeners[i](e);
+			}
+		}
+	}
+};
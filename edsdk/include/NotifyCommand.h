@@ -29,6 +29,8 @@ public:
 	NotifyCommand(CameraModel *model, std::string notifyString)
 		: Command(model) , _notifyString(notifyString){}
 
+	virtual const char* getName() const {return "Notify";}
+
     // Execute command	
 	virtual bool execute()
 	{
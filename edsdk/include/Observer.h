@@ -25,11 +25,69 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include <string>
 
+#include "CameraEvent.h"
+#include "Trace.h"
+
 
 class Observable;
-class CameraEvent;
+
+
+// Which events a subscription receives: the kinds whose cameraEventMask
+// bits are in mask and, of the property events, only those about one of
+// properties. Checked before the observer is called, so an observer in
+// Python is not entered for events it would ignore.
+struct EventFilter
+{
+	EdsUInt32		mask;
+	PropertyIDList	properties;		// empty for every property
+
+	EventFilter(EdsUInt32 eventMask = kCameraEventMask_All, const PropertyIDList& propertyIDs = PropertyIDList())
+		: mask(eventMask), properties(propertyIDs) {}
+
+	bool hasProperty(EdsUInt32 propertyID) const
+	{
+		return std::find(properties.begin(), properties.end(), propertyID) != properties.end();
+	}
+
+	bool accepts(const CameraEvent& e) const
+	{
+		if((mask & cameraEventMask(e.getID())) == 0)
+		{
+			return false;
+		}
+		if(properties.empty() || e.getArg() == NULL)
+		{
+			return true;
+		}
+
+		switch(e.getID())
+		{
+		case kCameraEvent_PropertyChanged:
+		case kCameraEvent_PropertyDescChanged:
+			return hasProperty(*static_cast<EdsUInt32*>(e.getArg()));
+
+		case kCameraEvent_PropertiesChanged:
+			{
+				const PropertyIDList* list = e.getPayload<kCameraEvent_PropertiesChanged>();
+				for(size_t i = 0; i < list->size(); i++)
+				{
+					if(hasProperty((*list)[i]))
+					{
+						return true;
+					}
+				}
+			}
+			return false;
+
+		default:
+			return true;
+		}
+	}
+};
 
 class Observer 
 {
@@ -38,45 +96,174 @@ public:
 };
 
 
+// Receives only the typed events it subscribed to, with no string
+// comparison on the way.
+class EventObserver
+{
+public:
+	virtual ~EventObserver(){}
+	virtual void onEvent(Observable* from, const CameraEvent& e) = 0;
+};
+
+
+// Observers are kept in an immutable list that is replaced as a whole
+// when one is added or deleted, so notifying takes no lock and may run on
+// several threads while observers change. An observer deleted during a
+// notification can still receive that one event.
 class Observable 
 {
 private:
-	std::vector<Observer*> _observers;
+	struct Subscription
+	{
+		Observer*		observer;
+		EventFilter		filter;
+	};
+
+	struct EventSubscription
+	{
+		EventObserver*	observer;
+		EventFilter		filter;
+	};
+
+	struct ObserverList
+	{
+		std::vector<Subscription>		observers;
+		std::vector<EventSubscription>	eventObservers;
+	};
+	typedef std::shared_ptr<const ObserverList> ObserverListRef;
+
+	// Never NULL; read and replaced with std::atomic_load/atomic_store
+	ObserverListRef _list;
+	// Serializes the writers only
+	std::mutex _writeMutex;
+
+	Observable(const Observable&);
+	Observable& operator=(const Observable&);
+
+	ObserverListRef snapshot() const { return std::atomic_load(&_list); }
 
 public:
-	Observable(){}
+	Observable() : _list(std::make_shared<ObserverList>()) {}
 	virtual ~Observable(){deleteObservers();}
 
-	// Addition of Observer
-	void addObserver(Observer* ob)
+	// Addition of Observer, for the events filter accepts. Adding it again
+	// replaces its filter.
+	void addObserver(Observer* ob, const EventFilter& filter = EventFilter())
 	{
-		if ( std::find(_observers.begin(), _observers.end(), ob) == _observers.end() )
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		std::shared_ptr<ObserverList> next = std::make_shared<ObserverList>(*snapshot());
+		for(std::vector<Subscription>::iterator i = next->observers.begin(); i != next->observers.end(); ++i)
 		{
-			_observers.push_back(ob);
+			if(i->observer == ob)
+			{
+				i->filter = filter;
+				std::atomic_store(&_list, ObserverListRef(next));
+				return;
+			}
 		}
+		Subscription subscription = { ob, filter };
+		next->observers.push_back(subscription);
+		std::atomic_store(&_list, ObserverListRef(next));
 	}
 
 	// Deletion of Observer
 	void deleteObserver(const Observer* ob)
 	{
-		std::vector<Observer*>::iterator i = std::find(_observers.begin(), _observers.end(), ob);
-		if ( i != _observers.end() ) 
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		ObserverListRef current = snapshot();
+		for(size_t n = 0; n < current->observers.size(); n++)
+		{
+			if(current->observers[n].observer == ob)
+			{
+				std::shared_ptr<ObserverList> next = std::make_shared<ObserverList>(*current);
+				next->observers.erase(next->observers.begin() + n);
+				std::atomic_store(&_list, ObserverListRef(next));
+				return;
+			}
+		}
+	}
+
+	// Addition of typed Observer, for the events in mask (cameraEventMask bits)
+	void addEventObserver(EventObserver* ob, EdsUInt32 mask = kCameraEventMask_All)
+	{
+		addEventObserver(ob, EventFilter(mask));
+	}
+
+	void addEventObserver(EventObserver* ob, const EventFilter& filter)
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		std::shared_ptr<ObserverList> next = std::make_shared<ObserverList>(*snapshot());
+		for(std::vector<EventSubscription>::iterator i = next->eventObservers.begin(); i != next->eventObservers.end(); ++i)
+		{
+			if(i->observer == ob)
+			{
+				i->filter = filter;
+				std::atomic_store(&_list, ObserverListRef(next));
+				return;
+			}
+		}
+		EventSubscription subscription = { ob, filter };
+		next->eventObservers.push_back(subscription);
+		std::atomic_store(&_list, ObserverListRef(next));
+	}
+
+	// Deletion of typed Observer
+	void deleteEventObserver(const EventObserver* ob)
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		ObserverListRef current = snapshot();
+		for(size_t n = 0; n < current->eventObservers.size(); n++)
 		{
-			_observers.erase(i);
+			if(current->eventObservers[n].observer == ob)
+			{
+				std::shared_ptr<ObserverList> next = std::make_shared<ObserverList>(*current);
+				next->eventObservers.erase(next->eventObservers.begin() + n);
+				std::atomic_store(&_list, ObserverListRef(next));
+				return;
+			}
 		}
 	}
 
 	// It notifies Observer
 	void notifyObservers(CameraEvent *e = NULL)
 	{
-		std::vector<Observer*>::reverse_iterator i = _observers.rbegin();
-		while ( i != _observers.rend() )
+		TraceScope trace("Observer", (e == NULL) ? "Notify" : (e->getID() == kCameraEvent_Custom) ? "Custom" : CameraEvent::nameOf(e->getID()).c_str());
+
+		// The list as it was when the notification started
+		ObserverListRef list = snapshot();
+
+		std::vector<Subscription>::const_reverse_iterator i = list->observers.rbegin();
+		while ( i != list->observers.rend() )
+		{
+			// Without an event there is nothing to filter on
+			if(e == NULL || i->filter.accepts(*e))
+			{
+				i->observer->update(this, e);
+			}
+			++i;
+		}
+
+		if(e != NULL)
 		{
-			(*i++)->update(this, e);
+			for(size_t n = 0; n < list->eventObservers.size(); n++)
+			{
+				if(list->eventObservers[n].filter.accepts(*e))
+				{
+					list->eventObservers[n].observer->onEvent(this, *e);
+				}
+			}
 		}
 	}
 
-	void deleteObservers(){ _observers.clear(); }
-	int countObservers() const{ return (int)_observers.size(); }
+	void deleteObservers()
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		std::atomic_store(&_list, ObserverListRef(std::make_shared<ObserverList>()));
+	}
+	int countObservers() const
+	{
+		ObserverListRef list = snapshot();
+		return (int)(list->observers.size() + list->eventObservers.size());
+	}
 
-};
\ No newline at end of file
+};
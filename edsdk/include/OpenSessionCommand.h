@@ -21,6 +21,8 @@
 #include "EDSDK.h"
 #include "GetPropertyCommand.h"
 #include "GetPropertyDescCommand.h"
+#include "PropertyDescCache.h"
+#include "SaveSettingCommand.h"
 
 class OpenSessionCommand : public Command
 {
@@ -29,50 +31,43 @@ public:
 	OpenSessionCommand(CameraModel *model) : Command(model){}
 
 
+	virtual const char* getName() const {return "OpenSession";}
+
 	// Execute command	
 	virtual bool execute()
 	{
 		EdsError err = EDS_ERR_OK;
-		bool	 locked = false;
 	
 		//The communication with the camera begins
-		err = EdsOpenSession(_model->getCameraObject());
-	
-
-		//Preservation ahead is set to PC
-		if(err == EDS_ERR_OK)
+		_model->getPropertyInfoCache().clear();
 		{
-			EdsUInt32 saveTo = kEdsSaveTo_Host;
-			err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_SaveTo, 0, sizeof(saveTo) , &saveTo);
+			TraceScope trace("EDSDK", "EdsOpenSession");
+			err = EdsOpenSession(_model->getCameraObject());
+			trace.setArg("error", err);
 		}
-
-		//UI lock
 		if(err == EDS_ERR_OK)
 		{
-			err = EdsSendStatusCommand(_model->getCameraObject(), kEdsCameraStatusCommand_UILock, 0);
+			_model->noteSessionOpened();
 		}
+	
 
+		//Preservation ahead, with the host's capacity when it is the PC
 		if(err == EDS_ERR_OK)
 		{
-			locked = true;
+			err = SaveSettingCommand::apply(_model, _model->getSaveTo());
 		}
-		
+
+		// Descs seen before with this body and mode are there at once
 		if(err == EDS_ERR_OK)
 		{
-			EdsCapacity capacity = {0x7FFFFFFF, 0x1000, 1};
-			err = EdsSetCapacity( _model->getCameraObject(), capacity);
+			PropertyDescCache::instance().preload(_model);
 		}
-		
-		//It releases it when locked
-		if(locked)
-		{
-			EdsSendStatusCommand(_model->getCameraObject(), kEdsCameraStatusCommand_UIUnLock, 0);
-		}	
 
 		//Notification of error
 		if(err != EDS_ERR_OK)
 		{
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
@@ -18,9 +18,47 @@
 
 
 #include <deque>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+#include <chrono>
 #include "Thread.h"
 #include "Synchronized.h"
 #include "Command.h"
+#include "Metrics.h"
+#include "RetryPolicy.h"
+
+
+// Time from enqueue() until the worker starts executing a command, in microseconds
+typedef struct _DISPATCH_LATENCY 
+{
+	EdsUInt64		count;
+	EdsUInt64		lastMicros;
+	EdsUInt64		averageMicros;
+	EdsUInt64		maxMicros;
+}DISPATCH_LATENCY;
+
+
+// Command parked until its retry time
+typedef struct _RETRY_ENTRY 
+{
+	std::chrono::steady_clock::time_point	due;
+	EdsUInt64								sequence;
+	CommandPriority							priority;
+	Command*								command;
+}RETRY_ENTRY;
+
+// Orders the retry heap so that the earliest due entry is on top
+struct RetryEntryLater
+{
+	bool operator()(const RETRY_ENTRY& a, const RETRY_ENTRY& b) const
+	{
+		if(a.due != b.due)return a.due > b.due;
+		return a.sequence > b.sequence;
+	}
+};
+
 
 class Processor : public Thread 
 {
@@ -28,19 +66,56 @@ class Processor : public Thread
 protected:
     // Whether it is executing it or not?
 	bool _running;
-	// Que
-	std::deque<Command*>  _queue;
+	// Commands are held in the que, not executed, while set
+	bool _paused;
+	// Que for each priority lane
+	std::deque<Command*>  _queue[kCommandPriority_Count];
+
+	// Times a waiting lane was passed over for a higher one
+	int			_skipCount[kCommandPriority_Count];
+
+	// A waiting lane is served once it has been passed over this many times
+	int			_starvationLimit;
 
 	// Command when ending
 	Command*	_closeCommand;
+
+	// Lane of the command being executed
+	CommandPriority	_currentPriority;
 		
 	// Synchronized Object
     Synchronized _syncObject;
 
+	// Commands waiting for their retry time
+	std::priority_queue<RETRY_ENTRY, std::vector<RETRY_ENTRY>, RetryEntryLater> _retryQueue;
+	EdsUInt64	_retrySequence;
+
+	// How long a failed command waits before it is reissued, and when it is given up
+	RetryPolicyTable	_retryPolicies;
+
+	// Coalesce keys of the commands waiting in the que, with their handles
+	std::map<EdsUInt64, CommandHandleRef>	_pendingKeys;
+
+	// Number of commands merged into one already pending
+	EdsUInt64	_coalescedCount;
+
+	// Dispatch latency accumulators
+	EdsUInt64	_dispatchCount;
+	EdsUInt64	_dispatchTotalMicros;
+	EdsUInt64	_dispatchLastMicros;
+	EdsUInt64	_dispatchMaxMicros;
+
+	// Per command type counters and latencies
+	CommandMetrics	_metrics;
+
 
 public:
 	// Constructor  
-	Processor(): _running(false), _closeCommand(0){ }	
+	Processor(): _running(false), _paused(false), _starvationLimit(8), _closeCommand(0), _currentPriority(kCommandPriority_Normal), _retrySequence(0), _coalescedCount(0),
+		_dispatchCount(0), _dispatchTotalMicros(0), _dispatchLastMicros(0), _dispatchMaxMicros(0)
+	{
+		memset(_skipCount, 0, sizeof(_skipCount));
+	}	
 
 	// Destoracta
 	virtual ~Processor(){clear();}
@@ -48,6 +123,30 @@ public:
 	// Set command when ending
 	void setCloseCommand(Command* closeCommand){_closeCommand = closeCommand;}
 
+	// Fixed interval before a command the camera was busy for, or that failed
+	// otherwise, is reissued. The policies give finer control.
+	void setRetryInterval(int millisec)
+	{
+		EdsUInt32 interval = (millisec < 0) ? 0 : (EdsUInt32)millisec;
+		RETRY_POLICY busy = _retryPolicies.getDefault(kRetryError_Busy);
+		busy.initialDelayMillis = busy.maxDelayMillis = interval;
+		_retryPolicies.setDefault(kRetryError_Busy, busy);
+
+		RETRY_POLICY other = _retryPolicies.getDefault(kRetryError_Other);
+		other.initialDelayMillis = interval;
+		if(other.maxDelayMillis < interval)other.maxDelayMillis = interval;
+		_retryPolicies.setDefault(kRetryError_Other, other);
+	}
+	int getRetryInterval() const {return (int)_retryPolicies.getDefault(kRetryError_Busy).initialDelayMillis;}
+
+	// Retry policies by error class and command name
+	RetryPolicyTable& getRetryPolicies(){return _retryPolicies;}
+
+	// Set how many times a waiting lane may be passed over before it is served.
+	// 0 means strict priority.
+	void setStarvationLimit(int limit){_starvationLimit = limit;}
+	int getStarvationLimit() const {return _starvationLimit;}
+
 
 	/*
 	void enqueue(Command* command)
@@ -59,12 +158,65 @@ public:
 	}*/
 
 	
-	void enqueue(Command* command)
+	// The handle tells when the command is done and how it went
+	CommandHandleRef enqueue(Command* command)
+	{
+		return enqueue(command, command->getPriority());
+	}
+
+	CommandHandleRef enqueue(Command* command, CommandPriority priority)
 	{
 		_syncObject.lock();
-		_queue.push_back(command);
+
+		// The same refresh is already waiting, its run stands for this one
+		EdsUInt64 key = coalesceKey(command);
+		if(key != 0)
+		{
+			std::map<EdsUInt64, CommandHandleRef>::iterator pending = _pendingKeys.find(key);
+			if(pending != _pendingKeys.end())
+			{
+				CommandHandleRef handle = pending->second;
+				_coalescedCount++;
+				_syncObject.unlock();
+				delete command;
+				return handle;
+			}
+		}
+
+		CommandHandleRef handle = command->getHandle();
+		if(key != 0)
+		{
+			_pendingKeys[key] = handle;
+		}
+
+		command->setEnqueueTime(std::chrono::steady_clock::now());
+		_queue[priority].push_back(command);
 		_syncObject.notify();	
 		_syncObject.unlock();
+
+		return handle;
+	}
+
+	// Park a command until due, e.g. the release of a bulb exposure, so the
+	// worker keeps running others meanwhile. It then goes to the front of
+	// its lane like a due retry; the wait is kept to the millisecond.
+	CommandHandleRef enqueueAt(Command* command, std::chrono::steady_clock::time_point due)
+	{
+		_syncObject.lock();
+
+		CommandHandleRef handle = command->getHandle();
+
+		RETRY_ENTRY entry;
+		entry.due = due;
+		entry.sequence = _retrySequence++;
+		entry.priority = command->getPriority();
+		entry.command = command;
+		_retryQueue.push(entry);
+
+		_syncObject.notify();
+		_syncObject.unlock();
+
+		return handle;
 	}
 
 
@@ -73,22 +225,164 @@ public:
 	{
 		_syncObject.lock();
 		_running = false;
+		// Wake up the worker so that it sees the stop request
+		_syncObject.notify();
 		_syncObject.unlock();
 		//resume();
 	}  
 
 
+	// Hold the commands in the que, and those queued from now on, until
+	// resume(). The command executing now still finishes.
+	void pause()
+	{
+		_syncObject.lock();
+		_paused = true;
+		_syncObject.unlock();
+	}
+
+	void resume()
+	{
+		_syncObject.lock();
+		_paused = false;
+		_syncObject.notify();
+		_syncObject.unlock();
+	}
+
+	bool isPaused()
+	{
+		_syncObject.lock();
+		bool paused = _paused;
+		_syncObject.unlock();
+		return paused;
+	}
+
+
+	DISPATCH_LATENCY getDispatchLatency()
+	{
+		DISPATCH_LATENCY latency = {};
+
+		_syncObject.lock();
+		latency.count = _dispatchCount;
+		latency.lastMicros = _dispatchLastMicros;
+		latency.maxMicros = _dispatchMaxMicros;
+		if(_dispatchCount != 0)
+		{
+			latency.averageMicros = _dispatchTotalMicros / _dispatchCount;
+		}
+		_syncObject.unlock();
+
+		return latency;
+	}
+
+
+	// Lock-free, safe to poll from any thread
+	const CommandMetrics& getMetrics() const {return _metrics;}
+
+	// Thread name in exported traces
+	virtual const char* getThreadName() const {return "Processor";}
+
+	// Number of commands waiting in a lane
+	int getQueueDepth(CommandPriority priority)
+	{
+		_syncObject.lock();
+		int depth = (int)_queue[priority].size();
+		_syncObject.unlock();
+
+		return depth;
+	}
+
+	// Number of commands merged into one already pending
+	EdsUInt64 getCoalescedCount()
+	{
+		_syncObject.lock();
+		EdsUInt64 count = _coalescedCount;
+		_syncObject.unlock();
+
+		return count;
+	}
+
+	// Number of commands parked for retry
+	int getRetryDepth()
+	{
+		_syncObject.lock();
+		int depth = (int)_retryQueue.size();
+		_syncObject.unlock();
+
+		return depth;
+	}
+
+
+	// Drop the waiting commands of one camera, e.g. when it closes while
+	// sharing this processor with other cameras
+	void purge(CameraModel* model)
+	{
+		_syncObject.lock();
+
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
+		{
+			std::deque<Command*>::iterator it = _queue[lane].begin();
+			while (it != _queue[lane].end())
+			{
+				if((*it)->getCameraModel() == model)
+				{
+					_pendingKeys.erase(coalesceKey(*it));
+					delete (*it);
+					it = _queue[lane].erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		std::vector<RETRY_ENTRY> kept;
+		while (!_retryQueue.empty())
+		{
+			RETRY_ENTRY entry = _retryQueue.top();
+			_retryQueue.pop();
+			if(entry.command->getCameraModel() == model)
+			{
+				_pendingKeys.erase(coalesceKey(entry.command));
+				delete entry.command;
+			}
+			else
+			{
+				kept.push_back(entry);
+			}
+		}
+		for(std::vector<RETRY_ENTRY>::iterator it = kept.begin(); it != kept.end(); ++it)
+		{
+			_retryQueue.push(*it);
+		}
+
+		_syncObject.unlock();
+	}
+
+
 	void clear() 
 	{
 		_syncObject.lock();
 
-		std::deque<Command*>::iterator it = _queue.begin();
-		while (it != _queue.end())
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
 		{
-			delete (*it);
-			++it;
+			std::deque<Command*>::iterator it = _queue[lane].begin();
+			while (it != _queue[lane].end())
+			{
+				delete (*it);
+				++it;
+			}
+			_queue[lane].clear();
 		}
-		_queue.clear();
+
+		while (!_retryQueue.empty())
+		{
+			delete _retryQueue.top().command;
+			_retryQueue.pop();
+		}
+
+		_pendingKeys.clear();
 
 		_syncObject.unlock();
 	}
@@ -99,29 +393,53 @@ public:
 	{
 		//When using the SDK from another thread in Windows, 
 		// you must initialize the COM library by calling CoInitialize 
+#ifdef _WIN32
 		CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+		std::string name = getName();
+		Tracer::instance().setThreadName(name.empty() ? getThreadName() : Tracer::instance().intern(name));
 
 		_running = true;
 		while (_running)
 		{
-			Sleep(1);
-
 			Command* command = take();
 			if(command != NULL)
 			{
-				bool complete = command->execute();
+				CommandPriority priority = _currentPriority;
+				std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+				command->beginExecute();
+				bool complete;
+				{
+					TraceScope trace("Command", command->getName());
+					complete = command->execute();
+					trace.setArg("error", command->getError());
+				}
+				std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - started;
+				_metrics.recordExecution(command->getName(), complete, command->getError(),
+					(EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+				commandExecuted(command, complete, elapsed);
 				
-				if(complete == false)
+				int delay = complete ? 0 : retryDelay(command);
+				if(complete == false && delay >= 0)
 				{
 					//If commands that were issued fail ( because of DeviceBusy or other reasons )
 					// and retry is required , note that some cameras may become unstable if multiple 
 					// commands are issued in succession without an intervening interval.
-					//Thus, leave an interval of about 500 ms before commands are reissued.
-					Sleep(500);
-					enqueue(command);
+					//Thus, leave the interval of its retry policy before commands are reissued.
+					// The command is parked until then while other commands keep running.
+					command->retrying();
+					scheduleRetry(command, priority, delay);
+				}
+				else if(complete == false)
+				{
+					// Out of attempts or past its deadline
+					abandon(command);
+					command->complete(true);
+					delete command;
 				}
 				else
 				{
+					command->complete(true);
 					delete command;
 				}
 			}
@@ -138,12 +456,17 @@ public:
 			_closeCommand = NULL;
 		}
 
+#ifdef _WIN32
 		CoUninitialize();
+#endif
 
 	}
 
 protected:
 
+	// Called on the worker after each execute(), before a retry is scheduled
+	virtual void commandExecuted(Command*, bool, std::chrono::steady_clock::duration) {}
+
 	//The command is taken out of the que
 
 	/*
@@ -180,7 +503,7 @@ protected:
 	}*/
 
 	
- 	Command* take()
+ 	virtual Command* take()
 	{
 	
 		Command* command = NULL;
@@ -188,27 +511,202 @@ protected:
 		_syncObject.lock();
 
 		// Que stands by between emptiness.
-		while (_queue.empty() && _running)
+		// enqueue() and stop() notify, so the wait only times out for the next retry.
+		int lane = -1;
+		while (_running)
 		{
-			_syncObject.wait(10);
+			if(!_paused)
+			{
+				promoteDueRetries();
+
+				lane = selectLane();
+				if(lane >= 0)break;
+			}
+
+			_syncObject.wait(_paused ? -1 : millisUntilNextRetry());
 		}
 	
-		if (_running)
+		if (_running && lane >= 0)
 		{
-			command = _queue.front();
-			_queue.pop_front();
+			command = _queue[lane].front();
+			_queue[lane].pop_front();
+			_currentPriority = (CommandPriority)lane;
+
+			// From here on a new refresh must be queued again, it may see a newer value
+			_pendingKeys.erase(coalesceKey(command));
+			recordDispatch(command);
 		}
 
 		_syncObject.unlock();
 
 		return command;
 	}
+
+	// Pick the highest non-empty lane, unless a lower one has waited too long.
+	// Called with the lock held
+	int selectLane()
+	{
+		int selected = -1;
+
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
+		{
+			if(_queue[lane].empty())continue;
+
+			if(selected < 0)
+			{
+				selected = lane;
+			}
+			else if(_starvationLimit > 0 && _skipCount[lane] >= _starvationLimit)
+			{
+				selected = lane;
+				break;
+			}
+		}
+
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
+		{
+			if(lane == selected)
+			{
+				_skipCount[lane] = 0;
+			}
+			else if(!_queue[lane].empty() && lane > selected)
+			{
+				_skipCount[lane]++;
+			}
+		}
+
+		return selected;
+	}
+
+	// Wait before reissuing a command that asked for a retry, -1 to give it up
+	int retryDelay(Command* command)
+	{
+		RETRY_POLICY policy = _retryPolicies.getPolicy(command->getName(), RetryPolicyTable::classOf(command->getError()));
+
+		EdsUInt32 executions = command->getExecutions();
+		if(policy.maxAttempts != 0 && executions >= policy.maxAttempts)
+		{
+			return -1;
+		}
+
+		EdsUInt32 delay = _retryPolicies.delayMillis(policy, executions);
+		if(policy.deadlineMillis != 0)
+		{
+			std::chrono::steady_clock::time_point due = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+			if(due - command->getFirstExecuteTime() > std::chrono::milliseconds(policy.deadlineMillis))
+			{
+				return -1;
+			}
+		}
+		return (int)delay;
+	}
+
+	// The command completes with the error of its last execute()
+	void abandon(Command* command)
+	{
+		_metrics.recordAbandoned(command->getName());
+
+		CameraModel* model = command->getCameraModel();
+		if(model != NULL)
+		{
+			EdsError err = command->getError();
+			CameraEvent e(kCameraEvent_Error, &err);
+			model->notifyObservers(&e);
+		}
+	}
+
+	// Park a failed command until its retry delay has passed
+	void scheduleRetry(Command* command, CommandPriority priority, int delayMillis)
+	{
+		_syncObject.lock();
+
+		RETRY_ENTRY entry;
+		entry.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMillis);
+		entry.sequence = _retrySequence++;
+		entry.priority = priority;
+		entry.command = command;
+		_retryQueue.push(entry);
+
+		// A parked refresh still counts as pending
+		EdsUInt64 key = coalesceKey(command);
+		if(key != 0)
+		{
+			_pendingKeys[key] = command->getHandle();
+		}
+
+		_syncObject.notify();
+		_syncObject.unlock();
+	}
+
+	// Move retries that are due to the front of the que, keeping their order.
+	// Called with the lock held
+	void promoteDueRetries()
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		std::vector<RETRY_ENTRY> due;
+
+		while (!_retryQueue.empty() && _retryQueue.top().due <= now)
+		{
+			due.push_back(_retryQueue.top());
+			_retryQueue.pop();
+		}
+
+		// Push in reverse so that the earliest retry ends up first in its lane
+		std::vector<RETRY_ENTRY>::reverse_iterator it = due.rbegin();
+		while (it != due.rend())
+		{
+			// Dispatch latency of a retry counts from its due time
+			it->command->setEnqueueTime(it->due);
+			_queue[it->priority].push_front(it->command);
+			++it;
+		}
+	}
+
+	// Called with the lock held
+	int millisUntilNextRetry() const
+	{
+		if(_retryQueue.empty())
+		{
+			return -1;
+		}
+
+		std::chrono::steady_clock::duration wait = _retryQueue.top().due - std::chrono::steady_clock::now();
+		EdsInt64 millis = std::chrono::duration_cast<std::chrono::milliseconds>(wait).count() + 1;
+		return (millis < 1) ? 1 : (int)millis;
+	}
+
+	// A command someone waits on keeps its own run
+	static EdsUInt64 coalesceKey(const Command* command)
+	{
+		return command->hasCompletion() ? 0 : command->getCoalesceKey();
+	}
+
+	// Called with the lock held
+	void recordDispatch(Command* command)
+	{
+		EdsUInt64 micros = (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - command->getEnqueueTime()).count();
+
+		_metrics.recordDispatch(micros);
+
+		_dispatchCount++;
+		_dispatchTotalMicros += micros;
+		_dispatchLastMicros = micros;
+		if(micros > _dispatchMaxMicros)
+		{
+			_dispatchMaxMicros = micros;
+		}
+	}
  
 
 	bool isEmpty()
 	{
 		_syncObject.lock();
-		bool ret = _queue.empty();
+		bool ret = _retryQueue.empty();
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
+		{
+			ret = ret && _queue[lane].empty();
+		}
 		_syncObject.unlock();
 		
 		return ret;
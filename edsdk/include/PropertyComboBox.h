@@ -15,7 +15,7 @@
 
 #pragma once
 
-#include <map>
+#include "PropertyLabels.h"
 // CPropertyComboBox
 
 class CPropertyComboBox : public CComboBox
@@ -31,7 +31,8 @@ protected:
 
 	DECLARE_MESSAGE_MAP()
 
-	std::map<EdsUInt32, const char *> _propertyTable;
+	// Display names of the values, NULL for none
+	const PROPERTY_LABEL_TABLE* _propertyTable;
 
 	void updateProperty(EdsUInt32 value);
 	void updatePropertyDesc(const EdsPropertyDesc* desc);
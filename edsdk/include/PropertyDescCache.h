@@ -0,0 +1,392 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : PropertyDescCache.h                                             *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+
+#include "EDSDK.h"
+#include "CameraEvent.h"
+#include "CameraModel.h"
+#include "GetPropertyCommand.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include "XxHash64.h"
+
+
+// What a desc list depends on: the body and its firmware, the lens (for
+// Av) and the AE mode
+typedef struct _PROPERTY_DESC_KEY
+{
+	EdsChar		productName[EDS_MAX_NAME];
+	EdsChar		firmwareVersion[EDS_MAX_NAME];
+	EdsChar		lensName[EDS_MAX_NAME];
+	EdsUInt32	aeMode;
+}PROPERTY_DESC_KEY;
+
+typedef struct _PROPERTY_DESC_CACHE_STATISTICS
+{
+	EdsUInt32	capacity;			// records the file holds
+	EdsUInt32	records;			// in use
+	EdsUInt64	hits;				// descs served without EdsGetPropertyDesc
+	EdsUInt64	verified;			// read from the camera to check a cached one
+	EdsUInt64	changed;			// of those, different from the cache
+	EdsUInt64	misses;
+	EdsUInt64	preloaded;			// descs put into models at connect
+}PROPERTY_DESC_CACHE_STATISTICS;
+
+
+// Desc lists kept on disk across runs, by model, firmware, lens and AE
+// mode. OpenSessionCommand fills a new session's model from it at once;
+// GetPropertyDescCommand then answers from it without the camera while a
+// record was read back from a camera within the verify interval, and
+// otherwise reads the camera, in the background lane, to check it.
+//
+// The file is a fixed table of records mapped into memory, open
+// addressed by a hash of the key. One process writes it at a time; a
+// file of another layout is started over.
+class PropertyDescCache
+{
+public:
+	enum { kDefaultCapacity = 2048, kDefaultVerifySeconds = 24 * 60 * 60, kMaxProbes = 16 };
+
+private:
+	enum { kMagic = 0x43534450, kVersion = 1 };		// "PDSC"
+
+	typedef struct _HEADER
+	{
+		EdsUInt32	magic;
+		EdsUInt32	version;
+		EdsUInt32	capacity;
+		EdsUInt32	recordSize;
+		EdsUInt32	records;
+		EdsUInt32	reserved[11];
+	}HEADER;
+
+	typedef struct _RECORD
+	{
+		EdsUInt64			hash;			// 0 while free
+		PROPERTY_DESC_KEY	key;
+		EdsPropertyID		propertyID;
+		EdsUInt32			reserved;
+		EdsUInt64			verifiedTime;	// time(), last read back from a camera
+		EdsPropertyDesc		desc;
+	}RECORD;
+
+	std::mutex		_mutex;
+	MappedFile		_file;
+	std::string		_path;
+	EdsUInt64		_verifySeconds;
+
+	EdsUInt64		_hits;
+	EdsUInt64		_verified;
+	EdsUInt64		_changed;
+	EdsUInt64		_misses;
+	EdsUInt64		_preloaded;
+
+	PropertyDescCache(const PropertyDescCache&);
+	PropertyDescCache& operator=(const PropertyDescCache&);
+
+	PropertyDescCache() : _verifySeconds(kDefaultVerifySeconds), _hits(0), _verified(0), _changed(0), _misses(0), _preloaded(0) {}
+
+	HEADER* header() const		{ return (HEADER*)_file.getData(); }
+	RECORD* records() const		{ return (RECORD*)(_file.getData() + sizeof(HEADER)); }
+
+	static EdsUInt64 hashOf(const PROPERTY_DESC_KEY& key, EdsPropertyID propertyID)
+	{
+		XxHash64 hasher(propertyID);
+		hasher.update(&key, sizeof(key));
+		EdsUInt64 hash = hasher.digest();
+		return (hash != 0) ? hash : 1;
+	}
+
+	static bool sameKey(const RECORD& record, const PROPERTY_DESC_KEY& key, EdsPropertyID propertyID)
+	{
+		return record.propertyID == propertyID && memcmp(&record.key, &key, sizeof(key)) == 0;
+	}
+
+	static bool sameDesc(const EdsPropertyDesc& a, const EdsPropertyDesc& b)
+	{
+		return a.form == b.form && a.access == b.access && a.numElements == b.numElements &&
+			a.numElements >= 0 && a.numElements <= 128 && memcmp(a.propDesc, b.propDesc, sizeof(a.propDesc[0]) * (size_t)a.numElements) == 0;
+	}
+
+	// Mutex held. The record of the key, or with add the free slot for
+	// it; NULL when neither is within kMaxProbes.
+	RECORD* find(const PROPERTY_DESC_KEY& key, EdsPropertyID propertyID, bool add)
+	{
+		if(!_file.isOpen())
+		{
+			return NULL;
+		}
+		EdsUInt32 capacity = header()->capacity;
+		EdsUInt64 hash = hashOf(key, propertyID);
+		for(EdsUInt32 probe = 0; probe < kMaxProbes && probe < capacity; probe++)
+		{
+			RECORD* record = &records()[(hash + probe) % capacity];
+			if(record->hash == hash && sameKey(*record, key, propertyID))
+			{
+				return record;
+			}
+			if(record->hash == 0)
+			{
+				return add ? record : NULL;
+			}
+		}
+		return NULL;
+	}
+
+	static void readString(const CameraModel* model, EdsPropertyID propertyID, EdsChar* out)
+	{
+		PROPERTY_VALUE value;
+		memset(out, 0, EDS_MAX_NAME);
+		if(model->getPropertyStore().getValue(propertyID, value) && value.dataType == kEdsDataType_String)
+		{
+			strncpy(out, (const EdsChar*)value.data, EDS_MAX_NAME - 1);
+		}
+	}
+
+public:
+	static PropertyDescCache& instance()
+	{
+		static PropertyDescCache* cache = new PropertyDescCache();
+		return *cache;
+	}
+
+	// Opens the cache at path, or starts it there with room for capacity records
+	EdsError open(const std::string& path, EdsUInt32 capacity = kDefaultCapacity)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_file.close();
+		_path.clear();
+
+		EdsError err = _file.open(path.c_str(), true);
+		if(err == EDS_ERR_OK)
+		{
+			const HEADER* h = header();
+			if(_file.getSize() < sizeof(HEADER) || h->magic != kMagic || h->version != kVersion || h->recordSize != sizeof(RECORD) ||
+			   h->capacity == 0 || _file.getSize() < sizeof(HEADER) + (EdsUInt64)h->capacity * sizeof(RECORD))
+			{
+				_file.close();
+				err = EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+			}
+		}
+
+		if(err != EDS_ERR_OK)
+		{
+			if(capacity == 0)
+			{
+				return EDS_ERR_INVALID_PARAMETER;
+			}
+			err = _file.create(path.c_str(), sizeof(HEADER) + (EdsUInt64)capacity * sizeof(RECORD));
+			if(err != EDS_ERR_OK)
+			{
+				return err;
+			}
+			HEADER* h = header();
+			h->magic = kMagic;
+			h->version = kVersion;
+			h->capacity = capacity;
+			h->recordSize = sizeof(RECORD);
+			h->records = 0;
+		}
+		_path = path;
+		return EDS_ERR_OK;
+	}
+
+	// Writes it back and stops using it
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_file.flush();
+		_file.close();
+		_path.clear();
+	}
+
+	bool isOpen()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _file.isOpen();
+	}
+
+	std::string getPath()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _path;
+	}
+
+	// Cached descs newer than this are trusted; 0 checks each against the camera
+	void setVerifyInterval(EdsUInt64 seconds)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_verifySeconds = seconds;
+	}
+	EdsUInt64 getVerifyInterval()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _verifySeconds;
+	}
+
+	// Drops every record, keeping the file
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_file.isOpen())
+		{
+			memset(records(), 0, (size_t)header()->capacity * sizeof(RECORD));
+			header()->records = 0;
+		}
+	}
+
+	// The key of what the model holds now; false without a product name
+	static bool makeKey(const CameraModel* model, PROPERTY_DESC_KEY& key)
+	{
+		memset(&key, 0, sizeof(key));
+		readString(model, kEdsPropID_ProductName, key.productName);
+		readString(model, kEdsPropID_FirmwareVersion, key.firmwareVersion);
+		readString(model, kEdsPropID_LensName, key.lensName);
+		key.aeMode = model->getPropertyStore().getUInt32(kEdsPropID_AEModeSelect, 0xffffffff);
+		return key.productName[0] != '\0';
+	}
+
+	// A fresh record is within the verify interval
+	bool lookup(const PROPERTY_DESC_KEY& key, EdsPropertyID propertyID, EdsPropertyDesc& desc, bool& fresh)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		RECORD* record = find(key, propertyID, false);
+		if(record == NULL)
+		{
+			return false;
+		}
+		desc = record->desc;
+		EdsUInt64 now = (EdsUInt64)time(NULL);
+		fresh = _verifySeconds != 0 && record->verifiedTime + _verifySeconds > now;
+		return true;
+	}
+
+	// A desc just read from the camera
+	void store(const PROPERTY_DESC_KEY& key, EdsPropertyID propertyID, const EdsPropertyDesc& desc)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		RECORD* record = find(key, propertyID, true);
+		if(record == NULL)
+		{
+			return;
+		}
+		if(record->hash == 0)
+		{
+			record->key = key;
+			record->propertyID = propertyID;
+			record->reserved = 0;
+			record->desc = desc;
+			header()->records++;
+			// Readers go by the hash, so it is set last
+			record->hash = hashOf(key, propertyID);
+			_misses++;
+		}
+		else
+		{
+			_verified++;
+			if(!sameDesc(record->desc, desc))
+			{
+				record->desc = desc;
+				_changed++;
+			}
+		}
+		record->verifiedTime = (EdsUInt64)time(NULL);
+	}
+
+	void noteHit()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_hits++;
+	}
+
+	// On the processor thread once the session is open: reads what the key
+	// needs and puts every desc cached for it into the model. Returns how
+	// many; stale ones are checked as their GetPropertyDescCommand runs.
+	EdsUInt32 preload(CameraModel* model)
+	{
+		if(!isOpen())
+		{
+			return 0;
+		}
+
+		TraceScope trace("Cache", "PreloadPropertyDescs");
+		const EdsPropertyID keyProperties[] = { kEdsPropID_ProductName, kEdsPropID_FirmwareVersion, kEdsPropID_LensName, kEdsPropID_AEModeSelect };
+		for(size_t i = 0; i < sizeof(keyProperties) / sizeof(keyProperties[0]); i++)
+		{
+			if(model->getPropertyStore().getVersion(keyProperties[i]) == 0)
+			{
+				// No lens reports no name; the key goes without it
+				GetPropertyCommand::readProperty(model, keyProperties[i]);
+			}
+		}
+
+		PROPERTY_DESC_KEY key;
+		if(!makeKey(model, key))
+		{
+			return 0;
+		}
+
+		const EdsPropertyID descProperties[] = {
+			kEdsPropID_AEModeSelect, kEdsPropID_Tv, kEdsPropID_Av, kEdsPropID_ISOSpeed, kEdsPropID_MeteringMode,
+			kEdsPropID_ExposureCompensation, kEdsPropID_ImageQuality, kEdsPropID_Evf_AFMode,
+		};
+		EdsUInt32 count = 0;
+		for(size_t i = 0; i < sizeof(descProperties) / sizeof(descProperties[0]); i++)
+		{
+			EdsPropertyDesc desc;
+			bool fresh = false;
+			if(lookup(key, descProperties[i], desc, fresh) && model->getPropertyStore().getDescVersion(descProperties[i]) == 0)
+			{
+				EdsPropertyID propertyID = descProperties[i];
+				model->setPropertyDesc(propertyID, &desc);
+				CameraEvent e(kCameraEvent_PropertyDescChanged, &propertyID);
+				model->notifyObservers(&e);
+				count++;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_preloaded += count;
+		}
+		trace.setArg("count", count);
+		return count;
+	}
+
+	PROPERTY_DESC_CACHE_STATISTICS getStatistics()
+	{
+		PROPERTY_DESC_CACHE_STATISTICS stats;
+		std::lock_guard<std::mutex> lock(_mutex);
+		stats.capacity = _file.isOpen() ? header()->capacity : 0;
+		stats.records = _file.isOpen() ? header()->records : 0;
+		stats.hits = _hits;
+		stats.verified = _verified;
+		stats.changed = _changed;
+		stats.misses = _misses;
+		stats.preloaded = _preloaded;
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_hits = 0;
+		_verified = 0;
+		_changed = 0;
+		_misses = 0;
+		_preloaded = 0;
+	}
+};
@@ -0,0 +1,524 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : PropertyLabels.h                                                *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+
+#include "EDSDK.h"
+
+
+// Display name of one property value
+typedef struct _PROPERTY_LABEL
+{
+	EdsUInt32		value;
+	const char*		label;
+}PROPERTY_LABEL;
+
+// Each table is sorted by value and looked up by binary search. The
+// tables are constant data: nothing is built or allocated at startup.
+static constexpr PROPERTY_LABEL kAEModeLabels[] =
+{
+	{ 0,          "P" },
+	{ 1,          "Tv" },
+	{ 2,          "Av" },
+	{ 3,          "M" },
+	{ 4,          "Bulb" },
+	{ 5,          "A-DEP" },
+	{ 6,          "DEP" },
+	{ 7,          "C1" },
+	{ 8,          "Lock" },
+	{ 9,          "GreenMode" },
+	{ 10,         "Night Portrait" },
+	{ 11,         "Sports" },
+	{ 12,         "Portrait" },
+	{ 13,         "LandScape" },
+	{ 14,         "Close-Up" },
+	{ 15,         "No Strobo" },
+	{ 16,         "C2" },
+	{ 17,         "C3" },
+	{ 19,         "Creative Auto" },
+	{ 20,         "Movies" },
+	{ 22,         "Scene Intelligent Auto" },
+	{ 25,         "SCN" },
+	{ 29,         "Creative filters" },
+	{ 55,         "FV" },
+	{ 0xffffffff, "unknown" },
+};
+
+static constexpr PROPERTY_LABEL kTvLabels[] =
+{
+	{ 0x04,       "Auto" },
+	{ 0x0c,       "Bulb" },
+	{ 0x10,       "30\"" },
+	{ 0x13,       "25\"" },
+	{ 0x14,       "20\"" },
+	{ 0x15,       "20\"" },
+	{ 0x18,       "15\"" },
+	{ 0x1B,       "13\"" },
+	{ 0x1C,       "10\"" },
+	{ 0x1D,       "10\"" },
+	{ 0x20,       "8\"" },
+	{ 0x23,       "6\"" },
+	{ 0x24,       "6\"" },
+	{ 0x25,       "5\"" },
+	{ 0x28,       "4\"" },
+	{ 0x2B,       "3\"2" },
+	{ 0x2C,       "3\"" },
+	{ 0x2D,       "2\"5" },
+	{ 0x30,       "2\"" },
+	{ 0x33,       "1\"6" },
+	{ 0x34,       "1\"5" },
+	{ 0x35,       "1\"3" },
+	{ 0x38,       "1\"" },
+	{ 0x3B,       "0\"8" },
+	{ 0x3C,       "0\"7" },
+	{ 0x3D,       "0\"6" },
+	{ 0x40,       "0\"5" },
+	{ 0x43,       "0\"4" },
+	{ 0x44,       "0\"3" },
+	{ 0x45,       "0\"3" },
+	{ 0x48,       "4" },
+	{ 0x4B,       "5" },
+	{ 0x4C,       "6" },
+	{ 0x4D,       "6" },
+	{ 0x50,       "8" },
+	{ 0x53,       "10" },
+	{ 0x54,       "10" },
+	{ 0x55,       "13" },
+	{ 0x58,       "15" },
+	{ 0x5B,       "20" },
+	{ 0x5C,       "20" },
+	{ 0x5D,       "25" },
+	{ 0x60,       "30" },
+	{ 0x63,       "40" },
+	{ 0x64,       "45" },
+	{ 0x65,       "50" },
+	{ 0x68,       "60" },
+	{ 0x6B,       "80" },
+	{ 0x6C,       "90" },
+	{ 0x6D,       "100" },
+	{ 0x70,       "125" },
+	{ 0x73,       "160" },
+	{ 0x74,       "180" },
+	{ 0x75,       "200" },
+	{ 0x78,       "250" },
+	{ 0x7B,       "320" },
+	{ 0x7C,       "350" },
+	{ 0x7D,       "400" },
+	{ 0x80,       "500" },
+	{ 0x83,       "640" },
+	{ 0x84,       "750" },
+	{ 0x85,       "800" },
+	{ 0x88,       "1000" },
+	{ 0x8B,       "1250" },
+	{ 0x8C,       "1500" },
+	{ 0x8D,       "1600" },
+	{ 0x90,       "2000" },
+	{ 0x93,       "2500" },
+	{ 0x94,       "3000" },
+	{ 0x95,       "3200" },
+	{ 0x98,       "4000" },
+	{ 0x9B,       "5000" },
+	{ 0x9C,       "6000" },
+	{ 0x9D,       "6400" },
+	{ 0xA0,       "8000" },
+	{ 0xA3,       "10000" },
+	{ 0xA5,       "12800" },
+	{ 0xA8,       "16000" },
+	{ 0xAB,       "20000" },
+	{ 0xAD,       "25600" },
+	{ 0xB0,       "32000" },
+	{ 0xffffffff, "unknown" },
+};
+
+static constexpr PROPERTY_LABEL kAvLabels[] =
+{
+	{ 0x00,       "00" },
+	{ 0x08,       "1" },
+	{ 0x0B,       "1.1" },
+	{ 0x0C,       "1.2" },
+	{ 0x0D,       "1.2" },
+	{ 0x10,       "1.4" },
+	{ 0x13,       "1.6" },
+	{ 0x14,       "1.8" },
+	{ 0x15,       "1.8" },
+	{ 0x18,       "2" },
+	{ 0x1B,       "2.2" },
+	{ 0x1C,       "2.5" },
+	{ 0x1D,       "2.5" },
+	{ 0x20,       "2.8" },
+	{ 0x23,       "3.2" },
+	{ 0x24,       "3.5" },
+	{ 0x25,       "3.5" },
+	{ 0x28,       "4" },
+	{ 0x2B,       "4.5" },
+	{ 0x2C,       "4.5" },
+	{ 0x2D,       "5.0" },
+	{ 0x30,       "5.6" },
+	{ 0x33,       "6.3" },
+	{ 0x34,       "6.7" },
+	{ 0x35,       "7.1" },
+	{ 0x38,       "8" },
+	{ 0x3B,       "9" },
+	{ 0x3C,       "9.5" },
+	{ 0x3D,       "10" },
+	{ 0x40,       "11" },
+	{ 0x43,       "13" },
+	{ 0x44,       "13" },
+	{ 0x45,       "14" },
+	{ 0x48,       "16" },
+	{ 0x4B,       "18" },
+	{ 0x4C,       "19" },
+	{ 0x4D,       "20" },
+	{ 0x50,       "22" },
+	{ 0x53,       "25" },
+	{ 0x54,       "27" },
+	{ 0x55,       "29" },
+	{ 0x58,       "32" },
+	{ 0x5B,       "36" },
+	{ 0x5C,       "38" },
+	{ 0x5D,       "40" },
+	{ 0x60,       "45" },
+	{ 0x63,       "51" },
+	{ 0x64,       "54" },
+	{ 0x65,       "57" },
+	{ 0x68,       "64" },
+	{ 0x6B,       "72" },
+	{ 0x6C,       "76" },
+	{ 0x6D,       "80" },
+	{ 0x70,       "91" },
+	{ 0xFF,       "Auto" },
+	{ 0xffffffff, "unknown" },
+};
+
+static constexpr PROPERTY_LABEL kIsoLabels[] =
+{
+	{ 0x00,       "Auto" },
+	{ 0x28,       "6" },
+	{ 0x30,       "12" },
+	{ 0x38,       "25" },
+	{ 0x40,       "50" },
+	{ 0x48,       "100" },
+	{ 0x4b,       "125" },
+	{ 0x4d,       "160" },
+	{ 0x50,       "200" },
+	{ 0x53,       "250" },
+	{ 0x55,       "320" },
+	{ 0x58,       "400" },
+	{ 0x5b,       "500" },
+	{ 0x5d,       "640" },
+	{ 0x60,       "800" },
+	{ 0x63,       "1000" },
+	{ 0x65,       "1250" },
+	{ 0x68,       "1600" },
+	{ 0x6b,       "2000" },
+	{ 0x6d,       "2500" },
+	{ 0x70,       "3200" },
+	{ 0x73,       "4000" },
+	{ 0x75,       "5000" },
+	{ 0x78,       "6400" },
+	{ 0x7b,       "8000" },
+	{ 0x7d,       "10000" },
+	{ 0x80,       "12800" },
+	{ 0x83,       "16000" },
+	{ 0x85,       "20000" },
+	{ 0x88,       "25600" },
+	{ 0x8b,       "32000" },
+	{ 0x8d,       "40000" },
+	{ 0x90,       "51200" },
+	{ 0x93,       "64000" },
+	{ 0x95,       "80000" },
+	{ 0x98,       "102400" },
+	{ 0xa0,       "204800" },
+	{ 0xa8,       "409600" },
+	{ 0xb0,       "819200" },
+	{ 0xffffffff, "unknown" },
+};
+
+static constexpr PROPERTY_LABEL kMeteringModeLabels[] =
+{
+	{ 1,          "Spot metering" },
+	{ 3,          "Evaluative metering" },
+	{ 4,          "Partial metering" },
+	{ 5,          "Center-weighted average" },
+	{ 0xffffffff, "unknown" },
+};
+
+static constexpr PROPERTY_LABEL kExposureCompensationLabels[] =
+{
+	{ 0x00,       "0" },
+	{ 0x03,       "+1/3" },
+	{ 0x04,       "+1/2" },
+	{ 0x05,       "+2/3" },
+	{ 0x08,       "+1" },
+	{ 0x0b,       "+1 1/3" },
+	{ 0x0c,       "+1 1/2" },
+	{ 0x0d,       "+1 2/3" },
+	{ 0x10,       "+2" },
+	{ 0x13,       "+2 1/3" },
+	{ 0x14,       "+2 1/2" },
+	{ 0x15,       "+2 2/3" },
+	{ 0x18,       "+3" },
+	{ 0x1B,       "+3 1/3" },
+	{ 0x1C,       "+3 1/2" },
+	{ 0x1D,       "+3 2/3" },
+	{ 0x20,       "+4" },
+	{ 0x23,       "+4 1/3" },
+	{ 0x24,       "+4 1/2" },
+	{ 0x25,       "+4 2/3" },
+	{ 0x28,       "+5" },
+	{ 0xD8,       "-5" },
+	{ 0xDB,       "-4 2/3" },
+	{ 0xDC,       "-4 1/2" },
+	{ 0xDD,       "-4 1/3" },
+	{ 0xE0,       "-4" },
+	{ 0xE3,       "-3 2/3" },
+	{ 0xE4,       "-3 1/2" },
+	{ 0xE5,       "-3 1/3" },
+	{ 0xe8,       "-3" },
+	{ 0xeb,       "-2 2/3" },
+	{ 0xec,       "-2 1/2" },
+	{ 0xed,       "-2 1/3" },
+	{ 0xf0,       "-2" },
+	{ 0xf3,       "-1 2/3" },
+	{ 0xf4,       "-1 1/2" },
+	{ 0xf5,       "-1 1/3" },
+	{ 0xf8,       "-1" },
+	{ 0xfb,       "-2/3" },
+	{ 0xfc,       "-1/2" },
+	{ 0xfd,       "-1/3" },
+	{ 0xffffffff, "unknown" },
+};
+
+static constexpr PROPERTY_LABEL kImageQualityLabels[] =
+{
+	{ EdsImageQuality_LJ,        "Large Jpeg" },
+	{ EdsImageQuality_LJN,       "Large Normal Jpeg" },
+	{ EdsImageQuality_LJF,       "Large Fine Jpeg" },
+	{ EdsImageQuality_CRLJ,      "CRAW + Large Jpeg" },
+	{ EdsImageQuality_CRLJN,     "CRAW + Large Normal Jpeg" },
+	{ EdsImageQuality_CRLJF,     "CRAW + Large Fine Jpeg" },
+	{ EdsImageQuality_CRHEIFL,   "CRAW + HEIF Large" },
+	{ EdsImageQuality_CRHEIFLN,  "CRAW + HEIF Large Normal" },
+	{ EdsImageQuality_CRHEIFLF,  "CRAW + HEIF Large Fine" },
+	{ EdsImageQuality_CRMJN,     "CRAW + Middle Normal Jpeg" },
+	{ EdsImageQuality_CRMJF,     "CRAW + Middle Fine Jpeg" },
+	{ EdsImageQuality_CRHEIFMN,  "CRAW + HEIF Middle Normal" },
+	{ EdsImageQuality_CRHEIFMF,  "CRAW + HEIF Middle Fine" },
+	{ EdsImageQuality_CRSJ,      "CRAW + Small Jpeg" },
+	{ EdsImageQuality_CRSJN,     "CRAW + Small Normal Jpeg" },
+	{ EdsImageQuality_CRSJF,     "CRAW + Small Fine Jpeg" },
+	{ EdsImageQuality_CRM1J,     "CRAW + Middle1 Jpeg" },
+	{ EdsImageQuality_CRM1JN,    "CRAW + Middle1 Normal Jpeg" },
+	{ EdsImageQuality_CRM1JF,    "CRAW + Middle1 Fine Jpeg" },
+	{ EdsImageQuality_CRM2J,     "CRAW + Middle2 Jpeg" },
+	{ EdsImageQuality_CRM2JN,    "CRAW + Middle2 Normal Jpeg" },
+	{ EdsImageQuality_CRM2JF,    "CRAW + Middle2 Fine Jpeg" },
+	{ EdsImageQuality_CRS1JN,    "CRAW + Small1 Normal Jpeg" },
+	{ EdsImageQuality_CRS1JF,    "CRAW + Small1 Fine Jpeg" },
+	{ EdsImageQuality_CRHEIFS1N, "CRAW + HEIF Small1 Normal" },
+	{ EdsImageQuality_CRHEIFS1F, "CRAW + HEIF Small1 Fine" },
+	{ EdsImageQuality_CRS2JF,    "CRAW + Small2 Fine Jpeg" },
+	{ EdsImageQuality_CRHEIFS2F, "CRAW + HEIF Small2 Fine" },
+	{ EdsImageQuality_CRS3JF,    "CRAW + Small3 Fine Jpeg" },
+	{ EdsImageQuality_CR,        "CRAW" },
+	{ EdsImageQuality_LRLJ,      "RAW + Large Jpeg" },
+	{ EdsImageQuality_LRLJN,     "RAW + Large Normal Jpeg" },
+	{ EdsImageQuality_LRLJF,     "RAW + Large Fine Jpeg" },
+	{ EdsImageQuality_RHEIFL,    "RAW + HEIF Large" },
+	{ EdsImageQuality_RHEIFLN,   "RAW + HEIF Large Normal" },
+	{ EdsImageQuality_RHEIFLF,   "RAW + HEIF Large Fine" },
+	{ EdsImageQuality_LRMJN,     "RAW + Middle Normal Jpeg" },
+	{ EdsImageQuality_LRMJF,     "RAW + Middle Fine Jpeg" },
+	{ EdsImageQuality_RHEIFMN,   "RAW + HEIF Middle Normal" },
+	{ EdsImageQuality_RHEIFMF,   "RAW + HEIF Middle Fine" },
+	{ EdsImageQuality_LRSJ,      "RAW + Small Jpeg" },
+	{ EdsImageQuality_LRSJN,     "RAW + Small Normal Jpeg" },
+	{ EdsImageQuality_LRSJF,     "RAW + Small Fine Jpeg" },
+	{ EdsImageQuality_LRM1J,     "RAW + Middle1 Jpeg" },
+	{ EdsImageQuality_LRM2J,     "RAW + Middle2 Jpeg" },
+	{ EdsImageQuality_LRS1JN,    "RAW + Small1 Normal Jpeg" },
+	{ EdsImageQuality_LRS1JF,    "RAW + Small1 Fine Jpeg" },
+	{ EdsImageQuality_RHEIFS1N,  "RAW + HEIF Small1 Normal" },
+	{ EdsImageQuality_RHEIFS1F,  "RAW + HEIF Small1 Fine" },
+	{ EdsImageQuality_LRS2JF,    "RAW + Small2 Jpeg" },
+	{ EdsImageQuality_RHEIFS2F,  "RAW + HEIF Small2 Fine" },
+	{ EdsImageQuality_LRS3JF,    "RAW + Small3 Jpeg" },
+	{ EdsImageQuality_LR,        "RAW" },
+	{ EdsImageQuality_HEIFL,     "HEIF Large" },
+	{ EdsImageQuality_HEIFLN,    "HEIF Large Normal" },
+	{ EdsImageQuality_HEIFLF,    "HEIF Large Fine" },
+	{ EdsImageQuality_MJN,       "Middle Normal Jpeg" },
+	{ EdsImageQuality_MJF,       "Middle Fine Jpeg" },
+	{ EdsImageQuality_MRLJ,      "Middle Raw + Large Jpeg" },
+	{ EdsImageQuality_MRLJN,     "Middle Raw(Small RAW1) + Large Normal Jpeg" },
+	{ EdsImageQuality_MRLJF,     "Middle Raw(Small RAW1) + Large Fine Jpeg" },
+	{ EdsImageQuality_MRMJN,     "Middle Raw(Small RAW1) + Middle Normal Jpeg" },
+	{ EdsImageQuality_MRMJF,     "Middle Raw(Small RAW1) + Middle Fine Jpeg" },
+	{ EdsImageQuality_MRSJ,      "Middle Raw + Small Jpeg" },
+	{ EdsImageQuality_MRSJN,     "Middle Raw(Small RAW1) + Small Normal Jpeg" },
+	{ EdsImageQuality_MRSJF,     "Middle Raw(Small RAW1) + Small Fine Jpeg" },
+	{ EdsImageQuality_MRM1J,     "Middle Raw + Middle1 Jpeg" },
+	{ EdsImageQuality_MRM2J,     "Middle Raw + Middle2 Jpeg" },
+	{ EdsImageQuality_MRS1JN,    "Middle RAW + Small1 Normal Jpeg" },
+	{ EdsImageQuality_MRS1JF,    "Middle RAW + Small1 Fine Jpeg" },
+	{ EdsImageQuality_MRS2JF,    "Middle RAW + Small2 Jpeg" },
+	{ EdsImageQuality_MRS3JF,    "Middle RAW + Small3 Jpeg" },
+	{ EdsImageQuality_MR,        "Middle Raw(Small RAW1)" },
+	{ EdsImageQuality_HEIFMN,    "HEIF Middle Normal" },
+	{ EdsImageQuality_HEIFMF,    "HEIF Middle Fine" },
+	{ EdsImageQuality_SJ,        "Small Jpeg" },
+	{ EdsImageQuality_SJN,       "Small Normal Jpeg" },
+	{ EdsImageQuality_SJF,       "Small Fine Jpeg" },
+	{ EdsImageQuality_SRLJ,      "Small RAW + Large Jpeg" },
+	{ EdsImageQuality_SRLJN,     "Small RAW(Small RAW2) + Large Normal Jpeg" },
+	{ EdsImageQuality_SRLJF,     "Small RAW(Small RAW2) + Large Fine Jpeg" },
+	{ EdsImageQuality_SRMJN,     "Small RAW(Small RAW2) + Middle Normal Jpeg" },
+	{ EdsImageQuality_SRMJF,     "Small RAW(Small RAW2) + Middle Fine Jpeg" },
+	{ EdsImageQuality_SRSJ,      "Small RAW + Small Jpeg" },
+	{ EdsImageQuality_SRSJN,     "Small RAW(Small RAW2) + Small Normal Jpeg" },
+	{ EdsImageQuality_SRSJF,     "Small RAW(Small RAW2) + Small Fine Jpeg" },
+	{ EdsImageQuality_SRM1J,     "Small RAW + Middle1 Jpeg" },
+	{ EdsImageQuality_SRM2J,     "Small RAW + Middle2 Jpeg" },
+	{ EdsImageQuality_SRS1JN,    "Small RAW + Small1 Normal Jpeg" },
+	{ EdsImageQuality_SRS1JF,    "Small RAW + Small1 Fine Jpeg" },
+	{ EdsImageQuality_SRS2JF,    "Small RAW + Small2 Jpeg" },
+	{ EdsImageQuality_SRS3JF,    "Small RAW + Small3 Jpeg" },
+	{ EdsImageQuality_SR,        "Small RAW(Small RAW2)" },
+	{ EdsImageQuality_M1J,       "Middle1 Jpeg" },
+	{ EdsImageQuality_M2J,       "Middle2 Jpeg" },
+	{ EdsImageQuality_S1JN,      "Small1 Normal Jpeg" },
+	{ EdsImageQuality_S1JF,      "Small1 Fine Jpeg" },
+	{ EdsImageQuality_HEIFS1N,   "HEIF Small1 Normal" },
+	{ EdsImageQuality_HEIFS1F,   "HEIF Small1 Fine" },
+	{ EdsImageQuality_S2JF,      "Small2 Jpeg" },
+	{ EdsImageQuality_HEIFS2F,   "HEIF Small2 Fine" },
+	{ EdsImageQuality_S3JF,      "Small3 Jpeg" },
+};
+
+static constexpr PROPERTY_LABEL kEvfAFModeLabels[] =
+{
+	{ 0x00,       "Quick mode" },
+	{ 0x01,       "1-point AF" },
+	{ 0x02,       "Face+Tracking" },
+	{ 0x03,       "FlexiZone - Multi" },
+	{ 0x04,       "Zone AF" },
+	{ 0x05,       "Expand AF area" },
+	{ 0x06,       "Expand AF area: Around" },
+	{ 0x07,       "Large Zone AF: Horizontal" },
+	{ 0x08,       "Large Zone AF: Vertical" },
+	{ 0x09,       "Catch AF" },
+	{ 0x0a,       "Spot AF" },
+	{ 0x0b,       "Flexible Zone AF 1" },
+	{ 0x0c,       "Flexible Zone AF 2" },
+	{ 0x0d,       "Flexible Zone AF 3" },
+	{ 0x0e,       "Whole area AF" },
+	{ 0x0f,       "No Traking Spot AF" },
+	{ 0x10,       "No Traking 1-point AF" },
+	{ 0x11,       "No Traking Expand AF area" },
+	{ 0x12,       "No Traking Expand AF area: Around" },
+	{ 0xffffffff, "unknown" },
+};
+
+
+typedef struct _PROPERTY_LABEL_TABLE
+{
+	EdsPropertyID			propertyID;
+	const PROPERTY_LABEL*	labels;
+	size_t					count;
+}PROPERTY_LABEL_TABLE;
+
+#define PROPERTY_LABEL_TABLE_ENTRY(propertyID, labels)	{ propertyID, labels, sizeof(labels) / sizeof(labels[0]) }
+
+static constexpr PROPERTY_LABEL_TABLE kPropertyLabelTables[] =
+{
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_AEModeSelect, kAEModeLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_Tv, kTvLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_Av, kAvLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_ISOSpeed, kIsoLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_MeteringMode, kMeteringModeLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_ExposureCompensation, kExposureCompensationLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_ImageQuality, kImageQualityLabels),
+	PROPERTY_LABEL_TABLE_ENTRY(kEdsPropID_Evf_AFMode, kEvfAFModeLabels),
+};
+
+#undef PROPERTY_LABEL_TABLE_ENTRY
+
+
+constexpr bool isPropertyLabelTableSorted(const PROPERTY_LABEL* labels, size_t count)
+{
+	for(size_t i = 1; i < count; i++)
+	{
+		if(labels[i - 1].value >= labels[i].value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+constexpr bool arePropertyLabelTablesSorted()
+{
+	for(size_t i = 0; i < sizeof(kPropertyLabelTables) / sizeof(kPropertyLabelTables[0]); i++)
+	{
+		if(!isPropertyLabelTableSorted(kPropertyLabelTables[i].labels, kPropertyLabelTables[i].count))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(arePropertyLabelTablesSorted(), "property label tables must be sorted by value");
+
+
+// NULL if no table is kept for the property
+inline const PROPERTY_LABEL_TABLE* findPropertyLabelTable(EdsPropertyID propertyID)
+{
+	for(size_t i = 0; i < sizeof(kPropertyLabelTables) / sizeof(kPropertyLabelTables[0]); i++)
+	{
+		if(kPropertyLabelTables[i].propertyID == propertyID)
+		{
+			return &kPropertyLabelTables[i];
+		}
+	}
+	return NULL;
+}
+
+// NULL if the value has no label
+inline const char* findPropertyLabel(const PROPERTY_LABEL_TABLE* table, EdsUInt32 value)
+{
+	if(table == NULL)
+	{
+		return NULL;
+	}
+
+	size_t low = 0;
+	size_t high = table->count;
+	while(low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+		if(table->labels[middle].value < value)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return (low < table->count && table->labels[low].value == value) ? table->labels[low].label : NULL;
+}
+
+inline const char* findPropertyLabel(EdsPropertyID propertyID, EdsUInt32 value)
+{
+	return findPropertyLabel(findPropertyLabelTable(propertyID), value);
+}
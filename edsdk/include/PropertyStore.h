@@ -0,0 +1,417 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : PropertyStore.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+
+
+// Largest value kept in the store; strings are EDS_MAX_NAME. Bigger
+// values (FocusInfo) are held by the model itself.
+#define PROPERTY_VALUE_MAX	EDS_MAX_NAME
+
+// A property value as the SDK returned it
+typedef struct _PROPERTY_VALUE
+{
+	EdsDataType		dataType;
+	EdsUInt32		size;
+	// Bumped each time the value changes, 0 until it is first set
+	EdsUInt32		version;
+	unsigned char	data[PROPERTY_VALUE_MAX];
+}PROPERTY_VALUE;
+
+
+// Values and descs of every property a camera reports, by EdsPropertyID.
+//
+// Writers (the processor and SDK threads) are serialized by a mutex.
+// Readers take no lock: each entry is a seqlock, so a reader copies the
+// entry and retries if a write overlapped. Entries are added to an open
+// addressed table that never shrinks, so lookups need no lock either.
+class PropertyStore
+{
+public:
+	enum { kCapacity = 256 };
+
+	// Fetch state of an entry, for sessions that read properties on demand
+	enum
+	{
+		kFetch_ValueStale		= 1 << 0,	// the camera reported a change not read yet
+		kFetch_DescStale		= 1 << 1,
+		kFetch_ValueRequested	= 1 << 2,	// a read is queued
+		kFetch_DescRequested	= 1 << 3,
+		kFetch_ValueFailed		= 1 << 4,	// the last read failed, not retried until the next change
+		kFetch_DescFailed		= 1 << 5,
+	};
+
+private:
+	struct Entry
+	{
+		// 0 while the slot is free
+		std::atomic<EdsUInt32>	propertyID;
+		// Odd while a write is in progress
+		std::atomic<EdsUInt32>	sequence;
+		std::atomic<EdsUInt32>	fetch;
+
+		PROPERTY_VALUE			value;
+		EdsUInt32				descVersion;
+		EdsPropertyDesc			desc;
+	};
+
+	Entry					_entries[kCapacity];
+	std::atomic<EdsUInt64>	_generation;
+	std::mutex				_writeMutex;
+
+	PropertyStore(const PropertyStore&);
+	PropertyStore& operator=(const PropertyStore&);
+
+	static EdsUInt32 slotOf(EdsPropertyID propertyID)
+	{
+		return (EdsUInt32)((propertyID * 2654435761u) >> 24) & (kCapacity - 1);
+	}
+
+	const Entry* find(EdsPropertyID propertyID) const
+	{
+		EdsUInt32 slot = slotOf(propertyID);
+		for(EdsUInt32 i = 0; i < kCapacity; i++)
+		{
+			const Entry& entry = _entries[(slot + i) & (kCapacity - 1)];
+			EdsUInt32 id = entry.propertyID.load(std::memory_order_acquire);
+			if(id == propertyID)
+			{
+				return &entry;
+			}
+			if(id == 0)
+			{
+				break;
+			}
+		}
+		return NULL;
+	}
+
+	// Called with the write mutex held. NULL when the table is full.
+	Entry* findOrAdd(EdsPropertyID propertyID)
+	{
+		EdsUInt32 slot = slotOf(propertyID);
+		for(EdsUInt32 i = 0; i < kCapacity; i++)
+		{
+			Entry& entry = _entries[(slot + i) & (kCapacity - 1)];
+			EdsUInt32 id = entry.propertyID.load(std::memory_order_relaxed);
+			if(id == propertyID)
+			{
+				return &entry;
+			}
+			if(id == 0)
+			{
+				// Published only once the slot is cleared
+				memset(&entry.value, 0, sizeof(entry.value));
+				memset(&entry.desc, 0, sizeof(entry.desc));
+				entry.descVersion = 0;
+				entry.fetch.store(0, std::memory_order_relaxed);
+				entry.propertyID.store(propertyID, std::memory_order_release);
+				return &entry;
+			}
+		}
+		return NULL;
+	}
+
+	static void beginWrite(Entry* entry)
+	{
+		entry->sequence.store(entry->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+
+	static void endWrite(Entry* entry)
+	{
+		entry->sequence.store(entry->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Copy out a consistent snapshot of an entry
+	template<typename F>
+	static void read(const Entry* entry, F copy)
+	{
+		for(;;)
+		{
+			EdsUInt32 before = entry->sequence.load(std::memory_order_acquire);
+			if(before & 1)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			copy();
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(entry->sequence.load(std::memory_order_relaxed) == before)
+			{
+				return;
+			}
+		}
+	}
+
+public:
+	PropertyStore() : _generation(0)
+	{
+		for(EdsUInt32 i = 0; i < kCapacity; i++)
+		{
+			_entries[i].propertyID.store(0, std::memory_order_relaxed);
+			_entries[i].sequence.store(0, std::memory_order_relaxed);
+			_entries[i].fetch.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	// True if the value differs from the one held. Values larger than
+	// PROPERTY_VALUE_MAX are not stored.
+	bool setValue(EdsPropertyID propertyID, EdsDataType dataType, const void* data, EdsUInt32 size)
+	{
+		if(size > PROPERTY_VALUE_MAX)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		Entry* entry = findOrAdd(propertyID);
+		if(entry == NULL)
+		{
+			return false;
+		}
+
+		// Current again, even if the value did not change
+		entry->fetch.fetch_and(~(EdsUInt32)(kFetch_ValueStale | kFetch_ValueRequested | kFetch_ValueFailed), std::memory_order_release);
+
+		if(entry->value.version != 0 && entry->value.dataType == dataType && entry->value.size == size &&
+		   memcmp(entry->value.data, data, size) == 0)
+		{
+			return false;
+		}
+
+		beginWrite(entry);
+		entry->value.dataType = dataType;
+		entry->value.size = size;
+		entry->value.version++;
+		memcpy(entry->value.data, data, size);
+		memset(entry->value.data + size, 0, PROPERTY_VALUE_MAX - size);
+		endWrite(entry);
+
+		_generation.fetch_add(1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	bool set(EdsPropertyID propertyID, EdsDataType dataType, const T& value)
+	{
+		return setValue(propertyID, dataType, &value, sizeof(T));
+	}
+
+	bool setString(EdsPropertyID propertyID, const EdsChar* str)
+	{
+		EdsChar buffer[PROPERTY_VALUE_MAX] = {0};
+		strncpy(buffer, str, PROPERTY_VALUE_MAX - 1);
+		return setValue(propertyID, kEdsDataType_String, buffer, (EdsUInt32)strlen(buffer) + 1);
+	}
+
+	void setDesc(EdsPropertyID propertyID, const EdsPropertyDesc& desc)
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		Entry* entry = findOrAdd(propertyID);
+		if(entry == NULL)
+		{
+			return;
+		}
+
+		entry->fetch.fetch_and(~(EdsUInt32)(kFetch_DescStale | kFetch_DescRequested | kFetch_DescFailed), std::memory_order_release);
+
+		beginWrite(entry);
+		entry->desc = desc;
+		entry->descVersion++;
+		endWrite(entry);
+
+		_generation.fetch_add(1, std::memory_order_release);
+	}
+
+	// The camera reported a change; the value or desc is read again on
+	// its next access.
+	void markStale(EdsPropertyID propertyID, bool desc)
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		Entry* entry = findOrAdd(propertyID);
+		if(entry != NULL)
+		{
+			EdsUInt32 clear = desc ? kFetch_DescFailed : kFetch_ValueFailed;
+			EdsUInt32 set = desc ? kFetch_DescStale : kFetch_ValueStale;
+			EdsUInt32 fetch = entry->fetch.load(std::memory_order_relaxed);
+			while(!entry->fetch.compare_exchange_weak(fetch, (fetch & ~clear) | set, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+	// True, once, when the value or desc is missing or stale and no read
+	// is queued for it yet. The caller queues the read.
+	bool claimFetch(EdsPropertyID propertyID, bool desc)
+	{
+		EdsUInt32 stale = desc ? kFetch_DescStale : kFetch_ValueStale;
+		EdsUInt32 blocked = desc ? (kFetch_DescRequested | kFetch_DescFailed) : (kFetch_ValueRequested | kFetch_ValueFailed);
+		EdsUInt32 requested = desc ? kFetch_DescRequested : kFetch_ValueRequested;
+
+		Entry* entry = const_cast<Entry*>(find(propertyID));
+		if(entry != NULL)
+		{
+			// The common case: held, current and not stale
+			EdsUInt32 fetch = entry->fetch.load(std::memory_order_acquire);
+			if(!(fetch & stale) && (desc ? getDescVersion(propertyID) : getVersion(propertyID)) != 0)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(_writeMutex);
+			entry = findOrAdd(propertyID);
+			if(entry == NULL)
+			{
+				return false;
+			}
+		}
+		EdsUInt32 fetch = entry->fetch.load(std::memory_order_relaxed);
+		do
+		{
+			if(fetch & blocked)
+			{
+				return false;
+			}
+		}
+		while(!entry->fetch.compare_exchange_weak(fetch, fetch | requested, std::memory_order_acq_rel, std::memory_order_relaxed));
+		return true;
+	}
+
+	// A read claimed with claimFetch ended. A failed one is not claimed
+	// again until the property is marked stale.
+	void fetchDone(EdsPropertyID propertyID, bool desc, bool failed)
+	{
+		Entry* entry = const_cast<Entry*>(find(propertyID));
+		if(entry == NULL)
+		{
+			return;
+		}
+		EdsUInt32 requested = desc ? kFetch_DescRequested : kFetch_ValueRequested;
+		EdsUInt32 fetch = entry->fetch.load(std::memory_order_relaxed);
+		EdsUInt32 next;
+		do
+		{
+			next = fetch & ~requested;
+			if(failed)
+			{
+				next |= desc ? kFetch_DescFailed : kFetch_ValueFailed;
+			}
+		}
+		while(!entry->fetch.compare_exchange_weak(fetch, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+	}
+
+	// False if the property has no value yet
+	bool getValue(EdsPropertyID propertyID, PROPERTY_VALUE& value) const
+	{
+		const Entry* entry = find(propertyID);
+		if(entry == NULL)
+		{
+			return false;
+		}
+		read(entry, [&]() { memcpy(&value, &entry->value, sizeof(value)); });
+		return value.version != 0;
+	}
+
+	// False unless the value is set and has the size of T
+	template<typename T>
+	bool get(EdsPropertyID propertyID, T& value) const
+	{
+		const Entry* entry = find(propertyID);
+		if(entry == NULL)
+		{
+			return false;
+		}
+
+		bool found = false;
+		read(entry, [&]() {
+			found = (entry->value.version != 0 && entry->value.size == sizeof(T));
+			if(found)
+			{
+				memcpy(&value, entry->value.data, sizeof(T));
+			}
+		});
+		return found;
+	}
+
+	EdsUInt32 getUInt32(EdsPropertyID propertyID, EdsUInt32 defaultValue) const
+	{
+		EdsUInt32 value;
+		return get(propertyID, value) ? value : defaultValue;
+	}
+
+	// All zero with numElements 0 until the desc is first set
+	EdsPropertyDesc getDesc(EdsPropertyID propertyID) const
+	{
+		EdsPropertyDesc desc;
+		memset(&desc, 0, sizeof(desc));
+
+		const Entry* entry = find(propertyID);
+		if(entry != NULL)
+		{
+			read(entry, [&]() { memcpy(&desc, &entry->desc, sizeof(desc)); });
+		}
+		return desc;
+	}
+
+	// 0 until the value is first set
+	EdsUInt32 getVersion(EdsPropertyID propertyID) const
+	{
+		const Entry* entry = find(propertyID);
+		EdsUInt32 version = 0;
+		if(entry != NULL)
+		{
+			read(entry, [&]() { version = entry->value.version; });
+		}
+		return version;
+	}
+
+	EdsUInt32 getDescVersion(EdsPropertyID propertyID) const
+	{
+		const Entry* entry = find(propertyID);
+		EdsUInt32 version = 0;
+		if(entry != NULL)
+		{
+			read(entry, [&]() { version = entry->descVersion; });
+		}
+		return version;
+	}
+
+	// Bumped on every change to any value or desc, for cheap polling
+	EdsUInt64 getGeneration() const
+	{
+		return _generation.load(std::memory_order_acquire);
+	}
+
+	// IDs of every property the store has seen
+	std::vector<EdsPropertyID> getPropertyIDs() const
+	{
+		std::vector<EdsPropertyID> propertyIDs;
+		for(EdsUInt32 i = 0; i < kCapacity; i++)
+		{
+			EdsUInt32 id = _entries[i].propertyID.load(std::memory_order_acquire);
+			if(id != 0)
+			{
+				propertyIDs.push_back(id);
+			}
+		}
+		return propertyIDs;
+	}
+};
@@ -0,0 +1,123 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : PropertyTraits.h                                                *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "EDSDK.h"
+
+
+// C++ type of a property, for the properties the sample reads and writes.
+// Using an ID with no specialization is a compile error.
+template<EdsPropertyID propertyID>
+struct PropertyTraits;
+
+#define DEFINE_PROPERTY_TRAITS(propertyID, cppType, edsDataType)	\
+	template<> struct PropertyTraits<propertyID>					\
+	{																\
+		typedef cppType type;										\
+		static const EdsDataType dataType = edsDataType;			\
+	};
+
+DEFINE_PROPERTY_TRAITS(kEdsPropID_AEModeSelect,				EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_AEMode,					EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Tv,						EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Av,						EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_ISOSpeed,					EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_MeteringMode,				EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_ExposureCompensation,		EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_ImageQuality,				EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_DriveMode,				EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_AFMode,					EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_SaveTo,					EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_BatteryLevel,				EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_AvailableShots,			EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_Mode,					EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_OutputDevice,			EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_DepthOfFieldPreview,	EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_Zoom,					EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_AFMode,				EdsUInt32,		kEdsDataType_UInt32)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_ZoomPosition,			EdsPoint,		kEdsDataType_Point)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_Evf_ZoomRect,				EdsRect,		kEdsDataType_Rect)
+DEFINE_PROPERTY_TRAITS(kEdsPropID_FocusInfo,				EdsFocusInfo,	kEdsDataType_FocusInfo)
+
+#undef DEFINE_PROPERTY_TRAITS
+
+
+// Type and size of a property as EdsGetPropertySize reports them
+typedef struct _PROPERTY_INFO
+{
+	EdsDataType		dataType;
+	EdsUInt32		size;
+}PROPERTY_INFO;
+
+
+// Types and sizes seen on the connected camera, so a read is one
+// EdsGetPropertyData instead of a size query plus the data. Only fixed-size
+// types are kept: strings and arrays can change length between reads.
+class PropertyInfoCache
+{
+private:
+	std::mutex									_mutex;
+	std::unordered_map<EdsUInt32, PROPERTY_INFO>	_infos;
+
+public:
+	static bool isCacheable(EdsDataType dataType)
+	{
+		return dataType != kEdsDataType_Unknown &&
+			   dataType != kEdsDataType_String &&
+			   dataType != kEdsDataType_ByteBlock &&
+			   !(dataType >= kEdsDataType_Bool_Array && dataType <= kEdsDataType_Rational_Array);
+	}
+
+	bool find(EdsPropertyID propertyID, PROPERTY_INFO& info)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::unordered_map<EdsUInt32, PROPERTY_INFO>::const_iterator it = _infos.find(propertyID);
+		if(it == _infos.end())
+		{
+			return false;
+		}
+		info = it->second;
+		return true;
+	}
+
+	void add(EdsPropertyID propertyID, EdsDataType dataType, EdsUInt32 size)
+	{
+		if(!isCacheable(dataType))
+		{
+			return;
+		}
+		PROPERTY_INFO info = { dataType, size };
+		std::lock_guard<std::mutex> lock(_mutex);
+		_infos[propertyID] = info;
+	}
+
+	void remove(EdsPropertyID propertyID)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_infos.erase(propertyID);
+	}
+
+	// When a session opens: the camera may not be the one seen before
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_infos.clear();
+	}
+
+	size_t size()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _infos.size();
+	}
+};
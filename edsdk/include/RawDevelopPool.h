@@ -0,0 +1,541 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : RawDevelopPool.h                                                *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+#include "CameraModel.h"
+#include "CapturedImage.h"
+#include "EvfFrame.h"
+#include "Trace.h"
+#include "EDSDK.h"
+
+
+// A RAW after development: RGB pixels, 8 or 16 bits a channel in native
+// byte order, rows packed.
+class DevelopedImage
+{
+private:
+	EdsDirectoryItemInfo		_info;
+	EdsUInt64					_sequence;
+	CapturedImageRef			_source;
+	EdsUInt32					_width;
+	EdsUInt32					_height;
+	EdsUInt32					_bitsPerChannel;
+	// Size of the full image in the file, before any scaling
+	EdsUInt32					_sourceWidth;
+	EdsUInt32					_sourceHeight;
+	std::vector<unsigned char>	_pixels;
+	EdsUInt64					_developMicros;
+
+	DevelopedImage(const DevelopedImage&);
+	DevelopedImage& operator=(const DevelopedImage&);
+
+	friend class RawDevelopPool;
+
+public:
+	DevelopedImage() : _sequence(0), _width(0), _height(0), _bitsPerChannel(8), _sourceWidth(0), _sourceHeight(0), _developMicros(0)
+	{
+		memset(&_info, 0, sizeof(_info));
+	}
+
+	const EdsDirectoryItemInfo& getInfo() const	{ return _info; }
+	const EdsChar* getFileName() const			{ return _info.szFileName; }
+	// CaptureQueue sequence of the download
+	EdsUInt64 getSequence() const				{ return _sequence; }
+	// The RAW bytes, only kept when the pool was told to
+	const CapturedImageRef& getSource() const	{ return _source; }
+
+	EdsUInt32 getWidth() const					{ return _width; }
+	EdsUInt32 getHeight() const					{ return _height; }
+	EdsUInt32 getBitsPerChannel() const			{ return _bitsPerChannel; }
+	EdsUInt32 getStride() const					{ return _width * 3 * (_bitsPerChannel / 8); }
+	EdsUInt32 getSourceWidth() const			{ return _sourceWidth; }
+	EdsUInt32 getSourceHeight() const			{ return _sourceHeight; }
+	const unsigned char* getPixels() const		{ return _pixels.empty() ? NULL : &_pixels[0]; }
+	EdsUInt64 getLength() const					{ return _pixels.size(); }
+
+	// Inside EdsGetImage and around it, on the worker
+	EdsUInt64 getDevelopMicros() const			{ return _developMicros; }
+};
+
+typedef std::shared_ptr<DevelopedImage> DevelopedImageRef;
+
+// Called on the worker that developed the image
+typedef std::function<void(const DevelopedImageRef&)> RawDevelopListener;
+
+
+typedef struct _RAW_DEVELOP_STATISTICS
+{
+	EdsUInt64	submitted;
+	EdsUInt64	developed;
+	EdsUInt64	failed;
+	EdsUInt64	dropped;				// over the input limit before a worker took them
+	EdsUInt64	overwritten;			// developed but never popped, over the result limit
+	EdsUInt32	queueDepth;
+	EdsUInt32	workerCount;
+	EdsUInt64	inputBytes;				// RAW bytes developed
+	EdsUInt64	outputPixels;
+	EdsUInt64	averageDevelopMicros;	// per image, on one worker
+	EdsUInt64	averageLatencyMicros;	// submit to done, queueing included
+	EdsUInt64	activeMicros;			// first submit to the latest result
+	double		imagesPerSecond;		// developed over activeMicros, all workers
+	double		megapixelsPerSecond;
+}RAW_DEVELOP_STATISTICS;
+
+
+// Develops RAW files to RGB with EdsCreateImageRef / EdsGetImage on a pool
+// of worker threads, straight from memory downloads: attached to a model,
+// RAWs pushed to its CaptureQueue go to the workers without touching the
+// disk. Each image gets its own image reference, so the workers develop in
+// parallel.
+//
+// Results wait in a bounded queue for pop() and go to the listeners as
+// they finish, not necessarily in submission order; getSequence() gives
+// the download order.
+class RawDevelopPool : public std::enable_shared_from_this<RawDevelopPool>
+{
+public:
+	enum { kDefaultWorkerCount = 2, kDefaultResultLimit = 4 };
+
+private:
+	class Worker : public Thread
+	{
+	private:
+		RawDevelopPool*	_pool;
+	public:
+		Worker(RawDevelopPool* pool) : _pool(pool) {}
+		// Develops through the SDK, which needs COM on this thread in Windows
+		virtual void run()
+		{
+#ifdef _WIN32
+			CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+			_pool->work();
+#ifdef _WIN32
+			CoUninitialize();
+#endif
+		}
+	};
+
+	typedef struct _JOB
+	{
+		CapturedImageRef	image;
+		EdsUInt64			queued;
+	}JOB;
+
+	EdsUInt32								_workerCount;
+	EdsTargetImageType						_imageType;
+	EdsImageSource							_source;
+	EdsUInt32								_maxSize;
+	EdsUInt32								_queueLimit;
+	EdsUInt32								_resultLimit;
+	bool									_keepSource;
+
+	std::vector<std::unique_ptr<Worker> >	_workers;
+	std::atomic<bool>						_running;
+	CameraModel*							_attached;
+
+	std::deque<JOB>							_jobs;
+	std::mutex								_jobMutex;
+	std::condition_variable					_jobCondition;
+
+	std::deque<DevelopedImageRef>			_results;
+	std::vector<RawDevelopListener>			_listeners;
+	std::mutex								_resultMutex;
+	std::condition_variable					_resultCondition;
+
+	RAW_DEVELOP_STATISTICS					_stats;
+	EdsUInt64								_developMicrosTotal;
+	EdsUInt64								_latencyMicrosTotal;
+	EdsUInt64								_firstSubmitMicros;
+	EdsUInt64								_lastResultMicros;
+
+	RawDevelopPool(const RawDevelopPool&);
+	RawDevelopPool& operator=(const RawDevelopPool&);
+
+public:
+	// imageType kEdsTargetImageType_RGB or _RGB16. maxSize fits the long
+	// side, 0 for full size.
+	RawDevelopPool(EdsUInt32 workerCount = kDefaultWorkerCount, EdsTargetImageType imageType = kEdsTargetImageType_RGB16, EdsUInt32 maxSize = 0)
+		: _workerCount(workerCount > 0 ? workerCount : 1), _imageType(imageType == kEdsTargetImageType_RGB ? kEdsTargetImageType_RGB : kEdsTargetImageType_RGB16),
+		  _source(kEdsImageSrc_FullView), _maxSize(maxSize), _queueLimit(0), _resultLimit(kDefaultResultLimit), _keepSource(false),
+		  _running(false), _attached(NULL), _developMicrosTotal(0), _latencyMicrosTotal(0),
+		  _firstSubmitMicros(0), _lastResultMicros(0)
+	{
+		memset(&_stats, 0, sizeof(_stats));
+	}
+
+	virtual ~RawDevelopPool()
+	{
+		detach();
+		stop();
+	}
+
+	// RAW extensions Canon bodies write
+	static bool isRawFile(const char* name)
+	{
+		const char* dot = (name != NULL) ? strrchr(name, '.') : NULL;
+		if(dot == NULL)
+		{
+			return false;
+		}
+		std::string ext(dot + 1);
+		for(size_t i = 0; i < ext.size(); i++)
+		{
+			ext[i] = (char)toupper((unsigned char)ext[i]);
+		}
+		return ext == "CR2" || ext == "CR3" || ext == "CRW";
+	}
+
+	// Set before start()
+	void setSource(EdsImageSource source)			{ _source = source; }
+	// 0 for no limit; past it the oldest waiting RAW is dropped
+	void setQueueLimit(EdsUInt32 limit)				{ std::lock_guard<std::mutex> lock(_jobMutex); _queueLimit = limit; }
+	void setResultLimit(EdsUInt32 limit)			{ std::lock_guard<std::mutex> lock(_resultMutex); _resultLimit = (limit > 0) ? limit : 1; }
+	// Keep the RAW buffer on the result instead of returning it to the pool
+	void setKeepSource(bool keepSource)				{ _keepSource = keepSource; }
+
+	EdsUInt32 getWorkerCount() const				{ return _workerCount; }
+	EdsTargetImageType getImageType() const			{ return _imageType; }
+	EdsUInt32 getMaxSize() const					{ return _maxSize; }
+	bool isRunning() const							{ return _running; }
+
+	void addListener(const RawDevelopListener& listener)
+	{
+		std::lock_guard<std::mutex> lock(_resultMutex);
+		_listeners.push_back(listener);
+	}
+
+	bool start()
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		if(_running)
+		{
+			return true;
+		}
+
+		_running = true;
+		for(EdsUInt32 i = 0; i < _workerCount; i++)
+		{
+			std::unique_ptr<Worker> worker(new Worker(this));
+			if(worker->start())
+			{
+				_workers.push_back(std::move(worker));
+			}
+		}
+
+		_running = !_workers.empty();
+		return _running;
+	}
+
+	// Waiting RAWs are dropped; those being developed finish first
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			if(!_running)
+			{
+				return;
+			}
+			_running = false;
+			_jobs.clear();
+		}
+		_jobCondition.notify_all();
+
+		for(size_t i = 0; i < _workers.size(); i++)
+		{
+			_workers[i]->join();
+		}
+		_workers.clear();
+		_resultCondition.notify_all();
+	}
+
+	// Takes the RAWs the model downloads to memory, before its CaptureQueue
+	// does. With passThrough they are queued there as well; other files
+	// always are.
+	void attach(CameraModel* model, bool passThrough = false)
+	{
+		detach();
+		std::weak_ptr<RawDevelopPool> pool(shared_from_this());
+		model->getCaptureQueue()->setTap([pool, passThrough](const CapturedImageRef& image)
+		{
+			std::shared_ptr<RawDevelopPool> owner = pool.lock();
+			if(!owner || !isRawFile(image->getFileName()) || !owner->submit(image))
+			{
+				return false;
+			}
+			return !passThrough;
+		});
+		_attached = model;
+	}
+
+	void detach()
+	{
+		if(_attached != NULL)
+		{
+			_attached->getCaptureQueue()->setTap(CaptureTap());
+			_attached = NULL;
+		}
+	}
+
+	// Any thread. False when stopped or the image has no data.
+	bool submit(const CapturedImageRef& image)
+	{
+		if(!image || image->getData() == NULL || image->getLength() == 0)
+		{
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_jobMutex);
+			if(!_running)
+			{
+				return false;
+			}
+			if(_queueLimit > 0 && _jobs.size() >= _queueLimit)
+			{
+				_jobs.pop_front();
+				_stats.dropped++;
+			}
+
+			JOB job;
+			job.image = image;
+			job.queued = evfClockMicros();
+			if(_firstSubmitMicros == 0)
+			{
+				_firstSubmitMicros = job.queued;
+			}
+			_jobs.push_back(job);
+			_stats.submitted++;
+		}
+		_jobCondition.notify_one();
+		return true;
+	}
+
+	// Oldest developed image not yet taken, or empty on timeout
+	DevelopedImageRef pop(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_resultMutex);
+		_resultCondition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [this]() { return !_results.empty(); });
+		if(_results.empty())
+		{
+			return DevelopedImageRef();
+		}
+		DevelopedImageRef image = _results.front();
+		_results.pop_front();
+		return image;
+	}
+
+	// True once every submitted RAW is developed or failed
+	bool waitIdle(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_resultMutex);
+		return _resultCondition.wait_for(lock, std::chrono::milliseconds(millisec < 0 ? 0 : millisec), [this]()
+		{
+			std::lock_guard<std::mutex> jobs(_jobMutex);
+			return _stats.developed + _stats.failed + _stats.dropped >= _stats.submitted;
+		});
+	}
+
+	RAW_DEVELOP_STATISTICS getStatistics()
+	{
+		RAW_DEVELOP_STATISTICS stats;
+		{
+			std::lock_guard<std::mutex> results(_resultMutex);
+			std::lock_guard<std::mutex> jobs(_jobMutex);
+			stats = _stats;
+			stats.queueDepth = (EdsUInt32)_jobs.size();
+			if(_stats.developed > 0)
+			{
+				stats.averageDevelopMicros = _developMicrosTotal / _stats.developed;
+				stats.averageLatencyMicros = _latencyMicrosTotal / _stats.developed;
+			}
+			if(_lastResultMicros > _firstSubmitMicros)
+			{
+				stats.activeMicros = _lastResultMicros - _firstSubmitMicros;
+			}
+		}
+		stats.workerCount = _workerCount;
+		if(stats.activeMicros > 0)
+		{
+			stats.imagesPerSecond = stats.developed * 1000000.0 / stats.activeMicros;
+			stats.megapixelsPerSecond = (double)stats.outputPixels / stats.activeMicros;
+		}
+		return stats;
+	}
+
+	// Develops one RAW held in memory; used by the workers and usable on
+	// its own.
+	static EdsError develop(const void* data, EdsUInt64 length, EdsImageSource source, EdsTargetImageType imageType,
+		EdsUInt32 maxSize, DevelopedImage& out)
+	{
+		EdsError		err = EDS_ERR_OK;
+		EdsStreamRef	input = NULL;
+		EdsStreamRef	output = NULL;
+		EdsImageRef		image = NULL;
+		EdsImageInfo	imageInfo;
+		EdsUInt32		bytesPerChannel = (imageType == kEdsTargetImageType_RGB16) ? 2 : 1;
+
+		err = EdsCreateMemoryStreamFromPointer(const_cast<void*>(data), length, &input);
+
+		if(err == EDS_ERR_OK)
+		{
+			TraceScope trace("EDSDK", "EdsCreateImageRef");
+			err = EdsCreateImageRef(input, &image);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsGetImageInfo(image, source, &imageInfo);
+		}
+
+		EdsSize size = { 0, 0 };
+		if(err == EDS_ERR_OK)
+		{
+			EdsUInt32 width = imageInfo.effectiveRect.size.width;
+			EdsUInt32 height = imageInfo.effectiveRect.size.height;
+			out._sourceWidth = width;
+			out._sourceHeight = height;
+			size.width = (EdsInt32)width;
+			size.height = (EdsInt32)height;
+			if(maxSize > 0 && std::max(width, height) > maxSize)
+			{
+				double scale = (double)maxSize / std::max(width, height);
+				size.width = std::max<EdsInt32>(1, (EdsInt32)(width * scale + 0.5));
+				size.height = std::max<EdsInt32>(1, (EdsInt32)(height * scale + 0.5));
+			}
+
+			// EdsGetImage writes straight into the result's pixels
+			out._pixels.resize((size_t)size.width * size.height * 3 * bytesPerChannel);
+			err = EdsCreateMemoryStreamFromPointer(&out._pixels[0], out._pixels.size(), &output);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			TraceScope trace("EDSDK", "EdsGetImage");
+			err = EdsGetImage(image, source, imageType, imageInfo.effectiveRect, size, output);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			out._width = (EdsUInt32)size.width;
+			out._height = (EdsUInt32)size.height;
+			out._bitsPerChannel = bytesPerChannel * 8;
+		}
+		else
+		{
+			out._pixels.clear();
+		}
+
+		if(output != NULL)
+		{
+			EdsRelease(output);
+		}
+		if(image != NULL)
+		{
+			EdsRelease(image);
+		}
+		if(input != NULL)
+		{
+			EdsRelease(input);
+		}
+		return err;
+	}
+
+protected:
+	void work()
+	{
+		Tracer::instance().setThreadName("RawDevelop");
+
+		for(;;)
+		{
+			JOB job;
+			{
+				std::unique_lock<std::mutex> lock(_jobMutex);
+				_jobCondition.wait(lock, [this]() { return !_running || !_jobs.empty(); });
+				if(!_running)
+				{
+					return;
+				}
+				job = _jobs.front();
+				_jobs.pop_front();
+			}
+
+			DevelopedImageRef developed = std::make_shared<DevelopedImage>();
+			developed->_info = job.image->getInfo();
+			developed->_sequence = job.image->getSequence();
+
+			EdsUInt64 started = evfClockMicros();
+			EdsError err;
+			{
+				TraceScope trace("Develop", "Raw");
+				err = develop(job.image->getData(), job.image->getLength(), _source, _imageType, _maxSize, *developed);
+				trace.setArg("error", err);
+			}
+			EdsUInt64 finished = evfClockMicros();
+			developed->_developMicros = finished - started;
+			if(_keepSource)
+			{
+				developed->_source = job.image;
+			}
+			EdsUInt64 inputBytes = job.image->getLength();
+			// The RAW buffer goes back to the capture pool here unless kept
+			job.image.reset();
+
+			std::vector<RawDevelopListener> listeners;
+			{
+				std::lock_guard<std::mutex> results(_resultMutex);
+				std::lock_guard<std::mutex> jobs(_jobMutex);
+				if(err != EDS_ERR_OK)
+				{
+					_stats.failed++;
+				}
+				else
+				{
+					_stats.developed++;
+					_stats.inputBytes += inputBytes;
+					_stats.outputPixels += (EdsUInt64)developed->_width * developed->_height;
+					_developMicrosTotal += developed->_developMicros;
+					_latencyMicrosTotal += finished - job.queued;
+					_lastResultMicros = finished;
+					_results.push_back(developed);
+					while(_results.size() > _resultLimit)
+					{
+						_results.pop_front();
+						_stats.overwritten++;
+					}
+					listeners = _listeners;
+				}
+			}
+			_resultCondition.notify_all();
+
+			for(size_t i = 0; i < listeners.size(); i++)
+			{
+				listeners[i](developed);
+			}
+		}
+	}
+};
+
+typedef std::shared_ptr<RawDevelopPool> RawDevelopPoolRef;
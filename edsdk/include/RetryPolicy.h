@@ -0,0 +1,149 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : RetryPolicy.h                                                   *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "EDSDK.h"
+
+
+// What a command that asked for a retry failed with
+enum RetryErrorClass
+{
+	kRetryError_Busy = 0,		// EDS_ERR_DEVICE_BUSY
+	kRetryError_NotReady,		// EDS_ERR_OBJECT_NOTREADY, live view not up yet
+	kRetryError_Other,
+	kRetryError_Count
+};
+
+// How a command is reissued. The n-th retry waits
+// initialDelay * factor^(n-1), at most maxDelay, give or take jitter.
+typedef struct _RETRY_POLICY
+{
+	EdsUInt32	initialDelayMillis;
+	double		factor;				// 1 keeps the delay fixed
+	EdsUInt32	maxDelayMillis;
+	double		jitter;				// fraction of the delay, either way
+	EdsUInt32	maxAttempts;		// executions in all, 0 for no limit
+	EdsUInt32	deadlineMillis;		// from the first execute(), 0 for none
+}RETRY_POLICY;
+
+
+// Retry policies of a processor, by error class, with overrides by command
+// name (Command::getName()).
+class RetryPolicyTable
+{
+private:
+	RETRY_POLICY								_defaults[kRetryError_Count];
+	std::map<std::string, RETRY_POLICY>			_overrides[kRetryError_Count];
+	std::minstd_rand							_random;
+	mutable std::mutex							_mutex;
+
+public:
+	static RETRY_POLICY makePolicy(EdsUInt32 initialDelayMillis, double factor, EdsUInt32 maxDelayMillis,
+		double jitter, EdsUInt32 maxAttempts, EdsUInt32 deadlineMillis)
+	{
+		RETRY_POLICY policy;
+		policy.initialDelayMillis = initialDelayMillis;
+		policy.factor = factor;
+		policy.maxDelayMillis = maxDelayMillis;
+		policy.jitter = jitter;
+		policy.maxAttempts = maxAttempts;
+		policy.deadlineMillis = deadlineMillis;
+		return policy;
+	}
+
+	static RetryErrorClass classOf(EdsError error)
+	{
+		if((error & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)return kRetryError_Busy;
+		if(error == EDS_ERR_OBJECT_NOTREADY)return kRetryError_NotReady;
+		return kRetryError_Other;
+	}
+
+	// Some cameras become unstable when commands are reissued in quick
+	// succession, so a busy body is left alone for 500 ms as before. A live
+	// view frame is usually ready within a few frame times.
+	RetryPolicyTable() : _random((std::minstd_rand::result_type)std::random_device()())
+	{
+		_defaults[kRetryError_Busy] = makePolicy(500, 1.0, 500, 0.0, 0, 30000);
+		_defaults[kRetryError_NotReady] = makePolicy(10, 1.5, 30, 0.2, 0, 5000);
+		_defaults[kRetryError_Other] = makePolicy(500, 2.0, 4000, 0.1, 8, 0);
+	}
+
+	void setDefault(RetryErrorClass errorClass, const RETRY_POLICY& policy)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_defaults[errorClass] = policy;
+	}
+
+	RETRY_POLICY getDefault(RetryErrorClass errorClass) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _defaults[errorClass];
+	}
+
+	// Policy for one kind of command, in place of the default
+	void setPolicy(const std::string& name, RetryErrorClass errorClass, const RETRY_POLICY& policy)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_overrides[errorClass][name] = policy;
+	}
+
+	// Back to the defaults for every error class
+	void clearPolicy(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(int i = 0; i < kRetryError_Count; i++)
+		{
+			_overrides[i].erase(name);
+		}
+	}
+
+	RETRY_POLICY getPolicy(const char* name, RetryErrorClass errorClass) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		const std::map<std::string, RETRY_POLICY>& overrides = _overrides[errorClass];
+		if(!overrides.empty())
+		{
+			std::map<std::string, RETRY_POLICY>::const_iterator it = overrides.find(name);
+			if(it != overrides.end())
+			{
+				return it->second;
+			}
+		}
+		return _defaults[errorClass];
+	}
+
+	// Wait before the given retry, 1 for the first
+	EdsUInt32 delayMillis(const RETRY_POLICY& policy, EdsUInt32 retry)
+	{
+		double delay = policy.initialDelayMillis;
+		for(EdsUInt32 i = 1; i < retry && delay < policy.maxDelayMillis; i++)
+		{
+			delay *= policy.factor;
+		}
+		if(delay > policy.maxDelayMillis)
+		{
+			delay = policy.maxDelayMillis;
+		}
+
+		if(policy.jitter > 0.0)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::uniform_real_distribution<double> spread(-policy.jitter, policy.jitter);
+			delay += delay * spread(_random);
+		}
+		return (delay < 0.0) ? 0 : (EdsUInt32)(delay + 0.5);
+	}
+};
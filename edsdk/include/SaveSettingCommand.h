@@ -15,6 +15,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/statvfs.h>
+#endif
+
 #include "Command.h"
 #include "CameraEvent.h"
 #include "EDSDK.h"
@@ -25,16 +34,78 @@ private:
 	EdsSaveTo _saveTo;
 
 public:
-	SaveSettingCommand(CameraModel *model, EdsSaveTo saveTo) :_saveTo(saveTo), Command(model){}
+	SaveSettingCommand(CameraModel *model, EdsSaveTo saveTo) :Command(model), _saveTo(saveTo){}
 
+	// Free space of the volume holding path, for EdsSetCapacity; the camera
+	// counts the shots left on the host from it. Clusters are capped at
+	// what EdsCapacity holds, and an unknown volume reports the cap.
+	static EdsCapacity hostCapacity(const std::string& path)
+	{
+		EdsCapacity capacity = {0x7FFFFFFF, 0x1000, 1};
+		const char* directory = path.empty() ? "." : path.c_str();
+		EdsUInt64 freeBytes = 0;
+		bool known = false;
+#ifdef _WIN32
+		ULARGE_INTEGER available;
+		if(GetDiskFreeSpaceExA(directory, &available, NULL, NULL))
+		{
+			freeBytes = available.QuadPart;
+			known = true;
+		}
+#else
+		struct statvfs volume;
+		if(statvfs(directory, &volume) == 0)
+		{
+			freeBytes = (EdsUInt64)volume.f_bavail * volume.f_frsize;
+			known = true;
+		}
+#endif
+		if(known)
+		{
+			capacity.numberOfFreeClusters = (EdsInt32)std::min<EdsUInt64>(freeBytes / capacity.bytesPerSector, 0x7FFFFFFF);
+		}
+		return capacity;
+	}
+
+	// Sets kEdsPropID_SaveTo and, when the host is part of it, the host's
+	// capacity under a UI lock
+	static EdsError apply(CameraModel* model, EdsUInt32 saveTo)
+	{
+		EdsError err = EDS_ERR_OK;
+		{
+			TraceScope trace("EDSDK", "EdsSetPropertyData");
+			err = EdsSetPropertyData(model->getCameraObject(), kEdsPropID_SaveTo, 0, sizeof(saveTo) , &saveTo);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK && (saveTo & kEdsSaveTo_Host))
+		{
+			err = model->lockUI();
+			if(err == EDS_ERR_OK)
+			{
+				EdsCapacity capacity = hostCapacity(model->getHostCapacityPath());
+				{
+					TraceScope trace("EDSDK", "EdsSetCapacity");
+					err = EdsSetCapacity(model->getCameraObject(), capacity);
+					trace.setArg("error", err);
+				}
+				model->unlockUI();
+			}
+		}
+		return err;
+	}
+
+	virtual const char* getName() const {return "SaveSetting";}
 
 	// Execute command	
 	virtual bool execute()
 	{
-		EdsError err = EDS_ERR_OK;
-		
 		//It sets preserving ahead
-		err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_SaveTo, 0, sizeof(_saveTo) , &_saveTo);
+		EdsError err = apply(_model, _saveTo);
+		if(err == EDS_ERR_OK)
+		{
+			_model->setSaveTo(_saveTo);
+		}
 
 		//Notification of error
 		if(err != EDS_ERR_OK)
@@ -42,12 +113,14 @@ public:
 			// It retries it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
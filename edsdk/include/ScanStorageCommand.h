@@ -0,0 +1,130 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ScanStorageCommand.h                                            *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include "Command.h"
+#include "CameraEvent.h"
+#include "CameraModel.h"
+#include "StorageIndex.h"
+#include "EDSDK.h"
+
+
+// Walks every card into the model's storage index. Queued with the
+// downloads, behind anything already waiting there.
+class ScanStorageCommand : public Command
+{
+public:
+	ScanStorageCommand(CameraModel *model) : Command(model) {}
+
+	virtual bool isTransfer() const {return true;}
+
+	virtual CommandPriority getPriority() const {return kCommandPriority_Background;}
+
+	virtual const char* getName() const {return "ScanStorage";}
+
+	virtual bool execute()
+	{
+		StorageIndexRef index = _model->getStorageIndex();
+		EdsError err = index->build(_model->getCameraObject());
+
+		// It retries it at device busy
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+			return false;
+		}
+
+		_error = err;
+		if(err != EDS_ERR_OK)
+		{
+			CameraEvent e(kCameraEvent_Error, &err);
+			_model->notifyObservers(&e);
+			return true;
+		}
+
+		STORAGE_INDEX_STATISTICS stats = index->getStatistics();
+		STORAGE_CHANGE change = { kStorageChange_Scanned, 0xffffffff, (EdsUInt32)stats.files, stats.generation };
+		CameraEvent e(kCameraEvent_StorageChanged, &change);
+		_model->notifyObservers(&e);
+		return true;
+	}
+};
+
+
+// Applies one object event to the storage index, so the cards need no
+// rescan after a capture or a delete
+class UpdateStorageCommand : public Command
+{
+private:
+	EdsUInt32	_event;
+	EdsBaseRef	_ref;
+
+public:
+	// Takes over the reference from the object event
+	UpdateStorageCommand(CameraModel *model, EdsUInt32 event, EdsBaseRef ref)
+		: Command(model), _event(event), _ref(ref) {}
+
+	virtual ~UpdateStorageCommand()
+	{
+		if(_ref != NULL)
+		{
+			EdsRelease(_ref);
+			_ref = NULL;
+		}
+	}
+
+	virtual bool isTransfer() const {return true;}
+
+	virtual const char* getName() const {return "UpdateStorage";}
+
+	virtual bool execute()
+	{
+		StorageIndexRef index = _model->getStorageIndex();
+		STORAGE_CHANGE change;
+		EdsError err = EDS_ERR_OK;
+
+		if(_event == kEdsObjectEvent_VolumeAdded || _event == kEdsObjectEvent_VolumeRemoved)
+		{
+			// A card came or went: the volume list itself changed
+			err = index->build(_model->getCameraObject());
+			STORAGE_INDEX_STATISTICS stats = index->getStatistics();
+			change.kind = kStorageChange_Scanned;
+			change.volume = 0xffffffff;
+			change.items = (EdsUInt32)stats.files;
+			change.generation = stats.generation;
+		}
+		else
+		{
+			err = index->update(_event, _ref, change);
+		}
+
+		// It retries it at device busy
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+			return false;
+		}
+
+		// Items outside the index, e.g. removed before it was built, are
+		// not errors worth telling observers about
+		_error = err;
+		if(err == EDS_ERR_OK)
+		{
+			CameraEvent e(kCameraEvent_StorageChanged, &change);
+			_model->notifyObservers(&e);
+		}
+		return true;
+	}
+};
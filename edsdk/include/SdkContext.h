@@ -0,0 +1,299 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : SdkContext.h                                                    *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "EDSDK.h"
+#include "CameraManager.h"
+#include "EvfFrame.h"
+
+
+class SdkContext;
+typedef std::shared_ptr<SdkContext> SdkContextRef;
+
+typedef struct _SDK_CONTEXT_STATISTICS
+{
+	EdsUInt64	initializations;	// EdsInitializeSDK calls, process lifetime
+	EdsUInt64	sessionsOpened;		// by this context
+	EdsUInt64	leases;
+	EdsUInt64	warmLeases;			// on a session that was already open
+	EdsUInt32	activeLeases;
+	EdsUInt32	openSessions;
+	EdsUInt64	lastLeaseMicros;	// time the last lease took
+}SDK_CONTEXT_STATISTICS;
+
+
+// Use of an open session. The session stays open, for the next lease,
+// when this is released.
+class SessionLease
+{
+private:
+	SdkContextRef		_context;
+	CameraSessionRef	_session;
+	bool				_warm;
+
+	SessionLease(const SessionLease&);
+	SessionLease& operator=(const SessionLease&);
+
+public:
+	SessionLease(const SdkContextRef& context, const CameraSessionRef& session, bool warm)
+		: _context(context), _session(session), _warm(warm) {}
+
+	virtual ~SessionLease()
+	{
+		release();
+	}
+
+	// Idempotent; the lease holds nothing after it
+	inline void release();
+
+	bool isActive() const						{ return (bool)_session; }
+	// The session was open before this lease
+	bool isWarm() const							{ return _warm; }
+	CameraSessionRef getSession() const			{ return _session; }
+	CameraModel* getCameraModel() const			{ return _session ? _session->getCameraModel() : NULL; }
+	CameraController* getCameraController() const	{ return _session ? _session->getCameraController() : NULL; }
+};
+
+typedef std::shared_ptr<SessionLease> SessionLeaseRef;
+
+
+// The EDSDK, once per process, and the camera sessions opened through it.
+//
+// acquire() hands out references to one context; the SDK is initialized
+// with the first and terminated with the last. Sessions are opened by
+// the first lease of a camera and kept open across leases, so a new
+// handle on a camera already in use, or recently used, costs a lookup
+// rather than EdsOpenSession.
+class SdkContext : public std::enable_shared_from_this<SdkContext>
+{
+private:
+	CameraManager					_manager;
+	std::mutex						_mutex;
+	std::map<CameraSession*, EdsUInt32>	_leaseCounts;
+	SDK_CONTEXT_STATISTICS			_stats;
+
+	SdkContext(const SdkContext&);
+	SdkContext& operator=(const SdkContext&);
+
+	// Recursive: a context that fails to initialize is destroyed inside acquire()
+	static std::recursive_mutex& lifecycleMutex()
+	{
+		static std::recursive_mutex mutex;
+		return mutex;
+	}
+
+	static std::weak_ptr<SdkContext>& current()
+	{
+		static std::weak_ptr<SdkContext> context;
+		return context;
+	}
+
+	static EdsUInt64& initializations()
+	{
+		static EdsUInt64 count = 0;
+		return count;
+	}
+
+	// Called with _mutex held. Empty port: any open session, the first one
+	// without a lease if there is one.
+	CameraSessionRef findOpen(const std::string& portName)
+	{
+		if(!portName.empty())
+		{
+			CameraSessionRef session = _manager.findByPort(portName);
+			return (session && session->isOpen()) ? session : CameraSessionRef();
+		}
+
+		CameraSessionRef leased;
+		std::vector<CameraSessionRef> sessions = _manager.getSessions();
+		for(size_t i = 0; i < sessions.size(); i++)
+		{
+			if(!sessions[i]->isOpen())
+			{
+				continue;
+			}
+			if(_leaseCounts[sessions[i].get()] == 0)
+			{
+				return sessions[i];
+			}
+			if(!leased)
+			{
+				leased = sessions[i];
+			}
+		}
+		return leased;
+	}
+
+	// Called with _mutex held. Drops sessions that are no longer open.
+	void pruneClosed()
+	{
+		std::vector<CameraSessionRef> sessions = _manager.getSessions();
+		for(size_t i = 0; i < sessions.size(); i++)
+		{
+			if(!sessions[i]->isOpen())
+			{
+				_leaseCounts.erase(sessions[i].get());
+				_manager.disconnect(sessions[i]);
+			}
+		}
+	}
+
+	friend class SessionLease;
+
+	void release(CameraSession* session)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::map<CameraSession*, EdsUInt32>::iterator it = _leaseCounts.find(session);
+		if(it != _leaseCounts.end() && it->second > 0)
+		{
+			it->second--;
+			_stats.activeLeases--;
+		}
+	}
+
+public:
+	SdkContext()
+	{
+		memset(&_stats, 0, sizeof(_stats));
+	}
+
+	// Sessions close at once; leases still held keep their session object
+	// but it no longer talks to the camera.
+	virtual ~SdkContext()
+	{
+		std::lock_guard<std::recursive_mutex> lock(lifecycleMutex());
+		_manager.terminate();
+	}
+
+	// The process-wide context, initializing the SDK if there is none.
+	// NULL with the error when EdsInitializeSDK fails.
+	static SdkContextRef acquire(EdsError* outError = NULL)
+	{
+		std::lock_guard<std::recursive_mutex> lock(lifecycleMutex());
+
+		SdkContextRef context = current().lock();
+		EdsError err = EDS_ERR_OK;
+		if(!context)
+		{
+			context = std::make_shared<SdkContext>();
+			err = context->_manager.initialize();
+			initializations()++;
+			if(err == EDS_ERR_OK)
+			{
+				current() = context;
+			}
+			else
+			{
+				context.reset();
+			}
+		}
+
+		if(outError != NULL)
+		{
+			*outError = err;
+		}
+		return context;
+	}
+
+	// True while some reference to the context is held
+	static bool isAlive()
+	{
+		std::lock_guard<std::recursive_mutex> lock(lifecycleMutex());
+		return !current().expired();
+	}
+
+	CameraManager& getManager()						{ return _manager; }
+
+	// A lease on the camera at portName, or with an empty name on any
+	// camera, opening sessions on attached cameras when none matches.
+	EdsError lease(const std::string& portName, SessionLeaseRef& outLease)
+	{
+		outLease.reset();
+		EdsUInt64 start = evfClockMicros();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		CameraSessionRef session = findOpen(portName);
+		bool warm = (bool)session;
+
+		EdsError err = EDS_ERR_OK;
+		if(!session)
+		{
+			pruneClosed();
+			size_t before = _manager.getSessionCount();
+			err = _manager.connectAll();
+			_stats.sessionsOpened += _manager.getSessionCount() - before;
+			session = findOpen(portName);
+		}
+
+		if(!session)
+		{
+			return (err != EDS_ERR_OK) ? err : EDS_ERR_DEVICE_NOT_FOUND;
+		}
+
+		_leaseCounts[session.get()]++;
+		_stats.leases++;
+		_stats.activeLeases++;
+		if(warm)
+		{
+			_stats.warmLeases++;
+		}
+
+		outLease = std::make_shared<SessionLease>(shared_from_this(), session, warm);
+		_stats.lastLeaseMicros = evfClockMicros() - start;
+		return EDS_ERR_OK;
+	}
+
+	// Close the sessions no lease holds
+	void closeIdle()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::vector<CameraSessionRef> sessions = _manager.getSessions();
+		for(size_t i = 0; i < sessions.size(); i++)
+		{
+			if(_leaseCounts[sessions[i].get()] == 0)
+			{
+				_leaseCounts.erase(sessions[i].get());
+				_manager.disconnect(sessions[i]);
+			}
+		}
+	}
+
+	SDK_CONTEXT_STATISTICS getStatistics()
+	{
+		SDK_CONTEXT_STATISTICS stats;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			stats = _stats;
+		}
+		{
+			std::lock_guard<std::recursive_mutex> lock(lifecycleMutex());
+			stats.initializations = initializations();
+		}
+		stats.openSessions = (EdsUInt32)_manager.getSessionCount();
+		return stats;
+	}
+};
+
+
+inline void SessionLease::release()
+{
+	if(_session)
+	{
+		_context->release(_session.get());
+		_session.reset();
+		_context.reset();
+	}
+}
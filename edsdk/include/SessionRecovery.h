@@ -0,0 +1,590 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : SessionRecovery.h                                               *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+#include "CameraEvent.h"
+#include "CameraManager.h"
+#include "EvfFrame.h"
+#include "Metrics.h"
+#include "OpenSessionCommand.h"
+#include "SetPropertiesCommand.h"
+#include "StartEvfCommand.h"
+#include "Thread.h"
+#include "Trace.h"
+
+
+// One lost link, told once it is back or given up. Times are evfClockMicros().
+typedef struct _RECOVERY_EVENT
+{
+	// Closed and out of the manager unless error is EDS_ERR_OK
+	CameraSessionRef	session;
+	EdsChar				portName[EDS_MAX_NAME];
+	EdsChar				serialNumber[EDS_MAX_NAME];
+	EdsError			error;
+	EdsUInt64			lostMicros;			// kEdsStateEvent_Shutdown
+	EdsUInt64			foundMicros;		// back in the camera list, 0 if it never was
+	EdsUInt64			openMicros;			// SDK session open again
+	EdsUInt64			resumedMicros;		// settings restored, commands running again
+	EdsUInt64			downtimeMicros;		// lost to resumed
+	EdsUInt32			scans;				// camera list reads
+	EdsUInt32			restored;			// settings set again
+	EdsUInt32			restoreFailed;		// settings the camera refused
+	bool				evfRestored;
+	EdsUInt32			replayed;			// commands held while down, run on resume
+}RECOVERY_EVENT;
+
+typedef std::function<void(const RECOVERY_EVENT&)> RecoveryListener;
+
+typedef struct _RECOVERY_STATISTICS
+{
+	EdsUInt64			lost;
+	EdsUInt64			recovered;
+	EdsUInt64			failed;				// not back in time, closed
+	EdsUInt32			recovering;			// now
+	LATENCY_SNAPSHOT	downtime;			// of the recovered ones
+}RECOVERY_STATISTICS;
+
+
+// Brings sessions back after kEdsStateEvent_Shutdown, as from a USB reset
+// or a hub that drops the link for a moment. The session's commands are
+// held from the shutdown on; the camera list is read every pollInterval
+// until the same body is back, which is then reattached to the session,
+// so its model, observers and handles stay valid. The SDK session is
+// opened again, the settings and live view it had are set back, and the
+// held commands run in order. A body not back within the timeout is
+// closed and dropped from the manager.
+//
+// Takes the manager's shutdown handler, in place of a HotPlugMonitor;
+// the monitor would see the returning body as a new one. Listeners run on
+// the recovery thread.
+class SessionRecovery : public Thread
+{
+public:
+	enum { kDefaultTimeoutMillis = 10000, kDefaultPollMillis = 20, kBusyRetryMillis = 10 };
+
+private:
+	// What a session had when it was lost
+	struct Lost
+	{
+		CameraSessionRef		session;
+		RECOVERY_EVENT			event;
+		std::string				description;
+		PropertySettingList		settings;
+		bool					evf;
+		PropertySettingList		evfSettings;	// after live view is started
+	};
+
+	// What the shutdown handler hands over; outlives the handler
+	struct Inbox
+	{
+		std::mutex							mutex;
+		std::condition_variable				wake;
+		bool								stopping;
+		std::vector<std::shared_ptr<Lost> >	lost;
+		PropertyIDList						properties;
+		PropertyIDList						evfProperties;
+		bool								restoreEvf;
+
+		Inbox() : stopping(false), restoreEvf(true) {}
+	};
+
+	CameraManager&				_manager;
+	std::shared_ptr<Inbox>		_inbox;
+	bool						_running;
+	EdsUInt32					_timeoutMillis;
+	EdsUInt32					_pollMillis;
+
+	std::mutex					_listenerMutex;
+	std::vector<RecoveryListener>	_listeners;
+
+	std::mutex					_statisticsMutex;
+	EdsUInt64					_lost;
+	EdsUInt64					_recovered;
+	EdsUInt64					_failed;
+	EdsUInt32					_recovering;
+	LatencyHistogram			_downtime;
+
+	SessionRecovery(const SessionRecovery&);
+	SessionRecovery& operator=(const SessionRecovery&);
+
+	static void snapshot(const CameraModel* model, const PropertyIDList& propertyIDs, PropertySettingList& settings)
+	{
+		for(size_t i = 0; i < propertyIDs.size(); i++)
+		{
+			PROPERTY_VALUE value;
+			if(!model->getPropertyStore().getValue(propertyIDs[i], value) || value.size > PROPERTY_VALUE_MAX)
+			{
+				continue;
+			}
+			PROPERTY_SETTING setting;
+			memset(&setting, 0, sizeof(setting));
+			setting.propertyID = propertyIDs[i];
+			setting.size = value.size;
+			memcpy(setting.data, value.data, value.size);
+			setting.error = EDS_ERR_DEVICE_BUSY;
+			settings.push_back(setting);
+		}
+	}
+
+	// On the SDK thread: hold the commands and note what to restore
+	static void sessionLost(const std::shared_ptr<Inbox>& inbox, const CameraSessionRef& session)
+	{
+		session->getCameraController()->suspend();
+
+		std::shared_ptr<Lost> lost = std::make_shared<Lost>();
+		lost->event = RECOVERY_EVENT();
+		lost->event.lostMicros = evfClockMicros();
+		lost->session = session;
+		lost->description = session->getDescription();
+		strncpy(lost->event.portName, session->getPortName(), EDS_MAX_NAME - 1);
+
+		CameraModel* model = session->getCameraModel();
+		// From the store, without a read on demand
+		PROPERTY_VALUE serialNumber;
+		if(model->getPropertyStore().getValue(kEdsPropID_BodyIDEx, serialNumber) && serialNumber.dataType == kEdsDataType_String)
+		{
+			strncpy(lost->event.serialNumber, (const EdsChar*)serialNumber.data, EDS_MAX_NAME - 1);
+		}
+
+		std::lock_guard<std::mutex> lock(inbox->mutex);
+		if(inbox->stopping)
+		{
+			session->getCameraController()->resume();
+			return;
+		}
+		snapshot(model, inbox->properties, lost->settings);
+		lost->evf = inbox->restoreEvf &&
+			(model->getPropertyStore().getUInt32(kEdsPropID_Evf_OutputDevice, 0) & kEdsEvfOutputDevice_PC) != 0;
+		if(lost->evf)
+		{
+			snapshot(model, inbox->evfProperties, lost->evfSettings);
+		}
+		inbox->lost.push_back(lost);
+		inbox->wake.notify_all();
+	}
+
+	static std::string readSerialNumber(EdsCameraRef camera)
+	{
+		EdsChar serialNumber[EDS_MAX_NAME];
+		memset(serialNumber, 0, sizeof(serialNumber));
+		if(EdsOpenSession(camera) != EDS_ERR_OK)
+		{
+			return std::string();
+		}
+		EdsGetPropertyData(camera, kEdsPropID_BodyIDEx, 0, sizeof(serialNumber) - 1, serialNumber);
+		EdsCloseSession(camera);
+		return serialNumber;
+	}
+
+	// A body on the same port, or else one like it on a port no session
+	// has whose serial number matches. Returns a reference, NULL if none.
+	EdsCameraRef find(const Lost& lost, EdsDeviceInfo& deviceInfo)
+	{
+		EdsCameraListRef cameraList = NULL;
+		EdsUInt32 count = 0;
+		EdsCameraRef found = NULL;
+
+		EdsError err = EdsGetCameraList(&cameraList);
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsGetChildCount(cameraList, &count);
+		}
+
+		for(EdsUInt32 pass = 0; pass < 2 && found == NULL; pass++)
+		{
+			for(EdsUInt32 i = 0; err == EDS_ERR_OK && i < count && found == NULL; i++)
+			{
+				EdsCameraRef camera = NULL;
+				EdsDeviceInfo info;
+				if(EdsGetChildAtIndex(cameraList, i, &camera) != EDS_ERR_OK)
+				{
+					continue;
+				}
+				if(EdsGetDeviceInfo(camera, &info) == EDS_ERR_OK)
+				{
+					CameraSessionRef owner = _manager.findByPort(info.szPortName);
+					if(pass == 0)
+					{
+						if(strcmp(info.szPortName, lost.event.portName) == 0 && (!owner || owner == lost.session))
+						{
+							found = camera;
+						}
+					}
+					else if(!owner && lost.event.serialNumber[0] != '\0' && lost.description == info.szDeviceDescription &&
+							readSerialNumber(camera) == lost.event.serialNumber)
+					{
+						found = camera;
+					}
+				}
+				if(found == camera)
+				{
+					deviceInfo = info;
+				}
+				else
+				{
+					EdsRelease(camera);
+				}
+			}
+		}
+
+		if(cameraList != NULL)
+		{
+			EdsRelease(cameraList);
+		}
+		return found;
+	}
+
+	// Until it completes or the deadline passes, busy answers included
+	static EdsError runUntil(Command& command, std::chrono::steady_clock::time_point deadline)
+	{
+		for(;;)
+		{
+			command.beginExecute();
+			bool complete = command.execute();
+			if((complete && command.getError() == EDS_ERR_OK) || std::chrono::steady_clock::now() >= deadline)
+			{
+				return command.getError();
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(kBusyRetryMillis));
+		}
+	}
+
+	static void countSettings(const SetPropertiesCommand& command, RECOVERY_EVENT& event)
+	{
+		const PropertySettingList& settings = command.getSettings();
+		for(size_t i = 0; i < settings.size(); i++)
+		{
+			if(settings[i].error == EDS_ERR_OK)
+			{
+				event.restored++;
+			}
+			else
+			{
+				event.restoreFailed++;
+			}
+		}
+	}
+
+	// The body is back under camera: open, restore, replay
+	EdsError recover(Lost& lost, EdsCameraRef camera, const EdsDeviceInfo& deviceInfo, std::chrono::steady_clock::time_point deadline)
+	{
+		TraceScope trace("Recovery", "Reopen");
+		CameraSession* session = lost.session.get();
+		CameraModel* model = session->getCameraModel();
+		CameraController* controller = session->getCameraController();
+		// Before the new session's property events queue their reads
+		lost.event.replayed = (EdsUInt32)controller->getPendingCount();
+
+		EdsError err = session->reattach(camera, deviceInfo);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		OpenSessionCommand open(model);
+		err = runUntil(open, deadline);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+		lost.event.openMicros = evfClockMicros();
+
+		if(!lost.settings.empty())
+		{
+			SetPropertiesCommand restore(model, lost.settings);
+			runUntil(restore, deadline);
+			countSettings(restore, lost.event);
+		}
+
+		if(lost.evf)
+		{
+			StartEvfCommand startEvf(model);
+			lost.event.evfRestored = (runUntil(startEvf, deadline) == EDS_ERR_OK);
+			if(lost.event.evfRestored && !lost.evfSettings.empty())
+			{
+				SetPropertiesCommand restore(model, lost.evfSettings);
+				runUntil(restore, deadline);
+				countSettings(restore, lost.event);
+			}
+		}
+
+		// Object events were lost with the link
+		if(model->getStorageIndex()->isActive())
+		{
+			controller->scanStorage();
+		}
+
+		controller->resume();
+		trace.setArg("error", err);
+		return EDS_ERR_OK;
+	}
+
+	// Called outside the lock, so a listener may add another
+	void notify(const RECOVERY_EVENT& event)
+	{
+		std::vector<RecoveryListener> listeners;
+		{
+			std::lock_guard<std::mutex> lock(_listenerMutex);
+			listeners = _listeners;
+		}
+		for(size_t i = 0; i < listeners.size(); i++)
+		{
+			listeners[i](event);
+		}
+	}
+
+	void finish(Lost& lost, EdsError err)
+	{
+		lost.event.error = err;
+		if(err == EDS_ERR_OK)
+		{
+			lost.event.resumedMicros = evfClockMicros();
+			lost.event.downtimeMicros = lost.event.resumedMicros - lost.event.lostMicros;
+		}
+		else
+		{
+			// Closing drops the held commands
+			_manager.disconnect(lost.session);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_statisticsMutex);
+			_recovering--;
+			if(err == EDS_ERR_OK)
+			{
+				_recovered++;
+				_downtime.record(lost.event.downtimeMicros);
+			}
+			else
+			{
+				_failed++;
+			}
+		}
+
+		lost.event.session = lost.session;
+		notify(lost.event);
+	}
+
+public:
+	SessionRecovery(CameraManager& manager)
+		: _manager(manager), _inbox(std::make_shared<Inbox>()), _running(false),
+		  _timeoutMillis(kDefaultTimeoutMillis), _pollMillis(kDefaultPollMillis),
+		  _lost(0), _recovered(0), _failed(0), _recovering(0)
+	{
+		const EdsPropertyID properties[] = {
+			kEdsPropID_ImageQuality, kEdsPropID_DriveMode, kEdsPropID_AFMode, kEdsPropID_MeteringMode,
+			kEdsPropID_Tv, kEdsPropID_Av, kEdsPropID_ISOSpeed, kEdsPropID_ExposureCompensation,
+			kEdsPropID_WhiteBalance, kEdsPropID_ColorTemperature, kEdsPropID_PictureStyle,
+		};
+		const EdsPropertyID evfProperties[] = {
+			kEdsPropID_Evf_AFMode, kEdsPropID_Evf_Zoom, kEdsPropID_Evf_ZoomPosition,
+		};
+		_inbox->properties.assign(properties, properties + sizeof(properties) / sizeof(properties[0]));
+		_inbox->evfProperties.assign(evfProperties, evfProperties + sizeof(evfProperties) / sizeof(evfProperties[0]));
+	}
+
+	virtual ~SessionRecovery()
+	{
+		stop();
+	}
+
+	// How long a body may be gone before its session is closed
+	void setTimeout(EdsUInt32 millis)			{ _timeoutMillis = millis; }
+	EdsUInt32 getTimeout() const				{ return _timeoutMillis; }
+	// Camera list reads while waiting for it. Set both before start().
+	void setPollInterval(EdsUInt32 millis)		{ _pollMillis = (millis > 0) ? millis : 1; }
+	EdsUInt32 getPollInterval() const			{ return _pollMillis; }
+
+	// Set back in this order once the session is open again; values the
+	// model does not hold are skipped. Taken at the next loss.
+	void setRestoreProperties(const PropertyIDList& propertyIDs)
+	{
+		std::lock_guard<std::mutex> lock(_inbox->mutex);
+		_inbox->properties = propertyIDs;
+	}
+	PropertyIDList getRestoreProperties()
+	{
+		std::lock_guard<std::mutex> lock(_inbox->mutex);
+		return _inbox->properties;
+	}
+
+	// Start live view again where it ran to the PC, then set its zoom and AF mode
+	void setRestoreEvf(bool restoreEvf)
+	{
+		std::lock_guard<std::mutex> lock(_inbox->mutex);
+		_inbox->restoreEvf = restoreEvf;
+	}
+
+	void addListener(const RecoveryListener& listener)
+	{
+		std::lock_guard<std::mutex> lock(_listenerMutex);
+		_listeners.push_back(listener);
+	}
+
+	bool start()
+	{
+		if(_running)
+		{
+			return true;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_inbox->mutex);
+			_inbox->stopping = false;
+		}
+
+		std::shared_ptr<Inbox> inbox = _inbox;
+		_manager.setShutdownHandler([inbox](const CameraSessionRef& session) {
+			sessionLost(inbox, session);
+		});
+		if(!Thread::start())
+		{
+			_manager.setShutdownHandler(SessionShutdownHandler());
+			return false;
+		}
+		_running = true;
+		return true;
+	}
+
+	// Sessions still being recovered are closed
+	void stop()
+	{
+		if(!_running)
+		{
+			return;
+		}
+		_running = false;
+
+		_manager.setShutdownHandler(SessionShutdownHandler());
+		{
+			std::lock_guard<std::mutex> lock(_inbox->mutex);
+			_inbox->stopping = true;
+			_inbox->wake.notify_all();
+		}
+		join();
+	}
+
+	bool isRunning() const						{ return _running; }
+
+	RECOVERY_STATISTICS getStatistics()
+	{
+		RECOVERY_STATISTICS stats;
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		stats.lost = _lost;
+		stats.recovered = _recovered;
+		stats.failed = _failed;
+		stats.recovering = _recovering;
+		stats.downtime = _downtime.snapshot();
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		_lost = 0;
+		_recovered = 0;
+		_failed = 0;
+		_downtime.reset();
+	}
+
+	virtual void run()
+	{
+		//When using the SDK from another thread in Windows,
+		// you must initialize the COM library by calling CoInitialize
+#ifdef _WIN32
+		CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+		Tracer::instance().setThreadName("Recovery");
+
+		std::vector<std::shared_ptr<Lost> > waiting;
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_inbox->mutex);
+				if(waiting.empty())
+				{
+					while(!_inbox->stopping && _inbox->lost.empty())
+					{
+						_inbox->wake.wait(lock);
+					}
+				}
+				else
+				{
+					_inbox->wake.wait_for(lock, std::chrono::milliseconds(_pollMillis));
+				}
+
+				// Taken in on stop as well, to be closed below
+				std::lock_guard<std::mutex> statistics(_statisticsMutex);
+				for(size_t i = 0; i < _inbox->lost.size(); i++)
+				{
+					// Downloads of the lost link cannot finish
+					CameraSession* session = _inbox->lost[i]->session.get();
+					session->getCameraController()->getTransferProcessor()->purge(session->getCameraModel());
+					waiting.push_back(_inbox->lost[i]);
+					_lost++;
+					_recovering++;
+				}
+				_inbox->lost.clear();
+
+				if(_inbox->stopping)
+				{
+					break;
+				}
+			}
+
+			for(size_t i = 0; i < waiting.size(); )
+			{
+				Lost& lost = *waiting[i];
+				std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+					std::chrono::microseconds((EdsInt64)_timeoutMillis * 1000 - (EdsInt64)(evfClockMicros() - lost.event.lostMicros));
+
+				EdsDeviceInfo deviceInfo;
+				lost.event.scans++;
+				EdsCameraRef camera = find(lost, deviceInfo);
+				if(camera != NULL)
+				{
+					lost.event.foundMicros = evfClockMicros();
+					finish(lost, recover(lost, camera, deviceInfo, deadline));
+					waiting.erase(waiting.begin() + i);
+				}
+				else if(std::chrono::steady_clock::now() >= deadline)
+				{
+					finish(lost, EDS_ERR_DEVICE_NOT_FOUND);
+					waiting.erase(waiting.begin() + i);
+				}
+				else
+				{
+					i++;
+				}
+			}
+		}
+
+		// Stopped with bodies still gone
+		for(size_t i = 0; i < waiting.size(); i++)
+		{
+			finish(*waiting[i], EDS_ERR_DEVICE_NOT_FOUND);
+		}
+
+#ifdef _WIN32
+		CoUninitialize();
+#endif
+	}
+};
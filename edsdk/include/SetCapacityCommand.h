@@ -33,6 +33,8 @@ public:
 		_capacity = capacity;
 	}
 
+	virtual const char* getName() const {return "SetCapacity";}
+
 	// Execute command	
 	virtual bool execute()
 	{
@@ -40,12 +42,17 @@ public:
 		EdsError err = EDS_ERR_OK;
 
 		//Acquisition of the number of sheets that can be taken a picture
-		err = EdsSetCapacity( _model->getCameraObject(), _capacity);
+		{
+			TraceScope trace("EDSDK", "EdsSetCapacity");
+			err = EdsSetCapacity( _model->getCameraObject(), _capacity);
+			trace.setArg("error", err);
+		}
 
 		//Notification of error
 		if(err != EDS_ERR_OK)
 		{
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
@@ -0,0 +1,163 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : SetPropertiesCommand.h                                          *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "Command.h"
+#include "CameraEvent.h"
+#include "EDSDK.h"
+#include "PropertyStore.h"
+#include "PropertyTraits.h"
+
+
+// One property of a settings transaction
+typedef struct _PROPERTY_SETTING
+{
+	EdsPropertyID	propertyID;
+	EdsUInt32		size;
+	unsigned char	data[PROPERTY_VALUE_MAX];
+	// EDS_ERR_OK once applied; busy while it still waits for a retry
+	EdsError		error;
+}PROPERTY_SETTING;
+
+typedef std::vector<PROPERTY_SETTING> PropertySettingList;
+
+template<typename T>
+PROPERTY_SETTING makePropertySetting(EdsPropertyID propertyID, const T& value)
+{
+	static_assert(sizeof(T) <= PROPERTY_VALUE_MAX, "property value too large");
+	PROPERTY_SETTING setting;
+	memset(&setting, 0, sizeof(setting));
+	setting.propertyID = propertyID;
+	setting.size = sizeof(T);
+	memcpy(setting.data, &value, sizeof(T));
+	setting.error = EDS_ERR_DEVICE_BUSY;
+	return setting;
+}
+
+
+// Sets several properties as one transaction: the UI lock is taken once,
+// the properties are set in order, and only those the camera answered busy
+// are set again, a few times while the lock is held and then on the
+// processor's retry. Other failures are final and reported once with the
+// first of them; the rest of the settings still go through.
+class SetPropertiesCommand : public Command
+{
+public:
+	enum { kLockedRetries = 4, kLockedRetryMillis = 10 };
+
+private:
+	PropertySettingList _settings;
+	// First failure that is not busy
+	EdsError			_failure;
+
+
+public:
+	SetPropertiesCommand(CameraModel *model, const PropertySettingList& settings)
+		:Command(model), _settings(settings), _failure(EDS_ERR_OK)
+	{
+		for(size_t i = 0; i < _settings.size(); i++)
+		{
+			_settings[i].error = EDS_ERR_DEVICE_BUSY;
+		}
+	}
+
+
+	virtual const char* getName() const {return "SetProperties";}
+
+	// Each setting's outcome so far
+	const PropertySettingList& getSettings() const {return _settings;}
+
+	// Execute command
+	virtual bool execute()
+	{
+		EdsError err = EDS_ERR_OK;
+		bool	 pending = false;
+
+		//UI lock, so the body does not change settings in between
+		err = _model->lockUI();
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+			return false;
+		}
+
+		for(int round = 0; err == EDS_ERR_OK && round <= kLockedRetries; round++)
+		{
+			if(round > 0)
+			{
+				if(!pending)
+				{
+					break;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(kLockedRetryMillis * round));
+			}
+
+			pending = false;
+			for(size_t i = 0; i < _settings.size(); i++)
+			{
+				PROPERTY_SETTING& setting = _settings[i];
+				if((setting.error & EDS_ERRORID_MASK) != EDS_ERR_DEVICE_BUSY)
+				{
+					continue;
+				}
+
+				TraceScope trace("EDSDK", "EdsSetPropertyData");
+				setting.error = EdsSetPropertyData(_model->getCameraObject(), setting.propertyID, 0, setting.size, setting.data);
+				trace.setArg("error", setting.error);
+				if((setting.error & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+				{
+					pending = true;
+				}
+				else if(setting.error != EDS_ERR_OK && _failure == EDS_ERR_OK)
+				{
+					_failure = setting.error;
+				}
+			}
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			_model->unlockUI();
+		}
+
+		// It retries the busy ones
+		if(pending)
+		{
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+			return false;
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = _failure;
+		}
+
+		//Notification of error
+		_error = err;
+		if(err != EDS_ERR_OK)
+		{
+			CameraEvent e(kCameraEvent_Error, &err);
+			_model->notifyObservers(&e);
+		}
+
+		return true;
+	}
+
+};
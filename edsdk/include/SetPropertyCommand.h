@@ -18,6 +18,7 @@
 #include "Command.h"
 #include "CameraEvent.h"
 #include "EDSDK.h"
+#include "PropertyTraits.h"
 
 template<typename T>
 class SetPropertyCommand : public Command
@@ -29,20 +30,26 @@ private:
 
 public:
 	SetPropertyCommand(CameraModel *model, EdsPropertyID propertyID, T data)
-		:_propertyID(propertyID), _data(data), Command(model){}
+		:Command(model), _propertyID(propertyID), _data(data){}
 
 
+	virtual const char* getName() const {return "SetProperty";}
+
 	// Execute command	
 	virtual bool execute()
 	{
 		EdsError err = EDS_ERR_OK;
 	
 		// Set property
-		err = EdsSetPropertyData(	_model->getCameraObject(),
-									_propertyID,
-									0,
-									sizeof(_data),
-									(EdsVoid *)&_data );
+		{
+			TraceScope trace("EDSDK", "EdsSetPropertyData");
+			err = EdsSetPropertyData(	_model->getCameraObject(),
+										_propertyID,
+										0,
+										sizeof(_data),
+										(EdsVoid *)&_data );
+			trace.setArg("error", err);
+		}
 
 
 
@@ -52,16 +59,26 @@ public:
 			// It retries it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
 		return true;
 	}
 
-};
\ No newline at end of file
+};
+
+
+// Type-checked: the value must have the property's C++ type
+template<EdsPropertyID propertyID>
+SetPropertyCommand<typename PropertyTraits<propertyID>::type>* newSetPropertyCommand(CameraModel *model, const typename PropertyTraits<propertyID>::type& data)
+{
+	return new SetPropertyCommand<typename PropertyTraits<propertyID>::type>(model, propertyID, data);
+}
\ No newline at end of file
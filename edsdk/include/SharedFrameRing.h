@@ -0,0 +1,625 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : SharedFrameRing.h                                               *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CameraModel.h"
+#include "DownloadSink.h"
+#include "EvfDecodePool.h"
+#include "EvfFrame.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include "EDSDK.h"
+
+
+// Frames handed to other processes through a named shared memory segment,
+// so a reader maps them in place instead of receiving a copy.
+//
+//   header | slot 0: slot header, payload | slot 1: ... | slot n-1
+//
+// One process writes and any number read. Frame n (counting from 1) goes to
+// slot (n - 1) % slotCount, overwriting the oldest. Each slot header starts
+// with a seqlock word that is odd while the slot is being written; a reader
+// notes it, uses the payload, and the data was intact if the word is
+// unchanged afterwards. Slots start on 64 byte boundaries. Fields are in the
+// byte order of the machine; the layout is mirrored in shared_frames.py.
+#define SHARED_FRAME_RING_MAGIC		"EDSRING"
+#define SHARED_FRAME_RING_VERSION	1
+
+enum SharedFrameKind
+{
+	kSharedFrameKind_None = 0,
+	kSharedFrameKind_EvfJpeg,		// the camera's live view JPEG
+	kSharedFrameKind_EvfImage,		// decoded live view pixels
+	kSharedFrameKind_Capture,		// a downloaded file as the camera stored it
+};
+
+typedef struct _SHARED_FRAME_RING_HEADER
+{
+	char					magic[8];
+	EdsUInt32				version;
+	EdsUInt32				headerSize;
+	EdsUInt32				slotCount;
+	EdsUInt32				slotHeaderSize;
+	EdsUInt64				slotSize;			// payload bytes a slot holds
+	EdsUInt64				slotStride;			// slot header and payload
+	std::atomic<EdsUInt64>	published;			// sequence of the newest complete frame
+	EdsUInt64				producerId;			// process id of the writer
+	EdsUInt64				createdMicros;
+	EdsUInt64				reserved[8];
+}SHARED_FRAME_RING_HEADER;
+
+typedef struct _SHARED_FRAME_INFO
+{
+	EdsUInt64				sequence;			// frame in this ring
+	EdsUInt64				sourceSequence;		// EvfFrame sequence or decode index
+	EdsUInt64				timeMicros;			// since the Unix epoch
+	EdsUInt64				length;				// payload bytes
+	EdsUInt32				kind;				// SharedFrameKind
+	EdsUInt32				format;				// JpegPixelFormat of an image
+	EdsInt32				width;
+	EdsInt32				height;
+	EdsInt32				stride;				// bytes per image row
+	EdsInt32				channels;
+	EdsUInt32				zoom;
+	EdsInt32				zoomRect[4];		// x, y, width, height
+	EdsInt32				imagePosition[2];	// x, y
+	EdsUInt32				reserved0;
+	char					name[64];			// file name of a capture
+	EdsUInt64				reserved[4];
+}SHARED_FRAME_INFO;
+
+typedef struct _SHARED_FRAME_SLOT
+{
+	std::atomic<EdsUInt64>	lock;				// seqlock, odd while written
+	SHARED_FRAME_INFO		info;
+}SHARED_FRAME_SLOT;
+
+// Readers in other languages rely on these
+static_assert(sizeof(SHARED_FRAME_RING_HEADER) == 128, "shared ring header layout");
+static_assert(sizeof(SHARED_FRAME_SLOT) == 192, "shared ring slot layout");
+
+
+typedef struct _SHARED_FRAME_RING_STATISTICS
+{
+	EdsUInt64	published;
+	EdsUInt64	bytes;				// payload bytes published
+	EdsUInt64	dropped;			// frames larger than a slot
+	EdsUInt64	aborted;			// captures whose download failed part way
+}SHARED_FRAME_RING_STATISTICS;
+
+
+// The writing side. Live view sinks straight into it as JPEG, decoded frames
+// arrive through publishDecoded() as an EvfDecodePool listener, and captures
+// through SharedFrameDownloadSink. Writes are serialised, and a capture holds
+// the ring for its whole download, so give captures a ring of their own
+// rather than sharing one with live view.
+class SharedFrameRing : public EvfFrameSink
+{
+public:
+	enum { kDefaultSlotCount = 4 };
+
+private:
+	MappedFile						_segment;
+	std::string						_name;
+	SHARED_FRAME_RING_HEADER*		_header;
+	std::mutex						_writeMutex;
+	SHARED_FRAME_SLOT*				_writing;
+	EdsUInt64						_writingSequence;
+	std::atomic<EdsUInt64>			_bytes;
+	std::atomic<EdsUInt64>			_dropped;
+	std::atomic<EdsUInt64>			_aborted;
+	mutable std::mutex				_mutex;
+
+	SharedFrameRing(const SharedFrameRing&);
+	SharedFrameRing& operator=(const SharedFrameRing&);
+
+	static EdsUInt64 align(EdsUInt64 offset)
+	{
+		return (offset + 63) & ~(EdsUInt64)63;
+	}
+
+	static EdsUInt64 nowMicros()
+	{
+		return (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	static EdsUInt64 processId()
+	{
+#ifdef _WIN32
+		return (EdsUInt64)GetCurrentProcessId();
+#else
+		return (EdsUInt64)getpid();
+#endif
+	}
+
+	SHARED_FRAME_SLOT* slotAt(EdsUInt64 sequence) const
+	{
+		return (SHARED_FRAME_SLOT*)(_segment.getData() + _header->headerSize
+			+ ((sequence - 1) % _header->slotCount) * _header->slotStride);
+	}
+
+	static void copyDataSet(SHARED_FRAME_SLOT* slot, const EvfFrame& frame)
+	{
+		EdsRect zoomRect = frame.getZoomRect();
+		EdsPoint position = frame.getImagePosition();
+		slot->info.sourceSequence = frame.getSequence();
+		slot->info.zoom = frame.getZoom();
+		slot->info.zoomRect[0] = zoomRect.point.x;
+		slot->info.zoomRect[1] = zoomRect.point.y;
+		slot->info.zoomRect[2] = zoomRect.size.width;
+		slot->info.zoomRect[3] = zoomRect.size.height;
+		slot->info.imagePosition[0] = position.x;
+		slot->info.imagePosition[1] = position.y;
+	}
+
+public:
+	SharedFrameRing() : _header(NULL), _writing(NULL), _writingSequence(0), _bytes(0), _dropped(0), _aborted(0) {}
+
+	virtual ~SharedFrameRing()
+	{
+		close();
+	}
+
+	// Creates the segment, replacing one a crashed writer left behind.
+	// slotSize is the largest payload a frame may have.
+	EdsError create(const char* name, EdsUInt64 slotSize, EdsUInt32 slotCount = kDefaultSlotCount)
+	{
+		std::lock_guard<std::mutex> write(_writeMutex);
+		std::lock_guard<std::mutex> lock(_mutex);
+		closeLocked();
+
+		if(name == NULL || *name == '\0' || slotSize == 0 || slotCount == 0)
+		{
+			return EDS_ERR_INVALID_PARAMETER;
+		}
+
+		EdsUInt64 headerSize = align(sizeof(SHARED_FRAME_RING_HEADER));
+		EdsUInt64 slotStride = align(sizeof(SHARED_FRAME_SLOT) + slotSize);
+		EdsError err = _segment.createShared(name, headerSize + slotStride * slotCount);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		// A new segment is all zeros, so every slot starts unwritten and even
+		_header = (SHARED_FRAME_RING_HEADER*)_segment.getData();
+		_header->version = SHARED_FRAME_RING_VERSION;
+		_header->headerSize = (EdsUInt32)headerSize;
+		_header->slotCount = slotCount;
+		_header->slotHeaderSize = sizeof(SHARED_FRAME_SLOT);
+		_header->slotSize = slotSize;
+		_header->slotStride = slotStride;
+		_header->producerId = processId();
+		_header->createdMicros = nowMicros();
+		_header->published.store(0, std::memory_order_relaxed);
+		// Readers check the magic last, once the rest is in place
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(_header->magic, SHARED_FRAME_RING_MAGIC, sizeof(_header->magic));
+
+		_name = name;
+		_bytes = 0;
+		_dropped = 0;
+		_aborted = 0;
+		return EDS_ERR_OK;
+	}
+
+	// Removes the segment; readers keep what they have mapped
+	void close()
+	{
+		std::lock_guard<std::mutex> write(_writeMutex);
+		std::lock_guard<std::mutex> lock(_mutex);
+		closeLocked();
+	}
+
+	bool isOpen() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _header != NULL;
+	}
+
+	std::string getName() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _name;
+	}
+
+	EdsUInt64 getSlotSize() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _header != NULL ? _header->slotSize : 0;
+	}
+
+	EdsUInt32 getSlotCount() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _header != NULL ? _header->slotCount : 0;
+	}
+
+	SHARED_FRAME_RING_STATISTICS getStatistics() const
+	{
+		SHARED_FRAME_RING_STATISTICS stats = {};
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_header != NULL)
+		{
+			stats.published = _header->published.load(std::memory_order_relaxed);
+		}
+		stats.bytes = _bytes.load();
+		stats.dropped = _dropped.load();
+		stats.aborted = _aborted.load();
+		return stats;
+	}
+
+	// Claims the slot of the next frame and marks it as being written. The
+	// returned slot's metadata and payload belong to the caller until
+	// commit() or abort(), which must come from the same thread. NULL if the
+	// ring is closed or length will not fit; pass 0 when it is not known yet.
+	SHARED_FRAME_SLOT* begin(SharedFrameKind kind, EdsUInt64 length = 0)
+	{
+		_writeMutex.lock();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_header == NULL || length > _header->slotSize)
+			{
+				if(_header != NULL)
+				{
+					_dropped++;
+				}
+				_writeMutex.unlock();
+				return NULL;
+			}
+		}
+
+		_writingSequence = _header->published.load(std::memory_order_relaxed) + 1;
+		_writing = slotAt(_writingSequence);
+		_writing->lock.store(_writing->lock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		_writing->info.sequence = _writingSequence;
+		_writing->info.sourceSequence = 0;
+		_writing->info.timeMicros = nowMicros();
+		_writing->info.length = 0;
+		_writing->info.kind = kind;
+		_writing->info.format = 0;
+		_writing->info.width = 0;
+		_writing->info.height = 0;
+		_writing->info.stride = 0;
+		_writing->info.channels = 0;
+		_writing->info.zoom = 0;
+		memset(_writing->info.zoomRect, 0, sizeof(_writing->info.zoomRect));
+		memset(_writing->info.imagePosition, 0, sizeof(_writing->info.imagePosition));
+		memset(_writing->info.name, 0, sizeof(_writing->info.name));
+		return _writing;
+	}
+
+	unsigned char* getPayload(SHARED_FRAME_SLOT* slot) const
+	{
+		return (unsigned char*)slot + _header->slotHeaderSize;
+	}
+
+	// Appends to the payload of the slot being written; false if it does
+	// not fit
+	bool append(const void* data, EdsUInt64 length)
+	{
+		if(_writing == NULL || _writing->info.length + length > _header->slotSize)
+		{
+			return false;
+		}
+		memcpy(getPayload(_writing) + _writing->info.length, data, (size_t)length);
+		_writing->info.length += length;
+		return true;
+	}
+
+	void commit()
+	{
+		if(_writing == NULL)
+		{
+			return;
+		}
+		_bytes += _writing->info.length;
+		_writing->lock.store(_writing->lock.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		_header->published.store(_writingSequence, std::memory_order_release);
+		_writing = NULL;
+		_writeMutex.unlock();
+	}
+
+	// Leaves the slot empty. The frame it held before is lost either way.
+	void abort()
+	{
+		if(_writing == NULL)
+		{
+			return;
+		}
+		_writing->info.kind = kSharedFrameKind_None;
+		_writing->info.length = 0;
+		_writing->info.sequence = 0;
+		_writing->lock.store(_writing->lock.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		_writing = NULL;
+		_aborted++;
+		_writeMutex.unlock();
+	}
+
+	// EvfFrameSink: the JPEG as the camera sent it
+	virtual void onEvfFrame(const EvfFrameRef& frame)
+	{
+		if(!frame)
+		{
+			return;
+		}
+		TraceScope trace("Evf", "SharedPublish");
+		SHARED_FRAME_SLOT* slot = begin(kSharedFrameKind_EvfJpeg, frame->getLength());
+		if(slot == NULL)
+		{
+			return;
+		}
+		copyDataSet(slot, *frame);
+		append(frame->getData(), frame->getLength());
+		commit();
+	}
+
+	// For EvfDecodePool::addListener: the decoded pixels, rows packed as the
+	// decoder left them
+	void publishDecoded(const DecodedEvfFrameRef& decoded)
+	{
+		if(!decoded || !decoded->image)
+		{
+			return;
+		}
+		const DecodedImage& image = *decoded->image;
+		EdsUInt64 length = (EdsUInt64)image.getStride() * image.getHeight();
+		TraceScope trace("Evf", "SharedPublishDecoded");
+		SHARED_FRAME_SLOT* slot = begin(kSharedFrameKind_EvfImage, length);
+		if(slot == NULL)
+		{
+			return;
+		}
+		if(decoded->frame)
+		{
+			copyDataSet(slot, *decoded->frame);
+		}
+		slot->info.sourceSequence = decoded->index;
+		slot->info.format = image.getFormat();
+		slot->info.width = image.getWidth();
+		slot->info.height = image.getHeight();
+		slot->info.stride = image.getStride();
+		slot->info.channels = image.getChannels();
+		append(image.getPixels(), length);
+		commit();
+	}
+
+private:
+	void closeLocked()
+	{
+		if(_header != NULL)
+		{
+			_segment.close();
+			_header = NULL;
+		}
+		_name.clear();
+	}
+};
+
+// Streams each downloaded file into a ring as its chunks arrive. A file
+// larger than a slot is skipped and counted as dropped, without failing the
+// download for the other sinks. The ring must outlive the sink.
+class SharedFrameDownloadSink : public DownloadSink
+{
+private:
+	SharedFrameRing*		_ring;
+	SHARED_FRAME_SLOT*		_slot;
+
+public:
+	SharedFrameDownloadSink(SharedFrameRing* ring) : _ring(ring), _slot(NULL) {}
+
+	virtual ~SharedFrameDownloadSink()
+	{
+		if(_slot != NULL)
+		{
+			_ring->abort();
+		}
+	}
+
+	SharedFrameRing* getRing() const			{ return _ring; }
+
+	virtual bool begin(CameraModel*, const EdsDirectoryItemInfo& info)
+	{
+		_slot = _ring->begin(kSharedFrameKind_Capture, info.size);
+		if(_slot != NULL)
+		{
+			strncpy(_slot->info.name, info.szFileName, sizeof(_slot->info.name) - 1);
+			_slot->info.format = info.format;
+		}
+		return true;
+	}
+
+	virtual bool write(const unsigned char* data, size_t length)
+	{
+		if(_slot != NULL && !_ring->append(data, length))
+		{
+			_ring->abort();
+			_slot = NULL;
+		}
+		return true;
+	}
+
+	virtual void end(bool success)
+	{
+		if(_slot == NULL)
+		{
+			return;
+		}
+		if(success)
+		{
+			_ring->commit();
+		}
+		else
+		{
+			_ring->abort();
+		}
+		_slot = NULL;
+	}
+};
+
+
+// A frame as a reader sees it: the slot's metadata copied out, the payload
+// left in place. The payload may be overwritten once the writer laps the
+// ring, so check isValid() after using it, or copy() it.
+typedef struct _SHARED_FRAME_VIEW
+{
+	SHARED_FRAME_INFO			info;
+	EdsUInt64					lock;		// seqlock word when it was read
+	const unsigned char*		data;
+	const SHARED_FRAME_SLOT*	slot;
+}SHARED_FRAME_VIEW;
+
+
+// The reading side, in the same or another process. Nothing it does blocks
+// the writer.
+class SharedFrameReader
+{
+private:
+	MappedFile							_segment;
+	const SHARED_FRAME_RING_HEADER*		_header;
+
+	SharedFrameReader(const SharedFrameReader&);
+	SharedFrameReader& operator=(const SharedFrameReader&);
+
+	const SHARED_FRAME_SLOT* slotAt(EdsUInt64 sequence) const
+	{
+		return (const SHARED_FRAME_SLOT*)(_segment.getData() + _header->headerSize
+			+ ((sequence - 1) % _header->slotCount) * _header->slotStride);
+	}
+
+public:
+	SharedFrameReader() : _header(NULL) {}
+
+	EdsError open(const char* name)
+	{
+		close();
+		EdsError err = _segment.openShared(name);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		const SHARED_FRAME_RING_HEADER* header = (const SHARED_FRAME_RING_HEADER*)_segment.getData();
+		if(_segment.getSize() < sizeof(SHARED_FRAME_RING_HEADER)
+			|| memcmp(header->magic, SHARED_FRAME_RING_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != SHARED_FRAME_RING_VERSION
+			|| _segment.getSize() < header->headerSize + header->slotStride * header->slotCount)
+		{
+			_segment.close();
+			return EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		_header = header;
+		return EDS_ERR_OK;
+	}
+
+	void close()
+	{
+		_segment.close();
+		_header = NULL;
+	}
+
+	bool isOpen() const						{ return _header != NULL; }
+	EdsUInt32 getSlotCount() const			{ return _header != NULL ? _header->slotCount : 0; }
+	EdsUInt64 getSlotSize() const			{ return _header != NULL ? _header->slotSize : 0; }
+	EdsUInt64 getProducerId() const			{ return _header != NULL ? _header->producerId : 0; }
+
+	// Sequence of the newest complete frame, 0 before the first
+	EdsUInt64 getPublished() const
+	{
+		return _header != NULL ? _header->published.load(std::memory_order_acquire) : 0;
+	}
+
+	// False if sequence was overwritten, not written yet or is being written
+	bool read(EdsUInt64 sequence, SHARED_FRAME_VIEW& view) const
+	{
+		if(_header == NULL || sequence == 0 || sequence > getPublished())
+		{
+			return false;
+		}
+		const SHARED_FRAME_SLOT* slot = slotAt(sequence);
+		EdsUInt64 word = slot->lock.load(std::memory_order_acquire);
+		if(word & 1)
+		{
+			return false;
+		}
+		view.info = slot->info;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(slot->lock.load(std::memory_order_relaxed) != word || view.info.sequence != sequence
+			|| view.info.length > _header->slotSize)
+		{
+			return false;
+		}
+		view.lock = word;
+		view.data = (const unsigned char*)slot + _header->slotHeaderSize;
+		view.slot = slot;
+		return true;
+	}
+
+	bool latest(SHARED_FRAME_VIEW& view) const
+	{
+		// Retry once in case the writer moved on between the two reads
+		for(int attempt = 0; attempt < 2; attempt++)
+		{
+			if(read(getPublished(), view))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Waits up to timeoutMillis (-1 for ever) for a frame newer than
+	// sequence and reads the newest one
+	bool wait(EdsUInt64 sequence, SHARED_FRAME_VIEW& view, int timeoutMillis = -1) const
+	{
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+		while(_header != NULL)
+		{
+			if(getPublished() > sequence && latest(view))
+			{
+				return true;
+			}
+			if(timeoutMillis >= 0 && std::chrono::steady_clock::now() >= deadline)
+			{
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	// True while the writer has not touched the slot since view was read
+	static bool isValid(const SHARED_FRAME_VIEW& view)
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return view.slot != NULL
+			&& view.slot->lock.load(std::memory_order_relaxed) == view.lock;
+	}
+
+	// The payload copied out, or false if it changed while copying
+	static bool copy(const SHARED_FRAME_VIEW& view, std::vector<unsigned char>& out)
+	{
+		out.assign(view.data, view.data + view.info.length);
+		return isValid(view);
+	}
+};
@@ -0,0 +1,106 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : Sharpness.h                                                     *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include "JpegDecoder.h"
+#include "EDSDK.h"
+
+
+enum FocusMetric
+{
+	// Mean squared Sobel gradient
+	kFocusMetric_Tenengrad = 0,
+	// Variance of the 4-neighbour Laplacian
+	kFocusMetric_LaplacianVariance,
+};
+
+
+// Contrast scores of 8-bit gray pixels; larger is sharper. The border pixels
+// are not scored. Inner loops are branch-free integer code over three row
+// pointers so the compiler vectorizes them; a row's sums fit in 64 bits for
+// any live view width.
+inline double tenengradSharpness(const unsigned char* pixels, int width, int height, int stride)
+{
+	if(pixels == NULL || width < 3 || height < 3)
+	{
+		return 0.0;
+	}
+
+	EdsUInt64 sum = 0;
+	for(int y = 1; y < height - 1; y++)
+	{
+		const unsigned char* above = pixels + (size_t)stride * (y - 1);
+		const unsigned char* row = above + stride;
+		const unsigned char* below = row + stride;
+
+		EdsInt64 rowSum = 0;
+		for(int x = 1; x < width - 1; x++)
+		{
+			int gx = (above[x + 1] + 2 * row[x + 1] + below[x + 1]) - (above[x - 1] + 2 * row[x - 1] + below[x - 1]);
+			int gy = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+			rowSum += gx * gx + gy * gy;
+		}
+		sum += (EdsUInt64)rowSum;
+	}
+	return (double)sum / ((double)(width - 2) * (height - 2));
+}
+
+inline double laplacianVarianceSharpness(const unsigned char* pixels, int width, int height, int stride)
+{
+	if(pixels == NULL || width < 3 || height < 3)
+	{
+		return 0.0;
+	}
+
+	EdsInt64 sum = 0;
+	EdsUInt64 sumSquares = 0;
+	for(int y = 1; y < height - 1; y++)
+	{
+		const unsigned char* above = pixels + (size_t)stride * (y - 1);
+		const unsigned char* row = above + stride;
+		const unsigned char* below = row + stride;
+
+		EdsInt64 rowSum = 0;
+		EdsInt64 rowSquares = 0;
+		for(int x = 1; x < width - 1; x++)
+		{
+			int laplacian = above[x] + below[x] + row[x - 1] + row[x + 1] - 4 * row[x];
+			rowSum += laplacian;
+			rowSquares += laplacian * laplacian;
+		}
+		sum += rowSum;
+		sumSquares += (EdsUInt64)rowSquares;
+	}
+
+	double count = (double)(width - 2) * (height - 2);
+	double mean = sum / count;
+	return sumSquares / count - mean * mean;
+}
+
+inline double computeSharpness(const unsigned char* pixels, int width, int height, int stride, FocusMetric metric)
+{
+	switch(metric)
+	{
+		case kFocusMetric_LaplacianVariance:	return laplacianVarianceSharpness(pixels, width, height, stride);
+		default:								return tenengradSharpness(pixels, width, height, stride);
+	}
+}
+
+// Gray images only; decode with kJpegPixelFormat_Gray, which for live view
+// JPEGs just skips the chroma planes.
+inline double computeSharpness(const DecodedImage& image, FocusMetric metric)
+{
+	if(image.getFormat() != kJpegPixelFormat_Gray)
+	{
+		return 0.0;
+	}
+	return computeSharpness(image.getPixels(), image.getWidth(), image.getHeight(), image.getStride(), metric);
+}
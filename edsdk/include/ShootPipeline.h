@@ -0,0 +1,558 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ShootPipeline.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EDSDK.h"
+#include "Thread.h"
+#include "CameraController.h"
+#include "CapturedImage.h"
+#include "JpegDecoder.h"
+#include "Metrics.h"
+#include "RawDevelopPool.h"
+#include "TakePictureCommand.h"
+#include "Trace.h"
+
+
+// Files a shot is complete with
+enum ShotFiles
+{
+	kShotFiles_Jpeg = 0x01,
+	kShotFiles_Raw = 0x02,
+	kShotFiles_RawJpeg = kShotFiles_Jpeg | kShotFiles_Raw
+};
+
+// evfClockMicros() times of one shot; stages it never went through stay 0.
+// Transfer times are those of the JPEG, or of the RAW without one.
+typedef struct _SHOT_TIMING
+{
+	EdsUInt64	requestMicros;			// shoot()
+	EdsUInt64	releaseMicros;			// the release command returned
+	EdsUInt64	transferRequestMicros;	// DirItemRequestTransfer
+	EdsUInt64	downloadStartMicros;
+	EdsUInt64	downloadEndMicros;
+	EdsUInt64	decodeStartMicros;
+	EdsUInt64	decodeEndMicros;
+	EdsUInt64	completeMicros;
+}SHOT_TIMING;
+
+typedef struct _SHOOT_PIPELINE_STATISTICS
+{
+	EdsUInt64			shots;
+	EdsUInt64			completed;
+	EdsUInt64			failed;
+	EdsUInt32			inFlight;
+	EdsUInt32			maxInFlight;		// most shots in flight at once
+	LATENCY_SNAPSHOT	shutterLag;			// shoot() to release
+	LATENCY_SNAPSHOT	transferWait;		// release to transfer request
+	LATENCY_SNAPSHOT	transfer;			// transfer request to download end
+	LATENCY_SNAPSHOT	decode;
+	LATENCY_SNAPSHOT	total;				// shoot() to complete
+	double				shotsPerSecond;		// first shoot() to last completion
+}SHOOT_PIPELINE_STATISTICS;
+
+
+// Outcome of one shoot(), filled in as its files come in
+class ShotFuture
+{
+private:
+	std::mutex				_mutex;
+	std::condition_variable	_done;
+	bool					_complete;
+	EdsError				_error;
+	EdsUInt64				_index;
+	EdsUInt32				_missing;		// kShotFiles_ still to come
+	CapturedImageRef		_jpeg;
+	CapturedImageRef		_raw;
+	DecodedImageRef			_decoded;
+	SHOT_TIMING				_timing;
+
+	ShotFuture(const ShotFuture&);
+	ShotFuture& operator=(const ShotFuture&);
+
+	friend class ShootPipeline;
+
+public:
+	ShotFuture(EdsUInt64 index, EdsUInt32 files) : _complete(false), _error(EDS_ERR_OK), _index(index), _missing(files)
+	{
+		memset(&_timing, 0, sizeof(_timing));
+		_timing.requestMicros = evfClockMicros();
+	}
+
+	// Block until complete or failed; negative waits forever. False on timeout.
+	bool wait(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if(millisec < 0)
+		{
+			_done.wait(lock, [this]() { return _complete; });
+			return true;
+		}
+		return _done.wait_for(lock, std::chrono::milliseconds(millisec), [this]() { return _complete; });
+	}
+
+	// Block until the release command has run, or the shot failed before
+	bool waitReleased(int millisec)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		std::function<bool()> released = [this]() { return _complete || _timing.releaseMicros != 0; };
+		if(millisec < 0)
+		{
+			_done.wait(lock, released);
+			return true;
+		}
+		return _done.wait_for(lock, std::chrono::milliseconds(millisec), released);
+	}
+
+	bool isDone()								{ std::lock_guard<std::mutex> lock(_mutex); return _complete; }
+	EdsError getError()							{ std::lock_guard<std::mutex> lock(_mutex); return _error; }
+	// Order of shoot() calls, from 1
+	EdsUInt64 getIndex() const					{ return _index; }
+	CapturedImageRef getJpeg()					{ std::lock_guard<std::mutex> lock(_mutex); return _jpeg; }
+	CapturedImageRef getRaw()					{ std::lock_guard<std::mutex> lock(_mutex); return _raw; }
+	// Pixels of the JPEG; empty when decoding is off or failed
+	DecodedImageRef getDecoded()				{ std::lock_guard<std::mutex> lock(_mutex); return _decoded; }
+	SHOT_TIMING getTiming()						{ std::lock_guard<std::mutex> lock(_mutex); return _timing; }
+};
+
+typedef std::shared_ptr<ShotFuture> ShotFutureRef;
+
+
+// Trigger, transfer and decode of captures as one pipeline.
+//
+// shoot() releases the shutter and returns at once with a future for the
+// shot. The model downloads to memory; each file is matched to the oldest
+// shot still waiting for a file of its kind and the JPEG is decoded on a
+// worker, so several shots can be in flight and the camera's buffer, not
+// this side, sets the pace. Files nobody shot for (the camera's own
+// button) go on to the CaptureQueue. Takes the queue's tap while attached.
+class ShootPipeline : public std::enable_shared_from_this<ShootPipeline>
+{
+public:
+	enum { kDefaultWorkerCount = 2, kDefaultMaxInFlight = 4 };
+
+private:
+	class Worker : public Thread
+	{
+	private:
+		ShootPipeline*	_pipeline;
+	public:
+		Worker(ShootPipeline* pipeline) : _pipeline(pipeline) {}
+		virtual void run() { _pipeline->work(); }
+	};
+
+	CameraController*						_controller;
+	EdsUInt32								_workerCount;
+	EdsUInt32								_files;
+	EdsUInt32								_maxInFlight;
+	bool									_autoFocus;
+	bool									_decode;
+	JpegPixelFormat							_format;
+	int										_scale;
+	DownloadTarget							_previousTarget;
+
+	std::vector<std::unique_ptr<Worker> >	_workers;
+	bool									_running;
+
+	// Shots released or about to be, waiting for their files
+	std::deque<ShotFutureRef>				_pending;
+	EdsUInt32								_inFlight;
+	EdsUInt64								_nextIndex;
+	std::mutex								_mutex;
+	std::condition_variable					_slot;
+
+	std::deque<ShotFutureRef>				_jobs;
+	std::condition_variable					_jobCondition;
+
+	SHOOT_PIPELINE_STATISTICS				_stats;
+	EdsUInt64								_firstShotMicros;
+	EdsUInt64								_lastCompleteMicros;
+	LatencyHistogram						_shutterLag;
+	LatencyHistogram						_transferWait;
+	LatencyHistogram						_transfer;
+	LatencyHistogram						_decodeLatency;
+	LatencyHistogram						_total;
+
+	ShootPipeline(const ShootPipeline&);
+	ShootPipeline& operator=(const ShootPipeline&);
+
+	static EdsUInt64 since(EdsUInt64 from, EdsUInt64 to)
+	{
+		return (from != 0 && to > from) ? to - from : 0;
+	}
+
+	// Called with _mutex held
+	void finish(const ShotFutureRef& shot, EdsError error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(shot->_mutex);
+			if(shot->_complete)
+			{
+				return;
+			}
+			shot->_complete = true;
+			shot->_error = error;
+			shot->_timing.completeMicros = evfClockMicros();
+
+			const SHOT_TIMING& t = shot->_timing;
+			if(error == EDS_ERR_OK)
+			{
+				_shutterLag.record(since(t.requestMicros, t.releaseMicros));
+				_transferWait.record(since(t.releaseMicros, t.transferRequestMicros));
+				_transfer.record(since(t.transferRequestMicros, t.downloadEndMicros));
+				if(t.decodeStartMicros != 0)
+				{
+					_decodeLatency.record(since(t.decodeStartMicros, t.decodeEndMicros));
+				}
+				_total.record(since(t.requestMicros, t.completeMicros));
+				_stats.completed++;
+			}
+			else
+			{
+				_stats.failed++;
+			}
+			_lastCompleteMicros = t.completeMicros;
+		}
+		shot->_done.notify_all();
+
+		_inFlight--;
+		_slot.notify_all();
+	}
+
+	// Called with _mutex held
+	void removePending(const ShotFutureRef& shot)
+	{
+		for(std::deque<ShotFutureRef>::iterator it = _pending.begin(); it != _pending.end(); ++it)
+		{
+			if(*it == shot)
+			{
+				_pending.erase(it);
+				return;
+			}
+		}
+	}
+
+	// On the processor thread once the release has run
+	void released(const ShotFutureRef& shot, EdsError error)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		{
+			std::lock_guard<std::mutex> shotLock(shot->_mutex);
+			shot->_timing.releaseMicros = evfClockMicros();
+		}
+		if(error != EDS_ERR_OK)
+		{
+			removePending(shot);
+			finish(shot, error);
+		}
+		shot->_done.notify_all();
+	}
+
+	// On the transfer thread. True when a shot took the image.
+	bool take(const CapturedImageRef& image)
+	{
+		EdsUInt32 kind = RawDevelopPool::isRawFile(image->getFileName()) ? kShotFiles_Raw : kShotFiles_Jpeg;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(std::deque<ShotFutureRef>::iterator it = _pending.begin(); it != _pending.end(); ++it)
+		{
+			ShotFutureRef shot = *it;
+			bool complete = false;
+			{
+				std::lock_guard<std::mutex> shotLock(shot->_mutex);
+				if(!(shot->_missing & kind))
+				{
+					continue;
+				}
+				shot->_missing &= ~kind;
+				complete = (shot->_missing == 0);
+
+				if(kind == kShotFiles_Jpeg)
+				{
+					shot->_jpeg = image;
+				}
+				else
+				{
+					shot->_raw = image;
+				}
+				if(kind == kShotFiles_Jpeg || !(_files & kShotFiles_Jpeg))
+				{
+					const CAPTURE_TIMING& timing = image->getTiming();
+					shot->_timing.transferRequestMicros = timing.requestMicros;
+					shot->_timing.downloadStartMicros = timing.downloadStartMicros;
+					shot->_timing.downloadEndMicros = timing.downloadEndMicros;
+				}
+			}
+
+			if(complete)
+			{
+				_pending.erase(it);
+				if(_decode && (_files & kShotFiles_Jpeg) && _running)
+				{
+					_jobs.push_back(shot);
+					_jobCondition.notify_one();
+				}
+				else
+				{
+					finish(shot, EDS_ERR_OK);
+				}
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void work()
+	{
+		Tracer::instance().setThreadName("ShootDecode");
+		JpegDecoder decoder;
+
+		for(;;)
+		{
+			ShotFutureRef shot;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_jobCondition.wait(lock, [this]() { return !_running || !_jobs.empty(); });
+				if(_jobs.empty())
+				{
+					return;
+				}
+				shot = _jobs.front();
+				_jobs.pop_front();
+			}
+
+			CapturedImageRef jpeg = shot->getJpeg();
+			DecodedImageRef decoded = std::make_shared<DecodedImage>();
+			EdsUInt64 start = evfClockMicros();
+			bool ok;
+			{
+				TraceScope trace("Shoot", "decode");
+				ok = decoder.decode(jpeg->getData(), (size_t)jpeg->getLength(), *decoded, _format, _scale);
+			}
+			EdsUInt64 end = evfClockMicros();
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			{
+				std::lock_guard<std::mutex> shotLock(shot->_mutex);
+				shot->_timing.decodeStartMicros = start;
+				shot->_timing.decodeEndMicros = end;
+				if(ok)
+				{
+					shot->_decoded = decoded;
+				}
+			}
+			finish(shot, ok ? EDS_ERR_OK : EDS_ERR_FILE_FORMAT_UNRECOGNIZED);
+		}
+	}
+
+public:
+	// files tells which files each shot waits for. Without libjpeg, or
+	// with decode off, shots complete with the JPEG bytes alone.
+	ShootPipeline(CameraController* controller, EdsUInt32 files = kShotFiles_Jpeg, EdsUInt32 workerCount = kDefaultWorkerCount)
+		: _controller(controller), _workerCount(workerCount > 0 ? workerCount : 1),
+		  _files((files & kShotFiles_RawJpeg) != 0 ? (files & kShotFiles_RawJpeg) : (EdsUInt32)kShotFiles_Jpeg),
+		  _maxInFlight(kDefaultMaxInFlight), _autoFocus(true), _decode(JpegDecoder::isAvailable()), _format(kJpegPixelFormat_RGB), _scale(1),
+		  _previousTarget(kDownloadTarget_File), _running(false), _inFlight(0), _nextIndex(0),
+		  _stats(), _firstShotMicros(0), _lastCompleteMicros(0)
+	{
+	}
+
+	virtual ~ShootPipeline()
+	{
+		stop();
+	}
+
+	// Set before start()
+	void setDecode(bool decode)						{ _decode = decode && JpegDecoder::isAvailable(); }
+	void setPixelFormat(JpegPixelFormat format)		{ _format = format; }
+	// 1, 2, 4 or 8 to decode at a fraction of the size
+	void setScale(int scaleDenom)					{ _scale = JpegDecoder::isValidScale(scaleDenom) ? scaleDenom : 1; }
+
+	// shoot() waits while this many shots are in flight
+	void setMaxInFlight(EdsUInt32 maxInFlight)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_maxInFlight = (maxInFlight > 0) ? maxInFlight : 1;
+		_slot.notify_all();
+	}
+
+	// Off releases with ShutterButton_Completely_NonAF, for manual focus
+	void setAutoFocus(bool autoFocus)				{ std::lock_guard<std::mutex> lock(_mutex); _autoFocus = autoFocus; }
+	bool getAutoFocus()								{ std::lock_guard<std::mutex> lock(_mutex); return _autoFocus; }
+
+	EdsUInt32 getFiles() const						{ return _files; }
+	bool getDecode() const							{ return _decode; }
+
+	bool isRunning()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _running;
+	}
+
+	// Switches the model to memory downloads until stop()
+	bool start()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_running)
+		{
+			return true;
+		}
+
+		_running = true;
+		for(EdsUInt32 i = 0; i < _workerCount && _decode; i++)
+		{
+			std::unique_ptr<Worker> worker(new Worker(this));
+			if(worker->start())
+			{
+				_workers.push_back(std::move(worker));
+			}
+		}
+		if(_decode && _workers.empty())
+		{
+			_running = false;
+			return false;
+		}
+
+		CameraModel* model = _controller->getCameraModel();
+		_previousTarget = model->getDownloadTarget();
+		model->setDownloadTarget(kDownloadTarget_Memory);
+
+		std::weak_ptr<ShootPipeline> pipeline(shared_from_this());
+		model->getCaptureQueue()->setTap([pipeline](const CapturedImageRef& image)
+		{
+			std::shared_ptr<ShootPipeline> owner = pipeline.lock();
+			return owner && owner->take(image);
+		});
+		return true;
+	}
+
+	// Shots still in flight fail with EDS_ERR_OPERATION_CANCELLED
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(!_running)
+			{
+				return;
+			}
+			_running = false;
+
+			CameraModel* model = _controller->getCameraModel();
+			model->getCaptureQueue()->setTap(CaptureTap());
+			model->setDownloadTarget(_previousTarget);
+		}
+		_jobCondition.notify_all();
+
+		for(size_t i = 0; i < _workers.size(); i++)
+		{
+			_workers[i]->join();
+		}
+		_workers.clear();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		while(!_pending.empty())
+		{
+			ShotFutureRef shot = _pending.front();
+			_pending.pop_front();
+			finish(shot, EDS_ERR_OPERATION_CANCELLED);
+		}
+		while(!_jobs.empty())
+		{
+			ShotFutureRef shot = _jobs.front();
+			_jobs.pop_front();
+			finish(shot, EDS_ERR_OPERATION_CANCELLED);
+		}
+		_slot.notify_all();
+	}
+
+	// Release the shutter. Waits up to millisec for a shot in flight to
+	// finish first when there are max in flight, negative forever; empty on
+	// timeout or when stopped.
+	ShotFutureRef shoot(int millisec = -1)
+	{
+		ShotFutureRef shot;
+		bool autoFocus = true;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			std::function<bool()> ready = [this]() { return !_running || _inFlight < _maxInFlight; };
+			if(millisec < 0)
+			{
+				_slot.wait(lock, ready);
+			}
+			else if(!_slot.wait_for(lock, std::chrono::milliseconds(millisec), ready))
+			{
+				return ShotFutureRef();
+			}
+			if(!_running)
+			{
+				return ShotFutureRef();
+			}
+
+			shot = std::make_shared<ShotFuture>(++_nextIndex, _files);
+			_pending.push_back(shot);
+			_inFlight++;
+			_stats.shots++;
+			if(_inFlight > _stats.maxInFlight)
+			{
+				_stats.maxInFlight = _inFlight;
+			}
+			if(_firstShotMicros == 0)
+			{
+				_firstShotMicros = shot->_timing.requestMicros;
+			}
+			autoFocus = _autoFocus;
+		}
+
+		// The handle exists before the command is queued, so the completion
+		// can read its error
+		Command* command = new TakePictureCommand(_controller->getCameraModel(), autoFocus);
+		CommandHandleRef handle = command->getHandle();
+		std::weak_ptr<ShootPipeline> pipeline(shared_from_this());
+		std::weak_ptr<CommandHandle> weakHandle(handle);
+		_controller->enqueue(command, [pipeline, shot, weakHandle](bool executed)
+		{
+			std::shared_ptr<ShootPipeline> owner = pipeline.lock();
+			CommandHandleRef commandHandle = weakHandle.lock();
+			if(owner)
+			{
+				EdsError err = commandHandle ? commandHandle->getError() : EDS_ERR_OK;
+				owner->released(shot, executed ? err : EDS_ERR_OPERATION_CANCELLED);
+			}
+		});
+		return shot;
+	}
+
+	SHOOT_PIPELINE_STATISTICS getStatistics()
+	{
+		SHOOT_PIPELINE_STATISTICS stats;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			stats = _stats;
+			stats.inFlight = _inFlight;
+			EdsUInt64 elapsed = since(_firstShotMicros, _lastCompleteMicros);
+			stats.shotsPerSecond = (elapsed > 0) ? stats.completed * 1000000.0 / elapsed : 0.0;
+		}
+		stats.shutterLag = _shutterLag.snapshot();
+		stats.transferWait = _transferWait.snapshot();
+		stats.transfer = _transfer.snapshot();
+		stats.decode = _decodeLatency.snapshot();
+		stats.total = _total.snapshot();
+		return stats;
+	}
+};
+
+typedef std::shared_ptr<ShootPipeline> ShootPipelineRef;
@@ -18,6 +18,7 @@
 #include "Command.h"
 #include "CameraEvent.h"
 #include "EDSDK.h"
+#include "GetPropertyCommand.h"
 
 
 
@@ -27,22 +28,36 @@ class StartEvfCommand : public Command
 public:
 	StartEvfCommand(CameraModel *model) : Command(model){}
 
+	virtual const char* getName() const {return "StartEvf";}
+
     // Execute command	
 	virtual bool execute()
 	{
 		EdsError err = EDS_ERR_OK;
 
+		// A lazy session may not have read these yet: read them here rather
+		// than wait for the queue
+		if(_model->getStartupMode() == kStartupMode_Lazy)
+		{
+			err = readAhead(kEdsPropID_Evf_Mode);
+			if(err == EDS_ERR_OK)
+			{
+				err = readAhead(kEdsPropID_Evf_OutputDevice);
+			}
+		}
 
 		/// Change settings because live view cannot be started
 		/// when camera settings are set to gdo not perform live view.h
 		EdsUInt32 evfMode = _model->getEvfMode();
 		
-		if(evfMode == 0)
+		if(err == EDS_ERR_OK && evfMode == 0)
 		{
 			evfMode = 1;
 
 			// Set to the camera.
+			TraceScope trace("EDSDK", "EdsSetPropertyData");
 			err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_Evf_Mode, 0, sizeof(evfMode), &evfMode);
+			trace.setArg("error", err);
 		}
 			
 
@@ -55,7 +70,9 @@ public:
 			device |= kEdsEvfOutputDevice_PC;
 
 			// Set to the camera.
+			TraceScope trace("EDSDK", "EdsSetPropertyData");
 			err = EdsSetPropertyData(_model->getCameraObject(), kEdsPropID_Evf_OutputDevice, 0, sizeof(device), &device);
+			trace.setArg("error", err);
 		}
 
 		//Notification of error
@@ -64,16 +81,31 @@ public:
 			// It doesn't retry it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return false;
 			}
 
-			CameraEvent e("error", &err);
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
 			_model->notifyObservers(&e);
 		}
 
 		return true;
 	}
 
+private:
+	// Only busy is returned; without the value the defaults apply
+	EdsError readAhead(EdsPropertyID propertyID)
+	{
+		if(_model->getPropertyStore().getVersion(propertyID) != 0)
+		{
+			return EDS_ERR_OK;
+		}
+		EdsError err = GetPropertyCommand::readProperty(_model, propertyID);
+		_model->notePropertyFetched(propertyID, false, err);
+		return ((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY) ? EDS_ERR_DEVICE_BUSY : EDS_ERR_OK;
+	}
+
 };
\ No newline at end of file
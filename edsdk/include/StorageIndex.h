@@ -0,0 +1,790 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : StorageIndex.h                                                  *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+#include "EvfFrame.h"
+#include "Trace.h"
+
+
+// What one index change was, the argument of kCameraEvent_StorageChanged
+enum StorageChangeKind
+{
+	// Built or rebuilt from the camera, all volumes or one
+	kStorageChange_Scanned = 0,
+	kStorageChange_ItemAdded,
+	kStorageChange_ItemRemoved,
+	kStorageChange_ItemChanged,
+	kStorageChange_VolumeChanged,
+};
+
+typedef struct _STORAGE_CHANGE
+{
+	StorageChangeKind	kind;
+	EdsUInt32			volume;
+	// Items added, removed or changed; files indexed after a scan
+	EdsUInt32			items;
+	EdsUInt64			generation;
+}STORAGE_CHANGE;
+
+
+typedef struct _STORAGE_INDEX_STATISTICS
+{
+	EdsUInt32	volumes;
+	EdsUInt64	files;
+	EdsUInt64	folders;
+	EdsUInt64	bytes;					// total size of the files
+	EdsUInt64	scans;
+	EdsUInt64	updates;				// object events applied without a rescan
+	EdsUInt64	lastScanMicros;
+	EdsUInt64	generation;				// bumped by every change
+}STORAGE_INDEX_STATISTICS;
+
+
+// A file or folder on a card. Holds the index's reference to the item,
+// so it can be downloaded while it is in the index.
+class StorageItem
+{
+private:
+	EdsDirectoryItemRef		_ref;
+	EdsDirectoryItemInfo	_info;
+	EdsUInt32				_volume;
+	std::string				_folder;
+	std::string				_path;
+
+	StorageItem(const StorageItem&);
+	StorageItem& operator=(const StorageItem&);
+
+public:
+	// Takes over the reference
+	StorageItem(EdsDirectoryItemRef ref, const EdsDirectoryItemInfo& info, EdsUInt32 volume, const std::string& folder)
+		: _ref(ref), _info(info), _volume(volume), _folder(folder), _path(folder + "/" + info.szFileName) {}
+
+	~StorageItem()
+	{
+		if(_ref != NULL)
+		{
+			EdsRelease(_ref);
+		}
+	}
+
+	EdsDirectoryItemRef getRef() const			{ return _ref; }
+	const EdsDirectoryItemInfo& getInfo() const	{ return _info; }
+	void setInfo(const EdsDirectoryItemInfo& info)	{ _info = info; }
+	const EdsChar* getFileName() const			{ return _info.szFileName; }
+	EdsUInt64 getSize() const					{ return _info.size; }
+	EdsUInt32 getDateTime() const				{ return _info.dateTime; }
+	EdsUInt32 getFormat() const					{ return _info.format; }
+	EdsUInt32 getGroupID() const				{ return _info.groupID; }
+	bool isFolder() const						{ return _info.isFolder != 0; }
+	EdsUInt32 getVolume() const					{ return _volume; }
+	// "CF/DCIM/100CANON", and with the file name appended
+	const std::string& getFolder() const		{ return _folder; }
+	const std::string& getPath() const			{ return _path; }
+};
+
+typedef std::shared_ptr<StorageItem> StorageItemRef;
+typedef std::vector<StorageItemRef> StorageItemList;
+
+
+class StorageVolume
+{
+private:
+	EdsVolumeRef	_ref;
+	EdsVolumeInfo	_info;
+	EdsUInt32		_index;
+	std::string		_name;
+
+	StorageVolume(const StorageVolume&);
+	StorageVolume& operator=(const StorageVolume&);
+
+public:
+	StorageVolume(EdsVolumeRef ref, const EdsVolumeInfo& info, EdsUInt32 index, const std::string& name)
+		: _ref(ref), _info(info), _index(index), _name(name) {}
+
+	~StorageVolume()
+	{
+		if(_ref != NULL)
+		{
+			EdsRelease(_ref);
+		}
+	}
+
+	EdsVolumeRef getRef() const				{ return _ref; }
+	const EdsVolumeInfo& getInfo() const	{ return _info; }
+	void setInfo(const EdsVolumeInfo& info)	{ _info = info; }
+	EdsUInt32 getIndex() const				{ return _index; }
+	// The label, or VOLn when it has none or shares it; the first part of paths
+	const std::string& getName() const		{ return _name; }
+};
+
+typedef std::shared_ptr<StorageVolume> StorageVolumeRef;
+
+
+// What is on the camera's cards, walked once and then kept current from
+// object events. Queries only read the in-memory maps, under a lock, and
+// never reach the camera.
+//
+// build() and update() make SDK calls and run on the transfer processor,
+// through ScanStorageCommand and UpdateStorageCommand; everything else is
+// safe from any thread.
+class StorageIndex
+{
+private:
+	typedef std::multimap<std::string, StorageItemRef>	NameMap;
+	typedef std::multimap<EdsUInt32, StorageItemRef>	DateMap;
+	typedef std::multimap<EdsUInt64, StorageItemRef>	SizeMap;
+
+	mutable std::mutex						_mutex;
+	std::vector<StorageVolumeRef>			_volumes;
+	std::map<std::string, StorageItemRef>	_byPath;
+	std::map<EdsBaseRef, StorageItemRef>	_byRef;
+	// Files only; names upper-cased
+	NameMap									_byName;
+	DateMap									_byDate;
+	SizeMap									_bySize;
+	STORAGE_INDEX_STATISTICS				_stats;
+	bool									_built;
+	// Set once a scan is asked for, so events arriving meanwhile are kept
+	std::atomic<bool>						_active;
+
+	static std::string upper(const char* text)
+	{
+		std::string result(text);
+		for(size_t i = 0; i < result.size(); i++)
+		{
+			result[i] = (char)toupper((unsigned char)result[i]);
+		}
+		return result;
+	}
+
+	template<typename M, typename K>
+	static void eraseFrom(M& map, const K& key, const StorageItemRef& item)
+	{
+		std::pair<typename M::iterator, typename M::iterator> range = map.equal_range(key);
+		for(typename M::iterator it = range.first; it != range.second; ++it)
+		{
+			if(it->second == item)
+			{
+				map.erase(it);
+				return;
+			}
+		}
+	}
+
+	// Mutex held. Replaces any item at the same path.
+	void insert(const StorageItemRef& item)
+	{
+		std::map<std::string, StorageItemRef>::iterator existing = _byPath.find(item->getPath());
+		if(existing != _byPath.end())
+		{
+			erase(existing->second);
+		}
+		_byPath[item->getPath()] = item;
+		_byRef[item->getRef()] = item;
+		if(item->isFolder())
+		{
+			_stats.folders++;
+			return;
+		}
+		_byName.insert(std::make_pair(upper(item->getFileName()), item));
+		_byDate.insert(std::make_pair(item->getDateTime(), item));
+		_bySize.insert(std::make_pair(item->getSize(), item));
+		_stats.files++;
+		_stats.bytes += item->getSize();
+	}
+
+	// Mutex held
+	void erase(StorageItemRef item)
+	{
+		_byPath.erase(item->getPath());
+		std::map<EdsBaseRef, StorageItemRef>::iterator ref = _byRef.find(item->getRef());
+		if(ref != _byRef.end() && ref->second == item)
+		{
+			_byRef.erase(ref);
+		}
+		if(item->isFolder())
+		{
+			_stats.folders--;
+			return;
+		}
+		eraseFrom(_byName, upper(item->getFileName()), item);
+		eraseFrom(_byDate, item->getDateTime(), item);
+		eraseFrom(_bySize, item->getSize(), item);
+		_stats.files--;
+		_stats.bytes -= std::min(_stats.bytes, item->getSize());
+	}
+
+	// Mutex held. The item and everything below it; the number of files.
+	EdsUInt32 eraseTree(const StorageItemRef& item)
+	{
+		EdsUInt32 files = item->isFolder() ? 0 : 1;
+		if(item->isFolder())
+		{
+			std::string prefix = item->getPath() + "/";
+			std::map<std::string, StorageItemRef>::iterator it = _byPath.lower_bound(prefix);
+			while(it != _byPath.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+			{
+				StorageItemRef child = (it++)->second;
+				files += child->isFolder() ? 0 : 1;
+				erase(child);
+			}
+		}
+		erase(item);
+		return files;
+	}
+
+	// Mutex held
+	void eraseVolume(EdsUInt32 volume)
+	{
+		std::vector<StorageItemRef> items;
+		for(std::map<std::string, StorageItemRef>::iterator it = _byPath.begin(); it != _byPath.end(); ++it)
+		{
+			if(it->second->getVolume() == volume)
+			{
+				items.push_back(it->second);
+			}
+		}
+		for(size_t i = 0; i < items.size(); i++)
+		{
+			erase(items[i]);
+		}
+	}
+
+	// Everything below parent, depth first. Runs without the mutex, one
+	// thread per volume.
+	static EdsError walk(EdsBaseRef parent, EdsUInt32 volume, const std::string& folder, StorageItemList& out)
+	{
+		EdsUInt32 count = 0;
+		EdsError err = EdsGetChildCount(parent, &count);
+		for(EdsUInt32 i = 0; err == EDS_ERR_OK && i < count; i++)
+		{
+			EdsBaseRef child = NULL;
+			EdsDirectoryItemInfo info;
+			err = EdsGetChildAtIndex(parent, (EdsInt32)i, &child);
+			if(err == EDS_ERR_OK)
+			{
+				err = EdsGetDirectoryItemInfo(child, &info);
+				if(err != EDS_ERR_OK)
+				{
+					EdsRelease(child);
+				}
+			}
+			if(err == EDS_ERR_OK)
+			{
+				StorageItemRef item = std::make_shared<StorageItem>(child, info, volume, folder);
+				out.push_back(item);
+				if(item->isFolder())
+				{
+					err = walk(child, volume, item->getPath(), out);
+				}
+			}
+		}
+		return err;
+	}
+
+	static std::string volumeName(const EdsVolumeInfo& info, EdsUInt32 index, const std::vector<StorageVolumeRef>& volumes)
+	{
+		std::string name(info.szVolumeLabel);
+		for(size_t i = 0; !name.empty() && i < volumes.size(); i++)
+		{
+			if(volumes[i]->getName() == name)
+			{
+				name.clear();
+			}
+		}
+		if(name.empty() || name.find('/') != std::string::npos)
+		{
+			name = "VOL" + std::to_string(index);
+		}
+		return name;
+	}
+
+	// Mutex held. The indexed folder or volume parent is, if any.
+	bool locate(EdsBaseRef parent, EdsUInt32& outVolume, std::string& outFolder) const
+	{
+		std::map<EdsBaseRef, StorageItemRef>::const_iterator folder = _byRef.find(parent);
+		if(folder != _byRef.end() && folder->second->isFolder())
+		{
+			outVolume = folder->second->getVolume();
+			outFolder = folder->second->getPath();
+			return true;
+		}
+		for(size_t i = 0; i < _volumes.size(); i++)
+		{
+			if(_volumes[i]->getRef() == parent)
+			{
+				outVolume = _volumes[i]->getIndex();
+				outFolder = _volumes[i]->getName();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Where ref sits in the index, found from its parent. A folder the
+	// camera made for the new file, e.g. 101CANON, is indexed on the way.
+	EdsError placeOf(EdsBaseRef ref, EdsUInt32& outVolume, std::string& outFolder, int depth = 0)
+	{
+		EdsBaseRef parent = NULL;
+		EdsDirectoryItemInfo info;
+		bool located = false;
+		EdsError err = EdsGetParent(ref, &parent);
+		if(err == EDS_ERR_OK)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			located = locate(parent, outVolume, outFolder);
+		}
+
+		// Volumes are always known, so a parent not found is a folder
+		if(err == EDS_ERR_OK && !located)
+		{
+			err = (depth < 8) ? EdsGetDirectoryItemInfo(parent, &info) : EDS_ERR_DIR_NOT_FOUND;
+			if(err == EDS_ERR_OK && !info.isFolder)
+			{
+				err = EDS_ERR_DIR_NOT_FOUND;
+			}
+			if(err == EDS_ERR_OK)
+			{
+				err = placeOf(parent, outVolume, outFolder, depth + 1);
+			}
+			if(err == EDS_ERR_OK)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				StorageItemRef folder = std::make_shared<StorageItem>(parent, info, outVolume, outFolder);
+				insert(folder);
+				outFolder = folder->getPath();
+				parent = NULL;
+			}
+		}
+
+		if(parent != NULL)
+		{
+			EdsRelease(parent);
+		}
+		return err;
+	}
+
+	// Files and folders from below one folder or volume, replacing what
+	// the index had there
+	EdsError rescan(EdsBaseRef parent, EdsUInt32 volume, const std::string& folder, EdsUInt32& outFiles)
+	{
+		StorageItemList items;
+		EdsError err = walk(parent, volume, folder, items);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::string prefix = folder + "/";
+		std::vector<StorageItemRef> stale;
+		for(std::map<std::string, StorageItemRef>::iterator it = _byPath.lower_bound(prefix); it != _byPath.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+		{
+			stale.push_back(it->second);
+		}
+		for(size_t i = 0; i < stale.size(); i++)
+		{
+			erase(stale[i]);
+		}
+		outFiles = 0;
+		for(size_t i = 0; i < items.size(); i++)
+		{
+			insert(items[i]);
+			outFiles += items[i]->isFolder() ? 0 : 1;
+		}
+		return EDS_ERR_OK;
+	}
+
+public:
+	StorageIndex() : _built(false), _active(false)
+	{
+		memset(&_stats, 0, sizeof(_stats));
+	}
+
+	bool isBuilt() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _built;
+	}
+
+	// Events are only worth turning into updates once someone wants the index
+	void setActive(bool active)	{ _active = active; }
+	bool isActive() const		{ return _active; }
+
+	// Walks every volume of camera, all volumes at once, and swaps the
+	// result in whole. Queries see the old index until then.
+	EdsError build(EdsCameraRef camera)
+	{
+		EdsUInt64 start = evfClockMicros();
+		TraceScope trace("Storage", "Build");
+
+		EdsUInt32 count = 0;
+		EdsError err = EdsGetChildCount(camera, &count);
+
+		std::vector<StorageVolumeRef> volumes;
+		for(EdsUInt32 i = 0; err == EDS_ERR_OK && i < count; i++)
+		{
+			EdsVolumeRef volume = NULL;
+			EdsVolumeInfo info;
+			err = EdsGetChildAtIndex(camera, (EdsInt32)i, &volume);
+			if(err == EDS_ERR_OK)
+			{
+				err = EdsGetVolumeInfo(volume, &info);
+				if(err != EDS_ERR_OK)
+				{
+					EdsRelease(volume);
+				}
+			}
+			if(err == EDS_ERR_OK)
+			{
+				volumes.push_back(std::make_shared<StorageVolume>(volume, info, i, volumeName(info, i, volumes)));
+			}
+		}
+
+		// The link is idle between the replies of one walk; walks of the
+		// other volumes fill those gaps
+		std::vector<StorageItemList> items(volumes.size());
+		std::vector<EdsError> errors(volumes.size(), EDS_ERR_OK);
+		std::vector<std::thread> walkers;
+		for(size_t i = 0; err == EDS_ERR_OK && i < volumes.size(); i++)
+		{
+			walkers.push_back(std::thread([&volumes, &items, &errors, i]()
+			{
+				// The SDK needs COM on each thread that calls it in Windows
+#ifdef _WIN32
+				CoInitializeEx( NULL, COINIT_MULTITHREADED );
+#endif
+				Tracer::instance().setThreadName("StorageWalker");
+				{
+					TraceScope trace("Storage", "Walk");
+					errors[i] = walk(volumes[i]->getRef(), volumes[i]->getIndex(), volumes[i]->getName(), items[i]);
+				}
+#ifdef _WIN32
+				CoUninitialize();
+#endif
+			}));
+		}
+		for(size_t i = 0; i < walkers.size(); i++)
+		{
+			walkers[i].join();
+			if(err == EDS_ERR_OK)
+			{
+				err = errors[i];
+			}
+		}
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		EdsUInt64 generation = _stats.generation;
+		EdsUInt64 scans = _stats.scans;
+		EdsUInt64 updates = _stats.updates;
+		_byPath.clear();
+		_byRef.clear();
+		_byName.clear();
+		_byDate.clear();
+		_bySize.clear();
+		memset(&_stats, 0, sizeof(_stats));
+		_volumes.swap(volumes);
+		for(size_t v = 0; v < items.size(); v++)
+		{
+			for(size_t i = 0; i < items[v].size(); i++)
+			{
+				insert(items[v][i]);
+			}
+		}
+		_stats.volumes = (EdsUInt32)_volumes.size();
+		_stats.scans = scans + 1;
+		_stats.updates = updates;
+		_stats.generation = generation + 1;
+		_stats.lastScanMicros = evfClockMicros() - start;
+		_built = true;
+		_active = true;
+		trace.setArg("files", (EdsUInt32)_stats.files);
+		return EDS_ERR_OK;
+	}
+
+	// Applies one kEdsObjectEvent_* about ref, which the caller keeps.
+	// Those that do not concern the cards return EDS_ERR_NOT_SUPPORTED.
+	EdsError update(EdsUInt32 event, EdsBaseRef ref, STORAGE_CHANGE& outChange)
+	{
+		EdsError err = EDS_ERR_OK;
+		EdsDirectoryItemInfo info;
+		outChange.kind = kStorageChange_ItemChanged;
+		outChange.volume = 0;
+		outChange.items = 0;
+		outChange.generation = 0;
+
+		if(!isBuilt())
+		{
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+
+		switch(event)
+		{
+		case kEdsObjectEvent_DirItemCreated:
+		case kEdsObjectEvent_DirItemInfoChanged:
+		case kEdsObjectEvent_DirItemContentChanged:
+			{
+				std::string folder;
+				err = EdsGetDirectoryItemInfo(ref, &info);
+				if(err == EDS_ERR_OK)
+				{
+					err = placeOf(ref, outChange.volume, folder);
+				}
+				if(err != EDS_ERR_OK)
+				{
+					return err;
+				}
+
+				EdsRetain(ref);
+				StorageItemRef item = std::make_shared<StorageItem>(ref, info, outChange.volume, folder);
+				if(item->isFolder())
+				{
+					// A new folder may already have contents
+					err = rescan(ref, outChange.volume, item->getPath(), outChange.items);
+				}
+				std::lock_guard<std::mutex> lock(_mutex);
+				outChange.kind = (_byPath.count(item->getPath()) != 0) ? kStorageChange_ItemChanged : kStorageChange_ItemAdded;
+				insert(item);
+				outChange.items += item->isFolder() ? 0 : 1;
+			}
+			break;
+
+		case kEdsObjectEvent_DirItemRemoved:
+			{
+				outChange.kind = kStorageChange_ItemRemoved;
+				std::lock_guard<std::mutex> lock(_mutex);
+				std::map<EdsBaseRef, StorageItemRef>::iterator known = _byRef.find(ref);
+				StorageItemRef item = (known != _byRef.end()) ? known->second : StorageItemRef();
+
+				// A different ref for the same file: go by the name when it is unique
+				if(!item && EdsGetDirectoryItemInfo(ref, &info) == EDS_ERR_OK)
+				{
+					std::pair<NameMap::iterator, NameMap::iterator> named = _byName.equal_range(upper(info.szFileName));
+					if(named.first != named.second && std::next(named.first) == named.second)
+					{
+						item = named.first->second;
+					}
+				}
+				if(!item)
+				{
+					return EDS_ERR_DIR_NOT_FOUND;
+				}
+				outChange.volume = item->getVolume();
+				outChange.items = eraseTree(item);
+			}
+			break;
+
+		case kEdsObjectEvent_FolderUpdateItems:
+			{
+				EdsUInt32 volume = 0;
+				std::string folder;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					if(!locate(ref, volume, folder))
+					{
+						return EDS_ERR_DIR_NOT_FOUND;
+					}
+				}
+				outChange.kind = kStorageChange_Scanned;
+				outChange.volume = volume;
+				err = rescan(ref, volume, folder, outChange.items);
+			}
+			break;
+
+		case kEdsObjectEvent_VolumeInfoChanged:
+		case kEdsObjectEvent_VolumeUpdateItems:
+			{
+				EdsVolumeInfo volumeInfo;
+				StorageVolumeRef volume;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					for(size_t i = 0; i < _volumes.size(); i++)
+					{
+						if(_volumes[i]->getRef() == ref)
+						{
+							volume = _volumes[i];
+						}
+					}
+				}
+				if(!volume)
+				{
+					return EDS_ERR_DIR_NOT_FOUND;
+				}
+				err = EdsGetVolumeInfo(ref, &volumeInfo);
+				if(err == EDS_ERR_OK)
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					volume->setInfo(volumeInfo);
+				}
+				outChange.kind = kStorageChange_VolumeChanged;
+				outChange.volume = volume->getIndex();
+				if(err == EDS_ERR_OK && event == kEdsObjectEvent_VolumeUpdateItems)
+				{
+					outChange.kind = kStorageChange_Scanned;
+					err = rescan(ref, volume->getIndex(), volume->getName(), outChange.items);
+				}
+			}
+			break;
+
+		default:
+			return EDS_ERR_NOT_SUPPORTED;
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stats.updates++;
+			outChange.generation = ++_stats.generation;
+		}
+		return err;
+	}
+
+	// Drops everything, e.g. when the session closes
+	void clear()
+	{
+		std::vector<StorageVolumeRef> volumes;
+		std::map<std::string, StorageItemRef> items;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			volumes.swap(_volumes);
+			items.swap(_byPath);
+			_byRef.clear();
+			_byName.clear();
+			_byDate.clear();
+			_bySize.clear();
+			EdsUInt64 generation = _stats.generation;
+			memset(&_stats, 0, sizeof(_stats));
+			_stats.generation = generation + 1;
+			_built = false;
+		}
+		_active = false;
+	}
+
+	// Queries
+
+	STORAGE_INDEX_STATISTICS getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _stats;
+	}
+
+	std::vector<StorageVolumeRef> getVolumes() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _volumes;
+	}
+
+	// "CF/DCIM/100CANON/IMG_0001.JPG"; empty if not indexed
+	StorageItemRef findPath(const std::string& path) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::map<std::string, StorageItemRef>::const_iterator it = _byPath.find(path);
+		return (it != _byPath.end()) ? it->second : StorageItemRef();
+	}
+
+	// Files of that name in any folder, ignoring case. A trailing '*'
+	// matches every name starting with the rest, e.g. "IMG_12*".
+	StorageItemList findByName(const std::string& name) const
+	{
+		StorageItemList result;
+		std::string key = upper(name.c_str());
+		bool prefix = !key.empty() && key[key.size() - 1] == '*';
+		if(prefix)
+		{
+			key.erase(key.size() - 1);
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		NameMap::const_iterator it = _byName.lower_bound(key);
+		for(; it != _byName.end() && (prefix ? it->first.compare(0, key.size(), key) == 0 : it->first == key); ++it)
+		{
+			result.push_back(it->second);
+		}
+		return result;
+	}
+
+	// Files taken from first to last inclusive, EdsDirectoryItemInfo
+	// dateTime, oldest first
+	StorageItemList findByDate(EdsUInt32 first, EdsUInt32 last) const
+	{
+		StorageItemList result;
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(DateMap::const_iterator it = _byDate.lower_bound(first); it != _byDate.end() && it->first <= last; ++it)
+		{
+			result.push_back(it->second);
+		}
+		return result;
+	}
+
+	// Files of minimum to maximum bytes inclusive, smallest first
+	StorageItemList findBySize(EdsUInt64 minimum, EdsUInt64 maximum) const
+	{
+		StorageItemList result;
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(SizeMap::const_iterator it = _bySize.lower_bound(minimum); it != _bySize.end() && it->first <= maximum; ++it)
+		{
+			result.push_back(it->second);
+		}
+		return result;
+	}
+
+	// Files below folder ("" for all, "CF", "CF/DCIM/100CANON"), in path order
+	StorageItemList getFiles(const std::string& folder = std::string()) const
+	{
+		StorageItemList result;
+		std::string prefix = folder.empty() ? folder : folder + "/";
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::map<std::string, StorageItemRef>::const_iterator it = _byPath.lower_bound(prefix);
+		for(; it != _byPath.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+		{
+			if(!it->second->isFolder())
+			{
+				result.push_back(it->second);
+			}
+		}
+		return result;
+	}
+
+	// Folders directly inside folder, or the top folders of a volume by name
+	StorageItemList getFolders(const std::string& folder) const
+	{
+		StorageItemList result;
+		std::string prefix = folder + "/";
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::map<std::string, StorageItemRef>::const_iterator it = _byPath.lower_bound(prefix);
+		for(; it != _byPath.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+		{
+			if(it->second->isFolder() && it->second->getFolder() == folder)
+			{
+				result.push_back(it->second);
+			}
+		}
+		return result;
+	}
+};
+
+typedef std::shared_ptr<StorageIndex> StorageIndexRef;
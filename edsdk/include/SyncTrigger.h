@@ -0,0 +1,398 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : SyncTrigger.h                                                   *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+#include "Command.h"
+#include "CameraEvent.h"
+#include "CameraManager.h"
+
+
+typedef struct _SYNC_CAMERA_TIMING
+{
+	EdsError	error;
+	bool		armed;
+	bool		fired;
+	bool		transferred;
+	// Release command sent, from the earliest camera
+	EdsUInt64	dispatchOffsetMicros;
+	// Time spent inside EdsSendCommand for the release
+	EdsUInt64	callMicros;
+	// DirItemRequestTransfer arrival, from the earliest camera
+	EdsUInt64	transferOffsetMicros;
+}SYNC_CAMERA_TIMING;
+
+
+typedef struct _SYNC_TRIGGER_RESULT
+{
+	bool		success;
+	EdsUInt32	cameras;
+	EdsUInt32	armed;
+	EdsUInt32	fired;
+	EdsUInt32	transferred;
+	EdsUInt64	armMicros;
+	// Spread of the release dispatch and of the transfer arrivals
+	EdsUInt64	dispatchSkewMicros;
+	EdsUInt64	transferSkewMicros;
+	std::vector<SYNC_CAMERA_TIMING>	timings;
+}SYNC_TRIGGER_RESULT;
+
+
+// Lines up the processor threads of several cameras and lets them go at
+// one instant. The last thread to arrive sets a release time a little
+// ahead, and every thread spins to it: a condition variable wake-up alone
+// spreads the threads by the scheduler's latency.
+class SyncBarrier
+{
+private:
+	typedef std::chrono::steady_clock	Clock;
+
+	const EdsUInt32				_count;
+	std::atomic<EdsUInt32>		_arrived;
+	std::atomic<Clock::rep>		_releaseAt;
+	std::atomic<bool>			_aborted;
+	Clock::duration				_lead;
+
+public:
+	SyncBarrier(EdsUInt32 count, EdsUInt32 leadMicros)
+		: _count(count), _arrived(0), _releaseAt(0), _aborted(false), _lead(std::chrono::microseconds(leadMicros)) {}
+
+	// False if the barrier was aborted or the others did not arrive in time.
+	bool arriveAndWait(EdsUInt32 timeoutMillis)
+	{
+		Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMillis);
+
+		if(++_arrived == _count)
+		{
+			_releaseAt = (Clock::now() + _lead).time_since_epoch().count();
+		}
+
+		Clock::rep releaseAt;
+		while((releaseAt = _releaseAt.load()) == 0)
+		{
+			if(_aborted || Clock::now() > deadline)
+			{
+				_aborted = true;
+				return false;
+			}
+			std::this_thread::yield();
+		}
+
+		// Yield the core until the last stretch, then spin
+		const Clock::rep spin = std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(200)).count();
+		Clock::rep now;
+		while((now = Clock::now().time_since_epoch().count()) < releaseAt)
+		{
+			if(releaseAt - now > spin)
+			{
+				std::this_thread::yield();
+			}
+		}
+		return !_aborted;
+	}
+
+	void abort()	{ _aborted = true; }
+};
+
+
+// Shared by the commands of one trigger.
+class SyncTriggerState
+{
+public:
+	std::vector<SYNC_CAMERA_TIMING>			timings;
+	std::vector<EdsUInt64>					dispatchMicros;
+	std::shared_ptr<SyncBarrier>			barrier;
+	EdsUInt32								barrierTimeout;
+
+	std::mutex								mutex;
+	std::condition_variable					condition;
+	EdsUInt32								pending;
+
+	SyncTriggerState(size_t count) : timings(count), dispatchMicros(count, 0), barrierTimeout(0), pending(0)
+	{
+		memset(&timings[0], 0, sizeof(SYNC_CAMERA_TIMING) * count);
+	}
+
+	void done()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending--;
+		condition.notify_all();
+	}
+
+	bool waitAll(EdsUInt32 timeoutMillis)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return condition.wait_for(lock, std::chrono::milliseconds(timeoutMillis), [this]() { return pending == 0; });
+	}
+};
+
+typedef std::shared_ptr<SyncTriggerState> SyncTriggerStateRef;
+
+
+// Half-press on one camera ahead of the release.
+class SyncArmCommand : public Command
+{
+private:
+	SyncTriggerStateRef	_state;
+	size_t				_index;
+
+public:
+	SyncArmCommand(CameraModel* model, const SyncTriggerStateRef& state, size_t index) : Command(model), _state(state), _index(index) {}
+
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+	virtual const char* getName() const {return "SyncArm";}
+
+	virtual bool execute()
+	{
+		EdsError err = EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_Halfway);
+
+		SYNC_CAMERA_TIMING& timing = _state->timings[_index];
+		timing.error = err;
+		timing.armed = (err == EDS_ERR_OK);
+		_state->done();
+
+		if(err != EDS_ERR_OK)
+		{
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err);
+			_model->notifyObservers(&e);
+		}
+		return true;
+	}
+};
+
+
+// Waits on the barrier, then presses the shutter fully and lets it go.
+// Never retried: a late second attempt would not be in sync.
+class SyncReleaseCommand : public Command
+{
+private:
+	SyncTriggerStateRef	_state;
+	size_t				_index;
+
+public:
+	SyncReleaseCommand(CameraModel* model, const SyncTriggerStateRef& state, size_t index) : Command(model), _state(state), _index(index) {}
+
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+	virtual const char* getName() const {return "SyncRelease";}
+
+	virtual bool execute()
+	{
+		SYNC_CAMERA_TIMING& timing = _state->timings[_index];
+		EdsCameraRef camera = _model->getCameraObject();
+
+		if(_state->barrier->arriveAndWait(_state->barrierTimeout))
+		{
+			_model->expectTransferRequest();
+
+			EdsUInt64 start = evfClockMicros();
+			EdsError err = EdsSendCommand(camera, kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_Completely);
+			EdsUInt64 end = evfClockMicros();
+
+			_state->dispatchMicros[_index] = start;
+			timing.callMicros = end - start;
+			timing.fired = (err == EDS_ERR_OK);
+			if(timing.error == EDS_ERR_OK)
+			{
+				timing.error = err;
+			}
+		}
+		else if(timing.error == EDS_ERR_OK)
+		{
+			timing.error = EDS_ERR_OPERATION_CANCELLED;
+		}
+
+		EdsSendCommand(camera, kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_OFF);
+		_state->done();
+		return true;
+	}
+};
+
+
+// Synchronized capture across the sessions of a CameraManager: every
+// body is half-pressed first, then all processor threads meet on a
+// barrier and release the shutter together. The result has each camera's
+// dispatch and DirItemRequestTransfer times so the skew can be measured.
+class SyncTrigger
+{
+private:
+	bool		_halfPress;
+	EdsUInt32	_leadMicros;
+	EdsUInt32	_armTimeout;
+	EdsUInt32	_barrierTimeout;
+	EdsUInt32	_transferTimeout;
+	bool		_pumpEvents;
+
+public:
+	SyncTrigger()
+		: _halfPress(true), _leadMicros(2000), _armTimeout(3000), _barrierTimeout(2000), _transferTimeout(5000), _pumpEvents(true) {}
+
+	// Half-press every body before the release, so AF and metering are done.
+	void setHalfPress(bool halfPress)				{ _halfPress = halfPress; }
+	// Time between the last thread arriving and the release.
+	void setLead(EdsUInt32 micros)					{ _leadMicros = micros; }
+	void setArmTimeout(EdsUInt32 millisec)			{ _armTimeout = millisec; }
+	void setBarrierTimeout(EdsUInt32 millisec)		{ _barrierTimeout = millisec; }
+	// How long to wait for the transfer requests; 0 skips them.
+	void setTransferTimeout(EdsUInt32 millisec)		{ _transferTimeout = millisec; }
+	// Call EdsGetEvent while waiting for transfers, for callers with no
+	// message loop. Must then run on the thread that initialized the SDK.
+	void setPumpEvents(bool pumpEvents)				{ _pumpEvents = pumpEvents; }
+
+	bool fire(CameraManager& manager, SYNC_TRIGGER_RESULT& result)
+	{
+		return fire(manager.getSessions(), result);
+	}
+
+	bool fire(const std::vector<CameraSessionRef>& sessions, SYNC_TRIGGER_RESULT& result)
+	{
+		size_t count = sessions.size();
+
+		result.success = false;
+		result.cameras = (EdsUInt32)count;
+		result.armed = result.fired = result.transferred = 0;
+		result.armMicros = result.dispatchSkewMicros = result.transferSkewMicros = 0;
+		result.timings.clear();
+
+		if(count == 0)
+		{
+			return false;
+		}
+
+		SyncTriggerStateRef state = std::make_shared<SyncTriggerState>(count);
+		EdsUInt64 armStart = evfClockMicros();
+
+		if(_halfPress)
+		{
+			state->pending = (EdsUInt32)count;
+			for(size_t i = 0; i < count; i++)
+			{
+				sessions[i]->getCameraController()->enqueue(new SyncArmCommand(sessions[i]->getCameraModel(), state, i));
+			}
+			state->waitAll(_armTimeout);
+
+			for(size_t i = 0; i < count; i++)
+			{
+				if(state->timings[i].armed)
+				{
+					result.armed++;
+				}
+			}
+		}
+		else
+		{
+			result.armed = (EdsUInt32)count;
+		}
+		result.armMicros = evfClockMicros() - armStart;
+
+		// Held by the commands too, for any that run after a timeout
+		std::shared_ptr<SyncBarrier> barrier = std::make_shared<SyncBarrier>((EdsUInt32)count, _leadMicros);
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->barrier = barrier;
+			state->barrierTimeout = _barrierTimeout;
+			state->pending = (EdsUInt32)count;
+		}
+
+		for(size_t i = 0; i < count; i++)
+		{
+			sessions[i]->getCameraController()->enqueue(new SyncReleaseCommand(sessions[i]->getCameraModel(), state, i));
+		}
+
+		if(!state->waitAll(_armTimeout + _barrierTimeout))
+		{
+			barrier->abort();
+			state->waitAll(_barrierTimeout);
+		}
+
+		std::vector<EdsUInt64> transferMicros(count, 0);
+		waitForTransfers(sessions, state, transferMicros);
+
+		EdsUInt64 firstDispatch = 0, lastDispatch = 0, firstTransfer = 0, lastTransfer = 0;
+		for(size_t i = 0; i < count; i++)
+		{
+			SYNC_CAMERA_TIMING& timing = state->timings[i];
+			if(timing.fired)
+			{
+				EdsUInt64 dispatch = state->dispatchMicros[i];
+				firstDispatch = (result.fired == 0) ? dispatch : (std::min)(firstDispatch, dispatch);
+				lastDispatch = (std::max)(lastDispatch, dispatch);
+				result.fired++;
+			}
+			if(transferMicros[i] != 0)
+			{
+				timing.transferred = true;
+				firstTransfer = (result.transferred == 0) ? transferMicros[i] : (std::min)(firstTransfer, transferMicros[i]);
+				lastTransfer = (std::max)(lastTransfer, transferMicros[i]);
+				result.transferred++;
+			}
+		}
+
+		for(size_t i = 0; i < count; i++)
+		{
+			SYNC_CAMERA_TIMING& timing = state->timings[i];
+			timing.dispatchOffsetMicros = timing.fired ? state->dispatchMicros[i] - firstDispatch : 0;
+			timing.transferOffsetMicros = timing.transferred ? transferMicros[i] - firstTransfer : 0;
+		}
+
+		result.dispatchSkewMicros = lastDispatch - firstDispatch;
+		result.transferSkewMicros = lastTransfer - firstTransfer;
+		result.timings = state->timings;
+		result.success = (result.fired == count);
+		return result.success;
+	}
+
+protected:
+	void waitForTransfers(const std::vector<CameraSessionRef>& sessions, const SyncTriggerStateRef& state, std::vector<EdsUInt64>& transferMicros)
+	{
+		if(_transferTimeout == 0)
+		{
+			return;
+		}
+
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_transferTimeout);
+		for(;;)
+		{
+			if(_pumpEvents)
+			{
+				EdsGetEvent();
+			}
+
+			bool waiting = false;
+			for(size_t i = 0; i < sessions.size(); i++)
+			{
+				if(state->timings[i].fired && transferMicros[i] == 0)
+				{
+					transferMicros[i] = sessions[i]->getCameraModel()->getFirstTransferRequestMicros();
+					waiting = waiting || (transferMicros[i] == 0);
+				}
+			}
+
+			if(!waiting || std::chrono::steady_clock::now() > deadline)
+			{
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+};
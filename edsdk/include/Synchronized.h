@@ -19,81 +19,119 @@
 *                                                                             *
 ******************************************************************************/
 
+
 #pragma once 
 
-#include <windows.h>
-#include <process.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 
+// A recursive lock with one wait/notify channel, on the standard library
+// so it builds everywhere the SDK does. Uncontended lock() and unlock()
+// stay in user space; only a contended lock or a wait enters the kernel.
 class Synchronized 
 {
 protected:
-	HANDLE _hMutex;
-	bool _acquired;
+	mutable std::recursive_mutex		_mutex;
+	std::condition_variable_any			_condition;
+	// Set by notify() and consumed by wait(), like an auto-reset event,
+	// so a notify() that runs before the wait starts is not lost
+	bool								_notified;
+
+	// Owner and depth, to tell whether the caller holds the lock
+	mutable std::atomic<std::thread::id>	_owner;
+	mutable int							_depth;
+
 public:
-	Synchronized(): _hMutex(NULL), _acquired(false)
+	Synchronized(): _notified(false), _depth(0)
 	{
-		 _hMutex = CreateMutex(NULL, false, NULL);
-		if(_hMutex == NULL)
-		{
-			CloseHandle(_hMutex);
-		}
 	}
 
     virtual ~Synchronized()
 	{
-		unlock();
-		CloseHandle(_hMutex);	
 	}
 
 
     virtual bool lock()
 	{
-		if(_hMutex != NULL)
-		{
-			DWORD result = WaitForSingleObject(_hMutex, INFINITE);
-			if (result == WAIT_OBJECT_0 || result == WAIT_ABANDONED)
-			{
-				_acquired = true;
-			}
-		}
-
-		return _acquired;
+		_mutex.lock();
+		_owner.store(std::this_thread::get_id());
+		_depth++;
+		return true;
 	}
 
+	// Ignored unless the calling thread holds the lock
     virtual void unlock() const
 	{
-		if(_hMutex != NULL)
+		if(!isLocked())
 		{
-			ReleaseMutex(_hMutex);	
-		}	
+			return;
+		}
+
+		if(--_depth == 0)
+		{
+			_owner.store(std::thread::id());
+		}
+		_mutex.unlock();
 	}
 
+	// Releases the lock and blocks until notify() is called or millisec
+	// elapses, negative for no timeout. Returns with the lock held.
 	virtual void wait(int millisec) 
 	{
-		Sleep(millisec);
+		if(!isLocked())
+		{
+			lock();
+		}
+
+		// Release every level so a nested lock cannot block notify()
+		int depth = _depth;
+		_depth = 0;
+		_owner.store(std::thread::id());
+		for(int i = 1; i < depth; i++)
+		{
+			_mutex.unlock();
+		}
+
+		{
+			std::unique_lock<std::recursive_mutex> hold(_mutex, std::adopt_lock);
+			if(millisec < 0)
+			{
+				_condition.wait(hold, [this]() { return _notified; });
+			}
+			else
+			{
+				_condition.wait_for(hold, std::chrono::milliseconds(millisec), [this]() { return _notified; });
+			}
+			_notified = false;
+			hold.release();
+		}
 
-		if(isLocked())
+		for(int i = 1; i < depth; i++)
 		{
-			unlock();
+			_mutex.lock();
 		}
-		
-		lock();
+		_owner.store(std::this_thread::get_id());
+		_depth = depth;
 	}
 
+	// Wakes up a thread blocked in wait()
 	virtual void notify()
 	{
-		if(isLocked())
 		{
-			unlock();
+			std::lock_guard<std::recursive_mutex> guard(_mutex);
+			_notified = true;
 		}
+		_condition.notify_one();
 	}
 
+	// True if the calling thread holds the lock
 	virtual bool isLocked() const
 	{
-		return _acquired;
+		return _owner.load() == std::this_thread::get_id();
 	}
 
 };
-
-
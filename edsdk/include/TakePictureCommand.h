@@ -21,20 +21,31 @@
 
 class TakePictureCommand : public Command
 {
+private:
+	bool _autoFocus;
 
 public:
-	TakePictureCommand(CameraModel *model) : Command(model){}
+	// Without autoFocus the release leaves the lens where it is
+	TakePictureCommand(CameraModel *model, bool autoFocus = true) : Command(model), _autoFocus(autoFocus){}
 
+	virtual CommandPriority getPriority() const {return kCommandPriority_Realtime;}
+
+
+	virtual const char* getName() const {return "TakePicture";}
 
 	// Execute command	
 	virtual bool execute()
 	{
 		EdsError err = EDS_ERR_OK;
-		bool	 locked = false;
 		
 		//Taking a picture
-		err = EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_Completely);
-		      EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_OFF);
+		{
+			TraceScope trace("EDSDK", "EdsSendCommand");
+			err = EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton,
+				_autoFocus ? kEdsCameraCommand_ShutterButton_Completely : kEdsCameraCommand_ShutterButton_Completely_NonAF);
+			      EdsSendCommand(_model->getCameraObject(), kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_OFF);
+			trace.setArg("error", err);
+		}
 		
 
 		//Notification of error
@@ -43,12 +54,14 @@ public:
 			// It retries it at device busy
 			if(err == EDS_ERR_DEVICE_BUSY)
 			{
-				CameraEvent e("DeviceBusy");
+				_error = EDS_ERR_DEVICE_BUSY;
+				CameraEvent e(kCameraEvent_DeviceBusy);
 				_model->notifyObservers(&e);
 				return true;
 			}
 			
-			CameraEvent e("error", &err); 
+			_error = err;
+			CameraEvent e(kCameraEvent_Error, &err); 
 			_model->notifyObservers(&e);
 		}
 
@@ -22,78 +22,132 @@
 
 #pragma once
 
-#include <windows.h>
-#include <process.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
 #include "Synchronized.h"
+#include "ThreadPlacement.h"
 
 class Thread  
 {
 private:
-	HANDLE		_hThread;
-	bool		_active;
+	std::thread			_thread;
+	std::atomic<bool>	_active;
+
+	// Taken by the thread itself when it starts
+	std::string			_name;
+	THREAD_PLACEMENT	_placement;
+	std::mutex			_placementMutex;
 
 public:
-	Thread() : _hThread(),_active(false){} 
+	Thread() : _active(false), _placement(ThreadPlacement::any()){} 
 
-	virtual ~Thread(){}
+	// Like _beginthread, a thread still running is left to finish on its own
+	virtual ~Thread()
+	{
+		if(_thread.joinable())
+		{
+			_thread.detach();
+		}
+	}
 
 
 	bool start() 
 	{
-		_hThread = (HANDLE)_beginthread(threadProc, 0, this);
-		return (_hThread != NULL);
+		std::lock_guard<std::mutex> lock(_placementMutex);
+		if(_thread.joinable())
+		{
+			return false;
+		}
+
+		try
+		{
+			_thread = std::thread(threadProc, this);
+		}
+		catch(const std::system_error&)
+		{
+			return false;
+		}
+		return true;
 	}
 
 	void join()
 	{
-		if(_hThread)
+		if(_thread.joinable() && _thread.get_id() != std::this_thread::get_id())
 		{
-			::WaitForSingleObject( _hThread, INFINITE );
-			_hThread = NULL;
+			_thread.join();
 		}
 	}
 
 	void sleep(int millisec) const
 	{
-		if(_hThread)
+		if(_thread.joinable())
 		{
-			Sleep(millisec);
+			std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
 		}
 	}
 
-	/*
-	void resume() const
+	// True while run() is executing
+	bool isActive() const
 	{
-		if(_hThread )
-		{
-			ResumeThread(_hThread);
-		}
+		return _active.load();
+	}
+
+	// OS name of the thread, e.g. "cam3-cmd"; set before start().
+	void setName(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(_placementMutex);
+		_name = name;
 	}
 
-	void suspend() const
+	std::string getName()
 	{
-		if(_hThread)
+		std::lock_guard<std::mutex> lock(_placementMutex);
+		return _name;
+	}
+
+	// Cores the thread runs on; a running thread is moved at once.
+	bool setPlacement(const THREAD_PLACEMENT& placement)
+	{
+		std::lock_guard<std::mutex> lock(_placementMutex);
+		_placement = placement;
+		if(_thread.joinable())
 		{
-			SuspendThread(_hThread);
+			return ThreadPlacement::apply(_thread.native_handle(), placement);
 		}
+		return true;
+	}
+
+	THREAD_PLACEMENT getPlacement()
+	{
+		std::lock_guard<std::mutex> lock(_placementMutex);
+		return _placement;
 	}
-	*/
 
 public:
 	virtual void run() = 0;
 
 protected:
 
-	static void threadProc(void* lParam)
+	static void threadProc(Thread* thread)
 	{
-		Thread* thread = (Thread *)lParam;
 		if (thread != NULL)
 		{
+			{
+				std::lock_guard<std::mutex> lock(thread->_placementMutex);
+				if(!ThreadPlacement::isAny(thread->_placement))
+				{
+					ThreadPlacement::applyToCurrent(thread->_placement);
+				}
+				ThreadPlacement::setCurrentName(thread->_name.c_str());
+			}
 		    thread->_active = true;
 			thread->run();
 			thread->_active = false;	
 		}
-		_endthread();
 	}
 
 };
@@ -0,0 +1,406 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ThreadPlacement.h                                               *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <dirent.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EDSDK.h"
+
+
+enum { kThreadPlacement_MaxCores = 256 };
+
+// Where a thread may run. Without any core or node it runs where the
+// scheduler puts it.
+typedef struct _THREAD_PLACEMENT
+{
+	EdsUInt64	cores[kThreadPlacement_MaxCores / 64];	// one bit per logical core
+	EdsInt32	numaNode;								// -1 for none; its cores join the set
+}THREAD_PLACEMENT;
+
+// Placement of the threads and memory of one camera.
+typedef struct _CAMERA_PLACEMENT
+{
+	EdsChar				name[16];		// thread name prefix, e.g. "cam3"
+	THREAD_PLACEMENT	io;				// processor, transfer and live view pump
+	THREAD_PLACEMENT	decode;			// live view decode and fan-out workers
+	EdsUInt32			arenaBuffers;	// capture buffers faulted in on the io cores
+	EdsUInt64			arenaBufferSize;
+}CAMERA_PLACEMENT;
+
+// Placement of the camera in slot; slots are numbered from 0 by the manager
+// in the order sessions are opened, a closed session's slot is reused.
+typedef std::function<CAMERA_PLACEMENT(EdsUInt32 slot, const EdsDeviceInfo& deviceInfo)> PlacementPolicy;
+
+
+// Core sets, NUMA nodes and thread names, on the platforms that have them.
+// Linux takes the node layout from sysfs, so libnuma is not needed; memory
+// ends up on a node by first touch, from a thread placed there. Windows
+// pins within the first group of 64 cores; macOS only names threads.
+class ThreadPlacement
+{
+public:
+	static THREAD_PLACEMENT any()
+	{
+		THREAD_PLACEMENT placement;
+		memset(&placement, 0, sizeof(placement));
+		placement.numaNode = -1;
+		return placement;
+	}
+
+	static THREAD_PLACEMENT onCores(const std::vector<int>& cores)
+	{
+		THREAD_PLACEMENT placement = any();
+		for(size_t i = 0; i < cores.size(); i++)
+		{
+			addCore(placement, cores[i]);
+		}
+		return placement;
+	}
+
+	static THREAD_PLACEMENT onNode(int node)
+	{
+		THREAD_PLACEMENT placement = any();
+		placement.numaNode = node;
+		return placement;
+	}
+
+	static void addCore(THREAD_PLACEMENT& placement, int core)
+	{
+		if(core >= 0 && core < kThreadPlacement_MaxCores)
+		{
+			placement.cores[core / 64] |= (EdsUInt64)1 << (core % 64);
+		}
+	}
+
+	static bool isAny(const THREAD_PLACEMENT& placement)
+	{
+		return placement.numaNode < 0 && getCores(placement).empty();
+	}
+
+	// Cores of the set, then of the node, without duplicates
+	static std::vector<int> getCores(const THREAD_PLACEMENT& placement)
+	{
+		THREAD_PLACEMENT all = placement;
+		if(placement.numaNode >= 0)
+		{
+			std::vector<int> node = getNodeCores(placement.numaNode);
+			for(size_t i = 0; i < node.size(); i++)
+			{
+				addCore(all, node[i]);
+			}
+		}
+
+		std::vector<int> cores;
+		for(int core = 0; core < kThreadPlacement_MaxCores; core++)
+		{
+			if(all.cores[core / 64] & ((EdsUInt64)1 << (core % 64)))
+			{
+				cores.push_back(core);
+			}
+		}
+		return cores;
+	}
+
+	static int getCoreCount()
+	{
+		unsigned int count = std::thread::hardware_concurrency();
+		return count > 0 ? (int)count : 1;
+	}
+
+	static int getNodeCount()
+	{
+#if defined(_WIN32)
+		ULONG highest = 0;
+		return GetNumaHighestNodeNumber(&highest) ? (int)highest + 1 : 1;
+#elif defined(__linux__)
+		int count = 0;
+		DIR* dir = opendir("/sys/devices/system/node");
+		if(dir != NULL)
+		{
+			struct dirent* entry;
+			while((entry = readdir(dir)) != NULL)
+			{
+				if(strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+				{
+					count++;
+				}
+			}
+			closedir(dir);
+		}
+		return count > 0 ? count : 1;
+#else
+		return 1;
+#endif
+	}
+
+	// Every core when the platform has no node layout
+	static std::vector<int> getNodeCores(int node)
+	{
+		std::vector<int> cores;
+#if defined(_WIN32)
+		ULONGLONG mask = 0;
+		if(GetNumaNodeProcessorMask((UCHAR)node, &mask))
+		{
+			for(int core = 0; core < 64; core++)
+			{
+				if(mask & ((ULONGLONG)1 << core))
+				{
+					cores.push_back(core);
+				}
+			}
+		}
+		return cores;
+#elif defined(__linux__)
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+		FILE* file = fopen(path, "r");
+		if(file != NULL)
+		{
+			char text[1024] = {0};
+			if(fgets(text, sizeof(text), file) != NULL)
+			{
+				parseCoreList(text, cores);
+			}
+			fclose(file);
+			return cores;
+		}
+#endif
+		if(node == 0)
+		{
+			for(int core = 0; core < getCoreCount(); core++)
+			{
+				cores.push_back(core);
+			}
+		}
+		return cores;
+	}
+
+	// "0-3,8,10-11", the format of sysfs and taskset
+	static bool parseCoreList(const char* text, std::vector<int>& cores)
+	{
+		const char* p = text;
+		while(*p != '\0' && *p != '\n')
+		{
+			char* end = NULL;
+			long first = strtol(p, &end, 10);
+			if(end == p || first < 0)
+			{
+				return false;
+			}
+			long last = first;
+			p = end;
+			if(*p == '-')
+			{
+				p++;
+				last = strtol(p, &end, 10);
+				if(end == p || last < first)
+				{
+					return false;
+				}
+				p = end;
+			}
+			for(long core = first; core <= last && core < kThreadPlacement_MaxCores; core++)
+			{
+				cores.push_back((int)core);
+			}
+			if(*p == ',')
+			{
+				p++;
+			}
+			else if(*p != '\0' && *p != '\n')
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Pin a thread, running or not yet past its first instruction. A
+	// placement without cores lets it run anywhere again.
+	static bool apply(std::thread::native_handle_type handle, const THREAD_PLACEMENT& placement)
+	{
+		std::vector<int> cores = getCores(placement);
+#if defined(_WIN32)
+		DWORD_PTR mask = 0;
+		for(size_t i = 0; i < cores.size(); i++)
+		{
+			if(cores[i] < (int)(sizeof(DWORD_PTR) * 8))
+			{
+				mask |= (DWORD_PTR)1 << cores[i];
+			}
+		}
+		if(mask == 0)
+		{
+			DWORD_PTR system = 0;
+			GetProcessAffinityMask(GetCurrentProcess(), &mask, &system);
+		}
+		return SetThreadAffinityMask((HANDLE)handle, mask) != 0;
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for(size_t i = 0; i < cores.size(); i++)
+		{
+			if(cores[i] < CPU_SETSIZE)
+			{
+				CPU_SET(cores[i], &set);
+			}
+		}
+		if(cores.empty())
+		{
+			for(int core = 0; core < getCoreCount() && core < CPU_SETSIZE; core++)
+			{
+				CPU_SET(core, &set);
+			}
+		}
+		return pthread_setaffinity_np(handle, sizeof(set), &set) == 0;
+#else
+		(void)handle;
+		return cores.empty();
+#endif
+	}
+
+	static bool applyToCurrent(const THREAD_PLACEMENT& placement)
+	{
+#ifdef _WIN32
+		return apply(GetCurrentThread(), placement);
+#else
+		return apply(pthread_self(), placement);
+#endif
+	}
+
+	// Shown by debuggers, perf, top -H and the Windows profilers. Linux keeps
+	// 15 characters.
+	static void setCurrentName(const char* name)
+	{
+		if(name == NULL || name[0] == '\0')
+		{
+			return;
+		}
+#if defined(_WIN32)
+		// Windows 10 1607 and later
+		typedef HRESULT (WINAPI *SetThreadDescriptionProc)(HANDLE, PCWSTR);
+		SetThreadDescriptionProc setDescription = (SetThreadDescriptionProc)GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+		if(setDescription != NULL)
+		{
+			wchar_t wide[64];
+			size_t i = 0;
+			for(; name[i] != '\0' && i < 63; i++)
+			{
+				wide[i] = (wchar_t)(unsigned char)name[i];
+			}
+			wide[i] = L'\0';
+			setDescription(GetCurrentThread(), wide);
+		}
+#else
+		char shortName[16];
+		strncpy(shortName, name, sizeof(shortName) - 1);
+		shortName[sizeof(shortName) - 1] = '\0';
+#if defined(__APPLE__)
+		pthread_setname_np(shortName);
+#elif defined(__linux__)
+		pthread_setname_np(pthread_self(), shortName);
+#endif
+#endif
+	}
+
+	// Run fn on a thread placed there and wait for it, e.g. so the pages it
+	// faults in come from that node.
+	static void runOn(const THREAD_PLACEMENT& placement, const std::function<void()>& fn)
+	{
+		if(isAny(placement))
+		{
+			fn();
+			return;
+		}
+		std::thread thread([&placement, &fn]()
+		{
+			applyToCurrent(placement);
+			fn();
+		});
+		thread.join();
+	}
+
+	// --- Policies ---
+
+	static CAMERA_PLACEMENT makeCameraPlacement(EdsUInt32 slot)
+	{
+		CAMERA_PLACEMENT placement;
+		memset(&placement, 0, sizeof(placement));
+		snprintf(placement.name, sizeof(placement.name), "cam%u", slot);
+		placement.io = any();
+		placement.decode = any();
+		return placement;
+	}
+
+	// Names only; the scheduler places every thread.
+	static PlacementPolicy unpinned()
+	{
+		return [](EdsUInt32 slot, const EdsDeviceInfo&) { return makeCameraPlacement(slot); };
+	}
+
+	// Cameras dealt round the NUMA nodes. Each one's I/O runs on a core of
+	// its own within the node, in turn, and decodes anywhere on the node.
+	static PlacementPolicy spreadAcrossNodes(EdsUInt32 arenaBuffers = 0, EdsUInt64 arenaBufferSize = 0)
+	{
+		int nodeCount = getNodeCount();
+		return [nodeCount, arenaBuffers, arenaBufferSize](EdsUInt32 slot, const EdsDeviceInfo&)
+		{
+			CAMERA_PLACEMENT placement = makeCameraPlacement(slot);
+			int node = (int)(slot % (EdsUInt32)nodeCount);
+			std::vector<int> cores = getNodeCores(node);
+			if(!cores.empty())
+			{
+				addCore(placement.io, cores[(slot / (EdsUInt32)nodeCount) % cores.size()]);
+				placement.decode = onNode(node);
+			}
+			placement.arenaBuffers = arenaBuffers;
+			placement.arenaBufferSize = arenaBufferSize;
+			return placement;
+		};
+	}
+
+	// coresPerCamera consecutive cores per camera from firstCore on, wrapping
+	// round the machine; I/O on the first of them, decoding on all.
+	static PlacementPolicy coresPerCamera(int coresPerCamera, int firstCore = 0, EdsUInt32 arenaBuffers = 0, EdsUInt64 arenaBufferSize = 0)
+	{
+		int coreCount = getCoreCount();
+		int perCamera = coresPerCamera > 0 ? coresPerCamera : 1;
+		return [coreCount, perCamera, firstCore, arenaBuffers, arenaBufferSize](EdsUInt32 slot, const EdsDeviceInfo&)
+		{
+			CAMERA_PLACEMENT placement = makeCameraPlacement(slot);
+			for(int i = 0; i < perCamera; i++)
+			{
+				int core = (firstCore + (int)slot * perCamera + i) % coreCount;
+				if(i == 0)
+				{
+					addCore(placement.io, core);
+				}
+				addCore(placement.decode, core);
+			}
+			placement.arenaBuffers = arenaBuffers;
+			placement.arenaBufferSize = arenaBufferSize;
+			return placement;
+		};
+	}
+};
@@ -0,0 +1,272 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : Thumbnail.h                                                     *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EDSDK.h"
+#include "Trace.h"
+
+
+// The small image a camera file carries with it, fetched without
+// downloading the file. The bytes are what the SDK hands over: the embedded
+// thumbnail from EdsDownloadThumbnail (a JPEG for stills), or nothing when
+// only the pixels of a file's preview were extracted. Pixels are 8 bit RGB
+// from EdsGetImage, present only when asked for.
+class Thumbnail
+{
+private:
+	EdsDirectoryItemInfo		_info;
+	EdsImageSource				_source;
+	std::vector<unsigned char>	_data;
+	// Size of the image at the source, before any scaling
+	EdsUInt32					_width;
+	EdsUInt32					_height;
+	std::vector<unsigned char>	_pixels;
+	EdsUInt32					_pixelWidth;
+	EdsUInt32					_pixelHeight;
+
+	Thumbnail(const Thumbnail&);
+	Thumbnail& operator=(const Thumbnail&);
+
+	static EdsUInt64 streamLength(EdsStreamRef stream)
+	{
+		EdsUInt64 length = 0;
+		return (EdsGetLength(stream, &length) == EDS_ERR_OK) ? length : 0;
+	}
+
+	static bool copyStream(EdsStreamRef stream, std::vector<unsigned char>& out)
+	{
+		EdsVoid* data = NULL;
+		EdsUInt64 length = streamLength(stream);
+		if(length == 0 || EdsGetPointer(stream, &data) != EDS_ERR_OK || data == NULL)
+		{
+			return false;
+		}
+		out.assign((const unsigned char*)data, (const unsigned char*)data + (size_t)length);
+		return true;
+	}
+
+public:
+	Thumbnail() : _source(kEdsImageSrc_Thumbnail), _width(0), _height(0), _pixelWidth(0), _pixelHeight(0)
+	{
+		memset(&_info, 0, sizeof(_info));
+	}
+
+	const EdsDirectoryItemInfo& getInfo() const	{ return _info; }
+	const EdsChar* getFileName() const			{ return _info.szFileName; }
+	EdsImageSource getSource() const			{ return _source; }
+
+	const unsigned char* getData() const		{ return _data.empty() ? NULL : &_data[0]; }
+	EdsUInt64 getLength() const					{ return _data.size(); }
+
+	EdsUInt32 getWidth() const					{ return _width; }
+	EdsUInt32 getHeight() const					{ return _height; }
+
+	bool hasPixels() const						{ return !_pixels.empty(); }
+	const unsigned char* getPixels() const		{ return _pixels.empty() ? NULL : &_pixels[0]; }
+	EdsUInt32 getPixelWidth() const				{ return _pixelWidth; }
+	EdsUInt32 getPixelHeight() const			{ return _pixelHeight; }
+	EdsUInt32 getStride() const					{ return _pixelWidth * 3; }
+
+	// Reads the size of source in the file behind stream and, with decode,
+	// its pixels scaled to fit maxSize on the long side (0 for full size)
+	EdsError render(EdsStreamRef stream, EdsImageSource source, bool decode, EdsUInt32 maxSize)
+	{
+		EdsError		err = EDS_ERR_OK;
+		EdsImageRef		image = NULL;
+		EdsStreamRef	pixels = NULL;
+		EdsImageInfo	imageInfo;
+
+		{
+			TraceScope trace("EDSDK", "EdsCreateImageRef");
+			err = EdsCreateImageRef(stream, &image);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsGetImageInfo(image, source, &imageInfo);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			_source = source;
+			_width = imageInfo.effectiveRect.size.width;
+			_height = imageInfo.effectiveRect.size.height;
+		}
+
+		EdsSize size = { (EdsInt32)_width, (EdsInt32)_height };
+		if(err == EDS_ERR_OK && decode && maxSize > 0 && std::max(_width, _height) > maxSize)
+		{
+			double scale = (double)maxSize / std::max(_width, _height);
+			size.width = std::max<EdsInt32>(1, (EdsInt32)(_width * scale + 0.5));
+			size.height = std::max<EdsInt32>(1, (EdsInt32)(_height * scale + 0.5));
+		}
+
+		if(err == EDS_ERR_OK && decode)
+		{
+			err = EdsCreateMemoryStream((EdsUInt64)size.width * size.height * 3, &pixels);
+		}
+
+		if(err == EDS_ERR_OK && decode)
+		{
+			TraceScope trace("EDSDK", "EdsGetImage");
+			err = EdsGetImage(image, source, kEdsTargetImageType_RGB, imageInfo.effectiveRect, size, pixels);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK && decode)
+		{
+			if(copyStream(pixels, _pixels) && _pixels.size() >= (size_t)size.width * size.height * 3)
+			{
+				_pixels.resize((size_t)size.width * size.height * 3);
+				_pixelWidth = (EdsUInt32)size.width;
+				_pixelHeight = (EdsUInt32)size.height;
+			}
+			else
+			{
+				_pixels.clear();
+				err = EDS_ERR_STREAM_READ_ERROR;
+			}
+		}
+
+		if(pixels != NULL)
+		{
+			EdsRelease(pixels);
+		}
+		if(image != NULL)
+		{
+			EdsRelease(image);
+		}
+		return err;
+	}
+
+	// The embedded thumbnail of a file still on the camera. Only the
+	// thumbnail crosses the link, a few KB however large the file.
+	static EdsError download(EdsDirectoryItemRef item, bool decode, EdsUInt32 maxSize, std::shared_ptr<Thumbnail>& outThumbnail)
+	{
+		EdsError		err = EDS_ERR_OK;
+		EdsStreamRef	stream = NULL;
+		std::shared_ptr<Thumbnail> thumbnail = std::make_shared<Thumbnail>();
+
+		{
+			TraceScope trace("EDSDK", "EdsGetDirectoryItemInfo");
+			err = EdsGetDirectoryItemInfo(item, &thumbnail->_info);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsCreateMemoryStream(0, &stream);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			TraceScope trace("EDSDK", "EdsDownloadThumbnail");
+			err = EdsDownloadThumbnail(item, stream);
+			trace.setArg("error", err);
+		}
+
+		if(err == EDS_ERR_OK && !copyStream(stream, thumbnail->_data))
+		{
+			err = EDS_ERR_STREAM_READ_ERROR;
+		}
+
+		// Read back from the start as a file of its own
+		if(err == EDS_ERR_OK)
+		{
+			err = EdsSeek(stream, 0, kEdsSeek_Begin);
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = thumbnail->render(stream, kEdsImageSrc_Thumbnail, decode, maxSize);
+		}
+
+		if(stream != NULL)
+		{
+			EdsRelease(stream);
+		}
+		if(err == EDS_ERR_OK)
+		{
+			outThumbnail = thumbnail;
+		}
+		return err;
+	}
+
+	// The thumbnail or preview inside a file already in memory, e.g. a
+	// CapturedImage; kEdsImageSrc_Preview is the larger of the two
+	static EdsError extract(const void* data, EdsUInt64 length, const EdsDirectoryItemInfo* info, EdsImageSource source,
+		EdsUInt32 maxSize, std::shared_ptr<Thumbnail>& outThumbnail)
+	{
+		if(data == NULL || length == 0)
+		{
+			return EDS_ERR_INVALID_PARAMETER;
+		}
+
+		EdsStreamRef stream = NULL;
+		EdsError err = EdsCreateMemoryStreamFromPointer(const_cast<void*>(data), length, &stream);
+		std::shared_ptr<Thumbnail> thumbnail = std::make_shared<Thumbnail>();
+		if(info != NULL)
+		{
+			thumbnail->_info = *info;
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			err = thumbnail->render(stream, source, true, maxSize);
+		}
+
+		if(stream != NULL)
+		{
+			EdsRelease(stream);
+		}
+		if(err == EDS_ERR_OK)
+		{
+			outThumbnail = thumbnail;
+		}
+		return err;
+	}
+
+	// The same for a file on disk
+	static EdsError extractFile(const char* path, EdsImageSource source, EdsUInt32 maxSize, std::shared_ptr<Thumbnail>& outThumbnail)
+	{
+		EdsStreamRef stream = NULL;
+		EdsError err = EdsCreateFileStream(path, kEdsFileCreateDisposition_OpenExisting, kEdsAccess_Read, &stream);
+		std::shared_ptr<Thumbnail> thumbnail = std::make_shared<Thumbnail>();
+		if(err == EDS_ERR_OK)
+		{
+			std::string name(path);
+			size_t slash = name.find_last_of("/\\");
+			name = (slash == std::string::npos) ? name : name.substr(slash + 1);
+			strncpy(thumbnail->_info.szFileName, name.c_str(), sizeof(thumbnail->_info.szFileName) - 1);
+			thumbnail->_info.size = streamLength(stream);
+			err = thumbnail->render(stream, source, true, maxSize);
+		}
+
+		if(stream != NULL)
+		{
+			EdsRelease(stream);
+		}
+		if(err == EDS_ERR_OK)
+		{
+			outThumbnail = thumbnail;
+		}
+		return err;
+	}
+};
+
+typedef std::shared_ptr<Thumbnail> ThumbnailRef;
@@ -0,0 +1,80 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : ThumbnailCommand.h                                              *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <functional>
+
+#include "Command.h"
+#include "CameraEvent.h"
+#include "Thumbnail.h"
+#include "EDSDK.h"
+
+
+// Told on the transfer thread with the thumbnail, or the error and an empty ref
+typedef std::function<void(EdsError err, const ThumbnailRef& thumbnail)> ThumbnailHandler;
+
+
+// Fetches the embedded thumbnail of a directory item, leaving the file on
+// the camera. Queued with the downloads, so it never blocks camera control.
+class ThumbnailCommand : public Command
+{
+private:
+	EdsDirectoryItemRef	_directoryItem;
+	bool				_decode;
+	EdsUInt32			_maxSize;
+	ThumbnailHandler	_handler;
+	EdsUInt64			_transferredBytes;
+
+public:
+	// Takes over the reference to the directory item
+	ThumbnailCommand(CameraModel *model, EdsDirectoryItemRef dirItem, bool decode, EdsUInt32 maxSize, const ThumbnailHandler& handler)
+		: Command(model), _directoryItem(dirItem), _decode(decode), _maxSize(maxSize), _handler(handler), _transferredBytes(0) {}
+
+	virtual ~ThumbnailCommand()
+	{
+		if(_directoryItem != NULL)
+		{
+			EdsRelease(_directoryItem);
+			_directoryItem = NULL;
+		}
+	}
+
+	virtual bool isTransfer() const {return true;}
+
+	virtual EdsUInt64 getTransferredBytes() const {return _transferredBytes;}
+
+	virtual const char* getName() const {return "Thumbnail";}
+
+	virtual bool execute()
+	{
+		ThumbnailRef thumbnail;
+		EdsError err = Thumbnail::download(_directoryItem, _decode, _maxSize, thumbnail);
+
+		// It retries it at device busy
+		if((err & EDS_ERRORID_MASK) == EDS_ERR_DEVICE_BUSY)
+		{
+			_error = EDS_ERR_DEVICE_BUSY;
+			CameraEvent e(kCameraEvent_DeviceBusy);
+			_model->notifyObservers(&e);
+			return false;
+		}
+
+		_transferredBytes = thumbnail ? thumbnail->getLength() : 0;
+		_error = err;
+		// Files without one, such as movies, fail here; only the handler
+		// and the handle hear of it, not the observers
+		if(_handler)
+		{
+			_handler(err, thumbnail);
+		}
+		return true;
+	}
+};
@@ -0,0 +1,464 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : Trace.h                                                         *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "EDSDK.h"
+
+
+enum TracePhase
+{
+	kTracePhase_Complete = 'X',		// A span with a duration
+	kTracePhase_Instant = 'i'
+};
+
+
+// One span or instant. Names are string literals, or Tracer::intern()ed.
+typedef struct _TRACE_EVENT
+{
+	const char*		category;
+	const char*		name;
+	EdsUInt64		beginMicros;
+	EdsUInt64		durationMicros;
+	const char*		argName;		// NULL for no argument
+	EdsUInt64		argValue;
+	EdsUInt32		threadId;		// Tracer's own numbering, see setThreadName()
+	char			phase;
+}TRACE_EVENT;
+
+
+// Ring of the events of one thread. Only the owning thread writes; a
+// reader copies it without a lock and drops whatever may have been
+// overwritten while it was copying.
+class TraceBuffer
+{
+private:
+	std::vector<TRACE_EVENT>	_events;
+	std::atomic<EdsUInt64>		_head;		// events ever written
+	std::atomic<EdsUInt64>		_tail;		// first event still wanted, for clear()
+
+	TraceBuffer(const TraceBuffer&);
+	TraceBuffer& operator=(const TraceBuffer&);
+
+public:
+	TraceBuffer(size_t capacity) : _events(capacity), _head(0), _tail(0) {}
+
+	void push(const TRACE_EVENT& event)
+	{
+		EdsUInt64 head = _head.load(std::memory_order_relaxed);
+		_events[(size_t)(head % _events.size())] = event;
+		_head.store(head + 1, std::memory_order_release);
+	}
+
+	void clear()
+	{
+		_tail.store(_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+
+	// Events overwritten before anyone read them
+	EdsUInt64 getDropped() const
+	{
+		EdsUInt64 head = _head.load(std::memory_order_acquire);
+		EdsUInt64 tail = _tail.load(std::memory_order_relaxed);
+		return (head - tail > _events.size()) ? head - tail - _events.size() : 0;
+	}
+
+	void collect(std::vector<TRACE_EVENT>& out) const
+	{
+		EdsUInt64 capacity = _events.size();
+		EdsUInt64 head = _head.load(std::memory_order_acquire);
+		EdsUInt64 first = _tail.load(std::memory_order_relaxed);
+		if(head - first > capacity)
+		{
+			first = head - capacity;
+		}
+
+		size_t start = out.size();
+		for(EdsUInt64 i = first; i < head; i++)
+		{
+			out.push_back(_events[(size_t)(i % capacity)]);
+		}
+
+		// The writer is at most one slot past what it published: anything
+		// within a capacity of its new head, less that slot, is intact
+		EdsUInt64 now = _head.load(std::memory_order_acquire);
+		if(now >= first + capacity)
+		{
+			EdsUInt64 stale = now - capacity + 1 - first;
+			if(stale > head - first)
+			{
+				stale = head - first;
+			}
+			out.erase(out.begin() + start, out.begin() + start + (size_t)stale);
+		}
+	}
+};
+
+
+// Process wide span recorder, off until start(). With tracing off a
+// TraceScope costs one relaxed load; with it on a span is two clock reads
+// and a write into the calling thread's own buffer, with no lock.
+//
+// exportChromeTrace() gives the Chrome trace event JSON, which
+// chrome://tracing and ui.perfetto.dev both open.
+class Tracer
+{
+public:
+	enum { kDefaultEventsPerThread = 1 << 16 };
+
+private:
+	std::mutex									_mutex;
+	std::vector<std::unique_ptr<TraceBuffer> >	_buffers;
+	std::vector<TraceBuffer*>					_freeBuffers;
+	std::vector<std::string>					_threadNames;		// by thread id - 1
+	std::set<std::string>						_interned;
+	size_t										_eventsPerThread;
+	EdsUInt64									_originMicros;
+
+	Tracer() : _eventsPerThread(kDefaultEventsPerThread), _originMicros(nowMicros()) {}
+	Tracer(const Tracer&);
+	Tracer& operator=(const Tracer&);
+
+	static std::atomic<bool>& enabled()
+	{
+		static std::atomic<bool> enabled(false);
+		return enabled;
+	}
+
+	// The calling thread's buffer and id, handed back for reuse when the
+	// thread ends
+	struct ThreadSlot
+	{
+		TraceBuffer*	buffer;
+		EdsUInt32		threadId;
+
+		ThreadSlot() : buffer(NULL), threadId(0) {}
+		~ThreadSlot()
+		{
+			if(buffer != NULL)
+			{
+				Tracer::instance().releaseBuffer(buffer);
+			}
+		}
+	};
+
+	static ThreadSlot& threadSlot()
+	{
+		static thread_local ThreadSlot slot;
+		return slot;
+	}
+
+	EdsUInt32 threadId()
+	{
+		ThreadSlot& slot = threadSlot();
+		if(slot.threadId == 0)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_threadNames.push_back(std::string());
+			slot.threadId = (EdsUInt32)_threadNames.size();
+		}
+		return slot.threadId;
+	}
+
+	TraceBuffer* threadBuffer()
+	{
+		ThreadSlot& slot = threadSlot();
+		if(slot.buffer == NULL)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(!_freeBuffers.empty())
+			{
+				slot.buffer = _freeBuffers.back();
+				_freeBuffers.pop_back();
+			}
+			else
+			{
+				_buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(_eventsPerThread)));
+				slot.buffer = _buffers.back().get();
+			}
+		}
+		return slot.buffer;
+	}
+
+	void releaseBuffer(TraceBuffer* buffer)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_freeBuffers.push_back(buffer);
+	}
+
+	static void appendEscaped(std::string& out, const char* text)
+	{
+		for(const char* c = text; *c != '\0'; c++)
+		{
+			switch(*c)
+			{
+			case '"':	out += "\\\""; break;
+			case '\\':	out += "\\\\"; break;
+			case '\n':	out += "\\n"; break;
+			default:
+				if((unsigned char)*c < 0x20)
+				{
+					char code[8];
+					snprintf(code, sizeof(code), "\\u%04x", (unsigned char)*c);
+					out += code;
+				}
+				else
+				{
+					out += *c;
+				}
+			}
+		}
+	}
+
+public:
+	// Never destroyed, so threads ending at exit can still hand back buffers
+	static Tracer& instance()
+	{
+		static Tracer* tracer = new Tracer();
+		return *tracer;
+	}
+
+	static bool isEnabled()
+	{
+		return enabled().load(std::memory_order_relaxed);
+	}
+
+	static EdsUInt64 nowMicros()
+	{
+		return (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// eventsPerThread applies to buffers not yet created; each thread keeps
+	// its latest events once its buffer is full
+	void start(size_t eventsPerThread = kDefaultEventsPerThread)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_eventsPerThread = (eventsPerThread != 0) ? eventsPerThread : 1;
+		}
+		enabled().store(true);
+	}
+
+	void stop()
+	{
+		enabled().store(false);
+	}
+
+	// Forget what was recorded so far
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+			_buffers[i]->clear();
+		}
+		_originMicros = nowMicros();
+	}
+
+	// Name of the calling thread in the exported trace
+	void setThreadName(const char* name)
+	{
+		EdsUInt32 id = threadId();
+		std::lock_guard<std::mutex> lock(_mutex);
+		_threadNames[id - 1] = name;
+	}
+
+	// A copy of name that lives as long as the process, for names not known
+	// at compile time
+	const char* intern(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _interned.insert(name).first->c_str();
+	}
+
+	void record(const char* category, const char* name, EdsUInt64 beginMicros, EdsUInt64 durationMicros,
+		const char* argName = NULL, EdsUInt64 argValue = 0, char phase = kTracePhase_Complete)
+	{
+		TRACE_EVENT event;
+		event.category = category;
+		event.name = name;
+		event.beginMicros = beginMicros;
+		event.durationMicros = durationMicros;
+		event.argName = argName;
+		event.argValue = argValue;
+		event.threadId = threadId();
+		event.phase = phase;
+		threadBuffer()->push(event);
+	}
+
+	void instant(const char* category, const char* name, const char* argName = NULL, EdsUInt64 argValue = 0)
+	{
+		if(isEnabled())
+		{
+			record(category, name, nowMicros(), 0, argName, argValue, kTracePhase_Instant);
+		}
+	}
+
+	// All threads' events, in no particular order
+	std::vector<TRACE_EVENT> collect()
+	{
+		std::vector<TRACE_EVENT> events;
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+			_buffers[i]->collect(events);
+		}
+		return events;
+	}
+
+	EdsUInt64 getDropped()
+	{
+		EdsUInt64 dropped = 0;
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(size_t i = 0; i < _buffers.size(); i++)
+		{
+			dropped += _buffers[i]->getDropped();
+		}
+		return dropped;
+	}
+
+	std::string exportChromeTrace()
+	{
+		std::vector<TRACE_EVENT> events = collect();
+		std::vector<std::string> threadNames;
+		EdsUInt64 origin;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			threadNames = _threadNames;
+			origin = _originMicros;
+		}
+
+		std::string json;
+		json.reserve(events.size() * 128 + 256);
+		json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+		char number[64];
+		bool first = true;
+		for(size_t i = 0; i < threadNames.size(); i++)
+		{
+			if(threadNames[i].empty())
+			{
+				continue;
+			}
+			snprintf(number, sizeof(number), "%u", (unsigned)(i + 1));
+			json += first ? "" : ",\n";
+			json += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":";
+			json += number;
+			json += ",\"args\":{\"name\":\"";
+			appendEscaped(json, threadNames[i].c_str());
+			json += "\"}}";
+			first = false;
+		}
+
+		for(size_t i = 0; i < events.size(); i++)
+		{
+			const TRACE_EVENT& event = events[i];
+			if(event.beginMicros < origin)
+			{
+				continue;
+			}
+
+			json += first ? "" : ",\n";
+			json += "{\"ph\":\"";
+			json += event.phase;
+			json += "\",\"cat\":\"";
+			appendEscaped(json, event.category);
+			json += "\",\"name\":\"";
+			appendEscaped(json, event.name);
+			snprintf(number, sizeof(number), "\",\"pid\":1,\"tid\":%u,\"ts\":%llu",
+				(unsigned)event.threadId, (unsigned long long)(event.beginMicros - origin));
+			json += number;
+			if(event.phase == kTracePhase_Complete)
+			{
+				snprintf(number, sizeof(number), ",\"dur\":%llu", (unsigned long long)event.durationMicros);
+				json += number;
+			}
+			else
+			{
+				json += ",\"s\":\"t\"";
+			}
+			if(event.argName != NULL)
+			{
+				json += ",\"args\":{\"";
+				appendEscaped(json, event.argName);
+				snprintf(number, sizeof(number), "\":%llu}", (unsigned long long)event.argValue);
+				json += number;
+			}
+			json += "}";
+			first = false;
+		}
+
+		json += "\n]}\n";
+		return json;
+	}
+
+	bool writeChromeTrace(const char* path)
+	{
+		std::string json = exportChromeTrace();
+		FILE* file = fopen(path, "wb");
+		if(file == NULL)
+		{
+			return false;
+		}
+		bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+		return (fclose(file) == 0) && written;
+	}
+};
+
+
+// Records the enclosing block as a span while tracing is on
+class TraceScope
+{
+private:
+	const char*		_category;
+	const char*		_name;
+	const char*		_argName;
+	EdsUInt64		_argValue;
+	EdsUInt64		_begin;
+	bool			_active;
+
+	TraceScope(const TraceScope&);
+	TraceScope& operator=(const TraceScope&);
+
+public:
+	TraceScope(const char* category, const char* name) :
+	  _category(category), _name(name), _argName(NULL), _argValue(0), _begin(0), _active(Tracer::isEnabled())
+	{
+		if(_active)
+		{
+			_begin = Tracer::nowMicros();
+		}
+	}
+
+	~TraceScope()
+	{
+		if(_active)
+		{
+			Tracer::instance().record(_category, _name, _begin, Tracer::nowMicros() - _begin, _argName, _argValue);
+		}
+	}
+
+	// Shown with the span, e.g. the EdsError of the call
+	void setArg(const char* name, EdsUInt64 value)
+	{
+		_argName = name;
+		_argValue = value;
+	}
+};
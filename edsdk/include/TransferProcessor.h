@@ -0,0 +1,125 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : TransferProcessor.h                                             *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+
+#include "Processor.h"
+#include "Command.h"
+
+
+typedef struct _TRANSFER_STATISTICS
+{
+	EdsUInt64	completed;				// transfers that moved data
+	EdsUInt64	failed;					// transfers that ended without data
+	EdsUInt64	bytes;					// total bytes moved
+	EdsUInt64	busyMicros;				// time spent inside transfers
+	EdsUInt64	lastBytes;
+	EdsUInt64	lastMicros;
+	double		lastBytesPerSecond;
+	double		averageBytesPerSecond;	// bytes / busyMicros
+	EdsUInt32	queueDepth;				// transfers waiting, retries included
+	EdsUInt32	active;					// transfer running right now, 0 or 1
+}TRANSFER_STATISTICS;
+
+
+// Worker for image downloads, so a 40 MB EdsDownload does not hold up the
+// shutter, property and live view commands on the control processor.
+// One worker may be shared by the controllers of several cameras; closing a
+// camera purges its waiting transfers.
+class TransferProcessor : public Processor
+{
+protected:
+	EdsUInt64	_completed;
+	EdsUInt64	_failed;
+	EdsUInt64	_bytes;
+	EdsUInt64	_busyMicros;
+	EdsUInt64	_lastBytes;
+	EdsUInt64	_lastMicros;
+	bool		_active;
+
+public:
+	TransferProcessor() : _completed(0), _failed(0), _bytes(0), _busyMicros(0), _lastBytes(0), _lastMicros(0), _active(false) {}
+
+	virtual const char* getThreadName() const {return "TransferProcessor";}
+
+	TRANSFER_STATISTICS getStatistics()
+	{
+		TRANSFER_STATISTICS stats = {};
+
+		_syncObject.lock();
+		stats.completed = _completed;
+		stats.failed = _failed;
+		stats.bytes = _bytes;
+		stats.busyMicros = _busyMicros;
+		stats.lastBytes = _lastBytes;
+		stats.lastMicros = _lastMicros;
+		if(_lastMicros != 0)
+		{
+			stats.lastBytesPerSecond = _lastBytes * 1000000.0 / _lastMicros;
+		}
+		if(_busyMicros != 0)
+		{
+			stats.averageBytesPerSecond = _bytes * 1000000.0 / _busyMicros;
+		}
+		stats.queueDepth = (EdsUInt32)_retryQueue.size();
+		for(int lane = 0; lane < kCommandPriority_Count; lane++)
+		{
+			stats.queueDepth += (EdsUInt32)_queue[lane].size();
+		}
+		stats.active = _active ? 1 : 0;
+		_syncObject.unlock();
+
+		return stats;
+	}
+
+	void resetStatistics()
+	{
+		_syncObject.lock();
+		_completed = _failed = _bytes = _busyMicros = _lastBytes = _lastMicros = 0;
+		_syncObject.unlock();
+	}
+
+protected:
+	virtual Command* take()
+	{
+		Command* command = Processor::take();
+
+		_syncObject.lock();
+		_active = (command != NULL);
+		_syncObject.unlock();
+
+		return command;
+	}
+
+	virtual void commandExecuted(Command* command, bool complete, std::chrono::steady_clock::duration elapsed)
+	{
+		EdsUInt64 micros = (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+		EdsUInt64 bytes = command->getTransferredBytes();
+
+		_syncObject.lock();
+		_active = false;
+		_busyMicros += micros;
+		if(bytes != 0)
+		{
+			_completed++;
+			_bytes += bytes;
+			_lastBytes = bytes;
+			_lastMicros = micros;
+		}
+		else if(complete && command->getError() != EDS_ERR_OK)
+		{
+			// Index scans move no file bytes without having failed
+			_failed++;
+		}
+		_syncObject.unlock();
+	}
+};
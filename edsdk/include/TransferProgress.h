@@ -0,0 +1,399 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : TransferProgress.h                                              *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "EDSDK.h"
+#include "EvfFrame.h"
+
+class CameraModel;
+
+
+// One file being downloaded. Times are evfClockMicros().
+typedef struct _TRANSFER_PROGRESS
+{
+	EdsUInt64		id;
+	std::string		camera;				// body serial number, or model name
+	std::string		fileName;
+	EdsUInt64		totalBytes;
+	EdsUInt64		transferredBytes;
+	EdsUInt32		percent;
+	double			bytesPerSecond;
+	EdsUInt64		etaMicros;			// 0 until a rate is known
+	EdsUInt64		startMicros;
+	EdsUInt64		elapsedMicros;
+	bool			cancelRequested;
+}TRANSFER_PROGRESS;
+
+// The transfers of one body; the file counts are since the body's first transfer
+typedef struct _CAMERA_TRANSFER_PROGRESS
+{
+	std::string		camera;
+	EdsUInt32		activeTransfers;
+	EdsUInt64		totalBytes;			// of the active transfers
+	EdsUInt64		transferredBytes;
+	double			bytesPerSecond;
+	EdsUInt64		etaMicros;
+	EdsUInt64		completedFiles;
+	EdsUInt64		completedBytes;
+	EdsUInt64		failedFiles;
+	EdsUInt64		cancelledFiles;
+}CAMERA_TRANSFER_PROGRESS;
+
+// Every active transfer of every body at one moment
+typedef struct _TRANSFER_PROGRESS_SNAPSHOT
+{
+	EdsUInt64								timestampMicros;
+	std::vector<TRANSFER_PROGRESS>			transfers;
+	std::vector<CAMERA_TRANSFER_PROGRESS>	cameras;
+	EdsUInt64								totalBytes;
+	EdsUInt64								transferredBytes;
+	double									bytesPerSecond;
+	EdsUInt64								etaMicros;
+}TRANSFER_PROGRESS_SNAPSHOT;
+
+typedef std::function<void(const TRANSFER_PROGRESS_SNAPSHOT&)> TransferProgressListener;
+
+
+// Progress of the downloads of all cameras in the process. DownloadCommand
+// reports each SDK progress tick here; the tracker keeps byte counters and
+// a smoothed throughput per transfer and per body, and says which ticks are
+// worth a ProgressReport, at most maxRate a second per transfer plus the
+// first and the last. Listeners get one snapshot of all active transfers,
+// at most maxRate a second overall, instead of an event per tick.
+// Transfers are cancelled through the SDK progress callback's outCancel.
+class TransferProgressTracker
+{
+public:
+	enum { kDefaultMaxRate = 10 };
+
+private:
+	struct Transfer
+	{
+		TRANSFER_PROGRESS	progress;
+		const CameraModel*	model;
+		EdsUInt64			lastSampleMicros;
+		EdsUInt64			lastSampleBytes;
+		EdsUInt64			lastReportMicros;
+	};
+
+	struct Camera
+	{
+		const CameraModel*			model;
+		CAMERA_TRANSFER_PROGRESS	totals;
+	};
+
+	std::mutex							_mutex;
+	std::vector<Transfer>				_transfers;
+	std::vector<Camera>					_cameras;
+	std::vector<TransferProgressListener>	_listeners;
+	EdsUInt64							_nextID;
+	EdsUInt64							_intervalMicros;
+	EdsUInt64							_lastEmitMicros;
+
+	TransferProgressTracker() : _nextID(1), _intervalMicros(1000000 / kDefaultMaxRate), _lastEmitMicros(0) {}
+	TransferProgressTracker(const TransferProgressTracker&);
+	TransferProgressTracker& operator=(const TransferProgressTracker&);
+
+	Transfer* find(EdsUInt64 id)
+	{
+		for(size_t i = 0; i < _transfers.size(); i++)
+		{
+			if(_transfers[i].progress.id == id)
+			{
+				return &_transfers[i];
+			}
+		}
+		return NULL;
+	}
+
+	Camera& cameraOf(const CameraModel* model, const std::string& name)
+	{
+		for(size_t i = 0; i < _cameras.size(); i++)
+		{
+			if(_cameras[i].model == model)
+			{
+				return _cameras[i];
+			}
+		}
+		Camera camera;
+		camera.model = model;
+		camera.totals = CAMERA_TRANSFER_PROGRESS();
+		camera.totals.camera = name;
+		_cameras.push_back(camera);
+		return _cameras.back();
+	}
+
+	static EdsUInt64 etaOf(EdsUInt64 remaining, double bytesPerSecond)
+	{
+		return (bytesPerSecond > 0.0) ? (EdsUInt64)((double)remaining * 1000000.0 / bytesPerSecond) : 0;
+	}
+
+	// Lock held
+	TRANSFER_PROGRESS_SNAPSHOT snapshotLocked(EdsUInt64 now)
+	{
+		TRANSFER_PROGRESS_SNAPSHOT snapshot;
+		snapshot.timestampMicros = now;
+		snapshot.totalBytes = snapshot.transferredBytes = 0;
+		snapshot.bytesPerSecond = 0.0;
+
+		for(size_t c = 0; c < _cameras.size(); c++)
+		{
+			CAMERA_TRANSFER_PROGRESS camera = _cameras[c].totals;
+			camera.activeTransfers = 0;
+			camera.totalBytes = camera.transferredBytes = 0;
+			camera.bytesPerSecond = 0.0;
+			for(size_t i = 0; i < _transfers.size(); i++)
+			{
+				if(_transfers[i].model == _cameras[c].model)
+				{
+					const TRANSFER_PROGRESS& transfer = _transfers[i].progress;
+					camera.activeTransfers++;
+					camera.totalBytes += transfer.totalBytes;
+					camera.transferredBytes += transfer.transferredBytes;
+					camera.bytesPerSecond += transfer.bytesPerSecond;
+				}
+			}
+			camera.etaMicros = etaOf(camera.totalBytes - camera.transferredBytes, camera.bytesPerSecond);
+
+			snapshot.totalBytes += camera.totalBytes;
+			snapshot.transferredBytes += camera.transferredBytes;
+			snapshot.bytesPerSecond += camera.bytesPerSecond;
+			snapshot.cameras.push_back(camera);
+		}
+
+		for(size_t i = 0; i < _transfers.size(); i++)
+		{
+			TRANSFER_PROGRESS transfer = _transfers[i].progress;
+			transfer.elapsedMicros = now - transfer.startMicros;
+			snapshot.transfers.push_back(transfer);
+		}
+		snapshot.etaMicros = etaOf(snapshot.totalBytes - snapshot.transferredBytes, snapshot.bytesPerSecond);
+		return snapshot;
+	}
+
+	// Called without the lock
+	void emit(EdsUInt64 now, bool force)
+	{
+		TRANSFER_PROGRESS_SNAPSHOT snapshot;
+		std::vector<TransferProgressListener> listeners;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_listeners.empty() || (!force && now - _lastEmitMicros < _intervalMicros))
+			{
+				return;
+			}
+			_lastEmitMicros = now;
+			snapshot = snapshotLocked(now);
+			listeners = _listeners;
+		}
+		for(size_t i = 0; i < listeners.size(); i++)
+		{
+			listeners[i](snapshot);
+		}
+	}
+
+public:
+	// Never destroyed, so transfers still running at exit can report
+	static TransferProgressTracker& instance()
+	{
+		static TransferProgressTracker* tracker = new TransferProgressTracker();
+		return *tracker;
+	}
+
+	// Reports per transfer, and snapshots, a second; 0 for every tick
+	void setMaxRate(double perSecond)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_intervalMicros = (perSecond > 0.0) ? (EdsUInt64)(1000000.0 / perSecond) : 0;
+	}
+
+	double getMaxRate()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return (_intervalMicros > 0) ? 1000000.0 / (double)_intervalMicros : 0.0;
+	}
+
+	// Called on the thread that sends the snapshot; keep it short
+	void addListener(const TransferProgressListener& listener)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_listeners.push_back(listener);
+	}
+
+	void clearListeners()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_listeners.clear();
+	}
+
+	EdsUInt64 begin(const CameraModel* model, const std::string& camera, const EdsDirectoryItemInfo& info)
+	{
+		EdsUInt64 now = evfClockMicros();
+		std::lock_guard<std::mutex> lock(_mutex);
+		Transfer transfer;
+		transfer.progress = TRANSFER_PROGRESS();
+		transfer.progress.id = _nextID++;
+		transfer.progress.camera = camera;
+		transfer.progress.fileName = info.szFileName;
+		transfer.progress.totalBytes = info.size;
+		transfer.progress.startMicros = now;
+		transfer.model = model;
+		transfer.lastSampleMicros = now;
+		transfer.lastSampleBytes = 0;
+		transfer.lastReportMicros = 0;
+		_transfers.push_back(transfer);
+		cameraOf(model, camera);
+		return transfer.progress.id;
+	}
+
+	// A progress tick. True when it should be reported to observers.
+	bool update(EdsUInt64 id, EdsUInt32 percent)
+	{
+		EdsUInt64 now = evfClockMicros();
+		bool report = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			Transfer* transfer = find(id);
+			if(transfer == NULL)
+			{
+				return true;
+			}
+
+			TRANSFER_PROGRESS& progress = transfer->progress;
+			progress.percent = std::min<EdsUInt32>(percent, 100);
+			progress.transferredBytes = progress.totalBytes * progress.percent / 100;
+
+			// Smoothed over the samples, so one late tick does not swing the ETA
+			EdsUInt64 elapsed = now - transfer->lastSampleMicros;
+			if(elapsed > 0 && progress.transferredBytes > transfer->lastSampleBytes)
+			{
+				double rate = (double)(progress.transferredBytes - transfer->lastSampleBytes) * 1000000.0 / (double)elapsed;
+				progress.bytesPerSecond = (progress.bytesPerSecond > 0.0) ? 0.7 * progress.bytesPerSecond + 0.3 * rate : rate;
+				transfer->lastSampleMicros = now;
+				transfer->lastSampleBytes = progress.transferredBytes;
+			}
+			progress.etaMicros = etaOf(progress.totalBytes - progress.transferredBytes, progress.bytesPerSecond);
+
+			report = transfer->lastReportMicros == 0 || progress.percent >= 100 || now - transfer->lastReportMicros >= _intervalMicros;
+			if(report)
+			{
+				transfer->lastReportMicros = now;
+			}
+		}
+		emit(now, false);
+		return report;
+	}
+
+	void end(EdsUInt64 id, EdsError err)
+	{
+		EdsUInt64 now = evfClockMicros();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for(std::vector<Transfer>::iterator i = _transfers.begin(); i != _transfers.end(); ++i)
+			{
+				if(i->progress.id == id)
+				{
+					CAMERA_TRANSFER_PROGRESS& totals = cameraOf(i->model, i->progress.camera).totals;
+					if(err == EDS_ERR_OK)
+					{
+						totals.completedFiles++;
+						totals.completedBytes += i->progress.totalBytes;
+					}
+					else if(err == EDS_ERR_OPERATION_CANCELLED)
+					{
+						totals.cancelledFiles++;
+					}
+					else
+					{
+						totals.failedFiles++;
+					}
+					_transfers.erase(i);
+					break;
+				}
+			}
+		}
+		emit(now, true);
+	}
+
+	// Read from the SDK progress callback, which then cancels the transfer
+	bool isCancelled(EdsUInt64 id)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		Transfer* transfer = find(id);
+		return transfer != NULL && transfer->progress.cancelRequested;
+	}
+
+	// The transfer stops at its next progress tick. False if it is not active.
+	bool cancel(EdsUInt64 id)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		Transfer* transfer = find(id);
+		if(transfer == NULL)
+		{
+			return false;
+		}
+		transfer->progress.cancelRequested = true;
+		return true;
+	}
+
+	// Every active transfer of model, or of all bodies for NULL
+	EdsUInt32 cancelAll(const CameraModel* model = NULL)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		EdsUInt32 count = 0;
+		for(size_t i = 0; i < _transfers.size(); i++)
+		{
+			if(model == NULL || _transfers[i].model == model)
+			{
+				_transfers[i].progress.cancelRequested = true;
+				count++;
+			}
+		}
+		return count;
+	}
+
+	TRANSFER_PROGRESS_SNAPSHOT snapshot()
+	{
+		EdsUInt64 now = evfClockMicros();
+		std::lock_guard<std::mutex> lock(_mutex);
+		return snapshotLocked(now);
+	}
+
+	// Forget the file counts of bodies with nothing in transfer
+	void resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(std::vector<Camera>::iterator i = _cameras.begin(); i != _cameras.end(); )
+		{
+			bool active = false;
+			for(size_t n = 0; n < _transfers.size(); n++)
+			{
+				active = active || (_transfers[n].model == i->model);
+			}
+			if(active)
+			{
+				CAMERA_TRANSFER_PROGRESS& totals = i->totals;
+				totals.completedFiles = totals.completedBytes = totals.failedFiles = totals.cancelledFiles = 0;
+				++i;
+			}
+			else
+			{
+				i = _cameras.erase(i);
+			}
+		}
+	}
+};
@@ -0,0 +1,208 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : TransferRules.h                                                 *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EDSDK.h"
+#include "Trace.h"
+
+
+enum TransferAction
+{
+	kTransferAction_Download = 0,
+	// EdsDownloadCancel instead; the file stays on the card for a later
+	// import. Only taken when the camera saves to its card as well.
+	kTransferAction_LeaveOnCard,
+};
+
+// Matches a file by extension and size; the first matching rule decides.
+typedef struct _TRANSFER_RULE
+{
+	EdsChar			extension[16];	// without the dot, any case; empty for any file
+	EdsUInt64		minSize;		// bytes, 0 for no bound
+	EdsUInt64		maxSize;
+	TransferAction	action;
+}TRANSFER_RULE;
+
+typedef struct _TRANSFER_RULE_STATISTICS
+{
+	EdsUInt64	requests;			// DirItemRequestTransfer seen
+	EdsUInt64	downloaded;
+	EdsUInt64	leftOnCard;
+	EdsUInt64	leftOnCardBytes;	// kept off the link
+	EdsUInt64	kept;				// would have been left, but the camera saves to the host only
+}TRANSFER_RULE_STATISTICS;
+
+
+// Which requested transfers cross the link. Decided in the object event
+// handler, before anything is queued, so a file left on the card costs one
+// EdsGetDirectoryItemInfo and an EdsDownloadCancel.
+class TransferRules
+{
+private:
+	std::vector<TRANSFER_RULE>	_rules;
+	TransferAction				_defaultAction;
+	TRANSFER_RULE_STATISTICS	_statistics;
+	mutable std::mutex			_mutex;
+
+	static bool sameExtension(const char* fileName, const char* extension)
+	{
+		if(extension[0] == '\0')
+		{
+			return true;
+		}
+		const char* dot = strrchr(fileName, '.');
+		if(dot == NULL)
+		{
+			return false;
+		}
+		const char* a = dot + 1;
+		const char* b = extension[0] == '.' ? extension + 1 : extension;
+		for(; *a != '\0' && *b != '\0'; a++, b++)
+		{
+			if(tolower((unsigned char)*a) != tolower((unsigned char)*b))
+			{
+				return false;
+			}
+		}
+		return *a == '\0' && *b == '\0';
+	}
+
+	static bool matches(const TRANSFER_RULE& rule, const EdsDirectoryItemInfo& info)
+	{
+		return sameExtension(info.szFileName, rule.extension) &&
+			(rule.minSize == 0 || info.size >= rule.minSize) &&
+			(rule.maxSize == 0 || info.size <= rule.maxSize);
+	}
+
+public:
+	TransferRules() : _defaultAction(kTransferAction_Download)
+	{
+		memset(&_statistics, 0, sizeof(_statistics));
+	}
+
+	static TRANSFER_RULE makeRule(const char* extension, TransferAction action, EdsUInt64 minSize = 0, EdsUInt64 maxSize = 0)
+	{
+		TRANSFER_RULE rule;
+		memset(&rule, 0, sizeof(rule));
+		if(extension != NULL)
+		{
+			strncpy(rule.extension, extension, sizeof(rule.extension) - 1);
+		}
+		rule.minSize = minSize;
+		rule.maxSize = maxSize;
+		rule.action = action;
+		return rule;
+	}
+
+	void addRule(const TRANSFER_RULE& rule)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_rules.push_back(rule);
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_rules.clear();
+		_defaultAction = kTransferAction_Download;
+	}
+
+	std::vector<TRANSFER_RULE> getRules() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _rules;
+	}
+
+	// For files no rule matches
+	void setDefaultAction(TransferAction action)	{ std::lock_guard<std::mutex> lock(_mutex); _defaultAction = action; }
+	TransferAction getDefaultAction() const			{ std::lock_guard<std::mutex> lock(_mutex); return _defaultAction; }
+
+	bool isEmpty() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _rules.empty() && _defaultAction == kTransferAction_Download;
+	}
+
+	TransferAction match(const EdsDirectoryItemInfo& info) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(size_t i = 0; i < _rules.size(); i++)
+		{
+			if(matches(_rules[i], info))
+			{
+				return _rules[i].action;
+			}
+		}
+		return _defaultAction;
+	}
+
+	// What to do with a requested transfer under the camera's kEdsPropID_SaveTo.
+	// A file the card does not keep is always downloaded.
+	TransferAction decide(EdsDirectoryItemRef item, EdsUInt32 saveTo)
+	{
+		TransferAction action = kTransferAction_Download;
+		EdsDirectoryItemInfo info;
+		memset(&info, 0, sizeof(info));
+
+		if(!isEmpty())
+		{
+			EdsError err;
+			{
+				TraceScope trace("EDSDK", "EdsGetDirectoryItemInfo");
+				err = EdsGetDirectoryItemInfo(item, &info);
+				trace.setArg("error", err);
+			}
+			if(err == EDS_ERR_OK)
+			{
+				action = match(info);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_statistics.requests++;
+		if(action == kTransferAction_LeaveOnCard && (saveTo & kEdsSaveTo_Camera) == 0)
+		{
+			_statistics.kept++;
+			action = kTransferAction_Download;
+		}
+
+		if(action == kTransferAction_LeaveOnCard)
+		{
+			_statistics.leftOnCard++;
+			_statistics.leftOnCardBytes += info.size;
+		}
+		else
+		{
+			_statistics.downloaded++;
+		}
+		return action;
+	}
+
+	TRANSFER_RULE_STATISTICS getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _statistics;
+	}
+
+	void resetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		memset(&_statistics, 0, sizeof(_statistics));
+	}
+};
+
+typedef std::shared_ptr<TransferRules> TransferRulesRef;
@@ -0,0 +1,177 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : XxHash64.h                                                      *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include "EDSDK.h"
+
+
+// Streaming XXH64, bit-compatible with the reference implementation
+// (xxhsum -H1). Fast enough to run alongside a USB transfer; it is a
+// checksum, not a cryptographic hash.
+class XxHash64
+{
+private:
+	static const EdsUInt64 kPrime1 = 11400714785074694791ULL;
+	static const EdsUInt64 kPrime2 = 14029467366897019727ULL;
+	static const EdsUInt64 kPrime3 = 1609587929392839161ULL;
+	static const EdsUInt64 kPrime4 = 9650029242287828579ULL;
+	static const EdsUInt64 kPrime5 = 2870177450012600261ULL;
+
+	EdsUInt64		_seed;
+	EdsUInt64		_v[4];
+	EdsUInt64		_totalLength;
+	unsigned char	_buffer[32];
+	size_t			_buffered;
+
+public:
+	XxHash64(EdsUInt64 seed = 0)
+	{
+		reset(seed);
+	}
+
+	void reset(EdsUInt64 seed = 0)
+	{
+		_seed = seed;
+		_v[0] = seed + kPrime1 + kPrime2;
+		_v[1] = seed + kPrime2;
+		_v[2] = seed;
+		_v[3] = seed - kPrime1;
+		_totalLength = 0;
+		_buffered = 0;
+	}
+
+	void update(const void* data, size_t length)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		const unsigned char* end = p + length;
+		_totalLength += length;
+
+		if(_buffered + length < 32)
+		{
+			memcpy(_buffer + _buffered, p, length);
+			_buffered += length;
+			return;
+		}
+
+		if(_buffered > 0)
+		{
+			size_t fill = 32 - _buffered;
+			memcpy(_buffer + _buffered, p, fill);
+			p += fill;
+			consume(_buffer);
+			_buffered = 0;
+		}
+
+		for(; p + 32 <= end; p += 32)
+		{
+			consume(p);
+		}
+
+		_buffered = (size_t)(end - p);
+		memcpy(_buffer, p, _buffered);
+	}
+
+	EdsUInt64 digest() const
+	{
+		EdsUInt64 h;
+		if(_totalLength >= 32)
+		{
+			h = rotl(_v[0], 1) + rotl(_v[1], 7) + rotl(_v[2], 12) + rotl(_v[3], 18);
+			for(int i = 0; i < 4; i++)
+			{
+				h = mergeRound(h, _v[i]);
+			}
+		}
+		else
+		{
+			h = _seed + kPrime5;
+		}
+		h += _totalLength;
+
+		const unsigned char* p = _buffer;
+		const unsigned char* end = _buffer + _buffered;
+		for(; p + 8 <= end; p += 8)
+		{
+			h ^= round(0, read64(p));
+			h = rotl(h, 27) * kPrime1 + kPrime4;
+		}
+		if(p + 4 <= end)
+		{
+			h ^= (EdsUInt64)read32(p) * kPrime1;
+			h = rotl(h, 23) * kPrime2 + kPrime3;
+			p += 4;
+		}
+		for(; p < end; p++)
+		{
+			h ^= (*p) * kPrime5;
+			h = rotl(h, 11) * kPrime1;
+		}
+
+		h ^= h >> 33;
+		h *= kPrime2;
+		h ^= h >> 29;
+		h *= kPrime3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	static EdsUInt64 hash(const void* data, size_t length, EdsUInt64 seed = 0)
+	{
+		XxHash64 hasher(seed);
+		hasher.update(data, length);
+		return hasher.digest();
+	}
+
+protected:
+	void consume(const unsigned char* p)
+	{
+		for(int i = 0; i < 4; i++)
+		{
+			_v[i] = round(_v[i], read64(p + 8 * i));
+		}
+	}
+
+	static EdsUInt64 rotl(EdsUInt64 value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	static EdsUInt64 round(EdsUInt64 acc, EdsUInt64 input)
+	{
+		acc += input * kPrime2;
+		acc = rotl(acc, 31);
+		return acc * kPrime1;
+	}
+
+	static EdsUInt64 mergeRound(EdsUInt64 acc, EdsUInt64 value)
+	{
+		acc ^= round(0, value);
+		return acc * kPrime1 + kPrime4;
+	}
+
+	// Little-endian hosts only, as are all EDSDK platforms.
+	static EdsUInt64 read64(const unsigned char* p)
+	{
+		EdsUInt64 value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	static EdsUInt32 read32(const unsigned char* p)
+	{
+		EdsUInt32 value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+};
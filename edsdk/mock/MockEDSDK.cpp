@@ -0,0 +1,2630 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : MockEDSDK.cpp                                                   *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MockEDSDK.h"
+#include "PropertyLabels.h"
+#include "Trace.h"
+
+
+static std::atomic<EdsUInt64> g_liveObjects(0);
+
+static EdsUInt64 mockClockMicros()
+{
+	return (EdsUInt64)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void simulateLatency(EdsUInt64 micros)
+{
+	if(micros > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(micros));
+	}
+}
+
+
+// Card layout: DCIM/100CANON holds the first files, then 101CANON and on
+static const EdsUInt32 kMockFilesPerFolder = 1000;
+
+
+// Every ref handed out is one of these
+struct __EdsObject
+{
+	std::atomic<EdsUInt32>	refCount;
+
+	__EdsObject() : refCount(1)		{ g_liveObjects++; }
+	virtual ~__EdsObject()			{ g_liveObjects--; }
+};
+
+
+/******************************************************************************
+ Synthetic JPEG
+******************************************************************************/
+
+// Baseline greyscale JPEG with the Annex K luminance tables. Frames are
+// encoded once at EdsInitializeSDK, so speed does not matter here.
+class MockJpegEncoder
+{
+private:
+	std::vector<unsigned char>&	_out;
+	EdsUInt32					_bitBuffer;
+	int							_bitCount;
+
+	unsigned short				_dcCodes[12];
+	unsigned char				_dcSizes[12];
+	unsigned short				_acCodes[256];
+	unsigned char				_acSizes[256];
+
+	static const unsigned char* dcBits()	{ static const unsigned char bits[16] = {0,1,5,1,1,1,1,1,1,0,0,0,0,0,0,0}; return bits; }
+	static const unsigned char* dcValues()	{ static const unsigned char values[12] = {0,1,2,3,4,5,6,7,8,9,10,11}; return values; }
+	static const unsigned char* acBits()	{ static const unsigned char bits[16] = {0,2,1,3,3,2,4,3,5,5,4,4,0,0,1,0x7d}; return bits; }
+	static const unsigned char* acValues()
+	{
+		static const unsigned char values[162] =
+		{
+			0x01,0x02,0x03,0x00,0x04,0x11,0x05,0x12,0x21,0x31,0x41,0x06,0x13,0x51,0x61,0x07,
+			0x22,0x71,0x14,0x32,0x81,0x91,0xa1,0x08,0x23,0x42,0xb1,0xc1,0x15,0x52,0xd1,0xf0,
+			0x24,0x33,0x62,0x72,0x82,0x09,0x0a,0x16,0x17,0x18,0x19,0x1a,0x25,0x26,0x27,0x28,
+			0x29,0x2a,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,0x49,
+			0x4a,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x63,0x64,0x65,0x66,0x67,0x68,0x69,
+			0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x83,0x84,0x85,0x86,0x87,0x88,0x89,
+			0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,
+			0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xc2,0xc3,0xc4,0xc5,
+			0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,0xe1,0xe2,
+			0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,
+			0xf9,0xfa
+		};
+		return values;
+	}
+	static const unsigned char* zigzag()
+	{
+		static const unsigned char order[64] =
+		{
+			 0, 1, 8,16, 9, 2, 3,10,17,24,32,25,18,11, 4, 5,
+			12,19,26,33,40,48,41,34,27,20,13, 6, 7,14,21,28,
+			35,42,49,56,57,50,43,36,29,22,15,23,30,37,44,51,
+			58,59,52,45,38,31,39,46,53,60,61,54,47,55,62,63
+		};
+		return order;
+	}
+	// Annex K luminance table, natural order, at quality 90
+	static const unsigned char* quantTable()
+	{
+		static unsigned char table[64] = {0};
+		static const unsigned char base[64] =
+		{
+			16,11,10,16, 24, 40, 51, 61,	12,12,14,19, 26, 58, 60, 55,
+			14,13,16,24, 40, 57, 69, 56,	14,17,22,29, 51, 87, 80, 62,
+			18,22,37,56, 68,109,103, 77,	24,35,55,64, 81,104,113, 92,
+			49,64,78,87,103,121,120,101,	72,92,95,98,112,100,103, 99
+		};
+		if(table[0] == 0)
+		{
+			for(int i = 0; i < 64; i++)
+			{
+				int q = (base[i] * 20 + 50) / 100;
+				table[i] = (unsigned char)std::min(255, std::max(1, q));
+			}
+		}
+		return table;
+	}
+
+	static void buildCodes(const unsigned char* bits, const unsigned char* values, unsigned short* codes, unsigned char* sizes)
+	{
+		int code = 0;
+		int k = 0;
+		for(int length = 1; length <= 16; length++)
+		{
+			for(int i = 0; i < bits[length - 1]; i++)
+			{
+				codes[values[k]] = (unsigned short)code;
+				sizes[values[k]] = (unsigned char)length;
+				code++;
+				k++;
+			}
+			code <<= 1;
+		}
+	}
+
+	void putByte(int value)		{ _out.push_back((unsigned char)value); }
+	void putWord(int value)		{ putByte(value >> 8); putByte(value & 0xff); }
+
+	void putBits(EdsUInt32 bits, int count)
+	{
+		for(int i = count - 1; i >= 0; i--)
+		{
+			_bitBuffer = (_bitBuffer << 1) | ((bits >> i) & 1);
+			if(++_bitCount == 8)
+			{
+				putByte((int)_bitBuffer);
+				if(_bitBuffer == 0xff)
+				{
+					putByte(0);
+				}
+				_bitBuffer = 0;
+				_bitCount = 0;
+			}
+		}
+	}
+
+	void flushBits()
+	{
+		while(_bitCount != 0)
+		{
+			putBits(1, 1);
+		}
+	}
+
+	static int category(int value)
+	{
+		int magnitude = (value < 0) ? -value : value;
+		int bits = 0;
+		while(magnitude != 0)
+		{
+			bits++;
+			magnitude >>= 1;
+		}
+		return bits;
+	}
+
+	void putValue(int value, int bits)
+	{
+		putBits((EdsUInt32)((value < 0) ? value - 1 : value) & ((1u << bits) - 1), bits);
+	}
+
+	int encodeBlock(const float* samples, int previousDC)
+	{
+		static float cosines[8][8];
+		static bool ready = false;
+		if(!ready)
+		{
+			for(int u = 0; u < 8; u++)
+			{
+				for(int x = 0; x < 8; x++)
+				{
+					cosines[u][x] = (float)(((u == 0) ? std::sqrt(0.125) : 0.5) * std::cos((2 * x + 1) * u * 3.14159265358979 / 16.0));
+				}
+			}
+			ready = true;
+		}
+
+		float rows[64];
+		for(int y = 0; y < 8; y++)
+		{
+			for(int u = 0; u < 8; u++)
+			{
+				float sum = 0.0f;
+				for(int x = 0; x < 8; x++)
+				{
+					sum += cosines[u][x] * samples[y * 8 + x];
+				}
+				rows[y * 8 + u] = sum;
+			}
+		}
+
+		const unsigned char* quant = quantTable();
+		int coefficients[64];
+		for(int v = 0; v < 8; v++)
+		{
+			for(int u = 0; u < 8; u++)
+			{
+				float sum = 0.0f;
+				for(int y = 0; y < 8; y++)
+				{
+					sum += cosines[v][y] * rows[y * 8 + u];
+				}
+				coefficients[v * 8 + u] = (int)std::floor(sum / quant[v * 8 + u] + 0.5f);
+			}
+		}
+
+		const unsigned char* order = zigzag();
+		int dc = coefficients[0];
+		int diff = dc - previousDC;
+		int bits = category(diff);
+		putBits(_dcCodes[bits], _dcSizes[bits]);
+		putValue(diff, bits);
+
+		int run = 0;
+		for(int k = 1; k < 64; k++)
+		{
+			int ac = coefficients[order[k]];
+			if(ac == 0)
+			{
+				run++;
+				continue;
+			}
+			while(run > 15)
+			{
+				putBits(_acCodes[0xf0], _acSizes[0xf0]);
+				run -= 16;
+			}
+			bits = category(ac);
+			int symbol = (run << 4) | bits;
+			putBits(_acCodes[symbol], _acSizes[symbol]);
+			putValue(ac, bits);
+			run = 0;
+		}
+		if(run > 0)
+		{
+			putBits(_acCodes[0], _acSizes[0]);
+		}
+		return dc;
+	}
+
+public:
+	MockJpegEncoder(std::vector<unsigned char>& out) : _out(out), _bitBuffer(0), _bitCount(0)
+	{
+		memset(_acCodes, 0, sizeof(_acCodes));
+		memset(_acSizes, 0, sizeof(_acSizes));
+		buildCodes(dcBits(), dcValues(), _dcCodes, _dcSizes);
+		buildCodes(acBits(), acValues(), _acCodes, _acSizes);
+	}
+
+	void encode(const unsigned char* pixels, int width, int height)
+	{
+		static const unsigned char jfif[] = { 'J','F','I','F',0, 1,1, 0, 0,1, 0,1, 0,0 };
+
+		putWord(0xffd8);
+
+		putWord(0xffe0);
+		putWord(2 + sizeof(jfif));
+		_out.insert(_out.end(), jfif, jfif + sizeof(jfif));
+
+		putWord(0xffdb);
+		putWord(2 + 1 + 64);
+		putByte(0);
+		for(int k = 0; k < 64; k++)
+		{
+			putByte(quantTable()[zigzag()[k]]);
+		}
+
+		putWord(0xffc0);
+		putWord(2 + 6 + 3);
+		putByte(8);
+		putWord(height);
+		putWord(width);
+		putByte(1);
+		putByte(1); putByte(0x11); putByte(0);
+
+		putWord(0xffc4);
+		putWord(2 + 1 + 16 + 12);
+		putByte(0x00);
+		_out.insert(_out.end(), dcBits(), dcBits() + 16);
+		_out.insert(_out.end(), dcValues(), dcValues() + 12);
+
+		putWord(0xffc4);
+		putWord(2 + 1 + 16 + 162);
+		putByte(0x10);
+		_out.insert(_out.end(), acBits(), acBits() + 16);
+		_out.insert(_out.end(), acValues(), acValues() + 162);
+
+		putWord(0xffda);
+		putWord(2 + 1 + 2 + 3);
+		putByte(1);
+		putByte(1); putByte(0x00);
+		putByte(0); putByte(63); putByte(0);
+
+		int previousDC = 0;
+		float samples[64];
+		for(int by = 0; by < height; by += 8)
+		{
+			for(int bx = 0; bx < width; bx += 8)
+			{
+				for(int y = 0; y < 8; y++)
+				{
+					int sy = std::min(by + y, height - 1);
+					for(int x = 0; x < 8; x++)
+					{
+						int sx = std::min(bx + x, width - 1);
+						samples[y * 8 + x] = (float)pixels[sy * width + sx] - 128.0f;
+					}
+				}
+				previousDC = encodeBlock(samples, previousDC);
+			}
+		}
+		flushBits();
+
+		putWord(0xffd9);
+	}
+};
+
+
+// One encoded live view frame and the histogram the camera reports with it
+typedef struct _MOCK_FRAME
+{
+	std::vector<unsigned char>	jpeg;
+	std::vector<EdsUInt32>		histogram;	// 256 * YRGB
+}MOCK_FRAME;
+
+typedef std::shared_ptr<const MOCK_FRAME> MockFrameRef;
+typedef std::shared_ptr<const std::vector<unsigned char> > MockPayloadRef;
+
+// A gradient with fine texture and a bar that moves with frameIndex, so
+// decoders, focus and motion measures all have something to work on.
+static MockFrameRef makeFrame(int width, int height, int frameIndex, EdsUInt32 seed)
+{
+	std::vector<unsigned char> pixels((size_t)width * height);
+	int barWidth = std::max(8, width / 20);
+	int barX = (frameIndex * width / 16) % width;
+
+	EdsUInt32 noise = seed * 2654435761u + (EdsUInt32)frameIndex + 1;
+	std::shared_ptr<MOCK_FRAME> frame = std::make_shared<MOCK_FRAME>();
+	frame->histogram.assign(256 * 4, 0);
+
+	for(int y = 0; y < height; y++)
+	{
+		for(int x = 0; x < width; x++)
+		{
+			noise ^= noise << 13;
+			noise ^= noise >> 17;
+			noise ^= noise << 5;
+
+			int value = 32 + x * 160 / width + y * 48 / height;
+			value += ((x ^ y) & 8) ? 10 : 0;
+			value += (int)(noise & 15) - 8;
+			if(x >= barX && x < barX + barWidth)
+			{
+				value = 230 + (int)(noise & 7);
+			}
+			value = std::min(255, std::max(0, value));
+			pixels[(size_t)y * width + x] = (unsigned char)value;
+
+			EdsUInt32* bin = &frame->histogram[value * 4];
+			bin[0]++; bin[1]++; bin[2]++; bin[3]++;
+		}
+	}
+
+	frame->jpeg.reserve((size_t)width * height / 4);
+	MockJpegEncoder(frame->jpeg).encode(&pixels[0], width, height);
+	return frame;
+}
+
+// Looks like a CR2 to anything reading the first bytes; the rest is noise
+static MockPayloadRef makeRaw(EdsUInt32 size, EdsUInt32 seed)
+{
+	std::shared_ptr<std::vector<unsigned char> > raw = std::make_shared<std::vector<unsigned char> >(size);
+	static const unsigned char header[] = { 'I','I',0x2a,0, 0x10,0,0,0, 'C','R',2,0 };
+	EdsUInt32 noise = seed | 1;
+	for(EdsUInt32 i = 0; i < size; i++)
+	{
+		noise ^= noise << 13;
+		noise ^= noise >> 17;
+		noise ^= noise << 5;
+		(*raw)[i] = (i < sizeof(header)) ? header[i] : (unsigned char)noise;
+	}
+	return raw;
+}
+
+
+/******************************************************************************
+ Objects
+******************************************************************************/
+
+class MockStream : public __EdsObject
+{
+public:
+	unsigned char*		memory;
+	EdsUInt64			capacity;
+	FILE*				file;
+	EdsUInt64			position;
+	EdsProgressCallback	progress;
+	EdsVoid*			progressContext;
+	// EdsCreateMemoryStream: memory is owned and grows with each write
+	bool				growable;
+	std::vector<unsigned char>	owned;
+
+	MockStream() : memory(NULL), capacity(0), file(NULL), position(0), progress(NULL), progressContext(NULL), growable(false) {}
+
+	virtual ~MockStream()
+	{
+		if(file != NULL)
+		{
+			fclose(file);
+		}
+	}
+
+	EdsError write(const unsigned char* data, EdsUInt64 size)
+	{
+		if(file != NULL)
+		{
+			if(fwrite(data, 1, (size_t)size, file) != (size_t)size)
+			{
+				return EDS_ERR_STREAM_WRITE_ERROR;
+			}
+			position += size;
+			return EDS_ERR_OK;
+		}
+		if(position + size > capacity && growable)
+		{
+			owned.resize((size_t)(position + size));
+			memory = &owned[0];
+			capacity = owned.size();
+		}
+		if(position + size > capacity)
+		{
+			return EDS_ERR_STREAM_END_OF_STREAM;
+		}
+		memcpy(memory + position, data, (size_t)size);
+		position += size;
+		return EDS_ERR_OK;
+	}
+
+	EdsUInt64 length()
+	{
+		if(file == NULL)
+		{
+			return capacity;
+		}
+		long current = ftell(file);
+		fseek(file, 0, SEEK_END);
+		long end = ftell(file);
+		fseek(file, current, SEEK_SET);
+		return (EdsUInt64)end;
+	}
+
+	// The whole stream, read back without moving the position
+	bool contents(std::vector<unsigned char>& out)
+	{
+		if(file == NULL)
+		{
+			out.assign(memory, memory + (size_t)capacity);
+			return true;
+		}
+		long current = ftell(file);
+		out.resize((size_t)length());
+		fseek(file, 0, SEEK_SET);
+		bool read = out.empty() || fread(&out[0], 1, out.size(), file) == out.size();
+		fseek(file, current, SEEK_SET);
+		return read;
+	}
+};
+
+
+class MockEvfImage : public __EdsObject
+{
+public:
+	MockStream*		stream;
+	MockFrameRef	frame;
+	EdsUInt32		zoom;
+	EdsPoint		imagePosition;
+	EdsRect			zoomRect;
+	EdsSize			coordinateSystem;
+
+	MockEvfImage(MockStream* inStream) : stream(inStream), zoom(1)
+	{
+		stream->refCount++;
+		memset(&imagePosition, 0, sizeof(imagePosition));
+		memset(&zoomRect, 0, sizeof(zoomRect));
+		memset(&coordinateSystem, 0, sizeof(coordinateSystem));
+	}
+
+	virtual ~MockEvfImage()
+	{
+		EdsRelease(stream);
+	}
+};
+
+
+// A file or folder. On a card it is held by its parent, which holds one
+// reference to each child; a transfer request item has no parent.
+class MockDirectoryItem : public __EdsObject
+{
+public:
+	EdsDirectoryItemInfo			info;
+	MockPayloadRef					payload;
+	MockPayloadRef					thumbnail;
+	EdsUInt64						offset;
+	__EdsObject*					parent;
+	std::vector<MockDirectoryItem*>	children;
+
+	MockDirectoryItem() : offset(0), parent(NULL) { memset(&info, 0, sizeof(info)); }
+
+	virtual ~MockDirectoryItem()
+	{
+		for(size_t i = 0; i < children.size(); i++)
+		{
+			children[i]->parent = NULL;
+			EdsRelease(children[i]);
+		}
+	}
+};
+
+
+class MockCamera;
+
+class MockVolume : public __EdsObject
+{
+public:
+	EdsVolumeInfo					info;
+	MockCamera*						camera;
+	std::vector<MockDirectoryItem*>	children;
+
+	MockVolume(MockCamera* inCamera) : camera(inCamera) { memset(&info, 0, sizeof(info)); }
+
+	virtual ~MockVolume()
+	{
+		for(size_t i = 0; i < children.size(); i++)
+		{
+			children[i]->parent = NULL;
+			EdsRelease(children[i]);
+		}
+	}
+};
+
+
+// A file opened with EdsCreateImageRef, JPEG or the mock RAW
+class MockImage : public __EdsObject
+{
+public:
+	EdsUInt32	width;
+	EdsUInt32	height;
+	bool		raw;
+
+	MockImage() : width(0), height(0), raw(false) {}
+
+	// Size of each image the file holds; false for one it does not
+	bool sourceSize(EdsImageSource source, EdsUInt32& outWidth, EdsUInt32& outHeight) const
+	{
+		EdsUInt32 limit = 0;
+		switch(source)
+		{
+		case kEdsImageSrc_FullView:		limit = width;	break;
+		case kEdsImageSrc_Thumbnail:	limit = 160;	break;
+		case kEdsImageSrc_Preview:		limit = 1620;	break;
+		case kEdsImageSrc_RAWThumbnail:	if(!raw) return false; limit = 160;		break;
+		case kEdsImageSrc_RAWFullView:	if(!raw) return false; limit = width;	break;
+		default:						return false;
+		}
+		outWidth = std::min(width, limit);
+		outHeight = std::max<EdsUInt32>(1, (EdsUInt32)((EdsUInt64)height * outWidth / width));
+		return true;
+	}
+};
+
+
+typedef struct _MOCK_PROPERTY
+{
+	EdsDataType					dataType;
+	std::vector<unsigned char>	data;
+	EdsPropertyDesc				desc;
+}MOCK_PROPERTY;
+
+
+class MockCamera : public __EdsObject
+{
+public:
+	EdsUInt32							index;
+	EdsDeviceInfo						deviceInfo;
+	bool								sessionOpen;
+	std::map<EdsPropertyID, MOCK_PROPERTY>	properties;
+
+	EdsPropertyEventHandler				propertyHandler;
+	EdsVoid*							propertyContext;
+	EdsObjectEventHandler				objectHandler;
+	EdsVoid*							objectContext;
+	EdsStateEventHandler				stateHandler;
+	EdsVoid*							stateContext;
+
+	// Live view clock: frame n is ready at evfStartMicros + n * interval
+	EdsUInt64							evfStartMicros;
+	EdsUInt64							evfLastTick;
+	EdsUInt32							fileNumber;
+	// Cards, each holding one reference
+	std::vector<MockVolume*>			volumes;
+
+	MockCamera(EdsUInt32 inIndex) : index(inIndex), sessionOpen(false),
+		propertyHandler(NULL), propertyContext(NULL), objectHandler(NULL), objectContext(NULL), stateHandler(NULL), stateContext(NULL),
+		evfStartMicros(0), evfLastTick((EdsUInt64)-1), fileNumber(0)
+	{
+		memset(&deviceInfo, 0, sizeof(deviceInfo));
+		snprintf(deviceInfo.szPortName, sizeof(deviceInfo.szPortName), "mock:%u", (unsigned)index);
+		snprintf(deviceInfo.szDeviceDescription, sizeof(deviceInfo.szDeviceDescription), "Canon EOS Mock %u", (unsigned)index);
+		deviceInfo.deviceSubType = 1;
+
+		char text[EDS_MAX_NAME];
+		setString(kEdsPropID_ProductName, "Canon EOS Mock");
+		snprintf(text, sizeof(text), "MOCK%08u", (unsigned)index);
+		setString(kEdsPropID_BodyIDEx, text);
+		setString(kEdsPropID_FirmwareVersion, "1.0.0");
+
+		// Every property with a label table, starting mid-range
+		for(size_t i = 0; i < sizeof(kPropertyLabelTables) / sizeof(kPropertyLabelTables[0]); i++)
+		{
+			const PROPERTY_LABEL_TABLE& table = kPropertyLabelTables[i];
+			EdsPropertyDesc desc;
+			memset(&desc, 0, sizeof(desc));
+			for(size_t n = 0; n < table.count && desc.numElements < 128; n++)
+			{
+				if(table.labels[n].value != 0xffffffff)
+				{
+					desc.propDesc[desc.numElements++] = (EdsInt32)table.labels[n].value;
+				}
+			}
+			EdsUInt32 value = (desc.numElements > 0) ? (EdsUInt32)desc.propDesc[desc.numElements / 2] : 0;
+			setUInt32(table.propertyID, value);
+			if(desc.numElements > 0)
+			{
+				properties[table.propertyID].desc = desc;
+			}
+		}
+
+		setUInt32(kEdsPropID_DriveMode, 0);
+		setUInt32(kEdsPropID_AFMode, 0);
+		setUInt32(kEdsPropID_SaveTo, kEdsSaveTo_Camera);
+		setUInt32(kEdsPropID_BatteryLevel, 100);
+		setUInt32(kEdsPropID_AvailableShots, 9999);
+		setUInt32(kEdsPropID_Evf_Mode, 1);
+		setUInt32(kEdsPropID_Evf_OutputDevice, kEdsEvfOutputDevice_TFT);
+		setUInt32(kEdsPropID_Evf_DepthOfFieldPreview, 0);
+		setUInt32(kEdsPropID_Evf_Zoom, 1);
+
+		EdsPoint center = { 0, 0 };
+		setData(kEdsPropID_Evf_ZoomPosition, kEdsDataType_Point, &center, sizeof(center));
+	}
+
+	virtual ~MockCamera()
+	{
+		for(size_t i = 0; i < volumes.size(); i++)
+		{
+			volumes[i]->camera = NULL;
+			EdsRelease(volumes[i]);
+		}
+	}
+
+	void setData(EdsPropertyID propertyID, EdsDataType dataType, const void* data, size_t size)
+	{
+		MOCK_PROPERTY& property = properties[propertyID];
+		property.dataType = dataType;
+		property.data.assign((const unsigned char*)data, (const unsigned char*)data + size);
+	}
+
+	void setUInt32(EdsPropertyID propertyID, EdsUInt32 value)
+	{
+		setData(propertyID, kEdsDataType_UInt32, &value, sizeof(value));
+	}
+
+	void setString(EdsPropertyID propertyID, const char* value)
+	{
+		setData(propertyID, kEdsDataType_String, value, strlen(value) + 1);
+	}
+
+	EdsUInt32 getUInt32(EdsPropertyID propertyID)
+	{
+		EdsUInt32 value = 0;
+		std::map<EdsPropertyID, MOCK_PROPERTY>::const_iterator it = properties.find(propertyID);
+		if(it != properties.end() && it->second.data.size() == sizeof(value))
+		{
+			memcpy(&value, &it->second.data[0], sizeof(value));
+		}
+		return value;
+	}
+};
+
+
+class MockCameraList : public __EdsObject
+{
+public:
+	std::vector<MockCamera*>	cameras;
+
+	virtual ~MockCameraList()
+	{
+		for(size_t i = 0; i < cameras.size(); i++)
+		{
+			EdsRelease(cameras[i]);
+		}
+	}
+};
+
+
+/******************************************************************************
+ SDK state
+******************************************************************************/
+
+typedef enum
+{
+	kMockEvent_Property = 0,
+	kMockEvent_Object,
+	kMockEvent_State,
+	kMockEvent_CameraAdded,		// to the SDK's handler, camera only retained
+}MockEventKind;
+
+typedef struct _MOCK_EVENT
+{
+	MockEventKind	kind;
+	MockCamera*		camera;		// retained until delivered
+	EdsUInt32		event;
+	EdsUInt32		param;
+	EdsBaseRef		ref;		// handed to the object handler
+}MOCK_EVENT;
+
+
+class MockSdk
+{
+public:
+	std::mutex								mutex;
+	std::condition_variable					wake;
+	MOCK_EDSDK_CONFIG						config;
+	EdsUInt32								initializeCount;
+	std::vector<MockCamera*>				cameras;
+	EdsUInt32								nextCameraIndex;
+	EdsCameraAddedHandler					cameraAddedHandler;
+	EdsVoid*								cameraAddedContext;
+	std::multimap<EdsUInt64, MOCK_EVENT>	events;
+	// Bodies after a USB reset, by when they are back in the camera list
+	std::multimap<EdsUInt64, MockCamera*>	returning;
+	std::thread								eventThread;
+	bool									stopping;
+	EdsUInt64								random;
+
+	std::vector<MockFrameRef>				evfFrames;
+	MockPayloadRef							jpeg;
+	MockPayloadRef							raw;
+	MockPayloadRef							thumbnail;
+
+	std::atomic<EdsUInt64>					calls;
+	std::atomic<EdsUInt64>					busyInjected;
+	std::atomic<EdsUInt64>					evfDelivered;
+	std::atomic<EdsUInt64>					evfNotReady;
+	std::atomic<EdsUInt64>					captures;
+	std::atomic<EdsUInt64>					transferRequests;
+	std::atomic<EdsUInt64>					bytesDownloaded;
+	std::atomic<EdsUInt64>					thumbnails;
+	std::atomic<EdsUInt64>					eventsDelivered;
+
+	MockSdk() : initializeCount(0), nextCameraIndex(0), cameraAddedHandler(NULL), cameraAddedContext(NULL), stopping(false), random(0)
+	{
+		MockEdsGetDefaultConfig(&config);
+		resetStatistics();
+	}
+
+	void resetStatistics()
+	{
+		calls = 0;
+		busyInjected = 0;
+		evfDelivered = 0;
+		evfNotReady = 0;
+		captures = 0;
+		transferRequests = 0;
+		bytesDownloaded = 0;
+		thumbnails = 0;
+		eventsDelivered = 0;
+	}
+
+	// Mutex held
+	bool drawBusy()
+	{
+		if(config.busyPermille == 0)
+		{
+			return false;
+		}
+		random ^= random << 13;
+		random ^= random >> 7;
+		random ^= random << 17;
+		if((random % 1000) < config.busyPermille)
+		{
+			busyInjected++;
+			return true;
+		}
+		return false;
+	}
+
+	// Mutex held
+	void post(EdsUInt64 due, MockEventKind kind, MockCamera* camera, EdsUInt32 event, EdsUInt32 param, EdsBaseRef ref)
+	{
+		MOCK_EVENT e = { kind, camera, event, param, ref };
+		camera->refCount++;
+		events.insert(std::make_pair(due, e));
+		wake.notify_all();
+	}
+
+	// Mutex held
+	void admitReturning(EdsUInt64 now)
+	{
+		while(!returning.empty() && returning.begin()->first <= now)
+		{
+			cameras.push_back(returning.begin()->second);
+			returning.erase(returning.begin());
+		}
+	}
+
+	// Hand due events to the handlers, outside the mutex so they can call
+	// back into the SDK
+	void deliverDue()
+	{
+		std::vector<MOCK_EVENT> due;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			EdsUInt64 now = mockClockMicros();
+			admitReturning(now);
+			while(!events.empty() && events.begin()->first <= now)
+			{
+				due.push_back(events.begin()->second);
+				events.erase(events.begin());
+			}
+		}
+
+		for(size_t i = 0; i < due.size(); i++)
+		{
+			deliver(due[i]);
+		}
+	}
+
+	void deliver(const MOCK_EVENT& e)
+	{
+		MockCamera* camera = e.camera;
+		bool delivered = false;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		switch(e.kind)
+		{
+		case kMockEvent_Property:
+			if(camera->propertyHandler != NULL)
+			{
+				EdsPropertyEventHandler handler = camera->propertyHandler;
+				EdsVoid* context = camera->propertyContext;
+				lock.unlock();
+				handler(e.event, e.param, 0, context);
+				delivered = true;
+			}
+			break;
+
+		case kMockEvent_Object:
+			if(camera->objectHandler != NULL)
+			{
+				EdsObjectEventHandler handler = camera->objectHandler;
+				EdsVoid* context = camera->objectContext;
+				lock.unlock();
+				// The handler owns the ref from here
+				handler(e.event, e.ref, context);
+				delivered = true;
+			}
+			break;
+
+		case kMockEvent_State:
+			if(camera->stateHandler != NULL)
+			{
+				EdsStateEventHandler handler = camera->stateHandler;
+				EdsVoid* context = camera->stateContext;
+				lock.unlock();
+				handler(e.event, e.param, context);
+				delivered = true;
+			}
+			break;
+
+		case kMockEvent_CameraAdded:
+			if(cameraAddedHandler != NULL)
+			{
+				EdsCameraAddedHandler handler = cameraAddedHandler;
+				EdsVoid* context = cameraAddedContext;
+				lock.unlock();
+				handler(context);
+				delivered = true;
+			}
+			break;
+		}
+		if(lock.owns_lock())
+		{
+			lock.unlock();
+		}
+
+		if(delivered)
+		{
+			eventsDelivered++;
+		}
+		else if(e.ref != NULL)
+		{
+			EdsRelease(e.ref);
+		}
+		EdsRelease(camera);
+	}
+
+	void runEventThread()
+	{
+		Tracer::instance().setThreadName("EDSDK events");
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while(!stopping)
+		{
+			if(events.empty())
+			{
+				wake.wait(lock);
+				continue;
+			}
+			EdsUInt64 now = mockClockMicros();
+			EdsUInt64 due = events.begin()->first;
+			if(due > now)
+			{
+				wake.wait_for(lock, std::chrono::microseconds(due - now));
+				continue;
+			}
+			lock.unlock();
+			deliverDue();
+			lock.lock();
+		}
+	}
+
+	// Mutex held. Children of a volume or folder, NULL for anything else.
+	static std::vector<MockDirectoryItem*>* childrenOf(__EdsObject* parent)
+	{
+		MockVolume* volume = dynamic_cast<MockVolume*>(parent);
+		if(volume != NULL)
+		{
+			return &volume->children;
+		}
+		MockDirectoryItem* folder = dynamic_cast<MockDirectoryItem*>(parent);
+		return (folder != NULL && folder->info.isFolder) ? &folder->children : NULL;
+	}
+
+	static MockVolume* volumeOf(MockDirectoryItem* item)
+	{
+		__EdsObject* parent = item->parent;
+		while(dynamic_cast<MockDirectoryItem*>(parent) != NULL)
+		{
+			parent = static_cast<MockDirectoryItem*>(parent)->parent;
+		}
+		return dynamic_cast<MockVolume*>(parent);
+	}
+
+	// Mutex held. Found by name, or created at the end if create is set.
+	static MockDirectoryItem* folderIn(__EdsObject* parent, const char* name, bool create)
+	{
+		std::vector<MockDirectoryItem*>* children = childrenOf(parent);
+		for(size_t i = 0; children != NULL && i < children->size(); i++)
+		{
+			if((*children)[i]->info.isFolder && strcmp((*children)[i]->info.szFileName, name) == 0)
+			{
+				return (*children)[i];
+			}
+		}
+		if(children == NULL || !create)
+		{
+			return NULL;
+		}
+		MockDirectoryItem* folder = new MockDirectoryItem();
+		folder->info.isFolder = true;
+		folder->info.dateTime = (EdsUInt32)time(NULL);
+		strncpy(folder->info.szFileName, name, sizeof(folder->info.szFileName) - 1);
+		folder->parent = parent;
+		children->push_back(folder);
+		return folder;
+	}
+
+	// Mutex held. DCIM/100CANON and on, kMockFilesPerFolder to a folder.
+	static MockDirectoryItem* addFile(MockVolume* volume, EdsUInt32 fileNumber, const char* name, EdsUInt32 format,
+		const MockPayloadRef& payload, const MockPayloadRef& thumbnail, EdsUInt32 dateTime)
+	{
+		char folderName[16];
+		snprintf(folderName, sizeof(folderName), "%03uCANON", (unsigned)(100 + ((fileNumber - 1) / kMockFilesPerFolder) % 900));
+		MockDirectoryItem* folder = folderIn(folderIn(volume, "DCIM", true), folderName, true);
+
+		MockDirectoryItem* item = new MockDirectoryItem();
+		item->payload = payload;
+		item->thumbnail = thumbnail;
+		item->info.size = payload->size();
+		item->info.format = format;
+		item->info.dateTime = dateTime;
+		item->info.groupID = fileNumber;
+		strncpy(item->info.szFileName, name, sizeof(item->info.szFileName) - 1);
+		item->parent = folder;
+		folder->children.push_back(item);
+
+		volume->info.freeSpaceInBytes -= std::min(volume->info.freeSpaceInBytes, item->info.size);
+		return item;
+	}
+
+	// Mutex held. Cards with cardFiles shots each, a minute apart.
+	void populateCards(MockCamera* camera)
+	{
+		static const char* labels[] = { "CF", "SD" };
+		EdsUInt32 now = (EdsUInt32)time(NULL);
+		for(EdsUInt32 v = 0; v < config.volumeCount; v++)
+		{
+			MockVolume* volume = new MockVolume(camera);
+			volume->info.storageType = (v == 0) ? kEdsStorageType_CF : kEdsStorageType_SD;
+			volume->info.access = kEdsAccess_ReadWrite;
+			volume->info.maxCapacity = 64ull * 1024 * 1024 * 1024;
+			volume->info.freeSpaceInBytes = volume->info.maxCapacity;
+			if(v < 2)
+			{
+				snprintf(volume->info.szVolumeLabel, sizeof(volume->info.szVolumeLabel), "%s", labels[v]);
+			}
+			else
+			{
+				snprintf(volume->info.szVolumeLabel, sizeof(volume->info.szVolumeLabel), "SD%u", (unsigned)v);
+			}
+			camera->volumes.push_back(volume);
+
+			for(EdsUInt32 n = 0; n < config.cardFiles; n++)
+			{
+				EdsUInt32 fileNumber = ++camera->fileNumber;
+				EdsUInt32 dateTime = now - (config.cardFiles - n) * 60;
+				char name[EDS_MAX_NAME];
+				snprintf(name, sizeof(name), "IMG_%04u.JPG", (unsigned)(fileNumber % 10000));
+				addFile(volume, fileNumber, name, kEdsTargetImageType_Jpeg, jpeg, thumbnail, dateTime);
+				if(raw)
+				{
+					snprintf(name, sizeof(name), "IMG_%04u.CR2", (unsigned)(fileNumber % 10000));
+					addFile(volume, fileNumber, name, 0, raw, thumbnail, dateTime);
+				}
+			}
+		}
+	}
+
+	// Mutex held. The JPEG, then the RAW if one is configured.
+	void scheduleCapture(MockCamera* camera)
+	{
+		captures++;
+		camera->fileNumber++;
+
+		EdsUInt64 due = mockClockMicros() + config.captureLatencyMicros;
+		for(int part = 0; part < 2; part++)
+		{
+			MockPayloadRef payload = (part == 0) ? jpeg : raw;
+			if(!payload)
+			{
+				continue;
+			}
+
+			EdsUInt32 dateTime = (EdsUInt32)time(NULL);
+			char fileName[EDS_MAX_NAME];
+			snprintf(fileName, sizeof(fileName), (part == 0) ? "IMG_%04u.JPG" : "IMG_%04u.CR2", (unsigned)(camera->fileNumber % 10000));
+			EdsUInt32 format = (part == 0) ? kEdsTargetImageType_Jpeg : 0;
+
+			// Only asked for when saving to the host
+			if(camera->getUInt32(kEdsPropID_SaveTo) & kEdsSaveTo_Host)
+			{
+				MockDirectoryItem* item = new MockDirectoryItem();
+				item->payload = payload;
+				item->thumbnail = thumbnail;
+				item->info.size = payload->size();
+				item->info.isFolder = false;
+				item->info.format = format;
+				item->info.dateTime = dateTime;
+				strcpy(item->info.szFileName, fileName);
+
+				transferRequests++;
+				post(due + part, kMockEvent_Object, camera, kEdsObjectEvent_DirItemRequestTransfer, 0, item);
+			}
+
+			// Written to the first card too when saving to the camera
+			if((camera->getUInt32(kEdsPropID_SaveTo) & kEdsSaveTo_Camera) && !camera->volumes.empty())
+			{
+				MockDirectoryItem* stored = addFile(camera->volumes[0], camera->fileNumber, fileName, format,
+					payload, thumbnail, dateTime);
+				stored->refCount++;
+				post(due + part, kMockEvent_Object, camera, kEdsObjectEvent_DirItemCreated, 0, stored);
+			}
+		}
+	}
+};
+
+static MockSdk& mockSdk()
+{
+	static MockSdk sdk;
+	return sdk;
+}
+
+template<typename T>
+static T* mockCast(EdsBaseRef ref)
+{
+	return dynamic_cast<T*>(ref);
+}
+
+// Every SDK entry point counts itself
+#define MOCK_CALL()		(mockSdk().calls++)
+
+
+/******************************************************************************
+ Mock control
+******************************************************************************/
+
+void MockEdsGetDefaultConfig(MOCK_EDSDK_CONFIG* outConfig)
+{
+	memset(outConfig, 0, sizeof(*outConfig));
+	outConfig->cameraCount = 1;
+	outConfig->sessionLatencyMicros = 50000;
+	outConfig->propertyLatencyMicros = 500;
+	outConfig->setPropertyLatencyMicros = 10000;
+	outConfig->commandLatencyMicros = 10000;
+	outConfig->evfLatencyMicros = 8000;
+	outConfig->evfFrameIntervalMicros = 33333;
+	outConfig->evfWarmupMicros = 100000;
+	outConfig->evfPropertyLatencyMicros = 300;
+	outConfig->evfWidth = 960;
+	outConfig->evfHeight = 640;
+	outConfig->captureLatencyMicros = 150000;
+	outConfig->transferBytesPerSecond = 40 * 1000 * 1000;
+	outConfig->jpegWidth = 3000;
+	outConfig->jpegHeight = 2000;
+	outConfig->rawSize = 0;
+	outConfig->volumeCount = 1;
+	outConfig->cardFiles = 0;
+	outConfig->enumerateLatencyMicros = 200;
+	outConfig->developMicrosPerMegapixel = 0;
+	outConfig->busyPermille = 0;
+	outConfig->seed = 1;
+	outConfig->eventThread = false;
+	outConfig->sessionEvents = false;
+}
+
+void MockEdsSetConfig(const MOCK_EDSDK_CONFIG* inConfig)
+{
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	sdk.config = *inConfig;
+	sdk.random = ((EdsUInt64)inConfig->seed << 32) | 0x9e3779b9u;
+}
+
+void MockEdsGetConfig(MOCK_EDSDK_CONFIG* outConfig)
+{
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	*outConfig = sdk.config;
+}
+
+void MockEdsGetStatistics(MOCK_EDSDK_STATISTICS* outStatistics)
+{
+	MockSdk& sdk = mockSdk();
+	outStatistics->calls = sdk.calls;
+	outStatistics->busyInjected = sdk.busyInjected;
+	outStatistics->evfFrames = sdk.evfDelivered;
+	outStatistics->evfNotReady = sdk.evfNotReady;
+	outStatistics->captures = sdk.captures;
+	outStatistics->transferRequests = sdk.transferRequests;
+	outStatistics->bytesDownloaded = sdk.bytesDownloaded;
+	outStatistics->thumbnails = sdk.thumbnails;
+	outStatistics->eventsDelivered = sdk.eventsDelivered;
+	outStatistics->liveObjects = g_liveObjects;
+}
+
+void MockEdsResetStatistics()
+{
+	mockSdk().resetStatistics();
+}
+
+EdsError MockEdsSendStateEvent(EdsUInt32 inIndex, EdsStateEvent inEvent, EdsUInt32 inEventData)
+{
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	if(inIndex >= sdk.cameras.size())
+	{
+		return EDS_ERR_INVALID_INDEX;
+	}
+	sdk.post(mockClockMicros(), kMockEvent_State, sdk.cameras[inIndex], inEvent, inEventData, NULL);
+	return EDS_ERR_OK;
+}
+
+
+EdsUInt32 MockEdsAttachCamera()
+{
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	if(sdk.initializeCount == 0)
+	{
+		return 0xffffffff;
+	}
+	MockCamera* camera = new MockCamera(sdk.nextCameraIndex++);
+	sdk.populateCards(camera);
+	sdk.cameras.push_back(camera);
+	sdk.post(mockClockMicros(), kMockEvent_CameraAdded, camera, 0, 0, NULL);
+	return (EdsUInt32)(sdk.cameras.size() - 1);
+}
+
+EdsError MockEdsDetachCamera(EdsUInt32 inIndex)
+{
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	if(inIndex >= sdk.cameras.size())
+	{
+		return EDS_ERR_INVALID_INDEX;
+	}
+	MockCamera* camera = sdk.cameras[inIndex];
+	sdk.cameras.erase(sdk.cameras.begin() + inIndex);
+	camera->sessionOpen = false;
+	// The event keeps the body alive until it is delivered
+	sdk.post(mockClockMicros(), kMockEvent_State, camera, kEdsStateEvent_Shutdown, 0, NULL);
+	EdsRelease(camera);
+	return EDS_ERR_OK;
+}
+
+
+EdsError MockEdsResetCamera(EdsUInt32 inIndex, EdsUInt32 inDownMicros)
+{
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	if(inIndex >= sdk.cameras.size())
+	{
+		return EDS_ERR_INVALID_INDEX;
+	}
+	MockCamera* camera = sdk.cameras[inIndex];
+	sdk.cameras.erase(sdk.cameras.begin() + inIndex);
+	camera->sessionOpen = false;
+
+	// Same port and serial, the settings kept as bodies keep them
+	MockCamera* back = new MockCamera(camera->index);
+	back->properties = camera->properties;
+	back->setUInt32(kEdsPropID_Evf_OutputDevice, kEdsEvfOutputDevice_TFT);
+	back->setUInt32(kEdsPropID_SaveTo, kEdsSaveTo_Camera);
+	sdk.populateCards(back);
+
+	EdsUInt64 now = mockClockMicros();
+	sdk.post(now, kMockEvent_State, camera, kEdsStateEvent_Shutdown, 0, NULL);
+	EdsRelease(camera);
+	sdk.returning.insert(std::make_pair(now + inDownMicros, back));
+	sdk.post(now + inDownMicros, kMockEvent_CameraAdded, back, 0, 0, NULL);
+	return EDS_ERR_OK;
+}
+
+
+/******************************************************************************
+ Basic functions
+******************************************************************************/
+
+EdsError EDSAPI EdsInitializeSDK()
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+
+	if(sdk.initializeCount++ > 0)
+	{
+		return EDS_ERR_OK;
+	}
+
+	const MOCK_EDSDK_CONFIG& config = sdk.config;
+	if(sdk.random == 0)
+	{
+		sdk.random = ((EdsUInt64)config.seed << 32) | 0x9e3779b9u;
+	}
+
+	sdk.evfFrames.clear();
+	for(int i = 0; i < 8; i++)
+	{
+		sdk.evfFrames.push_back(makeFrame(std::max(8u, config.evfWidth), std::max(8u, config.evfHeight), i, config.seed));
+	}
+	MockFrameRef still = makeFrame(std::max(8u, config.jpegWidth), std::max(8u, config.jpegHeight), 0, config.seed);
+	sdk.jpeg = std::make_shared<std::vector<unsigned char> >(still->jpeg);
+	sdk.raw = (config.rawSize > 0) ? makeRaw(config.rawSize, config.seed) : MockPayloadRef();
+	MockFrameRef thumbnail = makeFrame(160, std::max(8u, 160 * std::max(8u, config.jpegHeight) / std::max(8u, config.jpegWidth)), 0, config.seed);
+	sdk.thumbnail = std::make_shared<std::vector<unsigned char> >(thumbnail->jpeg);
+
+	for(EdsUInt32 i = 0; i < config.cameraCount; i++)
+	{
+		sdk.cameras.push_back(new MockCamera(i));
+		sdk.populateCards(sdk.cameras.back());
+	}
+	sdk.nextCameraIndex = config.cameraCount;
+
+	sdk.stopping = false;
+	if(config.eventThread)
+	{
+		sdk.eventThread = std::thread(&MockSdk::runEventThread, &sdk);
+	}
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsTerminateSDK()
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	std::vector<MOCK_EVENT> pending;
+	std::vector<MockCamera*> cameras;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		if(sdk.initializeCount == 0 || --sdk.initializeCount > 0)
+		{
+			return EDS_ERR_OK;
+		}
+		sdk.stopping = true;
+		sdk.wake.notify_all();
+	}
+
+	if(sdk.eventThread.joinable())
+	{
+		sdk.eventThread.join();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		for(std::multimap<EdsUInt64, MOCK_EVENT>::iterator it = sdk.events.begin(); it != sdk.events.end(); ++it)
+		{
+			pending.push_back(it->second);
+		}
+		sdk.events.clear();
+		sdk.admitReturning((EdsUInt64)-1);
+		cameras.swap(sdk.cameras);
+		sdk.cameraAddedHandler = NULL;
+		sdk.cameraAddedContext = NULL;
+	}
+
+	for(size_t i = 0; i < pending.size(); i++)
+	{
+		if(pending[i].ref != NULL)
+		{
+			EdsRelease(pending[i].ref);
+		}
+		EdsRelease(pending[i].camera);
+	}
+	for(size_t i = 0; i < cameras.size(); i++)
+	{
+		EdsRelease(cameras[i]);
+	}
+	return EDS_ERR_OK;
+}
+
+EdsUInt32 EDSAPI EdsRetain(EdsBaseRef inRef)
+{
+	MOCK_CALL();
+	if(inRef == NULL)
+	{
+		return 0xffffffff;
+	}
+	return ++inRef->refCount;
+}
+
+EdsUInt32 EDSAPI EdsRelease(EdsBaseRef inRef)
+{
+	MOCK_CALL();
+	if(inRef == NULL)
+	{
+		return 0xffffffff;
+	}
+	EdsUInt32 count = --inRef->refCount;
+	if(count == 0)
+	{
+		delete inRef;
+	}
+	return count;
+}
+
+EdsError EDSAPI EdsGetChildCount(EdsBaseRef inRef, EdsUInt32* outCount)
+{
+	MOCK_CALL();
+	if(outCount == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockCameraList* list = mockCast<MockCameraList>(inRef);
+	if(list != NULL)
+	{
+		*outCount = (EdsUInt32)list->cameras.size();
+		return EDS_ERR_OK;
+	}
+
+	MockSdk& sdk = mockSdk();
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		MockCamera* camera = mockCast<MockCamera>(inRef);
+		std::vector<MockDirectoryItem*>* children = MockSdk::childrenOf(inRef);
+		if(camera != NULL)
+		{
+			*outCount = (EdsUInt32)camera->volumes.size();
+		}
+		else if(children != NULL)
+		{
+			*outCount = (EdsUInt32)children->size();
+		}
+		else
+		{
+			return (mockCast<MockDirectoryItem>(inRef) != NULL) ? EDS_ERR_OBJECT_NOTREADY : EDS_ERR_INVALID_HANDLE;
+		}
+		latency = sdk.config.enumerateLatencyMicros;
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetChildAtIndex(EdsBaseRef inRef, EdsInt32 inIndex, EdsBaseRef* outRef)
+{
+	MOCK_CALL();
+	if(outRef == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockCameraList* list = mockCast<MockCameraList>(inRef);
+	if(list != NULL)
+	{
+		if(inIndex < 0 || (size_t)inIndex >= list->cameras.size())
+		{
+			return EDS_ERR_INVALID_INDEX;
+		}
+		MockCamera* camera = list->cameras[inIndex];
+		camera->refCount++;
+		*outRef = camera;
+		return EDS_ERR_OK;
+	}
+
+	// Volumes of a camera, then the contents of a volume or folder
+	MockSdk& sdk = mockSdk();
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		MockCamera* camera = mockCast<MockCamera>(inRef);
+		std::vector<MockDirectoryItem*>* children = MockSdk::childrenOf(inRef);
+		__EdsObject* child = NULL;
+		if(camera != NULL)
+		{
+			if(inIndex < 0 || (size_t)inIndex >= camera->volumes.size())
+			{
+				return EDS_ERR_INVALID_INDEX;
+			}
+			child = camera->volumes[inIndex];
+		}
+		else if(children != NULL)
+		{
+			if(inIndex < 0 || (size_t)inIndex >= children->size())
+			{
+				return EDS_ERR_INVALID_INDEX;
+			}
+			child = (*children)[inIndex];
+		}
+		else
+		{
+			return EDS_ERR_INVALID_HANDLE;
+		}
+		child->refCount++;
+		*outRef = child;
+		latency = sdk.config.enumerateLatencyMicros;
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetParent(EdsBaseRef inRef, EdsBaseRef* outParentRef)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outParentRef == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	__EdsObject* parent = NULL;
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inRef);
+	MockVolume* volume = mockCast<MockVolume>(inRef);
+	if(item != NULL)
+	{
+		parent = item->parent;
+	}
+	else if(volume != NULL)
+	{
+		parent = volume->camera;
+	}
+	else
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(parent == NULL)
+	{
+		// Removed, or a transfer request that was never on a card
+		*outParentRef = NULL;
+		return EDS_ERR_OBJECT_NOTREADY;
+	}
+	parent->refCount++;
+	*outParentRef = parent;
+	return EDS_ERR_OK;
+}
+
+
+/******************************************************************************
+ Properties
+******************************************************************************/
+
+static EdsError getEvfImageProperty(MockEvfImage* image, EdsPropertyID inPropertyID, EdsDataType* outDataType, const void** outData, EdsUInt32* outSize)
+{
+	switch(inPropertyID)
+	{
+	case kEdsPropID_Evf_Zoom:
+		*outDataType = kEdsDataType_UInt32;		*outData = &image->zoom;				*outSize = sizeof(image->zoom);
+		return EDS_ERR_OK;
+	case kEdsPropID_Evf_ImagePosition:
+		*outDataType = kEdsDataType_Point;		*outData = &image->imagePosition;		*outSize = sizeof(image->imagePosition);
+		return EDS_ERR_OK;
+	case kEdsPropID_Evf_ZoomRect:
+		*outDataType = kEdsDataType_Rect;		*outData = &image->zoomRect;			*outSize = sizeof(image->zoomRect);
+		return EDS_ERR_OK;
+	case kEdsPropID_Evf_CoordinateSystem:
+		*outDataType = kEdsDataType_ByteBlock;	*outData = &image->coordinateSystem;	*outSize = sizeof(image->coordinateSystem);
+		return EDS_ERR_OK;
+	case kEdsPropID_Evf_Histogram:
+		if(!image->frame)
+		{
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+		*outDataType = kEdsDataType_ByteBlock;
+		*outData = &image->frame->histogram[0];
+		*outSize = (EdsUInt32)(image->frame->histogram.size() * sizeof(EdsUInt32));
+		return EDS_ERR_OK;
+	}
+	return EDS_ERR_PROPERTIES_UNAVAILABLE;
+}
+
+EdsError EDSAPI EdsGetPropertySize(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsInt32, EdsDataType* outDataType, EdsUInt32* outSize)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outDataType == NULL || outSize == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	MockEvfImage* image = mockCast<MockEvfImage>(inRef);
+	if(image != NULL)
+	{
+		const void* data = NULL;
+		return getEvfImageProperty(image, inPropertyID, outDataType, &data, outSize);
+	}
+
+	MockCamera* camera = mockCast<MockCamera>(inRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		if(!camera->sessionOpen)
+		{
+			return EDS_ERR_SESSION_NOT_OPEN;
+		}
+		std::map<EdsPropertyID, MOCK_PROPERTY>::const_iterator it = camera->properties.find(inPropertyID);
+		if(it == camera->properties.end())
+		{
+			return EDS_ERR_PROPERTIES_UNAVAILABLE;
+		}
+		*outDataType = it->second.dataType;
+		*outSize = (EdsUInt32)it->second.data.size();
+		latency = sdk.config.propertyLatencyMicros;
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetPropertyData(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsInt32, EdsUInt32 inPropertySize, EdsVoid* outPropertyData)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outPropertyData == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	EdsUInt64 latency = 0;
+	MockEvfImage* image = mockCast<MockEvfImage>(inRef);
+	if(image != NULL)
+	{
+		EdsDataType dataType;
+		const void* data = NULL;
+		EdsUInt32 size = 0;
+		EdsError err = getEvfImageProperty(image, inPropertyID, &dataType, &data, &size);
+		if(err == EDS_ERR_OK && inPropertySize < size)
+		{
+			err = EDS_ERR_INVALID_LENGTH;
+		}
+		if(err == EDS_ERR_OK)
+		{
+			memcpy(outPropertyData, data, size);
+			std::lock_guard<std::mutex> lock(sdk.mutex);
+			latency = sdk.config.evfPropertyLatencyMicros;
+		}
+		simulateLatency(latency);
+		return err;
+	}
+
+	MockCamera* camera = mockCast<MockCamera>(inRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		if(!camera->sessionOpen)
+		{
+			return EDS_ERR_SESSION_NOT_OPEN;
+		}
+		std::map<EdsPropertyID, MOCK_PROPERTY>::const_iterator it = camera->properties.find(inPropertyID);
+		if(it == camera->properties.end())
+		{
+			return EDS_ERR_PROPERTIES_UNAVAILABLE;
+		}
+		if(inPropertySize < it->second.data.size())
+		{
+			return EDS_ERR_INVALID_LENGTH;
+		}
+		memcpy(outPropertyData, &it->second.data[0], it->second.data.size());
+		latency = sdk.config.propertyLatencyMicros;
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsSetPropertyData(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsInt32, EdsUInt32 inPropertySize, const EdsVoid* inPropertyData)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(inPropertyData == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	MockCamera* camera = mockCast<MockCamera>(inRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 latency = 0;
+	EdsError err = EDS_ERR_OK;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		latency = sdk.config.setPropertyLatencyMicros;
+
+		std::map<EdsPropertyID, MOCK_PROPERTY>::iterator it = camera->properties.find(inPropertyID);
+		if(!camera->sessionOpen)
+		{
+			err = EDS_ERR_SESSION_NOT_OPEN;
+		}
+		else if(it == camera->properties.end())
+		{
+			err = EDS_ERR_PROPERTIES_UNAVAILABLE;
+		}
+		else if(it->second.dataType != kEdsDataType_String && inPropertySize != it->second.data.size())
+		{
+			err = EDS_ERR_INVALID_LENGTH;
+		}
+		else if(sdk.drawBusy())
+		{
+			err = EDS_ERR_DEVICE_BUSY;
+		}
+
+		// Values outside the desc are refused, as the body would
+		if(err == EDS_ERR_OK && it->second.desc.numElements > 0 && inPropertySize == sizeof(EdsUInt32))
+		{
+			EdsInt32 value;
+			memcpy(&value, inPropertyData, sizeof(value));
+			const EdsPropertyDesc& desc = it->second.desc;
+			if(std::find(desc.propDesc, desc.propDesc + desc.numElements, value) == desc.propDesc + desc.numElements)
+			{
+				err = EDS_ERR_INVALID_PARAMETER;
+			}
+		}
+
+		if(err == EDS_ERR_OK)
+		{
+			MOCK_PROPERTY& property = it->second;
+			const unsigned char* data = (const unsigned char*)inPropertyData;
+			bool changed = (property.data.size() != inPropertySize) || memcmp(&property.data[0], data, inPropertySize) != 0;
+
+			if(inPropertyID == kEdsPropID_Evf_OutputDevice && inPropertySize == sizeof(EdsUInt32))
+			{
+				EdsUInt32 before = camera->getUInt32(inPropertyID);
+				EdsUInt32 after;
+				memcpy(&after, data, sizeof(after));
+				if(!(before & kEdsEvfOutputDevice_PC) && (after & kEdsEvfOutputDevice_PC))
+				{
+					camera->evfStartMicros = mockClockMicros();
+					camera->evfLastTick = (EdsUInt64)-1;
+				}
+			}
+
+			property.data.assign(data, data + inPropertySize);
+			if(changed)
+			{
+				sdk.post(mockClockMicros() + latency, kMockEvent_Property, camera, kEdsPropertyEvent_PropertyChanged, inPropertyID, NULL);
+			}
+		}
+	}
+	simulateLatency(latency);
+	return err;
+}
+
+EdsError EDSAPI EdsGetPropertyDesc(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsPropertyDesc* outPropertyDesc)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outPropertyDesc == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	MockCamera* camera = mockCast<MockCamera>(inRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		if(!camera->sessionOpen)
+		{
+			return EDS_ERR_SESSION_NOT_OPEN;
+		}
+		std::map<EdsPropertyID, MOCK_PROPERTY>::const_iterator it = camera->properties.find(inPropertyID);
+		if(it == camera->properties.end())
+		{
+			return EDS_ERR_PROPERTIES_UNAVAILABLE;
+		}
+		*outPropertyDesc = it->second.desc;
+		latency = sdk.config.propertyLatencyMicros;
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+
+/******************************************************************************
+ Camera
+******************************************************************************/
+
+EdsError EDSAPI EdsGetCameraList(EdsCameraListRef* outCameraListRef)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outCameraListRef == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	if(sdk.initializeCount == 0)
+	{
+		return EDS_ERR_INVALID_FN_CALL;
+	}
+	sdk.admitReturning(mockClockMicros());
+	MockCameraList* list = new MockCameraList();
+	for(size_t i = 0; i < sdk.cameras.size(); i++)
+	{
+		sdk.cameras[i]->refCount++;
+		list->cameras.push_back(sdk.cameras[i]);
+	}
+	*outCameraListRef = list;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetDeviceInfo(EdsCameraRef inCameraRef, EdsDeviceInfo* outDeviceInfo)
+{
+	MOCK_CALL();
+	if(outDeviceInfo == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	*outDeviceInfo = camera->deviceInfo;
+	return EDS_ERR_OK;
+}
+
+static EdsError setSessionOpen(EdsCameraRef inCameraRef, bool open)
+{
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		camera->sessionOpen = open;
+		if(!open)
+		{
+			camera->setUInt32(kEdsPropID_Evf_OutputDevice, kEdsEvfOutputDevice_TFT);
+		}
+		latency = sdk.config.sessionLatencyMicros;
+
+		// A body announces every property, and the choices of each that has
+		// them, once the session is open.
+		if(open && sdk.config.sessionEvents)
+		{
+			EdsUInt64 when = mockClockMicros() + latency;
+			for(std::map<EdsPropertyID, MOCK_PROPERTY>::const_iterator it = camera->properties.begin(); it != camera->properties.end(); ++it)
+			{
+				sdk.post(when, kMockEvent_Property, camera, kEdsPropertyEvent_PropertyChanged, it->first, NULL);
+				if(it->second.desc.numElements > 0)
+				{
+					sdk.post(when, kMockEvent_Property, camera, kEdsPropertyEvent_PropertyDescChanged, it->first, NULL);
+				}
+			}
+		}
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsOpenSession(EdsCameraRef inCameraRef)
+{
+	MOCK_CALL();
+	return setSessionOpen(inCameraRef, true);
+}
+
+EdsError EDSAPI EdsCloseSession(EdsCameraRef inCameraRef)
+{
+	MOCK_CALL();
+	return setSessionOpen(inCameraRef, false);
+}
+
+EdsError EDSAPI EdsSendCommand(EdsCameraRef inCameraRef, EdsCameraCommand inCommand, EdsInt32 inParam)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 latency = 0;
+	EdsError err = EDS_ERR_OK;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		latency = sdk.config.commandLatencyMicros;
+		if(!camera->sessionOpen)
+		{
+			err = EDS_ERR_SESSION_NOT_OPEN;
+		}
+		else if(sdk.drawBusy())
+		{
+			err = EDS_ERR_DEVICE_BUSY;
+		}
+		else if(inCommand == kEdsCameraCommand_TakePicture ||
+				(inCommand == kEdsCameraCommand_PressShutterButton &&
+				 (inParam == kEdsCameraCommand_ShutterButton_Completely || inParam == kEdsCameraCommand_ShutterButton_Completely_NonAF)))
+		{
+			sdk.scheduleCapture(camera);
+		}
+	}
+	simulateLatency(latency);
+	return err;
+}
+
+EdsError EDSAPI EdsSendStatusCommand(EdsCameraRef inCameraRef, EdsCameraStatusCommand, EdsInt32)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 latency = 0;
+	EdsError err = EDS_ERR_OK;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		latency = sdk.config.commandLatencyMicros;
+		if(!camera->sessionOpen)
+		{
+			err = EDS_ERR_SESSION_NOT_OPEN;
+		}
+		else if(sdk.drawBusy())
+		{
+			err = EDS_ERR_DEVICE_BUSY;
+		}
+	}
+	simulateLatency(latency);
+	return err;
+}
+
+EdsError EDSAPI EdsSetCapacity(EdsCameraRef inCameraRef, EdsCapacity)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	return camera->sessionOpen ? EDS_ERR_OK : EDS_ERR_SESSION_NOT_OPEN;
+}
+
+
+/******************************************************************************
+ Directory items
+******************************************************************************/
+
+EdsError EDSAPI EdsGetVolumeInfo(EdsVolumeRef inVolumeRef, EdsVolumeInfo* outVolumeInfo)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outVolumeInfo == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockVolume* volume = mockCast<MockVolume>(inVolumeRef);
+	if(volume == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	*outVolumeInfo = volume->info;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetDirectoryItemInfo(EdsDirectoryItemRef inDirItemRef, EdsDirectoryItemInfo* outDirItemInfo)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	if(outDirItemInfo == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inDirItemRef);
+	if(item == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		*outDirItemInfo = item->info;
+		latency = (item->parent != NULL) ? sdk.config.enumerateLatencyMicros : 0;
+	}
+	simulateLatency(latency);
+	return EDS_ERR_OK;
+}
+
+// Takes the item off its card and tells the camera's handler
+EdsError EDSAPI EdsDeleteDirectoryItem(EdsDirectoryItemRef inDirItemRef)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inDirItemRef);
+	if(item == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	MockVolume* volume = MockSdk::volumeOf(item);
+	std::vector<MockDirectoryItem*>* siblings = (item->parent != NULL) ? MockSdk::childrenOf(item->parent) : NULL;
+	if(volume == NULL || siblings == NULL)
+	{
+		return EDS_ERR_OBJECT_NOTREADY;
+	}
+	siblings->erase(std::remove(siblings->begin(), siblings->end(), item), siblings->end());
+	item->parent = NULL;
+	volume->info.freeSpaceInBytes = std::min(volume->info.maxCapacity, volume->info.freeSpaceInBytes + item->info.size);
+	if(volume->camera != NULL)
+	{
+		// The card's reference goes with the event
+		sdk.post(mockClockMicros(), kMockEvent_Object, volume->camera, kEdsObjectEvent_DirItemRemoved, 0, item);
+	}
+	else
+	{
+		EdsRelease(item);
+	}
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsDownload(EdsDirectoryItemRef inDirItemRef, EdsUInt64 inReadSize, EdsStreamRef outStream)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inDirItemRef);
+	MockStream* stream = mockCast<MockStream>(outStream);
+	if(item == NULL || stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsUInt64 total = item->payload->size();
+	if(item->offset >= total && inReadSize > 0)
+	{
+		return EDS_ERR_STREAM_END_OF_STREAM;
+	}
+	EdsUInt64 size = std::min(inReadSize, total - item->offset);
+
+	EdsUInt32 bytesPerSecond;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		bytesPerSecond = sdk.config.transferBytesPerSecond;
+	}
+
+	// In tenths, so progress is reported as a real transfer would
+	const EdsUInt64 slice = std::max<EdsUInt64>(EDS_TRANSFER_BLOCK_SIZE, (size + 9) / 10);
+	EdsUInt64 done = 0;
+	while(done < size)
+	{
+		EdsUInt64 length = std::min(slice, size - done);
+		if(bytesPerSecond > 0)
+		{
+			simulateLatency(length * 1000000 / bytesPerSecond);
+		}
+
+		EdsError err = stream->write(&(*item->payload)[(size_t)(item->offset)], length);
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+		item->offset += length;
+		done += length;
+		sdk.bytesDownloaded += length;
+
+		if(stream->progress != NULL)
+		{
+			EdsBool cancel = false;
+			stream->progress((EdsUInt32)(item->offset * 100 / total), stream->progressContext, &cancel);
+			if(cancel)
+			{
+				return EDS_ERR_OPERATION_CANCELLED;
+			}
+		}
+	}
+	return EDS_ERR_OK;
+}
+
+// Either ends the transfer; the next EdsDownload starts from the top
+EdsError EDSAPI EdsDownloadComplete(EdsDirectoryItemRef inDirItemRef)
+{
+	MOCK_CALL();
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inDirItemRef);
+	if(item == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	item->offset = 0;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsDownloadCancel(EdsDirectoryItemRef inDirItemRef)
+{
+	MOCK_CALL();
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inDirItemRef);
+	if(item == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	item->offset = 0;
+	return EDS_ERR_OK;
+}
+
+// One round trip for the embedded thumbnail, then its bytes at the link rate
+EdsError EDSAPI EdsDownloadThumbnail(EdsDirectoryItemRef inDirItemRef, EdsStreamRef outStream)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockDirectoryItem* item = mockCast<MockDirectoryItem>(inDirItemRef);
+	MockStream* stream = mockCast<MockStream>(outStream);
+	if(item == NULL || stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(!item->thumbnail)
+	{
+		return EDS_ERR_NOT_SUPPORTED;
+	}
+
+	EdsUInt32 latency, bytesPerSecond;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		latency = sdk.config.propertyLatencyMicros;
+		bytesPerSecond = sdk.config.transferBytesPerSecond;
+	}
+	EdsUInt64 size = item->thumbnail->size();
+	simulateLatency(latency + ((bytesPerSecond > 0) ? size * 1000000 / bytesPerSecond : 0));
+
+	EdsError err = stream->write(&(*item->thumbnail)[0], size);
+	if(err == EDS_ERR_OK)
+	{
+		sdk.thumbnails++;
+		sdk.bytesDownloaded += size;
+	}
+	return err;
+}
+
+
+/******************************************************************************
+ Streams
+******************************************************************************/
+
+EdsError EDSAPI EdsCreateFileStream(const EdsChar* inFileName, EdsFileCreateDisposition inCreateDisposition, EdsAccess inDesiredAccess, EdsStreamRef* outStream)
+{
+	MOCK_CALL();
+	if(inFileName == NULL || outStream == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	const char* mode = "rb";
+	switch(inCreateDisposition)
+	{
+	case kEdsFileCreateDisposition_CreateNew:
+	case kEdsFileCreateDisposition_CreateAlways:
+	case kEdsFileCreateDisposition_TruncateExsisting:
+		mode = (inDesiredAccess == kEdsAccess_Write) ? "wb" : "w+b";
+		break;
+	default:
+		mode = (inDesiredAccess == kEdsAccess_Read) ? "rb" : "r+b";
+		break;
+	}
+
+	FILE* file = fopen(inFileName, mode);
+	if(file == NULL)
+	{
+		return EDS_ERR_FILE_OPEN_ERROR;
+	}
+	MockStream* stream = new MockStream();
+	stream->file = file;
+	*outStream = stream;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsCreateMemoryStream(EdsUInt64 inBufferSize, EdsStreamRef* outStream)
+{
+	MOCK_CALL();
+	if(outStream == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockStream* stream = new MockStream();
+	stream->growable = true;
+	stream->owned.reserve((size_t)std::max<EdsUInt64>(inBufferSize, 1));
+	stream->owned.resize((size_t)inBufferSize);
+	stream->memory = stream->owned.data();
+	stream->capacity = inBufferSize;
+	*outStream = stream;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsCreateMemoryStreamFromPointer(EdsVoid* inUserBuffer, EdsUInt64 inBufferSize, EdsStreamRef* outStream)
+{
+	MOCK_CALL();
+	if(inUserBuffer == NULL || outStream == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	MockStream* stream = new MockStream();
+	stream->memory = (unsigned char*)inUserBuffer;
+	stream->capacity = inBufferSize;
+	*outStream = stream;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetPointer(EdsStreamRef inStream, EdsVoid** outPointer)
+{
+	MOCK_CALL();
+	MockStream* stream = mockCast<MockStream>(inStream);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(outPointer == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	if(stream->memory == NULL)
+	{
+		return EDS_ERR_NOT_SUPPORTED;
+	}
+	*outPointer = stream->memory;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsSeek(EdsStreamRef inStreamRef, EdsInt64 inSeekOffset, EdsSeekOrigin inSeekOrigin)
+{
+	MOCK_CALL();
+	MockStream* stream = mockCast<MockStream>(inStreamRef);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	EdsInt64 base = 0;
+	switch(inSeekOrigin)
+	{
+	case kEdsSeek_Cur:		base = (EdsInt64)stream->position;	break;
+	case kEdsSeek_Begin:	base = 0;							break;
+	case kEdsSeek_End:		base = (EdsInt64)stream->length();	break;
+	default:				return EDS_ERR_INVALID_PARAMETER;
+	}
+
+	EdsInt64 position = base + inSeekOffset;
+	if(position < 0 || (stream->file == NULL && (EdsUInt64)position > stream->capacity))
+	{
+		return EDS_ERR_STREAM_SEEK_ERROR;
+	}
+	if(stream->file != NULL && fseek(stream->file, (long)position, SEEK_SET) != 0)
+	{
+		return EDS_ERR_STREAM_SEEK_ERROR;
+	}
+	stream->position = (EdsUInt64)position;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetPosition(EdsStreamRef inStreamRef, EdsUInt64* outPosition)
+{
+	MOCK_CALL();
+	MockStream* stream = mockCast<MockStream>(inStreamRef);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(outPosition == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*outPosition = stream->position;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetLength(EdsStreamRef inStreamRef, EdsUInt64* outLength)
+{
+	MOCK_CALL();
+	MockStream* stream = mockCast<MockStream>(inStreamRef);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(outLength == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*outLength = stream->length();
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsSetProgressCallback(EdsBaseRef inRef, EdsProgressCallback inProgressCallback, EdsProgressOption inProgressOption, EdsVoid* inContext)
+{
+	MOCK_CALL();
+	MockStream* stream = mockCast<MockStream>(inRef);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	stream->progress = (inProgressOption == kEdsProgressOption_NoReport) ? NULL : inProgressCallback;
+	stream->progressContext = inContext;
+	return EDS_ERR_OK;
+}
+
+
+/******************************************************************************
+ Images
+******************************************************************************/
+
+// Frame size from the SOF segment of a JPEG
+static bool jpegSize(const std::vector<unsigned char>& data, EdsUInt32& outWidth, EdsUInt32& outHeight)
+{
+	size_t i = 2;
+	if(data.size() < 4 || data[0] != 0xff || data[1] != 0xd8)
+	{
+		return false;
+	}
+	while(i + 9 < data.size())
+	{
+		if(data[i] != 0xff)
+		{
+			return false;
+		}
+		unsigned char marker = data[i + 1];
+		size_t length = ((size_t)data[i + 2] << 8) | data[i + 3];
+		if(marker >= 0xc0 && marker <= 0xc2)
+		{
+			outHeight = ((EdsUInt32)data[i + 5] << 8) | data[i + 6];
+			outWidth = ((EdsUInt32)data[i + 7] << 8) | data[i + 8];
+			return outWidth > 0 && outHeight > 0;
+		}
+		i += 2 + length;
+	}
+	return false;
+}
+
+EdsError EDSAPI EdsCreateImageRef(EdsStreamRef inStreamRef, EdsImageRef* outImageRef)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockStream* stream = mockCast<MockStream>(inStreamRef);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(outImageRef == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	std::vector<unsigned char> data;
+	if(!stream->contents(data))
+	{
+		return EDS_ERR_STREAM_READ_ERROR;
+	}
+	MockImage* image = new MockImage();
+	if(data.size() >= 12 && data[8] == 'C' && data[9] == 'R')
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		image->raw = true;
+		image->width = std::max(8u, sdk.config.jpegWidth);
+		image->height = std::max(8u, sdk.config.jpegHeight);
+	}
+	else if(!jpegSize(data, image->width, image->height))
+	{
+		EdsRelease(image);
+		return EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+	}
+	*outImageRef = image;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetImageInfo(EdsImageRef inImageRef, EdsImageSource inImageSource, EdsImageInfo* outImageInfo)
+{
+	MOCK_CALL();
+	MockImage* image = mockCast<MockImage>(inImageRef);
+	if(image == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(outImageInfo == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	memset(outImageInfo, 0, sizeof(*outImageInfo));
+	if(!image->sourceSize(inImageSource, outImageInfo->width, outImageInfo->height))
+	{
+		return EDS_ERR_NOT_SUPPORTED;
+	}
+	outImageInfo->numOfComponents = 3;
+	outImageInfo->componentDepth = 8;
+	outImageInfo->effectiveRect.size.width = outImageInfo->width;
+	outImageInfo->effectiveRect.size.height = outImageInfo->height;
+	return EDS_ERR_OK;
+}
+
+// 8 or 16 bit RGB; the pixels are a gradient, not the file's. Developing
+// a RAW costs developMicrosPerMegapixel of the output, without the lock.
+EdsError EDSAPI EdsGetImage(EdsImageRef inImageRef, EdsImageSource inImageSource, EdsTargetImageType inImageType, EdsRect inSrcRect, EdsSize inDstSize, EdsStreamRef outStreamRef)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockImage* image = mockCast<MockImage>(inImageRef);
+	MockStream* stream = mockCast<MockStream>(outStreamRef);
+	if(image == NULL || stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	EdsUInt32 width, height;
+	if(!image->sourceSize(inImageSource, width, height) || (inImageType != kEdsTargetImageType_RGB && inImageType != kEdsTargetImageType_RGB16))
+	{
+		return EDS_ERR_NOT_SUPPORTED;
+	}
+	if(inSrcRect.point.x < 0 || inSrcRect.point.y < 0 || inDstSize.width <= 0 || inDstSize.height <= 0
+		|| (EdsUInt32)(inSrcRect.point.x + inSrcRect.size.width) > width || (EdsUInt32)(inSrcRect.point.y + inSrcRect.size.height) > height)
+	{
+		return EDS_ERR_INVALID_PARAMETER;
+	}
+
+	EdsUInt64 latency = 0;
+	if(image->raw && (inImageSource == kEdsImageSrc_FullView || inImageSource == kEdsImageSrc_RAWFullView))
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		latency = (EdsUInt64)sdk.config.developMicrosPerMegapixel * inDstSize.width * inDstSize.height / 1000000;
+	}
+	simulateLatency(latency);
+
+	bool wide = (inImageType == kEdsTargetImageType_RGB16);
+	std::vector<unsigned char> row((size_t)inDstSize.width * (wide ? 6 : 3));
+	for(EdsInt32 y = 0; y < inDstSize.height; y++)
+	{
+		for(EdsInt32 x = 0; x < inDstSize.width; x++)
+		{
+			unsigned char rgb[3] =
+			{
+				(unsigned char)(32 + x * 160 / inDstSize.width),
+				(unsigned char)(32 + y * 160 / inDstSize.height),
+				(unsigned char)(((x ^ y) & 8) ? 140 : 100),
+			};
+			for(int c = 0; c < 3; c++)
+			{
+				if(wide)
+				{
+					// Native order 16 bit, the 8 bit value scaled to full range
+					EdsUInt16 value = (EdsUInt16)(rgb[c] * 257);
+					memcpy(&row[(x * 3 + c) * 2], &value, sizeof(value));
+				}
+				else
+				{
+					row[x * 3 + c] = rgb[c];
+				}
+			}
+		}
+		EdsError err = stream->write(&row[0], row.size());
+		if(err != EDS_ERR_OK)
+		{
+			return err;
+		}
+	}
+	return EDS_ERR_OK;
+}
+
+
+/******************************************************************************
+ Live view
+******************************************************************************/
+
+EdsError EDSAPI EdsCreateEvfImageRef(EdsStreamRef inStreamRef, EdsEvfImageRef* outEvfImageRef)
+{
+	MOCK_CALL();
+	MockStream* stream = mockCast<MockStream>(inStreamRef);
+	if(stream == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if(outEvfImageRef == NULL)
+	{
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*outEvfImageRef = new MockEvfImage(stream);
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsDownloadEvfImage(EdsCameraRef inCameraRef, EdsEvfImageRef inEvfImageRef)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	MockEvfImage* image = mockCast<MockEvfImage>(inEvfImageRef);
+	if(camera == NULL || image == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	MockFrameRef frame;
+	EdsUInt64 latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		if(!camera->sessionOpen)
+		{
+			return EDS_ERR_SESSION_NOT_OPEN;
+		}
+		if(sdk.drawBusy())
+		{
+			return EDS_ERR_DEVICE_BUSY;
+		}
+		if(!(camera->getUInt32(kEdsPropID_Evf_OutputDevice) & kEdsEvfOutputDevice_PC) || sdk.evfFrames.empty())
+		{
+			sdk.evfNotReady++;
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+
+		EdsUInt64 now = mockClockMicros();
+		EdsUInt64 interval = std::max<EdsUInt32>(1, sdk.config.evfFrameIntervalMicros);
+		EdsUInt64 tick = (now - camera->evfStartMicros) / interval;
+		if(now < camera->evfStartMicros + sdk.config.evfWarmupMicros || tick == camera->evfLastTick)
+		{
+			sdk.evfNotReady++;
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+		camera->evfLastTick = tick;
+		frame = sdk.evfFrames[(size_t)(tick % sdk.evfFrames.size())];
+
+		EdsUInt32 zoom = std::max<EdsUInt32>(1, camera->getUInt32(kEdsPropID_Evf_Zoom));
+		EdsPoint position = { 0, 0 };
+		std::map<EdsPropertyID, MOCK_PROPERTY>::const_iterator it = camera->properties.find(kEdsPropID_Evf_ZoomPosition);
+		if(it != camera->properties.end() && it->second.data.size() == sizeof(position))
+		{
+			memcpy(&position, &it->second.data[0], sizeof(position));
+		}
+
+		image->zoom = zoom;
+		image->coordinateSystem.width = (EdsInt32)sdk.config.jpegWidth;
+		image->coordinateSystem.height = (EdsInt32)sdk.config.jpegHeight;
+		image->zoomRect.point = position;
+		image->zoomRect.size.width = (EdsInt32)sdk.config.jpegWidth / (EdsInt32)(zoom * 5);
+		image->zoomRect.size.height = (EdsInt32)sdk.config.jpegHeight / (EdsInt32)(zoom * 5);
+		image->imagePosition = (zoom > 1) ? position : EdsPoint();
+		latency = sdk.config.evfLatencyMicros;
+	}
+
+	simulateLatency(latency);
+
+	image->frame = frame;
+	EdsError err = image->stream->write(&frame->jpeg[0], frame->jpeg.size());
+	if(err == EDS_ERR_OK)
+	{
+		sdk.evfDelivered++;
+	}
+	return err;
+}
+
+
+/******************************************************************************
+ Events
+******************************************************************************/
+
+EdsError EDSAPI EdsSetPropertyEventHandler(EdsCameraRef inCameraRef, EdsPropertyEvent, EdsPropertyEventHandler inPropertyEventHandler, EdsVoid* inContext)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	camera->propertyHandler = inPropertyEventHandler;
+	camera->propertyContext = inContext;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsSetObjectEventHandler(EdsCameraRef inCameraRef, EdsObjectEvent, EdsObjectEventHandler inObjectEventHandler, EdsVoid* inContext)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	camera->objectHandler = inObjectEventHandler;
+	camera->objectContext = inContext;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsSetCameraStateEventHandler(EdsCameraRef inCameraRef, EdsStateEvent, EdsStateEventHandler inStateEventHandler, EdsVoid* inContext)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	MockCamera* camera = mockCast<MockCamera>(inCameraRef);
+	if(camera == NULL)
+	{
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	camera->stateHandler = inStateEventHandler;
+	camera->stateContext = inContext;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsSetCameraAddedHandler(EdsCameraAddedHandler inCameraAddedHandler, EdsVoid* inContext)
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	std::lock_guard<std::mutex> lock(sdk.mutex);
+	sdk.cameraAddedHandler = inCameraAddedHandler;
+	sdk.cameraAddedContext = inContext;
+	return EDS_ERR_OK;
+}
+
+EdsError EDSAPI EdsGetEvent()
+{
+	MOCK_CALL();
+	MockSdk& sdk = mockSdk();
+	{
+		std::lock_guard<std::mutex> lock(sdk.mutex);
+		if(sdk.config.eventThread && sdk.eventThread.joinable())
+		{
+			return EDS_ERR_OK;
+		}
+	}
+	sdk.deliverDue();
+	return EDS_ERR_OK;
+}
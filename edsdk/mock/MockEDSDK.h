@@ -0,0 +1,106 @@
+/******************************************************************************
+*                                                                             *
+*   PROJECT : EOS Digital Software Development Kit EDSDK                      *
+*      NAME : MockEDSDK.h                                                     *
+*                                                                             *
+*   Description: This is the Sample code to show the usage of EDSDK.          *
+*                                                                             *
+*                                                                             *
+*******************************************************************************/
+
+#pragma once
+
+#include "EDSDK.h"
+
+
+// An in-process stand-in for the EDSDK library, linked instead of it with
+// -DEDSDK_MOCK=ON. It implements the calls the sample makes against
+// simulated bodies, so the command, live view and download paths run and
+// can be timed with no camera attached.
+//
+// Each body has volumeCount cards of DCIM folders. A capture is sent as a
+// transfer request and, while kEdsPropID_SaveTo includes the camera, also
+// written to the first card with a DirItemCreated event.
+//
+// Events queue inside the mock and are delivered by EdsGetEvent(), as the
+// real SDK does without a message loop, or on a thread of their own with
+// eventThread set.
+typedef struct _MOCK_EDSDK_CONFIG
+{
+	EdsUInt32	cameraCount;				// bodies EdsGetCameraList reports
+
+	EdsUInt32	sessionLatencyMicros;		// EdsOpenSession / EdsCloseSession
+	EdsUInt32	propertyLatencyMicros;		// EdsGetPropertySize / Data / Desc on a camera
+	EdsUInt32	setPropertyLatencyMicros;	// EdsSetPropertyData on a camera
+	EdsUInt32	commandLatencyMicros;		// EdsSendCommand / EdsSendStatusCommand
+
+	EdsUInt32	evfLatencyMicros;			// inside EdsDownloadEvfImage
+	EdsUInt32	evfPropertyLatencyMicros;	// EdsGetPropertyData on a live view image
+	EdsUInt32	evfFrameIntervalMicros;		// a new frame this often, EDS_ERR_OBJECT_NOTREADY between
+	EdsUInt32	evfWarmupMicros;			// EDS_ERR_OBJECT_NOTREADY this long after the PC output starts
+	EdsUInt32	evfWidth;
+	EdsUInt32	evfHeight;
+
+	EdsUInt32	captureLatencyMicros;		// shutter release to DirItemRequestTransfer
+	EdsUInt32	transferBytesPerSecond;		// EdsDownload rate, 0 for no limit
+	EdsUInt32	jpegWidth;					// the captured JPEG
+	EdsUInt32	jpegHeight;
+	EdsUInt32	rawSize;					// bytes of a RAW sent after each JPEG, 0 for none
+
+	EdsUInt32	volumeCount;				// cards in each body
+	EdsUInt32	cardFiles;					// shots on each card at EdsInitializeSDK, as a JPEG
+											// and, with rawSize, a RAW each
+	EdsUInt32	enumerateLatencyMicros;		// EdsGetChildCount / AtIndex / DirectoryItemInfo on a card
+	EdsUInt32	developMicrosPerMegapixel;	// EdsGetImage of a RAW's full view, per output megapixel
+
+	EdsUInt32	busyPermille;				// chance per command, property set or live view
+											// download of EDS_ERR_DEVICE_BUSY, in 1/1000
+	EdsUInt32	seed;						// for the busy draws and the RAW payload
+	bool		eventThread;				// deliver events on a mock thread
+	bool		sessionEvents;				// PropertyChanged / DescChanged for every property
+											// after EdsOpenSession, as bodies send
+}MOCK_EDSDK_CONFIG;
+
+
+// Counted since EdsInitializeSDK or MockEdsResetStatistics
+typedef struct _MOCK_EDSDK_STATISTICS
+{
+	EdsUInt64	calls;						// SDK functions called
+	EdsUInt64	busyInjected;
+	EdsUInt64	evfFrames;					// EdsDownloadEvfImage calls that returned a frame
+	EdsUInt64	evfNotReady;
+	EdsUInt64	captures;					// shutter releases
+	EdsUInt64	transferRequests;			// DirItemRequestTransfer events sent
+	EdsUInt64	bytesDownloaded;
+	EdsUInt64	thumbnails;					// EdsDownloadThumbnail calls that returned one
+	EdsUInt64	eventsDelivered;
+	EdsUInt64	liveObjects;				// references not yet released, 0 after a clean shutdown
+}MOCK_EDSDK_STATISTICS;
+
+
+// A body with ~30 fps live view, 10 ms commands and a 40 MB/s link
+void MockEdsGetDefaultConfig(MOCK_EDSDK_CONFIG* outConfig);
+
+// Latencies and busy injection apply from the next call; the camera count,
+// payload sizes and eventThread from the next EdsInitializeSDK.
+void MockEdsSetConfig(const MOCK_EDSDK_CONFIG* inConfig);
+void MockEdsGetConfig(MOCK_EDSDK_CONFIG* outConfig);
+
+void MockEdsGetStatistics(MOCK_EDSDK_STATISTICS* outStatistics);
+void MockEdsResetStatistics();
+
+// Send a state event, e.g. kEdsStateEvent_Shutdown, from camera inIndex
+EdsError MockEdsSendStateEvent(EdsUInt32 inIndex, EdsStateEvent inEvent, EdsUInt32 inEventData);
+
+// Plug in a body, with a CameraAdded event; returns its index in the
+// camera list, 0xffffffff before EdsInitializeSDK
+EdsUInt32 MockEdsAttachCamera();
+
+// Unplug body inIndex: it leaves the camera list and sends
+// kEdsStateEvent_Shutdown. Later bodies move down one index.
+EdsError MockEdsDetachCamera(EdsUInt32 inIndex);
+
+// A USB reset of body inIndex: it is detached as above, then comes back
+// inDownMicros later as the same body (port, serial and settings) under a
+// new reference, at the end of the camera list and with a CameraAdded event.
+EdsError MockEdsResetCamera(EdsUInt32 inIndex, EdsUInt32 inDownMicros);
@@ -29,33 +29,8 @@ CAEMode::CAEMode()
 	// set up action command
 	setActionCommand("set_AEMode");
 
-	// Map of value and display name
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0,"P"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(1,"Tv"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(2,"Av"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(3,"M"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(55,"FV"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(4,"Bulb"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(5,"A-DEP"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(6,"DEP"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(7,"C1"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(16,"C2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(17,"C3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(8,"Lock"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(9,"GreenMode"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(10,"Night Portrait"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(11,"Sports"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(13,"LandScape"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(14,"Close-Up"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(15,"No Strobo"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(12,"Portrait"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(19,"Creative Auto"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(20,"Movies"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(25,"SCN"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(22,"Scene Intelligent Auto"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(29,"Creative filters"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xffffffff,"unknown"));
-
+	// Display names of the values
+	_propertyTable = findPropertyLabelTable(kEdsPropID_AEModeSelect);
 }
 
 CAEMode::~CAEMode()
@@ -93,6 +68,18 @@ void CAEMode::update(Observable* from, CameraEvent *e)
 		}
 	}
 
+	//Update of several properties at once
+	if(event == "PropertiesChanged")
+	{
+		const PropertyIDList* propertyIDs = static_cast<PropertyIDList *>(e->getArg());
+
+		if(std::find(propertyIDs->begin(), propertyIDs->end(), (EdsPropertyID)kEdsPropID_AEModeSelect) != propertyIDs->end())
+		{
+			//The update processing can be executed from another thread. 
+			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
+		}
+	}
+
 	//Update of list that can set property
 	if(event == "PropertyDescChanged")
 	{
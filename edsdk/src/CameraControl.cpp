@@ -138,7 +138,7 @@ BOOL CCameraControlApp::InitInstance()
 		CCameraControlDlg			view;
 		
 		_controller->setCameraModel(_model);
-		_model->addObserver(&view);
+		_model->addEventObserver(&view, cameraEventMask(kCameraEvent_DownloadComplete) | cameraEventMask(kCameraEvent_ProgressReport) | cameraEventMask(kCameraEvent_ShutDown));
 		// Send Model Event to view	
 		view.setCameraController(_controller);
 
@@ -169,18 +169,30 @@ void CCameraControlDlg::setupListener(ActionListener* listener)
 }
 
 
+// The property events of the given properties only
+static EventFilter propertyFilter(EdsPropertyID propertyID, EdsUInt32 mask = cameraEventMask(kCameraEvent_PropertyChanged) | cameraEventMask(kCameraEvent_PropertiesChanged) | cameraEventMask(kCameraEvent_PropertyDescChanged))
+{
+	return EventFilter(mask, PropertyIDList(1, propertyID));
+}
+
 void CCameraControlDlg::setupObserver(Observable* ob)
 {
-	ob->addObserver(static_cast<Observer*>(&_comboAEMode));
-	ob->addObserver(static_cast<Observer*>(&_comboTv));
-	ob->addObserver(static_cast<Observer*>(&_comboAv));
-	ob->addObserver(static_cast<Observer*>(&_comboIso));
-	ob->addObserver(static_cast<Observer*>(&_comboMeteringMode));
-	ob->addObserver(static_cast<Observer*>(&_comboExposureComp));
-	ob->addObserver(static_cast<Observer*>(&_comboImageQuality));
-	ob->addObserver(static_cast<Observer*>(&_pictureBox));
-	ob->addObserver(static_cast<Observer*>(&_comboEvfAFMode));
-	ob->addObserver(static_cast<Observer*>(&_btnZoomZoom));
+	ob->addObserver(static_cast<Observer*>(&_comboAEMode), propertyFilter(kEdsPropID_AEModeSelect));
+	ob->addObserver(static_cast<Observer*>(&_comboTv), propertyFilter(kEdsPropID_Tv));
+	ob->addObserver(static_cast<Observer*>(&_comboAv), propertyFilter(kEdsPropID_Av));
+	ob->addObserver(static_cast<Observer*>(&_comboIso), propertyFilter(kEdsPropID_ISOSpeed));
+	ob->addObserver(static_cast<Observer*>(&_comboMeteringMode), propertyFilter(kEdsPropID_MeteringMode));
+	ob->addObserver(static_cast<Observer*>(&_comboExposureComp), propertyFilter(kEdsPropID_ExposureCompensation));
+	ob->addObserver(static_cast<Observer*>(&_comboImageQuality), propertyFilter(kEdsPropID_ImageQuality));
+
+	PropertyIDList evfProperties;
+	evfProperties.push_back(kEdsPropID_Evf_OutputDevice);
+	evfProperties.push_back(kEdsPropID_FocusInfo);
+	evfProperties.push_back(kEdsPropID_Evf_AFMode);
+	ob->addEventObserver(&_pictureBox, EventFilter(cameraEventMask(kCameraEvent_EvfDataChanged) | cameraEventMask(kCameraEvent_PropertyChanged), evfProperties));
+
+	ob->addObserver(static_cast<Observer*>(&_comboEvfAFMode), propertyFilter(kEdsPropID_Evf_AFMode));
+	ob->addObserver(static_cast<Observer*>(&_btnZoomZoom), propertyFilter(kEdsPropID_Evf_AFMode, cameraEventMask(kCameraEvent_PropertyChanged)));
 }
 
 void CCameraControlDlg::OnClose()
@@ -206,28 +218,28 @@ void CCameraControlDlg::OnClose()
 }
 
 
-void CCameraControlDlg::update(Observable* from, CameraEvent *e)
+void CCameraControlDlg::onEvent(Observable* from, const CameraEvent& e)
 {
-	std::string event = e->getEvent();
+	CameraEventID event = e.getID();
 
 	//End of download of image
-	if(event == "DownloadComplete")
+	if(event == kCameraEvent_DownloadComplete)
 	{
 		//The update processing can be executed from another thread. 
 		::PostMessage(this->m_hWnd, WM_USER_DOWNLOAD_COMPLETE, NULL, NULL);
 	}
 
 	//Progress of download of image
-	if(event == "ProgressReport")
+	if(event == kCameraEvent_ProgressReport)
 	{
-		EdsInt32 percent = *static_cast<EdsInt32 *>(e->getArg());
+		EdsUInt32 percent = *e.getPayload<kCameraEvent_ProgressReport>();
 		
 		//The update processing can be executed from another thread. 
 		::PostMessage(this->m_hWnd, WM_USER_PROGRESS_REPORT, percent, NULL);
 	}
 
 	//shutdown event
-	if(event == "shutDown")
+	if(event == kCameraEvent_ShutDown)
 	{
 		::PostMessage(this->m_hWnd, WM_CLOSE, 0, NULL);
 	}
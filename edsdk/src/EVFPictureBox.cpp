@@ -24,35 +24,151 @@
 
 IMPLEMENT_DYNAMIC(CEVFPictureBox, CStatic)
 CEVFPictureBox::CEVFPictureBox()
+	: m_renderStop(false), m_front(0), m_frontReady(false), m_posted(false), m_surfaceSize(0, 0)
 {
 	active = FALSE;
 	memset(&m_focusInfo, 0, sizeof(EdsFocusInfo));
+#ifdef HAVE_LIBJPEG
+	// DIB rows are DWORD aligned.
+	m_decoder.setRowAlignment(4);
+#endif
 }
 
 CEVFPictureBox::~CEVFPictureBox()
 {
+	stopRenderer();
 }
 
 
 BEGIN_MESSAGE_MAP(CEVFPictureBox, CStatic)
 	ON_MESSAGE(WM_USER_EVF_DATA_CHANGED, OnEvfDataChanged)
+	ON_WM_DESTROY()
 END_MESSAGE_MAP()
 
 
 
+// Render thread
+
+void CEVFPictureBox::startRenderer()
+{
+	if(!m_renderThread.joinable())
+	{
+		m_renderThread = std::thread(&CEVFPictureBox::renderProc, this);
+	}
+}
+
+void CEVFPictureBox::stopRenderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_renderMutex);
+		m_renderStop = true;
+		m_pendingFrame.reset();
+	}
+	m_renderCondition.notify_all();
+	if(m_renderThread.joinable())
+	{
+		m_renderThread.join();
+	}
+}
+
+// Called on the processor thread; returns at once.
+void CEVFPictureBox::submitFrame(const EvfFrameRef& frame)
+{
+	if(!frame)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_renderMutex);
+		if(m_renderStop)
+		{
+			return;
+		}
+		startRenderer();
+		// Replaces a frame the renderer has not picked up yet
+		m_pendingFrame = frame;
+	}
+	m_renderCondition.notify_one();
+}
+
+void CEVFPictureBox::renderProc()
+{
+	for(;;)
+	{
+		EvfFrameRef frame;
+		{
+			std::unique_lock<std::mutex> lock(m_renderMutex);
+			m_renderCondition.wait(lock, [this]{ return m_renderStop || m_pendingFrame; });
+			if(m_renderStop)
+			{
+				return;
+			}
+			frame.swap(m_pendingFrame);
+		}
+
+		TraceScope trace("UI", "RenderEvf");
+
+		// Only this thread writes m_front, and the UI never reads the back buffer.
+		RenderedFrame& back = m_buffers[1 - m_front];
+		back.data = frame->getDataSet();
+		back.data.stream = NULL;
+		back.frame = frame;
+
+#ifdef HAVE_LIBJPEG
+		// Decode straight to BGR at the smallest DCT scale that still covers the window.
+		RECT rect = {0};
+		::GetWindowRect(m_hWnd, &rect);
+		int windowWidth = rect.right - rect.left;
+		int windowHeight = rect.bottom - rect.top;
+
+		int width = 0;
+		int height = 0;
+		if(m_decoder.readHeader(frame->getData(), (size_t)frame->getLength(), width, height))
+		{
+			int scale = 8;
+			while(scale > 1 && (width / scale < windowWidth || height / scale < windowHeight))
+			{
+				scale /= 2;
+			}
+
+			if(m_decoder.decode(frame->getData(), (size_t)frame->getLength(), back.image, kJpegPixelFormat_BGR, scale))
+			{
+				// Decoded, the stream can go back to the pool
+				back.frame.reset();
+			}
+		}
+#endif
+
+		{
+			std::lock_guard<std::mutex> lock(m_bufferMutex);
+			m_front = 1 - m_front;
+			m_frontReady = true;
+		}
+
+		// One message at a time; the UI draws whichever frame is in front by then.
+		if(!m_posted.exchange(true) && !::PostMessage(m_hWnd, WM_USER_EVF_DATA_CHANGED, 0, 0))
+		{
+			m_posted = false;
+		}
+	}
+}
+
+
+
 // CEVFPictureBox messge handler
 
-void CEVFPictureBox::update(Observable* from, CameraEvent *e)
+void CEVFPictureBox::onEvent(Observable* from, const CameraEvent& e)
 {
 
-	std::string event = e->getEvent();
+	CameraEventID event = e.getID();
 
-	if(event == "EvfDataChanged")
+	if(event == kCameraEvent_EvfDataChanged)
 	{
-		EVF_DATASET data = *static_cast<EVF_DATASET *>(e->getArg());
-	
-		//The update processing can be executed from another thread. 
-		::SendMessage(this->m_hWnd, WM_USER_EVF_DATA_CHANGED, (WPARAM) &data, NULL);
+		// The model holds the frame just downloaded, and the renderer a
+		// reference to it, so nothing is copied and this thread does not wait.
+		CameraModel* model = (CameraModel *)from;
+		submitFrame(model->getEvfFrame());
 
 		EdsInt32 propertyID = kEdsPropID_FocusInfo;
 		fireEvent("get_Property", &propertyID);
@@ -61,9 +177,9 @@ void CEVFPictureBox::update(Observable* from, CameraEvent *e)
 		fireEvent("downloadEVF");
 	}
 	
-	if (event == "PropertyChanged")
+	if (event == kCameraEvent_PropertyChanged)
 	{
-		EdsInt32 proeprtyID = *static_cast<EdsInt32 *>(e->getArg());
+		EdsInt32 proeprtyID = *e.getPayload<kCameraEvent_PropertyChanged>();
 		if(proeprtyID == kEdsPropID_Evf_OutputDevice)
 		{
 			CameraModel* model = (CameraModel *)from;
@@ -114,40 +230,99 @@ void CEVFPictureBox::update(Observable* from, CameraEvent *e)
 
 LRESULT CEVFPictureBox::OnEvfDataChanged(WPARAM wParam, LPARAM lParam)
 {
-	EVF_DATASET data = *(EVF_DATASET *)wParam;
-	EdsUInt64 size;
+	TraceScope trace("UI", "OnEvfDataChanged");
 
-	unsigned char* pbyteImage = NULL; 
+	// Frames swapped in from here on post again
+	m_posted = false;
 
-	// Get image (JPEG) pointer.
-	EdsGetPointer(data.stream, (EdsVoid**)&pbyteImage );
-	
-	if(pbyteImage != NULL)
+	CRect rect;
+	GetWindowRect(&rect);
+	if(rect.Width() <= 0 || rect.Height() <= 0)
 	{
-		EdsGetLength(data.stream, &size);
+		return 0;
+	}
 
-		CDC *pDC = GetDC();
-	
-		// Display image data.
-		OnDrawImage(pDC, pbyteImage, size);
+	CDC *pDC = GetDC();
 
-		// Display the focus border if displaying the entire image.
-		if(data.zoom == 1 && (data.sizeJpegLarge.width != 0 && data.sizeJpegLarge.height != 0))
+	CDC memDC;
+	memDC.CreateCompatibleDC(pDC);
+	if(m_surface.GetSafeHandle() == NULL || m_surfaceSize != rect.Size())
+	{
+		m_surface.DeleteObject();
+		m_surface.CreateCompatibleBitmap(pDC, rect.Width(), rect.Height());
+		m_surfaceSize = rect.Size();
+	}
+	CBitmap *oldBitmap = memDC.SelectObject(&m_surface);
+
+	bool drawn = false;
+	{
+		// The render thread waits here for its next swap only
+		std::lock_guard<std::mutex> lock(m_bufferMutex);
+		if(m_frontReady)
 		{
-			OnDrawFocusRect(pDC, CRect(data.zoomRect.point.x, data.zoomRect.point.y, data.zoomRect.point.x + data.zoomRect.size.width, data.zoomRect.point.y + data.zoomRect.size.height), CSize(data.sizeJpegLarge.width, data.sizeJpegLarge.height));
+			const RenderedFrame& front = m_buffers[m_front];
+
+			// Display image data.
+			OnDrawImage(&memDC, front, rect);
+
+			// Display the focus border if displaying the entire image.
+			const EVF_DATASET& data = front.data;
+			if(data.zoom == 1 && (data.sizeJpegLarge.width != 0 && data.sizeJpegLarge.height != 0))
+			{
+				OnDrawFocusRect(&memDC, CRect(data.zoomRect.point.x, data.zoomRect.point.y, data.zoomRect.point.x + data.zoomRect.size.width, data.zoomRect.point.y + data.zoomRect.size.height), CSize(data.sizeJpegLarge.width, data.sizeJpegLarge.height));
+			}
+			drawn = true;
 		}
+	}
 
-		ReleaseDC(pDC);
+	// One blit, so the border never flickers over a half drawn frame
+	if(drawn)
+	{
+		pDC->BitBlt(0, 0, rect.Width(), rect.Height(), &memDC, 0, 0, SRCCOPY);
 	}
 
+	memDC.SelectObject(oldBitmap);
+	ReleaseDC(pDC);
 
 	return 0;
 }
 
+void CEVFPictureBox::OnDestroy()
+{
+	// The render thread posts to this window
+	stopRenderer();
+	CStatic::OnDestroy();
+}
 
 
-void CEVFPictureBox::OnDrawImage(CDC *pDC, unsigned char* pbyteImage, int size)
+
+void CEVFPictureBox::OnDrawImage(CDC *pDC, const RenderedFrame& rendered, const CRect& rect)
 {
+#ifdef HAVE_LIBJPEG
+	if(!rendered.frame)
+	{
+		const DecodedImage& image = rendered.image;
+
+		BITMAPINFO bmi = {0};
+		bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		bmi.bmiHeader.biWidth = image.getWidth();
+		bmi.bmiHeader.biHeight = -image.getHeight(); // top-down
+		bmi.bmiHeader.biPlanes = 1;
+		bmi.bmiHeader.biBitCount = 24;
+		bmi.bmiHeader.biCompression = BI_RGB;
+
+		SetStretchBltMode(pDC->GetSafeHdc(), COLORONCOLOR);
+		StretchDIBits(pDC->GetSafeHdc(), 0, 0, rect.Width(), rect.Height(),
+			0, 0, image.getWidth(), image.getHeight(),
+			image.getPixels(), &bmi, DIB_RGB_COLORS, SRCCOPY);
+		return;
+	}
+#endif
+
+	// Not decoded by the render thread
+	const unsigned char* pbyteImage = rendered.frame->getData();
+	SIZE_T size = (SIZE_T)rendered.frame->getLength();
+
 	CImage image;
 
 	CComPtr<IStream> stream;
@@ -163,10 +338,6 @@ void CEVFPictureBox::OnDrawImage(CDC *pDC, unsigned char* pbyteImage, int size)
 
 	image.Load(stream);
 
-	
-	CRect rect;
-	GetWindowRect(&rect);
-
 	// Drawing
 	SetStretchBltMode(pDC->GetSafeHdc() , COLORONCOLOR);
 	image.StretchBlt(pDC->GetSafeHdc(),  0,0,rect.Width(),rect.Height(),0,0,image.GetWidth(), image.GetHeight(),SRCCOPY);
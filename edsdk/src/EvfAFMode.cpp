@@ -27,27 +27,8 @@ CEvfAFMode::CEvfAFMode()
 	// set up action command
 	setActionCommand("set_EvfAFMode");
 
-	// Map of value and display name
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x00,"Quick mode"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x01,"1-point AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x02,"Face+Tracking"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x03,"FlexiZone - Multi"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x04,"Zone AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x05,"Expand AF area"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x06,"Expand AF area: Around"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x07,"Large Zone AF: Horizontal"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x08,"Large Zone AF: Vertical"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x09,"Catch AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0a,"Spot AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0b,"Flexible Zone AF 1"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0c,"Flexible Zone AF 2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0d,"Flexible Zone AF 3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0e,"Whole area AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0f,"No Traking Spot AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x10,"No Traking 1-point AF"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x11,"No Traking Expand AF area"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x12,"No Traking Expand AF area: Around"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xffffffff,"unknown"));
+	// Display names of the values
+	_propertyTable = findPropertyLabelTable(kEdsPropID_Evf_AFMode);
 }
 
 CEvfAFMode::~CEvfAFMode()
@@ -86,6 +67,18 @@ void CEvfAFMode::update(Observable* from, CameraEvent *e)
 			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
 		}
 	}
+	//Update of several properties at once
+	if(event == "PropertiesChanged")
+	{
+		const PropertyIDList* propertyIDs = static_cast<PropertyIDList *>(e->getArg());
+
+		if(std::find(propertyIDs->begin(), propertyIDs->end(), (EdsPropertyID)kEdsPropID_Evf_AFMode) != propertyIDs->end())
+		{
+			//The update processing can be executed from another thread. 
+			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
+		}
+	}
+
 	//Update of list that can set property
 	if(event == "PropertyDescChanged")
 	{
@@ -27,52 +27,8 @@ CExposureComp::CExposureComp()
 	// set up action command
 	setActionCommand("set_ExposureCompensation");
 
-	// Map of value and display name
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x28,"+5"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x25,"+4 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x24,"+4 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x23,"+4 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x20,"+4"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x1D,"+3 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x1C,"+3 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x1B,"+3 1/3"));
-
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x18,"+3"));
-	 _propertyTable.insert( std::pair<EdsUInt32, const char *>(0x15,"+2 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x14,"+2 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x13,"+2 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x10,"+2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0d,"+1 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0c,"+1 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0b,"+1 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x08,"+1"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x05,"+2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x04,"+1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x03,"+1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x00,"0"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xfd,"-1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xfc,"-1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xfb,"-2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xf8,"-1"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xf5,"-1 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xf4,"-1 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xf3,"-1 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xf0,"-2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xed,"-2 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xec,"-2 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xeb,"-2 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xe8,"-3"));
-
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xE5,"-3 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xE4,"-3 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xE3,"-3 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xE0,"-4"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xDD,"-4 1/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xDC,"-4 1/2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xDB,"-4 2/3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xD8,"-5"));
-
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xffffffff,"unknown"));
+	// Display names of the values
+	_propertyTable = findPropertyLabelTable(kEdsPropID_ExposureCompensation);
 }
 
 CExposureComp::~CExposureComp()
@@ -113,6 +69,18 @@ void CExposureComp::update(Observable* from, CameraEvent *e)
 		}
 	}
 
+	//Update of several properties at once
+	if(event == "PropertiesChanged")
+	{
+		const PropertyIDList* propertyIDs = static_cast<PropertyIDList *>(e->getArg());
+
+		if(std::find(propertyIDs->begin(), propertyIDs->end(), (EdsPropertyID)kEdsPropID_ExposureCompensation) != propertyIDs->end())
+		{
+			//The update processing can be executed from another thread. 
+			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
+		}
+	}
+
 	//Update of list that can set property
 	if(event == "PropertyDescChanged")
 	{
@@ -27,47 +27,8 @@ CIso::CIso()
 	// set up action command
 	setActionCommand("set_ISOSpeed");
 
-	// Map of value and display name
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x00,"Auto"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x28,"6"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x30,"12"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x38,"25"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x40,"50"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x48,"100"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x4b,"125"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x4d,"160"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x50,"200"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x53,"250"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x55,"320"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x58,"400"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x5b,"500"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x5d,"640"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x60,"800"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x63,"1000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x65,"1250"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x68,"1600"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x6b,"2000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x6d,"2500"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x70,"3200"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x73,"4000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x75,"5000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x78,"6400"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x7b,"8000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x7d,"10000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x80,"12800"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x83,"16000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x85,"20000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x88,"25600"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x8b,"32000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x8d,"40000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x90,"51200"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x93,"64000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x95,"80000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x98,"102400"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xa0,"204800"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xa8,"409600"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xb0,"819200"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xffffffff,"unknown"));
+	// Display names of the values
+	_propertyTable = findPropertyLabelTable(kEdsPropID_ISOSpeed);
 }
 
 CIso::~CIso()
@@ -108,6 +69,18 @@ void CIso::update(Observable* from, CameraEvent *e)
 		}
 	}
 
+	//Update of several properties at once
+	if(event == "PropertiesChanged")
+	{
+		const PropertyIDList* propertyIDs = static_cast<PropertyIDList *>(e->getArg());
+
+		if(std::find(propertyIDs->begin(), propertyIDs->end(), (EdsPropertyID)kEdsPropID_ISOSpeed) != propertyIDs->end())
+		{
+			//The update processing can be executed from another thread. 
+			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
+		}
+	}
+
 	//Update of list that can set property
 	if(event == "PropertyDescChanged")
 	{
@@ -27,12 +27,8 @@ CMeteringMode::CMeteringMode()
 	// set up action command
 	setActionCommand("set_MeteringMode");
 
-	// Map of value and display name
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(1,"Spot metering"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(3,"Evaluative metering"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(4,"Partial metering"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(5,"Center-weighted average"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xffffffff,"unknown"));
+	// Display names of the values
+	_propertyTable = findPropertyLabelTable(kEdsPropID_MeteringMode);
 }
 
 CMeteringMode::~CMeteringMode()
@@ -72,6 +68,18 @@ void CMeteringMode::update(Observable* from, CameraEvent *e)
 		}
 	}
 
+	//Update of several properties at once
+	if(event == "PropertiesChanged")
+	{
+		const PropertyIDList* propertyIDs = static_cast<PropertyIDList *>(e->getArg());
+
+		if(std::find(propertyIDs->begin(), propertyIDs->end(), (EdsPropertyID)kEdsPropID_MeteringMode) != propertyIDs->end())
+		{
+			//The update processing can be executed from another thread. 
+			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
+		}
+	}
+
 	//Update of list that can set property
 	if(event == "PropertyDescChanged")
 	{
@@ -21,7 +21,7 @@
 // CPropertyComboBox
 
 IMPLEMENT_DYNAMIC(CPropertyComboBox, CComboBox)
-CPropertyComboBox::CPropertyComboBox()
+CPropertyComboBox::CPropertyComboBox() : _propertyTable(NULL)
 {
 }
 
@@ -38,11 +38,11 @@ END_MESSAGE_MAP()
 void CPropertyComboBox::updateProperty(EdsUInt32 value)
 {
 	// The character string corresponding to data is acquired. 
-	std::map<EdsUInt32, const char*>::iterator itr = _propertyTable.find(value);
-	if (itr != _propertyTable.end())
+	const char* label = findPropertyLabel(_propertyTable, value);
+	if (label != NULL)
 	{		
 		// Set String combo box
-		SetWindowText(itr->second);
+		SetWindowText(label);
 	}
 }
 
@@ -63,15 +63,15 @@ void CPropertyComboBox::updatePropertyDesc(const EdsPropertyDesc* desc)
 	for(int i = 0; i < desc->numElements; i++)
 	{
 		// The character string corresponding to data is acquired.
-		std::map<EdsUInt32, const char *>::iterator itr = _propertyTable.find((EdsUInt32)desc->propDesc[i]);
+		const char* label = findPropertyLabel(_propertyTable, (EdsUInt32)desc->propDesc[i]);
 
 		// Create list of combo box
-		if (itr != _propertyTable.end())
+		if (label != NULL)
 		{
 			// Insert string
-			int index = InsertString(-1, itr->second);
+			int index = InsertString(-1, label);
 			// Set data
-			SetItemData(index, itr->first);
+			SetItemData(index, (EdsUInt32)desc->propDesc[i]);
 		}
 	}	
 }
@@ -25,89 +25,9 @@ IMPLEMENT_DYNAMIC(CTv, CPropertyComboBox)
 CTv::CTv()
 {
 	setActionCommand("set_Tv");
-	
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x04,"Auto"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x0c,"Bulb"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x10,"30h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x13,"25h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x14,"20h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x15,"20h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x18,"15h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x1B,"13h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x1C,"10h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x1D,"10h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x20,"8h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x23,"6h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x24,"6h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x25,"5h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x28,"4h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x2B,"3h2"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x2C,"3h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x2D,"2h5"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x30,"2h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x33,"1h6"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x34,"1h5"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x35,"1h3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x38,"1h"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x3B,"0h8"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x3C,"0h7"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x3D,"0h6"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x40,"0h5"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x43,"0h4"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x44,"0h3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x45,"0h3"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x48,"4"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x4B,"5"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x4C,"6"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x4D,"6"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x50,"8"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x53,"10"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x54,"10"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x55,"13"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x58,"15"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x5B,"20"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x5C,"20"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x5D,"25"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x60,"30"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x63,"40"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x64,"45"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x65,"50"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x68,"60"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x6B,"80"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x6C,"90"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x6D,"100"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x70,"125"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x73,"160"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x74,"180"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x75,"200"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x78,"250"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x7B,"320"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x7C,"350"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x7D,"400"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x80,"500"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x83,"640"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x84,"750"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x85,"800"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x88,"1000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x8B,"1250"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x8C,"1500"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x8D,"1600"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x90,"2000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x93,"2500"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x94,"3000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x95,"3200"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x98,"4000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x9B,"5000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x9C,"6000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0x9D,"6400"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xA0,"8000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xA3,"10000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xA5,"12800"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xA8,"16000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xAB,"20000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xAD,"25600"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xB0,"32000"));
-	_propertyTable.insert( std::pair<EdsUInt32, const char *>(0xffffffff,"unknown"));
+
+	// Display names of the values
+	_propertyTable = findPropertyLabelTable(kEdsPropID_Tv);
 }
 
 CTv::~CTv()
@@ -147,6 +67,18 @@ void CTv::update(Observable* from, CameraEvent *e)
 		}
 	}
 
+	//Update of several properties at once
+	if(event == "PropertiesChanged")
+	{
+		const PropertyIDList* propertyIDs = static_cast<PropertyIDList *>(e->getArg());
+
+		if(std::find(propertyIDs->begin(), propertyIDs->end(), (EdsPropertyID)kEdsPropID_Tv) != propertyIDs->end())
+		{
+			//The update processing can be executed from another thread. 
+			::PostMessage(this->m_hWnd, WM_USER_PROPERTY_CHANGED, NULL, NULL);
+		}
+	}
+
 	//Update of list that can set property
 	if(event == "PropertyDescChanged")
 	{
@@ -58,6 +58,10 @@ class CMakeBuild(build_ext):
             edsdk_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'lib', 'EDSDK')
             cmake_args += [f'-DEDSDK_PATH={edsdk_path}']
 
+        # Simulated cameras instead of the real EDSDK
+        if os.environ.get('EDSDK_MOCK'):
+            cmake_args += ['-DEDSDK_MOCK=ON']
+
         # Set build type
         cfg = 'Debug' if self.debug else 'Release'
         build_args = ['--config', cfg]
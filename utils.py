@@ -245,6 +245,36 @@ def create_save_directory(base_dir: str, camera_name: Optional[str] = None) -> s
     return save_dir
 
 
+def create_file_sink(base_dir: str, path_template: str = "{name}",
+                     camera_name: Optional[str] = None, write_size: int = 8 * 1024 * 1024,
+                     buffer_count: int = 4, unbuffered: bool = True) -> Any:
+    """Create a native file sink writing downloads under a new save directory.
+    
+    The sink preallocates each file and writes it with large overlapped
+    writes behind the transfer. Add it to a ``DownloadPipeline``.
+    
+    Args:
+        base_dir: Base directory for saving images
+        path_template: Path of each file below the save directory. Tokens:
+            {name}, {stem}, {ext}, {seq} or {seq:N} (zero padded), {model},
+            {serial}, {date} (YYYYMMDD) and {time} (HHMMSS); subdirectories
+            are created as needed, e.g. "{serial}/{date}/{stem}_{seq:5}.{ext}"
+        camera_name: Optional camera name to include in the directory name
+        write_size: Bytes per disk write, rounded up to 4096
+        buffer_count: Writes that may be in flight at once
+        unbuffered: Bypass the system file cache
+    
+    Returns:
+        AsyncFileSink
+    """
+    if not edsdk_bindings:
+        raise CanonError("EDSDK bindings are not available")
+        
+    save_dir = create_save_directory(base_dir, camera_name)
+    return edsdk_bindings.AsyncFileSink(os.path.join(save_dir, path_template),
+                                        write_size, buffer_count, unbuffered)
+
+
 def is_valid_property_id(property_id: int) -> bool:
     """Check if a property ID is valid for Canon EDSDK.
     